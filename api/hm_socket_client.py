@@ -7,6 +7,7 @@ import time
 from collections import namedtuple
 
 from netchasm  import threadinfo_pb2
+from netchasm import workqueueinfo_pb2
 from netchasm import generalparams_pb2
 from netchasm import datahostgroup_pb2
 from netchasm import ipaddress_pb2
@@ -276,7 +277,13 @@ class HealthMonClient:
 		sock = self.__createSocket()
 		if sock:
 			self.__sendMessage(sock, '1 workqueueinfo')
-			x = self.__receiveUInt(sock)
+			size = self.__receivePacketSize(sock)
+			x = None
+			if size != 0:
+				data = self.__receiveData(sock, size)
+				wi = workqueueinfo_pb2.WorkQueueInfo()
+				wi.ParseFromString(data)
+				x = wi.queueSize
 			self.__closeSocket(sock)
 			return x
 		return None
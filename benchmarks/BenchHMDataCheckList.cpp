@@ -0,0 +1,83 @@
+// Copyright 2019, Oath Inc.
+// Licensed under the terms of the Apache 2.0 license. See LICENSE file in the root of the distribution for licensing details.
+#include <vector>
+
+#include "HMBench.h"
+#include "HMDataCheckList.h"
+#include "HMDataHostGroup.h"
+#include "HMWorkQueue.h"
+
+using namespace std;
+
+//! The number of hosts in the check list.
+#define BENCH_CHECKLIST_HOSTS 10000
+
+class BenchCheckList
+{
+public:
+    BenchCheckList()
+    {
+        string hostGroupName = "bench.hostgroup";
+        HMDataHostGroup hostGroup(hostGroupName);
+        hostGroup.setCheckType(HM_CHECK_HTTP);
+        hostGroup.setCheckPlugin(HM_CHECK_PLUGIN_HTTP_CURL);
+        hostGroup.setPort(80);
+        hostGroup.setDualStack(HM_DUALSTACK_IPV4_ONLY);
+        hostGroup.setCheckInfo("/status.html");
+        hostGroup.setRemoteCheck("");
+        hostGroup.setRemoteCheckType(HM_REMOTE_CHECK_NONE);
+        hostGroup.setDistributedFallback(HM_DISTRIBUTED_FALLBACK_NONE);
+        m_hostCheck.setCheckParams(hostGroup);
+        HMDataCheckParams params;
+        for(uint32_t i = 0; i < BENCH_CHECKLIST_HOSTS; i++)
+        {
+            string hostname = "host" + to_string(i) + ".bench.com";
+            HMIPAddress address;
+            address.set("10." + to_string((i >> 16) & 0xFF) + "." + to_string((i >> 8) & 0xFF) + "." + to_string(i & 0xFF));
+            set<HMIPAddress> ips;
+            ips.insert(address);
+            m_checkList.insertCheck(hostGroupName, hostname, m_hostCheck, params, ips);
+            m_hostnames.push_back(hostname);
+            m_addresses.push_back(address);
+        }
+    }
+
+    HMDataCheckList m_checkList;
+    HMDataHostCheck m_hostCheck;
+    vector<string> m_hostnames;
+    vector<HMIPAddress> m_addresses;
+};
+
+// The scheduling decision run by the event loop for every timeout.
+HM_BENCHMARK(BM_DataCheckList_CheckNeeded)
+{
+    state.pauseTiming();
+    BenchCheckList bench;
+    state.resumeTiming();
+    for(uint64_t i = 0; i < state.m_iterations; i++)
+    {
+        uint32_t index = i % BENCH_CHECKLIST_HOSTS;
+        HM_SCHEDULE_STATE schedule = bench.m_checkList.checkNeeded(bench.m_hostnames[index], bench.m_addresses[index], bench.m_hostCheck);
+        HMBenchDoNotOptimize(schedule);
+    }
+}
+
+// Creating the check work and handing it to the work queue.
+HM_BENCHMARK(BM_DataCheckList_QueueCheck)
+{
+    state.pauseTiming();
+    BenchCheckList bench;
+    HMWorkQueue queue;
+    unique_ptr<HMWork> work;
+    bool threadShutdown = false;
+    state.resumeTiming();
+    for(uint64_t i = 0; i < state.m_iterations; i++)
+    {
+        uint32_t index = i % BENCH_CHECKLIST_HOSTS;
+        bench.m_checkList.queueCheck(bench.m_hostnames[index], bench.m_addresses[index], bench.m_hostCheck, queue);
+        if(queue.queueSize() > 0)
+        {
+            queue.getWork(work, threadShutdown);
+        }
+    }
+}
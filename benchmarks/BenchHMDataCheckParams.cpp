@@ -0,0 +1,26 @@
+// Copyright 2019, Oath Inc.
+// Licensed under the terms of the Apache 2.0 license. See LICENSE file in the root of the distribution for licensing details.
+#include "HMBench.h"
+#include "HMDataCheckParams.h"
+
+using namespace std;
+
+// Recording a check result, including the smoothing and flap tracking.
+HM_BENCHMARK(BM_DataCheckParams_UpdateCheck)
+{
+    state.pauseTiming();
+    HMDataCheckParams params;
+    HMIPAddress address;
+    address.set("10.0.0.1");
+    string hostname = "host.bench.com";
+    params.emptyQuery(address);
+    HMMonotonicTime start = HMMonotonicTime::now();
+    state.resumeTiming();
+    for(uint64_t i = 0; i < state.m_iterations; i++)
+    {
+        params.startQuery(address);
+        HM_RESPONSE response = (i % 8) ? HM_RESPONSE_CONNECTED : HM_RESPONSE_FAILED;
+        HM_REASON reason = (i % 8) ? HM_REASON_SUCCESS : HM_REASON_CONNECT_TIMEOUT;
+        params.updateCheck(hostname, address, response, reason, start, start + (i % 50), 80);
+    }
+}
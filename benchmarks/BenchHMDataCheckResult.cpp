@@ -0,0 +1,186 @@
+// Copyright 2019, Oath Inc.
+// Licensed under the terms of the Apache 2.0 license. See LICENSE file in the root of the distribution for licensing details.
+#include <vector>
+
+#include "HMBench.h"
+#include "HMDataCheckResult.h"
+#include "HMDataPacking.h"
+#include "HMStorage.h"
+
+using namespace std;
+
+//! The number of hosts in a packed host group.
+#define BENCH_GROUP_HOSTS 8
+//! The number of addresses of each host in a packed host group.
+#define BENCH_GROUP_ADDRESSES 2
+
+//! The fixed layout written by older versions, to compare the decode time against.
+struct BenchLegacyResult
+{
+    HMIPAddress m_address;
+    uint64_t m_start;
+    uint64_t m_end;
+    uint32_t m_responseTime;
+    uint32_t m_totalResponseTime;
+    uint32_t m_minResponseTime;
+    uint32_t m_maxResponseTime;
+    uint32_t m_smoothedResponseTime;
+    uint64_t m_sumResponseTime;
+    uint32_t m_numChecks;
+    uint32_t m_numResponses;
+    uint32_t m_numConnectFailures;
+    uint32_t m_numFailures;
+    uint32_t m_numTimeouts;
+    uint32_t m_numFlaps;
+    uint16_t m_status;
+    uint8_t m_response;
+    uint8_t m_reason;
+    uint8_t m_softReason;
+    uint8_t m_numFailedChecks;
+    uint8_t m_numSlowResponses;
+    uint16_t m_port;
+    uint64_t m_changeTime;
+    uint64_t m_prevTime;
+    bool m_forceHostDown;
+    uint64_t m_queueCheckTime;
+    uint64_t m_checkTime;
+    uint64_t m_remoteCheckTime;
+};
+
+static HMDataCheckResult
+createResult(const string& address)
+{
+    HMDataCheckResult result;
+    HMTimeStamp now = HMTimeStamp::now();
+    result.m_address.set(address);
+    result.m_checkTime = now;
+    result.m_start = now - 20;
+    result.m_end = now - 5;
+    result.m_queueCheckTime = now - 30;
+    result.m_changeTime = now - 3600000;
+    result.m_responseTime = 12;
+    result.m_totalResponseTime = 15;
+    result.m_minResponseTime = 3;
+    result.m_maxResponseTime = 200;
+    result.m_smoothedResponseTime = 14;
+    result.m_sumResponseTime = 123456789;
+    result.m_numChecks = 1000;
+    result.m_numResponses = 998;
+    result.m_status = HM_HOST_STATUS_UP;
+    result.m_response = HM_RESPONSE_CONNECTED;
+    result.m_reason = HM_REASON_SUCCESS;
+    result.m_port = 443;
+    return result;
+}
+
+static void
+createGroupResults(vector<HMGroupCheckResult>& results)
+{
+    for(uint32_t i = 0; i < BENCH_GROUP_HOSTS; i++)
+    {
+        string hostname = "host" + to_string(i) + ".bench.com";
+        for(uint32_t j = 0; j < BENCH_GROUP_ADDRESSES; j++)
+        {
+            string address = "10.0." + to_string(j) + "." + to_string(i + 1);
+            results.push_back(HMGroupCheckResult(hostname, HMIPAddress(), createResult(address)));
+            results.back().m_address = results.back().m_result.m_address;
+        }
+    }
+}
+
+// Writing a check result record in the compact format.
+HM_BENCHMARK(BM_DataCheckResult_Serialize)
+{
+    state.pauseTiming();
+    HMDataCheckResult result = createResult("10.0.0.1");
+    vector<char> buf(result.serialize(nullptr, 0));
+    state.resumeTiming();
+    for(uint64_t i = 0; i < state.m_iterations; i++)
+    {
+        uint32_t size = result.serialize(nullptr, 0);
+        result.serialize(&buf[0], size);
+        HMBenchDoNotOptimize(buf);
+    }
+}
+
+// Reading a check result record in the compact format.
+HM_BENCHMARK(BM_DataCheckResult_Deserialize)
+{
+    state.pauseTiming();
+    HMDataCheckResult result = createResult("10.0.0.1");
+    vector<char> buf(result.serialize(nullptr, 0));
+    result.serialize(&buf[0], buf.size());
+    state.resumeTiming();
+    for(uint64_t i = 0; i < state.m_iterations; i++)
+    {
+        HMDataCheckResult read;
+        read.deserialize(&buf[0], buf.size());
+        HMBenchDoNotOptimize(read);
+    }
+}
+
+// Reading a check result record in the fixed layout of older versions.
+HM_BENCHMARK(BM_DataCheckResult_DeserializeLegacy)
+{
+    state.pauseTiming();
+    HMDataCheckResult result = createResult("10.0.0.1");
+    BenchLegacyResult legacy = BenchLegacyResult();
+    legacy.m_address = result.m_address;
+    legacy.m_start = result.m_start.getTimeSinceEpoch();
+    legacy.m_end = result.m_end.getTimeSinceEpoch();
+    legacy.m_responseTime = result.m_responseTime;
+    legacy.m_numChecks = result.m_numChecks;
+    legacy.m_response = result.m_response;
+    legacy.m_port = result.m_port;
+    legacy.m_checkTime = result.m_checkTime.getTimeSinceEpoch();
+    state.resumeTiming();
+    for(uint64_t i = 0; i < state.m_iterations; i++)
+    {
+        HMDataCheckResult read;
+        read.deserialize((char*)&legacy, sizeof(legacy));
+        HMBenchDoNotOptimize(read);
+    }
+}
+
+// Unpacking the results of a host group sent as a delta, hostnames once and compact results.
+HM_BENCHMARK(BM_DataPacking_UnpackHostGroupDelta)
+{
+    state.pauseTiming();
+    HMDataPacking dataPacking;
+    vector<HMGroupCheckResult> results;
+    createGroupResults(results);
+    uint64_t dataSize = 0;
+    unique_ptr<char[]> data = dataPacking.packHostGroupDelta(1, 1, true, results, dataSize);
+    state.setItems(state.m_iterations * results.size());
+    state.resumeTiming();
+    for(uint64_t i = 0; i < state.m_iterations; i++)
+    {
+        uint64_t epoch;
+        uint64_t sequence;
+        bool resync;
+        vector<HMGroupCheckResult> unpacked;
+        dataPacking.unpackHostGroupDelta(data, dataSize, epoch, sequence, resync, unpacked);
+        HMBenchDoNotOptimize(unpacked);
+    }
+}
+
+// Unpacking the results of a host group sent in full, one protobuf message per result.
+HM_BENCHMARK(BM_DataPacking_UnpackHostGroupInfo)
+{
+    state.pauseTiming();
+    HMDataPacking dataPacking;
+    vector<HMGroupCheckResult> results;
+    createGroupResults(results);
+    HMDataHostGroup group("group.bench.com");
+    uint64_t dataSize = 0;
+    unique_ptr<char[]> data = dataPacking.packHostGroupInfo(group, results, dataSize);
+    state.setItems(state.m_iterations * results.size());
+    state.resumeTiming();
+    for(uint64_t i = 0; i < state.m_iterations; i++)
+    {
+        HMDataHostGroup unpackedGroup("group.bench.com");
+        vector<HMGroupCheckResult> unpacked;
+        dataPacking.unpackHostGroupInfo(data, dataSize, unpackedGroup, unpacked);
+        HMBenchDoNotOptimize(unpacked);
+    }
+}
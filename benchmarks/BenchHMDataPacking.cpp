@@ -0,0 +1,67 @@
+// Copyright 2019, Oath Inc.
+// Licensed under the terms of the Apache 2.0 license. See LICENSE file in the root of the distribution for licensing details.
+#include <vector>
+
+#include "HMBench.h"
+#include "HMDataPacking.h"
+
+using namespace std;
+
+//! The number of check results in a packed host result.
+#define BENCH_PACK_RESULTS 16
+
+static void
+createHostResults(vector<pair<HMDataCheckParams, HMDataCheckResult>>& hostResults)
+{
+    for(uint32_t i = 0; i < BENCH_PACK_RESULTS; i++)
+    {
+        HMDataCheckParams params;
+        params.setCheckParameters(0, 0, 0, HM_DEFAULT_SMOOTHING_WINDOW,
+                HM_DEFAULT_GROUP_THRESHOLD, HM_DEFAULT_SLOW_THRESHOLD, HM_DEFAULT_MAX_FLAPS,
+                HM_DEFAULT_CHECK_TIMEOUT, HM_DEFAULT_TTL + i, HM_DEFAULT_FLAP_THRESHOLD, 0);
+        params.addHostGroup("group" + to_string(i) + ".bench.com");
+        HMDataCheckResult result;
+        result.m_address.set("10.0.0." + to_string(i + 1));
+        result.m_response = HM_RESPONSE_CONNECTED;
+        result.m_reason = HM_REASON_SUCCESS;
+        result.m_responseTime = 10 + i;
+        result.m_numChecks = 100 + i;
+        hostResults.push_back(make_pair(params, result));
+    }
+}
+
+// Packing the results of a host for the control socket.
+HM_BENCHMARK(BM_DataPacking_PackHostResults)
+{
+    state.pauseTiming();
+    HMDataPacking dataPacking;
+    vector<pair<HMDataCheckParams, HMDataCheckResult>> hostResults;
+    createHostResults(hostResults);
+    string hostname = "host.bench.com";
+    state.resumeTiming();
+    for(uint64_t i = 0; i < state.m_iterations; i++)
+    {
+        uint64_t dataSize = 0;
+        unique_ptr<char[]> data = dataPacking.packHostResults(hostname, hostResults, dataSize);
+        HMBenchDoNotOptimize(data);
+    }
+}
+
+// Unpacking the results of a host received on the control socket.
+HM_BENCHMARK(BM_DataPacking_UnpackHostResults)
+{
+    state.pauseTiming();
+    HMDataPacking dataPacking;
+    vector<pair<HMDataCheckParams, HMDataCheckResult>> hostResults;
+    createHostResults(hostResults);
+    string hostname = "host.bench.com";
+    uint64_t dataSize = 0;
+    unique_ptr<char[]> data = dataPacking.packHostResults(hostname, hostResults, dataSize);
+    state.resumeTiming();
+    for(uint64_t i = 0; i < state.m_iterations; i++)
+    {
+        multimap<HMDataCheckParams, HMDataCheckResult> results;
+        dataPacking.unpackHostResults(data, dataSize, results);
+        HMBenchDoNotOptimize(results);
+    }
+}
@@ -0,0 +1,101 @@
+// Copyright 2019, Oath Inc.
+// Licensed under the terms of the Apache 2.0 license. See LICENSE file in the root of the distribution for licensing details.
+#include <thread>
+#include <vector>
+
+#include "HMBench.h"
+#include "HMStateManager.h"
+#include "HMEventLoopQueue.h"
+
+using namespace std;
+
+//! The number of hosts scheduled by the benchmarks.
+#define BENCH_EVENT_HOSTS 10000
+//! The max time in ms to wait for the event loop to hand the scheduled checks to the work queue.
+#define BENCH_EVENT_DRAIN_TIMEOUT 30000
+
+static void
+createChecks(HMState& state, vector<string>& hostnames, vector<HMIPAddress>& addresses, HMDataHostCheck& hostCheck)
+{
+    string hostGroupName = "bench.hostgroup";
+    HMDataHostGroup hostGroup(hostGroupName);
+    hostGroup.setCheckType(HM_CHECK_TCP);
+    hostGroup.setCheckPlugin(HM_CHECK_PLUGIN_TCP_RAW);
+    hostGroup.setPort(80);
+    hostGroup.setDualStack(HM_DUALSTACK_IPV4_ONLY);
+    hostGroup.setCheckInfo("");
+    hostGroup.setRemoteCheck("");
+    hostGroup.setRemoteCheckType(HM_REMOTE_CHECK_NONE);
+    hostGroup.setDistributedFallback(HM_DISTRIBUTED_FALLBACK_NONE);
+    hostCheck.setCheckParams(hostGroup);
+    HMDataCheckParams params;
+    params.setCheckParameters(0, 0, 0, HM_DEFAULT_SMOOTHING_WINDOW,
+            HM_DEFAULT_GROUP_THRESHOLD, HM_DEFAULT_SLOW_THRESHOLD, HM_DEFAULT_MAX_FLAPS,
+            HM_DEFAULT_CHECK_TIMEOUT, HM_DEFAULT_TTL, HM_DEFAULT_FLAP_THRESHOLD, 0);
+    for(uint32_t i = 0; i < BENCH_EVENT_HOSTS; i++)
+    {
+        string hostname = "host" + to_string(i) + ".bench.com";
+        HMIPAddress address;
+        address.set("10." + to_string((i >> 16) & 0xFF) + "." + to_string((i >> 8) & 0xFF) + "." + to_string(i & 0xFF));
+        set<HMIPAddress> ips;
+        ips.insert(address);
+        state.m_checkList.insertCheck(hostGroupName, hostname, hostCheck, params, ips);
+        hostnames.push_back(hostname);
+        addresses.push_back(address);
+    }
+}
+
+// Insertion of health check timeouts into the scheduler.
+HM_BENCHMARK(BM_EventLoopQueue_AddTimeout)
+{
+    state.pauseTiming();
+    HMStateManager stateManager;
+    shared_ptr<HMState> current = make_shared<HMState>();
+    stateManager.setState(current);
+    vector<string> hostnames;
+    vector<HMIPAddress> addresses;
+    HMDataHostCheck hostCheck;
+    createChecks(*current, hostnames, addresses, hostCheck);
+    HMEventLoopQueue eventQueue(&stateManager);
+    HMMonotonicTime future = HMMonotonicTime::now() + 3600000;
+    state.resumeTiming();
+    for(uint64_t i = 0; i < state.m_iterations; i++)
+    {
+        uint32_t index = i % BENCH_EVENT_HOSTS;
+        eventQueue.addHealthCheckTimeout(hostnames[index], addresses[index], hostCheck, future + i % 1000);
+    }
+}
+
+// Time from scheduling due checks to their work being queued by the event loop thread.
+HM_BENCHMARK(BM_EventLoopQueue_ScheduleDue)
+{
+    state.pauseTiming();
+    HMStateManager stateManager;
+    shared_ptr<HMState> current = make_shared<HMState>();
+    stateManager.setState(current);
+    vector<string> hostnames;
+    vector<HMIPAddress> addresses;
+    HMDataHostCheck hostCheck;
+    createChecks(*current, hostnames, addresses, hostCheck);
+    HMEventLoopQueue eventQueue(&stateManager);
+    eventQueue.runThread();
+    uint64_t count = min(state.m_iterations, (uint64_t)BENCH_EVENT_HOSTS);
+    state.resumeTiming();
+
+    HMMonotonicTime now = HMMonotonicTime::now();
+    for(uint64_t i = 0; i < count; i++)
+    {
+        eventQueue.addHealthCheckTimeout(hostnames[i], addresses[i], hostCheck, now);
+    }
+    HMMonotonicTime expiry = HMMonotonicTime::now() + BENCH_EVENT_DRAIN_TIMEOUT;
+    while(stateManager.m_workQueue.queueSize() < count && HMMonotonicTime::now() < expiry)
+    {
+        this_thread::yield();
+    }
+
+    state.pauseTiming();
+    state.setItems(count);
+    eventQueue.shutDown();
+    current.reset();
+    stateManager.setState(current);
+}
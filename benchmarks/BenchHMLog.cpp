@@ -0,0 +1,80 @@
+// Copyright 2019, Oath Inc.
+// Licensed under the terms of the Apache 2.0 license. See LICENSE file in the root of the distribution for licensing details.
+#include <unistd.h>
+#include <thread>
+#include <vector>
+
+#include "HMBench.h"
+#include "HMLogText.h"
+
+using namespace std;
+
+//! The number of threads logging in the contended benchmark.
+#define BENCH_LOG_THREADS 4
+
+static void
+logMessages(uint64_t count)
+{
+    string hostname = "host.bench.com";
+    for(uint64_t i = 0; i < count; i++)
+    {
+        HMLog(HM_LOG_INFO, "[BENCH] Health check of %s completed in %lu ms with response %d", hostname.c_str(), i % 100, 1);
+    }
+}
+
+// Run the log writer thread with the given number of logging threads, the queue is flushed in shutDownLogging.
+static void
+runLog(HMBenchState& state, HM_LOG_LEVEL level, uint32_t nThreads)
+{
+    state.pauseTiming();
+    string logFile = getBenchDirectory() + "/netchasm_bench.log";
+    unlink(logFile.c_str());
+    HMLogBase* benchLog = new HMLogText();
+    benchLog->initLogging(logFile, level, true);
+    benchLog->setMaxLogQueue(UINT32_MAX);
+    HMLogBase* lastLog = hlog;
+    hlog = benchLog;
+    state.resumeTiming();
+
+    if(nThreads == 1)
+    {
+        logMessages(state.m_iterations);
+    }
+    else
+    {
+        vector<thread> threads;
+        for(uint32_t i = 0; i < nThreads; i++)
+        {
+            threads.push_back(thread(logMessages, state.m_iterations / nThreads + 1));
+        }
+        for(auto& t : threads)
+        {
+            t.join();
+        }
+        state.setItems((state.m_iterations / nThreads + 1) * nThreads);
+    }
+    benchLog->shutDownLogging();
+
+    state.pauseTiming();
+    hlog = lastLog;
+    delete benchLog;
+    unlink(logFile.c_str());
+}
+
+// Formatting and writing log lines from a single thread.
+HM_BENCHMARK(BM_Log_Text)
+{
+    runLog(state, HM_LOG_INFO, 1);
+}
+
+// Formatting and writing log lines from several threads.
+HM_BENCHMARK(BM_Log_TextContended)
+{
+    runLog(state, HM_LOG_INFO, BENCH_LOG_THREADS);
+}
+
+// The cost of a log call filtered out by the log level.
+HM_BENCHMARK(BM_Log_Filtered)
+{
+    runLog(state, HM_LOG_ERROR, 1);
+}
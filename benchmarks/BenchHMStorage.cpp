@@ -0,0 +1,105 @@
+// Copyright 2019, Oath Inc.
+// Licensed under the terms of the Apache 2.0 license. See LICENSE file in the root of the distribution for licensing details.
+#include <unistd.h>
+#include <vector>
+
+#include "HMBench.h"
+#include "HMDNSCache.h"
+#include "HMDataHostGroup.h"
+#include "TestStorageHostGroup.h"
+#ifdef USE_MDBM
+#include "HMStorageHostGroupMDBM.h"
+#endif
+
+using namespace std;
+
+//! The number of host groups stored.
+#define BENCH_STORE_GROUPS 100
+//! The number of hosts in each host group.
+#define BENCH_STORE_HOSTS 50
+
+class BenchStore
+{
+public:
+    BenchStore()
+    {
+        HMDNSLookup dnsHostCheck(HM_DNS_TYPE_LOOKUP, false);
+        for(uint32_t g = 0; g < BENCH_STORE_GROUPS; g++)
+        {
+            string groupName = "group" + to_string(g) + ".bench.com";
+            HMDataHostGroup group(groupName);
+            group.setDualStack(HM_DUALSTACK_IPV4_ONLY);
+            HMDataCheckParams params;
+            group.getCheckParameters(params);
+            params.addHostGroup(groupName);
+            m_params.push_back(params);
+            for(uint32_t h = 0; h < BENCH_STORE_HOSTS; h++)
+            {
+                string hostname = "host" + to_string(h) + "." + groupName;
+                HMIPAddress address;
+                address.set("10.0." + to_string(g) + "." + to_string(h + 1));
+                set<HMIPAddress> addresses;
+                addresses.insert(address);
+                m_dnsCache.insertDNSEntry(hostname, dnsHostCheck, HM_DEFAULT_DNS_TTL, HM_DEFAULT_DNS_TTL);
+                m_dnsCache.updateDNSEntry(hostname, dnsHostCheck, addresses);
+                group.addHost(hostname);
+                m_hostnames.push_back(hostname);
+                m_addresses.push_back(address);
+            }
+            m_groupMap.insert(make_pair(groupName, group));
+        }
+    }
+
+    // Store a check result for each host in turn, the store is drained in closeStore.
+    void run(HMStorage& store, HMBenchState& state)
+    {
+        HMDataCheckResult result;
+        result.m_response = HM_RESPONSE_CONNECTED;
+        result.m_reason = HM_REASON_SUCCESS;
+        for(uint64_t i = 0; i < state.m_iterations; i++)
+        {
+            uint32_t index = i % m_hostnames.size();
+            result.m_numChecks = i;
+            store.storeCheckResult(m_hostnames[index], m_addresses[index], m_hostCheck,
+                    m_params[index / BENCH_STORE_HOSTS], result);
+        }
+        store.closeStore();
+    }
+
+    HMDataHostGroupMap m_groupMap;
+    HMDNSCache m_dnsCache;
+    HMDataHostCheck m_hostCheck;
+    vector<HMDataCheckParams> m_params;
+    vector<string> m_hostnames;
+    vector<HMIPAddress> m_addresses;
+};
+
+// Check results through the host group commit path, on an in memory backend.
+HM_BENCHMARK(BM_StorageHostGroup_Commit)
+{
+    state.pauseTiming();
+    BenchStore bench;
+    TestStorageHostGroup store(&bench.m_groupMap, &bench.m_dnsCache);
+    store.openStore(false);
+    state.resumeTiming();
+    bench.run(store, state);
+}
+
+#ifdef USE_MDBM
+// Check results through the host group commit path, stored in MDBM.
+HM_BENCHMARK(BM_StorageHostGroupMDBM_Store)
+{
+    state.pauseTiming();
+    BenchStore bench;
+    string filename = getBenchDirectory() + "/netchasm_bench.mdbm";
+    unlink(filename.c_str());
+    {
+        HMStorageHostGroupMDBM store(filename, &bench.m_groupMap, &bench.m_dnsCache);
+        store.openStore();
+        state.resumeTiming();
+        bench.run(store, state);
+        state.pauseTiming();
+    }
+    unlink(filename.c_str());
+}
+#endif
@@ -0,0 +1,105 @@
+// Copyright 2019, Oath Inc.
+// Licensed under the terms of the Apache 2.0 license. See LICENSE file in the root of the distribution for licensing details.
+#include <thread>
+#include <atomic>
+#include <vector>
+
+#include "HMBench.h"
+#include "HMWorkQueue.h"
+#include "HMWorkDNSLookupStatic.h"
+
+using namespace std;
+
+//! The number of work items moved in a batch.
+#define BENCH_WORK_BATCH 1024
+//! The number of producer and consumer threads of the contended benchmark.
+#define BENCH_WORK_THREADS 4
+
+static unique_ptr<HMWork>
+createWork(uint32_t index)
+{
+    HMIPAddress ip;
+    HMDataHostCheck hostCheck;
+    HMDNSLookup dnsHostCheck(HM_DNS_TYPE_STATIC, false);
+    return make_unique<HMWorkDNSLookupStatic>("host" + to_string(index) + ".bench.com", ip, hostCheck, dnsHostCheck);
+}
+
+// A single thread inserting and taking back one work item.
+HM_BENCHMARK(BM_WorkQueue_InsertGet)
+{
+    HMWorkQueue queue;
+    unique_ptr<HMWork> work = createWork(0);
+    bool threadShutdown = false;
+    for(uint64_t i = 0; i < state.m_iterations; i++)
+    {
+        queue.insertWork(work);
+        queue.getWork(work, threadShutdown);
+    }
+}
+
+// A single thread inserting a batch of work and draining it.
+HM_BENCHMARK(BM_WorkQueue_InsertGetBatch)
+{
+    HMWorkQueue queue;
+    vector<unique_ptr<HMWork>> works;
+    for(uint32_t i = 0; i < BENCH_WORK_BATCH; i++)
+    {
+        works.push_back(createWork(i));
+    }
+    bool threadShutdown = false;
+    state.resumeTiming();
+    for(uint64_t i = 0; i < state.m_iterations; i++)
+    {
+        for(auto& work : works)
+        {
+            queue.insertWork(work);
+        }
+        for(auto& work : works)
+        {
+            queue.getWork(work, threadShutdown);
+        }
+    }
+    state.setItems(state.m_iterations * BENCH_WORK_BATCH);
+}
+
+// Producers and consumers contending on the queue like the event loop and the worker threads.
+HM_BENCHMARK(BM_WorkQueue_Contended)
+{
+    HMWorkQueue queue;
+    uint64_t perProducer = state.m_iterations / BENCH_WORK_THREADS + 1;
+    uint64_t total = perProducer * BENCH_WORK_THREADS;
+    atomic<uint64_t> consumed(0);
+    vector<thread> threads;
+    for(uint32_t i = 0; i < BENCH_WORK_THREADS; i++)
+    {
+        threads.push_back(thread([&queue, &consumed]() {
+            unique_ptr<HMWork> work;
+            bool threadShutdown = false;
+            while(queue.getWork(work, threadShutdown))
+            {
+                work.reset();
+                consumed++;
+            }
+        }));
+    }
+    for(uint32_t i = 0; i < BENCH_WORK_THREADS; i++)
+    {
+        threads.push_back(thread([&queue, perProducer, i]() {
+            for(uint64_t j = 0; j < perProducer; j++)
+            {
+                unique_ptr<HMWork> work = createWork(i);
+                queue.insertWork(work);
+            }
+        }));
+    }
+    while(consumed < total)
+    {
+        this_thread::yield();
+    }
+    queue.shutdown();
+    for(auto& t : threads)
+    {
+        t.join();
+    }
+    state.setItems(total);
+}
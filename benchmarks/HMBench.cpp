@@ -0,0 +1,144 @@
+// Copyright 2019, Oath Inc.
+// Licensed under the terms of the Apache 2.0 license. See LICENSE file in the root of the distribution for licensing details.
+#include <unistd.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <iostream>
+
+#include "HMBench.h"
+
+using namespace std;
+
+//! The default time in ms a benchmark is run for.
+#define HM_BENCH_DEFAULT_MIN_TIME 500
+//! The max number of iterations a benchmark is scaled to.
+#define HM_BENCH_MAX_ITERATIONS 1000000000ULL
+
+static string benchDirectory = "/tmp";
+
+void
+HMBenchState::pauseTiming()
+{
+    if(m_running)
+    {
+        m_elapsed += chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - m_start).count();
+        m_running = false;
+    }
+}
+
+void
+HMBenchState::resumeTiming()
+{
+    if(!m_running)
+    {
+        m_start = chrono::steady_clock::now();
+        m_running = true;
+    }
+}
+
+uint64_t
+HMBenchState::getElapsed()
+{
+    pauseTiming();
+    return m_elapsed;
+}
+
+vector<HMBenchRegistry::Entry>&
+HMBenchRegistry::getBenchmarks()
+{
+    static vector<Entry> benchmarks;
+    return benchmarks;
+}
+
+const string&
+getBenchDirectory()
+{
+    return benchDirectory;
+}
+
+static void
+usage(const char* name)
+{
+    cout << "Usage: " << name << " [options]" << endl;
+    cout << "Options:" << endl;
+    cout << "-f <filter>\tOnly run the benchmarks with a name containing the filter" << endl;
+    cout << "-t <msec>\tMinimum time to run each benchmark [default: " << HM_BENCH_DEFAULT_MIN_TIME << "]" << endl;
+    cout << "-d <dir>\tScratch directory for the benchmarks writing files [default: /tmp]" << endl;
+    cout << "-l\t\tList the benchmarks" << endl;
+}
+
+// Run the benchmark with an increasing number of iterations until it runs for at least minTime.
+static void
+runBenchmark(const HMBenchRegistry::Entry& entry, uint64_t minTime)
+{
+    uint64_t iterations = 1;
+    uint64_t elapsed = 0;
+    uint64_t items = 0;
+    while(true)
+    {
+        HMBenchState state(iterations);
+        entry.m_function(state);
+        elapsed = state.getElapsed();
+        items = state.m_items ? state.m_items : iterations;
+        if(elapsed >= minTime * 1000000 || iterations >= HM_BENCH_MAX_ITERATIONS)
+        {
+            break;
+        }
+        uint64_t next = iterations * 10;
+        if(elapsed > 0)
+        {
+            uint64_t estimate = (uint64_t)((double)iterations * minTime * 1000000 * 1.2 / elapsed);
+            next = min(next, max(estimate, iterations + 1));
+        }
+        iterations = min(next, (uint64_t)HM_BENCH_MAX_ITERATIONS);
+    }
+    double nsPerItem = (double)elapsed / items;
+    double itemsPerSec = elapsed ? (double)items * 1e9 / elapsed : 0;
+    printf("%-48s %12" PRIu64 " %14.1f ns/op %16.0f ops/s\n", entry.m_name.c_str(), items, nsPerItem, itemsPerSec);
+    fflush(stdout);
+}
+
+int
+main(int argc, char* argv[])
+{
+    string filter;
+    uint64_t minTime = HM_BENCH_DEFAULT_MIN_TIME;
+    bool list = false;
+    int opt;
+    while((opt = getopt(argc, argv, "f:t:d:lh")) != -1)
+    {
+        switch(opt)
+        {
+        case 'f':
+            filter = optarg;
+            break;
+        case 't':
+            minTime = strtoull(optarg, nullptr, 10);
+            break;
+        case 'd':
+            benchDirectory = optarg;
+            break;
+        case 'l':
+            list = true;
+            break;
+        default:
+            usage(argv[0]);
+            return (opt == 'h') ? 0 : 1;
+        }
+    }
+
+    for(auto& entry : HMBenchRegistry::getBenchmarks())
+    {
+        if(!filter.empty() && entry.m_name.find(filter) == string::npos)
+        {
+            continue;
+        }
+        if(list)
+        {
+            cout << entry.m_name << endl;
+            continue;
+        }
+        runBenchmark(entry, minTime);
+    }
+    return 0;
+}
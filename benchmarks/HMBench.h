@@ -0,0 +1,98 @@
+// Copyright 2019, Oath Inc.
+// Licensed under the terms of the Apache 2.0 license. See LICENSE file in the root of the distribution for licensing details.
+#ifndef HMBENCH_H_
+#define HMBENCH_H_
+
+#include <inttypes.h>
+#include <string>
+#include <vector>
+#include <chrono>
+
+//! The state handed to a benchmark run.
+/*!
+     A benchmark runs the measured operation m_iterations times. Setup and teardown that should not be measured
+     are kept out of the timed region with pauseTiming and resumeTiming. If the benchmark never touches the timer,
+     the whole function is measured.
+ */
+class HMBenchState
+{
+public:
+    HMBenchState(uint64_t iterations) :
+        m_iterations(iterations),
+        m_items(0),
+        m_elapsed(0),
+        m_running(true),
+        m_start(std::chrono::steady_clock::now()) {};
+
+    //! Stop the timer, the time spent until resumeTiming is not measured.
+    void pauseTiming();
+
+    //! Restart the timer.
+    void resumeTiming();
+
+    //! Set the number of items processed when an iteration handles more than one item.
+    void setItems(uint64_t items) { m_items = items; }
+
+    //! Get the measured time in ns.
+    uint64_t getElapsed();
+
+    //! The number of times to run the measured operation.
+    const uint64_t m_iterations;
+    //! The number of items processed, 0 if one item per iteration.
+    uint64_t m_items;
+
+private:
+    uint64_t m_elapsed;
+    bool m_running;
+    std::chrono::steady_clock::time_point m_start;
+};
+
+typedef void (*HMBenchFunction)(HMBenchState& state);
+
+//! The benchmarks linked in the executable.
+class HMBenchRegistry
+{
+public:
+    //! A registered benchmark.
+    class Entry
+    {
+    public:
+        Entry(const std::string& name, HMBenchFunction function) :
+            m_name(name),
+            m_function(function) {};
+
+        std::string m_name;
+        HMBenchFunction m_function;
+    };
+
+    //! Get the registered benchmarks.
+    static std::vector<Entry>& getBenchmarks();
+};
+
+//! Registers a benchmark at static initialization, use through HM_BENCHMARK.
+class HMBenchRegistrar
+{
+public:
+    HMBenchRegistrar(const char* name, HMBenchFunction function)
+    {
+        HMBenchRegistry::getBenchmarks().push_back(HMBenchRegistry::Entry(name, function));
+    }
+};
+
+//! Define and register a benchmark.
+#define HM_BENCHMARK(NAME) \
+    static void NAME(HMBenchState& state); \
+    static HMBenchRegistrar NAME##_registrar(#NAME, NAME); \
+    static void NAME(HMBenchState& state)
+
+//! Keep the compiler from optimizing away a value computed by a benchmark.
+template <typename T>
+inline void HMBenchDoNotOptimize(const T& value)
+{
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+//! Get a scratch directory for the benchmarks writing files.
+const std::string& getBenchDirectory();
+
+#endif /* HMBENCH_H_ */
@@ -0,0 +1,231 @@
+// Copyright 2019, Oath Inc.
+// Licensed under the terms of the Apache 2.0 license. See LICENSE file in the root of the distribution for licensing details.
+#include <unistd.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <inttypes.h>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <memory>
+#include <algorithm>
+#include <chrono>
+
+#include "HMStateManager.h"
+#include "HMLoadResponder.h"
+
+using namespace std;
+
+//! The default number of hosts checked per check type.
+#define LOAD_DEFAULT_HOSTS 100
+//! The default check ttl in ms.
+#define LOAD_DEFAULT_TTL 1000
+//! The default time in s the load is measured for.
+#define LOAD_DEFAULT_DURATION 30
+//! The default number of worker threads.
+#define LOAD_DEFAULT_THREADS 8
+
+static void
+usage(const char* name)
+{
+    cout << "Usage: " << name << " [options]" << endl;
+    cout << "Runs the daemon in process against loopback responders and reports the check rate and scheduling lateness." << endl;
+    cout << "Options:" << endl;
+    cout << "-n <hosts>\tNumber of hosts per check type [default: " << LOAD_DEFAULT_HOSTS << "]" << endl;
+    cout << "-t <msec>\tCheck ttl [default: " << LOAD_DEFAULT_TTL << "]" << endl;
+    cout << "-d <sec>\tMeasured duration after the warmup [default: " << LOAD_DEFAULT_DURATION << "]" << endl;
+    cout << "-c <types>\tComma separated check types among tcp,http,dns [default: tcp,http,dns]" << endl;
+    cout << "-w <threads>\tNumber of worker threads [default: " << LOAD_DEFAULT_THREADS << "]" << endl;
+    cout << "-e\t\tUse the event driven engines for TCP, HTTP and DNS checks" << endl;
+    cout << "-o <dir>\tScratch directory for the configs, database and log [default: /tmp]" << endl;
+    cout << "-v <level>\tLog level of the daemon [default: " << HM_LOG_ERROR << "]" << endl;
+}
+
+// Get the loopback address of a host, every address in 127.0.0.0/8 is local.
+static string
+hostAddress(uint32_t type, uint32_t host)
+{
+    stringstream ss;
+    ss << "127." << (type + 1) << "." << (host >> 8) << "." << ((host & 0xFF) + 1);
+    return ss.str();
+}
+
+static int64_t
+percentile(const vector<int64_t>& sorted, double p)
+{
+    if(sorted.empty())
+    {
+        return 0;
+    }
+    size_t index = (size_t)(p * (sorted.size() - 1));
+    return sorted[index];
+}
+
+int
+main(int argc, char* argv[])
+{
+    uint32_t nHosts = LOAD_DEFAULT_HOSTS;
+    uint64_t ttl = LOAD_DEFAULT_TTL;
+    uint64_t duration = LOAD_DEFAULT_DURATION;
+    uint32_t nThreads = LOAD_DEFAULT_THREADS;
+    string types = "tcp,http,dns";
+    string dir = "/tmp";
+    bool engines = false;
+    int logLevel = HM_LOG_ERROR;
+    int opt;
+    while((opt = getopt(argc, argv, "n:t:d:c:w:eo:v:h")) != -1)
+    {
+        switch(opt)
+        {
+        case 'n':
+            nHosts = atoi(optarg);
+            break;
+        case 't':
+            ttl = strtoull(optarg, nullptr, 10);
+            break;
+        case 'd':
+            duration = strtoull(optarg, nullptr, 10);
+            break;
+        case 'c':
+            types = optarg;
+            break;
+        case 'w':
+            nThreads = atoi(optarg);
+            break;
+        case 'e':
+            engines = true;
+            break;
+        case 'o':
+            dir = optarg;
+            break;
+        case 'v':
+            logLevel = atoi(optarg);
+            break;
+        default:
+            usage(argv[0]);
+            return (opt == 'h') ? 0 : 1;
+        }
+    }
+    if(nHosts == 0 || nHosts > 65536 || ttl == 0)
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    vector<unique_ptr<HMLoadResponder>> responders;
+    stringstream typeStream(types);
+    string type;
+    while(getline(typeStream, type, ','))
+    {
+        if(type == "tcp")
+        {
+            responders.push_back(make_unique<HMLoadResponder>(HM_LOAD_TCP));
+        }
+        else if(type == "http")
+        {
+            responders.push_back(make_unique<HMLoadResponder>(HM_LOAD_HTTP));
+        }
+        else if(type == "dns")
+        {
+            responders.push_back(make_unique<HMLoadResponder>(HM_LOAD_DNS));
+        }
+        else
+        {
+            cerr << "Unknown check type " << type << endl;
+            return 1;
+        }
+    }
+
+    string masterConfig = dir + "/netchasm_load_master.yaml";
+    string checkConfig = dir + "/netchasm_load_checks.yaml";
+    ofstream checks(checkConfig);
+    for(uint32_t i = 0; i < responders.size(); i++)
+    {
+        HMLoadResponder& responder = *responders[i];
+        if(!responder.start())
+        {
+            cerr << "Failed to start the " << responder.getName() << " responder" << endl;
+            return 1;
+        }
+        checks << "-   name: " << responder.getName() << ".load.netchasm.net\n";
+        checks << "    ttl: " << ttl << "\n";
+        checks << "    timeout: " << max(ttl / 2, (uint64_t)100) << "\n";
+        checks << "    check-type: " << responder.getName() << "\n";
+        checks << "    check-port: " << responder.getPort() << "\n";
+        checks << "    check-info: " << (responder.getName() == "dns" ? "bench.check" : "/status.html") << "\n";
+        checks << "    dual-stack-mode: ipv4-only\n";
+        checks << "    host:\n";
+        for(uint32_t h = 0; h < nHosts; h++)
+        {
+            checks << "       - " << hostAddress(i, h) << "\n";
+        }
+        checks << "\n";
+    }
+    checks.close();
+
+    ofstream master(masterConfig);
+    master << "threads: " << nThreads << "\n";
+    master << "config.load-file: " << checkConfig << "\n";
+    master << "control-server-linux: off\n";
+    master << "db.type: text\n";
+    master << "db.path: " << dir << "/netchasm_load.text\n";
+    master << "log.path: " << dir << "/netchasm_load.log\n";
+    if(engines)
+    {
+        master << "tcp.type: epoll\n";
+        master << "http.type: multi\n";
+        master << "dns.resolver: epoll\n";
+    }
+    master.close();
+
+    HMStateManager stateManager;
+    bool started = true;
+    thread daemon([&](){ started = stateManager.healthCheck(masterConfig, (HM_LOG_LEVEL)logLevel); });
+
+    // Let every host get scheduled at least twice before measuring
+    this_thread::sleep_for(chrono::milliseconds(2 * ttl + 1000));
+    vector<uint64_t> startRequests;
+    for(auto& responder : responders)
+    {
+        startRequests.push_back(responder->getRequests());
+        responder->startRecording();
+    }
+    auto start = chrono::steady_clock::now();
+    this_thread::sleep_for(chrono::seconds(duration));
+    double elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    vector<uint64_t> endRequests;
+    for(auto& responder : responders)
+    {
+        endRequests.push_back(responder->getRequests());
+    }
+
+    stateManager.shutdown();
+    daemon.join();
+    for(auto& responder : responders)
+    {
+        responder->shutDown();
+    }
+    if(!started)
+    {
+        cerr << "The daemon failed, see " << dir << "/netchasm_load.log" << endl;
+        return 1;
+    }
+
+    printf("%-6s %8s %12s %10s %12s %12s %12s\n", "type", "hosts", "checks", "checks/s", "late p50 ms", "late p99 ms", "late max ms");
+    for(uint32_t i = 0; i < responders.size(); i++)
+    {
+        vector<int64_t> intervals;
+        responders[i]->getIntervals(intervals);
+        for(auto& interval : intervals)
+        {
+            interval -= ttl;
+        }
+        sort(intervals.begin(), intervals.end());
+        uint64_t count = endRequests[i] - startRequests[i];
+        printf("%-6s %8u %12" PRIu64 " %10.1f %12" PRId64 " %12" PRId64 " %12" PRId64 "\n",
+                responders[i]->getName().c_str(), nHosts, count, count / elapsed,
+                percentile(intervals, 0.5), percentile(intervals, 0.99),
+                intervals.empty() ? 0 : intervals.back());
+    }
+    return 0;
+}
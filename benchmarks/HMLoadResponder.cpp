@@ -0,0 +1,335 @@
+// Copyright 2019, Oath Inc.
+// Licensed under the terms of the Apache 2.0 license. See LICENSE file in the root of the distribution for licensing details.
+#include <sys/socket.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <string.h>
+
+#include "HMLoadResponder.h"
+
+using namespace std;
+
+//! The max number of events handled per epoll wait.
+#define LOAD_MAX_EVENTS 256
+//! The size of the DNS packets handled.
+#define LOAD_DNS_PACKET 512
+
+static const char loadHTTPResponse[] = "HTTP/1.1 200 OK\r\nContent-Length: 2\r\nConnection: close\r\n\r\nOK";
+
+HMLoadResponder::~HMLoadResponder()
+{
+    shutDown();
+}
+
+string
+HMLoadResponder::getName() const
+{
+    switch(m_protocol)
+    {
+    case HM_LOAD_TCP:
+        return "tcp";
+    case HM_LOAD_HTTP:
+        return "http";
+    case HM_LOAD_DNS:
+        return "dns";
+    }
+    return "";
+}
+
+bool
+HMLoadResponder::start()
+{
+    bool udp = (m_protocol == HM_LOAD_DNS);
+    m_socket = socket(AF_INET, (udp ? SOCK_DGRAM : SOCK_STREAM) | SOCK_NONBLOCK, 0);
+    if(m_socket < 0)
+    {
+        return false;
+    }
+    int on = 1;
+    setsockopt(m_socket, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+    if(udp)
+    {
+        // The reply has to come from the queried address
+        setsockopt(m_socket, IPPROTO_IP, IP_PKTINFO, &on, sizeof(on));
+        int bufSize = 4 * 1024 * 1024;
+        setsockopt(m_socket, SOL_SOCKET, SO_RCVBUF, &bufSize, sizeof(bufSize));
+    }
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    socklen_t len = sizeof(addr);
+    if(bind(m_socket, (sockaddr*)&addr, sizeof(addr)) < 0
+            || (!udp && listen(m_socket, SOMAXCONN) < 0)
+            || getsockname(m_socket, (sockaddr*)&addr, &len) < 0)
+    {
+        return false;
+    }
+    m_port = ntohs(addr.sin_port);
+
+    m_epollFd = epoll_create1(EPOLL_CLOEXEC);
+    m_wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if(m_epollFd < 0 || m_wakeFd < 0)
+    {
+        return false;
+    }
+    epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.fd = m_socket;
+    epoll_ctl(m_epollFd, EPOLL_CTL_ADD, m_socket, &ev);
+    ev.data.fd = m_wakeFd;
+    epoll_ctl(m_epollFd, EPOLL_CTL_ADD, m_wakeFd, &ev);
+
+    m_keepRunning = true;
+    m_thread = thread(&HMLoadResponder::run, this);
+    return true;
+}
+
+void
+HMLoadResponder::shutDown()
+{
+    m_keepRunning = false;
+    if(m_thread.joinable())
+    {
+        uint64_t val = 1;
+        if(write(m_wakeFd, &val, sizeof(val)) < 0)
+        {
+            // The thread still exits on the next event
+        }
+        m_thread.join();
+    }
+    for(auto& it : m_buffers)
+    {
+        close(it.first);
+    }
+    m_buffers.clear();
+    for(int* fd : { &m_socket, &m_epollFd, &m_wakeFd })
+    {
+        if(*fd >= 0)
+        {
+            close(*fd);
+            *fd = -1;
+        }
+    }
+}
+
+void
+HMLoadResponder::startRecording()
+{
+    lock_guard<mutex> lk(m_recordMutex);
+    m_recording = true;
+}
+
+void
+HMLoadResponder::getIntervals(vector<int64_t>& intervals)
+{
+    lock_guard<mutex> lk(m_recordMutex);
+    intervals = m_intervals;
+}
+
+void
+HMLoadResponder::record(uint32_t address)
+{
+    m_requests++;
+    HMTimeStamp now = HMTimeStamp::now();
+    lock_guard<mutex> lk(m_recordMutex);
+    auto it = m_lastCheck.find(address);
+    if(it != m_lastCheck.end())
+    {
+        if(m_recording)
+        {
+            m_intervals.push_back((int64_t)(now - it->second));
+        }
+        it->second = now;
+    }
+    else
+    {
+        m_lastCheck.insert(make_pair(address, now));
+    }
+}
+
+void
+HMLoadResponder::run()
+{
+    epoll_event events[LOAD_MAX_EVENTS];
+    while(m_keepRunning)
+    {
+        int n = epoll_wait(m_epollFd, events, LOAD_MAX_EVENTS, -1);
+        for(int i = 0; i < n; i++)
+        {
+            int fd = events[i].data.fd;
+            if(fd == m_wakeFd)
+            {
+                continue;
+            }
+            if(fd != m_socket)
+            {
+                readRequest(fd);
+            }
+            else if(m_protocol == HM_LOAD_DNS)
+            {
+                answerQuery();
+            }
+            else
+            {
+                acceptConnections();
+            }
+        }
+    }
+}
+
+void
+HMLoadResponder::acceptConnections()
+{
+    while(true)
+    {
+        sockaddr_in local;
+        socklen_t len = sizeof(local);
+        int fd = accept4(m_socket, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if(fd < 0)
+        {
+            return;
+        }
+        if(getsockname(fd, (sockaddr*)&local, &len) < 0)
+        {
+            close(fd);
+            continue;
+        }
+        if(m_protocol == HM_LOAD_TCP)
+        {
+            record(ntohl(local.sin_addr.s_addr));
+            close(fd);
+            continue;
+        }
+        epoll_event ev;
+        memset(&ev, 0, sizeof(ev));
+        ev.events = EPOLLIN;
+        ev.data.fd = fd;
+        epoll_ctl(m_epollFd, EPOLL_CTL_ADD, fd, &ev);
+        m_buffers[fd].clear();
+    }
+}
+
+void
+HMLoadResponder::readRequest(int fd)
+{
+    char buf[4096];
+    string& request = m_buffers[fd];
+    ssize_t rc;
+    while((rc = recv(fd, buf, sizeof(buf), 0)) > 0)
+    {
+        request.append(buf, rc);
+    }
+    bool complete = (request.find("\r\n\r\n") != string::npos);
+    if(complete)
+    {
+        sockaddr_in local;
+        socklen_t len = sizeof(local);
+        if(getsockname(fd, (sockaddr*)&local, &len) == 0)
+        {
+            record(ntohl(local.sin_addr.s_addr));
+        }
+        if(send(fd, loadHTTPResponse, sizeof(loadHTTPResponse) - 1, MSG_NOSIGNAL) < 0)
+        {
+            // The client gave up on the check
+        }
+    }
+    if(complete || rc == 0 || (rc < 0 && errno != EAGAIN && errno != EWOULDBLOCK))
+    {
+        epoll_ctl(m_epollFd, EPOLL_CTL_DEL, fd, nullptr);
+        close(fd);
+        m_buffers.erase(fd);
+    }
+}
+
+void
+HMLoadResponder::answerQuery()
+{
+    while(true)
+    {
+        unsigned char packet[LOAD_DNS_PACKET];
+        char control[CMSG_SPACE(sizeof(in_pktinfo))];
+        sockaddr_in peer;
+        iovec iov = { packet, sizeof(packet) };
+        msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_name = &peer;
+        msg.msg_namelen = sizeof(peer);
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+        ssize_t size = recvmsg(m_socket, &msg, 0);
+        if(size < 0)
+        {
+            return;
+        }
+        // Only answer plain queries with a single question
+        if(size < 12 || (packet[2] & 0x80) || packet[4] != 0 || packet[5] != 1)
+        {
+            continue;
+        }
+        size_t pos = 12;
+        while(pos < (size_t)size && packet[pos] != 0)
+        {
+            pos += packet[pos] + 1;
+        }
+        if(pos + 5 > (size_t)size)
+        {
+            continue;
+        }
+        uint16_t qtype = (packet[pos + 1] << 8) | packet[pos + 2];
+        size_t questionEnd = pos + 5;
+
+        in_pktinfo pktinfo;
+        memset(&pktinfo, 0, sizeof(pktinfo));
+        for(cmsghdr* cmsg = CMSG_FIRSTHDR(&msg); cmsg != nullptr; cmsg = CMSG_NXTHDR(&msg, cmsg))
+        {
+            if(cmsg->cmsg_level == IPPROTO_IP && cmsg->cmsg_type == IP_PKTINFO)
+            {
+                memcpy(&pktinfo, CMSG_DATA(cmsg), sizeof(pktinfo));
+            }
+        }
+        record(ntohl(pktinfo.ipi_addr.s_addr));
+
+        // Build the response in place: QR, RD copied, RA, no error
+        size_t length = questionEnd;
+        packet[2] = 0x80 | (packet[2] & 0x01);
+        packet[3] = 0x80;
+        packet[6] = 0;
+        packet[7] = 0;
+        packet[8] = 0;
+        packet[9] = 0;
+        packet[10] = 0;
+        packet[11] = 0;
+        if(qtype == 1 && length + 16 <= sizeof(packet))
+        {
+            static const unsigned char answer[16] = { 0xC0, 0x0C, 0x00, 0x01, 0x00, 0x01, 0x00, 0x00, 0x00, 0x3C,
+                    0x00, 0x04, 127, 0, 0, 1 };
+            memcpy(packet + length, answer, sizeof(answer));
+            length += sizeof(answer);
+            packet[7] = 1;
+        }
+
+        iov.iov_len = length;
+        pktinfo.ipi_ifindex = 0;
+        pktinfo.ipi_spec_dst = pktinfo.ipi_addr;
+        memset(control, 0, sizeof(control));
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+        cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+        cmsg->cmsg_level = IPPROTO_IP;
+        cmsg->cmsg_type = IP_PKTINFO;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(pktinfo));
+        memcpy(CMSG_DATA(cmsg), &pktinfo, sizeof(pktinfo));
+        msg.msg_namelen = sizeof(peer);
+        if(sendmsg(m_socket, &msg, 0) < 0)
+        {
+            // The lookup times out on the client side
+        }
+    }
+}
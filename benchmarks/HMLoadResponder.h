@@ -0,0 +1,97 @@
+// Copyright 2019, Oath Inc.
+// Licensed under the terms of the Apache 2.0 license. See LICENSE file in the root of the distribution for licensing details.
+#ifndef HMLOADRESPONDER_H_
+#define HMLOADRESPONDER_H_
+
+#include <inttypes.h>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <mutex>
+#include <thread>
+#include <atomic>
+
+#include "HMTimeStamp.h"
+
+//! The protocols answered by the load responders.
+enum HM_LOAD_PROTOCOL
+{
+    HM_LOAD_TCP,
+    HM_LOAD_HTTP,
+    HM_LOAD_DNS
+};
+
+//! Loopback server answering the health checks of the load harness.
+/*!
+     Listens on all the addresses with an ephemeral port so every 127.0.0.0/8 address can be used as a distinct host.
+     TCP connections are accepted and closed, HTTP requests get a 200 OK and DNS queries for A records get 127.0.0.1.
+     The time of every check is recorded per destination address to measure the interval between the checks of a host.
+ */
+class HMLoadResponder
+{
+public:
+    HMLoadResponder(HM_LOAD_PROTOCOL protocol) :
+        m_protocol(protocol),
+        m_port(0),
+        m_socket(-1),
+        m_epollFd(-1),
+        m_wakeFd(-1),
+        m_keepRunning(false),
+        m_requests(0),
+        m_recording(false) {};
+
+    ~HMLoadResponder();
+
+    HMLoadResponder(const HMLoadResponder&) = delete;
+    HMLoadResponder& operator=(const HMLoadResponder&) = delete;
+
+    //! Bind the responder and start its thread.
+    bool start();
+
+    //! Stop the responder thread.
+    void shutDown();
+
+    //! Get the port the responder listens on.
+    uint16_t getPort() const { return m_port; }
+
+    //! Get the name of the protocol.
+    std::string getName() const;
+
+    //! Get the number of checks answered.
+    uint64_t getRequests() const { return m_requests; }
+
+    //! Start recording the check intervals, the checks before are only counted.
+    void startRecording();
+
+    //! Get the intervals in ms between the consecutive checks of the same host since startRecording.
+    void getIntervals(std::vector<int64_t>& intervals);
+
+private:
+
+    //! Record a check to the given destination address.
+    void record(uint32_t address);
+
+    void run();
+    void acceptConnections();
+    void readRequest(int fd);
+    void answerQuery();
+
+    HM_LOAD_PROTOCOL m_protocol;
+    uint16_t m_port;
+    int m_socket;
+    int m_epollFd;
+    int m_wakeFd;
+    std::atomic<bool> m_keepRunning;
+    std::atomic<uint64_t> m_requests;
+    std::thread m_thread;
+
+    //! The partial HTTP requests keyed by socket.
+    std::unordered_map<int, std::string> m_buffers;
+
+    std::mutex m_recordMutex;
+    bool m_recording;
+    std::unordered_map<uint32_t, HMTimeStamp> m_lastCheck;
+    std::vector<int64_t> m_intervals;
+};
+
+#endif /* HMLOADRESPONDER_H_ */
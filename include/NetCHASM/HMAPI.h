@@ -224,6 +224,9 @@ public:
     uint64_t m_start;
     uint64_t m_end;
     uint32_t m_responseTime;
+    uint32_t m_tcpConnectTime;
+    uint32_t m_tlsHandshakeTime;
+    uint32_t m_responseTimeMicros;
     uint32_t m_totalResponseTime;
     uint32_t m_minResponseTime;
     uint32_t m_maxResponseTime;
@@ -320,8 +323,122 @@ public:
 class HMAPIThreadInfo
 {
 public:
+    HMAPIThreadInfo() :
+        m_numThreads(0),
+        m_numIdleThreads(0),
+        m_minThreads(0),
+        m_maxThreads(0),
+        m_targetThreads(0),
+        m_queueWaitP50(0),
+        m_queueWaitP99(0),
+        m_utilisation(0),
+        m_numGrows(0),
+        m_numShrinks(0),
+        m_numRecycles(0),
+        m_residentMemory(0),
+        m_openFiles(0) {}
     uint64_t m_numThreads;
     uint64_t m_numIdleThreads;
+    uint64_t m_minThreads;
+    uint64_t m_maxThreads;
+    //! The pool size the controller picked on the last monitor interval.
+    uint64_t m_targetThreads;
+    //! The median queue wait in ms over the last monitor interval.
+    uint64_t m_queueWaitP50;
+    //! The 99th percentile queue wait in ms over the last monitor interval.
+    uint64_t m_queueWaitP99;
+    //! The percent of the last monitor interval the workers were busy.
+    uint32_t m_utilisation;
+    uint64_t m_numGrows;
+    uint64_t m_numShrinks;
+    uint64_t m_numRecycles;
+    //! The resident memory of the daemon in kB.
+    uint64_t m_residentMemory;
+    //! The number of descriptors open by the daemon.
+    uint64_t m_openFiles;
+};
+
+//! API class to hold the storage commit queue information.
+class HMAPIStoreInfo
+{
+public:
+    HMAPIStoreInfo() :
+        m_queueSize(0),
+        m_batchSize(0),
+        m_overflowPolicy(0),
+        m_checksQueued(0),
+        m_checksEnqueued(0),
+        m_checksDropped(0),
+        m_checksBlocked(0),
+        m_checksCoalesced(0),
+        m_checkBatches(0),
+        m_auxQueued(0),
+        m_auxEnqueued(0),
+        m_auxDropped(0),
+        m_auxBlocked(0),
+        m_auxCoalesced(0),
+        m_auxBatches(0) {}
+    //! The number of updates each commit queue can hold.
+    uint64_t m_queueSize;
+    //! The max number of updates drained from a commit queue at once.
+    uint32_t m_batchSize;
+    //! What is done with an update when a commit queue is full. 0 to block, 1 to drop the oldest update.
+    uint32_t m_overflowPolicy;
+    uint64_t m_checksQueued;
+    uint64_t m_checksEnqueued;
+    uint64_t m_checksDropped;
+    //! The number of times a check waited for room in the queue.
+    uint64_t m_checksBlocked;
+    //! The number of updates replaced by a newer update for the same host and address in a batch.
+    uint64_t m_checksCoalesced;
+    uint64_t m_checkBatches;
+    uint64_t m_auxQueued;
+    uint64_t m_auxEnqueued;
+    uint64_t m_auxDropped;
+    uint64_t m_auxBlocked;
+    uint64_t m_auxCoalesced;
+    uint64_t m_auxBatches;
+};
+
+//! API class to hold the queue information of a work class.
+class HMAPIWorkClassInfo
+{
+public:
+    HMAPIWorkClassInfo() :
+        m_weight(0),
+        m_depth(0),
+        m_dequeued(0),
+        m_totalWait(0),
+        m_oldestWait(0),
+        m_starved(0) {}
+    std::string m_name;
+    //! The share of the workers the class gets when work is queued.
+    uint32_t m_weight;
+    //! The number of work of the class queued.
+    uint64_t m_depth;
+    //! The number of work of the class taken from the queue.
+    uint64_t m_dequeued;
+    //! The total time in microseconds the work taken from the queue waited.
+    uint64_t m_totalWait;
+    //! The time in microseconds the oldest queued work of the class has waited.
+    uint64_t m_oldestWait;
+    //! The number of work taken ahead of the weights because it waited past the starvation time.
+    uint64_t m_starved;
+};
+
+//! API class to hold the work queue information.
+class HMAPIWorkQueueInfo
+{
+public:
+    HMAPIWorkQueueInfo() :
+        m_queueSize(0),
+        m_numShards(0),
+        m_starvationTime(0) {}
+    uint64_t m_queueSize;
+    uint32_t m_numShards;
+    //! The time in ms work can wait before its class is served ahead of the weights.
+    uint64_t m_starvationTime;
+    std::vector<HMAPIWorkClassInfo> m_classes;
 };
 
 //! API class to hold the data host check information.
@@ -31,6 +31,13 @@ public:
      */
     bool getThreadInfo(HMAPIThreadInfo& threadInfo);
 
+    /*!
+     Get the storage commit queue info of the daemon.
+     \param the HMAPIStoreInfo to fill.
+     \return true if the struct was filled correctly.
+     */
+    bool getStoreInfo(HMAPIStoreInfo& storeInfo);
+
     /*!
          Get the work queue length of the daemon.
          \param the variable to assign the length.
@@ -38,6 +45,13 @@ public:
      */
     bool getWorkQueue(uint32_t &workQLen);
 
+    /*!
+         Get the work queue info of the daemon, with the queue depth, wait and weight of each work class.
+         \param the HMAPIWorkQueueInfo to fill.
+         \return true if the struct was filled correctly.
+     */
+    bool getWorkQueueInfo(HMAPIWorkQueueInfo& workQueueInfo);
+
     /*!
          Get the schedule information of a host.
          \param hostGroupName to get the schedule info.
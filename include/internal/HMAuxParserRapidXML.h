@@ -31,7 +31,7 @@ public:
      \param hostname the hostname to use in the key.
      \param sourceURL the url to use in the key.
      \param address the address to use in the key.
-     \param string containing the xml to parse.
+     \param string containing the xml to parse, it is parsed in place and left modified.
      \param auxInfo to store the xml.
      \return bool true if the xml resulted in a new cache entry,
      */
@@ -0,0 +1,84 @@
+// Copyright 2019, Oath Inc.
+// Licensed under the terms of the Apache 2.0 license. See LICENSE file in the root of the distribution for licensing details.
+#ifndef HMCHECKSCHEDULE_H_
+#define HMCHECKSCHEDULE_H_
+
+#include <atomic>
+#include <cstdint>
+
+#include "HMConstants.h"
+#include "HMMonotonicTime.h"
+
+//! The parameters spreading the health checks over time.
+class HMCheckScheduleConfig
+{
+public:
+    HMCheckScheduleConfig() :
+        m_spreadWindow(HM_DEFAULT_SCHEDULE_SPREAD_WINDOW),
+        m_jitterPercent(HM_DEFAULT_SCHEDULE_JITTER_PERCENT),
+        m_rampUpRate(HM_DEFAULT_SCHEDULE_RAMP_UP_RATE) {};
+
+    //! The max window in ms the checks due at the same time are spread over, capped by the check TTL. 0 to disable.
+    uint64_t m_spreadWindow;
+    //! The max percent of the time to a scheduled check added as random delay. 0 to disable.
+    uint32_t m_jitterPercent;
+    //! The max number of checks per second started by a start or reload. 0 for no limit.
+    uint32_t m_rampUpRate;
+};
+
+//! Spreads the health checks so they do not all start at once.
+/*!
+     Spreads the health checks so they do not all start at once after a start, a reload or a new host group.
+     Each check due at the same time gets a phase in the spread window from the hash of its host, check and address,
+     so the same check always lands at the same offset and the load is flat over the window.
+     The checks of a start or reload are also handed ramp up slots at the configured rate, the phase is added to the slot.
+     The jitter adds a random delay to every scheduled check so the checks with the same TTL drift apart over time.
+     The config can change while the checks are scheduled, every value is read atomically.
+ */
+class HMCheckSchedule
+{
+public:
+    HMCheckSchedule() :
+        m_spreadWindow(HM_DEFAULT_SCHEDULE_SPREAD_WINDOW),
+        m_jitterPercent(HM_DEFAULT_SCHEDULE_JITTER_PERCENT),
+        m_rampInterval(0),
+        m_rampNext(0) {};
+
+    HMCheckSchedule(const HMCheckSchedule&) = delete;
+    HMCheckSchedule& operator=(const HMCheckSchedule&) = delete;
+
+    //! Set the schedule parameters.
+    /*!
+         Set the schedule parameters. The ramp up restarts from now.
+         \param the schedule parameters.
+     */
+    void setConfig(const HMCheckScheduleConfig& config);
+
+    //! Get the time to start a due check.
+    /*!
+         Get the time to start a due check, its ramp up slot if rampUp is set plus its phase in the spread window.
+         \param the hash of the check, used to pick the phase.
+         \param the TTL of the check in ms, the spread window never goes past it.
+         \param true to take a ramp up slot, for the checks of a start or reload.
+         \return the time to start the check, now if it is not spread.
+     */
+    HMMonotonicTime spread(uint64_t hash, uint64_t ttl, bool rampUp);
+
+    //! Add the jitter to a scheduled check.
+    /*!
+         Add the jitter to a scheduled check.
+         \param the time the check is scheduled.
+         \return the time delayed by up to the jitter percent of the time from now.
+     */
+    HMMonotonicTime jitter(HMMonotonicTime timeStamp) const;
+
+private:
+    std::atomic<uint64_t> m_spreadWindow;
+    std::atomic<uint32_t> m_jitterPercent;
+    //! The time between two ramp up slots in microseconds, 0 for no ramp up.
+    std::atomic<uint64_t> m_rampInterval;
+    //! The next free ramp up slot in microseconds.
+    std::atomic<uint64_t> m_rampNext;
+};
+
+#endif /* HMCHECKSCHEDULE_H_ */
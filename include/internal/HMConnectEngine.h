@@ -0,0 +1,277 @@
+// Copyright 2019, Oath Inc.
+// Licensed under the terms of the Apache 2.0 license. See LICENSE file in the root of the distribution for licensing details.
+#ifndef HMCONNECTENGINE_H_
+#define HMCONNECTENGINE_H_
+
+#include <string>
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <atomic>
+
+#include <openssl/ssl.h>
+
+#include "HMConstants.h"
+#include "HMIPAddress.h"
+#include "HMMonotonicTime.h"
+#include "HMTLSSessionCache.h"
+
+class HMConnectRequest;
+
+//! Callback used by the connect engine to hand a finished request back to its owner.
+typedef void (*HMConnectCallback)(HMConnectRequest& request, void* arg);
+
+//! A single non-blocking TCP connect, with an optional TLS handshake and banner read, run by the connect engine.
+/*!
+     The request is owned by the caller and must stay valid until the callback is called.
+     The input parameters are filled in before submitting the request, the engine fills in the results before the callback.
+ */
+class HMConnectRequest
+{
+public:
+    HMConnectRequest() :
+        m_port(0),
+        m_tos(0),
+        m_connectTimeout(HM_DEFAULT_CHECK_TIMEOUT),
+        m_readSize(0),
+        m_readTimeout(HM_DEFAULT_CHECK_TIMEOUT),
+        m_sslCtx(nullptr),
+        m_callback(nullptr),
+        m_arg(nullptr),
+        m_reason(HM_REASON_NONE),
+        m_sessionReused(false),
+        m_clientPort(-1) {};
+
+    //! The address to connect to.
+    HMIPAddress m_address;
+    //! The source address to bind to, if set.
+    HMIPAddress m_sourceAddress;
+    //! The port to connect to.
+    uint16_t m_port;
+    //! The TOS value to mark the socket with, 0 to leave it unset.
+    uint8_t m_tos;
+    //! The time in ms to wait for the connection to be established.
+    uint64_t m_connectTimeout;
+    //! The number of bytes to read after connecting. 0 to only connect.
+    uint32_t m_readSize;
+    //! The time in ms to wait for the banner read to complete after connecting.
+    uint64_t m_readTimeout;
+    //! The SSL context to run a TLS handshake with after connecting, nullptr for a plain TCP connect.
+    SSL_CTX* m_sslCtx;
+    //! The function to call upon completion.
+    HMConnectCallback m_callback;
+    //! The argument passed to the callback.
+    void* m_arg;
+
+    //! The result of the request.
+    HM_REASON m_reason;
+    //! The time the connect was started.
+    HMMonotonicTime m_start;
+    //! The time the TCP connection was established.
+    HMMonotonicTime m_connectTime;
+    //! The time the TLS handshake completed.
+    HMMonotonicTime m_handshakeTime;
+    //! True if the TLS handshake resumed a cached session.
+    bool m_sessionReused;
+    //! The local port of the connection.
+    int m_clientPort;
+    //! The data read from the connection.
+    std::string m_data;
+    //! The error message on an internal error.
+    std::string m_errorMsg;
+};
+
+//! Event driven engine to multiplex non-blocking TCP connects.
+/*!
+     Runs a small number of threads each driving an epoll instance. Each thread can track tens of thousands
+     of sockets waiting on a SYN-ACK, a TLS handshake or a banner read, so a TCP or TCPS health check no longer
+     holds a worker thread for the duration of the connect. Completed requests are handed back through the request
+     callback, which is called on the engine thread and should only move the work back onto the work queue.
+     The TLS handshakes run on the non-blocking sockets, driven by the events SSL_connect asks for. The session of
+     each target is cached so the next check of the target resumes it. A TLS 1.3 server only sends its session
+     ticket after the handshake, so a connection that has none yet is kept open for a short time after the request
+     is handed back to wait for it.
+ */
+class HMConnectEngine
+{
+public:
+    HMConnectEngine(uint32_t nThreads) :
+        m_nThreads(nThreads ? nThreads : 1),
+        m_keepRunning(false),
+        m_nextReactor(0),
+        m_inFlight(0),
+        m_sessionCache(HM_DEFAULT_TLS_SESSION_CACHE_SIZE) {};
+
+    ~HMConnectEngine();
+
+    HMConnectEngine(const HMConnectEngine&) = delete;
+    HMConnectEngine& operator=(const HMConnectEngine&) = delete;
+
+    //! Init and start the engine threads.
+    /*!
+         Init and start the engine threads.
+         \return true if all threads were started.
+     */
+    bool start();
+
+    //! Shutdown the engine threads.
+    /*!
+         Shutdown the engine threads. Requests still in flight are completed with an internal error.
+     */
+    void shutDown();
+
+    //! Submit a request to the engine.
+    /*!
+         Submit a request to the engine. The callback will be called exactly once from an engine thread when the request completes.
+         \param the request to run. It must remain valid until the callback is called.
+         \return false if the engine is not running, in which case the callback is not called.
+     */
+    bool submit(HMConnectRequest& request);
+
+    //! Get the number of requests in flight.
+    /*!
+         Get the number of requests submitted that have not completed.
+         \return the number of requests in flight.
+     */
+    uint64_t getInFlight() const;
+
+    //! Get the number of engine threads.
+    /*!
+         Get the number of engine threads.
+         \return the number of engine threads.
+     */
+    uint32_t getNThreads() const;
+
+    //! Get the TLS session cache.
+    /*!
+         Get the cache of the TLS sessions of the TCPS check targets.
+         \return the session cache.
+     */
+    HMTLSSessionCache& getSessionCache();
+
+private:
+
+    //! The stage of a connection.
+    enum ConnectionState
+    {
+        CONNECT_PENDING,
+        HANDSHAKE_PENDING,
+        READ_PENDING,
+        TICKET_PENDING
+    };
+
+    //! The engine state for a single socket.
+    class Connection
+    {
+    public:
+        Connection(int fd, HMConnectRequest* request) :
+            m_fd(fd),
+            m_request(request),
+            m_state(CONNECT_PENDING),
+            m_nRead(0),
+            m_events(0),
+            m_ssl(nullptr),
+            m_session(nullptr),
+            m_sessionStored(false),
+            m_port(0) {};
+
+        int m_fd;
+        //! The request of the connection, nullptr once handed back while waiting for a session ticket.
+        HMConnectRequest* m_request;
+        ConnectionState m_state;
+        uint32_t m_nRead;
+        //! The epoll events waited for, 0 if the socket is not in the epoll set.
+        uint32_t m_events;
+        SSL* m_ssl;
+        //! The TLS 1.3 session at the end of the handshake, replaced once a ticket comes in.
+        SSL_SESSION* m_session;
+        bool m_sessionStored;
+        //! The target the TLS session is cached for.
+        HMIPAddress m_address;
+        uint16_t m_port;
+        std::multimap<HMMonotonicTime, int>::iterator m_deadline;
+    };
+
+    //! The per thread epoll instance.
+    class Reactor
+    {
+    public:
+        Reactor() :
+            m_epollFd(-1),
+            m_wakeFd(-1) {};
+
+        int m_epollFd;
+        int m_wakeFd;
+        std::thread m_thread;
+
+        std::mutex m_submitMutex;
+        std::vector<HMConnectRequest*> m_submitted;
+
+        std::unordered_map<int, std::unique_ptr<Connection>> m_connections;
+        std::multimap<HMMonotonicTime, int> m_deadlines;
+    };
+
+    //! The engine thread main loop.
+    void run(Reactor* reactor);
+
+    //! Start the connect for a newly submitted request.
+    void startConnect(Reactor* reactor, HMConnectRequest* request);
+
+    //! Process an epoll event on a connection.
+    void handleEvent(Reactor* reactor, int fd, uint32_t events);
+
+    //! Move a connection to the handshake or read stage or complete it once the connect finished.
+    void connected(Reactor* reactor, Connection* conn);
+
+    //! Start the TLS handshake on a connection.
+    void startHandshake(Reactor* reactor, Connection* conn);
+
+    //! Continue the TLS handshake of a connection.
+    void handshake(Reactor* reactor, Connection* conn);
+
+    //! Move a connection to the read stage or complete it if there is nothing to read.
+    void startRead(Reactor* reactor, Connection* conn);
+
+    //! Read the banner data available on the connection.
+    void readData(Reactor* reactor, Connection* conn);
+
+    //! Process the post handshake messages received while waiting for a session ticket.
+    void readTicket(Reactor* reactor, Connection* conn);
+
+    //! Cache the session of a TLS connection if it can be resumed.
+    /*!
+         Cache the session of a TLS connection if it can be resumed.
+         \return true if the session was cached.
+     */
+    bool storeSession(Connection* conn);
+
+    //! Set the events to wait for on a connection.
+    bool watch(Reactor* reactor, Connection* conn, uint32_t events);
+
+    //! Complete all the connections that passed their deadline.
+    void expire(Reactor* reactor);
+
+    //! Reset the deadline of a connection.
+    void setDeadline(Reactor* reactor, Connection* conn, uint64_t timeout);
+
+    //! Hand the request back to the owner and close the connection.
+    void complete(Reactor* reactor, Connection* conn, HM_REASON reason);
+
+    //! Close the connection and free its state.
+    void closeConnection(Reactor* reactor, Connection* conn);
+
+    //! Hand back a request that never got a socket.
+    void fail(HMConnectRequest* request, HM_REASON reason, const std::string& errorMsg);
+
+    uint32_t m_nThreads;
+    std::atomic<bool> m_keepRunning;
+    std::atomic<uint32_t> m_nextReactor;
+    std::atomic<uint64_t> m_inFlight;
+    std::vector<std::unique_ptr<Reactor>> m_reactors;
+    HMTLSSessionCache m_sessionCache;
+};
+
+#endif /* HMCONNECTENGINE_H_ */
@@ -49,7 +49,13 @@ typedef std::multimap<HMDNSTypeMap, HMDataHostCheck> HMWaitList;
 typedef std::multimap<std::pair<std::string,HMDataHostCheck>,HMDataCheckParams, CompareCheckList> HMCheckList;
 
 //! The Current Version of the NetCHASM mdbm structure. Used to verify backend database compatibility.
-const uint8_t HM_MDBM_VERSION = 3;
+const uint8_t HM_MDBM_VERSION = 5;
+//! The last version of the NetCHASM mdbm structure storing each host group check result in a single record. Used to migrate older databases.
+const uint8_t HM_MDBM_VERSION_GROUP_BLOB = 3;
+//! The last version of the NetCHASM mdbm structure storing the host group info without a layout version. Used to migrate older databases.
+const uint8_t HM_MDBM_VERSION_GROUP_INFO = 4;
+//! The number of times to re-read a host group from the backend when it is updated during the read.
+#define HM_MDBM_CHECK_READ_RETRIES 3
 
 //! The Current Version of the Socket data structure. Used to verify data parsing and packing database compatibility.
 const uint8_t HM_CONTROL_SOCKET_VERSION = 1;
@@ -109,6 +115,124 @@ const std::string HM_MASTER_HEALTH_CHECK_COMMAND = "netchasm_status";
 #define HM_DEFAULT_MONITOR_FREQUENCY 2
 //! The Default work to thread ratio. How many healthchecks(work) needs a thread.
 #define HM_WORK_PER_THREAD_RATIO 4
+//! The Default 99th percentile queue wait in ms the thread pool grows to stay under.
+#define HM_DEFAULT_THREAD_TARGET_WAIT 200
+//! The Default worker utilisation percent under which the thread pool can shrink.
+#define HM_DEFAULT_THREAD_LOW_UTILISATION 30
+//! The Default worker utilisation percent over which the thread pool grows when work is queued.
+#define HM_DEFAULT_THREAD_HIGH_UTILISATION 85
+//! The Default percent of the thread pool added on each growth.
+#define HM_DEFAULT_THREAD_GROWTH_PERCENT 25
+//! The Default number of monitor intervals the thread pool must be underused before it shrinks.
+#define HM_DEFAULT_THREAD_SHRINK_INTERVALS 3
+//! The Default percent the resident memory can grow over its baseline before the worker threads are recycled.
+#define HM_DEFAULT_RECYCLE_MEMORY_GROWTH 50
+//! The Default number of descriptors the process can open over its baseline before the worker threads are recycled.
+#define HM_DEFAULT_RECYCLE_FILE_GROWTH 1024
+//! The Default max window in ms the checks due at the same time are spread over by their phase, 0 to start them right away.
+#define HM_DEFAULT_SCHEDULE_SPREAD_WINDOW 0
+//! The Default max percent of the time to a scheduled check added as random delay.
+#define HM_DEFAULT_SCHEDULE_JITTER_PERCENT 0
+//! The max jitter percent, more would let the jitter push a check past the next one.
+#define HM_MAX_SCHEDULE_JITTER_PERCENT 50
+//! The Default max number of checks per second started by a start or reload, 0 for no limit.
+#define HM_DEFAULT_SCHEDULE_RAMP_UP_RATE 0
+//! The Default max number of checks in flight to a destination, 0 for no limit.
+#define HM_DEFAULT_DESTINATION_CONCURRENCY 0
+//! The Default max number of checks per second started to a destination, 0 for no limit.
+#define HM_DEFAULT_DESTINATION_RATE 0
+//! The Default number of checks to a destination that can start at once under the rate limit.
+#define HM_DEFAULT_DESTINATION_BURST 1
+//! The Default prefix length grouping the IPv4 destinations.
+#define HM_DEFAULT_DESTINATION_PREFIX_IPV4 32
+//! The Default prefix length grouping the IPv6 destinations.
+#define HM_DEFAULT_DESTINATION_PREFIX_IPV6 128
+//! The Default time in ms before a check held back by the concurrency limit is tried again.
+#define HM_DEFAULT_DESTINATION_RETRY_DELAY 100
+//! The time in ms between the sweeps dropping the idle destinations of the limiter.
+#define HM_DESTINATION_SWEEP_INTERVAL 10000
+//! The number of buckets of the work queue wait histogram, bucket i holds the waits under 2^i ms.
+#define HM_WORK_QUEUE_WAIT_BUCKETS 24
+//! The number of work classes the work queue is split in, see HM_WORK_CLASS.
+#define HM_WORK_CLASS_COUNT 7
+//! The Default dequeue weight of the work forced from the control socket.
+#define HM_DEFAULT_WORK_WEIGHT_CONTROL 32
+//! The Default dequeue weight of the health checks of the high priority host groups.
+#define HM_DEFAULT_WORK_WEIGHT_HIGH 16
+//! The Default dequeue weight of the health checks of the normal priority host groups.
+#define HM_DEFAULT_WORK_WEIGHT_HEALTHCHECK 8
+//! The Default dequeue weight of the health checks of the low priority host groups.
+#define HM_DEFAULT_WORK_WEIGHT_LOW 2
+//! The Default dequeue weight of the DNS lookups.
+#define HM_DEFAULT_WORK_WEIGHT_DNSLOOKUP 4
+//! The Default dequeue weight of the remote host group and host checks.
+#define HM_DEFAULT_WORK_WEIGHT_REMOTE 4
+//! The Default dequeue weight of the aux fetches.
+#define HM_DEFAULT_WORK_WEIGHT_AUXFETCH 1
+//! The Default time in ms work can wait in the queue before its class is served ahead of the weights, 0 to disable.
+#define HM_DEFAULT_WORK_STARVATION_TIME 1000
+//! The Default number of threads used by the epoll TCP connect engine.
+#define HM_DEFAULT_CONNECT_ENGINE_THREADS 1
+//! The time in ms to wait for the check info to be returned by a TCP check.
+#define HM_DEFAULT_TCP_CHECKINFO_TIMEOUT 30000
+//! The max number of TLS sessions kept by the connect engine for the TCPS check targets.
+#define HM_DEFAULT_TLS_SESSION_CACHE_SIZE 65536
+//! The time in ms a TLS 1.3 connection is kept open after the check to receive the session ticket.
+#define HM_TLS_TICKET_WAIT 1000
+//! The Default number of threads used by the curl multi engine for HTTP/S checks.
+#define HM_DEFAULT_CURL_ENGINE_THREADS 1
+//! The max number of idle connections each curl multi engine thread keeps open.
+#define HM_DEFAULT_CURL_ENGINE_MAX_CONNECTS 10000
+//! The max number of idle curl handles each curl multi engine thread keeps for reuse.
+#define HM_CURL_ENGINE_MAX_IDLE_HANDLES 1024
+//! The Default max size in bytes of a body kept, or read while matching the expected string, by the curl checks.
+#define HM_DEFAULT_MAX_BODY_SIZE 4194304
+//! The Default number of threads used by the epoll DNS resolver.
+#define HM_DEFAULT_DNS_RESOLVER_THREADS 1
+//! The time in ms an ares channel of the DNS resolver can stay unused before it is destroyed.
+#define HM_DNS_RESOLVER_CHANNEL_IDLE_TIME 60000
+//! The Default number of threads running the control socket commands.
+#define HM_DEFAULT_CONTROL_EXECUTOR_THREADS 4
+//! The max number of control socket connections open at once.
+#define HM_DEFAULT_CONTROL_MAX_CONNECTIONS 1024
+//! The time in ms a control socket connection can wait for a command before it is closed.
+#define HM_CONTROL_IDLE_TIMEOUT 3000
+//! The resolution in ms of the first level of the scheduler timing wheel.
+#define HM_TIMER_WHEEL_RESOLUTION 10
+//! The number of bits used to index the slots of each timing wheel level.
+#define HM_TIMER_WHEEL_SLOT_BITS 8
+//! The number of slots on each timing wheel level.
+#define HM_TIMER_WHEEL_SLOTS (1 << HM_TIMER_WHEEL_SLOT_BITS)
+//! The number of levels in the timing wheel.
+#define HM_TIMER_WHEEL_LEVELS 4
+//! The max number of work queue shards. The default is one per core up to this limit.
+#define HM_WORK_QUEUE_MAX_SHARDS 64
+//! The max number of work orders moved at once when a worker steals from another shard.
+#define HM_WORK_QUEUE_STEAL_BATCH 32
+//! The number of shards for the map of work waiting on a continuation.
+#define HM_WORK_MAP_SHARDS 16
+//! The default number of results the Kafka publisher can hold before applying the drop policy.
+#define HM_DEFAULT_PUBLISH_QUEUE_SIZE 65536
+//! The default max number of results the Kafka publisher thread produces between delivery report polls.
+#define HM_DEFAULT_PUBLISH_BATCH_SIZE 1000
+//! The default time in ms the Kafka producer waits to fill a batch before sending it.
+#define HM_DEFAULT_PUBLISH_LINGER 5
+//! The default time in ms a check waits for room in the publisher queue with the block drop policy.
+#define HM_DEFAULT_PUBLISH_BLOCK_TIMEOUT 100
+//! The time in ms to wait for outstanding Kafka deliveries on shutdown.
+#define HM_DEFAULT_PUBLISH_FLUSH_TIMEOUT 10000
+//! The max time in ms to wait for the delivery reports of the Kafka results purged on shutdown.
+#define HM_PUBLISH_PURGE_TIMEOUT 1000
+//! The time in ms the Kafka publisher thread sleeps when it has nothing queued or in flight.
+#define HM_PUBLISH_IDLE_WAIT 1000
+//! The default number of updates each storage queue can hold before applying the overflow policy.
+#define HM_DEFAULT_STORAGE_QUEUE_SIZE 16384
+//! The default max number of updates the storage thread drains from a queue at once.
+#define HM_DEFAULT_STORAGE_BATCH_SIZE 256
+//! The time in ms a blocked check waits before looking at the storage queue again.
+#define HM_STORAGE_BLOCK_WAIT 10
+//! The time in ms the storage thread sleeps when it has nothing queued.
+#define HM_STORAGE_IDLE_WAIT 1000
 
 // We need to use milliseconds for group-threshold and milliseconds for
 // slow-threshold because that's what the current configs expect
@@ -173,6 +297,29 @@ enum HM_STORAGE_COMMIT_POLICY
     HM_STORAGE_COMMIT_ON_TTL
 };
 
+//! What the storage does with an update when its queue is full
+enum HM_STORAGE_OVERFLOW_POLICY : uint8_t
+{
+    HM_STORAGE_OVERFLOW_BLOCK,
+    HM_STORAGE_OVERFLOW_DROP_OLDEST
+};
+
+//! What the publisher does with a result when its queue is full
+enum HM_PUBLISH_DROP_POLICY : uint8_t
+{
+    HM_PUBLISH_DROP_NEWEST,
+    HM_PUBLISH_DROP_OLDEST,
+    HM_PUBLISH_BLOCK
+};
+
+//! The result of handing a message to the Kafka producer
+enum HM_PUBLISH_PRODUCE_STATUS : uint8_t
+{
+    HM_PUBLISH_PRODUCE_OK,
+    HM_PUBLISH_PRODUCE_QUEUE_FULL,
+    HM_PUBLISH_PRODUCE_FAILED
+};
+
 //! The supported lock strategies to the backend
 enum HM_STORAGE_LOCK_POLICY : uint8_t
 {
@@ -192,7 +339,10 @@ enum HM_CHECK_PLUGIN_CLASS : uint8_t
     HM_CHECK_PLUGIN_AUX_CURL,
     HM_CHECK_PLUGIN_HTTP_LIBEVENT,
     HM_CHECK_PLUGIN_TCPS_RAW,
-    HM_CHECK_PLUGIN_MARK_CURL
+    HM_CHECK_PLUGIN_MARK_CURL,
+    HM_CHECK_PLUGIN_TCP_EPOLL,
+    HM_CHECK_PLUGIN_HTTP_CURL_MULTI,
+    HM_CHECK_PLUGIN_TCPS_EPOLL
 };
 
 //! The supported health check types.
@@ -283,6 +433,27 @@ enum HM_WORK_TYPE : uint8_t
     HM_WORK_REMOTEHOSTCHECK,
 };
 
+//! The classes the work queue shares the workers between. HM_WORK_CLASS_DEFAULT picks the class from the work type.
+enum HM_WORK_CLASS : uint8_t
+{
+    HM_WORK_CLASS_CONTROL,
+    HM_WORK_CLASS_HIGH,
+    HM_WORK_CLASS_HEALTHCHECK,
+    HM_WORK_CLASS_LOW,
+    HM_WORK_CLASS_DNSLOOKUP,
+    HM_WORK_CLASS_REMOTE,
+    HM_WORK_CLASS_AUXFETCH,
+    HM_WORK_CLASS_DEFAULT
+};
+
+//! The priority of the health checks of a host group.
+enum HM_WORK_PRIORITY : uint8_t
+{
+    HM_WORK_PRIORITY_NORMAL,
+    HM_WORK_PRIORITY_HIGH,
+    HM_WORK_PRIORITY_LOW
+};
+
 //! The supported aux data types.
 enum HM_AUX_DATA_TYPE : uint8_t
 {
@@ -362,12 +533,14 @@ enum HM_COMMAND_TASKS
 {
     RELOAD,
     HOSTGROUPINFO,
+    HOSTGROUPDELTA,
     LOADFBINFO,
     LOADFBINFOHOST,
     LOADFBINFOIP,
     THREADINFO,
     WORKQUEUEINFO,
     SCHDQUEUEINFO,
+    STOREINFO,
     SETHOSTSTATUS,
     HOSTGROUPLIST,
     HOSTLIST,
@@ -460,6 +633,10 @@ std::string printCheckTypeConfigs(HM_CHECK_TYPE ct);
 std::string printCheckType(HM_CHECK_TYPE ct);
 //! Print the human readable work type.
 std::string printWorkType(HM_WORK_TYPE work);
+//! Print the human readable work class.
+std::string printWorkClass(HM_WORK_CLASS workClass);
+//! Print the config parser readable work priority.
+std::string printWorkPriority(HM_WORK_PRIORITY priority);
 //! Print the human readable measurement options.
 std::string printMeasurementOptions(uint16_t);
 //! Print the human readable DNS type.
@@ -5,6 +5,7 @@
 
 #include <unistd.h>
 #include <memory>
+#include <atomic>
 
 #include "HMConstants.h"
 #include "HMLogBase.h"
@@ -15,12 +16,14 @@
 const std::string HM_CMD_RELOAD = "reload";
 const std::string HM_CMD_REFRESH = "refresh";
 const std::string HM_CMD_HOSTGROUP = "hostgroup";
+const std::string HM_CMD_HOSTGROUPDELTA = "hostgroupdelta";
 const std::string HM_CMD_LOADFB = "loadfb";
 const std::string HM_CMD_LOADFBIP = "loadfbip";
 const std::string HM_CMD_LOADFBHOST = "loadfbhost";
 const std::string HM_CMD_THREADINFO = "threadinfo";
 const std::string HM_CMD_WORKQUEUEINFO = "workqueueinfo";
 const std::string HM_CMD_SCHDQUEUEINFO = "schdqueueinfo";
+const std::string HM_CMD_STOREINFO = "storeinfo";
 const std::string HM_CMD_SETHOSTSTATUS = "hostset";
 const std::string HM_CMD_HOSTGROUPLIST = "hostgrouplist";
 const std::string HM_CMD_HOSTLIST = "hostlist";
@@ -166,6 +169,20 @@ class HMCommandListenerBase
     */
   std::unique_ptr<char[]> createHostGroup(std::unique_ptr<HMDataPacking>& datapacking, std::string& hostGroupName, uint64_t& buflen, bool verifyHash, const HMHash& hash);
 
+  /*!
+       Called to get the packed health check results of a hostgroup changed since the last fetch of a peer.
+       All the results are packed as a resync if the peer sequence cannot be resumed.
+       \param unique ptr of the data packing class.
+       \param name of the hostgroup
+       \param the epoch of the peer sequence.
+       \param the sequence of the last fetch of the peer.
+       \param size of the packed data.
+       \param Hash data structure, the hostgroup hash of the peer.
+       \return unique pointer containing the data.
+    */
+  std::unique_ptr<char[]> createHostGroupDelta(std::unique_ptr<HMDataPacking>& datapacking, const std::string& hostGroupName,
+          uint64_t epoch, uint64_t sequence, uint64_t& buflen, const HMHash& hash);
+
   /*!
        Called to get the packed load feedback data for a particular hostgroup.
        \param unique ptr of the data packing class.
@@ -252,7 +269,7 @@ class HMCommandListenerBase
   std::unique_ptr<char[]> getHostResults(std::unique_ptr<HMDataPacking>& dataPacking, const std::string& hostName, const HMIPAddress& address, HMDataHostCheck& hostCheck, uint64_t& dataSize);
 
   /*!
-     Called to get the count of the connection handler threads.
+     Called to get the count of the connections open on the listener.
      \param unique ptr of the data packing class.
      \param size of the packed data.
      \return unique pointer containing the data.
@@ -312,9 +329,6 @@ class HMCommandListenerBase
    */
   std::unique_ptr<char[]> getHostMark(std::unique_ptr<HMDataPacking>& dataPacking, uint64_t& dataSize, const std::string& hostGroupName, const std::string& hostName, const HMIPAddress& address);
 
-  //! clean the handler thread after communication completes
-  void cleanHandlerThreads();
-
   /*!
        Called to validate the received command.
        \param command received.
@@ -332,13 +346,10 @@ class HMCommandListenerBase
   // This object will be valid during the lifetime of the command listener
   HMStateManager& m_stateManager;
   bool m_keepRunning;
-  std::thread m_mainThread;
-  std::shared_timed_mutex m_handlerMutex;
+  //! The number of connections open on the listener, maintained by the control reactor.
+  std::atomic<uint32_t> m_connections;
   std::mutex m_exceptionMutex;
   std::mutex m_transactionMutex;
-  std::vector<std::thread> m_handlerThreads;
-  std::map<std::thread::id,bool> m_handlerThreadsStatus;
-  int m_pipesfd[2];
 };
 
 #endif /* HMCOMMANDLISTENERBASE_H */
@@ -5,7 +5,6 @@
 
 #include <inttypes.h>
 #include <string>
-#include <thread>
 
 #include "HMControlBase.h"
 #include "HMConstants.h"
@@ -31,13 +30,6 @@ public:
     void run();
     //! Shutdown listeners
     void listernerShutDown();
-    /*!
-         Handle client communications
-         \param pointer of client socket.
-     */
-    void handleClient(int clientSock);
-    //! Handle client connections
-    void handleConnections();
 
 private:
     int m_socket;
@@ -0,0 +1,237 @@
+// Copyright 2019, Oath Inc.
+// Licensed under the terms of the Apache 2.0 license. See LICENSE file in the root of the distribution for licensing details.
+#ifndef HMCONTROLREACTOR_H_
+#define HMCONTROLREACTOR_H_
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <map>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+
+#include <openssl/ssl.h>
+
+#include "HMConstants.h"
+#include "HMTimeStamp.h"
+#include "HMSocketUtilBase.h"
+
+class HMStateManager;
+class HMCommandListenerBase;
+
+//! Event driven server for the control socket listeners.
+/*!
+     Runs a single epoll thread accepting the connections of all the control socket listeners, Linux, TCP and TLS,
+     so a burst of clients no longer spawns a thread per connection and the number of descriptors is no longer bound
+     by FD_SETSIZE. Each connection is a small state machine driven by the reactor thread: the TLS handshake is run
+     non-blocking, the command frames are read into the connection buffer and the responses are flushed as the socket
+     allows.
+     Complete commands are run by a small bounded pool of executor threads through the unchanged
+     HMCommandListenerBase::handleCommands. The connection itself is the HMSocketUtilBase handed to the handlers,
+     reads wait on the data buffered by the reactor thread and writes are queued for the reactor thread to send,
+     so only the reactor thread touches the sockets and the SSL objects.
+     A connection runs a single command at a time, which bounds the executor queue to the number of connections.
+ */
+class HMControlReactor
+{
+public:
+    HMControlReactor(HMStateManager& stateManager,
+            uint32_t nExecutors = HM_DEFAULT_CONTROL_EXECUTOR_THREADS,
+            uint32_t maxConnections = HM_DEFAULT_CONTROL_MAX_CONNECTIONS) :
+        m_stateManager(stateManager),
+        m_nExecutors(nExecutors ? nExecutors : 1),
+        m_maxConnections(maxConnections),
+        m_epollFd(-1),
+        m_wakeFd(-1),
+        m_keepRunning(false),
+        m_nConnections(0) {};
+
+    ~HMControlReactor();
+
+    HMControlReactor(const HMControlReactor&) = delete;
+    HMControlReactor& operator=(const HMControlReactor&) = delete;
+
+    //! Init and start the reactor and executor threads.
+    /*!
+         Init and start the reactor and executor threads.
+         \return true if all threads were started.
+     */
+    bool start();
+
+    //! Shutdown the reactor and executor threads.
+    /*!
+         Shutdown the reactor and executor threads. The commands running are completed, all the connections are closed.
+     */
+    void shutDown();
+
+    //! Add a listening socket to the reactor.
+    /*!
+         Add a listening socket to the reactor. The connections accepted are served with the listener command handlers.
+         \param the listening socket, it is set non blocking.
+         \param the type of control socket.
+         \param the listener owning the socket. It must stay valid until the reactor is shutdown.
+         \return true if the socket was added.
+     */
+    bool addListener(int sock, HM_CONTROL_SOCKET type, HMCommandListenerBase* listener);
+
+    //! Remove a listening socket from the reactor.
+    /*!
+         Remove a listening socket from the reactor. No more connections are accepted on the socket.
+         \param the listening socket.
+     */
+    void removeListener(int sock);
+
+    //! Get the number of open connections.
+    /*!
+         Get the number of control socket connections open.
+         \return the number of open connections.
+     */
+    uint32_t getConnections() const;
+
+private:
+
+    //! The state of a control connection.
+    enum HM_CONTROL_CONN_STATE
+    {
+        HM_CONTROL_CONN_HANDSHAKE,
+        HM_CONTROL_CONN_OPEN
+    };
+
+    //! A listening socket registered with the reactor.
+    class Listener
+    {
+    public:
+        Listener(HM_CONTROL_SOCKET type, HMCommandListenerBase* listener) :
+            m_type(type),
+            m_listener(listener) {};
+
+        HM_CONTROL_SOCKET m_type;
+        HMCommandListenerBase* m_listener;
+    };
+
+    //! A client connection and the socket util handed to the command handlers.
+    class Connection : public HMSocketUtilBase
+    {
+    public:
+        Connection(HMControlReactor* reactor, HMCommandListenerBase* listener, int sock, bool seqPacket) :
+            HMSocketUtilBase(true, sock, false),
+            m_reactor(reactor),
+            m_listener(listener),
+            m_fd(sock),
+            m_ssl(nullptr),
+            m_seqPacket(seqPacket),
+            m_state(HM_CONTROL_CONN_OPEN),
+            m_events(0),
+            m_registered(false),
+            m_keepOpen(false),
+            m_executing(false),
+            m_closing(false),
+            m_peerClosed(false),
+            m_wantWrite(false),
+            m_outOffset(0) {};
+
+        ~Connection();
+
+        HMControlReactor* m_reactor;
+        HMCommandListenerBase* m_listener;
+        int m_fd;
+        SSL* m_ssl;
+        //! Set for the Linux SOCK_SEQPACKET sockets where every send is a packet.
+        bool m_seqPacket;
+        HM_CONTROL_CONN_STATE m_state;
+        //! The handshake deadline or the idle deadline.
+        HMTimeStamp m_expiry;
+        uint32_t m_events;
+        bool m_registered;
+        bool m_keepOpen;
+        //! Set while an executor runs a command of the connection.
+        bool m_executing;
+        //! Set to close the connection once the running command completes.
+        bool m_closing;
+        //! Set when the peer closed the connection or the socket failed.
+        bool m_peerClosed;
+        //! Set when SSL needs the socket to be writable to make progress.
+        bool m_wantWrite;
+        std::string m_command;
+
+        std::mutex m_bufferMutex;
+        std::condition_variable m_bufferCond;
+        std::string m_in;
+        std::deque<std::string> m_out;
+        size_t m_outOffset;
+
+        void closeSocket();
+
+    private:
+        void reconnect();
+        bool sendData(const char* buffer, uint64_t size);
+        HM_SOCK_DATA_STATUS recvData(char* data, uint64_t size, timeval tv);
+    };
+
+    //! The reactor thread main loop.
+    void run();
+
+    //! The executor threads main loop.
+    void runExecutor();
+
+    //! Accept the pending connections of a listening socket.
+    void acceptConnections(int sock, const Listener& listener);
+
+    //! Progress a connection on a socket event.
+    void processConnection(Connection* conn);
+
+    //! Progress the TLS handshake of a connection.
+    bool handshake(Connection* conn);
+
+    //! Read the available data into the connection buffer.
+    void readConnection(Connection* conn);
+
+    //! Send the queued responses of the connection.
+    void flushConnection(Connection* conn);
+
+    //! Parse the buffered command frames and dispatch the next command.
+    void dispatchCommands(Connection* conn);
+
+    //! Update the epoll events of the connection.
+    void updateEvents(Connection* conn);
+
+    //! Close the connection once it is done, otherwise update its epoll events.
+    void updateConnection(Connection* conn);
+
+    //! Close the expired connections.
+    void processTimeouts();
+
+    //! Close a connection that is not running a command.
+    void closeConnection(Connection* conn);
+
+    //! Called from the executor threads to have the reactor flush or complete a connection.
+    void notify(Connection* conn, bool done);
+
+    HMStateManager& m_stateManager;
+    uint32_t m_nExecutors;
+    uint32_t m_maxConnections;
+    int m_epollFd;
+    int m_wakeFd;
+    std::atomic<bool> m_keepRunning;
+    std::atomic<uint32_t> m_nConnections;
+    std::thread m_thread;
+
+    std::mutex m_listenerMutex;
+    std::map<int, Listener> m_listeners;
+
+    std::unordered_map<int, std::unique_ptr<Connection>> m_connections;
+
+    std::mutex m_notifyMutex;
+    std::vector<std::pair<Connection*, bool>> m_notified;
+
+    std::vector<std::thread> m_executors;
+    std::mutex m_taskMutex;
+    std::condition_variable m_taskCond;
+    std::deque<Connection*> m_tasks;
+};
+
+#endif /* HMCONTROLREACTOR_H_ */
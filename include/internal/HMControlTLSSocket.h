@@ -5,7 +5,6 @@
 
 #include <inttypes.h>
 #include <string>
-#include <thread>
 
 #include "HMControlBase.h"
 #include "HMConstants.h"
@@ -29,21 +28,6 @@ public:
     void run();
     //! Shutdown listeners
     void listernerShutDown();
-    /*!
-          Handle client communications
-          \param Initialized SSL* object.
-     */
-    void handleClient(SSL* ssl);
-    //! Handle client connections
-    void handleConnections();
-    /*!
-          Handle secure accept
-          \param expiry time to wait for the connection to be established.
-          \param connection socket descriptor
-          \param client port for debug info
-     */
-    void secureAccept(HMTimeStamp expiry, int clientSock, int clientport);
-
 
 private:
     int m_socket;
@@ -0,0 +1,125 @@
+// Copyright 2019, Oath Inc.
+// Licensed under the terms of the Apache 2.0 license. See LICENSE file in the root of the distribution for licensing details.
+#ifndef HMCURLBUFFER_H_
+#define HMCURLBUFFER_H_
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "curl/curl.h"
+
+#include "HMConstants.h"
+
+//! Receive buffer shared by the curl fetches.
+/*!
+     The chunks handed over by curl are appended in place to a body pre-sized from the Content-Length of the response,
+     up to the max body size. When an expected string is set it is matched as the chunks come in, keeping the partial
+     match across the chunk boundaries, so a body that is not kept is never buffered and the transfer is stopped as soon
+     as the string is found.
+     A transfer stopped early fails with CURLE_WRITE_ERROR, getResult maps it back to the result the fetch should report.
+ */
+class HMCurlBuffer
+{
+public:
+    HMCurlBuffer() :
+        m_easy(nullptr),
+        m_maxSize(HM_DEFAULT_MAX_BODY_SIZE),
+        m_keepBody(true),
+        m_matchPos(0),
+        m_received(0),
+        m_found(false),
+        m_stopped(false),
+        m_overflow(false) {};
+
+    //! Set what is done with the body of the next fetches.
+    /*!
+         Set what is done with the body of the next fetches and clear the buffer.
+         \param the max number of bytes kept, or read while looking for the expected string.
+         \param true to keep the body, false to only count and match it.
+         \param the string the body is expected to contain, empty to not match the body.
+     */
+    void setParams(uint64_t maxSize, bool keepBody, const std::string& expect = "");
+
+    //! Clear the buffer for a new fetch.
+    /*!
+         Clear the body and the match state for a new fetch, the parameters are kept.
+     */
+    void clear();
+
+    //! Set the curl handle to write the body to the buffer.
+    /*!
+         Set the write callback of the curl handle to append to the buffer.
+         The handle is also used to pre-size the body from the Content-Length of the response.
+         \param the curl handle, nullptr to detach the buffer from its handle.
+     */
+    void attach(CURL* easy);
+
+    //! Append a chunk of the body.
+    /*!
+         Append a chunk of the body and match it against the expected string.
+         \param the chunk received.
+         \param the length of the chunk.
+         \return false if the transfer should be stopped.
+     */
+    bool append(const char* buf, size_t length);
+
+    //! Get the result the fetch should report.
+    /*!
+         Get the result the fetch should report from the curl result.
+         A transfer stopped after the expected string was found is reported as CURLE_OK,
+         a body over the max size as CURLE_FILESIZE_EXCEEDED.
+         \param the curl result of the fetch.
+         \return the result of the fetch.
+     */
+    CURLcode getResult(CURLcode result) const;
+
+    //! Check if the body matched the expectation.
+    /*!
+         Check if the body matched the expectation.
+         \return true if the expected string was found or none was set.
+     */
+    bool isMatched() const;
+
+    //! Get the number of body bytes received.
+    /*!
+         Get the number of body bytes received, kept or not.
+         \return the number of bytes received.
+     */
+    uint64_t getReceived() const;
+
+    //! Get the body.
+    /*!
+         Get the body kept by the buffer.
+         \return the body, empty if the body is not kept.
+     */
+    const std::string& getBody() const;
+
+    //! Hand the body over without a copy.
+    /*!
+         Hand the body over to the caller, the buffer is left empty.
+         \param the string to move the body to.
+     */
+    void releaseBody(std::string& body);
+
+    //! curl write callback appending to the buffer passed as the write data.
+    static size_t curlWrite(void* ptr, size_t size, size_t nmemb, void* arg);
+
+private:
+    CURL* m_easy;
+    uint64_t m_maxSize;
+    bool m_keepBody;
+    std::string m_expect;
+    //! The KMP failure table of the expected string.
+    std::vector<uint32_t> m_prefix;
+    //! The length of the expected string matched by the end of the last chunk.
+    uint32_t m_matchPos;
+
+    std::string m_body;
+    uint64_t m_received;
+    bool m_found;
+    bool m_stopped;
+    bool m_overflow;
+};
+
+#endif /* HMCURLBUFFER_H_ */
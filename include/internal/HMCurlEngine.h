@@ -0,0 +1,243 @@
+// Copyright 2019, Oath Inc.
+// Licensed under the terms of the Apache 2.0 license. See LICENSE file in the root of the distribution for licensing details.
+#ifndef HMCURLENGINE_H_
+#define HMCURLENGINE_H_
+
+#include <string>
+#include <vector>
+#include <unordered_set>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <atomic>
+
+#include "curl/curl.h"
+
+#include "HMConstants.h"
+#include "HMIPAddress.h"
+#include "HMMonotonicTime.h"
+#include "HMTLSIdentity.h"
+#include "HMCurlBuffer.h"
+
+class HMCurlRequest;
+
+//! Callback used by the curl engine to hand a finished request back to its owner.
+typedef void (*HMCurlCallback)(HMCurlRequest& request, void* arg);
+
+//! A single HTTP/S fetch run by the curl engine.
+/*!
+     The request is owned by the caller and must stay valid until the callback is called.
+     The input parameters are filled in before submitting the request, the engine fills in the results before the callback.
+ */
+class HMCurlRequest
+{
+public:
+    HMCurlRequest() :
+        m_tos(0),
+        m_connectTimeout(HM_DEFAULT_CHECK_TIMEOUT),
+        m_timeout(HM_DEFAULT_CHECK_TIMEOUT),
+        m_verifyPeer(true),
+        m_keepAlive(false),
+        m_callback(nullptr),
+        m_arg(nullptr),
+        m_result(CURLE_OK),
+        m_responseCode(0),
+        m_connectTime(0),
+        m_reused(false) {};
+
+    //! The URL to fetch.
+    std::string m_url;
+    //! The extra request headers.
+    std::vector<std::string> m_headers;
+    //! The CURLOPT_CONNECT_TO entry used to pin the connection of an SNI request to the checked address.
+    std::string m_connectTo;
+    //! The source address to bind to, if set.
+    HMIPAddress m_sourceAddress;
+    //! The TOS value to mark the socket with, 0 to leave it unset.
+    uint8_t m_tos;
+    //! The time in ms to wait for the connection to be established.
+    uint64_t m_connectTimeout;
+    //! The time in ms to wait for the whole fetch to complete.
+    uint64_t m_timeout;
+    //! Set to verify the peer certificate.
+    bool m_verifyPeer;
+    //! The CA file used to verify the peer, empty to use the default.
+    std::string m_caFile;
+    //! The client identity for mTLS, nullptr for no client certificate.
+    std::shared_ptr<HMTLSIdentity> m_clientIdentity;
+    //! Set to keep the connection open for the next request to the same target.
+    bool m_keepAlive;
+    //! The function to call upon completion.
+    HMCurlCallback m_callback;
+    //! The argument passed to the callback.
+    void* m_arg;
+
+    //! The curl result of the fetch.
+    CURLcode m_result;
+    //! The response code returned by the server.
+    long m_responseCode;
+    //! The time the fetch was started.
+    HMMonotonicTime m_start;
+    //! The time the fetch completed.
+    HMMonotonicTime m_end;
+    //! The time in microseconds it took to establish the connection, or to get the first response byte on a reused connection.
+    uint64_t m_connectTime;
+    //! Set if the fetch was sent on an already open connection.
+    bool m_reused;
+    //! The response body, kept or only matched against an expected string as set by the caller.
+    HMCurlBuffer m_body;
+};
+
+//! Event driven engine to multiplex HTTP/S checks with curl.
+/*!
+     Runs a small number of threads each driving a curl multi handle over an epoll instance, so an HTTP/S health check
+     no longer holds a worker thread for the duration of the fetch.
+     Requests to the same target are always run on the same thread so a keepalive request can reuse the connection
+     left open by the previous check. The TLS sessions and DNS entries are shared by all the threads so a new connection
+     can resume the TLS session instead of a full handshake. The curl handles are pooled and reused between requests.
+     Completed requests are handed back through the request callback, which is called on the engine thread and should
+     only move the work back onto the work queue.
+ */
+class HMCurlEngine
+{
+public:
+    HMCurlEngine(uint32_t nThreads, uint32_t maxConnects = HM_DEFAULT_CURL_ENGINE_MAX_CONNECTS) :
+        m_nThreads(nThreads ? nThreads : 1),
+        m_maxConnects(maxConnects),
+        m_share(nullptr),
+        m_keepRunning(false),
+        m_inFlight(0),
+        m_reused(0) {};
+
+    ~HMCurlEngine();
+
+    HMCurlEngine(const HMCurlEngine&) = delete;
+    HMCurlEngine& operator=(const HMCurlEngine&) = delete;
+
+    //! Init and start the engine threads.
+    /*!
+         Init and start the engine threads.
+         \return true if all threads were started.
+     */
+    bool start();
+
+    //! Shutdown the engine threads.
+    /*!
+         Shutdown the engine threads. Requests still in flight are completed with CURLE_ABORTED_BY_CALLBACK.
+     */
+    void shutDown();
+
+    //! Submit a request to the engine.
+    /*!
+         Submit a request to the engine. The callback will be called exactly once from an engine thread when the request completes.
+         \param the request to run. It must remain valid until the callback is called.
+         \return false if the engine is not running, in which case the callback is not called.
+     */
+    bool submit(HMCurlRequest& request);
+
+    //! Get the number of requests in flight.
+    /*!
+         Get the number of requests submitted that have not completed.
+         \return the number of requests in flight.
+     */
+    uint64_t getInFlight() const;
+
+    //! Get the number of requests sent on a reused connection.
+    /*!
+         Get the number of requests sent on a connection left open by a previous keepalive request.
+         \return the number of reused connections.
+     */
+    uint64_t getReused() const;
+
+    //! Get the number of engine threads.
+    /*!
+         Get the number of engine threads.
+         \return the number of engine threads.
+     */
+    uint32_t getNThreads() const;
+
+private:
+
+    //! The engine state for a request being fetched.
+    class Transfer
+    {
+    public:
+        Transfer(CURL* easy, HMCurlRequest* request) :
+            m_easy(easy),
+            m_request(request),
+            m_headers(nullptr),
+            m_connectTo(nullptr) {};
+
+        CURL* m_easy;
+        HMCurlRequest* m_request;
+        curl_slist* m_headers;
+        curl_slist* m_connectTo;
+        std::shared_ptr<HMTLSIdentity> m_clientIdentity;
+    };
+
+    //! The per thread curl multi handle and epoll instance.
+    class Reactor
+    {
+    public:
+        Reactor() :
+            m_epollFd(-1),
+            m_wakeFd(-1),
+            m_multi(nullptr),
+            m_timerSet(false) {};
+
+        int m_epollFd;
+        int m_wakeFd;
+        CURLM* m_multi;
+        //! Set if curl asked to be called back at m_timer.
+        bool m_timerSet;
+        HMMonotonicTime m_timer;
+        std::thread m_thread;
+
+        std::mutex m_submitMutex;
+        std::vector<HMCurlRequest*> m_submitted;
+
+        std::unordered_set<Transfer*> m_transfers;
+        std::vector<CURL*> m_idleHandles;
+    };
+
+    //! The engine thread main loop.
+    void run(Reactor* reactor);
+
+    //! Setup a curl handle for a newly submitted request and add it to the multi handle.
+    void startTransfer(Reactor* reactor, HMCurlRequest* request);
+
+    //! Hand back the requests curl finished.
+    void processCompleted(Reactor* reactor);
+
+    //! Release the curl handle and hand the request back to the owner.
+    void complete(Reactor* reactor, Transfer* transfer, CURLcode result);
+
+    //! Hand back a request that never got a curl handle.
+    void fail(HMCurlRequest* request, CURLcode result);
+
+    //! Release the resources of a reactor.
+    void cleanupReactor(Reactor* reactor);
+
+    //! curl callback to track the sockets in epoll.
+    static int socketCallback(CURL* easy, curl_socket_t fd, int what, void* arg, void* socketArg);
+
+    //! curl callback to set the timeout of the multi handle.
+    static int timerCallback(CURLM* multi, long timeout, void* arg);
+
+    //! curl callback to lock the shared TLS session and DNS caches.
+    static void lockCallback(CURL* easy, curl_lock_data data, curl_lock_access access, void* arg);
+
+    //! curl callback to unlock the shared TLS session and DNS caches.
+    static void unlockCallback(CURL* easy, curl_lock_data data, void* arg);
+
+    uint32_t m_nThreads;
+    uint32_t m_maxConnects;
+    CURLSH* m_share;
+    std::mutex m_shareMutex[CURL_LOCK_DATA_LAST];
+    std::atomic<bool> m_keepRunning;
+    std::atomic<uint64_t> m_inFlight;
+    std::atomic<uint64_t> m_reused;
+    std::vector<std::unique_ptr<Reactor>> m_reactors;
+};
+
+#endif /* HMCURLENGINE_H_ */
@@ -115,9 +115,9 @@ public:
          Get the next resolution time based on the timeout
          \param the host to resolve.
          \param structure holding DNS type and address type(v4 or v6).
-         \return the HMTimeStamp of the next time to schedule a DNS resolution.
+         \return the HMMonotonicTime of the next time to schedule a DNS resolution.
      */
-    HMTimeStamp nextQueryTime(const std::string& name, const HMDNSLookup& dnsHostCheck) const;
+    HMMonotonicTime nextQueryTime(const std::string& name, const HMDNSLookup& dnsHostCheck) const;
 
     //! Start aDNS query.
     /*!
@@ -134,12 +134,16 @@ public:
          \param the hostname to resolve.
          \param structure holding DNS type and address type(v4 or v6).
          \param the work queue to insert the DNS resolution work.
+         \param the event loop to hold the query back in if the resolver is over the limits, nullptr to queue it regardless.
+         \param true for a query forced from the control socket, queued in the control work class.
      */
-    void queueDNSQuery(std::string name, HMDNSLookup& dnsHostCheck, HMWorkQueue& queue);
+    void queueDNSQuery(std::string name, HMDNSLookup& dnsHostCheck, HMWorkQueue& queue, HMEventLoop* eventLoop = nullptr,
+            bool control = false);
 
     //! Queue all the DNS lookups.
     /*!
          Queue all the DNS lookups. Called at cold start to get all the hostnames resolved.
+         The lookups over the resolver limits of the work queue are scheduled to be tried again in the event loop.
          \param the work queue to insert the resolutions.
          \param the event loop to insert any needed timeouts for DNS resolutions that were loaded from storage.
          \param true if this is a restart during a running daemon config reload.
@@ -0,0 +1,273 @@
+// Copyright 2019, Oath Inc.
+// Licensed under the terms of the Apache 2.0 license. See LICENSE file in the root of the distribution for licensing details.
+#ifndef HMDNSRESOLVER_H_
+#define HMDNSRESOLVER_H_
+
+#include <string>
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <atomic>
+
+#include "ares.h"
+
+#include "HMConstants.h"
+#include "HMIPAddress.h"
+#include "HMMonotonicTime.h"
+
+class HMDNSRequest;
+
+//! Callback used by the resolver to hand a finished lookup back to its owner.
+typedef void (*HMDNSCallback)(HMDNSRequest& request, void* arg);
+
+//! A single DNS lookup run by the resolver.
+/*!
+     The request is owned by the caller and must stay valid until the callback is called.
+     The input parameters are filled in before submitting the request, the resolver fills in the results before the callback.
+ */
+class HMDNSRequest
+{
+public:
+    HMDNSRequest() :
+        m_family(AF_INET),
+        m_port(0),
+        m_useTCP(false),
+        m_timeout(HM_DEFAULT_DNS_RESOLUTION_TIMEOUT),
+        m_tries(HM_DEFAULT_DNS_RETRIES),
+        m_callback(nullptr),
+        m_arg(nullptr),
+        m_status(ARES_SUCCESS),
+        m_timeouts(0) {};
+
+    //! The name to resolve.
+    std::string m_hostname;
+    //! The address family to resolve, AF_INET or AF_INET6.
+    int m_family;
+    //! The DNS server to query, unset to use the system resolver configuration.
+    HMIPAddress m_server;
+    //! The DNS server port, 0 for the default port.
+    uint16_t m_port;
+    //! Set to query the server over TCP.
+    bool m_useTCP;
+    //! The source address to bind to, if set.
+    HMIPAddress m_sourceAddress;
+    //! The time in ms to wait for each try.
+    uint64_t m_timeout;
+    //! The number of tries per server.
+    uint32_t m_tries;
+    //! The function to call upon completion.
+    HMDNSCallback m_callback;
+    //! The argument passed to the callback.
+    void* m_arg;
+
+    //! The ares status of the lookup.
+    int m_status;
+    //! The number of tries that timed out.
+    int m_timeouts;
+    //! The official name of the resolved host.
+    std::string m_name;
+    //! The resolved addresses.
+    std::vector<HMIPAddress> m_addresses;
+    //! The time the lookup was started.
+    HMMonotonicTime m_start;
+    //! The time the lookup completed.
+    HMMonotonicTime m_end;
+};
+
+//! The lookup counters of a single DNS server.
+class HMDNSServerStats
+{
+public:
+    HMDNSServerStats() :
+        m_queries(0),
+        m_success(0),
+        m_notFound(0),
+        m_timeouts(0),
+        m_failures(0),
+        m_totalTime(0) {};
+
+    //! The number of lookups completed.
+    uint64_t m_queries;
+    //! The number of lookups that resolved.
+    uint64_t m_success;
+    //! The number of lookups for names that don't exist.
+    uint64_t m_notFound;
+    //! The number of lookups that timed out.
+    uint64_t m_timeouts;
+    //! The number of lookups that failed otherwise.
+    uint64_t m_failures;
+    //! The sum of the lookup times in ms.
+    uint64_t m_totalTime;
+};
+
+//! Event driven service to run the DNS lookups and DNS health checks with c-ares.
+/*!
+     Runs a small number of threads each driving long lived ares channels over an epoll instance, so a DNS lookup
+     no longer holds a worker thread and no longer creates a channel per health check.
+     Each thread keeps one channel per distinct server, port, protocol, source address and timeout. A channel can run
+     thousands of concurrent lookups, and is destroyed once it stayed idle for HM_DNS_RESOLVER_CHANNEL_IDLE_TIME.
+     Completed lookups are handed back through the request callback, which is called on the resolver thread and should
+     only store the result and move the work back onto the work queue.
+ */
+class HMDNSResolver
+{
+public:
+    HMDNSResolver(uint32_t nThreads) :
+        m_nThreads(nThreads ? nThreads : 1),
+        m_keepRunning(false),
+        m_stopped(true),
+        m_nextReactor(0),
+        m_inFlight(0) {};
+
+    ~HMDNSResolver();
+
+    HMDNSResolver(const HMDNSResolver&) = delete;
+    HMDNSResolver& operator=(const HMDNSResolver&) = delete;
+
+    //! Init and start the resolver threads.
+    /*!
+         Init and start the resolver threads.
+         \return true if all threads were started.
+     */
+    bool start();
+
+    //! Shutdown the resolver threads.
+    /*!
+         Shutdown the resolver threads. Lookups still in flight are completed with ARES_EDESTRUCTION.
+     */
+    void shutDown();
+
+    //! Submit a lookup to the resolver.
+    /*!
+         Submit a lookup to the resolver. The callback will be called exactly once from a resolver thread when the lookup completes.
+         \param the lookup to run. It must remain valid until the callback is called.
+         \return false if the resolver is not running, in which case the callback is not called.
+     */
+    bool submit(HMDNSRequest& request);
+
+    //! Get the number of lookups in flight.
+    /*!
+         Get the number of lookups submitted that have not completed.
+         \return the number of lookups in flight.
+     */
+    uint64_t getInFlight() const;
+
+    //! Get the number of resolver threads.
+    /*!
+         Get the number of resolver threads.
+         \return the number of resolver threads.
+     */
+    uint32_t getNThreads() const;
+
+    //! Get the lookup counters of each DNS server.
+    /*!
+         Get the lookup counters of each DNS server queried. The lookups using the system configuration are reported under "system".
+         \param the map filled with the counters keyed by server.
+     */
+    void getServerStats(std::map<std::string, HMDNSServerStats>& stats);
+
+private:
+
+    class Reactor;
+
+    //! A long lived ares channel and the settings it was created with.
+    class Channel
+    {
+    public:
+        Channel(Reactor* reactor, const std::string& key, const std::string& server) :
+            m_reactor(reactor),
+            m_channel(nullptr),
+            m_key(key),
+            m_server(server),
+            m_pending(0) {};
+
+        Reactor* m_reactor;
+        ares_channel m_channel;
+        std::string m_key;
+        std::string m_server;
+        uint32_t m_pending;
+        HMMonotonicTime m_lastUsed;
+    };
+
+    //! A lookup waiting on a channel.
+    class Query
+    {
+    public:
+        Query(HMDNSResolver* resolver, Channel* channel, HMDNSRequest* request) :
+            m_resolver(resolver),
+            m_channel(channel),
+            m_request(request) {};
+
+        HMDNSResolver* m_resolver;
+        Channel* m_channel;
+        HMDNSRequest* m_request;
+    };
+
+    //! The per thread epoll instance and channels.
+    class Reactor
+    {
+    public:
+        Reactor() :
+            m_epollFd(-1),
+            m_wakeFd(-1) {};
+
+        int m_epollFd;
+        int m_wakeFd;
+        std::thread m_thread;
+
+        std::mutex m_submitMutex;
+        std::vector<HMDNSRequest*> m_submitted;
+
+        std::unordered_map<std::string, std::unique_ptr<Channel>> m_channels;
+        std::unordered_map<int, Channel*> m_sockets;
+        HMMonotonicTime m_lastSweep;
+    };
+
+    //! The resolver thread main loop.
+    void run(Reactor* reactor);
+
+    //! Get or create the channel for the request settings.
+    Channel* getChannel(Reactor* reactor, const HMDNSRequest& request);
+
+    //! Start the lookup for a newly submitted request.
+    void startLookup(Reactor* reactor, HMDNSRequest* request);
+
+    //! Get the time in ms until the next channel timeout, -1 if no lookup is pending.
+    int nextTimeout(Reactor* reactor);
+
+    //! Let the channels with pending lookups process their timeouts.
+    void processTimeouts(Reactor* reactor);
+
+    //! Destroy the channels that have been idle for too long.
+    void sweepChannels(Reactor* reactor);
+
+    //! Record the result and hand the request back to the owner.
+    void complete(Query* query, int status, int timeouts, hostent* host);
+
+    //! Hand back a request that never got a channel.
+    void fail(HMDNSRequest* request, int status);
+
+    //! ares callback to track the channel sockets in epoll.
+    static void socketStateCallback(void* data, ares_socket_t fd, int readable, int writable);
+
+    //! ares callback for a finished lookup.
+    static void hostCallback(void* arg, int status, int timeouts, hostent* host);
+
+    uint32_t m_nThreads;
+    std::atomic<bool> m_keepRunning;
+    //! Set while the resolver is not running. Guarded with the reactors by m_stateMutex.
+    bool m_stopped;
+    std::shared_timed_mutex m_stateMutex;
+    std::atomic<uint32_t> m_nextReactor;
+    std::atomic<uint64_t> m_inFlight;
+    std::vector<std::unique_ptr<Reactor>> m_reactors;
+
+    std::mutex m_statsMutex;
+    std::map<std::string, HMDNSServerStats> m_serverStats;
+};
+
+#endif /* HMDNSRESOLVER_H_ */
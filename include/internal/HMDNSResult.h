@@ -10,7 +10,7 @@
 #include <vector>
 #include <cstdint>
 
-#include "HMTimeStamp.h"
+#include "HMMonotonicTime.h"
 #include "HMConstants.h"
 #include "HMIPAddress.h"
 
@@ -35,6 +35,7 @@ public:
         m_queryState = k.m_queryState;
         m_queryTime = k.m_queryTime;
         m_resultTime = k.m_resultTime;
+        m_lastResult = k.m_lastResult;
     }
 
     HMDNSResult(uint64_t ttl, uint64_t timeout) :
@@ -67,9 +68,9 @@ public:
 	/*!
 	     Start the DNS resolution for this result.
 	     Sets the internal state to HM_CHECK_IN_PROGRESS.
-	     \return the HMTimeStamp with the check timeout value. (To determine when to reschedule in case of timeout.)
+	     \return the HMMonotonicTime with the check timeout value. (To determine when to reschedule in case of timeout.)
 	 */
-	HMTimeStamp startQuery();
+	HMMonotonicTime startQuery();
 
 	//! Finish the DNS resolution for this result.
 	/*!
@@ -88,9 +89,9 @@ public:
 	//! Determine the time of the next required DNS resolution for this entry.
 	/*!
 	     Determine the time of the next required DNS resolution for this entry.
-	     \return HMTimeStamp of the next required DNS resolution for this entry.
+	     \return HMMonotonicTime of the next required DNS resolution for this entry.
 	 */
-	HMTimeStamp nextQueryTime() const;
+	HMMonotonicTime nextQueryTime() const;
 
 	//! Get the TTL of this DNS resolution.
 	/*!
@@ -158,8 +159,10 @@ private:
 	mutable std::shared_timed_mutex m_resultLock;
 
 	HM_WORK_STATE m_queryState;
-	HMTimeStamp m_queryTime;
+	HMMonotonicTime m_queryTime;
 	HMTimeStamp m_resultTime;
+	//! The monotonic time of m_resultTime, used to schedule the next resolution.
+	HMMonotonicTime m_lastResult;
 
 	uint64_t m_queryTimeout;
 	uint64_t m_dnsTimeout;
@@ -7,6 +7,7 @@
 #include <string>
 #include <memory>
 #include <vector>
+#include <atomic>
 
 #include "HMRemoteHostGroupCache.h"
 #include "HMDataCheckResult.h"
@@ -17,12 +18,17 @@
 #include "HMRemoteHostCache.h"
 
 class HMWork;
+class HMEventLoop;
 class HMStorage;
 class HMDataHostCheck;
 class HMCheckHeader;
 class HMAuxCache;
 class HMAuxInfo;
 class HMResultPublisher;
+
+//! The check id returned for a check that is not part of the check list.
+#define HM_CHECK_ID_INVALID 0
+
 //! Class to hold the list of health checks to perform
 /*!
  * This is the main class that holds all health checks that NetCHASM will perform.
@@ -36,11 +42,19 @@ class HMResultPublisher;
  * with all individual rotation's check to be updated correctly even with different check parameters, averaging etc.
  *
  * HMDataCheckResults -> Stores the actual results of the checks
+ *
+ * Each host name and hostDataCheck key is interned to a check id when it is inserted. The id indexes a flat table of the entries of
+ * the key so the scheduler can look up a check without hashing or comparing the host name and hostDataCheck again. Check ids are
+ * only valid for the check list that issued them, the check list id tells if an id has to be looked up again after a reload.
  */
 class HMDataCheckList
 {
 public:
-    HMDataCheckList() : m_guard(false) {};
+    HMDataCheckList() :
+        m_guard(false),
+        m_listID(++m_lastListID),
+        m_checkIndex(1),
+        m_checkHashes(1) {};
     HMDataCheckList(HMDataCheckList& k) = delete;
 
     //! CheckNeeded determines if the specific check in question should be conducted now.
@@ -53,15 +67,68 @@ public:
      */
     HM_SCHEDULE_STATE checkNeeded(std::string& hostname, HMIPAddress& ip, HMDataHostCheck& hostCheck);
 
+    //! CheckNeeded determines if the specific check in question should be conducted now.
+    /*!
+        This function determines the checkNeeded (HM_SCHEDULE_STATE) of the interned check without any lookup by host name.
+        \param the check id returned by getCheckID.
+        \param ip to check.
+        \return the schedule state. Either queue work, a timeout event or ignore.
+     */
+    HM_SCHEDULE_STATE checkNeeded(uint32_t checkID, const HMIPAddress& ip);
+
+    //! Get the interned id of a check.
+    /*!
+         Get the id of the host name and host check in this check list. The lookup does not allocate.
+         \param hostname of the check.
+         \param hostCheck parameters of the check.
+         \return the check id or HM_CHECK_ID_INVALID if the check is not part of the check list.
+     */
+    uint32_t getCheckID(const std::string& hostname, const HMDataHostCheck& hostCheck) const;
+
+    //! Get the id of the check list.
+    /*!
+         Get the unique id of the check list. Check ids issued by another check list must be looked up again.
+         \return the check list id.
+     */
+    uint64_t getListID() const;
+
+    //! Check if the given check is still part of the check list.
+    /*!
+         Check if the given check is still part of the check list for the given address.
+         \param hostname of the check.
+         \param ip address of the check.
+         \param hostCheck parameters of the check.
+         \return true if the check list has the check for the address.
+     */
+    bool hasCheck(const std::string& hostname, const HMIPAddress& ip, const HMDataHostCheck& hostCheck);
+
+    //! Check if the given check is still part of the check list.
+    /*!
+         Check if the interned check is still part of the check list for the given address.
+         \param the check id returned by getCheckID.
+         \param ip address of the check.
+         \return true if the check list has the check for the address.
+     */
+    bool hasCheck(uint32_t checkID, const HMIPAddress& ip);
+
     //! nextCheckTime determines the next timeStamp to conduct the given check.
     /*!
          This function determines the next check time according to the requirements of all check parameters.
          \param hostname to check.
          \param ip address to check.
          \param hostCheck parameters to be used for the check.
-         \return An HMTimeStamp of the time the next check should occur.
+         \return An HMMonotonicTime of the time the next check should occur.
      */
-    HMTimeStamp nextCheckTime(std::string& hostname, const HMIPAddress& ip, HMDataHostCheck& hostCheck);
+    HMMonotonicTime nextCheckTime(std::string& hostname, const HMIPAddress& ip, HMDataHostCheck& hostCheck);
+
+    //! nextCheckTime determines the next timeStamp to conduct the given check.
+    /*!
+         This function determines the next check time of the interned check.
+         \param the check id returned by getCheckID.
+         \param ip address to check.
+         \return An HMMonotonicTime of the time the next check should occur.
+     */
+    HMMonotonicTime nextCheckTime(uint32_t checkID, const HMIPAddress& ip);
 
     //! Get the check timeout based on the TTL of this check.
     /*!
@@ -71,7 +138,16 @@ public:
          \param hostCheck to use for the check parameters.
          \return the timestamp of the minimum TTL for this check.
      */
-    HMTimeStamp getCheckTimeout(const std::string& hostname, const HMIPAddress& ip, HMDataHostCheck& hostCheck);
+    HMMonotonicTime getCheckTimeout(const std::string& hostname, const HMIPAddress& ip, HMDataHostCheck& hostCheck);
+
+    //! Get the check timeout based on the TTL of this check.
+    /*!
+         This function gets the TTL of the interned check.
+         \param the check id returned by getCheckID.
+         \param ip address to check.
+         \return the timestamp of the minimum TTL for this check.
+     */
+    HMMonotonicTime getCheckTimeout(uint32_t checkID, const HMIPAddress& ip);
 
     //! This function is called to insert the check in to the work queue.
     /*
@@ -81,9 +157,42 @@ public:
          \param ip to check.
          \param hostCheck data to be used for the check.
          \param the work queue to insert the check.
-         \param enable remote check(default is false)
+         \param the event loop to hold the check back in if its destination is over the limits, nullptr to queue it regardless.
+         \param true for a check forced from the control socket, queued in the control work class.
+     */
+    void queueCheck(const std::string& hostname, const HMIPAddress& ip, HMDataHostCheck& check, HMWorkQueue& queue,
+            HMEventLoop* eventLoop = nullptr, bool control = false);
+
+    //! This function is called to insert the check in to the work queue.
+    /*
+         This function is called to insert the interned check in to the work queue. The work order carries the check id.
+         With an event loop, a check to a destination over the limits of the work queue is scheduled to be tried again instead.
+         \param the check id returned by getCheckID.
+         \param hostname to check.
+         \param ip to check.
+         \param hostCheck data to be used for the check.
+         \param the work queue to insert the check.
+         \param the event loop to hold the check back in if its destination is over the limits, nullptr to queue it regardless.
+         \param true for a check forced from the control socket, queued in the control work class.
      */
-    void queueCheck(const std::string& hostname, const HMIPAddress& ip, HMDataHostCheck& check, HMWorkQueue& queue);
+    void queueCheck(uint32_t checkID, const std::string& hostname, const HMIPAddress& ip, HMDataHostCheck& check, HMWorkQueue& queue,
+            HMEventLoop* eventLoop = nullptr, bool control = false);
+
+    //! Queue a due check or schedule it, spreading the checks started together.
+    /*
+         Queue a due check in the work queue or schedule it in the event loop. The due checks that did not run since the start,
+         and the due checks of a reload, are spread by the check schedule of the event loop so they do not all start at once.
+         The checks of a reload are forced, they are made due before they are spread.
+         Checks that are not due outside of a reload are left to their scheduled timeout.
+         \param hostname to check.
+         \param ip to check.
+         \param hostCheck data to be used for the check.
+         \param the work queue to insert the check.
+         \param the event loop to schedule the check.
+         \param true for the checks rescheduled by a reload.
+     */
+    void scheduleCheck(const std::string& hostname, const HMIPAddress& ip, HMDataHostCheck& check, HMWorkQueue& queue,
+            HMEventLoop& eventLoop, bool restart);
 
     //! This function is called by the worker thread when the check is removed from the work queue and is executed.
     /*
@@ -94,7 +203,16 @@ public:
          \param hostCheck data to use for the check.
          \return the timeout of the check. It can be rescheduled if this timeout elapses.
      */
-    HMTimeStamp startCheck(std::string& hostname, HMIPAddress& ip, HMDataHostCheck& check);
+    HMMonotonicTime startCheck(std::string& hostname, HMIPAddress& ip, HMDataHostCheck& check);
+
+    //! This function is called by the worker thread when the check is removed from the work queue and is executed.
+    /*
+         This function updates the state of the interned check to HM_CHECK_IN_PROGRESS.
+         \param the check id returned by getCheckID.
+         \param ip of the check.
+         \return the timeout of the check. It can be rescheduled if this timeout elapses.
+     */
+    HMMonotonicTime startCheck(uint32_t checkID, const HMIPAddress& ip);
 
     //! This function retrieves the host groups associated with the given check and check params.
     /*
@@ -172,12 +290,12 @@ public:
         \param work pointer to the work base class defining the check parameters that need updated.
         \param hostCheck to update.
         \param ip address to update.
-        \param the aux data to parse in the aux cache parser.
+        \param the aux data to parse in the aux cache parser, the parser can modify it.
         \param pointer to the current backend data storage class.
         \param format of aux data string.
         \param the current aux cache.
      */
-    void storeAux(HMWork* work, HMDataHostCheck& hostCheck, const HMIPAddress& address, std::string auxData, HMStorage* store, HMAuxCache& aux, HM_AUX_DATA_TYPE auxDataType);
+    void storeAux(HMWork* work, HMDataHostCheck& hostCheck, const HMIPAddress& address, std::string& auxData, HMStorage* store, HMAuxCache& aux, HM_AUX_DATA_TYPE auxDataType);
 
     //! This function is called by the worker thread to commit the aux information to the backend data store.
     /*
@@ -267,6 +385,19 @@ public:
      */
     uint32_t addHostGroup(HMDataHostGroup& hostGroup);
 
+    //! Restore the results of the checks that a reload left untouched.
+    /*
+         Restore the results of the checks that a reload left untouched. A check is untouched if all of its host groups are unchanged,
+         its results are merged directly into the matching check of this check list, keeping the newest result of each address,
+         and the backend cache is updated for each result restored. The other checks are returned to be restored one address at a time.
+         \param the check list of the running state.
+         \param the names of the host groups unchanged by the reload.
+         \param the backend storage of this check list.
+         \param vector of HMCheckHeader to fill with the checks that were not restored.
+         \return the number of checks restored.
+     */
+    uint64_t restoreChecks(HMDataCheckList& src, const std::set<std::string>& unchangedGroups, HMStorage* store, std::vector<HMCheckHeader>& changedChecks);
+
     //! Initiate the DNS cache based on the internal list of hostChecks.
     /*
          Initiate the DNS cache based on the internal list of hostChecks.
@@ -344,8 +475,26 @@ public:
 
 
 private:
+
+    //! Hash the key of a check, consistent with the CompareCheckList ordering of the check list.
+    static size_t hashCheck(const std::string& hostname, const HMDataHostCheck& hostCheck);
+
+    //! Find the check id of the key in the hash table.
+    uint32_t findCheckID(const std::string& hostname, const HMDataHostCheck& hostCheck, size_t hash) const;
+
+    //! Add a check list entry to the check index, interning its key if it is new.
+    void indexCheck(HMCheckList::iterator it);
+
     bool m_guard;
+    uint64_t m_listID;
+    static std::atomic<uint64_t> m_lastListID;
     HMCheckList m_checklist;
+    //! The check list entries of each check id, id HM_CHECK_ID_INVALID is never used.
+    std::vector<std::vector<HMCheckList::iterator>> m_checkIndex;
+    //! The key hash of each check id.
+    std::vector<size_t> m_checkHashes;
+    //! Open addressing table of the check ids, a power of two in size.
+    std::vector<uint32_t> m_checkSlots;
     // Contains reference to m_checklist entries without the remoteCheck set in DataHostCheck
     std::multimap<std::pair<std::string,HMDataHostCheck>, HMCheckList::iterator> m_checklistReference;
 };
@@ -9,7 +9,7 @@
 #include <cstdint>
 #include <shared_mutex>
 
-#include "HMTimeStamp.h"
+#include "HMMonotonicTime.h"
 #include "HMConstants.h"
 #include "HMDataCheckResult.h"
 #include "HMDataHostCheck.h"
@@ -103,6 +103,15 @@ public:
             uint32_t flapThreshold,
             uint32_t passthroughInfo);
 
+    //! Restore the results of the same check params of the running state.
+    /*!
+         Restore the results of the same check params of the running state on a reload, keeping the newest result of each address.
+         The restored results are set inactive so they are rescheduled by the new state.
+         \param the check params of the running state.
+         \param vector to fill with the addresses and results restored.
+     */
+    void restoreResults(HMDataCheckParams& src, std::vector<std::pair<HMIPAddress, HMDataCheckResult>>& restored);
+
     //! set the forcedown flag for the appropriate IP address in this check parameter
     /*!
          Set the force down flag for the hosts based on their IP address.
@@ -122,17 +131,17 @@ public:
     /*!
          Get the next check time for the specified address in this check params.
          \param address the address to get the next check time.
-         \return HMTimeStamp the timestamp to schedule the next check for this check params and address.
+         \return HMMonotonicTime the timestamp to schedule the next check for this check params and address.
      */
-    HMTimeStamp nextCheckTime(const HMIPAddress& address);
+    HMMonotonicTime nextCheckTime(const HMIPAddress& address);
 
     //! Get the check timeout based on the TTL of this check params.
     /*!
          Get the check timeout from now until the TTL.
          \param address the address to use to get the checktime.
-         \return HMTimeStamp the timestamp of now plus the check TTL.
+         \return HMMonotonicTime the timestamp of now plus the check TTL.
      */
-    HMTimeStamp getCheckTimeout(const HMIPAddress& address);
+    HMMonotonicTime getCheckTimeout(const HMIPAddress& address);
 
     //! Set the state machine for this check to queued.
     /*!
@@ -153,7 +162,7 @@ public:
         Set the state machine for this check to running.
         \param the IP address to set
      */
-    void startQuery(HMIPAddress& address);
+    void startQuery(const HMIPAddress& address);
 
     //! Check to see if this IP address is currently active.
     /*!
@@ -182,8 +191,10 @@ public:
          \param start the start time of the check.
          \param end the end time of the check.
          \param port the port used in the check.
+         \param connectEnd the time the TCP connect completed, only set by the checks with a TLS handshake after the connect.
      */
-    void updateCheck(std::string& hostname, const HMIPAddress& address, HM_RESPONSE response, HM_REASON reason, HMTimeStamp start, HMTimeStamp end, uint16_t port);
+    void updateCheck(std::string& hostname, const HMIPAddress& address, HM_RESPONSE response, HM_REASON reason, HMMonotonicTime start, HMMonotonicTime end, uint16_t port,
+            HMMonotonicTime connectEnd = HMMonotonicTime());
 
     //! Invalidate and remove the check and address to clear it from the internal cache.
     /*!
@@ -218,6 +229,21 @@ public:
      */
     HMTimeStamp getCheckTime(HMIPAddress& address);
 
+    //! Check if the address was checked since the start.
+    /*!
+         Check if the address was checked, or its result updated, since the start. A result loaded from the storage does not count.
+         \param address the address to look up.
+         \return true if the address was checked since the start, its next check then follows the TTL.
+     */
+    bool isCheckedSinceStart(const HMIPAddress& address);
+
+    //! Make the check of the address due now.
+    /*!
+         Make the check of the address due now, so the next scheduling of the check queues it.
+         \param address the address to expire.
+     */
+    void expireCheck(const HMIPAddress& address);
+
     //! Get the configured number of check retries.
     /*
          Get the configured number of check retries.
@@ -339,7 +365,7 @@ public:
          \param the ip address to retrieve the state.
          \return the work state associated with the passed address.
      */
-    HM_WORK_STATE getQueryState(HMIPAddress& address);
+    HM_WORK_STATE getQueryState(const HMIPAddress& address);
 
 private:
 
@@ -352,8 +378,8 @@ private:
          \param an iterator to the current entry to update.
      */
     void setResponse(std::string& hostname,
-            HMTimeStamp start,
-            HMTimeStamp end,
+            HMMonotonicTime start,
+            HMMonotonicTime end,
             std::map<HMIPAddress, HMDataCheckResult>::iterator& it);
 
     uint8_t m_numCheckRetries;
@@ -6,8 +6,9 @@
 #include <cstdint>
 
 #include "HMIPAddress.h"
-#include "HMTimeStamp.h"
+#include "HMMonotonicTime.h"
 #include "HMConstants.h"
+#include "HMVarint.h"
 
 //! The class to hold the results of a health check.
 class HMDataCheckResult
@@ -19,6 +20,9 @@ public:
                 && m_start == k.m_start
                 && m_end == k.m_end
                 && m_responseTime == k.m_responseTime
+                && m_tcpConnectTime == k.m_tcpConnectTime
+                && m_tlsHandshakeTime == k.m_tlsHandshakeTime
+                && m_responseTimeMicros == k.m_responseTimeMicros
                 && m_totalResponseTime == k.m_totalResponseTime
                 && m_minResponseTime == k.m_minResponseTime
                 && m_maxResponseTime == k.m_maxResponseTime
@@ -49,6 +53,9 @@ public:
 
     HMDataCheckResult() :
         m_responseTime(0),
+        m_tcpConnectTime(0),
+        m_tlsHandshakeTime(0),
+        m_responseTimeMicros(0),
         m_totalResponseTime(0),
         m_minResponseTime(0),
         m_maxResponseTime(0),
@@ -65,6 +72,7 @@ public:
         m_flapStatus(HM_HOST_STATUS_NONE),
         m_response(HM_RESPONSE_NONE),
         m_reason(HM_REASON_NONE),
+        m_softReason(HM_REASON_NONE),
         m_numFailedChecks(0),
         m_numSlowResponses(0),
         m_port(0),
@@ -74,6 +82,9 @@ public:
 
     HMDataCheckResult(uint64_t checkTimeout) :
         m_responseTime(checkTimeout),
+        m_tcpConnectTime(0),
+        m_tlsHandshakeTime(0),
+        m_responseTimeMicros(0),
         m_totalResponseTime(checkTimeout),
         m_minResponseTime(checkTimeout),
         m_maxResponseTime(checkTimeout),
@@ -90,6 +101,7 @@ public:
         m_flapStatus(HM_HOST_STATUS_NONE),
         m_response(HM_RESPONSE_NONE),
         m_reason(HM_REASON_NONE),
+        m_softReason(HM_REASON_NONE),
         m_numFailedChecks(0),
         m_numSlowResponses(0),
         m_port(0),
@@ -105,6 +117,12 @@ public:
     HMTimeStamp m_end;
     //! The amount of time it took for the check to connect.
     uint32_t m_responseTime;
+    //! The part of the response time taken by the TCP connect in microseconds, only set by the checks with a TLS handshake.
+    uint32_t m_tcpConnectTime;
+    //! The part of the response time taken by the TLS handshake after the TCP connect in microseconds.
+    uint32_t m_tlsHandshakeTime;
+    //! The response time in microseconds, m_responseTime is the same time in milliseconds.
+    uint32_t m_responseTimeMicros;
     //! The total time it took for the check from beginning to the end of the transfer.
     uint32_t m_totalResponseTime;
     //! The minimum response time seen for this check.
@@ -155,17 +173,32 @@ public:
     HMTimeStamp m_queueCheckTime;
     //! The last time this check was conducted.
     HMTimeStamp m_checkTime;
+    //! The monotonic time of m_checkTime, used to schedule the next check. Not stored or published.
+    HMMonotonicTime m_lastCheck;
     //! The current WORK_STATE to track the current state of the check.
     HM_WORK_STATE m_queryState;
     //! The last time this remote host was contacted.
     HMTimeStamp m_remoteCheckTime;
     //! Status showing Host went up to down or down to up
     bool m_statusChanged;
+
+    //! Get the monotonic time of the last check.
+    /*!
+         Get the monotonic time of the last check. Results read from storage or a remote have no monotonic time,
+         their wall clock check time is converted instead.
+         \return the monotonic time of the last check, unset if the check was never done.
+     */
+    HMMonotonicTime getLastCheck() const
+    {
+        return m_lastCheck.isSet() ? m_lastCheck : HMMonotonicTime::fromWallClock(m_checkTime);
+    }
+
     //! Function to serialize the current check result info into a raw buffer.
     /*!
          The serialize function supports two types of calls designed to be called consecutively.
          When called with a null buf and size 0 serialize will return the required size of the buf to store the check result.
          When called with a non-null buf and the correct size, serialize will store the check result into the buf.
+         The check result is written in the compact format, see serializeCompact.
          \param buf pass nullptr to get the required size or a raw buffer to fill.
          \param size pass 0 to get the required size or the required size to fill the buffer.
          \return The required size of the buf or the number of bytes saved to the buffer.
@@ -175,14 +208,82 @@ public:
     //! De-serialize the raw buffer.
     /*!
          This function is called to deserialize a check result. It fills in the class data from the raw buffer.
+         Both the compact format and the fixed layout written by older versions are read.
          \param buf raw buffer to deserialize.
          \param size the size of the raw buffer.
          \return true if the deserialize was a success.
      */
     bool deserialize(char* buf, uint32_t size);
 
+    //! De-serialize the raw buffer.
+    /*!
+         This function is called to deserialize a check result from a buffer holding more data after it.
+         \param buf raw buffer to deserialize.
+         \param size the size of the raw buffer.
+         \param set to the number of bytes used by the check result.
+         \return true if the deserialize was a success.
+     */
+    bool deserialize(const char* buf, uint32_t size, uint32_t& used);
+
 private:
 
+    //! Write the check result in the compact format.
+    /*!
+         Compact format:
+         | magic | version | presence bitmap | address | (| field |) --repeated for each bit set in the bitmap
+         The fields are varints and only the ones that are not 0 are written. The check time is written as is,
+         the other timestamps as the zigzag delta to the check time.
+         Readers skip the fields past the ones they know, so fields can be appended without changing the version.
+         \param buf the buffer to fill, must hold MAX_SERIALIZED_SIZE bytes.
+         \return the number of bytes written.
+     */
+    uint32_t serializeCompact(char* buf) const;
+
+    bool deserializeCompact(const char* buf, uint32_t size, uint32_t& used);
+    bool deserializeLegacy(const char* buf, uint32_t size, uint32_t& used);
+
+    static const uint8_t COMPACT_MAGIC = 0xC7;
+    static const uint8_t COMPACT_VERSION = 1;
+
+    //! The fields written in the compact format, in bitmap order.
+    enum CompactField
+    {
+        FIELD_CHECK_TIME = 0,
+        FIELD_START,
+        FIELD_END,
+        FIELD_QUEUE_CHECK_TIME,
+        FIELD_CHANGE_TIME,
+        FIELD_FLAP_TIME,
+        FIELD_REMOTE_CHECK_TIME,
+        FIELD_RESPONSE_TIME,
+        FIELD_TOTAL_RESPONSE_TIME,
+        FIELD_MIN_RESPONSE_TIME,
+        FIELD_MAX_RESPONSE_TIME,
+        FIELD_SMOOTHED_RESPONSE_TIME,
+        FIELD_SUM_RESPONSE_TIME,
+        FIELD_NUM_CHECKS,
+        FIELD_NUM_RESPONSES,
+        FIELD_NUM_CONNECT_FAILURES,
+        FIELD_NUM_FAILURES,
+        FIELD_NUM_TIMEOUTS,
+        FIELD_NUM_FLAPS,
+        FIELD_STATUS,
+        FIELD_RESPONSE,
+        FIELD_REASON,
+        FIELD_SOFT_REASON,
+        FIELD_NUM_FAILED_CHECKS,
+        FIELD_NUM_SLOW_RESPONSES,
+        FIELD_PORT,
+        FIELD_FORCE_HOST_DOWN,
+        FIELD_TCP_CONNECT_TIME,
+        FIELD_TLS_HANDSHAKE_TIME,
+        FIELD_RESPONSE_TIME_MICROS,
+        FIELD_COUNT
+    };
+
+    //! The max number of bytes of a check result in the compact format.
+    static const uint32_t MAX_SERIALIZED_SIZE = 2 + HMVarint::MAX_SIZE + HMVarint::MAX_ADDRESS_SIZE + FIELD_COUNT * HMVarint::MAX_SIZE;
+
     struct SerStruct
     {
         HMIPAddress m_address;
@@ -24,7 +24,9 @@ public:
         m_checkPlugin(HM_CHECK_PLUGIN_DEFAULT),
         m_remoteCheckType(HM_REMOTE_CHECK_NONE),
         m_TOSValue(0),
-        m_flowType(HM_FLOW_DNS_HEALTH_TYPE){};
+        m_flowType(HM_FLOW_DNS_HEALTH_TYPE),
+        m_keepAlive(false),
+        m_priority(HM_WORK_PRIORITY_NORMAL){};
 
     HMDataHostCheck(HM_DNS_TYPE dnsType) :
             m_checkType(HM_CHECK_DEFAULT),
@@ -35,7 +37,9 @@ public:
             m_checkPlugin(HM_CHECK_PLUGIN_DEFAULT),
             m_remoteCheckType(HM_REMOTE_CHECK_NONE),
             m_TOSValue(0),
-            m_flowType(HM_FLOW_DNS_HEALTH_TYPE){};
+            m_flowType(HM_FLOW_DNS_HEALTH_TYPE),
+            m_keepAlive(false),
+            m_priority(HM_WORK_PRIORITY_NORMAL){};
 	HMDataHostCheck(const HMAPIDataHostCheck&);
 	bool operator<(const HMDataHostCheck& k) const;
 	bool operator!=(const HMDataHostCheck& k) const;
@@ -81,7 +85,14 @@ public:
 	     Get the check info used for the check.
 	     \return the check info string.
 	 */
-	std::string getCheckInfo() const;
+	const std::string& getCheckInfo() const;
+
+    //! Get the string the body of an HTTP/S check is expected to contain.
+    /*!
+         Get the string the body of an HTTP/S check is expected to contain.
+         \return the expected string, empty if the body is not checked.
+     */
+    const std::string& getCheckExpect() const;
 
     //! Check mode of fallback for the remote check.
     /*!
@@ -146,6 +157,23 @@ public:
      */
     uint8_t getTOSValue() const;
 
+    //! Check if the connection is kept open between checks.
+    /*!
+         Check if the connection is kept open to be reused by the next check of the same target.
+         Like the check plugin this is how the check is run and not part of the check identity.
+         \return true if keepalive is enabled.
+     */
+    bool getKeepAlive() const;
+
+    //! Get the priority of the check in the work queue.
+    /*!
+         Get the priority of the check in the work queue, from its host group.
+         Like the keepalive this is how the check is run and not part of the check identity,
+         a check shared by host groups with different priorities keeps the priority of the host group that added it.
+         \return the work priority.
+     */
+    HM_WORK_PRIORITY getPriority() const;
+
     //! Get the type of DNS check.
     /*!
          Get the type of DNS check for the health check.
@@ -172,6 +200,7 @@ private:
     uint16_t m_port;
     HM_DUALSTACK m_dualstack;
     std::string m_checkInfo;
+    std::string m_checkExpect;
     std::string m_remoteCheck;
     HM_DISTRIBUTED_FALLBACK m_distributedFallback;
     HM_DNS_TYPE m_DNSType;
@@ -180,6 +209,8 @@ private:
     HMIPAddress m_sourceAddress;
     uint8_t m_TOSValue;
     HM_FLOW_TYPE m_flowType;
+    bool m_keepAlive;
+    HM_WORK_PRIORITY m_priority;
 };
 
 #endif /* HMDATAHOSTCHECK_H_ */
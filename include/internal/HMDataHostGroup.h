@@ -5,6 +5,7 @@
 
 #include <vector>
 #include <string>
+#include <memory>
 #include <algorithm>
 
 #include "HMDataHostCheck.h"
@@ -38,7 +39,10 @@ public:
         m_checkPlugin(HM_CHECK_PLUGIN_DEFAULT),
         m_DNSType(HM_DNS_TYPE_LOOKUP),
         m_TOSValue(0),
-        m_flowType(HM_FLOW_DNS_HEALTH_TYPE) {};
+        m_flowType(HM_FLOW_DNS_HEALTH_TYPE),
+        m_keepAlive(false),
+        m_priority(HM_WORK_PRIORITY_NORMAL),
+        m_hosts(std::make_shared<std::vector<std::string>>()) {};
 
     bool operator<(const HMDataHostGroup& k) const;
     bool operator==(const HMDataHostGroup& k) const;
@@ -111,6 +115,13 @@ public:
      */
     void setCheckInfo(const std::string& checkInfo);
 
+    //! Set the string the body of the HTTP/S checks is expected to contain.
+    /*!
+         Set the string the body of the HTTP/S checks is expected to contain.
+         \param the expected string, empty to not check the body.
+     */
+    void setCheckExpect(const std::string& checkExpect);
+
     //! Set the check retries for this group.
     /*!
          Set the check retries for this group.
@@ -273,6 +284,13 @@ public:
      */
     std::string getCheckInfo() const;
 
+    //! Get the string the body of the HTTP/S checks is expected to contain.
+    /*!
+         Get the string the body of the HTTP/S checks is expected to contain.
+         \return the expected string, empty if the body is not checked.
+     */
+    const std::string& getCheckExpect() const;
+
     //! Get the flap threshold for the group.
     /*!
          Get the flap threshold for the group.
@@ -357,6 +375,8 @@ public:
     //! De-serialize the raw buffer.
     /*!
          This function is called to deserializethe host group info. It fills in the class data from the raw buffer.
+         Both the versioned layout and the unversioned layout written by older versions are read.
+         The fields missing from the buffer are left at their defaults.
          \param buf raw buffer to deserialize.
          \param size the size of the raw buffer.
          \return true if the deserialize was a success.
@@ -443,6 +463,35 @@ public:
      */
     void setTOSValue(uint8_t tosValue);
 
+    //! Check if the checks keep their connection open between checks.
+    /*!
+         Check if the checks of the host group keep their connection open to be reused by the next check.
+         \return true if keepalive is enabled.
+     */
+    bool getKeepAlive() const;
+
+    //! Set if the checks keep their connection open between checks.
+    /*!
+         Set if the checks of the host group keep their connection open to be reused by the next check.
+         Only used by the HTTP/S checks run on the curl multi engine.
+         \param true to enable keepalive.
+     */
+    void setKeepAlive(bool keepAlive);
+
+    //! Get the priority of the health checks.
+    /*!
+         Get the priority the health checks of the host group are given in the work queue.
+         \return the work priority.
+     */
+    HM_WORK_PRIORITY getPriority() const;
+
+    //! Set the priority of the health checks.
+    /*!
+         Set the priority the health checks of the host group are given in the work queue.
+         \param the work priority.
+     */
+    void setPriority(HM_WORK_PRIORITY priority);
+
     //! Get the type of DNS check.
     /*!
          Get the type of DNS check for the host group.
@@ -480,6 +529,7 @@ private:
     HM_REMOTE_CHECK_TYPE m_remoteCheckType;
     uint16_t m_port;
     std::string m_checkInfo;
+    std::string m_checkExpect;
     std::string m_remoteCheck;
     HMIPAddress m_sourceAddress;
     uint8_t m_numCheckRetries;
@@ -498,10 +548,71 @@ private:
     HM_DNS_TYPE m_DNSType;
     uint8_t m_TOSValue;
     HM_FLOW_TYPE m_flowType;
+    bool m_keepAlive;
+    HM_WORK_PRIORITY m_priority;
     std::vector<std::string> m_hostGroups;
-    std::vector<std::string> m_hosts;
+    //! The host list, shared between the copies of the host group until one of them changes it.
+    std::shared_ptr<std::vector<std::string>> m_hosts;
+
+    //! Get the host list to change it, copying it first if it is shared.
+    std::vector<std::string>& getMutableHostList();
+
+    struct SerStruct;
+    //! Fill in the class data from a fixed layout and the strings following it.
+    bool deserialize(const SerStruct& ser, const char* src, uint32_t size);
+    //! Read the unversioned layout written by older versions.
+    bool deserializeLegacy(char* buf, uint32_t size);
 
+    //! The first byte of the versioned layout. The unversioned layout starts with the measurement options, never the magic.
+    static const uint8_t SER_MAGIC = 0xC9;
+    //! The version of the layout. Fields appended to SerStruct keep the version, only a change to the existing fields needs a new one.
+    static const uint8_t SER_VERSION = 1;
+
+    /* Format is:
+     | SerStruct | GroupName | CheckInfo | CheckExpect | RemoteCheck |
+     | HostNameSize (bytes) | HostName | --repeated for each host
+     | HostGroupNameSize (bytes) | HostGroupName | --repeated for each child host group
+     */
     struct SerStruct
+    {
+        uint8_t m_magic;
+        uint8_t m_version;
+        //! The size of the SerStruct written, the strings start after it.
+        //! Readers skip the fields appended by newer versions and leave the ones missing from older versions at 0.
+        uint16_t m_size;
+        uint16_t m_measurementOptions;
+        uint8_t m_dualstack;
+        uint8_t m_checkType;
+        uint16_t m_port;
+        uint8_t m_numCheckRetries;
+        uint32_t m_checkRetryDelay;
+        uint32_t m_smoothingWindow;
+        uint32_t m_groupThreshold;
+        uint32_t m_slowThreshold;
+        uint32_t m_maxFlaps;
+        uint64_t m_checkTimeout;
+        uint64_t m_checkTTL;
+        uint32_t m_flapThreshold;
+        uint32_t m_passthroughInfo;
+        uint8_t m_distributedFallback;
+        uint32_t m_groupNameSize;
+        uint32_t m_checkInfoSize;
+        uint32_t m_numHosts;
+        uint32_t m_remoteCheckSize;
+        uint32_t m_totalHostSize;
+        uint32_t m_numHostGroups;
+        uint32_t m_totalHostGroupSize;
+        HMIPAddress m_sourceAddress;
+        uint8_t m_TOSValue;
+        uint8_t m_DNSCheckPlugin;
+        uint8_t m_flowType;
+        uint8_t m_keepAlive;
+        uint32_t m_checkExpectSize;
+        uint8_t m_priority;
+    };
+
+    //! The fixed layout written before the layout was versioned.
+    struct LegacySerStruct
     {
         uint16_t m_measurementOptions;
         uint8_t m_dualstack;
@@ -12,11 +12,14 @@
 #include "HMConstants.h"
 #include "HMDataHostGroup.h"
 #include "netchasm/threadinfo.pb.h"
+#include "netchasm/storeinfo.pb.h"
+#include "netchasm/workqueueinfo.pb.h"
 #include "netchasm/datahostgroup.pb.h"
 #include "netchasm/ipaddress.pb.h"
 #include "netchasm/datacheckresult.pb.h"
 #include "netchasm/hostresults.pb.h"
 #include "netchasm/hostgroupinfo.pb.h"
+#include "netchasm/hostgroupdelta.pb.h"
 #include "netchasm/auxinfo.pb.h"
 #include "netchasm/hostschdinfo.pb.h"
 #include "netchasm/datahostcheck.pb.h"
@@ -47,6 +50,10 @@ public:
     virtual void unpackDataHostGroup(const netchasm::DataHostGroup pDataHostGroup, HMDataHostGroup& datahostGroup);
     virtual std::unique_ptr<char[]> packThreadInfo(HMAPIThreadInfo& tInfo, uint64_t& dataSize);
     virtual bool unpackThreadInfo(std::unique_ptr<char[]>& data, uint64_t dataSize, HMAPIThreadInfo& tInfo);
+    virtual std::unique_ptr<char[]> packStoreInfo(HMAPIStoreInfo& sInfo, uint64_t& dataSize);
+    virtual bool unpackStoreInfo(std::unique_ptr<char[]>& data, uint64_t dataSize, HMAPIStoreInfo& sInfo);
+    virtual std::unique_ptr<char[]> packWorkQueueInfo(HMAPIWorkQueueInfo& wInfo, uint64_t& dataSize);
+    virtual bool unpackWorkQueueInfo(std::unique_ptr<char[]>& data, uint64_t dataSize, HMAPIWorkQueueInfo& wInfo);
     virtual std::unique_ptr<char[]> packDataHostGroup(HMDataHostGroup& dataGroupInfo, uint64_t& dataSize);
     virtual bool unpackDataHostGroup(std::unique_ptr<char[]>& data, uint64_t dataSize, HMAPICheckInfo& dataGroupInfo);
     virtual bool unpackDataHostGroup(std::unique_ptr<char[]>& data, uint64_t dataSize, HMDataHostGroup& dataHostGroup);
@@ -60,6 +67,8 @@ public:
     virtual std::unique_ptr<char[]> packHostGroupInfo(HMDataHostGroup& group,  std::vector<HMGroupCheckResult>& results,uint64_t& dataSize);
     virtual bool unpackHostGroupInfo(std::unique_ptr<char[]>& data, uint64_t dataSize, HMAPICheckInfo& apiCheckInfo, std::vector<HMAPICheckResult>& apiCheckResults);
     virtual bool unpackHostGroupInfo(std::unique_ptr<char[]>& data, uint64_t dataSize, HMDataHostGroup& dataHostGroup, std::vector<HMGroupCheckResult>& checkResults);
+    virtual std::unique_ptr<char[]> packHostGroupDelta(uint64_t epoch, uint64_t sequence, bool resync, std::vector<HMGroupCheckResult>& results, uint64_t& dataSize);
+    virtual bool unpackHostGroupDelta(std::unique_ptr<char[]>& data, uint64_t dataSize, uint64_t& epoch, uint64_t& sequence, bool& resync, std::vector<HMGroupCheckResult>& checkResults);
     virtual std::unique_ptr<char[]> packAuxInfo(HMAuxInfo& auxInfo, std::string& hostName, HMIPAddress& addr, uint64_t& dataSize);
     virtual bool unpackAuxInfo(std::unique_ptr<char[]>& data, uint64_t dataSize, HMAPIAuxInfo& apiAuxInfoResult);
     virtual bool unpackAuxInfo(std::unique_ptr<char[]>& data, uint64_t dataSize, HMAuxInfo& auxInfoResult);
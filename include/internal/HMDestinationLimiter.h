@@ -0,0 +1,172 @@
+// Copyright 2019, Oath Inc.
+// Licensed under the terms of the Apache 2.0 license. See LICENSE file in the root of the distribution for licensing details.
+#ifndef HMDESTINATIONLIMITER_H_
+#define HMDESTINATIONLIMITER_H_
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+
+#include "HMConstants.h"
+#include "HMIPAddress.h"
+#include "HMMonotonicTime.h"
+
+//! The limits on the checks sent to a single destination.
+class HMDestinationLimitConfig
+{
+public:
+    HMDestinationLimitConfig() :
+        m_concurrency(HM_DEFAULT_DESTINATION_CONCURRENCY),
+        m_rate(HM_DEFAULT_DESTINATION_RATE),
+        m_burst(HM_DEFAULT_DESTINATION_BURST),
+        m_prefixIpv4(HM_DEFAULT_DESTINATION_PREFIX_IPV4),
+        m_prefixIpv6(HM_DEFAULT_DESTINATION_PREFIX_IPV6),
+        m_resolverConcurrency(HM_DEFAULT_DESTINATION_CONCURRENCY),
+        m_resolverRate(HM_DEFAULT_DESTINATION_RATE),
+        m_retryDelay(HM_DEFAULT_DESTINATION_RETRY_DELAY) {};
+
+    //! The max number of checks in flight to a destination. 0 for no limit.
+    uint32_t m_concurrency;
+    //! The max number of checks per second started to a destination. 0 for no limit.
+    uint32_t m_rate;
+    //! The number of checks to a destination that can start at once under the rate limit.
+    uint32_t m_burst;
+    //! The prefix length grouping the IPv4 destinations, 32 limits each address on its own.
+    uint32_t m_prefixIpv4;
+    //! The prefix length grouping the IPv6 destinations, 128 limits each address on its own.
+    uint32_t m_prefixIpv6;
+    //! The max number of DNS lookups in flight to the resolver. 0 for no limit.
+    uint32_t m_resolverConcurrency;
+    //! The max number of DNS lookups per second sent to the resolver. 0 for no limit.
+    uint32_t m_resolverRate;
+    //! The time in ms before a check held back by a concurrency limit is tried again.
+    uint64_t m_retryDelay;
+};
+
+//! A check in flight to a destination.
+/*!
+     A check in flight to a destination. Held by the work of the check, the destination gets the slot back when the work is destroyed.
+ */
+class HMDestinationSlot
+{
+public:
+    HMDestinationSlot(std::shared_ptr<std::atomic<uint32_t>> inFlight) :
+        m_inFlight(inFlight)
+    {
+        ++(*m_inFlight);
+    };
+
+    HMDestinationSlot(const HMDestinationSlot&) = delete;
+    HMDestinationSlot& operator=(const HMDestinationSlot&) = delete;
+
+    ~HMDestinationSlot()
+    {
+        --(*m_inFlight);
+    };
+
+private:
+    std::shared_ptr<std::atomic<uint32_t>> m_inFlight;
+};
+
+//! Limits the concurrency and the rate of the checks sent to each destination.
+/*!
+     Limits the concurrency and the rate of the checks sent to each destination, so a group with many hostnames on the
+     same VIP does not open hundreds of connections to it at once.
+     The health and aux checks are limited by their destination address, grouped by the configured prefix lengths.
+     The DNS lookups are limited together as they all go to the resolver.
+     A check gets a slot it keeps while it is in flight. A check over the limit is not blocked, the caller gets the time
+     to try again and schedules the check in the event loop.
+     The rate is a token bucket kept as the time the next check can start, refilled at the rate up to the burst.
+     The destinations with nothing in flight and a full bucket are dropped periodically so the destinations no longer
+     checked are not kept.
+ */
+class HMDestinationLimiter
+{
+public:
+    HMDestinationLimiter() :
+        m_nextSweep(0),
+        m_enabled(false),
+        m_resolverEnabled(false),
+        m_numDeferred(0) {};
+
+    HMDestinationLimiter(const HMDestinationLimiter&) = delete;
+    HMDestinationLimiter& operator=(const HMDestinationLimiter&) = delete;
+
+    //! Set the limits.
+    /*!
+         Set the limits. The checks in flight keep their slots, the destinations with nothing in flight are dropped.
+         \param the destination limits.
+     */
+    void setConfig(const HMDestinationLimitConfig& config);
+
+    //! Take a slot to send a check to a destination.
+    /*!
+         Take a slot to send a check to a destination.
+         \param the destination address of the check.
+         \param filled with the slot to hold while the check is in flight, left empty if the destinations are not limited.
+         \param filled with the time to try again if the destination is over its limits.
+         \return true if the check can be sent now.
+     */
+    bool acquire(const HMIPAddress& destination, std::shared_ptr<HMDestinationSlot>& slot, HMMonotonicTime& retry);
+
+    //! Take a slot to send a DNS lookup to the resolver.
+    /*!
+         Take a slot to send a DNS lookup to the resolver.
+         \param filled with the slot to hold while the lookup is in flight, left empty if the resolver is not limited.
+         \param filled with the time to try again if the resolver is over its limits.
+         \return true if the lookup can be sent now.
+     */
+    bool acquireResolver(std::shared_ptr<HMDestinationSlot>& slot, HMMonotonicTime& retry);
+
+    //! Get the number of checks held back by the limits.
+    uint64_t getNumDeferred() const
+    {
+        return m_numDeferred;
+    }
+
+    //! Get the number of destinations tracked.
+    size_t getNumDestinations()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_destinations.size();
+    }
+
+private:
+    //! The checks in flight and the rate state of a destination.
+    class Destination
+    {
+    public:
+        Destination() :
+            m_inFlight(std::make_shared<std::atomic<uint32_t>>(0)),
+            m_nextStart(0) {};
+
+        std::shared_ptr<std::atomic<uint32_t>> m_inFlight;
+        //! The time in microseconds the bucket is empty from, the burst of checks before it can start right away.
+        uint64_t m_nextStart;
+    };
+
+    //! Take a slot from a destination, called with the mutex held.
+    bool acquire(Destination& destination, uint32_t concurrency, uint32_t rate, std::shared_ptr<HMDestinationSlot>& slot, HMMonotonicTime& retry);
+
+    //! Drop the destinations with nothing in flight and a full bucket, called with the mutex held.
+    /*!
+         Drop the destinations with nothing in flight and a full bucket, at most once every HM_DESTINATION_SWEEP_INTERVAL.
+         A dropped destination is recreated in the same state on its next check.
+         \param the current time.
+     */
+    void sweep(const HMMonotonicTime& now);
+
+    std::mutex m_mutex;
+    HMDestinationLimitConfig m_config;
+    std::map<HMIPAddress, Destination> m_destinations;
+    //! The time in microseconds of the next sweep of the idle destinations.
+    uint64_t m_nextSweep;
+    Destination m_resolver;
+    std::atomic<bool> m_enabled;
+    std::atomic<bool> m_resolverEnabled;
+    std::atomic<uint64_t> m_numDeferred;
+};
+
+#endif /* HMDESTINATIONLIMITER_H_ */
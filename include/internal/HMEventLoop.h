@@ -6,9 +6,10 @@
 #include <string>
 #include <thread>
 
+#include "HMCheckSchedule.h"
 #include "HMDataHostCheck.h"
 #include "HMIPAddress.h"
-#include "HMTimeStamp.h"
+#include "HMMonotonicTime.h"
 #include "HMDNSCache.h"
 //! The Base class for the Event Loop.
 /*!
@@ -59,7 +60,7 @@ public:
          \param structure holding DNS type and address type(v4 or v6).
          \param the time Stamp of when the DNS resolution should take place.
      */
-    virtual void addDNSTimeout(const std::string& hostname, const HMDNSLookup& dnsHostCheck, HMTimeStamp timeStamp) = 0;
+    virtual void addDNSTimeout(const std::string& hostname, const HMDNSLookup& dnsHostCheck, HMMonotonicTime timeStamp) = 0;
 
     //! Add a new Remote timeout.
     /*!
@@ -67,7 +68,7 @@ public:
          \param the hostgroupname to remote check.
          \param the time Stamp of when the Remote check should take place.
      */
-    virtual void addRemoteTimeout(const std::string& hostname, HMTimeStamp timeStamp) = 0;
+    virtual void addRemoteTimeout(const std::string& hostname, HMMonotonicTime timeStamp) = 0;
 
     //! Add a new Remote host timeout.
     /*!
@@ -75,7 +76,7 @@ public:
          \param the hostname to remote check.
          \param the time Stamp of when the Remote check should take place.
      */
-    virtual void addRemoteHostTimeout(const std::string& hostname, const HMDataHostCheck& dataHostCheck, HMTimeStamp timeStamp) = 0;
+    virtual void addRemoteHostTimeout(const std::string& hostname, const HMDataHostCheck& dataHostCheck, HMMonotonicTime timeStamp) = 0;
 
     //! Add a new health check timeout.
     /*!
@@ -88,7 +89,40 @@ public:
     virtual void addHealthCheckTimeout(const std::string& hostname,
             const HMIPAddress& address,
             const HMDataHostCheck hostCheck,
-            HMTimeStamp timeStamp) = 0;
+            HMMonotonicTime timeStamp) = 0;
+
+    //! Add a new health check timeout for an interned check.
+    /*!
+         Add a new health check timeout to the event loop carrying the check id so it can be processed without a lookup by name.
+         Event loops that do not use the check id schedule the timeout by name.
+         \param the hostname to health check.
+         \param the IP address to health check.
+         \param the host check to conduct.
+         \param the time stamp of when the health check should take place.
+         \param the id of the check list that issued the check id.
+         \param the check id in the check list.
+     */
+    virtual void addHealthCheckTimeout(const std::string& hostname,
+            const HMIPAddress& address,
+            const HMDataHostCheck hostCheck,
+            HMMonotonicTime timeStamp,
+            uint64_t checkListID,
+            uint32_t checkID)
+    {
+        (void)checkListID;
+        (void)checkID;
+        addHealthCheckTimeout(hostname, address, hostCheck, timeStamp);
+    }
+
+    //! Get the schedule spreading the health checks.
+    /*!
+         Get the schedule spreading the health checks. The health check timeouts added to the event loop are jittered by it.
+         \return the check schedule.
+     */
+    HMCheckSchedule& getCheckSchedule()
+    {
+        return m_checkSchedule;
+    }
 protected:
 
     //! The internal run function.
@@ -97,6 +131,7 @@ protected:
      */
     virtual void run() = 0;
     std::thread m_thread;
+    HMCheckSchedule m_checkSchedule;
 };
 
 
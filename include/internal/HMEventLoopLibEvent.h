@@ -19,7 +19,7 @@
 #include "HMState.h"
 #include "HMIPAddress.h"
 #include "HMDataHostCheck.h"
-#include "HMTimeStamp.h"
+#include "HMMonotonicTime.h"
 
 #define CERTS "/etc/ssl/certs/ca-certificates.crt"
 
@@ -129,7 +129,7 @@ public:
          \param structure holding DNS type and address type(v4 or v6).
          \param the time Stamp of when the DNS resolution should take place.
      */
-    void addDNSTimeout(const std::string& hostname, const HMDNSLookup& dnsHostCheck, HMTimeStamp timeStamp);
+    void addDNSTimeout(const std::string& hostname, const HMDNSLookup& dnsHostCheck, HMMonotonicTime timeStamp);
 
     //! Add a new Remote timeout.
     /*!
@@ -137,7 +137,7 @@ public:
          \param the hostgroupname to remote check.
          \param the time Stamp of when the Remote check should take place.
      */
-    void addRemoteTimeout(const std::string& hostGroupName, HMTimeStamp timeStamp);
+    void addRemoteTimeout(const std::string& hostGroupName, HMMonotonicTime timeStamp);
 
     //! Add a new Remote host timeout.
     /*!
@@ -145,7 +145,7 @@ public:
          \param the hostname to remote check.
          \param the time Stamp of when the Remote check should take place.
      */
-    void addRemoteHostTimeout(const std::string& hostname, const HMDataHostCheck& dataHostCheck, HMTimeStamp timeStamp);
+    void addRemoteHostTimeout(const std::string& hostname, const HMDataHostCheck& dataHostCheck, HMMonotonicTime timeStamp);
 
     //! Add a new health check timeout.
     /*!
@@ -155,7 +155,7 @@ public:
          \param the host check to conduct.
          \param the time stamp of when the health check should take place.
      */
-    void addHealthCheckTimeout(const std::string& hostname, const HMIPAddress& address, const HMDataHostCheck hostCheck, HMTimeStamp timeStamp);
+    void addHealthCheckTimeout(const std::string& hostname, const HMIPAddress& address, const HMDataHostCheck hostCheck, HMMonotonicTime timeStamp);
 
     //! Callback function when a DNS timeout fires.
     /*!
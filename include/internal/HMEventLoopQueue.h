@@ -4,19 +4,25 @@
 #define HMEVENTLOOPQUEUE_H_
 
 #include <string>
-#include <queue>
+#include <vector>
 #include <mutex>
 #include <condition_variable>
 
 #include "HMWork.h"
-#include "HMTimeStamp.h"
+#include "HMMonotonicTime.h"
+#include "HMTimerWheel.h"
 #include "HMDataCheckList.h"
 #include "HMDataHostCheck.h"
 #include "HMStateManager.h"
 #include "HMWorkQueue.h"
 #include "HMConstants.h"
 
-//! Event loop implementation using a simple priority queue.
+//! Event loop implementation using a hierarchical timing wheel.
+/*!
+     Event loop implementation using a hierarchical timing wheel.
+     Timeouts are scheduled and expired in O(1), and are only copied once when scheduled.
+     On a reload, the health check timeouts for checks that are no longer configured are cancelled.
+ */
 class HMEventLoopQueue : public HMEventLoop
 {
 public:
@@ -34,7 +40,7 @@ public:
          \param true to resolve an IPv6 address.
          \param the time Stamp of when the DNS resolution should take place.
      */
-    void addDNSTimeout(const std::string& hostname, const HMDNSLookup& dnsHostCheck, HMTimeStamp timeStamp);
+    void addDNSTimeout(const std::string& hostname, const HMDNSLookup& dnsHostCheck, HMMonotonicTime timeStamp);
 
     //! Add a new Remote timeout.
     /*!
@@ -42,7 +48,7 @@ public:
          \param the hostgroupname to remote check.
          \param the time Stamp of when the Remote check should take place.
      */
-    void addRemoteTimeout(const std::string& hostname, HMTimeStamp timeStamp);
+    void addRemoteTimeout(const std::string& hostname, HMMonotonicTime timeStamp);
 
 
     //! Add a new Remote host timeout.
@@ -51,7 +57,7 @@ public:
          \param the hostname to remote check.
          \param the time Stamp of when the Remote check should take place.
      */
-    void addRemoteHostTimeout(const std::string& hostname, const HMDataHostCheck& dataHostCheck,HMTimeStamp timeStamp);
+    void addRemoteHostTimeout(const std::string& hostname, const HMDataHostCheck& dataHostCheck,HMMonotonicTime timeStamp);
 
 
     //! Add a new health check timeout.
@@ -62,7 +68,20 @@ public:
          \param the host check to conduct.
          \param the time stamp of when the health check should take place.
      */
-    void addHealthCheckTimeout(const std::string& hostname, const HMIPAddress& address, const HMDataHostCheck hostCheck, HMTimeStamp timeStamp);
+    void addHealthCheckTimeout(const std::string& hostname, const HMIPAddress& address, const HMDataHostCheck hostCheck, HMMonotonicTime timeStamp);
+
+    //! Add a new health check timeout for an interned check.
+    /*!
+         Add a new health check timeout to the event loop carrying the check id.
+         \param the hostname to health check.
+         \param the IP address to health check.
+         \param the host check to conduct.
+         \param the time stamp of when the health check should take place.
+         \param the id of the check list that issued the check id.
+         \param the check id in the check list.
+     */
+    void addHealthCheckTimeout(const std::string& hostname, const HMIPAddress& address, const HMDataHostCheck hostCheck, HMMonotonicTime timeStamp,
+            uint64_t checkListID, uint32_t checkID);
 
     //! Wakeup the tracker.
     /*!
@@ -124,12 +143,18 @@ private:
     public:
         std::string m_hostname;
         HMDataHostCheck m_hostCheck;
-        HMTimeStamp m_timeout;
+        HMMonotonicTime m_timeout;
         TimeoutType m_type;
         HMDNSLookup m_dnsLookup;
         HMIPAddress m_address;
-
-        Timeout(const std::string& host, HMDNSLookup lookup, const HMTimeStamp expiration)
+        //! The id of the check list that issued m_checkID, 0 if the check was not looked up yet.
+        uint64_t m_checkListID;
+        //! The interned id of the health check in the check list.
+        uint32_t m_checkID;
+
+        Timeout(const std::string& host, HMDNSLookup lookup, const HMMonotonicTime expiration) :
+            m_checkListID(0),
+            m_checkID(0)
         {
             m_hostname = host;
             m_timeout = expiration;
@@ -137,14 +162,18 @@ private:
             m_dnsLookup = lookup;
         }
 
-        Timeout(const std::string& host, const HMTimeStamp expiration)
+        Timeout(const std::string& host, const HMMonotonicTime expiration) :
+            m_checkListID(0),
+            m_checkID(0)
         {
             m_hostname = host;
             m_timeout = expiration;
             m_type = REMOTECHECK_TIMEOUT;
         }
 
-        Timeout(const std::string& host, const HMDataHostCheck& dataHostCheck, const HMTimeStamp expiration)
+        Timeout(const std::string& host, const HMDataHostCheck& dataHostCheck, const HMMonotonicTime expiration) :
+            m_checkListID(0),
+            m_checkID(0)
         {
             m_hostname = host;
             m_timeout = expiration;
@@ -152,7 +181,10 @@ private:
             m_hostCheck = dataHostCheck;
         }
 
-        Timeout(const std::string& host, const HMIPAddress& address, const HMDataHostCheck check, const HMTimeStamp expiration)
+        Timeout(const std::string& host, const HMIPAddress& address, const HMDataHostCheck check, const HMMonotonicTime expiration,
+                uint64_t checkListID = 0, uint32_t checkID = 0) :
+            m_checkListID(checkListID),
+            m_checkID(checkID)
         {
             m_hostname = host;
             m_hostCheck = check;
@@ -161,16 +193,49 @@ private:
             m_address = address;
         }
 
-        bool operator< (const Timeout& t) const
+        Timeout() :
+            m_type(HEALTHCHECK_TIMEOUT),
+            m_checkListID(0),
+            m_checkID(0) {};
+
+        //! Get the check id in the check list, looking it up again if the check list was reloaded.
+        uint32_t getCheckID(HMDataCheckList& checkList)
         {
-            // note the inverted order to get the lowest timestamp on top
-            return m_timeout > t.m_timeout;
+            if(m_checkListID != checkList.getListID())
+            {
+                m_checkID = checkList.getCheckID(m_hostname, m_hostCheck);
+                m_checkListID = checkList.getListID();
+            }
+            return m_checkID;
         }
 
     };
 
-    typedef std::priority_queue<Timeout> TimeoutQueue;
-    TimeoutQueue m_timeouts;
+    //! Schedule the timeout and wake the tracker if it is now the first to expire.
+    /*!
+         Schedule the timeout and wake the tracker if it is now the first to expire.
+         \param the timeout to schedule.
+     */
+    void addTimeout(Timeout& timeout);
+
+    //! Process an expired timeout.
+    /*!
+         Process an expired timeout. Queues the work or reschedules the timeout.
+         \param the expired timeout.
+         \param the current state.
+     */
+    void processTimeout(Timeout& timeout, std::shared_ptr<HMState>& currentState);
+
+    //! Cancel the health check timeouts for checks that are no longer configured.
+    /*!
+         Cancel the health check timeouts for checks that are no longer configured. Called when the state is reloaded.
+         \param the newly loaded state.
+     */
+    void cancelStaleTimeouts(std::shared_ptr<HMState>& currentState);
+
+    HMTimerWheel<Timeout> m_timeouts;
+    //! The time the tracker is sleeping until.
+    HMMonotonicTime m_nextWakeup;
 
     HMStateManager* m_stateManager;
     std::shared_ptr<HMState> m_currentState;
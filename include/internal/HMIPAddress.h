@@ -77,6 +77,22 @@ public:
      */
     bool isSet() const;
 
+    //! Check to see if the HMIPAddress is the unspecified address.
+    /*!
+         Check to see if the HMIPAddress is the unspecified address 0.0.0.0 or ::, used as the placeholder of a failed DNS resolution.
+         The address is checked in place without converting it to a string.
+         \return true if the address is an IPv4 or IPv6 unspecified address.
+     */
+    bool isUnspecified() const;
+
+    //! Get the network address of a prefix holding the address.
+    /*!
+         Get the network address of a prefix holding the address, the address with the bits past the prefix length cleared.
+         \param the prefix length, capped to the length of the address.
+         \return the network address of the prefix, the address itself if it is not set.
+     */
+    HMIPAddress getPrefix(uint32_t prefixLength) const;
+
     //! Get the type of address stored.
     /*!
          Get the type of address stored.
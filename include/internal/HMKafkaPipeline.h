@@ -0,0 +1,241 @@
+// Copyright 2019, Oath Inc.
+// Licensed under the terms of the Apache 2.0 license. See LICENSE file in the root of the distribution for licensing details.
+#ifndef HMKAFKAPIPELINE_H_
+#define HMKAFKAPIPELINE_H_
+
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <condition_variable>
+
+#include "HMConstants.h"
+#include "HMRingBuffer.h"
+
+//! Callback used by the producer to report the delivery of a message.
+typedef void (*HMKafkaDeliveryCallback)(void* opaque, bool delivered, void* arg);
+
+//! Interface to the Kafka producer used by the publisher pipeline.
+/*!
+     Interface to the Kafka producer used by the publisher pipeline. Keeps the pipeline independent of librdkafka
+     so it can be run against a local mock producer.
+     The producer must not copy or free the data passed to produce. The data stays valid until the delivery
+     callback is called for the message, which must happen exactly once for every message accepted by produce.
+ */
+class HMKafkaProducer
+{
+public:
+    HMKafkaProducer() :
+        m_deliveryCallback(nullptr),
+        m_deliveryArg(nullptr) {}
+
+    virtual ~HMKafkaProducer() {}
+
+    //! Hand a message to the producer.
+    /*!
+         Hand a message to the producer without copying it.
+         \param pointer to the data.
+         \param size of the data.
+         \param the opaque value passed back in the delivery callback.
+         \return HM_PUBLISH_PRODUCE_OK if the message was accepted.
+     */
+    virtual HM_PUBLISH_PRODUCE_STATUS produce(char* data, size_t datalen, void* opaque) = 0;
+
+    //! Serve the delivery reports of the messages sent.
+    /*!
+         Serve the delivery reports of the messages sent. The delivery callback is called from this function.
+         \param the max time in ms to wait for a delivery report.
+     */
+    virtual void poll(uint32_t timeout) = 0;
+
+    //! Wait for all the outstanding messages to be delivered.
+    /*!
+         Wait for all the outstanding messages to be delivered.
+         \param the max time in ms to wait.
+         \return true if all the messages were delivered.
+     */
+    virtual bool flush(uint32_t timeout) = 0;
+
+    //! Drop all the outstanding messages. Their delivery reports are served on the next poll.
+    virtual void purge() = 0;
+
+    //! Set the function called with the delivery report of each message.
+    void setDeliveryCallback(HMKafkaDeliveryCallback callback, void* arg)
+    {
+        m_deliveryCallback = callback;
+        m_deliveryArg = arg;
+    }
+
+protected:
+    //! Report the delivery of a message to the owner.
+    void delivered(void* opaque, bool success)
+    {
+        if(m_deliveryCallback != nullptr)
+        {
+            m_deliveryCallback(opaque, success, m_deliveryArg);
+        }
+    }
+
+private:
+    HMKafkaDeliveryCallback m_deliveryCallback;
+    void* m_deliveryArg;
+};
+
+//! The tuning parameters of the publisher pipeline.
+class HMKafkaPipelineConfig
+{
+public:
+    HMKafkaPipelineConfig() :
+        m_queueSize(HM_DEFAULT_PUBLISH_QUEUE_SIZE),
+        m_batchSize(HM_DEFAULT_PUBLISH_BATCH_SIZE),
+        m_linger(HM_DEFAULT_PUBLISH_LINGER),
+        m_dropPolicy(HM_PUBLISH_DROP_NEWEST),
+        m_blockTimeout(HM_DEFAULT_PUBLISH_BLOCK_TIMEOUT),
+        m_flushTimeout(HM_DEFAULT_PUBLISH_FLUSH_TIMEOUT) {}
+
+    //! The number of results that can wait for the publisher thread.
+    uint32_t m_queueSize;
+    //! The max number of results produced between delivery report polls.
+    uint32_t m_batchSize;
+    //! The time in ms the producer waits to fill a batch.
+    uint32_t m_linger;
+    //! What to do with a result when the queue is full.
+    HM_PUBLISH_DROP_POLICY m_dropPolicy;
+    //! The time in ms to wait for room in the queue with the block drop policy.
+    uint32_t m_blockTimeout;
+    //! The time in ms to wait for outstanding deliveries on shutdown.
+    uint32_t m_flushTimeout;
+};
+
+//! The counters of the publisher pipeline.
+class HMKafkaPipelineStats
+{
+public:
+    HMKafkaPipelineStats() :
+        m_enqueued(0),
+        m_dropped(0),
+        m_produced(0),
+        m_retries(0),
+        m_delivered(0),
+        m_failed(0),
+        m_queued(0),
+        m_inFlight(0) {}
+
+    //! The number of results accepted into the queue.
+    uint64_t m_enqueued;
+    //! The number of results dropped by the drop policy.
+    uint64_t m_dropped;
+    //! The number of results handed to the producer.
+    uint64_t m_produced;
+    //! The number of times the producer queue was full.
+    uint64_t m_retries;
+    //! The number of results the brokers acknowledged.
+    uint64_t m_delivered;
+    //! The number of results that could not be produced or delivered.
+    uint64_t m_failed;
+    //! The number of results waiting in the queue.
+    uint64_t m_queued;
+    //! The number of results produced and waiting on a delivery report.
+    uint64_t m_inFlight;
+};
+
+//! Asynchronous pipeline to publish check results to Kafka.
+/*!
+     Asynchronous pipeline to publish check results to Kafka.
+     Checks hand their packed results to a bounded lock free ring and return immediately. A dedicated thread
+     produces the results in batches and serves the delivery reports, which free the buffers and update the counters.
+     The buffers are handed to the producer without a copy.
+     When the ring is full the drop policy decides if the new result is dropped, the oldest result is dropped to
+     make room, or the check waits up to the block timeout for room.
+ */
+class HMKafkaPipeline
+{
+public:
+    HMKafkaPipeline(std::unique_ptr<HMKafkaProducer> producer, const HMKafkaPipelineConfig& config);
+
+    ~HMKafkaPipeline();
+
+    HMKafkaPipeline(const HMKafkaPipeline&) = delete;
+    HMKafkaPipeline& operator=(const HMKafkaPipeline&) = delete;
+
+    //! Start the publisher thread.
+    /*!
+         Start the publisher thread.
+         \return true if the thread was started.
+     */
+    bool start();
+
+    //! Shutdown the publisher thread.
+    /*!
+         Shutdown the publisher thread. The results still queued are produced and the outstanding deliveries are
+         waited on for up to the flush timeout before being dropped.
+     */
+    void shutDown();
+
+    //! Queue a result to publish.
+    /*!
+         Queue a result to publish. Applies the drop policy if the queue is full.
+         \param the packed result. The pipeline takes ownership of the buffer.
+         \param size of the data.
+         \return false if the result was dropped.
+     */
+    bool enqueue(std::unique_ptr<char[]> data, size_t datalen);
+
+    //! Get the pipeline counters.
+    /*!
+         Get the pipeline counters.
+         \param the stats to fill.
+     */
+    void getStats(HMKafkaPipelineStats& stats) const;
+
+    //! Get the pipeline configuration.
+    const HMKafkaPipelineConfig& getConfig() const;
+
+private:
+
+    //! A packed result waiting to be produced.
+    class Message
+    {
+    public:
+        Message() :
+            m_size(0) {}
+        Message(std::unique_ptr<char[]> data, size_t size) :
+            m_data(std::move(data)),
+            m_size(size) {}
+
+        std::unique_ptr<char[]> m_data;
+        size_t m_size;
+    };
+
+    //! The publisher thread main loop.
+    void run();
+
+    //! Hand a message to the producer, retrying while the producer queue is full.
+    bool produce(Message& message);
+
+    //! Wake the publisher thread if it is waiting for results.
+    void wake();
+
+    //! The delivery callback passed to the producer.
+    static void deliveryReport(void* opaque, bool delivered, void* arg);
+
+    std::unique_ptr<HMKafkaProducer> m_producer;
+    HMKafkaPipelineConfig m_config;
+    HMRingBuffer<Message> m_ring;
+
+    std::thread m_thread;
+    std::mutex m_mutex;
+    std::condition_variable m_cond;
+    std::atomic<bool> m_keepRunning;
+    std::atomic<bool> m_sleeping;
+
+    std::atomic<uint64_t> m_enqueued;
+    std::atomic<uint64_t> m_dropped;
+    std::atomic<uint64_t> m_produced;
+    std::atomic<uint64_t> m_retries;
+    std::atomic<uint64_t> m_delivered;
+    std::atomic<uint64_t> m_failed;
+    std::atomic<uint64_t> m_inFlight;
+};
+
+#endif /* HMKAFKAPIPELINE_H_ */
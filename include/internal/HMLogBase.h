@@ -9,11 +9,15 @@
 #include <thread>
 #include <mutex>
 #include <vector>
+#include <memory>
+#include <unordered_map>
 #include <sys/types.h>
 #include <condition_variable>
 
 #include "HMUtilitySpinLock.h"
 #include "HMTimeStamp.h"
+#include "HMLogRecord.h"
+#include "HMLogRing.h"
 
 //! The length of the date buffer.
 #define DATE_LENGTH 18
@@ -23,6 +27,12 @@
 #define DEFAULT_DATE_STRING "%Y%m%d.%Hh%Mm%Ss"
 //! The default max queue size for the logging. If the queue backs up more, logs are dropped.
 #define DEFAULT_MAX_QUEUE 8256
+//! The size of the ring buffer holding the pending log records of each logging thread.
+#define DEFAULT_LOG_RING_SIZE 131072
+//! The max time in ms the log writer thread sleeps before checking the rings.
+#define DEFAULT_LOG_FLUSH_INTERVAL 10
+//! The size of the stack buffer used to encode a log record, larger records are allocated.
+#define LOG_RECORD_STACK_SIZE 1024
 
 //! The pre-defined log levels
 enum HM_LOG_LEVEL : int8_t
@@ -76,6 +86,11 @@ const char * const PRINT_LOG_LEVEL[] =
      openLog - setup and open the log file.
      closeLog - tear down and close the current logging.
      writeLog - write the log entry to the log.
+
+     When threaded, a log call only copies the format pointer and the raw arguments as a binary record into a lock free
+     ring owned by the calling thread. The log writer thread drains the rings, formats the records in time order with
+     the cached parsed formats and hands the lines to writeLog. The thread ids are cached per thread and the time stamps
+     use the coarse clock.
  */
 class HMLogBase
 {
@@ -88,11 +103,19 @@ public:
         int length;
         HM_LOG_LEVEL level;
         pid_t tid;
-        bool ready;
         struct timeval tv;
-        struct LogEntry* next;
     };
 
+    HMLogBase() :
+        m_logLevel(HM_LOG_NONE),
+        m_keepRunning(false),
+        m_threaded(false),
+        m_id(0),
+        m_queued(0),
+        m_waiting(false),
+        m_maxQueue(DEFAULT_MAX_QUEUE),
+        m_droppedLogs(0) {}
+
     virtual ~HMLogBase() {}
 
     //! Initialize the logging.
@@ -140,6 +163,36 @@ public:
      */
     void log(HM_LOG_LEVEL level, const char* buf, ...);
 
+    //! Write to the log with deferred formatting.
+    /*!
+         Write to the log with deferred formatting. The arguments are copied in a binary record, the line is formatted
+         by the log writer thread. Called through HMLog.
+         \param the log level to write.
+         \param the printf format. It must stay valid after the call, as a string literal does, unless there are no arguments.
+         \param the arguments of the format.
+     */
+    template <typename ... Args>
+    void logFormat(HM_LOG_LEVEL level, const char* format, const Args& ... args)
+    {
+        if(level > m_logLevel)
+        {
+            return;
+        }
+        // Without arguments the format may be a temporary string, so copy it
+        bool inlineFormat = (sizeof...(Args) == 0);
+        uint32_t size = HMLogRecord::recordSize(format, inlineFormat, args ...);
+        char stackBuf[LOG_RECORD_STACK_SIZE];
+        std::unique_ptr<char[]> heapBuf;
+        char* record = stackBuf;
+        if(size > sizeof(stackBuf))
+        {
+            heapBuf.reset(new char[size]);
+            record = heapBuf.get();
+        }
+        HMLogRecord::writeRecord(record, size, level, format, inlineFormat, args ...);
+        submitRecord(record, size);
+    }
+
     //! Get the current log level.
     /*!
          Get the current log level.
@@ -208,33 +261,57 @@ protected:
      */
     virtual void writeLog(LogEntry *entry) = 0;
 
-    //! Get a new log entry struct on the queue.
+    //! Stamp an encoded record and queue it or write it.
     /*!
-         Get a new log entry struct on the queue. The allocation is done all at once to not block other threads.
-         \param the new log entry to use by the caller.
+         Stamp an encoded record with the time and thread id. When threaded, queue it in the ring of the calling thread,
+         otherwise format and write it.
+         \param the record.
+         \param the size of the record.
      */
-    void getEntry(struct LogEntry*& entry);
+    void submitRecord(char* record, uint32_t size);
+
+    //! Get the ring of the calling thread, registering a new one with the log on the first call.
+    HMLogRing* getThreadRing();
+
+    //! Format a record and write it to the log.
+    /*!
+         Format a record and write it to the log.
+         \param the record.
+         \param the buffer used to format the line.
+         \param the parsed formats cache, nullptr to parse the format.
+     */
+    void writeRecord(const char* record, std::string& line, std::unordered_map<const char*, HMLogFormat>* formats);
 
     //! The dedicated log writing done in the new thread.
     void flushBuffer();
 
+    //! Move the records of all the rings to the buffer.
+    /*!
+         Move the records of all the rings to the buffer and release the rings of the threads that exited.
+         \param the buffer the records are appended to.
+         \param filled with the offsets of the records in the buffer.
+     */
+    void drainRings(std::vector<char>& records, std::vector<size_t>& offsets);
+
     HM_LOG_LEVEL m_logLevel;
     std::string m_logFile;
 
-    struct LogEntry* m_writeHead;
-    struct LogEntry* m_readHead;
-
-    bool m_keepRunning;
+    std::atomic<bool> m_keepRunning;
     bool m_threaded;
 
-    HMUtilitySpinLock m_spinLock;
+    //! The unique id of this log, used to find the ring of the calling thread.
+    uint64_t m_id;
+    std::mutex m_ringMutex;
+    std::vector<std::shared_ptr<HMLogRing>> m_rings;
+    //! The number of records queued in the rings.
+    std::atomic<uint32_t> m_queued;
+    //! Set while the log writer thread is waiting for records.
+    std::atomic<bool> m_waiting;
 
     std::condition_variable m_dataReadyCond;
     std::mutex m_dataReadyLock;
 
     std::thread m_thread;
-    uint32_t m_current;
-    uint32_t m_last;
 
     std::string m_dateString;
     uint32_t m_maxQueue;
@@ -248,6 +325,7 @@ extern HMLogBase* hlog;
 //!  Template allowing the HMLog convenience function.
 /*
     This template is inline wrapping the log level so the variadic parameter are only evaluated if the log should be written.
+    The format is kept by pointer and formatted later by the log writer, so it must be a string literal when there are arguments.
  */
 template <typename ... Args>
 inline void HMLog(const HM_LOG_LEVEL level, const char* buf, Args const& ... args)
@@ -256,8 +334,17 @@ inline void HMLog(const HM_LOG_LEVEL level, const char* buf, Args const& ... arg
     {
         if(level <= hlog->getLevel())
         {
-            hlog->log(level, buf, args ...);
+            hlog->logFormat(level, buf, args ...);
         }
     }
 }
+
+//! Check if a log level is written.
+/*
+    Check if a log level is written, used to skip building costly log arguments on hot paths.
+ */
+inline bool HMLogEnabled(const HM_LOG_LEVEL level)
+{
+    return (hlog != nullptr) && (level <= hlog->getLevel());
+}
 #endif /* HMLOGBASE_H_ */
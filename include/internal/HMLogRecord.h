@@ -0,0 +1,265 @@
+// Copyright 2019, Oath Inc.
+// Licensed under the terms of the Apache 2.0 license. See LICENSE file in the root of the distribution for licensing details.
+#ifndef HMLOGRECORD_H_
+#define HMLOGRECORD_H_
+
+#include <inttypes.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <type_traits>
+#include <sys/types.h>
+#include <sys/time.h>
+
+//! The type of an argument stored in a binary log record.
+enum HM_LOG_ARG_TYPE : uint8_t
+{
+    HM_LOG_ARG_INT,
+    HM_LOG_ARG_UINT,
+    HM_LOG_ARG_DOUBLE,
+    HM_LOG_ARG_STRING,
+    HM_LOG_ARG_POINTER
+};
+
+//! The header of a binary log record.
+/*!
+     A log record is the header followed by the inline copy of the format when it is not kept by pointer,
+     and by the arguments, each stored as its type followed by its value. Strings are stored as their length
+     followed by the characters. Records are only accessed with memcpy so they need no alignment.
+ */
+struct HMLogRecordHeader
+{
+    //! The size of the whole record.
+    uint32_t m_size;
+    //! The HM_LOG_LEVEL of the record.
+    int8_t m_level;
+    //! The number of arguments stored.
+    uint8_t m_nArgs;
+    //! Set if the format is copied after the header instead of kept by pointer.
+    uint8_t m_inlineFormat;
+    pid_t m_tid;
+    struct timeval m_tv;
+    //! The format string, the identifier used to cache its parsed form.
+    const char* m_format;
+};
+
+//! Encoding of the log arguments into a binary log record.
+/*!
+     The size and write functions are overloaded on the argument types so the log call only copies the raw values,
+     the formatting is deferred to the log writer.
+ */
+class HMLogRecord
+{
+public:
+
+    //! Get the size of the record holding the given arguments.
+    /*!
+         Get the size of the record holding the given arguments.
+         \param the format string.
+         \param true to copy the format in the record.
+         \param the arguments.
+         \return the size of the record in bytes.
+     */
+    template <typename ... Args>
+    static uint32_t recordSize(const char* format, bool inlineFormat, const Args& ... args)
+    {
+        uint32_t size = sizeof(HMLogRecordHeader);
+        if(inlineFormat)
+        {
+            size += stringSize(format);
+        }
+        uint32_t argSizes[] = { 0, argSize(args) ... };
+        for(auto argSize : argSizes)
+        {
+            size += argSize;
+        }
+        return size;
+    }
+
+    //! Write the record for the given arguments.
+    /*!
+         Write the record for the given arguments. The time and thread id are left for the caller to set.
+         \param the buffer to write to, it must hold recordSize bytes.
+         \param the size returned by recordSize.
+         \param the HM_LOG_LEVEL of the record.
+         \param the format string.
+         \param true to copy the format in the record.
+         \param the arguments.
+     */
+    template <typename ... Args>
+    static void writeRecord(char* buf, uint32_t size, int8_t level, const char* format, bool inlineFormat, const Args& ... args)
+    {
+        HMLogRecordHeader header;
+        memset(&header, 0, sizeof(header));
+        header.m_size = size;
+        header.m_level = level;
+        header.m_nArgs = sizeof...(Args);
+        header.m_inlineFormat = inlineFormat;
+        header.m_format = inlineFormat ? nullptr : format;
+        memcpy(buf, &header, sizeof(header));
+        char* pos = buf + sizeof(header);
+        if(inlineFormat)
+        {
+            writeString(pos, format);
+        }
+        char* ends[] = { pos, (pos = writeArg(pos, args)) ... };
+        (void)ends;
+    }
+
+    //! Read the header of a record.
+    static void readHeader(const char* record, HMLogRecordHeader& header)
+    {
+        memcpy(&header, record, sizeof(header));
+    }
+
+private:
+
+    static uint32_t stringSize(const char* str)
+    {
+        return sizeof(uint32_t) + (str ? strlen(str) : 0) + 1;
+    }
+
+    static char* writeString(char* pos, const char* str)
+    {
+        uint32_t len = str ? strlen(str) : 0;
+        memcpy(pos, &len, sizeof(len));
+        pos += sizeof(len);
+        if(len > 0)
+        {
+            memcpy(pos, str, len);
+        }
+        pos[len] = 0;
+        return pos + len + 1;
+    }
+
+    template <typename T>
+    static char* writeValue(char* pos, HM_LOG_ARG_TYPE type, T value)
+    {
+        *pos++ = type;
+        memcpy(pos, &value, sizeof(value));
+        return pos + sizeof(value);
+    }
+
+    template <typename T, typename std::enable_if<std::is_integral<T>::value || std::is_enum<T>::value || std::is_floating_point<T>::value, int>::type = 0>
+    static uint32_t argSize(const T&)
+    {
+        return 1 + 8;
+    }
+
+    static uint32_t argSize(const char* str)
+    {
+        return 1 + stringSize(str);
+    }
+
+    static uint32_t argSize(const std::string& str)
+    {
+        return 1 + sizeof(uint32_t) + str.size() + 1;
+    }
+
+    static uint32_t argSize(const void*)
+    {
+        return 1 + 8;
+    }
+
+    template <typename T, typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value, int>::type = 0>
+    static char* writeArg(char* pos, const T& value)
+    {
+        return writeValue(pos, HM_LOG_ARG_INT, (int64_t)value);
+    }
+
+    template <typename T, typename std::enable_if<std::is_integral<T>::value && !std::is_signed<T>::value, int>::type = 0>
+    static char* writeArg(char* pos, const T& value)
+    {
+        return writeValue(pos, HM_LOG_ARG_UINT, (uint64_t)value);
+    }
+
+    template <typename T, typename std::enable_if<std::is_enum<T>::value, int>::type = 0>
+    static char* writeArg(char* pos, const T& value)
+    {
+        return writeValue(pos, HM_LOG_ARG_INT, (int64_t)value);
+    }
+
+    template <typename T, typename std::enable_if<std::is_floating_point<T>::value, int>::type = 0>
+    static char* writeArg(char* pos, const T& value)
+    {
+        return writeValue(pos, HM_LOG_ARG_DOUBLE, (double)value);
+    }
+
+    static char* writeArg(char* pos, const char* str)
+    {
+        *pos++ = HM_LOG_ARG_STRING;
+        return writeString(pos, str);
+    }
+
+    static char* writeArg(char* pos, const std::string& str)
+    {
+        *pos++ = HM_LOG_ARG_STRING;
+        return writeString(pos, str.c_str());
+    }
+
+    static char* writeArg(char* pos, const void* ptr)
+    {
+        return writeValue(pos, HM_LOG_ARG_POINTER, (uint64_t)(uintptr_t)ptr);
+    }
+};
+
+//! A printf format split into its literal text and conversions.
+/*!
+     The log writer parses each format once and keeps it by format pointer, the arguments of the records are then
+     formatted one conversion at a time.
+ */
+class HMLogFormat
+{
+public:
+    //! Parse the format string.
+    /*!
+         Parse the format string.
+         \param the printf format.
+     */
+    void parse(const char* format);
+
+    //! Format a record.
+    /*!
+         Format the arguments of a record with the parsed format.
+         \param the record arguments, following the header and inline format.
+         \param the end of the record.
+         \param the number of arguments in the record.
+         \param the string to append the formatted line to.
+     */
+    void format(const char* args, const char* end, uint32_t nArgs, std::string& out) const;
+
+    //! Get the position of the arguments in a record.
+    /*!
+         Get the position of the arguments in a record, skipping the inline format if any.
+         \param the record.
+         \param the header of the record.
+         \param set to the inline format, or to the format pointer.
+         \return the position of the first argument.
+     */
+    static const char* getArgs(const char* record, const HMLogRecordHeader& header, const char*& format);
+
+private:
+
+    //! A literal text followed by a conversion.
+    class Segment
+    {
+    public:
+        Segment() :
+            m_conversion(0),
+            m_length(0),
+            m_stars(0) {};
+
+        std::string m_literal;
+        //! The conversion spec including the %, empty if the segment is only literal text.
+        std::string m_spec;
+        char m_conversion;
+        //! The length modifier: 0, 'H' for hh, 'h', 'l', 'L' for ll and j, 'z', 't' or 'D' for long double.
+        char m_length;
+        //! The number of * width and precision taken from the arguments.
+        uint8_t m_stars;
+    };
+
+    std::vector<Segment> m_segments;
+};
+
+#endif /* HMLOGRECORD_H_ */
@@ -0,0 +1,60 @@
+// Copyright 2019, Oath Inc.
+// Licensed under the terms of the Apache 2.0 license. See LICENSE file in the root of the distribution for licensing details.
+#ifndef HMLOGRING_H_
+#define HMLOGRING_H_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+//! Lock free ring of binary log records for a single logging thread.
+/*!
+     Byte ring for a single producer and a single consumer. Each logging thread owns a ring, the log writer thread
+     drains all of them, so a log call only copies its record and never takes a lock.
+     Records are prefixed with their 32 bit size, which is the first field of HMLogRecordHeader, and wrap around the
+     end of the buffer. The capacity is rounded up to a power of two.
+ */
+class HMLogRing
+{
+public:
+    HMLogRing(uint32_t capacity);
+
+    HMLogRing(const HMLogRing&) = delete;
+    HMLogRing& operator=(const HMLogRing&) = delete;
+
+    //! Add a record to the ring. Only called from the owning thread.
+    /*!
+         Add a record to the ring.
+         \param the record starting with its size.
+         \param the size of the record.
+         \return false if the ring does not have the room for the record.
+     */
+    bool push(const char* record, uint32_t size);
+
+    //! Remove the oldest record from the ring. Only called from the log writer thread.
+    /*!
+         Remove the oldest record from the ring.
+         \param the buffer the record is appended to.
+         \return false if the ring is empty.
+     */
+    bool pop(std::vector<char>& out);
+
+    //! Check if the ring is empty. Only a snapshot while the owning thread logs.
+    bool empty() const;
+
+private:
+    void copyIn(uint64_t pos, const char* data, uint32_t size);
+    void copyOut(uint64_t pos, char* data, uint32_t size) const;
+
+    std::unique_ptr<char[]> m_buffer;
+    uint64_t m_mask;
+    // Keep the positions on separate cache lines so the logging thread and the writer don't contend
+    char m_pad0[64];
+    std::atomic<uint64_t> m_head;
+    char m_pad1[64];
+    std::atomic<uint64_t> m_tail;
+    char m_pad2[64];
+};
+
+#endif /* HMLOGRING_H_ */
@@ -0,0 +1,167 @@
+// Copyright 2019, Oath Inc.
+// Licensed under the terms of the Apache 2.0 license. See LICENSE file in the root of the distribution for licensing details.
+#ifndef HMMONOTONICTIME_H_
+#define HMMONOTONICTIME_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <sys/time.h>
+
+#include "HMTimeStamp.h"
+
+//! Clock that only moves when told to, for deterministic tests.
+/*!
+     Clock that only moves when told to. Once set with HMMonotonicTime::setFakeClock every monotonic time is read from it.
+     The time is in microseconds and starts after 0 so a fake now is never mistaken for an unset time.
+ */
+class HMFakeClock
+{
+public:
+    HMFakeClock(uint64_t start = 1000000) :
+        m_now(start) {};
+
+    //! Get the current fake time in microseconds.
+    uint64_t now() const
+    {
+        return m_now;
+    }
+
+    //! Set the current fake time in microseconds.
+    void set(uint64_t micros)
+    {
+        m_now = micros;
+    }
+
+    //! Move the fake time forward.
+    /*!
+         Move the fake time forward.
+         \param the number of microseconds to advance.
+     */
+    void advance(uint64_t micros)
+    {
+        m_now += micros;
+    }
+
+private:
+    std::atomic<uint64_t> m_now;
+};
+
+//! The time stamp used to schedule checks and measure them.
+/*!
+     The time stamp used to schedule checks and measure them. Read from the steady clock in microseconds, so it never
+     steps with NTP or leap adjustments and a sub-millisecond response time is not rounded away.
+     The time has no relation to the calendar, toWallClock and fromWallClock convert to and from the HMTimeStamp
+     kept for the stored and published results.
+     Offsets added to or subtracted from the time stamp are in milliseconds like HMTimeStamp,
+     the difference of two time stamps is in milliseconds, use microsecondsSince for the full resolution.
+ */
+class HMMonotonicTime
+{
+public:
+
+    HMMonotonicTime() :
+        m_time(0) {};
+
+    explicit HMMonotonicTime(uint64_t micros) :
+        m_time(micros) {};
+
+    bool operator==(const HMMonotonicTime& k) const { return m_time == k.m_time; }
+    bool operator!=(const HMMonotonicTime& k) const { return m_time != k.m_time; }
+    bool operator<(const HMMonotonicTime& k) const { return m_time < k.m_time; }
+    bool operator<=(const HMMonotonicTime& k) const { return m_time <= k.m_time; }
+    bool operator>(const HMMonotonicTime& k) const { return m_time > k.m_time; }
+    bool operator>=(const HMMonotonicTime& k) const { return m_time >= k.m_time; }
+
+    //! Static function to return an HMMonotonicTime initialized to now.
+    /*!
+         Static function to return an HMMonotonicTime initialized to now, read from the fake clock if one is set.
+         \return an HMMonotonicTime set to now.
+     */
+    static HMMonotonicTime now();
+
+    //! Check if the time stamp was set.
+    bool isSet() const
+    {
+        return m_time != 0;
+    }
+
+    //! Get the time stamp in microseconds from the start of the clock.
+    uint64_t getMicroseconds() const
+    {
+        return m_time;
+    }
+
+    //! Get the time stamp in milliseconds from the start of the clock.
+    uint64_t getMilliseconds() const
+    {
+        return m_time / 1000;
+    }
+
+    //! Get the time stamp a number of microseconds after this one.
+    HMMonotonicTime plusMicroseconds(uint64_t micros) const
+    {
+        return HMMonotonicTime(m_time + micros);
+    }
+
+    //! Get the time elapsed since an earlier time stamp.
+    /*!
+         Get the time elapsed since an earlier time stamp.
+         \param the earlier time stamp.
+         \return the number of microseconds from the earlier time stamp to this one, 0 if it is not earlier.
+     */
+    uint64_t microsecondsSince(const HMMonotonicTime& start) const
+    {
+        return (m_time > start.m_time) ? m_time - start.m_time : 0;
+    }
+
+    //! Get the amount of time from now to this time stamp in milliseconds.
+    /*!
+         Get the amount of time from now to this time stamp in milliseconds, rounded up so a wait never ends early.
+         \return the number of milliseconds to wait, 0 if the time stamp has passed.
+     */
+    uint64_t getMillisecondsFromNow() const;
+
+    //! Get the amount of time from now to this time stamp as a timeval timeout.
+    /*!
+         Get the amount of time from now to this time stamp as a timeval timeout.
+         \return a timeval representing the difference between this time stamp and now.
+     */
+    struct timeval getTimeout() const;
+
+    //! Convert the time stamp to wall clock time.
+    /*!
+         Convert the time stamp to wall clock time, relative to the current wall clock time.
+         \return the wall clock time stamp, unset if this time stamp is unset.
+     */
+    HMTimeStamp toWallClock() const;
+
+    //! Convert a wall clock time stamp to a monotonic time stamp.
+    /*!
+         Convert a wall clock time stamp to a monotonic time stamp, relative to the current wall clock time.
+         Used for the times read from storage or remote results.
+         \param the wall clock time stamp.
+         \return the monotonic time stamp, unset if the wall clock time stamp is unset.
+     */
+    static HMMonotonicTime fromWallClock(const HMTimeStamp& timeStamp);
+
+    //! Set the clock every time stamp is read from.
+    /*!
+         Set the clock every time stamp is read from. Only meant for tests.
+         \param the fake clock, nullptr to read the steady clock again.
+     */
+    static void setFakeClock(HMFakeClock* clock);
+
+    friend HMMonotonicTime operator + (const HMMonotonicTime& ts, uint64_t offset);
+    friend HMMonotonicTime operator + (uint64_t offset, const HMMonotonicTime& ts);
+    friend HMMonotonicTime operator - (const HMMonotonicTime& ts, uint64_t offset);
+    friend uint64_t operator - (const HMMonotonicTime& ts1, const HMMonotonicTime& ts2);
+
+private:
+    //! Microseconds from the start of the clock.
+    uint64_t m_time;
+
+    static std::atomic<HMFakeClock*> m_fakeClock;
+};
+
+#endif /* HMMONOTONICTIME_H_ */
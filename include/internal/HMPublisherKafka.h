@@ -7,49 +7,69 @@
 #include <vector>
 #include <memory>
 #include "HMPublisherProto.h"
+#include "HMKafkaPipeline.h"
 #include "librdkafka/rdkafkacpp.h"
 
-class DeliveryReportCb : public RdKafka::DeliveryReportCb {
+//! The librdkafka producer used by the Kafka publisher pipeline.
+class HMKafkaProducerRd : public HMKafkaProducer, public RdKafka::DeliveryReportCb
+{
 public:
-  void dr_cb (RdKafka::Message &message);
+    HMKafkaProducerRd(const std::string& topic) :
+        m_topic(topic) {}
+
+    //! Create the librdkafka producer.
+    /*!
+         Create the librdkafka producer.
+         \param the comma separated broker list.
+         \param the pipeline tuning used to set the producer batching.
+         \return true if the producer was created.
+     */
+    bool init(const std::string& brokers, const HMKafkaPipelineConfig& config);
+
+    HM_PUBLISH_PRODUCE_STATUS produce(char* data, size_t datalen, void* opaque);
+    void poll(uint32_t timeout);
+    bool flush(uint32_t timeout);
+    void purge();
+
+    //! The librdkafka delivery report callback.
+    void dr_cb(RdKafka::Message &message);
+
+private:
+    std::string m_topic;
+    std::unique_ptr<RdKafka::Producer> m_producer;
 };
 
 class HMKafkaConfig
 {
 public:
     std::string brokers;
+    HMKafkaPipelineConfig pipeline;
 };
 class HMPublisherKafka : public HMPublisherProto
 {
 public:
-    ~HMPublisherKafka() {}
+    ~HMPublisherKafka();
     HMPublisherKafka(HMKafkaConfig& config, std::string topic);
-    //! This function is called to publish the check information to the publisher.
-    /*
-         This function is called to publish the check information to the publisher.
-         \param pointer to data;
-         \param size of data.
-     */
-    void publish(char* data, const size_t datalen) const;
     //! Return the registered topic
     const std::string& getTopic() const;
     //! Return the kafka config object
     const HMKafkaConfig& getConfig() const;
-
-    std::unique_ptr<RdKafka::Producer> m_producer = nullptr;
+    //! Get the publisher pipeline counters.
+    void getStats(HMKafkaPipelineStats& stats) const;
 
 private:
     //! This function is called to publish the check information to the publisher.
     /*
          This function is called to publish the check information to the publisher.
-         \param pointer to data;
+         The data is queued to the publisher thread, it never waits on the brokers.
+         \param the packed data.
          \param size of data.
-         \return Kafka error code.
      */
-    RdKafka::ErrorCode produce(char* data, const size_t datalen) const;
-    DeliveryReportCb m_dr_cb;
+    void publish(std::unique_ptr<char[]> data, const size_t datalen) const;
+
     std::string m_topic;
     HMKafkaConfig m_config;
+    std::unique_ptr<HMKafkaPipeline> m_pipeline;
 };
 
 #endif /* HMPUBLISHERBASE_H_ */
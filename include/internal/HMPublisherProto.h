@@ -25,10 +25,10 @@ protected:
     //! This function is called to publish the check information to the publisher.
     /*
          This function is called to publish the check information to the publisher.
-         \param pointer to data;
+         \param the packed data. The publisher takes ownership of the buffer.
          \param size of data.
      */
-    virtual void publish(char* data, const size_t datalen) const = 0;
+    virtual void publish(std::unique_ptr<char[]> data, const size_t datalen) const = 0;
 };
 
 #endif /* HMPUBLISHERPROTO_H_ */
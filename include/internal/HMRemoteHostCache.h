@@ -67,9 +67,9 @@ public:
     /*!
          Get the next resolution time based on the timeout
          \param the host to resolve.
-         \return the HMTimeStamp of the next time to schedule a Remote check.
+         \return the HMMonotonicTime of the next time to schedule a Remote check.
      */
-    HMTimeStamp nextCheckTime(const std::string& name, const HMDataHostCheck& dataHostCheck) const;
+    HMMonotonicTime nextCheckTime(const std::string& name, const HMDataHostCheck& dataHostCheck) const;
 
     //! Start a Remote check.
     /*!
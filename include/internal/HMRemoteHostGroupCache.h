@@ -67,9 +67,9 @@ public:
     /*!
          Get the next resolution time based on the timeout
          \param the host to resolve.
-         \return the HMTimeStamp of the next time to schedule a Remote check.
+         \return the HMMonotonicTime of the next time to schedule a Remote check.
      */
-    HMTimeStamp nextCheckTime(const std::string& name) const;
+    HMMonotonicTime nextCheckTime(const std::string& name) const;
 
     //! Start a Remote check.
     /*!
@@ -105,6 +105,27 @@ public:
      */
     void updateResultTime(const std::string& name, const HMTimeStamp& resultTime);
 
+    //! Get the position of the result delta fetches of a hostgroup.
+    /*!
+         Get the remote host and the sequence the last delta fetch of a hostgroup ended at.
+         \param the hostgroupname.
+         \param set to the address of the remote host.
+         \param set to the epoch of the remote results.
+         \param set to the sequence of the remote results.
+         \return false if the hostgroup is not in the cache.
+     */
+    bool getSubscription(const std::string& name, HMIPAddress& peer, uint64_t& epoch, uint64_t& sequence) const;
+
+    //! Set the position of the result delta fetches of a hostgroup.
+    /*!
+         Set the remote host and the sequence the last delta fetch of a hostgroup ended at.
+         \param the hostgroupname.
+         \param the address of the remote host.
+         \param the epoch of the remote results, 0 to resync on the next fetch.
+         \param the sequence of the remote results.
+     */
+    void setSubscription(const std::string& name, const HMIPAddress& peer, uint64_t epoch, uint64_t sequence);
+
 private:
     std::map<std::string, HMRemoteResult> m_cache;
 };
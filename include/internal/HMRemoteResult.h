@@ -10,7 +10,7 @@
 #include <vector>
 #include <cstdint>
 
-#include "HMTimeStamp.h"
+#include "HMMonotonicTime.h"
 #include "HMConstants.h"
 #include "HMIPAddress.h"
 
@@ -26,7 +26,9 @@ public:
     HMRemoteResult() :
         m_checkState(HM_CHECK_INACTIVE),
         m_remoteTimeout(HM_DEFAULT_CHECK_TIMEOUT),
-        m_remoteTTL(HM_DEFAULT_TTL) {};
+        m_remoteTTL(HM_DEFAULT_TTL),
+        m_subscribeEpoch(0),
+        m_subscribeSequence(0) {};
 
     HMRemoteResult(HMRemoteResult&& k)
     {
@@ -35,12 +37,18 @@ public:
         m_checkState = k.m_checkState;
         m_checkTime = k.m_checkTime;
         m_resultTime = k.m_resultTime;
+        m_lastResult = k.m_lastResult;
+        m_subscribePeer = k.m_subscribePeer;
+        m_subscribeEpoch = k.m_subscribeEpoch;
+        m_subscribeSequence = k.m_subscribeSequence;
     }
 
     HMRemoteResult(uint64_t ttl, uint64_t timeout) :
         m_checkState(HM_CHECK_INACTIVE),
         m_remoteTimeout(timeout),
-        m_remoteTTL(ttl) {};
+        m_remoteTTL(ttl),
+        m_subscribeEpoch(0),
+        m_subscribeSequence(0) {};
 
     //! Update the internal timeout values after updating an entry.
     /*!
@@ -60,9 +68,9 @@ public:
 	/*!
 	     Start the Remote check for this result.
 	     Sets the internal state to HM_CHECK_IN_PROGRESS.
-	     \return the HMTimeStamp with the check timeout value. (To determine when to reschedule in case of timeout.)
+	     \return the HMMonotonicTime with the check timeout value. (To determine when to reschedule in case of timeout.)
 	 */
-	HMTimeStamp startCheck();
+	HMMonotonicTime startCheck();
 
 	//! Finish the Remote check for this result.
 	/*!
@@ -81,9 +89,9 @@ public:
 	//! Determine the time of the next required Remote check for this entry.
 	/*!
 	     Determine the time of the next required Remote check for this entry.
-	     \return HMTimeStamp of the next required Remote check for this entry.
+	     \return HMMonotonicTime of the next required Remote check for this entry.
 	 */
-	HMTimeStamp nextCheckTime() const;
+	HMMonotonicTime nextCheckTime() const;
 
 	//! Get the TTL of this Remote check.
 	/*!
@@ -113,16 +121,40 @@ public:
      */
     void setResultTime(const HMTimeStamp& resultTime);
 
+    //! Get the position of the result delta fetches.
+    /*!
+         Get the remote host and the sequence the last delta fetch ended at.
+         \param set to the address of the remote host.
+         \param set to the epoch of the remote results.
+         \param set to the sequence of the remote results.
+     */
+    void getSubscription(HMIPAddress& peer, uint64_t& epoch, uint64_t& sequence) const;
+
+    //! Set the position of the result delta fetches.
+    /*!
+         Set the remote host and the sequence the last delta fetch ended at. A 0 epoch makes the next fetch resync.
+         \param the address of the remote host.
+         \param the epoch of the remote results.
+         \param the sequence of the remote results.
+     */
+    void setSubscription(const HMIPAddress& peer, uint64_t epoch, uint64_t sequence);
+
 private:
 
 	mutable std::shared_timed_mutex m_resultLock;
 
 	HM_WORK_STATE m_checkState;
-	HMTimeStamp m_checkTime;
+	HMMonotonicTime m_checkTime;
 	HMTimeStamp m_resultTime;
+	//! The monotonic time of m_resultTime, used to schedule the next check.
+	HMMonotonicTime m_lastResult;
 
 	uint64_t m_remoteTimeout;
 	uint64_t m_remoteTTL;
+
+	HMIPAddress m_subscribePeer;
+	uint64_t m_subscribeEpoch;
+	uint64_t m_subscribeSequence;
 };
 
 #endif /* HMREMOTERESULT_H_ */
@@ -0,0 +1,151 @@
+// Copyright 2019, Oath Inc.
+// Licensed under the terms of the Apache 2.0 license. See LICENSE file in the root of the distribution for licensing details.
+#ifndef HMRINGBUFFER_H_
+#define HMRINGBUFFER_H_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+//! Bounded lock free ring buffer.
+/*!
+     Bounded lock free ring buffer for many producers and consumers.
+     Each slot carries a sequence number telling whether it is ready to be written or read for the current lap,
+     so a push or a pop only needs a compare and swap on the shared position and never takes a lock.
+     The capacity is rounded up to a power of two.
+     Items are moved in and out of the ring and a failed push leaves the item with the caller.
+ */
+template <class T>
+class HMRingBuffer
+{
+public:
+    HMRingBuffer(uint64_t capacity) :
+        m_enqueuePos(0),
+        m_dequeuePos(0)
+    {
+        uint64_t size = 2;
+        while(size < capacity)
+        {
+            size <<= 1;
+        }
+        m_mask = size - 1;
+        m_cells.reset(new Cell[size]);
+        for(uint64_t i = 0; i < size; i++)
+        {
+            m_cells[i].m_sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    HMRingBuffer(const HMRingBuffer&) = delete;
+    HMRingBuffer& operator=(const HMRingBuffer&) = delete;
+
+    //! Add an item to the ring.
+    /*!
+         Add an item to the ring.
+         \param the item to move into the ring. It is left untouched if the ring is full.
+         \return false if the ring is full.
+     */
+    bool push(T& item)
+    {
+        uint64_t pos = m_enqueuePos.load(std::memory_order_relaxed);
+        while(true)
+        {
+            Cell& cell = m_cells[pos & m_mask];
+            uint64_t seq = cell.m_sequence.load(std::memory_order_acquire);
+            int64_t diff = (int64_t)seq - (int64_t)pos;
+            if(diff == 0)
+            {
+                if(m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    cell.m_data = std::move(item);
+                    cell.m_sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if(diff < 0)
+            {
+                return false;
+            }
+            else
+            {
+                pos = m_enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    //! Remove the oldest item from the ring.
+    /*!
+         Remove the oldest item from the ring.
+         \param the item to move the oldest item into.
+         \return false if the ring is empty.
+     */
+    bool pop(T& item)
+    {
+        uint64_t pos = m_dequeuePos.load(std::memory_order_relaxed);
+        while(true)
+        {
+            Cell& cell = m_cells[pos & m_mask];
+            uint64_t seq = cell.m_sequence.load(std::memory_order_acquire);
+            int64_t diff = (int64_t)seq - (int64_t)(pos + 1);
+            if(diff == 0)
+            {
+                if(m_dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    item = std::move(cell.m_data);
+                    cell.m_sequence.store(pos + m_mask + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if(diff < 0)
+            {
+                return false;
+            }
+            else
+            {
+                pos = m_dequeuePos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    //! Get the number of items in the ring. Only a snapshot while producers or consumers are active.
+    uint64_t size() const
+    {
+        uint64_t enqueue = m_enqueuePos.load(std::memory_order_relaxed);
+        uint64_t dequeue = m_dequeuePos.load(std::memory_order_relaxed);
+        return (enqueue > dequeue) ? enqueue - dequeue : 0;
+    }
+
+    //! Check if the ring is empty. Only a snapshot while producers or consumers are active.
+    bool empty() const
+    {
+        return size() == 0;
+    }
+
+    //! Get the number of items the ring can hold.
+    uint64_t capacity() const
+    {
+        return m_mask + 1;
+    }
+
+private:
+
+    //! A slot in the ring.
+    class Cell
+    {
+    public:
+        std::atomic<uint64_t> m_sequence;
+        T m_data;
+    };
+
+    std::unique_ptr<Cell[]> m_cells;
+    uint64_t m_mask;
+    // Keep the positions on separate cache lines so producers and consumers don't contend
+    char m_pad0[64];
+    std::atomic<uint64_t> m_enqueuePos;
+    char m_pad1[64];
+    std::atomic<uint64_t> m_dequeuePos;
+    char m_pad2[64];
+};
+
+#endif /* HMRINGBUFFER_H_ */
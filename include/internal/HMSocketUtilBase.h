@@ -6,7 +6,7 @@
 #include <mutex>
 
 #include "HMConstants.h"
-#include "HMTimeStamp.h"
+#include "HMMonotonicTime.h"
 #include "HMIPAddress.h"
 
 class HMDataCheckResult;
@@ -104,6 +104,21 @@ public:
             timeval &tv, const HMHash& hash,
             std::vector<HMGroupCheckResult>& results);
 
+    /*!
+         Called to receive the Host group results changed since the last fetch from remote host specified in check.
+         \param name of the hostgroup.
+         \param timeout period
+         \param hash value expected
+         \param the epoch of the last fetch, set to the epoch of the remote results.
+         \param the sequence of the last fetch, set to the sequence of the remote results.
+         \param set to true if all the results were sent instead of a delta.
+         \param Datastructure to store results
+         \return Status of results fetch.
+     */
+    HM_SOCK_DATA_STATUS getHostGroupDelta(std::string& hostGroupName,
+            timeval &tv, const HMHash& hash, uint64_t& epoch, uint64_t& sequence,
+            bool& resync, std::vector<HMGroupCheckResult>& results);
+
     /*!
          Called to receive Load Feedback results from remote host.
          \param name of the host.
@@ -147,7 +162,7 @@ public:
     //! Called to get the error message.
     const std::string& getErrorMsg() const;
     //! Called to get the connect time.
-    const HMTimeStamp& getConnectTime() const;
+    const HMMonotonicTime& getConnectTime() const;
 
     //! Called to check if the connection needs to be reset.
     bool isConnectionReset() const;
@@ -172,7 +187,7 @@ protected:
     int m_socket;
     HM_REASON m_reason;
     std::string m_errorMsg;
-    HMTimeStamp m_connectTime;
+    HMMonotonicTime m_connectTime;
     std::mutex m_mutex;
 
     //! Called to reset the connection.
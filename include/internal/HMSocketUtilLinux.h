@@ -11,7 +11,7 @@
 #include <sys/time.h>
 
 #include "HMConstants.h"
-#include "HMTimeStamp.h"
+#include "HMMonotonicTime.h"
 #include "HMIPAddress.h"
 #include "HMControlBase.h"
 //! Class to help linux socket communication.
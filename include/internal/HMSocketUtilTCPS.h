@@ -12,7 +12,7 @@
 #include <openssl/ssl.h>
 #include <openssl/err.h>
 #include "HMConstants.h"
-#include "HMTimeStamp.h"
+#include "HMMonotonicTime.h"
 #include "HMIPAddress.h"
 #include "HMControlBase.h"
 #include "HMSocketUtilTCP.h"
@@ -39,10 +39,17 @@ public:
     HMSocketUtilTCPS(const HMSocketUtilTCPS&) = delete;
     //! Called to close the socket.
     void closeSocket();
+    //! Get the time the TCP connect completed.
+    /*!
+         Get the time the TCP connect completed, before the TLS handshake. getConnectTime returns the end of the handshake.
+         \return the time the TCP connect completed.
+     */
+    const HMMonotonicTime& getTCPConnectTime() const;
 private:
     HMSocketUtilTCPS();
     SSL_CTX* m_ctx;
     SSL* m_ssl;
+    HMMonotonicTime m_tcpConnectTime;
     /*!
          Called to send data across the socket.
          \param data buffer.
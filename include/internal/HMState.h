@@ -18,6 +18,11 @@
 #include "HMConnectionHandler.h"
 #include "HMRemoteHostGroupCache.h"
 #include "HMRemoteHostCache.h"
+#include "HMTLSIdentity.h"
+#include "HMThreadPoolController.h"
+#include "HMCheckSchedule.h"
+#include "HMDestinationLimiter.h"
+#include "HMWorkClassQueue.h"
 
 //! The SSL context class for HealthMon.
 /*!
@@ -41,6 +46,7 @@ private:
      All configuration parsing and reload logic is inside this class.
  */
 class HMStorageHostGroupMDBM;
+class HMEventLoop;
 class HMState
 {
 public:
@@ -64,6 +70,11 @@ public:
         m_dnsRetries(HM_DEFAULT_DNS_RETRIES),
         m_nMaxThreads(1),
         m_nMinThreads(1),
+        m_connectEngineThreads(HM_DEFAULT_CONNECT_ENGINE_THREADS),
+        m_curlEngineThreads(HM_DEFAULT_CURL_ENGINE_THREADS),
+        m_maxBodySize(HM_DEFAULT_MAX_BODY_SIZE),
+        m_dnsResolver(false),
+        m_dnsResolverThreads(HM_DEFAULT_DNS_RESOLVER_THREADS),
         m_connectionTimeout(3000),
         m_logClass(HM_LOG_PLUGIN_TEXT),
         m_logLevel(HM_LOG_NOTICE),
@@ -73,11 +84,15 @@ public:
         m_auxPolicy(HM_STORAGE_COMMIT_ALWAYS),
         m_healthCheckPolicy(HM_STORAGE_COMMIT_ALWAYS),
         m_storageLockPolicy(HM_STORAGE_RW_LOCKS),
+        m_storageQueueSize(HM_DEFAULT_STORAGE_QUEUE_SIZE),
+        m_storageBatchSize(HM_DEFAULT_STORAGE_BATCH_SIZE),
+        m_storageOverflowPolicy(HM_STORAGE_OVERFLOW_BLOCK),
         m_controlSocketCheckPortv4(HM_CONTROL_SOCKET_DEFAULT_PORTV4),
         m_controlSocketCheckPortv6(HM_CONTROL_SOCKET_DEFAULT_PORTV6),
         m_enableSecureRemote(false),
         m_enableMutualAuth(true),
         m_enableSharedConnection(false),
+        m_enableRemoteSubscribe(false),
         m_maxConnections(HM_DEFAULT_REMOTE_CONNECTIONS),
         m_libEventEnabled(false),
         m_flowType(HM_FLOW_REMOTE_HOST_TYPE),
@@ -86,6 +101,11 @@ public:
     {
         m_control_socket.push_back(HM_CONTROL_SOCKET_LINUX);
     }
+    //! Copy the master params and the host groups of a state.
+    /*!
+         Copy the master params and the host groups of a state, used for the transaction states. The check list and
+         the caches are not copied. The host lists are shared with the source host groups until they are changed.
+     */
     HMState(HMState&);
 
     ~HMState() {}
@@ -254,6 +274,69 @@ public:
      */
     uint64_t getMinThreads();
 
+    //! Get the thread pool sizing and recycling parameters.
+    /*!
+            Get the thread pool sizing and recycling parameters.
+            \return the thread pool config.
+     */
+    const HMThreadPoolConfig& getThreadPoolConfig() const;
+
+    //! Get the parameters spreading the health checks over time.
+    /*!
+            Get the parameters spreading the health checks over time.
+            \return the check schedule config.
+     */
+    const HMCheckScheduleConfig& getCheckScheduleConfig() const;
+
+    //! Get the limits on the checks sent to each destination.
+    /*!
+            Get the limits on the checks sent to each destination.
+            \return the destination limit config.
+     */
+    const HMDestinationLimitConfig& getDestinationLimitConfig() const;
+
+    //! Get the parameters sharing the workers between the work classes.
+    /*!
+            Get the parameters sharing the workers between the work classes.
+            \return the work queue config.
+     */
+    const HMWorkQueueConfig& getWorkQueueConfig() const;
+
+    //! Get the number of threads used by the epoll TCP connect engine.
+    /*!
+            Get the number of threads used by the epoll TCP connect engine. Only used when the TCP check type is epoll.
+            \return the number of connect engine threads.
+     */
+    uint32_t getConnectEngineThreads() const;
+
+    //! Get the number of threads used by the curl multi engine for HTTP/S checks.
+    /*!
+            Get the number of threads used by the curl multi engine for HTTP/S checks. Only used when the HTTP check type is multi.
+            \return the number of curl engine threads.
+     */
+    uint32_t getCurlEngineThreads() const;
+
+    //! Get the max size of a body fetched by the curl checks.
+    /*!
+            Get the max number of bytes an aux fetch keeps, or an HTTP/S check reads while looking for the check-expect string.
+            \return the max body size in bytes.
+     */
+    uint64_t getMaxBodySize() const;
+
+    //! Check if the DNS lookups and DNS health checks use the epoll DNS resolver.
+    /*!
+            Check if the DNS lookups and DNS health checks use the epoll DNS resolver instead of a blocking ares loop on the worker thread.
+            \return true if the DNS resolver is enabled.
+     */
+    bool isDNSResolverEnabled() const;
+
+    //! Get the number of threads used by the epoll DNS resolver.
+    /*!
+            Get the number of threads used by the epoll DNS resolver. Only used when the DNS resolver is enabled.
+            \return the number of DNS resolver threads.
+     */
+    uint32_t getDNSResolverThreads() const;
+
     //! Get the current default DNS resolution timeout.
     /*!
             Get the current default DNS resolution timeout.
@@ -317,6 +400,13 @@ public:
      */
     void setSocketPath(const std::string& path);
 
+    //! Set the number of threads used by the curl multi engine.
+    /*!
+         Set the number of threads used by the curl multi engine.
+         \param the number of curl engine threads.
+     */
+    void setCurlEngineThreads(uint32_t threads);
+
     //! Load all the configs.
     /*!
          Load all the configs as defined in the master config parse.
@@ -358,7 +448,7 @@ public:
 
     //! Force a health check for all hosts within a specific host group.
     /*!
-         Force a health check for all hosts within a specific host group.
+         Force a health check for all hosts within a specific host group. The checks are queued in the control work class.
          \param the host group to force a check now.
          \param the work queue to schedule the check.
      */
@@ -366,7 +456,7 @@ public:
 
     //! Force a health check for a specific host.
     /*!
-         Force a health check for a specific host.
+         Force a health check for a specific host. The checks are queued in the control work class.
          \param the host group to force a check now.
          \param the host within the host group to force the check.
          \param the work queue to schedule the check.
@@ -412,6 +502,22 @@ public:
     //! Close the backend.
     void closeBackend();
 
+    //! Diff the host groups against the running state.
+    /*!
+         Diff the host groups against the host groups of the running state before a reload. A host group is unchanged when its hash
+         and its host check are the same in both states. The checks of the unchanged host groups keep their results and their
+         scheduled timeouts, they are neither restored one address at a time nor rescheduled.
+         \param the running state.
+     */
+    void diffHostGroups(const HMState& src);
+
+    //! Get the host groups unchanged by the reload.
+    /*!
+         Get the host groups found unchanged by diffHostGroups.
+         \return the set of unchanged host group names.
+     */
+    const std::set<std::string>& getUnchangedHostGroups() const;
+
     //! Copy the current check state.
     /*!
          Copy the current check state from the src to this check state instance. Copies the checklist and DNS cache results. Only copies the results. The configs should be pre-loaded in the target state class.
@@ -423,10 +529,12 @@ public:
     //! Reschedule HealthChecks on a reload.
     /*!
          Reschedule HealthChecks on a reload. Forces stale and updated health checks to be queued for checking upon completion of a reload.
+         The forced checks are spread by the check schedule of the event loop.
          \param the src of the checks before reload.
          \param the current work queue.
+         \param the event loop to schedule the spread checks.
      */
-    void resheduleHealthChecks(std::shared_ptr<HMState> src, HMWorkQueue& workQueue);
+    void resheduleHealthChecks(std::shared_ptr<HMState> src, HMWorkQueue& workQueue, HMEventLoop& eventLoop);
 
     //! Reschedule DNS checks on a reload.
     /*!
@@ -485,6 +593,9 @@ public:
 
     //! Get the health check CA certificate file contents
     const std::string& getHealthCheckCert() const;
+
+    //! Get the parsed client identity used for the mTLS health checks, nullptr if none is configured.
+    std::shared_ptr<HMTLSIdentity> getHealthCheckIdentity() const;
     
     //! Get the current mode of Master-Slave.
     bool isMasterMode() const;
@@ -522,6 +633,9 @@ public:
     //! Enable shared connection for remote checks
     bool isEnableSharedConnection() const;
 
+    //! Enable delta fetches of the remote host group results
+    bool isEnableRemoteSubscribe() const;
+
     //! Get the max number of remote connection per connection type
     uint8_t getMaxConnections() const;
 
@@ -567,6 +681,15 @@ private:
      */
     bool parseMasterYaml(const std::string& masterConfig);
 
+    //! Restore the DNS cache entries of a host from the running state.
+    void restoreDNSEntry(HMState& src, const std::string& hostname, const HMDataHostCheck& hostCheck);
+
+    //! Requeue the DNS lookups of a host whose TTL grew in the reload.
+    void resheduleDNSCheck(HMState& src, const std::string& hostname, const HMDataHostCheck& hostCheck, HMWorkQueue& workQueue);
+
+    //! The host groups unchanged since the running state, set by diffHostGroups.
+    std::set<std::string> m_unchangedHostGroups;
+
     std::vector<std::string> m_configDirs;
     std::vector<std::string> m_configFiles;
 
@@ -593,6 +716,15 @@ private:
 
     uint32_t m_nMaxThreads;
     uint32_t m_nMinThreads;
+    HMThreadPoolConfig m_threadPoolConfig;
+    HMCheckScheduleConfig m_checkScheduleConfig;
+    HMDestinationLimitConfig m_destinationLimitConfig;
+    HMWorkQueueConfig m_workQueueConfig;
+    uint32_t m_connectEngineThreads;
+    uint32_t m_curlEngineThreads;
+    uint64_t m_maxBodySize;
+    bool m_dnsResolver;
+    uint32_t m_dnsResolverThreads;
     uint64_t m_connectionTimeout;
 
     HM_LOG_PLUGIN_CLASS m_logClass;
@@ -607,6 +739,9 @@ private:
     HM_STORAGE_COMMIT_POLICY m_auxPolicy;
     HM_STORAGE_COMMIT_POLICY m_healthCheckPolicy;
     HM_STORAGE_LOCK_POLICY m_storageLockPolicy;
+    uint64_t m_storageQueueSize;
+    uint32_t m_storageBatchSize;
+    HM_STORAGE_OVERFLOW_POLICY m_storageOverflowPolicy;
     uint16_t m_controlSocketCheckPortv4;
     uint16_t m_controlSocketCheckPortv6;
     HMHash m_hash;
@@ -614,6 +749,7 @@ private:
     std::string m_healthCheckCAFile;
     std::string m_healthCheckKey;
     std::string m_healthCheckCert;
+    std::shared_ptr<HMTLSIdentity> m_healthCheckIdentity;
     std::vector<HM_CONTROL_SOCKET> m_control_socket;
     bool m_enableSecureRemote;
     std::string m_certFile;
@@ -622,6 +758,7 @@ private:
     std::string m_PubSubConfigFile;
     bool m_enableMutualAuth;
     bool m_enableSharedConnection;
+    bool m_enableRemoteSubscribe;
     uint8_t m_maxConnections;
     bool m_libEventEnabled;
     HM_FLOW_TYPE m_flowType;
@@ -13,6 +13,11 @@
 #include "HMDNSCache.h"
 #include "HMLogBase.h"
 #include "HMHostMark.h"
+#include "HMConnectEngine.h"
+#include "HMCurlEngine.h"
+
+class HMDNSResolver;
+class HMControlReactor;
 
 class HMThreadPool;
 class HMCommandListenerBase;
@@ -29,6 +34,7 @@ public:
          Grab the latest version of the loaded state.
          Various classes in the codebase can keep a shared pointer on the state. Calling the update function at set times allows the work to finish and smoothly switch to a new state.
          During a reload, the reloader will only garbage collect when the work has updated the shared pointer.
+         The state is published and read with the atomic shared pointer operations so the readers never race a swap.
      */
     bool updateState(std::shared_ptr<HMState>& current);
 
@@ -129,6 +135,20 @@ public:
      */
     uint64_t getIdleThreads();
 
+    //! Get the work pool info.
+    /*!
+         Get the number of threads, the sizing controller state and the resource usage of the work pool.
+         \param the thread info to fill in.
+     */
+    void getThreadInfo(HMAPIThreadInfo& info);
+
+    //! Get the storage info.
+    /*!
+         Get the commit queue policy and counters of the current backend store.
+         \param the store info to fill in.
+     */
+    void getStoreInfo(HMAPIStoreInfo& info);
+
     //! Get the number of timeouts in the event loop.
     /*!
          Get the number of timeout in the event loop.
@@ -143,6 +163,34 @@ public:
      */
     HMEventLoopLibEvent* getLibEvent() { return m_libEvent; }
 
+    //! Get a pointer to the connect engine for non-blocking TCP checks.
+    /*!
+         Get a pointer to the connect engine for non-blocking TCP checks.
+         \return a pointer to the running HMConnectEngine or nullptr if the TCP checks are not using the engine.
+     */
+    HMConnectEngine* getConnectEngine() { return m_connectEngine; }
+
+    //! Get a pointer to the curl multi engine for non-blocking HTTP/S checks.
+    /*!
+         Get a pointer to the curl multi engine for non-blocking HTTP/S checks.
+         \return a pointer to the running HMCurlEngine or nullptr if the HTTP/S checks are not using the engine.
+     */
+    HMCurlEngine* getCurlEngine() { return m_curlEngine; }
+
+    //! Get a pointer to the DNS resolver for non-blocking DNS lookups and DNS checks.
+    /*!
+         Get a pointer to the DNS resolver for non-blocking DNS lookups and DNS checks.
+         \return a pointer to the running HMDNSResolver or nullptr if the DNS lookups are not using the resolver.
+     */
+    HMDNSResolver* getDNSResolver() { return m_dnsResolver; }
+
+    //! Get a pointer to the control reactor serving the control socket connections.
+    /*!
+         Get a pointer to the control reactor serving the control socket connections.
+         \return a pointer to the running HMControlReactor or nullptr if it is not running.
+     */
+    HMControlReactor* getControlReactor() { return m_controlReactor; }
+
     //! Get the current log level.
     /*!
          Get the current log level for the running logger.
@@ -252,11 +300,17 @@ private:
     HMEventLoop* m_eventLoop;
     HMThreadPool* m_threadPool;
     HMEventLoopLibEvent* m_libEvent;
+    HMConnectEngine* m_connectEngine;
+    HMCurlEngine* m_curlEngine;
+    HMDNSResolver* m_dnsResolver;
+    HMControlReactor* m_controlReactor;
 
     std::mutex m_reloadMutex;
 
+    //! The running state, only accessed through the atomic shared pointer operations outside the reload thread.
     std::shared_ptr<HMState> m_currentState;
     std::shared_ptr<HMState> m_newState;
+    //! The transaction state, only accessed through the atomic shared pointer operations.
     std::shared_ptr<HMState> m_newTransactionState;
     std::vector<std::unique_ptr<HMCommandListenerBase>> m_listener;
     bool m_enableRemoteQueryReply;
@@ -4,6 +4,9 @@
 #define HMSTORAGE_H_
 
 #include <string>
+#include <vector>
+#include <atomic>
+#include <unordered_map>
 #include <openssl/evp.h>
 
 #include "HMIPAddress.h"
@@ -13,11 +16,11 @@
 #include "HMDataCheckResult.h"
 #include "HMDataCheckList.h"
 #include "HMDNSCache.h"
-#include "HMUtilitySpinLock.h"
 #include "HMAuxCache.h"
 #include "HMHashMD5.h"
 #include "HMRemoteHostGroupCache.h"
 #include "HMRemoteHostCache.h"
+#include "HMAPI.h"
 
 class HMDataCheckList;
 class HMStorageHostGroup;
@@ -31,20 +34,140 @@ class HMGroupCheckResult
 {
 public:
     HMGroupCheckResult() :
-        m_backendStale(false) {}
+        m_backendStale(false),
+        m_sequence(0),
+        m_revision(0) {}
     HMGroupCheckResult(const std::string& hostName, const HMIPAddress& address, const HMDataCheckResult& result) :
         m_hostName(hostName),
         m_address(address),
         m_backendStale(false),
+        m_sequence(0),
+        m_revision(0),
         m_result(result) { m_commitTime = HMTimeStamp::now(); }
 
     std::string m_hostName;
     HMIPAddress m_address;
     bool m_backendStale;
     HMTimeStamp m_commitTime;
+    //! The sequence number of the host group results when the status, address, reason or forced state of this result last changed.
+    uint64_t m_sequence;
+    //! Stamp of the last change to this result, unique across all the host groups. The stores compare it to write only the changed results.
+    uint64_t m_revision;
     HMDataCheckResult m_result;
 };
 
+//! The cached check results of a host group.
+/*!
+     The cached check results of a host group, indexed by host name and address so an update finds its result
+     without scanning the group. Results are iterated in no particular order.
+     The host name, the address and the check result must not be changed through the iterators, use setAddress
+     and setResult.
+     A change of the status, address, reason or forced state stamps the result with the next sequence number of
+     the group, so the results changed since a sequence can be fetched. Every change stamps it with a new revision. The epoch identifies the sequence, it changes each time the group is recreated.
+ */
+class HMGroupCheckResults
+{
+public:
+    HMGroupCheckResults();
+
+    //! Find the result of a host and address.
+    /*!
+         Find the result of a host and address.
+         \param the host name.
+         \param the address.
+         \return the result, nullptr if there is none.
+     */
+    HMGroupCheckResult* find(const std::string& hostName, const HMIPAddress& address);
+
+    //! Find the result an update applies to.
+    /*!
+         Find the result an update applies to, the result of the address or else the result
+         stored before an address of the same family was known.
+         \param the host name.
+         \param the address of the update.
+         \return the result, nullptr if there is none.
+     */
+    HMGroupCheckResult* findUpdate(const std::string& hostName, const HMIPAddress& address);
+
+    //! Insert a result.
+    /*!
+         Insert a result, replacing the result of the same host and address if there is one.
+         \param the result to insert.
+         \return the inserted result.
+     */
+    HMGroupCheckResult* insert(const HMGroupCheckResult& result);
+
+    //! Set the check result of a result.
+    /*!
+         Set the check result of a result. The sequence is only moved if the status, address, reason or forced state changed.
+         \param the result as returned by find or findUpdate.
+         \param the new check result.
+     */
+    void setResult(HMGroupCheckResult* result, const HMDataCheckResult& checkResult);
+
+    //! Replace all the results.
+    /*!
+         Replace all the results, only the results whose status, address, reason or forced state changed move the sequence.
+         \param the new results of the host group.
+     */
+    void assign(const std::vector<HMGroupCheckResult>& results);
+
+    //! Get the results changed since a sequence.
+    /*!
+         Get the results changed since a sequence. All the results are returned if the sequence cannot be resumed,
+         the epoch differs, results were erased since, or the sequence is ahead of the group.
+         \param the epoch of the sequence, set to the epoch of the group.
+         \param the sequence of the last fetch, set to the current sequence of the group.
+         \param vector to append the results to.
+         \return true if only the changed results were returned, false on a resync.
+     */
+    bool getDelta(uint64_t& epoch, uint64_t& sequence, std::vector<HMGroupCheckResult>& results) const;
+
+    //! Change the address of a result.
+    /*!
+         Change the address of a result and move it in the index. No other result of the host may hold the address.
+         \param the result as returned by find or findUpdate.
+         \param the new address.
+     */
+    void setAddress(HMGroupCheckResult* result, const HMIPAddress& address);
+
+    //! Erase the result of a host and address.
+    /*!
+         Erase the result of a host and address.
+         \param the host name.
+         \param the address.
+         \return true if a result was erased.
+     */
+    bool erase(const std::string& hostName, const HMIPAddress& address);
+
+    //! Erase all the results.
+    void clear();
+
+    //! Get the number of results.
+    size_t size() const { return m_results.size(); }
+
+    //! Get the number of hosts with a result.
+    size_t hostCount() const { return m_hostCount.size(); }
+
+    std::vector<HMGroupCheckResult>::iterator begin() { return m_results.begin(); }
+    std::vector<HMGroupCheckResult>::iterator end() { return m_results.end(); }
+    std::vector<HMGroupCheckResult>::const_iterator begin() const { return m_results.begin(); }
+    std::vector<HMGroupCheckResult>::const_iterator end() const { return m_results.end(); }
+
+private:
+    static std::string key(const std::string& hostName, const HMIPAddress& address);
+
+    std::vector<HMGroupCheckResult> m_results;
+    //! Position of the results in m_results by host name and address.
+    std::unordered_map<std::string, size_t> m_index;
+    //! Number of results of each host.
+    std::unordered_map<std::string, uint32_t> m_hostCount;
+    uint64_t m_epoch;
+    uint64_t m_sequence;
+    //! The sequence of the last erase, older sequences must resync.
+    uint64_t m_resyncSequence;
+};
+
 //! Convenience class to pass an entire host group check result update.
 /*!
      Convenience class to pass an entire host group check result update.
@@ -53,6 +176,7 @@ public:
 class HMGroupCheckUpdate
 {
     public:
+    HMGroupCheckUpdate() {}
     HMGroupCheckUpdate(const std::string& hostGroup,
             const std::string& hostName,
             const HMIPAddress& address,
@@ -102,6 +226,7 @@ public:
 class HMGroupAuxUpdate
 {
 public:
+    HMGroupAuxUpdate() {}
     HMGroupAuxUpdate(const std::string& hostGroup,
             const std::string& hostName,
             const HMIPAddress& address,
@@ -253,6 +378,7 @@ private:
      updateHostGroups - force the given host groups to be updated in the backend from the result information.
 
      getGroupCheckResults - return all the check results for a given host group.
+     getGroupCheckDelta - return the check results of a host group changed since a sequence.
      getGroupAuxInfo - return all the aux info for a given host group.
 
      getHostGroupNames - get all the host group names from the stored configs.
@@ -273,6 +399,10 @@ public:
         m_auxCommitPolicy(HM_STORAGE_COMMIT_ALWAYS),
         m_healthCheckCommitPolicy(HM_STORAGE_COMMIT_ALWAYS),
         m_lockPolicy(HM_STORAGE_RW_LOCKS),
+        m_queueSize(HM_DEFAULT_STORAGE_QUEUE_SIZE),
+        m_batchSize(HM_DEFAULT_STORAGE_BATCH_SIZE),
+        m_overflowPolicy(HM_STORAGE_OVERFLOW_BLOCK),
+        m_storeSleeping(false),
         m_hostGroupMap(hostGroupMap),
         m_dnsCache(dnsCache){}
 
@@ -301,7 +431,7 @@ public:
 
     //! Check the backend version for compatibility.
     /*!
-          Check the version of the backend database. Clear the data if the version does not match.
+          Check the version of the backend database. Migrate the data if it was written by an older supported version, otherwise clear the data if the version does not match.
           \param returns true if the database is ready for use.
     */
     bool validateDBVersion();
@@ -527,6 +657,21 @@ public:
     virtual bool getGroupCheckResults(const std::string& groupName,
                 std::vector<HMGroupCheckResult>& results) = 0;
 
+    //! Get the health check results of a host group changed since a sequence.
+    /*!
+         Get the health check results of a host group changed since a sequence, from the cache.
+         Backends without sequenced results return all the results with a 0 epoch.
+         \param the group name to get the results.
+         \param the epoch of the sequence, set to the current epoch.
+         \param the sequence of the last fetch, set to the current sequence.
+         \param results vector to store the check results (HMGroupCheckResult)
+         \return true if only the changed results were returned, false if all the results were returned.
+     */
+    virtual bool getGroupCheckDelta(const std::string& groupName,
+                uint64_t& epoch,
+                uint64_t& sequence,
+                std::vector<HMGroupCheckResult>& results);
+
     //! Get the aux info for a given host group.
     /*!
          Get the aux info for a given host group.
@@ -579,6 +724,23 @@ public:
      */
     void updateLockPolicy(HM_STORAGE_LOCK_POLICY lockPolicy);
 
+    //! Update the commit queue policy
+    /*!
+         Update the size, batch size and overflow policy of the queues holding the updates for the commit thread.
+         Must be called before the store is opened.
+         \param the number of updates each queue can hold.
+         \param the max number of updates the commit thread drains from a queue at once.
+         \param the new HM_STORAGE_OVERFLOW_POLICY.
+     */
+    virtual void updateQueuePolicy(uint64_t queueSize, uint32_t batchSize, HM_STORAGE_OVERFLOW_POLICY overflowPolicy);
+
+    //! Get the commit queue info.
+    /*!
+         Get the commit queue policy and counters.
+         \param the store info to fill in.
+     */
+    virtual void getStoreInfo(HMAPIStoreInfo& info);
+
 protected:
 
     //! Internal function to handle opening the database and initializing the data structures.
@@ -591,17 +753,39 @@ protected:
     //! Internal function to handle closing the backend storage.
     virtual bool closeBackend() = 0;
 
+    //! Internal function to migrate the backend from an older version.
+    /*!
+         Internal function to migrate the backend data written by an older version to the current layout.
+         In read only mode nothing is written, the backend only reports if it can read the older layout.
+         The default backend cannot migrate and the data is cleared instead.
+         \param the version of the stored data.
+         \return true if the backend is ready for use with the current version.
+     */
+    virtual bool migrateBackend(uint8_t version);
+
     //! Internal function called from the commit thread to have the derived class write out the saved health checks information to the backend.
     virtual bool commitHealthCheck() = 0;
 
     //! Internal function called from the commit thread to have the derived class write out the savedAux info information to the backend.
     virtual bool commitAuxInfo() = 0;
 
+    //! Internal function called from the commit thread before it sleeps to check if there is anything left to commit.
+    virtual bool pendingCommits() = 0;
+
+    //! Internal function called when the commit thread starts or stops.
+    /*!
+         Internal function called when the commit thread starts or stops. The derived class should stop blocking
+         the checks on its queues while the thread is stopped.
+         \param true if the commit thread is starting.
+     */
+    virtual void openQueues(bool open);
+
     //! The function running in a separate thread to commit the health check and aux info to the backend without blocking the main data path.
     void runStore();
 
-    HMUtilitySpinLock m_checkQueueSpinLock;
-    HMUtilitySpinLock m_auxQueueSpinLock;
+    //! Wake the commit thread if it is waiting for updates.
+    void wakeStore();
+
     std::mutex m_dataReadyMutex;
     std::condition_variable m_dataReadyCond;
     std::thread m_thread;
@@ -612,6 +796,10 @@ protected:
     HM_STORAGE_COMMIT_POLICY m_auxCommitPolicy;
     HM_STORAGE_COMMIT_POLICY m_healthCheckCommitPolicy;
     HM_STORAGE_LOCK_POLICY m_lockPolicy;
+    uint64_t m_queueSize;
+    uint32_t m_batchSize;
+    HM_STORAGE_OVERFLOW_POLICY m_overflowPolicy;
+    std::atomic<bool> m_storeSleeping;
 
     HMDataHostGroupMap* m_hostGroupMap;
     HMDNSCache* m_dnsCache;
@@ -6,6 +6,7 @@
 #include <queue>
 
 #include "HMStorage.h"
+#include "HMUtilitySpinLock.h"
 
 // Base class to handle storage per host
 /*!
@@ -478,7 +479,11 @@ protected:
     bool commitHealthCheck();
     //! Internal function called from the commit thread to have the derived class write out the savedAux info information to the backend.
     bool commitAuxInfo();
+    //! Internal function called from the commit thread before it sleeps to check if there is anything left to commit.
+    bool pendingCommits();
 
+    HMUtilitySpinLock m_checkQueueSpinLock;
+    HMUtilitySpinLock m_auxQueueSpinLock;
     std::queue<HMCheckData> m_storeCheckQueue;
     std::queue<HMAuxData> m_storeAuxQueue;
 };
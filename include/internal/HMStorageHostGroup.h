@@ -3,10 +3,13 @@
 #ifndef INCLUDE_HMSTORAGEHOSTGROUP_H_
 #define INCLUDE_HMSTORAGEHOSTGROUP_H_
 
+#include <map>
 #include <string>
 #include <vector>
+#include <unordered_map>
 
 #include "HMStorage.h"
+#include "HMStorageQueue.h"
 
 // Base class to handle storage per host group
 /*!
@@ -37,6 +40,9 @@
      storeHostGroupAuxInfo - Store the Aux info to the backend.
      getHostGroupGroupAuxInfo - Get the Aux info from the backend.
      removeHostGroupGroupAuxInfo - Remove the Aux info from the backend.
+
+     The checks hand their updates to the commit thread through bounded lock free queues. The commit thread drains
+     them in batches of up to the batch size and only commits the newest update for each host and address of a batch.
  */
 class HMStorageHostGroup : public HMStorage
 {
@@ -269,6 +275,20 @@ public:
     bool getGroupCheckResults(const std::string& groupName,
                 std::vector<HMGroupCheckResult>& results);
 
+    //! Get the health check results of a host group changed since a sequence.
+    /*!
+         Get the health check results of a host group changed since a sequence, from the cache.
+         \param the group name to get the results.
+         \param the epoch of the sequence, set to the current epoch.
+         \param the sequence of the last fetch, set to the current sequence.
+         \param results vector to store the check results (HMGroupCheckResult)
+         \return true if only the changed results were returned, false if all the results were returned.
+     */
+    bool getGroupCheckDelta(const std::string& groupName,
+                uint64_t& epoch,
+                uint64_t& sequence,
+                std::vector<HMGroupCheckResult>& results);
+
     //! Get the aux info for a given host group.
     /*!
          Get the aux info for a given host group.
@@ -300,6 +320,23 @@ public:
      */
     virtual bool getGroupInfo(const std::string& hostGroupName, HMDataHostGroup& hostGroup) = 0;
 
+    //! Update the commit queue policy
+    /*!
+         Update the size, batch size and overflow policy of the queues holding the updates for the commit thread.
+         Must be called before the store is opened.
+         \param the number of updates each queue can hold.
+         \param the max number of updates the commit thread drains from a queue at once.
+         \param the new HM_STORAGE_OVERFLOW_POLICY.
+     */
+    void updateQueuePolicy(uint64_t queueSize, uint32_t batchSize, HM_STORAGE_OVERFLOW_POLICY overflowPolicy);
+
+    //! Get the commit queue info.
+    /*!
+         Get the commit queue policy and counters.
+         \param the store info to fill in.
+     */
+    void getStoreInfo(HMAPIStoreInfo& info);
+
 protected:
     //! Internal function to handle opening the database and initializing the data structures.
     /*!
@@ -421,6 +458,37 @@ protected:
     bool commitHealthCheck();
     //! Internal function called from the commit thread to have the derived class write out the savedAux info information to the backend.
     bool commitAuxInfo();
+    //! Internal function called from the commit thread before it sleeps to check if there is anything left to commit.
+    bool pendingCommits();
+    //! Internal function called when the commit thread starts or stops to open or close the commit queues.
+    void openQueues(bool open);
+
+    //! Internal function to apply a single health check update to the cache.
+    /*!
+         Internal function to apply a single health check update to the cache. The backend is not written.
+         \param the update to apply.
+         \param set to true if the update added a new result to the host group.
+         \return true if the update was applied to the cache.
+     */
+    bool applyCheckUpdate(HMGroupCheckUpdate& update, bool& coldStart);
+
+    //! Internal function to commit the cached check results of a host group.
+    /*!
+         Internal function to commit the cached check results of a host group to the backend as the commit policy requires.
+         Called once per host group for all the updates of a batch.
+         \param the host group to commit.
+         \param true if the updates added a new result to the host group.
+         \param true if the updates include the first host of the host group.
+     */
+    void commitGroupResults(const std::string& hostGroup, bool coldStart, bool firstHost);
+
+    //! Internal function to commit a single Aux info update.
+    /*!
+         Internal function to commit a single Aux info update to the cache, and to the backend as the commit policy requires.
+         \param the update to commit.
+         \return true if the update was committed.
+     */
+    bool commitAuxUpdate(HMGroupAuxUpdate& update);
 
     //! Internal function to get the cached host group info.
     /*!
@@ -441,12 +509,12 @@ protected:
     uint32_t getInternalCheckResults(const std::string& hostGroupName, std::vector<HMGroupCheckResult>& results);
 
     std::shared_timed_mutex m_checkUpdateMutex;
-    std::multimap<std::string, HMGroupCheckResult> m_hostGroupResults;
-    std::queue<HMGroupCheckUpdate> m_storeCheckQueue;
+    std::unordered_map<std::string, HMGroupCheckResults> m_hostGroupResults;
+    HMStorageQueue<HMGroupCheckUpdate> m_storeCheckQueue;
 
     std::shared_timed_mutex m_auxUpdateMutex;
     std::multimap<std::string, HMGroupAuxResult> m_hostGroupAux;
-    std::queue<HMGroupAuxUpdate> m_storeAuxQueue;
+    HMStorageQueue<HMGroupAuxUpdate> m_storeAuxQueue;
 };
 
 #endif /* INCLUDE_HMSTORAGEHOSTGROUP_H_ */
@@ -3,6 +3,8 @@
 #ifndef HMSTORAGEHOSTGROUPMDBM_H_
 #define HMSTORAGEHOSTGROUPMDBM_H_
 
+#include <map>
+#include <mutex>
 #include <mdbm.h>
 #include <mdbm_handle_pool.h>
 
@@ -25,8 +27,16 @@ const std::string HM_MDBM_CONFIG = "hm:config";
 const std::string HM_MDBM_GROUP_NAMES = "hm:groups";
 //! The prefix to use for the group information in the MDBM key.
 const std::string HM_MDBM_GROUP_PREFIX = "hm:group:";
-//! The prefix to use for the health check information in the MDBM key.
+//! The prefix to use for the single record host group health check information in the MDBM key. Only read to migrate older databases.
 const std::string HM_MDBM_CHECK_PREFIX = "hm:check:";
+//! The prefix to use for the host group health check index in the MDBM key.
+const std::string HM_MDBM_CHECK_INDEX_PREFIX = "hm:checkindex:";
+//! The prefix to use for the per host health check information in the MDBM key.
+const std::string HM_MDBM_CHECK_ENTRY_PREFIX = "hm:checkentry:";
+//! The marker starting a host group health check index in the compact layout. Older indexes start with their size.
+const uint32_t HM_MDBM_CHECK_INDEX_COMPACT = 0xFFFFC7C7;
+//! The version of the compact host group health check index layout.
+const uint8_t HM_MDBM_CHECK_INDEX_VERSION = 1;
 //! The prefix to use for the aux info information in the MDBM key.
 const std::string HM_MDBM_AUX_PREFIX = "hm:aux:";
 
@@ -178,6 +188,13 @@ private:
 };
 
 //! Main class to support storing information to an MDBM backend using the host group as the keys.
+/*!
+     Main class to support storing information to an MDBM backend using the host group as the keys.
+     The health check results of a host group are stored as one record per host and address, plus a group index
+     listing the records. Each store bumps the group generation and only rewrites the records that changed before
+     rewriting the index. Every record carries the generation it was written at, so a reader can detect a record
+     changed after it read the index and re-read the group to get a consistent view.
+ */
 class HMStorageHostGroupMDBM : public HMStorageHostGroup
 {
 public:
@@ -336,12 +353,122 @@ protected:
      */
     bool removeHostGroupGroupAuxInfo(const std::string& hostGroup);
 
+    // Internal function to migrate the backend from an older version.
+    /*!
+         Internal function to migrate the backend from an older version.
+         Converts the single record host group check results to the per host layout,
+         and rewrites the host group info in the versioned layout.
+         \param the version of the stored data.
+         \return true if the backend is ready for use with the current version.
+     */
+    bool migrateBackend(uint8_t version);
+
 private:
 
+    //! The record generation and the revision of the last stored result of a host in the group check index.
+    class CheckIndexEntry
+    {
+    public:
+        CheckIndexEntry() :
+            m_generation(0),
+            m_revision(0) {}
+
+        uint64_t m_generation;
+        uint64_t m_revision;
+    };
+
+    //! The group check index as last written to the backend.
+    class CheckIndex
+    {
+    public:
+        CheckIndex() :
+            m_generation(0) {}
+
+        uint64_t m_generation;
+        std::map<std::pair<std::string, HMIPAddress>, CheckIndexEntry> m_entries;
+    };
+
+    //! A check record to write and the revision of the result serialized in it.
+    class CheckRecord
+    {
+    public:
+        CheckRecord() :
+            m_revision(0) {}
+
+        uint64_t m_revision;
+        //! The record, the serialized result follows room for the record generation.
+        std::string m_data;
+    };
+
+    //! Internal function to get a copy of a record from the backend.
+    bool fetchRecord(const std::string& key, std::string& data);
+
+    //! Internal function to store a record to the backend.
+    bool storeRecord(const std::string& key, std::string& data);
+
+    //! Internal function to remove a record from the backend.
+    bool removeRecord(const std::string& key);
+
+    //! Internal function to build the key of the check record for a host.
+    std::string checkEntryKey(const std::string& hostGroupName, const std::string& hostName, const HMIPAddress& address) const;
+
+    // Internal function to read the group check index from the backend.
+    /*!
+         Internal function to read the group check index from the backend. The stored results are not filled in.
+         \param the host group name.
+         \param the check index to fill.
+         \return true if the index was found and parsed.
+     */
+    bool readCheckIndex(const std::string& hostGroupName, CheckIndex& index);
+
+    // Internal function to parse a group check index in the compact layout.
+    /*!
+         Internal function to parse a group check index in the compact layout.
+         \param the host group name.
+         \param the index record.
+         \param the check index to fill.
+         \return true if the index was parsed.
+     */
+    bool readCompactCheckIndex(const std::string& hostGroupName, const std::string& data, CheckIndex& index);
+
+    // Internal function to get the cached group check index.
+    /*!
+         Internal function to get the cached group check index, reading it from the backend on first use.
+         The caller must hold m_checkIndexMutex.
+         \param the host group name.
+         \return the cached check index of the group.
+     */
+    std::map<std::string, CheckIndex>::iterator loadCheckIndex(const std::string& hostGroupName);
+
+    // Internal function to write the check results of a group.
+    /*!
+         Internal function to write the check results of a group. The changed records are written, followed by the
+         group index, then the records of the removed hosts are dropped. The caller must hold m_checkIndexMutex.
+         \param the cached check index of the group, erased if the store fails.
+         \param the changed records keyed by host name and address.
+         \param the host names and addresses no longer in the group.
+         \return true if the results were stored successfully.
+     */
+    bool storeCheckEntries(std::map<std::string, CheckIndex>::iterator indexIt,
+            std::map<std::pair<std::string, HMIPAddress>, CheckRecord>& changed,
+            const std::vector<std::pair<std::string, HMIPAddress>>& removed);
+
+    // Internal function to get the check results stored in the single record layout.
+    /*!
+         Internal function to get the check results stored in the single record layout used by older versions.
+         \param the host group to get.
+         \param the vector to hold the HMGroupCheckResults.
+         \return true if the host group was retrieved successfully.
+     */
+    bool getLegacyHostGroupCheckResults(const std::string& hostGroup, std::vector<HMGroupCheckResult>& results);
+
     std::string m_mdbmPath;
     uint32_t m_openFlags;
 
     std::unique_ptr<MDBMPool> m_pool;
+
+    std::mutex m_checkIndexMutex;
+    std::map<std::string, CheckIndex> m_checkIndex;
 };
 
 #endif /* HMSTORAGEHOSTGROUPYFORMDBM_H_ */
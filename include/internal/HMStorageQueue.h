@@ -0,0 +1,233 @@
+// Copyright 2019, Oath Inc.
+// Licensed under the terms of the Apache 2.0 license. See LICENSE file in the root of the distribution for licensing details.
+#ifndef HMSTORAGEQUEUE_H_
+#define HMSTORAGEQUEUE_H_
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <condition_variable>
+
+#include "HMConstants.h"
+#include "HMRingBuffer.h"
+
+//! The counters of a storage queue.
+class HMStorageQueueStats
+{
+public:
+    HMStorageQueueStats() :
+        m_enqueued(0),
+        m_dropped(0),
+        m_blocked(0),
+        m_coalesced(0),
+        m_batches(0),
+        m_queued(0) {}
+
+    //! The number of updates accepted into the queue.
+    uint64_t m_enqueued;
+    //! The number of updates dropped by the overflow policy or while the queue was closed.
+    uint64_t m_dropped;
+    //! The number of times a check waited for room in the queue.
+    uint64_t m_blocked;
+    //! The number of updates replaced by a newer update for the same host and address in a batch.
+    uint64_t m_coalesced;
+    //! The number of batches drained by the storage thread.
+    uint64_t m_batches;
+    //! The number of updates waiting in the queue.
+    uint64_t m_queued;
+};
+
+//! Bounded queue of the updates waiting for the storage thread.
+/*!
+     Bounded queue of the updates waiting for the storage thread, built on a lock free ring so the checks never
+     contend on a lock to hand over their results.
+     When the ring is full the overflow policy decides if the check waits for the storage thread to make room,
+     or if the oldest update is dropped. A closed queue never blocks, the update is dropped instead.
+     The storage thread drains the updates in batches. Updates for the same key in a batch are coalesced,
+     only the newest is kept in the place of the first.
+ */
+template <class T>
+class HMStorageQueue
+{
+public:
+    HMStorageQueue() :
+        m_ring(new HMRingBuffer<T>(HM_DEFAULT_STORAGE_QUEUE_SIZE)),
+        m_size(HM_DEFAULT_STORAGE_QUEUE_SIZE),
+        m_policy(HM_STORAGE_OVERFLOW_BLOCK),
+        m_open(true),
+        m_waiting(0),
+        m_enqueued(0),
+        m_dropped(0),
+        m_blocked(0),
+        m_coalesced(0),
+        m_batches(0) {}
+
+    HMStorageQueue(const HMStorageQueue&) = delete;
+    HMStorageQueue& operator=(const HMStorageQueue&) = delete;
+
+    //! Set the size and the overflow policy of the queue.
+    /*!
+         Set the size and the overflow policy of the queue. The queue is cleared when its size changes,
+         so this must only be called while no update is pushed or drained.
+         \param the number of updates the queue can hold.
+         \param what to do with an update when the queue is full.
+     */
+    void setConfig(uint64_t size, HM_STORAGE_OVERFLOW_POLICY policy)
+    {
+        if(size != m_size)
+        {
+            m_size = size;
+            m_ring.reset(new HMRingBuffer<T>(size));
+        }
+        m_policy = policy;
+    }
+
+    //! Open or close the queue.
+    /*!
+         Open or close the queue. Checks waiting for room in a closed queue drop their update.
+         \param true to open the queue.
+     */
+    void setOpen(bool open)
+    {
+        std::lock_guard<std::mutex> lk(m_spaceMutex);
+        m_open = open;
+        m_spaceCond.notify_all();
+    }
+
+    //! Queue an update.
+    /*!
+         Queue an update. Applies the overflow policy if the queue is full.
+         \param the update to move into the queue.
+         \return false if the update was dropped.
+     */
+    bool push(T& item)
+    {
+        if(m_ring->push(item))
+        {
+            m_enqueued++;
+            return true;
+        }
+
+        if(m_policy == HM_STORAGE_OVERFLOW_DROP_OLDEST)
+        {
+            T oldest;
+            while(!m_ring->push(item))
+            {
+                if(m_ring->pop(oldest))
+                {
+                    m_dropped++;
+                }
+            }
+            m_enqueued++;
+            return true;
+        }
+
+        m_blocked++;
+        bool pushed = false;
+        std::unique_lock<std::mutex> lk(m_spaceMutex);
+        m_waiting++;
+        while(m_open && !(pushed = m_ring->push(item)))
+        {
+            // The storage thread is only woken when there are checks waiting, recheck in case the wakeup was missed
+            m_spaceCond.wait_for(lk, std::chrono::milliseconds(HM_STORAGE_BLOCK_WAIT));
+        }
+        m_waiting--;
+        if(pushed)
+        {
+            m_enqueued++;
+            return true;
+        }
+        m_dropped++;
+        return false;
+    }
+
+    //! Drain a batch of updates.
+    /*!
+         Drain a batch of updates and wake the checks waiting for room.
+         \param the vector to append the batch to. Updates with the same key are coalesced.
+         \param the max number of updates to drain.
+         \param the function returning the coalescing key of an update.
+         \return the number of updates drained, coalesced ones included.
+     */
+    template <class KeyFunc>
+    uint32_t popBatch(std::vector<T>& batch, uint32_t maxItems, KeyFunc key)
+    {
+        std::unordered_map<std::string, size_t> index;
+        T item;
+        uint32_t count = 0;
+        while(count < maxItems && m_ring->pop(item))
+        {
+            count++;
+            auto it = index.insert(std::make_pair(key(item), batch.size()));
+            if(it.second)
+            {
+                batch.push_back(std::move(item));
+            }
+            else
+            {
+                batch[it.first->second] = std::move(item);
+                m_coalesced++;
+            }
+        }
+        if(count > 0)
+        {
+            m_batches++;
+            if(m_waiting > 0)
+            {
+                std::lock_guard<std::mutex> lk(m_spaceMutex);
+                m_spaceCond.notify_all();
+            }
+        }
+        return count;
+    }
+
+    //! Drop all the queued updates.
+    void clear()
+    {
+        T item;
+        while(m_ring->pop(item)) {}
+    }
+
+    //! Check if the queue is empty. Only a snapshot while updates are pushed or drained.
+    bool empty() const
+    {
+        return m_ring->empty();
+    }
+
+    //! Get the queue counters.
+    /*!
+         Get the queue counters.
+         \param the stats to fill.
+     */
+    void getStats(HMStorageQueueStats& stats) const
+    {
+        stats.m_enqueued = m_enqueued;
+        stats.m_dropped = m_dropped;
+        stats.m_blocked = m_blocked;
+        stats.m_coalesced = m_coalesced;
+        stats.m_batches = m_batches;
+        stats.m_queued = m_ring->size();
+    }
+
+private:
+    std::unique_ptr<HMRingBuffer<T>> m_ring;
+    uint64_t m_size;
+    HM_STORAGE_OVERFLOW_POLICY m_policy;
+
+    std::mutex m_spaceMutex;
+    std::condition_variable m_spaceCond;
+    bool m_open;
+    std::atomic<uint32_t> m_waiting;
+
+    std::atomic<uint64_t> m_enqueued;
+    std::atomic<uint64_t> m_dropped;
+    std::atomic<uint64_t> m_blocked;
+    std::atomic<uint64_t> m_coalesced;
+    std::atomic<uint64_t> m_batches;
+};
+
+#endif /* HMSTORAGEQUEUE_H_ */
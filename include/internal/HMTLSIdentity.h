@@ -0,0 +1,119 @@
+// Copyright 2019, Oath Inc.
+// Licensed under the terms of the Apache 2.0 license. See LICENSE file in the root of the distribution for licensing details.
+#ifndef HMTLSIDENTITY_H_
+#define HMTLSIDENTITY_H_
+
+#include <string>
+#include <map>
+#include <memory>
+#include <mutex>
+
+#include <openssl/ssl.h>
+#include "curl/curl.h"
+
+//! A parsed client identity used by the mTLS health checks.
+/*!
+     A parsed client identity used by the mTLS health checks.
+     Holds the private key, the certificate and its chain parsed once from the PEM contents, and a client SSL_CTX
+     prepared with them. Applying the identity to an SSL_CTX or an SSL only takes references on the parsed objects,
+     so the checks no longer parse the PEM data on every connection.
+     The identity is immutable once created. Checks hold a shared_ptr to it so rotated credentials can replace it
+     on a reload while the checks in flight finish with the old one.
+ */
+class HMTLSIdentity
+{
+public:
+    ~HMTLSIdentity();
+
+    HMTLSIdentity(const HMTLSIdentity&) = delete;
+    HMTLSIdentity& operator=(const HMTLSIdentity&) = delete;
+
+    //! Parse a client identity.
+    /*!
+         Parse a client identity from the PEM contents of the key and the certificate.
+         \param the PEM private key.
+         \param the PEM certificate, optionally followed by its chain.
+         \return the identity or nullptr if the key or the certificate could not be parsed or don't match.
+     */
+    static std::shared_ptr<HMTLSIdentity> create(const std::string& key, const std::string& cert);
+
+    //! Use the identity in an SSL context.
+    /*!
+         Set the identity as the client certificate of an SSL context.
+         \param the SSL context.
+         \return true on success.
+     */
+    bool useIdentity(SSL_CTX* ctx) const;
+
+    //! Use the identity in an SSL connection.
+    /*!
+         Set the identity as the client certificate of a single SSL connection.
+         \param the SSL connection.
+         \return true on success.
+     */
+    bool useIdentity(SSL* ssl) const;
+
+    //! Get the client SSL context prepared with the identity.
+    /*!
+         Get the client SSL context prepared with the identity. The context is owned by the identity.
+         \return the SSL context.
+     */
+    SSL_CTX* getClientCtx() const;
+
+    //! CURLOPT_SSL_CTX_FUNCTION callback to use the identity in the curl connection.
+    /*!
+         CURLOPT_SSL_CTX_FUNCTION callback to use the identity in the curl connection.
+         \param the curl handle.
+         \param the SSL context of the connection.
+         \param the HMTLSIdentity set in CURLOPT_SSL_CTX_DATA. It must stay valid for the whole transfer.
+         \return CURLE_OK, or CURLE_SSL_CERTPROBLEM if the identity could not be used.
+     */
+    static CURLcode curlSslCtxCallback(CURL* curl, void* sslctx, void* arg);
+
+private:
+    HMTLSIdentity() :
+        m_key(nullptr),
+        m_cert(nullptr),
+        m_chain(nullptr),
+        m_clientCtx(nullptr) {};
+
+    EVP_PKEY* m_key;
+    X509* m_cert;
+    STACK_OF(X509)* m_chain;
+    SSL_CTX* m_clientCtx;
+};
+
+//! Process wide cache of the parsed mTLS client identities.
+/*!
+     Process wide cache of the parsed mTLS client identities, keyed by the hash of the credentials.
+     A reload with the same credentials gets the identity already parsed. The cache only keeps weak references,
+     an identity is freed once no state or check in flight uses it anymore.
+ */
+class HMTLSIdentityCache
+{
+public:
+    //! Get the process wide cache.
+    static HMTLSIdentityCache& instance();
+
+    //! Get the identity for the credentials.
+    /*!
+         Get the identity for the credentials, parsing them if they are not already cached.
+         \param the PEM private key.
+         \param the PEM certificate.
+         \return the identity or nullptr if the credentials could not be parsed.
+     */
+    std::shared_ptr<HMTLSIdentity> get(const std::string& key, const std::string& cert);
+
+    //! Get the number of identities cached.
+    /*!
+         Get the number of identities still in use.
+         \return the number of identities cached.
+     */
+    uint32_t size();
+
+private:
+    std::mutex m_mutex;
+    std::map<std::string, std::weak_ptr<HMTLSIdentity>> m_identities;
+};
+
+#endif /* HMTLSIDENTITY_H_ */
@@ -0,0 +1,86 @@
+// Copyright 2019, Oath Inc.
+// Licensed under the terms of the Apache 2.0 license. See LICENSE file in the root of the distribution for licensing details.
+#ifndef HMTLSSESSIONCACHE_H_
+#define HMTLSSESSIONCACHE_H_
+
+#include <map>
+#include <mutex>
+#include <cstdint>
+#include <utility>
+
+#include <openssl/ssl.h>
+
+#include "HMIPAddress.h"
+
+//! Cache of the TLS sessions of the TCPS health check targets.
+/*!
+     Cache of the TLS sessions of the TCPS health check targets, keyed by the address and port of the target.
+     The session, from a session ticket or a session id, is offered again on the next check of the target so the
+     check resumes the session instead of paying for a full handshake. A session is only offered to connections
+     made with the SSL context that negotiated it, and is dropped once it expired.
+     The cache is bounded, an arbitrary entry is evicted to make room once it is full.
+ */
+class HMTLSSessionCache
+{
+public:
+    HMTLSSessionCache(uint64_t maxSessions) :
+        m_maxSessions(maxSessions ? maxSessions : 1) {};
+
+    ~HMTLSSessionCache();
+
+    HMTLSSessionCache(const HMTLSSessionCache&) = delete;
+    HMTLSSessionCache& operator=(const HMTLSSessionCache&) = delete;
+
+    //! Get the session to resume for a target.
+    /*!
+         Get the session to resume for a target.
+         \param the address of the target.
+         \param the port of the target.
+         \param the SSL context of the new connection.
+         \return a reference on the session the caller must free with SSL_SESSION_free, or nullptr if there is none.
+     */
+    SSL_SESSION* get(const HMIPAddress& address, uint16_t port, SSL_CTX* ctx);
+
+    //! Store the session of a target.
+    /*!
+         Store the session of a target, replacing the previous one.
+         \param the address of the target.
+         \param the port of the target.
+         \param the SSL context the session was negotiated with.
+         \param the session. The cache takes over the reference of the caller.
+     */
+    void store(const HMIPAddress& address, uint16_t port, SSL_CTX* ctx, SSL_SESSION* session);
+
+    //! Drop the session of a target.
+    /*!
+         Drop the session of a target, after a failed handshake.
+         \param the address of the target.
+         \param the port of the target.
+     */
+    void remove(const HMIPAddress& address, uint16_t port);
+
+    //! Drop all the sessions.
+    void clear();
+
+    //! Get the number of sessions cached.
+    /*!
+         Get the number of sessions cached.
+         \return the number of sessions cached.
+     */
+    uint64_t size();
+
+private:
+    //! A cached session and the context it was negotiated with.
+    class Entry
+    {
+    public:
+        SSL_CTX* m_ctx;
+        SSL_SESSION* m_session;
+    };
+
+    uint64_t m_maxSessions;
+    std::mutex m_mutex;
+    std::map<std::pair<HMIPAddress, uint16_t>, Entry> m_sessions;
+};
+
+#endif /* HMTLSSESSIONCACHE_H_ */
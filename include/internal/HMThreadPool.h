@@ -5,12 +5,19 @@
 
 #include <vector>
 #include <thread>
+#include <mutex>
 
 #include "HMThreadWorker.h"
+#include "HMThreadPoolController.h"
 
 typedef std::vector<std::pair<std::unique_ptr<HMThreadWorker>, std::thread> > HMWorkerPool;
 
 //! The class that holds the thread pool for the worker threads.
+/*!
+     The pool is sized by the HMThreadPoolController from the queue wait and worker utilisation measured on each monitor interval.
+     With recycling on, the workers are replaced when the resident memory or the open descriptors of the daemon grow past the
+     configured limits, flushing the thread state kept by the Curl and Ares libraries.
+ */
 class HMThreadPool
 {
 public:
@@ -23,7 +30,12 @@ public:
         m_recycle(false),
         m_stateManager(state),
         m_eventLoop(eventLoop),
-        m_shutdown(false) {};
+        m_shutdown(false),
+        m_nRecycles(0),
+        m_baseMemory(0),
+        m_baseFiles(0),
+        m_residentMemory(0),
+        m_openFiles(0) {};
 
     //! Resize the size of the thread pool.
     /*!
@@ -40,8 +52,15 @@ public:
      */
     uint64_t countIdle();
 
-    //! Recycle threads with a high used count.
+    //! Replace the worker threads that ran work since they were started.
     void recycleThreads();
+
+    //! Get the thread pool info.
+    /*!
+         Get the number of threads, the controller state and the resource usage tracked for the recycling.
+         \param the thread info to fill in.
+     */
+    void getThreadInfo(HMAPIThreadInfo& info);
     //! Function called to run the worker pool monitoring in a new thread.
     void monitorThreads();
     //! Function to shutdow the worker pool, all workers and the thread monitor.
@@ -54,6 +73,15 @@ public:
      */
     uint64_t getNThreads();
 
+    //! Get the resource usage of the process.
+    /*!
+         Get the resident memory and the number of descriptors open by the process.
+         \param set to the resident memory in kB.
+         \param set to the number of open descriptors.
+         \return true if the usage was read.
+     */
+    static bool getResourceUsage(uint64_t& residentMemory, uint64_t& openFiles);
+
     //! Get the current timeout between updating the thread monitoring stats.
     /*!
          Get the current timeout between updating the thread monitoring stats.
@@ -115,12 +143,27 @@ private:
     uint32_t m_stridePercent;
     uint32_t m_monitorFrequency;
     uint32_t m_workPerThreadRatio;
-    bool m_recycle
-    ;
+    bool m_recycle;
     HMWorkerPool m_workers;
     HMStateManager* m_stateManager;
     HMEventLoop* m_eventLoop;
     bool m_shutdown;
+
+    //! Held while the workers are changed and while the controller state is read or updated.
+    std::mutex m_poolMutex;
+    HMThreadPoolController m_controller;
+    uint64_t m_nRecycles;
+    //! The resource usage after the last recycle.
+    uint64_t m_baseMemory;
+    uint64_t m_baseFiles;
+    uint64_t m_residentMemory;
+    uint64_t m_openFiles;
+
+    //! Check if the resource usage grew enough since the last recycle to recycle the workers.
+    bool needsRecycle(const HMThreadPoolConfig& config) const;
+
+    //! Start a new worker thread in a slot of the pool.
+    void startWorker(uint32_t index);
 };
 
 #endif /* HMTHREADPOOL_H_ */
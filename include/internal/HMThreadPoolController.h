@@ -0,0 +1,121 @@
+// Copyright 2019, Oath Inc.
+// Licensed under the terms of the Apache 2.0 license. See LICENSE file in the root of the distribution for licensing details.
+#ifndef HMTHREADPOOLCONTROLLER_H_
+#define HMTHREADPOOLCONTROLLER_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "HMConstants.h"
+#include "HMAPI.h"
+
+//! The thread pool sizing and recycling parameters, set from the master config.
+class HMThreadPoolConfig
+{
+public:
+    HMThreadPoolConfig() :
+        m_targetWait(HM_DEFAULT_THREAD_TARGET_WAIT),
+        m_lowUtilisation(HM_DEFAULT_THREAD_LOW_UTILISATION),
+        m_highUtilisation(HM_DEFAULT_THREAD_HIGH_UTILISATION),
+        m_growthPercent(HM_DEFAULT_THREAD_GROWTH_PERCENT),
+        m_shrinkIntervals(HM_DEFAULT_THREAD_SHRINK_INTERVALS),
+        m_recycleMemoryGrowth(HM_DEFAULT_RECYCLE_MEMORY_GROWTH),
+        m_recycleFileGrowth(HM_DEFAULT_RECYCLE_FILE_GROWTH) {};
+
+    //! The 99th percentile queue wait in ms the pool grows to stay under.
+    uint32_t m_targetWait;
+    //! The worker utilisation percent under which the pool can shrink.
+    uint32_t m_lowUtilisation;
+    //! The worker utilisation percent over which the pool grows when work is queued.
+    uint32_t m_highUtilisation;
+    //! The percent of the pool added on each growth.
+    uint32_t m_growthPercent;
+    //! The number of monitor intervals the pool must be underused before it shrinks.
+    uint32_t m_shrinkIntervals;
+    //! The percent the resident memory can grow over its baseline before the workers are recycled, 0 to disable.
+    uint32_t m_recycleMemoryGrowth;
+    //! The number of descriptors the process can open over its baseline before the workers are recycled, 0 to disable.
+    uint32_t m_recycleFileGrowth;
+};
+
+//! The feedback controller sizing the worker thread pool.
+/*!
+     The controller is fed the queue wait percentiles and the worker utilisation measured over each monitor interval.
+     The pool grows by the growth percent, and by the queued work over the work per thread ratio, as soon as the queue wait
+     goes over the target or the workers are saturated with work queued. A queue wait over four times the target doubles the growth
+     to catch up with bursts.
+     The pool shrinks by the stride percent only after the utilisation stayed under the low watermark with a short queue wait for
+     the shrink intervals, the gap between the watermarks and the interval count give the hysteresis keeping it from flapping.
+ */
+class HMThreadPoolController
+{
+public:
+    HMThreadPoolController() :
+        m_minThreads(1),
+        m_maxThreads(1),
+        m_stridePercent(HM_DEFAULT_STRIDE_PERCENT),
+        m_workPerThreadRatio(HM_WORK_PER_THREAD_RATIO),
+        m_lowIntervals(0),
+        m_waitP50(0),
+        m_waitP99(0),
+        m_utilisation(0),
+        m_target(0),
+        m_nGrows(0),
+        m_nShrinks(0) {};
+
+    //! Set the parameters of the controller.
+    /*!
+         Set the parameters of the controller.
+         \param the pool config.
+         \param the minimum number of threads.
+         \param the maximum number of threads.
+         \param the percent of the pool removed on each shrink.
+         \param the number of queued work orders each added thread is expected to serve.
+     */
+    void setConfig(const HMThreadPoolConfig& config, uint64_t minThreads, uint64_t maxThreads,
+            uint32_t stridePercent, uint32_t workPerThreadRatio);
+
+    //! Get the target pool size for the last interval.
+    /*!
+         Get the target pool size from the stats of the last monitor interval.
+         \param the current number of threads.
+         \param the queue wait histogram of the interval, see HMWorkQueue::collectQueueWait.
+         \param the percent of the interval the workers were busy.
+         \param the number of work orders queued.
+         \return the number of threads the pool should run.
+     */
+    uint64_t update(uint64_t nThreads, const std::vector<uint64_t>& waitHistogram, uint32_t utilisation, uint64_t queued);
+
+    //! Get a percentile of a queue wait histogram.
+    /*!
+         Get a percentile of a queue wait histogram, the upper bound of the bucket holding it.
+         \param the queue wait histogram.
+         \param the percentile.
+         \return the queue wait in ms, 0 if the histogram is empty.
+     */
+    static uint64_t getPercentile(const std::vector<uint64_t>& waitHistogram, uint32_t percentile);
+
+    //! Get the controller stats.
+    /*!
+         Fill in the controller limits and the stats of the last interval.
+         \param the thread info to fill in.
+     */
+    void getStats(HMAPIThreadInfo& info) const;
+
+private:
+    HMThreadPoolConfig m_config;
+    uint64_t m_minThreads;
+    uint64_t m_maxThreads;
+    uint32_t m_stridePercent;
+    uint32_t m_workPerThreadRatio;
+    uint32_t m_lowIntervals;
+
+    uint64_t m_waitP50;
+    uint64_t m_waitP99;
+    uint32_t m_utilisation;
+    uint64_t m_target;
+    uint64_t m_nGrows;
+    uint64_t m_nShrinks;
+};
+
+#endif /* HMTHREADPOOLCONTROLLER_H_ */
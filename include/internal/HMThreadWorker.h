@@ -23,6 +23,7 @@ public:
         m_idle(false),
         m_running(false),
         m_nUsed(0),
+        m_busyTime(0),
         m_shutdown(false),
         m_threadID(0),
         m_stateManager(stateManager),
@@ -32,6 +33,7 @@ public:
         m_idle(k.m_idle.load()),
         m_running(k.m_running.load()),
         m_nUsed(k.m_nUsed),
+        m_busyTime(k.m_busyTime.load()),
         m_shutdown(k.m_shutdown),
         m_threadID(k.m_threadID),
         m_stateManager(k.m_stateManager),
@@ -62,10 +64,18 @@ public:
      */
     uint64_t getUsedCounter();
 
+    //! Collect the time the thread spent running work.
+    /*!
+         Collect the time the thread spent running work since the last call.
+         \return the busy time in microseconds.
+     */
+    uint64_t collectBusyTime();
+
 private:
     std::atomic<bool> m_idle;
     std::atomic<bool> m_running;
     uint64_t m_nUsed;
+    std::atomic<uint64_t> m_busyTime;
     bool m_shutdown;
     uint64_t m_threadID;
     HMStateManager* m_stateManager;
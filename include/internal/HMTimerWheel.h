@@ -0,0 +1,394 @@
+// Copyright 2019, Oath Inc.
+// Licensed under the terms of the Apache 2.0 license. See LICENSE file in the root of the distribution for licensing details.
+#ifndef INCLUDE_HMTIMERWHEEL_H_
+#define INCLUDE_HMTIMERWHEEL_H_
+
+#include <cstdint>
+#include <vector>
+#include <utility>
+
+#include "HMMonotonicTime.h"
+#include "HMConstants.h"
+
+//! Hierarchical timing wheel used to schedule timeouts.
+/*!
+     Hierarchical timing wheel used to schedule timeouts.
+     Timeouts are kept in a slab and the wheel slots only link slab indices, so inserting, cancelling and
+     expiring a timeout is O(1) and the payload is never copied after it is scheduled.
+     The wheel has HM_TIMER_WHEEL_LEVELS levels of HM_TIMER_WHEEL_SLOTS slots. The first level is
+     HM_TIMER_WHEEL_RESOLUTION ms per slot and each following level covers a full rotation of the level below.
+     Timeouts on the higher levels are cascaded down as the wheel turns.
+     Timeouts that fall in the same slot expire in the order they were scheduled.
+     The wheel is not thread safe, the owner must serialize access.
+ */
+template <class T>
+class HMTimerWheel
+{
+public:
+
+    //! Handle to a scheduled timeout. Stays unique for the life of the wheel.
+    typedef uint64_t Handle;
+
+    //! A handle that never refers to a timeout.
+    static const Handle INVALID_HANDLE = 0;
+
+    HMTimerWheel(uint64_t resolution = HM_TIMER_WHEEL_RESOLUTION) :
+        m_resolution(resolution ? resolution : 1),
+        m_currentTick(0),
+        m_size(0)
+    {
+        for(uint32_t level = 0; level < HM_TIMER_WHEEL_LEVELS; level++)
+        {
+            for(uint32_t slot = 0; slot < HM_TIMER_WHEEL_SLOTS; slot++)
+            {
+                m_head[level][slot] = NIL;
+                m_tail[level][slot] = NIL;
+            }
+        }
+        for(uint32_t i = 0; i < BITMAP_WORDS; i++)
+        {
+            m_occupied[i] = 0;
+        }
+    }
+
+    //! Schedule a timeout.
+    /*!
+         Schedule a timeout. The timeout expires on the first slot at or after the expiration time.
+         Timeouts in the past expire on the next call to expire.
+         \param the payload to return when the timeout expires.
+         \param the time the timeout expires.
+         \return the handle for the timeout.
+     */
+    Handle schedule(T payload, HMMonotonicTime expiration)
+    {
+        // Round up so a timeout never expires early
+        uint64_t tick = (expiration.getMicroseconds() + m_resolution * 1000 - 1) / (m_resolution * 1000);
+        if(m_size == 0)
+        {
+            // Nothing is scheduled, so the wheel can be moved to any time
+            m_currentTick = toTick(HMMonotonicTime::now());
+        }
+        if(tick < m_currentTick)
+        {
+            tick = m_currentTick;
+        }
+
+        uint32_t index;
+        if(m_free.empty())
+        {
+            index = m_nodes.size();
+            m_nodes.emplace_back();
+        }
+        else
+        {
+            index = m_free.back();
+            m_free.pop_back();
+        }
+        Node& node = m_nodes[index];
+        node.m_payload = std::move(payload);
+        node.m_tick = tick;
+        node.m_active = true;
+        node.m_generation++;
+        link(index);
+        m_size++;
+        return ((uint64_t)node.m_generation << 32) | index;
+    }
+
+    //! Cancel a scheduled timeout.
+    /*!
+         Cancel a scheduled timeout.
+         \param the handle returned when the timeout was scheduled.
+         \return true if the timeout was pending and is now cancelled.
+     */
+    bool cancel(Handle handle)
+    {
+        uint32_t index = handle & 0xFFFFFFFF;
+        uint32_t generation = handle >> 32;
+        if(index >= m_nodes.size() || !m_nodes[index].m_active || m_nodes[index].m_generation != generation)
+        {
+            return false;
+        }
+        unlink(index);
+        release(index);
+        return true;
+    }
+
+    //! Cancel all the timeouts matching a predicate.
+    /*!
+         Cancel all the timeouts matching a predicate. Walks every pending timeout, so this is meant for reloads.
+         \param a callable taking the payload and returning true if the timeout should be cancelled.
+         \return the number of timeouts cancelled.
+     */
+    template <class Predicate>
+    uint64_t cancelIf(Predicate predicate)
+    {
+        uint64_t cancelled = 0;
+        for(uint32_t index = 0; index < m_nodes.size(); index++)
+        {
+            if(m_nodes[index].m_active && predicate(m_nodes[index].m_payload))
+            {
+                unlink(index);
+                release(index);
+                cancelled++;
+            }
+        }
+        return cancelled;
+    }
+
+    //! Get the time the wheel next needs to be serviced.
+    /*!
+         Get the time the wheel next needs to be serviced. This is either the first timeout to expire or
+         the next time the higher levels need to be cascaded, so it may be earlier than the first timeout.
+         \param the time stamp to fill with the next service time.
+         \return false if there are no timeouts scheduled.
+     */
+    bool nextExpiration(HMMonotonicTime& expiration) const
+    {
+        if(m_size == 0)
+        {
+            return false;
+        }
+        uint32_t slot = m_currentTick & SLOT_MASK;
+        uint32_t next = nextOccupied(slot);
+        uint64_t tick;
+        if(next < HM_TIMER_WHEEL_SLOTS)
+        {
+            tick = (m_currentTick & ~(uint64_t)SLOT_MASK) + next;
+        }
+        else
+        {
+            tick = (m_currentTick | SLOT_MASK) + 1;
+        }
+        expiration = HMMonotonicTime(tick * m_resolution * 1000);
+        return true;
+    }
+
+    //! Expire all the timeouts up to the given time.
+    /*!
+         Expire all the timeouts up to the given time.
+         \param the current time.
+         \param vector the expired payloads are appended to in expiration order.
+     */
+    void expire(HMMonotonicTime now, std::vector<T>& expired)
+    {
+        uint64_t nowTick = toTick(now);
+        while(m_currentTick <= nowTick)
+        {
+            if(m_size == 0)
+            {
+                m_currentTick = nowTick + 1;
+                return;
+            }
+            uint32_t slot = m_currentTick & SLOT_MASK;
+            if(slot == 0)
+            {
+                cascade();
+            }
+            uint32_t index = m_head[0][slot];
+            while(index != NIL)
+            {
+                uint32_t next = m_nodes[index].m_next;
+                expired.push_back(std::move(m_nodes[index].m_payload));
+                release(index);
+                index = next;
+            }
+            m_head[0][slot] = NIL;
+            m_tail[0][slot] = NIL;
+            clearOccupied(slot);
+
+            // Skip straight to the next occupied slot or the next cascade
+            uint32_t next = (slot + 1 < HM_TIMER_WHEEL_SLOTS) ? nextOccupied(slot + 1) : HM_TIMER_WHEEL_SLOTS;
+            uint64_t nextTick = (m_currentTick & ~(uint64_t)SLOT_MASK) + next;
+            if(nextTick > nowTick + 1)
+            {
+                nextTick = nowTick + 1;
+            }
+            m_currentTick = nextTick;
+        }
+    }
+
+    //! Get the number of timeouts scheduled.
+    uint64_t size() const
+    {
+        return m_size;
+    }
+
+    //! Check if there are no timeouts scheduled.
+    bool empty() const
+    {
+        return m_size == 0;
+    }
+
+private:
+
+    static const uint32_t NIL = 0xFFFFFFFF;
+    static const uint32_t SLOT_BITS = HM_TIMER_WHEEL_SLOT_BITS;
+    static const uint32_t SLOT_MASK = HM_TIMER_WHEEL_SLOTS - 1;
+    static const uint32_t BITMAP_WORDS = HM_TIMER_WHEEL_SLOTS / 64;
+
+    //! A slab entry holding a timeout.
+    class Node
+    {
+    public:
+        Node() :
+            m_tick(0),
+            m_prev(NIL),
+            m_next(NIL),
+            m_generation(0),
+            m_level(0),
+            m_slot(0),
+            m_active(false) {};
+
+        T m_payload;
+        uint64_t m_tick;
+        uint32_t m_prev;
+        uint32_t m_next;
+        uint32_t m_generation;
+        uint16_t m_level;
+        uint16_t m_slot;
+        bool m_active;
+    };
+
+    uint64_t toTick(HMMonotonicTime timeStamp) const
+    {
+        return timeStamp.getMicroseconds() / (m_resolution * 1000);
+    }
+
+    //! Add the node to the slot for its tick relative to the current tick.
+    void link(uint32_t index)
+    {
+        Node& node = m_nodes[index];
+        uint64_t delta = node.m_tick - m_currentTick;
+        uint64_t tick = node.m_tick;
+        uint32_t level = 0;
+        while(level < HM_TIMER_WHEEL_LEVELS - 1 && delta >= ((uint64_t)1 << (SLOT_BITS * (level + 1))))
+        {
+            level++;
+        }
+        uint64_t range = (uint64_t)1 << (SLOT_BITS * (level + 1));
+        if(delta >= range)
+        {
+            // Too far out for the top level, park it in the last slot and recheck on cascade
+            tick = m_currentTick + range - 1;
+        }
+        uint32_t slot = (tick >> (SLOT_BITS * level)) & SLOT_MASK;
+
+        node.m_level = level;
+        node.m_slot = slot;
+        node.m_next = NIL;
+        node.m_prev = m_tail[level][slot];
+        if(node.m_prev == NIL)
+        {
+            m_head[level][slot] = index;
+        }
+        else
+        {
+            m_nodes[node.m_prev].m_next = index;
+        }
+        m_tail[level][slot] = index;
+        if(level == 0)
+        {
+            setOccupied(slot);
+        }
+    }
+
+    //! Remove the node from its slot.
+    void unlink(uint32_t index)
+    {
+        Node& node = m_nodes[index];
+        if(node.m_prev == NIL)
+        {
+            m_head[node.m_level][node.m_slot] = node.m_next;
+        }
+        else
+        {
+            m_nodes[node.m_prev].m_next = node.m_next;
+        }
+        if(node.m_next == NIL)
+        {
+            m_tail[node.m_level][node.m_slot] = node.m_prev;
+        }
+        else
+        {
+            m_nodes[node.m_next].m_prev = node.m_prev;
+        }
+        if(node.m_level == 0 && m_head[0][node.m_slot] == NIL)
+        {
+            clearOccupied(node.m_slot);
+        }
+    }
+
+    //! Return the node to the free list.
+    void release(uint32_t index)
+    {
+        Node& node = m_nodes[index];
+        node.m_active = false;
+        node.m_payload = T();
+        m_free.push_back(index);
+        m_size--;
+    }
+
+    //! Move the timeouts due in the coming rotation down from the higher levels.
+    void cascade()
+    {
+        for(uint32_t level = 1; level < HM_TIMER_WHEEL_LEVELS; level++)
+        {
+            uint32_t slot = (m_currentTick >> (SLOT_BITS * level)) & SLOT_MASK;
+            uint32_t index = m_head[level][slot];
+            m_head[level][slot] = NIL;
+            m_tail[level][slot] = NIL;
+            while(index != NIL)
+            {
+                uint32_t next = m_nodes[index].m_next;
+                link(index);
+                index = next;
+            }
+            if(slot != 0)
+            {
+                break;
+            }
+        }
+    }
+
+    void setOccupied(uint32_t slot)
+    {
+        m_occupied[slot / 64] |= ((uint64_t)1 << (slot % 64));
+    }
+
+    void clearOccupied(uint32_t slot)
+    {
+        m_occupied[slot / 64] &= ~((uint64_t)1 << (slot % 64));
+    }
+
+    //! Find the first occupied slot on the first level at or after slot, HM_TIMER_WHEEL_SLOTS if there are none.
+    uint32_t nextOccupied(uint32_t slot) const
+    {
+        uint32_t word = slot / 64;
+        uint64_t bits = m_occupied[word] & (~(uint64_t)0 << (slot % 64));
+        while(true)
+        {
+            if(bits)
+            {
+                return word * 64 + __builtin_ctzll(bits);
+            }
+            if(++word >= BITMAP_WORDS)
+            {
+                return HM_TIMER_WHEEL_SLOTS;
+            }
+            bits = m_occupied[word];
+        }
+    }
+
+    uint64_t m_resolution;
+    uint64_t m_currentTick;
+    uint64_t m_size;
+
+    std::vector<Node> m_nodes;
+    std::vector<uint32_t> m_free;
+
+    uint32_t m_head[HM_TIMER_WHEEL_LEVELS][HM_TIMER_WHEEL_SLOTS];
+    uint32_t m_tail[HM_TIMER_WHEEL_LEVELS][HM_TIMER_WHEEL_SLOTS];
+    uint64_t m_occupied[HM_TIMER_WHEEL_SLOTS / 64];
+};
+
+#endif /* INCLUDE_HMTIMERWHEEL_H_ */
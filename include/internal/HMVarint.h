@@ -0,0 +1,150 @@
+// Copyright 2019, Oath Inc.
+// Licensed under the terms of the Apache 2.0 license. See LICENSE file in the root of the distribution for licensing details.
+#ifndef HMVARINT_H_
+#define HMVARINT_H_
+
+#include <cstdint>
+#include <cstring>
+
+#include "HMIPAddress.h"
+
+//! Helpers for the compact binary encodings.
+/*!
+     Values are written as LEB128 varints, 7 bits per byte with the high bit set on every byte but the last.
+     Signed values are zigzag mapped first so small negative values stay short.
+     The readers never go past the end of the buffer and return false on a truncated value.
+ */
+class HMVarint
+{
+public:
+    //! The max number of bytes of an encoded 64 bit value.
+    static const uint32_t MAX_SIZE = 10;
+    //! The max number of bytes of an encoded address.
+    static const uint32_t MAX_ADDRESS_SIZE = 1 + sizeof(in6_addr);
+
+    //! Write a value.
+    /*!
+         Write a value.
+         \param the buffer to write to, must hold MAX_SIZE bytes.
+         \param the value to write.
+         \return the number of bytes written.
+     */
+    static uint32_t put(char* buf, uint64_t value)
+    {
+        uint32_t len = 0;
+        while(value >= 0x80)
+        {
+            buf[len++] = (char)(value | 0x80);
+            value >>= 7;
+        }
+        buf[len++] = (char)value;
+        return len;
+    }
+
+    //! Read a value.
+    /*!
+         Read a value.
+         \param the position to read from, moved past the value.
+         \param the end of the buffer.
+         \param the value read.
+         \return false if the value is truncated or too long.
+     */
+    static bool get(const char*& src, const char* end, uint64_t& value)
+    {
+        value = 0;
+        for(uint32_t shift = 0; shift < 64 && src < end; shift += 7)
+        {
+            uint8_t byte = *src++;
+            value |= (uint64_t)(byte & 0x7F) << shift;
+            if(!(byte & 0x80))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    //! Get the number of bytes a value is written in.
+    static uint32_t size(uint64_t value)
+    {
+        uint32_t len = 1;
+        while(value >= 0x80)
+        {
+            value >>= 7;
+            len++;
+        }
+        return len;
+    }
+
+    //! Map a signed value to an unsigned one, small magnitudes to small values.
+    static uint64_t zigzag(int64_t value)
+    {
+        return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+    }
+
+    //! Map a zigzag value back to the signed value.
+    static int64_t unzigzag(uint64_t value)
+    {
+        return (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+    }
+
+    //! Write an address as its type followed by the 0, 4 or 16 bytes of the address.
+    /*!
+         Write an address.
+         \param the buffer to write to, must hold MAX_ADDRESS_SIZE bytes.
+         \param the address to write.
+         \return the number of bytes written.
+     */
+    static uint32_t putAddress(char* buf, const HMIPAddress& address)
+    {
+        buf[0] = (char)address.getType();
+        if(address.getType() == AF_INET)
+        {
+            in_addr_t addr = address.addr4();
+            memcpy(buf + 1, &addr, sizeof(addr));
+            return 1 + sizeof(addr);
+        }
+        if(address.getType() == AF_INET6)
+        {
+            in6_addr addr = address.addr6();
+            memcpy(buf + 1, &addr, sizeof(addr));
+            return 1 + sizeof(addr);
+        }
+        buf[0] = (char)AF_UNSPEC;
+        return 1;
+    }
+
+    //! Read an address.
+    /*!
+         Read an address.
+         \param the position to read from, moved past the address.
+         \param the end of the buffer.
+         \param the address read.
+         \return false if the address is truncated.
+     */
+    static bool getAddress(const char*& src, const char* end, HMIPAddress& address)
+    {
+        if(src >= end)
+        {
+            return false;
+        }
+        uint8_t type = *src++;
+        if(type == AF_INET || type == AF_INET6)
+        {
+            uint32_t len = (type == AF_INET) ? sizeof(in_addr_t) : sizeof(in6_addr);
+            if((uint32_t)(end - src) < len)
+            {
+                return false;
+            }
+            char addr[sizeof(in6_addr)];
+            memcpy(addr, src, len);
+            src += len;
+            address.set(addr, type);
+            return true;
+        }
+        address = HMIPAddress();
+        return true;
+    }
+};
+
+#endif /* HMVARINT_H_ */
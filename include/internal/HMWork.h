@@ -11,8 +11,9 @@
 #include "HMDataCheckParams.h"
 #include "HMDataHostCheck.h"
 #include "HMIPAddress.h"
-#include "HMTimeStamp.h"
+#include "HMMonotonicTime.h"
 #include "HMAuxCache.h"
+#include "HMDestinationLimiter.h"
 
 class HMStateManager;
 class HMEventLoop;
@@ -80,6 +81,9 @@ public:
         m_reason(HM_REASON_NONE),
         m_ID(0),
         m_workStatus(HM_WORK_IDLE),
+        m_checkListID(0),
+        m_checkID(0),
+        m_workClass(HM_WORK_CLASS_DEFAULT),
         m_stateManager(nullptr),
         m_eventLoop(nullptr),
         m_reschedule(true),
@@ -95,6 +99,9 @@ public:
         m_reason(HM_REASON_NONE),
         m_ID(0),
         m_workStatus(HM_WORK_IDLE),
+        m_checkListID(0),
+        m_checkID(0),
+        m_workClass(HM_WORK_CLASS_DEFAULT),
         m_stateManager(nullptr),
         m_eventLoop(nullptr),
         m_reschedule(true),
@@ -169,19 +176,48 @@ public:
      */
     void setPublish(bool publish);
 
+    //! Called to get the id of the check of the work in the check list.
+    /*!
+         Called to get the id of the check of the work in the check list. The id is looked up again if the check list
+         was reloaded since the work was queued.
+         \param the current check list.
+         \return the check id, HM_CHECK_ID_INVALID if the check is no longer in the check list.
+     */
+    uint32_t getCheckID(HMDataCheckList& checkList);
+
+    //! Called to get the class of the work in the work queue.
+    /*!
+         Called to get the class the work is queued in. Unless set by the creator of the work, the class is picked
+         from the work type, and the health checks from the priority of their host group.
+         \return the work class.
+     */
+    HM_WORK_CLASS getWorkClass();
+
     std::string m_hostname;
     HMIPAddress m_ipAddress;
     HMDataHostCheck m_hostCheck;
     HM_RESPONSE m_response;
     HM_REASON m_reason;
-    HMTimeStamp m_start;
-    HMTimeStamp m_end;
+    HMMonotonicTime m_start;
+    HMMonotonicTime m_end;
+    //! The time the TCP connect completed, only set by the checks with a TLS handshake after the connect.
+    HMMonotonicTime m_connectEnd;
     uint64_t m_ID;
     HM_WORK_STATUS m_workStatus;
+    //! The id of the check list that issued m_checkID.
+    uint64_t m_checkListID;
+    //! The interned id of the hostname and host check in the check list.
+    uint32_t m_checkID;
+    //! The slot of the destination limits held while the work is in flight, given back when the work is destroyed.
+    std::shared_ptr<HMDestinationSlot> m_destinationSlot;
+    //! The class the work is queued in, HM_WORK_CLASS_DEFAULT to pick it from the work type.
+    HM_WORK_CLASS m_workClass;
+    //! The time the work was last inserted in the work queue.
+    HMMonotonicTime m_queueTime;
 
 
 protected:
-    HMTimeStamp m_timeout;
+    HMMonotonicTime m_timeout;
     HMStateManager* m_stateManager;
     HMEventLoop* m_eventLoop;
     bool m_reschedule;
@@ -4,6 +4,7 @@
 #define HMWORKAUXFETCHCURL_H_
 
 #include "HMWorkAuxFetch.h"
+#include "HMCurlBuffer.h"
 
 //! Curl implementation to retrieve auxiliary information for NetCHASM
 /*!
@@ -15,14 +16,6 @@ public:
     HMWorkAuxFetchCurl(const std::string& hostname, const HMIPAddress& ip, const HMDataHostCheck& hostcheck) :
         HMWorkAuxFetch(hostname, ip, hostcheck) {};
 
-    //! Callback function to update the receive buffer as data comes into CURL.
-    /*!
-          Callback function to update the receive buffer as data comes into CURL.
-          \param buf of data received from the CURL callback.
-          \param the length of the buffer.
-     */
-    void updateBuffer(char* buf, uint32_t length);
-
     //! Called to conduct the actual check.
     /*!
          Called to conduct the actual check.  Should store the check info into m_auxData.
@@ -44,7 +37,7 @@ public:
     };
 
 private:
-    std::string rcvdBuffer;
+    HMCurlBuffer m_rcvdBuffer;
 };
 
 #endif /* HMWORKAUXFETCHCURL_H_ */
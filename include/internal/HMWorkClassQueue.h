@@ -0,0 +1,97 @@
+// Copyright 2019, Oath Inc.
+// Licensed under the terms of the Apache 2.0 license. See LICENSE file in the root of the distribution for licensing details.
+#ifndef HMWORKCLASSQUEUE_H_
+#define HMWORKCLASSQUEUE_H_
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+
+#include "HMConstants.h"
+#include "HMMonotonicTime.h"
+#include "HMWork.h"
+
+//! The parameters sharing the workers between the work classes.
+class HMWorkQueueConfig
+{
+public:
+    HMWorkQueueConfig() :
+        m_weights{HM_DEFAULT_WORK_WEIGHT_CONTROL,
+            HM_DEFAULT_WORK_WEIGHT_HIGH,
+            HM_DEFAULT_WORK_WEIGHT_HEALTHCHECK,
+            HM_DEFAULT_WORK_WEIGHT_LOW,
+            HM_DEFAULT_WORK_WEIGHT_DNSLOOKUP,
+            HM_DEFAULT_WORK_WEIGHT_REMOTE,
+            HM_DEFAULT_WORK_WEIGHT_AUXFETCH},
+        m_starvationTime(HM_DEFAULT_WORK_STARVATION_TIME) {};
+
+    //! The dequeue weight of each work class, indexed by HM_WORK_CLASS.
+    uint32_t m_weights[HM_WORK_CLASS_COUNT];
+    //! The time in ms work can wait before its class is served ahead of the weights. 0 to disable.
+    uint64_t m_starvationTime;
+};
+
+//! The queued work of a work queue shard, split by work class.
+/*!
+     The queued work of a work queue shard, split by work class. Not thread safe, used under the lock of the shard.
+     The work of each class is kept in FIFO order. The classes are served by smooth weighted round robin,
+     each class with work gets its weight in credits on every dequeue, the class with the most credits is served
+     and pays back the weights of all the classes with work. Over time each class is served in proportion to its weight,
+     and a heavy class is interleaved with the others instead of served in bursts.
+     When the oldest work of a class has waited past the starvation time, the class with the oldest such work is served first.
+ */
+class HMWorkClassQueue
+{
+public:
+    HMWorkClassQueue() :
+        m_credits{},
+        m_size(0) {};
+
+    HMWorkClassQueue(const HMWorkClassQueue&) = delete;
+    HMWorkClassQueue& operator=(const HMWorkClassQueue&) = delete;
+
+    //! Add work to the back of its class.
+    /*!
+         Add work to the back of its class.
+         \param the work to add, moved from.
+     */
+    void push(std::unique_ptr<HMWork>& work);
+
+    //! Take the next work to run.
+    /*!
+         Take the next work to run, from a starved class or from the class picked by the weights.
+         \param the work to fill in.
+         \param the dequeue weight of each work class, a weight of 0 is served as 1.
+         \param the time in microseconds work can wait before its class is starved, 0 to ignore the starvation.
+         \param set to true if the work was taken from a starved class.
+         \return true if work was taken.
+     */
+    bool pop(std::unique_ptr<HMWork>& work, const uint32_t* weights, uint64_t starvationTime, bool& starved);
+
+    //! Get the number of work queued.
+    size_t size() const
+    {
+        return m_size;
+    }
+
+    //! Get the number of work queued in a class.
+    size_t size(HM_WORK_CLASS workClass) const
+    {
+        return m_queues[workClass].size();
+    }
+
+    //! Get the time the oldest work of a class was queued.
+    /*!
+         Get the time the oldest work of a class was queued.
+         \param the work class.
+         \return the queue time of the oldest work, unset if the class has no work.
+     */
+    HMMonotonicTime getOldest(HM_WORK_CLASS workClass) const;
+
+private:
+    std::deque<std::unique_ptr<HMWork>> m_queues[HM_WORK_CLASS_COUNT];
+    int64_t m_credits[HM_WORK_CLASS_COUNT];
+    size_t m_size;
+};
+
+#endif /* HMWORKCLASSQUEUE_H_ */
@@ -2,6 +2,7 @@
 // Licensed under the terms of the Apache 2.0 license. See LICENSE file in the root of the distribution for licensing details.
 #include "HMDNSCache.h"
 #include "HMWorkDNSLookup.h"
+#include "HMDNSResolver.h"
 
 #include <vector>
 #include <string>
@@ -48,8 +49,24 @@ public:
     //! Called from the Ares callback to indicate that the resolution lookup is done.
     void signalDone();
 
+    //! Called from the Ares callbacks to set the result of the lookup.
+    /*!
+         Called from the Ares callbacks to set the resolved IP addresses and the reason codes from the Ares status.
+         \param the Ares status of the lookup.
+         \param the resolved IP addresses.
+     */
+    void setLookupResult(int status, const std::vector<HMIPAddress>& addresses);
+
 private:
 
+    //! Store the result of the lookup in the DNS cache.
+    void storeResult();
+
+    //! Called by the DNS resolver when the lookup completes.
+    static void lookupDone(HMDNSRequest& request, void* arg);
+
+    HMDNSRequest m_dnsRequest;
+
     bool m_finished;
     ares_channel* m_channel;
 };
@@ -4,9 +4,13 @@
 #define HMWORKHEALTHCHECKCURL_H_
 
 #include <string>
+#include <vector>
 #include <cstdint>
 
 #include "HMWorkHealthCheck.h"
+#include "HMCurlEngine.h"
+
+class HMState;
 
 // LCOV_EXCL_START; Tested in functional testing
 
@@ -17,14 +21,6 @@ public:
     HMWorkHealthCheckCurl(const std::string& hostname, const HMIPAddress& ip, const HMDataHostCheck& hostcheck) :
         HMWorkHealthCheck(hostname, ip, hostcheck) {};
 
-    //! Callback function to update the receive buffer as data comes into CURL.
-    /*!
-          Callback function to update the receive buffer as data comes into CURL.
-          \param buf of data received from the CURL callback.
-          \param the length of the buffer.
-     */
-    void updateBuffer(char* buf, uint32_t length);
-
     //! Main function to actually conduct the health check.
     /*!
          Main function to actually conduct the health check.
@@ -45,7 +41,49 @@ public:
     };
 
 private:
-    std::string rcvdBuffer;
+    //! Build the URL and the connection parameters of an HTTP/S check from the check info.
+    /*!
+         Build the URL and the connection parameters of an HTTP/S check from the check info.
+         \param the URL to fetch.
+         \param the extra request headers.
+         \param the CURLOPT_CONNECT_TO entry to pin an SNI request to the checked address, empty if not needed.
+     */
+    void buildHttpRequest(std::string& url, std::vector<std::string>& headers, std::string& connectTo);
+
+    //! Set the check result from the curl result of an HTTP/S fetch.
+    /*!
+         Set the check result from the curl result of an HTTP/S fetch.
+         \param the curl result.
+         \param the HTTP response code.
+         \param the response time in microseconds reported on success.
+         \param false if the body did not contain the check-expect string.
+     */
+    void setHttpResult(CURLcode res, long httpCode, uint64_t responseTime, bool matched);
+
+    //! Submit the check to the curl engine.
+    /*!
+         Submit the check to the curl engine.
+         \param the curl engine to use.
+         \param the current state.
+         \param the URL to fetch.
+         \param the extra request headers.
+         \param the CURLOPT_CONNECT_TO entry, empty if not needed.
+         \return true if the request was submitted, false to run the check on the blocking path.
+     */
+    bool submitRequest(HMCurlEngine* engine, const HMState& state, const std::string& url,
+            const std::vector<std::string>& headers, const std::string& connectTo);
+
+    //! Callback from the curl engine when the fetch completes.
+    /*!
+         Callback from the curl engine when the fetch completes.
+         Sets the check results and requeues the work.
+         \param the completed curl request.
+         \param the HMWorkHealthCheckCurl that submitted the request.
+     */
+    static void requestDone(HMCurlRequest& request, void* arg);
+
+    //! The request handed to the curl engine, its body buffer is also used by the blocking fetches.
+    HMCurlRequest m_curlRequest;
 };
 
 #endif /* HMWORKHEALTHCHECKCURL_H_ */
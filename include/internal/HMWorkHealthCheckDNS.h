@@ -8,6 +8,7 @@
 
 #include "HMConstants.h"
 #include "HMWorkHealthCheck.h"
+#include "HMDNSResolver.h"
 
 // LCOV_EXCL_START; Tested in functional testing
 //! Class to conduct a health check through DNS using the Ares Library
@@ -38,6 +39,16 @@ public:
      */
     void status(HM_REASON ret, const std::string& msg);
 
+    //! Used in the Ares callbacks to set the check result from the lookup.
+    /*!
+         Used in the Ares callbacks to set the check result from the lookup.
+         \param the Ares status of the lookup.
+         \param the number of tries that timed out.
+         \param the resolved host name.
+         \param the first resolved IP address.
+     */
+    void setCheckResult(int aresStatus, int timeouts, const std::string& name, const HMIPAddress& ip);
+
     //! Called to init and setup the work order.
     /*!
          Called to init and setup the work order.
@@ -50,8 +61,13 @@ public:
     };
 
 private:
+
+    //! Called by the DNS resolver when the lookup completes.
+    static void lookupDone(HMDNSRequest& request, void* arg);
+
     bool m_finishCallback;
     HM_WORK_STATUS m_ok;
+    HMDNSRequest m_dnsRequest;
 };
 
 #endif /* HMWORKHEALTHCHECKDNS_H_ */
@@ -7,6 +7,7 @@
 #include <cstdint>
 
 #include "HMSocketUtilTCP.h"
+#include "HMConnectEngine.h"
 #include "HMWorkHealthCheck.h"
 
 // LCOV_EXCL_START; Tested in functional testing
@@ -46,6 +47,26 @@ public:
       (void)state;
     };
 
+private:
+    //! Callback from the connect engine when the connect and check info read completes.
+    /*!
+         Callback from the connect engine when the connect and check info read completes.
+         Sets the check results and requeues the work.
+         \param the completed connect request.
+         \param the HMWorkHealthCheckTCP that submitted the request.
+     */
+    static void connectDone(HMConnectRequest& request, void* arg);
+
+    //! Submit the check to the connect engine.
+    /*!
+         Submit the check to the connect engine.
+         \param the connect engine to use.
+         \param the connect timeout in ms.
+         \return true if the request was submitted, false to run the check on the blocking path.
+     */
+    bool submitConnect(HMConnectEngine* engine, uint64_t timeout);
+
+    HMConnectRequest m_connectRequest;
 };
 
 #endif /* HMWORKHEALTHCHECKTCP_H_ */
@@ -7,6 +7,7 @@
 #include <cstdint>
 #include "HMWorkHealthCheck.h"
 #include "HMSocketUtilTCPS.h"
+#include "HMConnectEngine.h"
 
 // LCOV_EXCL_START; Tested in functional testing
 //! Health Check implementation to do a TCP connection.
@@ -45,6 +46,27 @@ public:
       (void)state;
     };
 
+private:
+    //! Callback from the connect engine when the connect, TLS handshake and check info read completes.
+    /*!
+         Callback from the connect engine when the connect, TLS handshake and check info read completes.
+         Sets the check results and requeues the work.
+         \param the completed connect request.
+         \param the HMWorkHealthCheckTCPS that submitted the request.
+     */
+    static void connectDone(HMConnectRequest& request, void* arg);
+
+    //! Submit the check to the connect engine.
+    /*!
+         Submit the check to the connect engine.
+         \param the connect engine to use.
+         \param the SSL context to run the handshake with.
+         \param the connect timeout in ms.
+         \return true if the request was submitted, false to run the check on the blocking path.
+     */
+    bool submitConnect(HMConnectEngine* engine, SSL_CTX* ctx, uint64_t timeout);
+
+    HMConnectRequest m_connectRequest;
 };
 
 #endif /* HMWORKHEALTHCHECKTCPS_H_ */
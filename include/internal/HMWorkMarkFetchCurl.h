@@ -7,6 +7,7 @@
 #include <cstdint>
 
 #include "HMWorkHealthCheck.h"
+#include "HMCurlBuffer.h"
 
 // LCOV_EXCL_START; Tested in functional testing
 
@@ -17,14 +18,6 @@ public:
     HMWorkMarkFetchCurl(const std::string& hostname, const HMIPAddress& ip, const HMDataHostCheck& hostcheck) :
         HMWorkHealthCheck(hostname, ip, hostcheck) {};
 
-    //! Callback function to update the receive buffer as data comes into CURL.
-    /*!
-          Callback function to update the receive buffer as data comes into CURL.
-          \param buf of data received from the CURL callback.
-          \param the length of the buffer.
-     */
-    void updateBuffer(char* buf, uint32_t length);
-
     //! Main function to actually conduct the health check.
     /*!
          Main function to actually conduct the health check.
@@ -45,7 +38,7 @@ public:
     }
 
 private:
-    std::string rcvdBuffer;
+    HMCurlBuffer m_rcvdBuffer;
 };
 
 #endif /* HMWORKMARKFETCHCURL_H_ */
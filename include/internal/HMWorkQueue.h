@@ -4,29 +4,35 @@
 #define HMWORKQUEUE_H_
 
 #include <memory>
-#include <queue>
+#include <deque>
+#include <vector>
 #include <mutex>
 #include <condition_variable>
 #include <atomic>
 #include <utility>
-#include <map>
+#include <unordered_map>
+#include <unordered_set>
 
+#include "HMAPI.h"
 #include "HMWork.h"
+#include "HMWorkClassQueue.h"
+#include "HMDestinationLimiter.h"
+#include "HMConstants.h"
 
 // The work queue class.
 /*!
      Maintains the queue of work to do right now. Thread safe for insertion and retrieving work.
      Work threads will block in get work until work is available, shutdown is called, or thread cycles is called.
+     The queue is split in shards, each with its own lock. Every thread is given a home shard it inserts into and takes work from.
+     A thread with an empty home shard steals a batch of work from the other shards, so work inserted by a single
+     thread (the event loop) is spread over the workers without every worker contending on one lock.
+     The work of each shard is split in work classes, handed out by the class weights so a backlog of low value work
+     does not hold back the health checks. Work of the same class is handed out in FIFO order.
  */
 class HMWorkQueue
 {
 public:
-    HMWorkQueue() :
-        m_totalTime(0),
-        m_totalCount(0),
-        m_numOffSchedule(0),
-        m_ttlTreshold(HM_DEFAULT_TTL_THRESHOLD),
-        m_shutdown(false) {};
+    HMWorkQueue(uint32_t nShards = 0);
 
     //! Cycle the work threads.
     /*!
@@ -57,6 +63,7 @@ public:
     //! Add the given work from the callback map to the active work queue.
     /*!
          Add the given work from the callback map to the active work queue.
+         If the callback fires before the work was inserted into the map, the work is queued as soon as insertMap is called.
          \param the pointer to the work to move to the active work queue.
      */
     void addWork(HMWork* value);
@@ -78,6 +85,13 @@ public:
      */
     uint32_t queueSize();
 
+    //! Get the number of shards the work queue is split in.
+    /*!
+         Get the number of shards the work queue is split in.
+         \return the number of shards.
+     */
+    uint32_t getShardCount() const;
+
     //! Get the number of work items started that have been scheduled beyond their TTL * TTLThreshold.
     /*!
          Get the number of work items started that have been scheduled beyond their TTL * TTLThreshold.
@@ -108,27 +122,128 @@ public:
      */
     void setTtlTreshold(uint32_t ttlTreshold);
 
+    //! Collect the queue wait histogram.
+    /*!
+         Collect the histogram of the time the work waited in the queue since the last call, and reset it.
+         Bucket 0 counts the work that did not wait, bucket i the waits from 2^(i-1) ms to under 2^i ms, the last bucket all the longer waits.
+         \param the histogram to add the counts to, resized to HM_WORK_QUEUE_WAIT_BUCKETS.
+     */
+    void collectQueueWait(std::vector<uint64_t>& histogram);
+
+    //! Set the parameters sharing the workers between the work classes.
+    /*!
+         Set the parameters sharing the workers between the work classes. The queued work keeps its class.
+         \param the work class weights and starvation time.
+     */
+    void setConfig(const HMWorkQueueConfig& config);
+
+    //! Get the work queue info.
+    /*!
+         Get the size of the work queue, and the weight, depth, wait and dequeue counters of each work class.
+         \param the work queue info to fill.
+     */
+    void getWorkQueueInfo(HMAPIWorkQueueInfo& info);
+
+    //! Get the limits on the work sent to each destination.
+    /*!
+         Get the limits on the work sent to each destination, checked where the checks and DNS lookups are created.
+         \return the destination limiter.
+     */
+    HMDestinationLimiter& getDestinationLimiter()
+    {
+        return m_destinationLimiter;
+    }
+
     //! Shutdown the work queue.
     void shutdown();
 
 private:
 
-    std::queue<std::unique_ptr<HMWork>> m_queue;
-    std::mutex m_queueMutex;
+    //! A shard of the work queue.
+    class Shard
+    {
+    public:
+        Shard() :
+            m_totalTime(0),
+            m_totalCount(0),
+            m_numOffSchedule(0)
+        {
+            for(auto& bucket : m_waitHistogram)
+            {
+                bucket = 0;
+            }
+            for(uint32_t i = 0; i < HM_WORK_CLASS_COUNT; i++)
+            {
+                m_classDequeued[i] = 0;
+                m_classWait[i] = 0;
+                m_classStarved[i] = 0;
+            }
+        };
+
+        std::mutex m_queueMutex;
+        HMWorkClassQueue m_queue;
+
+        std::atomic<uint64_t> m_totalTime;
+        std::atomic<uint32_t> m_totalCount;
+        std::atomic<uint64_t> m_numOffSchedule;
+        std::atomic<uint64_t> m_waitHistogram[HM_WORK_QUEUE_WAIT_BUCKETS];
+        //! The number of work taken from each class.
+        std::atomic<uint64_t> m_classDequeued[HM_WORK_CLASS_COUNT];
+        //! The total time in microseconds the work taken from each class waited in the queue.
+        std::atomic<uint64_t> m_classWait[HM_WORK_CLASS_COUNT];
+        //! The number of work taken from each class ahead of the weights because it was starved.
+        std::atomic<uint64_t> m_classStarved[HM_WORK_CLASS_COUNT];
+    };
+
+    //! A shard of the map holding work waiting on a continuation.
+    class MapShard
+    {
+    public:
+        std::mutex m_mapMutex;
+        std::unordered_map<HMWork*, std::unique_ptr<HMWork>> m_workMap;
+        //! Work completed by a continuation before it was inserted into the map.
+        std::unordered_set<HMWork*> m_earlyCompletions;
+    };
+
+    //! Get the index of the home shard for the calling thread.
+    uint32_t getHomeShard();
+
+    //! Get the map shard holding the given work.
+    MapShard& getMapShard(HMWork* work);
+
+    //! Take the next work from the home shard or steal a batch from another shard.
+    /*!
+         Take the next work from the home shard or steal a batch from another shard.
+         \param the index of the home shard of the calling thread.
+         \param the work to fill in.
+         \return true if work was found.
+     */
+    bool takeWork(uint32_t homeIndex, std::unique_ptr<HMWork>& work, bool& starved);
+
+    //! Update the queue time stats for the work about to run.
+    void updateStats(Shard& home, std::unique_ptr<HMWork>& work, bool starved);
+
+    std::vector<std::unique_ptr<Shard>> m_shards;
+    std::unique_ptr<MapShard[]> m_mapShards;
+
+    //! The total number of work orders queued in all the shards.
+    std::atomic<uint64_t> m_size;
+    //! The number of threads waiting for work.
+    std::atomic<uint32_t> m_sleepers;
 
     std::mutex m_notifyMutex;
     std::condition_variable m_notifyCond;
 
-    std::atomic<uint64_t> m_totalTime;
-    std::atomic<uint32_t> m_totalCount;
-    std::atomic<uint64_t> m_numOffSchedule;
     uint32_t m_ttlTreshold;
 
-    std::mutex m_mapMutex;
+    //! The dequeue weight of each work class.
+    std::atomic<uint32_t> m_weights[HM_WORK_CLASS_COUNT];
+    //! The time in microseconds work can wait before its class is starved.
+    std::atomic<uint64_t> m_starvationTime;
 
-    std::map<HMWork*, std::unique_ptr<HMWork>> m_workMap;
+    HMDestinationLimiter m_destinationLimiter;
 
-    bool m_shutdown;
+    std::atomic<bool> m_shutdown;
 };
 
 #endif /* HMWORKQUEUE_H_ */
@@ -5,12 +5,15 @@
 #include <vector>
 #include <string>
 #include <set>
+#include <memory>
 
 // LCOV_EXCL_START; Tested in functional testing
 
 #ifndef HMWORKREMOTECHECKREMOTE_H_
 #define HMWORKREMOTECHECKREMOTE_H_
 
+class HMSocketUtilBase;
+
 class HMWorkRemoteCheckRemote : public HMWorkRemoteCheck
 {
 
@@ -47,6 +50,16 @@ private:
      */
     bool getHostResult(HMState& state, const std::string& remoteHost, HMDataCheckResult& remote);
 
+    /*!
+         Called to get the results changed since the last fetch from remote host and merge them with the stored results.
+         \param current state.
+         \param the socket connected to the remote host.
+         \param the address of the remote host.
+         \param the timeout of the fetch.
+         \return true if m_results holds all the results of the hostgroup.
+     */
+    bool getHostGroupDelta(HMState& state, std::shared_ptr<HMSocketUtilBase>& socketAPI, const HMIPAddress& peer, timeval& tv);
+
     //! Called to get the connect and communicate from remote host.
     bool remoteCheck(HMState& state, HMDataHostGroup& dataHostGroup);
 
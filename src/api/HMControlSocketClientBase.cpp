@@ -148,13 +148,46 @@ HMControlSocketClientBase::getThreadInfo(HMAPIThreadInfo& threadInfo)
     return false;
 }
 
+bool
+HMControlSocketClientBase::getStoreInfo(HMAPIStoreInfo& storeInfo)
+{
+    string cmd = to_string(HM_CONTROL_SOCKET_VERSION) + " " + HM_CMD_STOREINFO;
+    if (sendMessage(cmd))
+    {
+        unique_ptr<char[]> data;
+        uint64_t dataSize = 0;
+        if (receivePacket(data, dataSize))
+        {
+            return dataPacking->unpackStoreInfo(data, dataSize, storeInfo);
+        }
+    }
+    return false;
+}
+
 bool
 HMControlSocketClientBase::getWorkQueue(uint32_t &workQLen)
+{
+    HMAPIWorkQueueInfo workQueueInfo;
+    if(getWorkQueueInfo(workQueueInfo))
+    {
+        workQLen = workQueueInfo.m_queueSize;
+        return true;
+    }
+    return false;
+}
+
+bool
+HMControlSocketClientBase::getWorkQueueInfo(HMAPIWorkQueueInfo& workQueueInfo)
 {
     string cmd = to_string(HM_CONTROL_SOCKET_VERSION) + " " + HM_CMD_WORKQUEUEINFO;
-    if( sendMessage(cmd))
+    if (sendMessage(cmd))
     {
-        return receiveUInt(workQLen);
+        unique_ptr<char[]> data;
+        uint64_t dataSize = 0;
+        if (receivePacket(data, dataSize))
+        {
+            return dataPacking->unpackWorkQueueInfo(data, dataSize, workQueueInfo);
+        }
     }
     return false;
 }
@@ -80,11 +80,12 @@ HMStorageAPI::init(const string& masterConfig, bool localConfigs)
 bool
 HMStorageAPI::updateState(shared_ptr<HMState>& current)
 {
-    if(current == m_currentState)
+    shared_ptr<HMState> state = atomic_load(&m_currentState);
+    if(current == state)
     {
         return false;
     }
-    current = m_currentState;
+    current = move(state);
     return true;
 }
 
@@ -178,7 +179,7 @@ HMStorageAPI::updateConfigs()
             newState.reset();
             return false;
         }
-        newState.swap(m_currentState);
+        atomic_store(&m_currentState, newState);
     }
     return true;
 }
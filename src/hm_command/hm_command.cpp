@@ -37,8 +37,9 @@ static void usage(char* name)
                 << "-v      verbose " << endl
                 << "Commands:"<<endl
                 << "\t" <<"threadinfo\tReturns # of total and idle threads" <<endl
-                << "\t" <<"workqueueinfo\tReturns length of WorkQueue" <<endl
+                << "\t" <<"workqueueinfo\tReturns length of WorkQueue and the work class counters" <<endl
                 << "\t" <<"schdqueueinfo\tReturns length of Scheduler queue" <<endl
+                << "\t" <<"storeinfo\tReturns the storage commit queue counters" <<endl
                 << "\t" <<"refresh\tRefreshes the configs" <<endl
                 << "\t" <<"reload <master config>\tReload healthmon daemon. Master config is optional" <<endl
                 << "\t" <<"hostschdinfo <hostgroup name> <hostname> \tReturns Scheduling info about host in the hostgroup" <<endl
@@ -105,13 +106,49 @@ bool runCommand(const vector<string> &strArgs)
         bool status = socketAPI.getThreadInfo(threadInfo);
         cout << "Number of threads  = "  << threadInfo.m_numThreads << endl;
         cout << "Number of idle threads  = "  << threadInfo.m_numIdleThreads << endl;
+        cout << "Min/max threads  = "  << threadInfo.m_minThreads << "/" << threadInfo.m_maxThreads << endl;
+        cout << "Target threads  = "  << threadInfo.m_targetThreads << endl;
+        cout << "Queue wait p50/p99  = "  << threadInfo.m_queueWaitP50 << "/" << threadInfo.m_queueWaitP99 << " ms" << endl;
+        cout << "Worker utilisation  = "  << threadInfo.m_utilisation << "%" << endl;
+        cout << "Grows/shrinks  = "  << threadInfo.m_numGrows << "/" << threadInfo.m_numShrinks << endl;
+        cout << "Recycles  = "  << threadInfo.m_numRecycles << endl;
+        cout << "Resident memory  = "  << threadInfo.m_residentMemory << " kB" << endl;
+        cout << "Open files  = "  << threadInfo.m_openFiles << endl;
         return status;
     }
     else if (strArgs[0] == HM_CMD_WORKQUEUEINFO)
     {
-        uint32_t workQueueLen = 0;
-        bool status = socketAPI.getWorkQueue(workQueueLen);
-        cout << "Work queue length = " << workQueueLen << endl;
+        HMAPIWorkQueueInfo workQueueInfo;
+        bool status = socketAPI.getWorkQueueInfo(workQueueInfo);
+        cout << "Work queue length = " << workQueueInfo.m_queueSize << endl;
+        cout << "Shards  = " << workQueueInfo.m_numShards << endl;
+        cout << "Starvation time  = " << workQueueInfo.m_starvationTime << " ms" << endl;
+        for(const HMAPIWorkClassInfo& classInfo : workQueueInfo.m_classes)
+        {
+            double avgWait = classInfo.m_dequeued ? (double)classInfo.m_totalWait / classInfo.m_dequeued / 1000 : 0;
+            cout << classInfo.m_name << ": weight " << classInfo.m_weight
+                    << ", depth " << classInfo.m_depth
+                    << ", dequeued " << classInfo.m_dequeued
+                    << ", starved " << classInfo.m_starved
+                    << ", avg wait " << avgWait << " ms"
+                    << ", oldest wait " << classInfo.m_oldestWait / 1000 << " ms" << endl;
+        }
+        return status;
+    }
+    else if (strArgs[0] == HM_CMD_STOREINFO)
+    {
+        HMAPIStoreInfo storeInfo;
+        bool status = socketAPI.getStoreInfo(storeInfo);
+        cout << "Queue size/batch size  = "  << storeInfo.m_queueSize << "/" << storeInfo.m_batchSize << endl;
+        cout << "Overflow policy  = "  << ((storeInfo.m_overflowPolicy == HM_STORAGE_OVERFLOW_DROP_OLDEST) ? "dropoldest" : "block") << endl;
+        cout << "Check updates queued/enqueued  = "  << storeInfo.m_checksQueued << "/" << storeInfo.m_checksEnqueued << endl;
+        cout << "Check updates dropped/blocked/coalesced  = "  << storeInfo.m_checksDropped << "/" << storeInfo.m_checksBlocked
+                << "/" << storeInfo.m_checksCoalesced << endl;
+        cout << "Check batches  = "  << storeInfo.m_checkBatches << endl;
+        cout << "Aux updates queued/enqueued  = "  << storeInfo.m_auxQueued << "/" << storeInfo.m_auxEnqueued << endl;
+        cout << "Aux updates dropped/blocked/coalesced  = "  << storeInfo.m_auxDropped << "/" << storeInfo.m_auxBlocked
+                << "/" << storeInfo.m_auxCoalesced << endl;
+        cout << "Aux batches  = "  << storeInfo.m_auxBatches << endl;
         return status;
     }
     else if (strArgs[0] == HM_CMD_SCHDQUEUEINFO)
@@ -513,6 +550,7 @@ int main(int argc, char* argv[])
     case WORKQUEUEINFO:
     case THREADINFO:
     case SCHDQUEUEINFO:
+    case STOREINFO:
     case GETLOGLEVEL:
     case GETCONNECTIONTIMEOUT:
     case GETMONFREQ:
@@ -588,6 +626,7 @@ int main(int argc, char* argv[])
     case GETHOSTGROUPHASH:
     case GETTRANSCONFIGHASH:
     case LOADFBINFOHOST:
+    case HOSTGROUPDELTA:
     case UNDEFINED:
         cerr << "Not all commands are supported at this time" << endl;
         return -3;
@@ -707,6 +707,7 @@ int main(int argc, char* argv[])
     case WORKQUEUEINFO:
     case THREADINFO:
     case SCHDQUEUEINFO:
+    case STOREINFO:
     case HEALTHCHECK:
     case DNSCHECK:
     case RELOAD:
@@ -742,6 +743,7 @@ int main(int argc, char* argv[])
     case REMOTESCHDINFO:
     case LOADFBINFOHOST:
     case REFRESH:
+    case HOSTGROUPDELTA:
     case UNDEFINED:
         cerr << "Not all commands are supported at this time" << endl;
         return -3;
@@ -165,6 +165,7 @@ int main(int argc, char* argv[])
     case WORKQUEUEINFO:
     case THREADINFO:
     case SCHDQUEUEINFO:
+    case STOREINFO:
     case HEALTHCHECK:
     case DNSCHECK:
     case SETLOGLEVEL:
@@ -210,6 +211,7 @@ int main(int argc, char* argv[])
     case REMOTESCHDINFO:
     case LOADFBINFOHOST:
     case REFRESH:
+    case HOSTGROUPDELTA:
     case UNDEFINED:
         cerr << "Not all commands are supported at this time" << endl;
         return -3;
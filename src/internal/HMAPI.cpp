@@ -11,6 +11,9 @@ HMAPICheckResult::HMAPICheckResult() :
                 m_start(0),
                 m_end(0),
                 m_responseTime(0),
+                m_tcpConnectTime(0),
+                m_tlsHandshakeTime(0),
+                m_responseTimeMicros(0),
                 m_totalResponseTime(0),
                 m_minResponseTime(0),
                 m_maxResponseTime(0),
@@ -49,6 +52,9 @@ HMAPICheckResult::HMAPICheckResult(HMDataCheckResult& k)
     m_start = k.m_start.getTimeSinceEpoch();
     m_end = k.m_end.getTimeSinceEpoch();
     m_responseTime = k.m_responseTime;
+    m_tcpConnectTime = k.m_tcpConnectTime;
+    m_tlsHandshakeTime = k.m_tlsHandshakeTime;
+    m_responseTimeMicros = k.m_responseTimeMicros;
     m_totalResponseTime = k.m_totalResponseTime;
     m_minResponseTime = k.m_minResponseTime;
     m_maxResponseTime = k.m_maxResponseTime;
@@ -90,6 +96,9 @@ HMAPICheckResult::HMAPICheckResult(HMGroupCheckResult& k)
     m_start = k.m_result.m_start.getTimeSinceEpoch();
     m_end = k.m_result.m_end.getTimeSinceEpoch();
     m_responseTime = k.m_result.m_responseTime;
+    m_tcpConnectTime = k.m_result.m_tcpConnectTime;
+    m_tlsHandshakeTime = k.m_result.m_tlsHandshakeTime;
+    m_responseTimeMicros = k.m_result.m_responseTimeMicros;
     m_totalResponseTime = k.m_result.m_totalResponseTime;
     m_minResponseTime = k.m_result.m_minResponseTime;
     m_maxResponseTime = k.m_result.m_maxResponseTime;
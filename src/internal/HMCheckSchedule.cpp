@@ -0,0 +1,62 @@
+// Copyright 2019, Oath Inc.
+// Licensed under the terms of the Apache 2.0 license. See LICENSE file in the root of the distribution for licensing details.
+#include <random>
+
+#include "HMCheckSchedule.h"
+
+using namespace std;
+
+void
+HMCheckSchedule::setConfig(const HMCheckScheduleConfig& config)
+{
+    m_spreadWindow = config.m_spreadWindow;
+    m_jitterPercent = (config.m_jitterPercent > HM_MAX_SCHEDULE_JITTER_PERCENT) ? HM_MAX_SCHEDULE_JITTER_PERCENT : config.m_jitterPercent;
+    m_rampInterval = config.m_rampUpRate ? 1000000 / config.m_rampUpRate : 0;
+    m_rampNext = 0;
+}
+
+HMMonotonicTime
+HMCheckSchedule::spread(uint64_t hash, uint64_t ttl, bool rampUp)
+{
+    HMMonotonicTime checkTime = HMMonotonicTime::now();
+    uint64_t interval = m_rampInterval;
+    if(rampUp && interval > 0)
+    {
+        uint64_t next = m_rampNext;
+        uint64_t slot;
+        do
+        {
+            slot = (next > checkTime.getMicroseconds()) ? next : checkTime.getMicroseconds();
+        } while(!m_rampNext.compare_exchange_weak(next, slot + interval));
+        checkTime = HMMonotonicTime(slot);
+    }
+
+    uint64_t window = m_spreadWindow;
+    window = (ttl < window) ? ttl : window;
+    if(window > 0)
+    {
+        // Mix the hash so checks with close hashes do not get close phases
+        hash ^= hash >> 33;
+        hash *= 0xff51afd7ed558ccdULL;
+        hash ^= hash >> 33;
+        checkTime = checkTime.plusMicroseconds(hash % (window * 1000));
+    }
+    return checkTime;
+}
+
+HMMonotonicTime
+HMCheckSchedule::jitter(HMMonotonicTime timeStamp) const
+{
+    uint32_t percent = m_jitterPercent;
+    if(percent == 0)
+    {
+        return timeStamp;
+    }
+    uint64_t maxJitter = timeStamp.microsecondsSince(HMMonotonicTime::now()) * percent / 100;
+    if(maxJitter == 0)
+    {
+        return timeStamp;
+    }
+    thread_local minstd_rand generator(random_device{}());
+    return timeStamp.plusMicroseconds(uniform_int_distribution<uint64_t>(0, maxJitter)(generator));
+}
@@ -407,6 +407,10 @@ HMConfigParserYAML::parseConfig(const string& fileName, HMState& checkState, HMC
                     res->second = val;
                 }
             }
+            else if (key == "check-expect")
+            {
+                currentHostGroup->second.setCheckExpect(val);
+            }
             else if (key == "check-retries")
             {
                 currentHostGroup->second.setNumCheckRetries(atoi(val.c_str()));
@@ -519,6 +523,44 @@ HMConfigParserYAML::parseConfig(const string& fileName, HMState& checkState, HMC
                             fileName.c_str(), n.second.Mark().line);
                 }
             }
+            else if (key == "keepalive")
+            {
+                if (val == "on")
+                {
+                    currentHostGroup->second.setKeepAlive(true);
+                }
+                else if (val == "off")
+                {
+                    currentHostGroup->second.setKeepAlive(false);
+                }
+                else
+                {
+                    nerr++;
+                    HMLog(HM_LOG_ERROR, "%s(%d): Invalid keepalive mode",
+                            fileName.c_str(), n.second.Mark().line);
+                }
+            }
+            else if (key == "priority")
+            {
+                if (val == "high")
+                {
+                    currentHostGroup->second.setPriority(HM_WORK_PRIORITY_HIGH);
+                }
+                else if (val == "normal")
+                {
+                    currentHostGroup->second.setPriority(HM_WORK_PRIORITY_NORMAL);
+                }
+                else if (val == "low")
+                {
+                    currentHostGroup->second.setPriority(HM_WORK_PRIORITY_LOW);
+                }
+                else
+                {
+                    nerr++;
+                    HMLog(HM_LOG_ERROR, "%s(%d): Invalid priority",
+                            fileName.c_str(), n.second.Mark().line);
+                }
+            }
             else if (key == "dns-type")
             {
                 if (val == "lookup")
@@ -613,6 +655,10 @@ HMConfigParserYAML::writeConfigs(HMState& state, std::string outFile)
         {
             outFileStream << "    check-info: " << it.second.getCheckInfo() << endl;
         }
+        if (it.second.getCheckExpect().size() > 0)
+        {
+            outFileStream << "    check-expect: " << it.second.getCheckExpect() << endl;
+        }
         outFileStream << "    timeout: " << it.second.getCheckTimeout() << endl;
         outFileStream << "    check-port: " << it.second.getCheckPort() << endl;
         outFileStream << "    dual-stack-mode: " << printDualStack(it.second.getDualstack()) << endl;
@@ -635,6 +681,14 @@ HMConfigParserYAML::writeConfigs(HMState& state, std::string outFile)
         {
             outFileStream << "    tos-value: " << (int)it.second.getTOSValue() << endl;
         }
+        if(it.second.getKeepAlive())
+        {
+            outFileStream << "    keepalive: on" << endl;
+        }
+        if(it.second.getPriority() != HM_WORK_PRIORITY_NORMAL)
+        {
+            outFileStream << "    priority: " << printWorkPriority(it.second.getPriority()) << endl;
+        }
         outFileStream << "    flow-type: " << printFlowType(it.second.getFlowType()) << endl;
         const vector<string>* hosts = it.second.getHostList();
         if(hosts->size() > 0)
@@ -0,0 +1,692 @@
+// Copyright 2019, Oath Inc.
+// Licensed under the terms of the Apache 2.0 license. See LICENSE file in the root of the distribution for licensing details.
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <netinet/in.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <signal.h>
+#include <system_error>
+
+#include <openssl/err.h>
+
+#include "HMConnectEngine.h"
+#include "HMLogBase.h"
+
+using namespace std;
+
+//! The max number of epoll events to process per wakeup.
+#define HM_CONNECT_ENGINE_MAX_EVENTS 1024
+
+static string
+connectEngineError(const string& msg)
+{
+    error_code ec(errno, generic_category());
+    return msg + " " + ec.message();
+}
+
+static string
+tlsError(const string& msg)
+{
+    char buf[256];
+    unsigned long err = ERR_get_error();
+    if(err == 0)
+    {
+        return connectEngineError(msg);
+    }
+    ERR_error_string_n(err, buf, sizeof(buf));
+    return msg + " " + buf;
+}
+
+HMConnectEngine::~HMConnectEngine()
+{
+    shutDown();
+}
+
+bool
+HMConnectEngine::start()
+{
+    if(m_keepRunning)
+    {
+        return true;
+    }
+    m_keepRunning = true;
+    for(uint32_t i = 0; i < m_nThreads; i++)
+    {
+        unique_ptr<Reactor> reactor = make_unique<Reactor>();
+        reactor->m_epollFd = epoll_create1(EPOLL_CLOEXEC);
+        reactor->m_wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if(reactor->m_epollFd < 0 || reactor->m_wakeFd < 0)
+        {
+            HMLog(HM_LOG_CRITICAL, "[CONNECT] %s", connectEngineError("Failed to create the connect engine").c_str());
+            if(reactor->m_epollFd >= 0)
+            {
+                close(reactor->m_epollFd);
+            }
+            if(reactor->m_wakeFd >= 0)
+            {
+                close(reactor->m_wakeFd);
+            }
+            shutDown();
+            return false;
+        }
+        epoll_event ev;
+        memset(&ev, 0, sizeof(ev));
+        ev.events = EPOLLIN;
+        ev.data.fd = reactor->m_wakeFd;
+        epoll_ctl(reactor->m_epollFd, EPOLL_CTL_ADD, reactor->m_wakeFd, &ev);
+        reactor->m_thread = thread(&HMConnectEngine::run, this, reactor.get());
+        m_reactors.push_back(move(reactor));
+    }
+    HMLog(HM_LOG_NOTICE, "[CONNECT] Started connect engine with %u threads", m_nThreads);
+    return true;
+}
+
+void
+HMConnectEngine::shutDown()
+{
+    m_keepRunning = false;
+    for(auto& reactor : m_reactors)
+    {
+        uint64_t val = 1;
+        if(write(reactor->m_wakeFd, &val, sizeof(val)) < 0)
+        {
+            HMLog(HM_LOG_DEBUG, "[CONNECT] Failed to wake connect engine thread");
+        }
+    }
+    for(auto& reactor : m_reactors)
+    {
+        if(reactor->m_thread.joinable())
+        {
+            reactor->m_thread.join();
+        }
+        close(reactor->m_wakeFd);
+        close(reactor->m_epollFd);
+    }
+    m_reactors.clear();
+}
+
+bool
+HMConnectEngine::submit(HMConnectRequest& request)
+{
+    if(!m_keepRunning || m_reactors.empty())
+    {
+        return false;
+    }
+    Reactor* reactor = m_reactors[m_nextReactor++ % m_reactors.size()].get();
+    request.m_reason = HM_REASON_NONE;
+    request.m_connectTime = HMMonotonicTime();
+    request.m_handshakeTime = HMMonotonicTime();
+    request.m_sessionReused = false;
+    request.m_data.clear();
+    request.m_errorMsg.clear();
+    m_inFlight++;
+    {
+        lock_guard<mutex> lk(reactor->m_submitMutex);
+        reactor->m_submitted.push_back(&request);
+    }
+    uint64_t val = 1;
+    if(write(reactor->m_wakeFd, &val, sizeof(val)) < 0)
+    {
+        HMLog(HM_LOG_DEBUG, "[CONNECT] Failed to wake connect engine thread");
+    }
+    return true;
+}
+
+uint64_t
+HMConnectEngine::getInFlight() const
+{
+    return m_inFlight;
+}
+
+uint32_t
+HMConnectEngine::getNThreads() const
+{
+    return m_nThreads;
+}
+
+HMTLSSessionCache&
+HMConnectEngine::getSessionCache()
+{
+    return m_sessionCache;
+}
+
+void
+HMConnectEngine::run(Reactor* reactor)
+{
+    signal(SIGPIPE, SIG_IGN);
+    vector<epoll_event> events(HM_CONNECT_ENGINE_MAX_EVENTS);
+    vector<HMConnectRequest*> submitted;
+
+    while(m_keepRunning)
+    {
+        int timeout = -1;
+        if(!reactor->m_deadlines.empty())
+        {
+            HMMonotonicTime now = HMMonotonicTime::now();
+            HMMonotonicTime next = reactor->m_deadlines.begin()->first;
+            timeout = (next <= now) ? 0 : (int)(next - now);
+        }
+
+        int nEvents = epoll_wait(reactor->m_epollFd, events.data(), events.size(), timeout);
+        if(nEvents < 0 && errno != EINTR)
+        {
+            HMLog(HM_LOG_ERROR, "[CONNECT] %s", connectEngineError("epoll_wait failed").c_str());
+        }
+
+        for(int i = 0; i < nEvents; i++)
+        {
+            if(events[i].data.fd == reactor->m_wakeFd)
+            {
+                uint64_t val;
+                while(read(reactor->m_wakeFd, &val, sizeof(val)) > 0);
+                continue;
+            }
+            handleEvent(reactor, events[i].data.fd, events[i].events);
+        }
+
+        {
+            lock_guard<mutex> lk(reactor->m_submitMutex);
+            submitted.swap(reactor->m_submitted);
+        }
+        for(auto request : submitted)
+        {
+            startConnect(reactor, request);
+        }
+        submitted.clear();
+
+        expire(reactor);
+    }
+
+    // Hand back everything still pending so the owners can finish.
+    {
+        lock_guard<mutex> lk(reactor->m_submitMutex);
+        submitted.swap(reactor->m_submitted);
+    }
+    for(auto request : submitted)
+    {
+        fail(request, HM_REASON_INTERNAL_ERROR, "connect engine shutdown");
+    }
+    while(!reactor->m_connections.empty())
+    {
+        Connection* conn = reactor->m_connections.begin()->second.get();
+        if(conn->m_request == nullptr)
+        {
+            closeConnection(reactor, conn);
+            continue;
+        }
+        conn->m_request->m_errorMsg = "connect engine shutdown";
+        complete(reactor, conn, HM_REASON_INTERNAL_ERROR);
+    }
+}
+
+void
+HMConnectEngine::startConnect(Reactor* reactor, HMConnectRequest* request)
+{
+    request->m_start = HMMonotonicTime::now();
+    int fd = socket(request->m_address.getType(), SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if(fd < 0)
+    {
+        fail(request, HM_REASON_INTERNAL_ERROR, connectEngineError("tcp check socket()"));
+        return;
+    }
+
+    if(request->m_tos)
+    {
+        if(setsockopt(fd, IPPROTO_IP, IP_TOS, &request->m_tos, sizeof(request->m_tos)) < 0)
+        {
+            close(fd);
+            fail(request, HM_REASON_INTERNAL_ERROR, connectEngineError("Error setting TOS:"));
+            return;
+        }
+    }
+
+    if(request->m_sourceAddress.isSet())
+    {
+        sockaddr_storage localAddress;
+        socklen_t localLen = sizeof(localAddress);
+        memset(&localAddress, 0, sizeof(localAddress));
+        request->m_sourceAddress.getSockaddr(&localAddress, &localLen, 0);
+        if(::bind(fd, (sockaddr*)&localAddress, localLen) < 0)
+        {
+            HMLog(HM_LOG_ERROR, "[CONNECT] Failed to bind source IP for %s", request->m_sourceAddress.toString().c_str());
+        }
+    }
+
+    sockaddr_storage server;
+    socklen_t len = sizeof(server);
+    memset(&server, 0, sizeof(server));
+    request->m_address.getSockaddr(&server, &len, request->m_port);
+
+    unique_ptr<Connection> conn = make_unique<Connection>(fd, request);
+    Connection* connPtr = conn.get();
+    conn->m_deadline = reactor->m_deadlines.end();
+    reactor->m_connections.emplace(fd, move(conn));
+
+    if(connect(fd, (sockaddr*)&server, len) == 0)
+    {
+        connected(reactor, connPtr);
+        return;
+    }
+    if(errno != EINPROGRESS)
+    {
+        connPtr->m_request->m_errorMsg = connectEngineError("tcp check connect");
+        complete(reactor, connPtr, HM_REASON_CONNECT_FAILURE);
+        return;
+    }
+
+    if(!watch(reactor, connPtr, EPOLLOUT))
+    {
+        connPtr->m_request->m_errorMsg = connectEngineError("epoll_ctl");
+        complete(reactor, connPtr, HM_REASON_INTERNAL_ERROR);
+        return;
+    }
+    setDeadline(reactor, connPtr, request->m_connectTimeout);
+}
+
+void
+HMConnectEngine::handleEvent(Reactor* reactor, int fd, uint32_t events)
+{
+    auto it = reactor->m_connections.find(fd);
+    if(it == reactor->m_connections.end())
+    {
+        return;
+    }
+    Connection* conn = it->second.get();
+
+    switch(conn->m_state)
+    {
+    case CONNECT_PENDING:
+    {
+        int err = 0;
+        socklen_t errLen = sizeof(err);
+        if(getsockopt(fd, SOL_SOCKET, SO_ERROR, &err, &errLen) < 0)
+        {
+            conn->m_request->m_errorMsg = connectEngineError("tcp check getsockopt");
+            complete(reactor, conn, HM_REASON_INTERNAL_ERROR);
+        }
+        else if(err == ETIMEDOUT)
+        {
+            complete(reactor, conn, HM_REASON_CONNECT_TIMEOUT);
+        }
+        else if(err != 0)
+        {
+            complete(reactor, conn, HM_REASON_CONNECT_FAILURE);
+        }
+        else if(events & (EPOLLOUT | EPOLLIN))
+        {
+            connected(reactor, conn);
+        }
+        break;
+    }
+    case HANDSHAKE_PENDING:
+        handshake(reactor, conn);
+        break;
+    case READ_PENDING:
+        if(events & (EPOLLIN | EPOLLOUT | EPOLLHUP | EPOLLERR))
+        {
+            readData(reactor, conn);
+        }
+        break;
+    case TICKET_PENDING:
+        readTicket(reactor, conn);
+        break;
+    }
+}
+
+void
+HMConnectEngine::connected(Reactor* reactor, Connection* conn)
+{
+    HMConnectRequest* request = conn->m_request;
+    request->m_connectTime = HMMonotonicTime::now();
+
+    sockaddr_storage local;
+    socklen_t localLen = sizeof(local);
+    if(getsockname(conn->m_fd, (sockaddr*)&local, &localLen) == 0)
+    {
+        request->m_clientPort = (local.ss_family == AF_INET6) ?
+                ntohs(((sockaddr_in6*)&local)->sin6_port) : ntohs(((sockaddr_in*)&local)->sin_port);
+    }
+
+    if(request->m_sslCtx != nullptr)
+    {
+        startHandshake(reactor, conn);
+        return;
+    }
+    startRead(reactor, conn);
+}
+
+void
+HMConnectEngine::startHandshake(Reactor* reactor, Connection* conn)
+{
+    HMConnectRequest* request = conn->m_request;
+    conn->m_ssl = SSL_new(request->m_sslCtx);
+    if(conn->m_ssl == nullptr || SSL_set_fd(conn->m_ssl, conn->m_fd) != 1)
+    {
+        request->m_errorMsg = tlsError("tcps check SSL_new");
+        complete(reactor, conn, HM_REASON_INTERNAL_ERROR);
+        return;
+    }
+    conn->m_address = request->m_address;
+    conn->m_port = request->m_port;
+
+    SSL_SESSION* session = m_sessionCache.get(conn->m_address, conn->m_port, request->m_sslCtx);
+    if(session != nullptr)
+    {
+        SSL_set_session(conn->m_ssl, session);
+        SSL_SESSION_free(session);
+    }
+
+    conn->m_state = HANDSHAKE_PENDING;
+    setDeadline(reactor, conn, request->m_connectTimeout);
+    handshake(reactor, conn);
+}
+
+void
+HMConnectEngine::handshake(Reactor* reactor, Connection* conn)
+{
+    HMConnectRequest* request = conn->m_request;
+    ERR_clear_error();
+    int ret = SSL_connect(conn->m_ssl);
+    if(ret == 1)
+    {
+        request->m_handshakeTime = HMMonotonicTime::now();
+        request->m_sessionReused = SSL_session_reused(conn->m_ssl);
+#if OPENSSL_VERSION_NUMBER >= 0x10101000L
+        if(SSL_version(conn->m_ssl) >= TLS1_3_VERSION)
+        {
+            // The ticket to resume with comes after the handshake and replaces the session of the connection
+            conn->m_session = SSL_get1_session(conn->m_ssl);
+        }
+        else
+#endif
+        {
+            storeSession(conn);
+        }
+        startRead(reactor, conn);
+        return;
+    }
+
+    int err = SSL_get_error(conn->m_ssl, ret);
+    if(err == SSL_ERROR_WANT_READ || err == SSL_ERROR_WANT_WRITE)
+    {
+        if(!watch(reactor, conn, (err == SSL_ERROR_WANT_READ) ? EPOLLIN : EPOLLOUT))
+        {
+            request->m_errorMsg = connectEngineError("epoll_ctl");
+            complete(reactor, conn, HM_REASON_INTERNAL_ERROR);
+        }
+        return;
+    }
+
+    // Don't offer the session again to a target that failed the handshake
+    m_sessionCache.remove(conn->m_address, conn->m_port);
+    HMLog(HM_LOG_DEBUG3, "[CONNECT] %s", tlsError("TLS handshake failed").c_str());
+    complete(reactor, conn, HM_REASON_CONNECT_FAILURE);
+}
+
+void
+HMConnectEngine::startRead(Reactor* reactor, Connection* conn)
+{
+    HMConnectRequest* request = conn->m_request;
+    if(request->m_readSize == 0)
+    {
+        complete(reactor, conn, HM_REASON_SUCCESS);
+        return;
+    }
+
+    conn->m_state = READ_PENDING;
+    request->m_data.reserve(request->m_readSize);
+
+    if(!watch(reactor, conn, EPOLLIN))
+    {
+        request->m_errorMsg = connectEngineError("epoll_ctl");
+        complete(reactor, conn, HM_REASON_INTERNAL_ERROR);
+        return;
+    }
+    setDeadline(reactor, conn, request->m_readTimeout);
+    if(conn->m_ssl != nullptr)
+    {
+        // The banner can come in with the end of the handshake, already read from the socket
+        readData(reactor, conn);
+    }
+}
+
+void
+HMConnectEngine::readData(Reactor* reactor, Connection* conn)
+{
+    HMConnectRequest* request = conn->m_request;
+    char buffer[512];
+    while(conn->m_nRead < request->m_readSize)
+    {
+        size_t want = request->m_readSize - conn->m_nRead;
+        if(want > sizeof(buffer))
+        {
+            want = sizeof(buffer);
+        }
+        if(conn->m_ssl != nullptr)
+        {
+            ERR_clear_error();
+            int ret = SSL_read(conn->m_ssl, buffer, want);
+            if(ret > 0)
+            {
+                request->m_data.append(buffer, ret);
+                conn->m_nRead += ret;
+                HMLog(HM_LOG_DEBUG3, "[CONNECT] TLS bytes %d received", ret);
+                continue;
+            }
+            int err = SSL_get_error(conn->m_ssl, ret);
+            if(err == SSL_ERROR_WANT_READ || err == SSL_ERROR_WANT_WRITE)
+            {
+                if(!watch(reactor, conn, (err == SSL_ERROR_WANT_READ) ? EPOLLIN : EPOLLOUT))
+                {
+                    request->m_errorMsg = connectEngineError("epoll_ctl");
+                    complete(reactor, conn, HM_REASON_INTERNAL_ERROR);
+                }
+                return;
+            }
+            HMLog(HM_LOG_DEBUG3, "[CONNECT] %s", tlsError("TLS read - connection closed").c_str());
+            complete(reactor, conn, HM_REASON_RESPONSE_FAILURE);
+            return;
+        }
+
+        ssize_t ret = read(conn->m_fd, buffer, want);
+        if(ret > 0)
+        {
+            request->m_data.append(buffer, ret);
+            conn->m_nRead += ret;
+            HMLog(HM_LOG_DEBUG3, "[CONNECT] TCP bytes %d received", (int)ret);
+        }
+        else if(ret == 0)
+        {
+            HMLog(HM_LOG_DEBUG3, "[CONNECT] TCP read - No more data to send ,shutdown on other end");
+            complete(reactor, conn, HM_REASON_RESPONSE_FAILURE);
+            return;
+        }
+        else if(errno == EAGAIN || errno == EWOULDBLOCK)
+        {
+            return;
+        }
+        else if(errno != EINTR)
+        {
+            request->m_errorMsg = connectEngineError("tcp check read");
+            complete(reactor, conn, HM_REASON_INTERNAL_ERROR);
+            return;
+        }
+    }
+    complete(reactor, conn, HM_REASON_SUCCESS);
+}
+
+void
+HMConnectEngine::readTicket(Reactor* reactor, Connection* conn)
+{
+    char buffer[512];
+    ERR_clear_error();
+    int ret = SSL_read(conn->m_ssl, buffer, sizeof(buffer));
+    if(storeSession(conn))
+    {
+        closeConnection(reactor, conn);
+        return;
+    }
+    if(ret > 0)
+    {
+        return;
+    }
+    int err = SSL_get_error(conn->m_ssl, ret);
+    if(err == SSL_ERROR_WANT_READ)
+    {
+        return;
+    }
+    if(err != SSL_ERROR_WANT_WRITE || !watch(reactor, conn, EPOLLOUT))
+    {
+        closeConnection(reactor, conn);
+    }
+}
+
+bool
+HMConnectEngine::storeSession(Connection* conn)
+{
+    SSL_SESSION* session = SSL_get_session(conn->m_ssl);
+    if(session == nullptr || session == conn->m_session)
+    {
+        return false;
+    }
+#if OPENSSL_VERSION_NUMBER >= 0x10101000L
+    if(!SSL_SESSION_is_resumable(session))
+    {
+        return false;
+    }
+#endif
+    SSL_SESSION_up_ref(session);
+    m_sessionCache.store(conn->m_address, conn->m_port, SSL_get_SSL_CTX(conn->m_ssl), session);
+    conn->m_sessionStored = true;
+    return true;
+}
+
+bool
+HMConnectEngine::watch(Reactor* reactor, Connection* conn, uint32_t events)
+{
+    if(conn->m_events == events)
+    {
+        return true;
+    }
+    epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = events;
+    ev.data.fd = conn->m_fd;
+    if(epoll_ctl(reactor->m_epollFd, conn->m_events ? EPOLL_CTL_MOD : EPOLL_CTL_ADD, conn->m_fd, &ev) < 0)
+    {
+        return false;
+    }
+    conn->m_events = events;
+    return true;
+}
+
+void
+HMConnectEngine::expire(Reactor* reactor)
+{
+    HMMonotonicTime now = HMMonotonicTime::now();
+    while(!reactor->m_deadlines.empty() && reactor->m_deadlines.begin()->first <= now)
+    {
+        auto it = reactor->m_connections.find(reactor->m_deadlines.begin()->second);
+        if(it == reactor->m_connections.end())
+        {
+            reactor->m_deadlines.erase(reactor->m_deadlines.begin());
+            continue;
+        }
+        Connection* conn = it->second.get();
+        switch(conn->m_state)
+        {
+        case CONNECT_PENDING:
+        case HANDSHAKE_PENDING:
+            complete(reactor, conn, HM_REASON_CONNECT_TIMEOUT);
+            break;
+        case READ_PENDING:
+            complete(reactor, conn, HM_REASON_RESPONSE_TIMEOUT);
+            break;
+        case TICKET_PENDING:
+            closeConnection(reactor, conn);
+            break;
+        }
+    }
+}
+
+void
+HMConnectEngine::setDeadline(Reactor* reactor, Connection* conn, uint64_t timeout)
+{
+    if(conn->m_deadline != reactor->m_deadlines.end())
+    {
+        reactor->m_deadlines.erase(conn->m_deadline);
+    }
+    conn->m_deadline = reactor->m_deadlines.emplace(HMMonotonicTime::now() + timeout, conn->m_fd);
+}
+
+void
+HMConnectEngine::complete(Reactor* reactor, Connection* conn, HM_REASON reason)
+{
+    HMConnectRequest* request = conn->m_request;
+    bool waitTicket = (reason == HM_REASON_SUCCESS && conn->m_session != nullptr
+            && !conn->m_sessionStored && !storeSession(conn));
+    if(waitTicket && watch(reactor, conn, EPOLLIN))
+    {
+        // Hand the request back now, the connection lives on until the ticket comes in
+        conn->m_request = nullptr;
+        conn->m_state = TICKET_PENDING;
+        setDeadline(reactor, conn, HM_TLS_TICKET_WAIT);
+    }
+    else
+    {
+        closeConnection(reactor, conn);
+    }
+
+    request->m_reason = reason;
+    m_inFlight--;
+    if(request->m_callback)
+    {
+        request->m_callback(*request, request->m_arg);
+    }
+}
+
+void
+HMConnectEngine::closeConnection(Reactor* reactor, Connection* conn)
+{
+    int fd = conn->m_fd;
+    if(conn->m_deadline != reactor->m_deadlines.end())
+    {
+        reactor->m_deadlines.erase(conn->m_deadline);
+    }
+    if(conn->m_events)
+    {
+        epoll_ctl(reactor->m_epollFd, EPOLL_CTL_DEL, fd, nullptr);
+    }
+    if(conn->m_ssl != nullptr)
+    {
+        if(SSL_is_init_finished(conn->m_ssl))
+        {
+            // Freeing a connection without a shutdown marks its session as not resumable
+            SSL_shutdown(conn->m_ssl);
+        }
+        SSL_free(conn->m_ssl);
+        ERR_clear_error();
+    }
+    if(conn->m_session != nullptr)
+    {
+        SSL_SESSION_free(conn->m_session);
+    }
+    close(fd);
+    reactor->m_connections.erase(fd);
+}
+
+void
+HMConnectEngine::fail(HMConnectRequest* request, HM_REASON reason, const string& errorMsg)
+{
+    request->m_reason = reason;
+    request->m_errorMsg = errorMsg;
+    m_inFlight--;
+    if(request->m_callback)
+    {
+        request->m_callback(*request, request->m_arg);
+    }
+}
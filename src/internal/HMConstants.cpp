@@ -183,6 +183,46 @@ printWorkType(HM_WORK_TYPE work)
     }
 }
 
+string
+printWorkClass(HM_WORK_CLASS workClass)
+{
+    switch(workClass)
+    {
+    case HM_WORK_CLASS_CONTROL:
+        return "control";
+    case HM_WORK_CLASS_HIGH:
+        return "high";
+    case HM_WORK_CLASS_HEALTHCHECK:
+        return "healthcheck";
+    case HM_WORK_CLASS_LOW:
+        return "low";
+    case HM_WORK_CLASS_DNSLOOKUP:
+        return "dns";
+    case HM_WORK_CLASS_REMOTE:
+        return "remote";
+    case HM_WORK_CLASS_AUXFETCH:
+        return "aux";
+    default:
+        return "Invalid Work Class";
+    }
+}
+
+string
+printWorkPriority(HM_WORK_PRIORITY priority)
+{
+    switch(priority)
+    {
+    case HM_WORK_PRIORITY_NORMAL:
+        return "normal";
+    case HM_WORK_PRIORITY_HIGH:
+        return "high";
+    case HM_WORK_PRIORITY_LOW:
+        return "low";
+    default:
+        return "Invalid";
+    }
+}
+
 string
 printMeasurementOptions(uint16_t rtMode)
 {
@@ -18,12 +18,14 @@ map<string, HM_COMMAND_TASKS> commands =
     { HM_CMD_RELOAD, RELOAD },
     { HM_CMD_REFRESH, REFRESH },
     { HM_CMD_HOSTGROUP, HOSTGROUPINFO },
+    { HM_CMD_HOSTGROUPDELTA, HOSTGROUPDELTA },
     { HM_CMD_LOADFB, LOADFBINFO },
     { HM_CMD_LOADFBIP, LOADFBINFOIP },
     { HM_CMD_LOADFBHOST, LOADFBINFOHOST },
     { HM_CMD_THREADINFO, THREADINFO },
     { HM_CMD_WORKQUEUEINFO, WORKQUEUEINFO },
     { HM_CMD_SCHDQUEUEINFO, SCHDQUEUEINFO },
+    { HM_CMD_STOREINFO, STOREINFO },
     { HM_CMD_SETHOSTSTATUS, SETHOSTSTATUS },
     { HM_CMD_HOSTGROUPLIST, HOSTGROUPLIST },
     { HM_CMD_HOSTLIST, HOSTLIST },
@@ -69,14 +71,13 @@ map<string, HM_COMMAND_TASKS> commands =
 
 HMCommandListenerBase::HMCommandListenerBase(HMStateManager &stateManager) :
         m_stateManager(stateManager),
-        m_keepRunning(false) {}
+        m_keepRunning(false),
+        m_connections(0) {}
 
 void
 HMCommandListenerBase::init()
 {
-    if (pipe(m_pipesfd) < 0) {
-        throwException("Failed to create pipe, error desc: ");
-    }
+    // The sockets are polled by the control reactor of the state manager
 }
 
 HM_COMMAND_TASKS
@@ -198,6 +199,37 @@ HMCommandListenerBase::handleCommands(string& command, HMSocketUtilBase& socketB
             HMLog(HM_LOG_DEBUG, "Missing HostGroup name for command:%s", HM_CMD_HOSTGROUP.c_str());
         }
         break;
+    case HOSTGROUPDELTA:
+        if(cmd_args.size() > 4)
+        {
+            uint64_t epoch;
+            uint64_t sequence;
+            uint32_t size;
+            if(!socketBase.strtoull(cmd_args[2], epoch)
+                    || !socketBase.strtoull(cmd_args[3], sequence)
+                    || !socketBase.strtoul(cmd_args[4], size))
+            {
+                result = false;
+                break;
+            }
+            HMHash hash;
+            unique_ptr<char[]> data = make_unique<char[]>(size);
+            if (socketBase.receiveMessage(data.get(), size) != HM_SOCK_DATA_OK
+                    || !dataPacking->unpackHash(data, size, hash))
+            {
+                HMLog(HM_LOG_DEBUG, "Failed to receive Hash payload for command:%s",
+                        HM_CMD_HOSTGROUPDELTA.c_str());
+                socketBase.sendMessage(nullptr, 0);
+                break;
+            }
+            returnResult = createHostGroupDelta(dataPacking, cmd_args[1], epoch, sequence, buflen, hash);
+            socketBase.sendMessage(returnResult.get(), buflen);
+        }
+        else
+        {
+            HMLog(HM_LOG_DEBUG, "Missing HostGroup name, sequence or hash for command:%s", HM_CMD_HOSTGROUPDELTA.c_str());
+        }
+        break;
     case LOADFBINFO:
         if(cmd_args.size() > 1)
         {
@@ -240,20 +272,33 @@ HMCommandListenerBase::handleCommands(string& command, HMSocketUtilBase& socketB
         }
         break;
     case THREADINFO:
+    {
         HMAPIThreadInfo info;
-        info.m_numIdleThreads = m_stateManager.getIdleThreads();
-        info.m_numThreads = m_stateManager.getNThreads();
+        m_stateManager.getThreadInfo(info);
         returnResult = dataPacking->packThreadInfo(info, buflen);
         socketBase.sendMessage(returnResult.get(), buflen);
         break;
+    }
     case WORKQUEUEINFO:
-        returnResult = dataPacking->packUInt(m_stateManager.m_workQueue.queueSize(), buflen);
+    {
+        HMAPIWorkQueueInfo info;
+        m_stateManager.m_workQueue.getWorkQueueInfo(info);
+        returnResult = dataPacking->packWorkQueueInfo(info, buflen);
         socketBase.sendMessage(returnResult.get(), buflen);
         break;
+    }
     case SCHDQUEUEINFO:
         returnResult = dataPacking->packUInt(m_stateManager.getEventQueueSize(), buflen);
         socketBase.sendMessage(returnResult.get(), buflen);
         break;
+    case STOREINFO:
+    {
+        HMAPIStoreInfo info;
+        m_stateManager.getStoreInfo(info);
+        returnResult = dataPacking->packStoreInfo(info, buflen);
+        socketBase.sendMessage(returnResult.get(), buflen);
+        break;
+    }
     case SETHOSTSTATUS:
         if(cmd_args.size() > 3)
         {
@@ -1046,11 +1091,6 @@ HMCommandListenerBase::shutDown()
 {
     m_keepRunning = false;
     listernerShutDown();
-    for(auto it = m_handlerThreads.begin(); it != m_handlerThreads.end(); ++it)
-    {
-        it->join();
-    }
-    m_handlerThreads.clear();
 }
 
 //LCOV_EXCL_START; can't be tested
@@ -1110,7 +1150,7 @@ HMCommandListenerBase::getHostSchdInfo(unique_ptr<HMDataPacking>& dataPacking, c
                 v4Result->second.getResultTime().getTimeSinceEpoch();
         dns.m_v4State = HM_API_WORK_STATE(v4Result->second.getQueryState());
         dns.m_v4NextCheckTime =
-                v4Result->second.nextQueryTime().getTimeSinceEpoch();
+                v4Result->second.nextQueryTime().toWallClock().getTimeSinceEpoch();
     }
     if ((check.getDualStack() & HM_DUALSTACK_IPV6_ONLY)
             && current->m_dnsCache.getDNSResult(host, dnsCheckV6, v6Result))
@@ -1120,7 +1160,7 @@ HMCommandListenerBase::getHostSchdInfo(unique_ptr<HMDataPacking>& dataPacking, c
                 v6Result->second.getResultTime().getTimeSinceEpoch();
         dns.m_v6State = HM_API_WORK_STATE(v6Result->second.getQueryState());
         dns.m_v6NextCheckTime =
-                v6Result->second.nextQueryTime().getTimeSinceEpoch();
+                v6Result->second.nextQueryTime().toWallClock().getTimeSinceEpoch();
     }
     set<HMIPAddress> addresses;
     if (current->m_dnsCache.getAddresses(host, check.getDualStack(), dnsCheck, addresses))
@@ -1135,7 +1175,7 @@ HMCommandListenerBase::getHostSchdInfo(unique_ptr<HMDataPacking>& dataPacking, c
             hc.m_lastCheckTime = hcResult.m_checkTime.getTimeSinceEpoch();
             hc.m_state = HM_API_WORK_STATE(hcResult.m_queryState);
             hc.m_nextCheckTime = current->m_checkList.nextCheckTime(host, ip,
-                    check).getTimeSinceEpoch();
+                    check).toWallClock().getTimeSinceEpoch();
             hc.m_address.m_type = ip.getType();
             if (hc.m_address.m_type == AF_INET)
             {
@@ -1171,7 +1211,7 @@ HMCommandListenerBase::getRemoteSchdInfo(unique_ptr<HMDataPacking>& dataPacking,
     }
     schdinfo.m_lastCheckTime = result->second.getResultTime().getTimeSinceEpoch();
     schdinfo.m_state = HM_API_WORK_STATE(result->second.getCheckState());
-    schdinfo.m_nextCheckTime = result->second.nextCheckTime().getTimeSinceEpoch();
+    schdinfo.m_nextCheckTime = result->second.nextCheckTime().toWallClock().getTimeSinceEpoch();
     return dataPacking->packRemoteHostGroupSchedInfo(schdinfo, buflen);
 }
 
@@ -1198,7 +1238,7 @@ HMCommandListenerBase::getRemoteSchdInfo(unique_ptr<HMDataPacking>& dataPacking,
     }
     schdinfo.m_lastCheckTime = result->second.getResultTime().getTimeSinceEpoch();
     schdinfo.m_state = HM_API_WORK_STATE(result->second.getCheckState());
-    schdinfo.m_nextCheckTime = result->second.nextCheckTime().getTimeSinceEpoch();
+    schdinfo.m_nextCheckTime = result->second.nextCheckTime().toWallClock().getTimeSinceEpoch();
     return dataPacking->packRemoteHostGroupSchedInfo(schdinfo, buflen);
 }
 
@@ -1230,6 +1270,28 @@ HMCommandListenerBase::createHostGroup(unique_ptr<HMDataPacking>& dataPacking, s
     return dataPacking->packHostGroupInfo(group, results, buflen);
 }
 
+unique_ptr<char[]>
+HMCommandListenerBase::createHostGroupDelta(unique_ptr<HMDataPacking>& dataPacking, const string& hostGroupName,
+        uint64_t epoch, uint64_t sequence, uint64_t& buflen, const HMHash& hash)
+{
+    buflen = 0;
+    HMDataHostGroup group(hostGroupName);
+    if(!getHostGroupInfo(hostGroupName, group))
+    {
+        return nullptr;
+    }
+    if(hash != group.getHashValue())
+    {
+        return nullptr;
+    }
+    shared_ptr<HMState> current;
+    m_stateManager.updateState(current);
+    vector<HMGroupCheckResult> results;
+    bool delta = current->m_datastore->getGroupCheckDelta(hostGroupName, epoch, sequence, results);
+    HMLog(HM_LOG_DEBUG3, "Sending %s of %lu results for %s at sequence %lu",
+            delta ? "delta" : "resync", results.size(), hostGroupName.c_str(), sequence);
+    return dataPacking->packHostGroupDelta(epoch, sequence, !delta, results, buflen);
+}
 
 unique_ptr<char[]>
 HMCommandListenerBase::getloadfbdata (unique_ptr<HMDataPacking>& dataPacking, string& rotationName, uint64_t& buflen, bool verifyHash, const HMHash& hash)
@@ -1427,8 +1489,8 @@ HMCommandListenerBase::getHostResults(unique_ptr<HMDataPacking>& dataPacking, co
 unique_ptr<char[]>
 HMCommandListenerBase::getConnectionHandlerCount(unique_ptr<HMDataPacking>& dataPacking, uint64_t& dataSize)
 {
-    shared_lock<shared_timed_mutex> lg(m_handlerMutex);
-    return dataPacking->packUInt(m_handlerThreads.size(), dataSize);
+    uint64_t connections = m_connections;
+    return dataPacking->packUInt(connections, dataSize);
 }
 
 bool
@@ -1542,25 +1604,6 @@ HMCommandListenerBase::getHostMark(unique_ptr<HMDataPacking>& dataPacking, uint6
     return data;
 }
 
-void
-HMCommandListenerBase::cleanHandlerThreads()
-{
-    lock_guard<shared_timed_mutex> lg(m_handlerMutex);
-    for(auto it = m_handlerThreads.begin(); it != m_handlerThreads.end();)
-    {
-        map<thread::id, bool>::iterator its = m_handlerThreadsStatus.find(it->get_id());
-        if(its != m_handlerThreadsStatus.end() && its->second == true)
-        {
-            it->join();
-            it = m_handlerThreads.erase(it);
-            m_handlerThreadsStatus.erase(its);
-        }
-        else
-        {
-            ++it;
-        }
-    }
-}
 
 bool
 HMCommandListenerBase::isValidCommand(const string& strCommand)
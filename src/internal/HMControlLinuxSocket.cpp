@@ -6,12 +6,11 @@
 #include <sys/socket.h>
 #include <sys/un.h>
 #include <unistd.h>
-#include <future>
 
 #include "HMControlLinuxSocket.h"
 #include "HMLogBase.h"
 #include "HMStateManager.h"
-#include "HMSocketUtilLinux.h"
+#include "HMControlReactor.h"
 
 using namespace std;
 
@@ -70,9 +69,7 @@ HMControlLinuxSocket::init()
 void
 HMControlLinuxSocket::run()
 {
-    // TODO: Move to a non blocking socket so that we can kill
-    // this thread
-    int rc = listen(m_socket, 10);
+    int rc = listen(m_socket, SOMAXCONN);
     if(rc == -1)
     {
         //LCOV_EXCL_START
@@ -81,120 +78,31 @@ HMControlLinuxSocket::run()
         throw system_error(ec, strBuf);
         //LCOV_EXCL_STOP
     }
-    m_mainThread = thread(&HMControlLinuxSocket::handleConnections,this);
-}
-
-void
-HMControlLinuxSocket::listernerShutDown()
-{
-    if(m_socket != -1)
-    {
-        close(m_socket);
-    }
-    if(write(m_pipesfd[1], "test",5) < 0)
+    m_keepRunning = true;
+    HMControlReactor* reactor = m_stateManager.getControlReactor();
+    if(reactor == nullptr || !reactor->addListener(m_socket, HM_CONTROL_SOCKET_LINUX, this))
     {
-        HMLog(HM_LOG_ERROR, "[CORE] failed writing to shutdown listener"); //LCOV_EXCL_LINE
+        //LCOV_EXCL_START
+        throwException("Failed to add socket " + m_socketPath + " to the control reactor, error desc: ");
+        //LCOV_EXCL_STOP
     }
-    m_mainThread.join();
-    unlinkSocket(m_socketPath);
 }
 
 void
-HMControlLinuxSocket::handleClient(int clientSock)
+HMControlLinuxSocket::listernerShutDown()
 {
-    if(clientSock == -1)
+    HMControlReactor* reactor = m_stateManager.getControlReactor();
+    if(reactor != nullptr)
     {
-        //LCOV_EXCL_START
-        string strBuf = "Failed to accept on socket, error desc: ";
-        error_code ec(errno, generic_category());
-        throw system_error(ec, strBuf);
-        //LCOV_EXCL_STOP
+        reactor->removeListener(m_socket);
     }
-    HMSocketUtilLinux utilLinux(clientSock, m_socketPath);
-    bool keepOpen = false;
-    bool done = false;
-    do
-    {
-        done = false;
-        struct timeval timeToWait;
-        timeToWait.tv_sec = 3;
-        timeToWait.tv_usec = 0;
-        string command;
-        HM_SOCK_DATA_STATUS status = utilLinux.receiveCommand(command, timeToWait);
-        switch(status)
-        {
-        case HM_SOCK_DATA_EMPTY:
-        case HM_SOCK_DATA_FAILED:
-            keepOpen = false;
-            done = true;
-            break;
-        case HM_SOCK_DATA_TIMEOUT:
-            done = true;
-            break;
-        case HM_SOCK_DATA_OK:
-            HMLog(HM_LOG_DEBUG, "[UNIXSERVER] NetCHASM daemon socket received command = %s",
-                    command.c_str());
-
-            if (command == "quit")
-            {
-                done = true;
-                keepOpen = false;
-            }
-            else if (command == HM_CMD_KEEPOPENSTR)
-            {
-                keepOpen = true;
-            }
-            else
-            {
-                handleCommands(command, utilLinux);
-            }
-        }
-    } while (m_keepRunning && (keepOpen || !done));
-    utilLinux.closeSocket();
-    lock_guard<shared_timed_mutex> lg(m_handlerMutex);
-    m_handlerThreadsStatus[this_thread::get_id()] = true;
-    return;
-}
-
-void HMControlLinuxSocket::handleConnections()
-{
-    struct sockaddr_un clientAddr;
-    socklen_t len = sizeof(clientAddr);
-    m_keepRunning = true;
-    fd_set fds;
-    while (m_keepRunning)
+    if(m_socket != -1)
     {
-        FD_ZERO (&fds);
-        FD_SET(m_socket, &fds);
-        FD_SET(m_pipesfd[0], &fds);
-        int max = m_socket>m_pipesfd[1]?m_socket:m_pipesfd[0];
-        int res = select(max + 1, &fds, NULL, NULL, NULL);
-        if(res < 0)
-        {
-            //LCOV_EXCL_START
-            HMLog(HM_LOG_ERROR, "[CORE] HMCommandListener::Select Failed linux Socket");
-            //LCOV_EXCL_STOP
-        }
-        if(FD_ISSET(m_socket, &fds))
-        {
-            int clientSock = accept(m_socket, (struct sockaddr *) &clientAddr, &len);
-            if(clientSock > 0)
-            {
-                cleanHandlerThreads();
-                lock_guard<shared_timed_mutex> lg(m_handlerMutex);
-                m_handlerThreads.push_back(
-                        thread(&HMControlLinuxSocket::handleClient, this,
-                               clientSock));
-                HMLog(HM_LOG_DEBUG, "[CORE] HMCommandListener::run accept on client sock = %d", clientSock);
-            }
-        }
-        if(FD_ISSET(m_pipesfd[0], &fds))
-        {
-            close(m_pipesfd[0]);
-            close(m_pipesfd[1]);
-            HMLog(HM_LOG_INFO, "[CORE] Shutting down listener");
-        }
+        close(m_socket);
+        m_socket = -1;
     }
+    HMLog(HM_LOG_INFO, "[CORE] Shutting down listener");
+    unlinkSocket(m_socketPath);
 }
 
 void
@@ -0,0 +1,769 @@
+// Copyright 2019, Oath Inc.
+// Licensed under the terms of the Apache 2.0 license. See LICENSE file in the root of the distribution for licensing details.
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/ioctl.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <signal.h>
+#include <system_error>
+#include <openssl/err.h>
+
+#include "HMControlReactor.h"
+#include "HMControlBase.h"
+#include "HMDataPacking.h"
+#include "HMStateManager.h"
+#include "HMState.h"
+#include "HMLogBase.h"
+
+using namespace std;
+
+//! The max number of epoll events to process per wakeup.
+#define HM_CONTROL_REACTOR_MAX_EVENTS 256
+//! The time in ms between the checks of the handshake and idle timeouts.
+#define HM_CONTROL_REACTOR_TICK 500
+//! The size of the buffer used to read from the stream sockets.
+#define HM_CONTROL_READ_SIZE 16384
+//! The max size of a packet sent on the Linux SOCK_SEQPACKET sockets.
+#define HM_CONTROL_MAX_PACKET 65535
+
+static string
+controlReactorError(const string& msg)
+{
+    error_code ec(errno, generic_category());
+    return msg + " " + ec.message();
+}
+
+HMControlReactor::Connection::~Connection()
+{
+    closeSocket();
+}
+
+void
+HMControlReactor::Connection::closeSocket()
+{
+    if(m_ssl != nullptr)
+    {
+        SSL_free(m_ssl);
+        m_ssl = nullptr;
+    }
+    if(m_fd != -1)
+    {
+        close(m_fd);
+        m_fd = -1;
+        m_socket = -1;
+    }
+    m_connected = false;
+}
+
+void
+HMControlReactor::Connection::reconnect()
+{
+    // Server side connections can't be reopened
+}
+
+bool
+HMControlReactor::Connection::sendData(const char* buffer, uint64_t size)
+{
+    if(size == 0)
+    {
+        return true;
+    }
+    {
+        lock_guard<mutex> lk(m_bufferMutex);
+        if(m_peerClosed)
+        {
+            return false;
+        }
+        if(m_seqPacket)
+        {
+            // Keep the packet boundaries the Linux clients read
+            for(uint64_t offset = 0; offset < size; offset += HM_CONTROL_MAX_PACKET)
+            {
+                uint64_t chunk = (size - offset < HM_CONTROL_MAX_PACKET) ? size - offset : HM_CONTROL_MAX_PACKET;
+                m_out.emplace_back(buffer + offset, chunk);
+            }
+        }
+        else
+        {
+            m_out.emplace_back(buffer, size);
+        }
+    }
+    m_reactor->notify(this, false);
+    return true;
+}
+
+HM_SOCK_DATA_STATUS
+HMControlReactor::Connection::recvData(char* data, uint64_t size, timeval tv)
+{
+    unique_lock<mutex> lk(m_bufferMutex);
+    auto expiry = chrono::steady_clock::now() + chrono::seconds(tv.tv_sec) + chrono::microseconds(tv.tv_usec);
+    if(!m_bufferCond.wait_until(lk, expiry, [this, size](){return m_in.size() >= size || m_peerClosed;}))
+    {
+        m_reason = HM_REASON_RESPONSE_TIMEOUT;
+        return HM_SOCK_DATA_TIMEOUT;
+    }
+    if(m_in.size() < size)
+    {
+        return HM_SOCK_DATA_FAILED;
+    }
+    memcpy(data, m_in.data(), size);
+    m_in.erase(0, size);
+    m_reason = HM_REASON_SUCCESS;
+    return HM_SOCK_DATA_OK;
+}
+
+HMControlReactor::~HMControlReactor()
+{
+    shutDown();
+}
+
+bool
+HMControlReactor::start()
+{
+    if(m_keepRunning)
+    {
+        return true;
+    }
+    m_epollFd = epoll_create1(EPOLL_CLOEXEC);
+    m_wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if(m_epollFd < 0 || m_wakeFd < 0)
+    {
+        HMLog(HM_LOG_CRITICAL, "[CONTROL] %s", controlReactorError("Failed to create the control reactor").c_str());
+        shutDown();
+        return false;
+    }
+    epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.fd = m_wakeFd;
+    epoll_ctl(m_epollFd, EPOLL_CTL_ADD, m_wakeFd, &ev);
+
+    m_keepRunning = true;
+    m_thread = thread(&HMControlReactor::run, this);
+    for(uint32_t i = 0; i < m_nExecutors; i++)
+    {
+        m_executors.push_back(thread(&HMControlReactor::runExecutor, this));
+    }
+    HMLog(HM_LOG_NOTICE, "[CONTROL] Started control reactor with %u executor threads", m_nExecutors);
+    return true;
+}
+
+void
+HMControlReactor::shutDown()
+{
+    m_keepRunning = false;
+    if(m_thread.joinable())
+    {
+        uint64_t val = 1;
+        if(write(m_wakeFd, &val, sizeof(val)) < 0)
+        {
+            HMLog(HM_LOG_DEBUG, "[CONTROL] Failed to wake control reactor thread");
+        }
+        m_thread.join();
+    }
+
+    // Release the commands waiting for more data so the executors can finish
+    for(auto& it : m_connections)
+    {
+        lock_guard<mutex> lk(it.second->m_bufferMutex);
+        it.second->m_peerClosed = true;
+        it.second->m_bufferCond.notify_all();
+    }
+    {
+        lock_guard<mutex> lk(m_taskMutex);
+        m_tasks.clear();
+    }
+    m_taskCond.notify_all();
+    for(auto& executor : m_executors)
+    {
+        executor.join();
+    }
+    m_executors.clear();
+
+    for(auto& it : m_connections)
+    {
+        it.second->m_listener->m_connections--;
+    }
+    m_connections.clear();
+    m_nConnections = 0;
+    m_notified.clear();
+    {
+        lock_guard<mutex> lk(m_listenerMutex);
+        m_listeners.clear();
+    }
+    if(m_wakeFd >= 0)
+    {
+        close(m_wakeFd);
+        m_wakeFd = -1;
+    }
+    if(m_epollFd >= 0)
+    {
+        close(m_epollFd);
+        m_epollFd = -1;
+    }
+}
+
+bool
+HMControlReactor::addListener(int sock, HM_CONTROL_SOCKET type, HMCommandListenerBase* listener)
+{
+    if(m_epollFd < 0 || sock < 0)
+    {
+        return false;
+    }
+    int flags = fcntl(sock, F_GETFL, 0);
+    if(flags < 0 || fcntl(sock, F_SETFL, flags | O_NONBLOCK) < 0)
+    {
+        HMLog(HM_LOG_ERROR, "[CONTROL] %s", controlReactorError("Failed to set the listening socket non blocking").c_str());
+        return false;
+    }
+    {
+        lock_guard<mutex> lk(m_listenerMutex);
+        m_listeners.emplace(sock, Listener(type, listener));
+    }
+    epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.fd = sock;
+    if(epoll_ctl(m_epollFd, EPOLL_CTL_ADD, sock, &ev) < 0)
+    {
+        HMLog(HM_LOG_ERROR, "[CONTROL] %s", controlReactorError("Failed to add the listening socket").c_str());
+        lock_guard<mutex> lk(m_listenerMutex);
+        m_listeners.erase(sock);
+        return false;
+    }
+    return true;
+}
+
+void
+HMControlReactor::removeListener(int sock)
+{
+    if(m_epollFd >= 0)
+    {
+        epoll_ctl(m_epollFd, EPOLL_CTL_DEL, sock, nullptr);
+    }
+    lock_guard<mutex> lk(m_listenerMutex);
+    m_listeners.erase(sock);
+}
+
+uint32_t
+HMControlReactor::getConnections() const
+{
+    return m_nConnections;
+}
+
+void
+HMControlReactor::run()
+{
+    signal(SIGPIPE, SIG_IGN);
+    vector<epoll_event> events(HM_CONTROL_REACTOR_MAX_EVENTS);
+    vector<pair<Connection*, bool>> notified;
+
+    while(m_keepRunning)
+    {
+        int nEvents = epoll_wait(m_epollFd, events.data(), events.size(), HM_CONTROL_REACTOR_TICK);
+        if(nEvents < 0 && errno != EINTR)
+        {
+            HMLog(HM_LOG_ERROR, "[CONTROL] %s", controlReactorError("epoll_wait failed").c_str());
+        }
+
+        for(int i = 0; i < nEvents; i++)
+        {
+            int fd = events[i].data.fd;
+            if(fd == m_wakeFd)
+            {
+                uint64_t val;
+                while(read(m_wakeFd, &val, sizeof(val)) > 0);
+                continue;
+            }
+            bool isListener = false;
+            Listener listener(HM_CONTROL_SOCKET_LINUX, nullptr);
+            {
+                lock_guard<mutex> lk(m_listenerMutex);
+                auto it = m_listeners.find(fd);
+                if(it != m_listeners.end())
+                {
+                    isListener = true;
+                    listener = it->second;
+                }
+            }
+            if(isListener)
+            {
+                acceptConnections(fd, listener);
+                continue;
+            }
+            // The connection may have been closed while processing an earlier event
+            auto it = m_connections.find(fd);
+            if(it != m_connections.end())
+            {
+                processConnection(it->second.get());
+            }
+        }
+
+        {
+            lock_guard<mutex> lk(m_notifyMutex);
+            notified.swap(m_notified);
+        }
+        // A connection is notified done only after all its flushes, so it is never used after being closed
+        for(auto& it : notified)
+        {
+            Connection* conn = it.first;
+            if(it.second)
+            {
+                conn->m_executing = false;
+                conn->m_expiry = HMTimeStamp::now() + HM_CONTROL_IDLE_TIMEOUT;
+            }
+            flushConnection(conn);
+            if(!conn->m_executing && !conn->m_closing)
+            {
+                dispatchCommands(conn);
+            }
+            updateConnection(conn);
+        }
+        notified.clear();
+
+        processTimeouts();
+    }
+}
+
+void
+HMControlReactor::runExecutor()
+{
+    while(true)
+    {
+        Connection* conn = nullptr;
+        {
+            unique_lock<mutex> lk(m_taskMutex);
+            m_taskCond.wait(lk, [this](){return !m_keepRunning || !m_tasks.empty();});
+            if(!m_keepRunning)
+            {
+                return;
+            }
+            conn = m_tasks.front();
+            m_tasks.pop_front();
+        }
+        try
+        {
+            conn->m_listener->handleCommands(conn->m_command, *conn);
+        }
+        catch(exception& e)
+        {
+            HMLog(HM_LOG_ERROR, "[CONTROL] Failed to run command %s: %s", conn->m_command.c_str(), e.what());
+        }
+        notify(conn, true);
+    }
+}
+
+void
+HMControlReactor::acceptConnections(int sock, const Listener& listener)
+{
+    while(true)
+    {
+        int fd = accept4(sock, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if(fd < 0)
+        {
+            if(errno == EINTR)
+            {
+                continue;
+            }
+            if(errno != EAGAIN && errno != EWOULDBLOCK)
+            {
+                HMLog(HM_LOG_ERROR, "[CONTROL] %s", controlReactorError("Failed to accept on control socket").c_str());
+            }
+            return;
+        }
+        if(m_nConnections >= m_maxConnections)
+        {
+            HMLog(HM_LOG_ERROR, "[CONTROL] Too many control connections open (%u), closing new connection", m_maxConnections);
+            close(fd);
+            continue;
+        }
+
+        unique_ptr<Connection> conn = make_unique<Connection>(this, listener.m_listener, fd,
+                listener.m_type == HM_CONTROL_SOCKET_LINUX);
+        if(listener.m_type == HM_CONTROL_SOCKET_TLS_V4 || listener.m_type == HM_CONTROL_SOCKET_TLS_V6)
+        {
+            shared_ptr<HMState> current;
+            m_stateManager.updateState(current);
+            SSL_CTX* ctx = (current && current->m_ctx) ? current->m_ctx->getCtx() : nullptr;
+            uint64_t timeout = current ? current->getConnectionTimeout() : HM_CONTROL_IDLE_TIMEOUT;
+            current.reset();
+            conn->m_ssl = (ctx != nullptr) ? SSL_new(ctx) : nullptr;
+            if(conn->m_ssl == nullptr)
+            {
+                HMLog(HM_LOG_CRITICAL, "Failed to create ssl Instance, err: %s",
+                        ERR_error_string(ERR_get_error(), NULL));
+                continue;
+            }
+            SSL_set_fd(conn->m_ssl, fd);
+            SSL_set_accept_state(conn->m_ssl);
+            SSL_set_mode(conn->m_ssl, SSL_MODE_ENABLE_PARTIAL_WRITE | SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER);
+            conn->m_state = HM_CONTROL_CONN_HANDSHAKE;
+            conn->m_expiry = HMTimeStamp::now() + timeout;
+        }
+        else
+        {
+            conn->m_expiry = HMTimeStamp::now() + HM_CONTROL_IDLE_TIMEOUT;
+        }
+
+        HMLog(HM_LOG_DEBUG, "[CONTROL] Accepted control connection on client sock = %d", fd);
+        Connection* ret = conn.get();
+        m_connections[fd] = move(conn);
+        m_nConnections++;
+        listener.m_listener->m_connections++;
+        updateConnection(ret);
+    }
+}
+
+void
+HMControlReactor::processConnection(Connection* conn)
+{
+    conn->m_wantWrite = false;
+    if(conn->m_state == HM_CONTROL_CONN_HANDSHAKE)
+    {
+        if(!handshake(conn))
+        {
+            closeConnection(conn);
+            return;
+        }
+        if(conn->m_state == HM_CONTROL_CONN_HANDSHAKE)
+        {
+            updateConnection(conn);
+            return;
+        }
+    }
+    readConnection(conn);
+    flushConnection(conn);
+    if(!conn->m_executing && !conn->m_closing)
+    {
+        dispatchCommands(conn);
+    }
+    updateConnection(conn);
+}
+
+bool
+HMControlReactor::handshake(Connection* conn)
+{
+    int ret = SSL_do_handshake(conn->m_ssl);
+    if(ret == 1)
+    {
+        HMLog(HM_LOG_DEBUG, "[CONTROL] TLS handshake completed on client sock = %d", conn->m_fd);
+        conn->m_state = HM_CONTROL_CONN_OPEN;
+        conn->m_expiry = HMTimeStamp::now() + HM_CONTROL_IDLE_TIMEOUT;
+        return true;
+    }
+    int error = SSL_get_error(conn->m_ssl, ret);
+    switch(error)
+    {
+    case SSL_ERROR_WANT_READ:
+        return true;
+    case SSL_ERROR_WANT_WRITE:
+        conn->m_wantWrite = true;
+        return true;
+    default:
+        // Client side socket may be closed prematurely
+        if(error == SSL_ERROR_SYSCALL && (errno == 0 || errno == ECONNRESET || errno == EPIPE))
+        {
+            HMLog(HM_LOG_DEBUG, "Failed secure accept, socket may have been closed");
+        }
+        else
+        {
+            HMLog(HM_LOG_CRITICAL, "Failed secure accept, err code(%d), ssl err code(%d) err: %s",
+                    errno, error, ERR_error_string(ERR_get_error(), NULL));
+        }
+        ERR_clear_error();
+        return false;
+    }
+}
+
+void
+HMControlReactor::readConnection(Connection* conn)
+{
+    string data;
+    bool closed = false;
+    if(conn->m_ssl != nullptr)
+    {
+        char buf[HM_CONTROL_READ_SIZE];
+        while(true)
+        {
+            int n = SSL_read(conn->m_ssl, buf, sizeof(buf));
+            if(n > 0)
+            {
+                data.append(buf, n);
+                continue;
+            }
+            int error = SSL_get_error(conn->m_ssl, n);
+            if(error == SSL_ERROR_WANT_WRITE)
+            {
+                conn->m_wantWrite = true;
+            }
+            else if(error != SSL_ERROR_WANT_READ)
+            {
+                closed = true;
+                ERR_clear_error();
+            }
+            break;
+        }
+    }
+    else
+    {
+        vector<char> buf(HM_CONTROL_READ_SIZE);
+        while(true)
+        {
+            if(conn->m_seqPacket)
+            {
+                // A packet larger than the buffer would be truncated
+                int pending = 0;
+                if(ioctl(conn->m_fd, FIONREAD, &pending) == 0 && pending > (int)buf.size())
+                {
+                    buf.resize(pending);
+                }
+            }
+            ssize_t n = recv(conn->m_fd, buf.data(), buf.size(), 0);
+            if(n > 0)
+            {
+                data.append(buf.data(), n);
+                continue;
+            }
+            if(n < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if(n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK))
+            {
+                closed = true;
+            }
+            break;
+        }
+    }
+
+    if(data.empty() && !closed)
+    {
+        return;
+    }
+    if(!data.empty())
+    {
+        conn->m_expiry = HMTimeStamp::now() + HM_CONTROL_IDLE_TIMEOUT;
+    }
+    lock_guard<mutex> lk(conn->m_bufferMutex);
+    conn->m_in.append(data);
+    if(closed)
+    {
+        conn->m_peerClosed = true;
+        conn->m_out.clear();
+    }
+    conn->m_bufferCond.notify_all();
+}
+
+void
+HMControlReactor::flushConnection(Connection* conn)
+{
+    lock_guard<mutex> lk(conn->m_bufferMutex);
+    while(!conn->m_out.empty() && !conn->m_peerClosed)
+    {
+        const string& segment = conn->m_out.front();
+        const char* buf = segment.data() + conn->m_outOffset;
+        size_t len = segment.size() - conn->m_outOffset;
+        ssize_t n;
+        if(conn->m_ssl != nullptr)
+        {
+            n = SSL_write(conn->m_ssl, buf, len);
+            if(n <= 0)
+            {
+                int error = SSL_get_error(conn->m_ssl, n);
+                if(error == SSL_ERROR_WANT_WRITE)
+                {
+                    conn->m_wantWrite = true;
+                    return;
+                }
+                if(error == SSL_ERROR_WANT_READ)
+                {
+                    return;
+                }
+                HMLog(HM_LOG_ERROR, "Error writing data from SSL socket, error desc: %s",
+                        ERR_error_string(ERR_get_error(), NULL));
+                ERR_clear_error();
+                n = -1;
+            }
+        }
+        else
+        {
+            n = send(conn->m_fd, buf, len, MSG_NOSIGNAL);
+            if(n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR))
+            {
+                return;
+            }
+        }
+        if(n < 0)
+        {
+            HMLog(HM_LOG_DEBUG, "[CONTROL] Failed to send response on client sock = %d", conn->m_fd);
+            conn->m_peerClosed = true;
+            conn->m_out.clear();
+            conn->m_bufferCond.notify_all();
+            return;
+        }
+        conn->m_outOffset += n;
+        if(conn->m_outOffset == segment.size())
+        {
+            conn->m_out.pop_front();
+            conn->m_outOffset = 0;
+        }
+        conn->m_expiry = HMTimeStamp::now() + HM_CONTROL_IDLE_TIMEOUT;
+    }
+}
+
+void
+HMControlReactor::dispatchCommands(Connection* conn)
+{
+    if(conn->m_state != HM_CONTROL_CONN_OPEN)
+    {
+        return;
+    }
+    lock_guard<mutex> lk(conn->m_bufferMutex);
+    while(conn->m_in.size() >= sizeof(uint64_t))
+    {
+        uint64_t size;
+        memcpy(&size, conn->m_in.data(), sizeof(size));
+        size = HMDataPacking::ntoh64(size);
+        if(size == 0)
+        {
+            conn->m_closing = true;
+            return;
+        }
+        if(conn->m_in.size() - sizeof(uint64_t) < size)
+        {
+            return;
+        }
+        const char* data = conn->m_in.data() + sizeof(uint64_t);
+        string command(data, strnlen(data, size));
+        conn->m_in.erase(0, sizeof(uint64_t) + size);
+
+        HMLog(HM_LOG_DEBUG, "[CONTROL] NetCHASM daemon socket received command = %s", command.c_str());
+        if(command == "quit")
+        {
+            conn->m_closing = true;
+            return;
+        }
+        if(command == HM_CMD_KEEPOPENSTR)
+        {
+            conn->m_keepOpen = true;
+            continue;
+        }
+
+        conn->m_command = command;
+        conn->m_executing = true;
+        {
+            lock_guard<mutex> tlk(m_taskMutex);
+            m_tasks.push_back(conn);
+        }
+        m_taskCond.notify_one();
+        return;
+    }
+}
+
+void
+HMControlReactor::updateEvents(Connection* conn)
+{
+    if(conn->m_peerClosed || conn->m_closing)
+    {
+        // Nothing more to read or send, stop polling the socket until the command completes
+        if(conn->m_registered)
+        {
+            epoll_ctl(m_epollFd, EPOLL_CTL_DEL, conn->m_fd, nullptr);
+            conn->m_registered = false;
+        }
+        return;
+    }
+    uint32_t events = EPOLLIN;
+    bool pending;
+    {
+        lock_guard<mutex> lk(conn->m_bufferMutex);
+        pending = !conn->m_out.empty();
+    }
+    if(conn->m_wantWrite || pending)
+    {
+        events |= EPOLLOUT;
+    }
+    if(conn->m_registered && events == conn->m_events)
+    {
+        return;
+    }
+    epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = events;
+    ev.data.fd = conn->m_fd;
+    if(epoll_ctl(m_epollFd, conn->m_registered ? EPOLL_CTL_MOD : EPOLL_CTL_ADD, conn->m_fd, &ev) < 0)
+    {
+        HMLog(HM_LOG_ERROR, "[CONTROL] %s", controlReactorError("epoll_ctl").c_str());
+        return;
+    }
+    conn->m_registered = true;
+    conn->m_events = events;
+}
+
+void
+HMControlReactor::updateConnection(Connection* conn)
+{
+    if(!conn->m_executing && (conn->m_closing || conn->m_peerClosed))
+    {
+        closeConnection(conn);
+        return;
+    }
+    updateEvents(conn);
+}
+
+void
+HMControlReactor::processTimeouts()
+{
+    HMTimeStamp now = HMTimeStamp::now();
+    vector<Connection*> expired;
+    for(auto& it : m_connections)
+    {
+        Connection* conn = it.second.get();
+        if(conn->m_executing || (conn->m_keepOpen && conn->m_state == HM_CONTROL_CONN_OPEN))
+        {
+            continue;
+        }
+        if(conn->m_expiry < now)
+        {
+            expired.push_back(conn);
+        }
+    }
+    for(auto conn : expired)
+    {
+        HMLog(HM_LOG_DEBUG, "[CONTROL] %s timed out on client sock = %d",
+                (conn->m_state == HM_CONTROL_CONN_HANDSHAKE) ? "TLS handshake" : "Control connection", conn->m_fd);
+        closeConnection(conn);
+    }
+}
+
+void
+HMControlReactor::closeConnection(Connection* conn)
+{
+    if(conn->m_registered)
+    {
+        epoll_ctl(m_epollFd, EPOLL_CTL_DEL, conn->m_fd, nullptr);
+    }
+    HMLog(HM_LOG_DEBUG, "[CONTROL] Closing control connection on client sock = %d", conn->m_fd);
+    conn->m_listener->m_connections--;
+    m_nConnections--;
+    m_connections.erase(conn->m_fd);
+}
+
+void
+HMControlReactor::notify(Connection* conn, bool done)
+{
+    {
+        lock_guard<mutex> lk(m_notifyMutex);
+        m_notified.push_back(make_pair(conn, done));
+    }
+    uint64_t val = 1;
+    if(write(m_wakeFd, &val, sizeof(val)) < 0)
+    {
+        HMLog(HM_LOG_DEBUG, "[CONTROL] Failed to wake control reactor thread");
+    }
+}
@@ -6,13 +6,13 @@
 #include <sys/socket.h>
 #include <sys/un.h>
 #include <unistd.h>
-#include <future>
 #include <arpa/inet.h>
 #include <fcntl.h>
 #include <HMControlTCPSocket.h>
 #include <netinet/in.h>
 #include "HMLogBase.h"
 #include "HMStateManager.h"
+#include "HMControlReactor.h"
 
 using namespace std;
 
@@ -90,116 +90,29 @@ HMControlTCPSocket::init()
 void
 HMControlTCPSocket::run()
 {
-    m_mainThread = thread(&HMControlTCPSocket::handleConnections,this);
-}
-
-void
-HMControlTCPSocket::listernerShutDown()
-{
-    if(m_socket != -1)
-    {
-        close(m_socket);
-    }
-    if(write(m_pipesfd[1], "test",5) < 0)
+    m_keepRunning = true;
+    HMControlReactor* reactor = m_stateManager.getControlReactor();
+    HM_CONTROL_SOCKET type = m_ipv6 ? HM_CONTROL_SOCKET_TCP_V6 : HM_CONTROL_SOCKET_TCP_V4;
+    if(reactor == nullptr || !reactor->addListener(m_socket, type, this))
     {
-        HMLog(HM_LOG_ERROR, "[CORE] failed writing to shutdown listener"); //LCOV_EXCL_LINE
+        //LCOV_EXCL_START
+        throwException("Failed to add TCP socket to the control reactor, error desc: ");
+        //LCOV_EXCL_STOP
     }
-    m_mainThread.join();
 }
 
 void
-HMControlTCPSocket::handleClient(int clientSock)
+HMControlTCPSocket::listernerShutDown()
 {
-    if(clientSock == -1)
+    HMControlReactor* reactor = m_stateManager.getControlReactor();
+    if(reactor != nullptr)
     {
-        //LCOV_EXCL_START
-        string strBuf = "Failed to accept on socket, error desc: ";
-        error_code ec(errno, generic_category());
-        throw system_error(ec, strBuf);
-        //LCOV_EXCL_STOP
+        reactor->removeListener(m_socket);
     }
-    HMSocketUtilTCP utilTcp(clientSock);
-    bool keepOpen = false;
-    bool done;
-    do
-    {
-        done = false;
-        struct timeval timeToWait;
-        timeToWait.tv_sec = 3;
-        timeToWait.tv_usec = 0;
-        string command;
-        HM_SOCK_DATA_STATUS status = utilTcp.receiveCommand(command, timeToWait);
-        switch(status)
-        {
-        case HM_SOCK_DATA_EMPTY:
-        case HM_SOCK_DATA_FAILED:
-            keepOpen = false;
-            done = true;
-            break;
-        case HM_SOCK_DATA_TIMEOUT:
-            done = true;
-            break;
-        case HM_SOCK_DATA_OK:
-            HMLog(HM_LOG_DEBUG, "[TCPSERVER] NetCHASM daemon socket received command = %s",
-                    command.c_str());
-            if (command == "quit")
-            {
-                keepOpen = false;
-                done = true;
-            }
-            else if (command == HM_CMD_KEEPOPENSTR)
-            {
-                keepOpen = true;
-            }
-            else
-            {
-                handleCommands(command, utilTcp);
-            }
-        }
-    } while (m_keepRunning && (keepOpen || !done));
-    utilTcp.closeSocket();
-    lock_guard<shared_timed_mutex> lg(m_handlerMutex);
-    m_handlerThreadsStatus[this_thread::get_id()] = true;
-    return;
-}
-
-void HMControlTCPSocket::handleConnections()
-{
-    m_keepRunning = true;
-    fd_set fds;
-    while (m_keepRunning)
+    if(m_socket != -1)
     {
-        FD_ZERO (&fds);
-        FD_SET(m_socket, &fds);
-        FD_SET(m_pipesfd[0], &fds);
-        int max = m_socket>m_pipesfd[0]?m_socket:m_pipesfd[0];
-        timeval tv { 3, 0};
-        int res = select(max + 1, &fds, NULL, NULL, &tv);
-        if(res < 0)
-        {
-            //LCOV_EXCL_START
-            HMLog(HM_LOG_ERROR, "[CORE] HMCommandListener::Select Failed linux Socket");
-            //LCOV_EXCL_STOP
-        }
-        if(FD_ISSET(m_socket, &fds))
-        {
-            int clientSock = accept(m_socket, NULL, 0);
-            if(clientSock > 0)
-            {
-                cleanHandlerThreads();
-                lock_guard<shared_timed_mutex> lg(m_handlerMutex);
-                m_handlerThreads.push_back(
-                        thread(&HMControlTCPSocket::handleClient, this,
-                                clientSock));
-                HMLog(HM_LOG_DEBUG, "[CORE] HMCommandListener::run accept on client sock = %d", clientSock);
-            }
-        }
-        if(FD_ISSET(m_pipesfd[0], &fds))
-        {
-            close(m_pipesfd[1]);
-            close(m_pipesfd[0]);
-            HMLog(HM_LOG_INFO, "[CORE] Shutting down listener");
-        }
+        close(m_socket);
+        m_socket = -1;
     }
+    HMLog(HM_LOG_INFO, "[CORE] Shutting down listener");
 }
-
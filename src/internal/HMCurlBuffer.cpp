@@ -0,0 +1,155 @@
+// Copyright 2019, Oath Inc.
+// Licensed under the terms of the Apache 2.0 license. See LICENSE file in the root of the distribution for licensing details.
+#include "HMCurlBuffer.h"
+
+using namespace std;
+
+void
+HMCurlBuffer::setParams(uint64_t maxSize, bool keepBody, const string& expect)
+{
+    m_maxSize = maxSize;
+    m_keepBody = keepBody;
+    if(m_expect != expect)
+    {
+        m_expect = expect;
+        m_prefix.assign(m_expect.size(), 0);
+        uint32_t len = 0;
+        for(uint32_t i = 1; i < m_expect.size(); i++)
+        {
+            while(len > 0 && m_expect[i] != m_expect[len])
+            {
+                len = m_prefix[len - 1];
+            }
+            if(m_expect[i] == m_expect[len])
+            {
+                len++;
+            }
+            m_prefix[i] = len;
+        }
+    }
+    clear();
+}
+
+void
+HMCurlBuffer::clear()
+{
+    m_body.clear();
+    m_matchPos = 0;
+    m_received = 0;
+    m_found = false;
+    m_stopped = false;
+    m_overflow = false;
+}
+
+void
+HMCurlBuffer::attach(CURL* easy)
+{
+    m_easy = easy;
+    if(easy != nullptr)
+    {
+        curl_easy_setopt(easy, CURLOPT_WRITEFUNCTION, HMCurlBuffer::curlWrite);
+        curl_easy_setopt(easy, CURLOPT_WRITEDATA, this);
+    }
+}
+
+bool
+HMCurlBuffer::append(const char* buf, size_t length)
+{
+    m_received += length;
+    if(m_keepBody)
+    {
+        if(m_body.size() + length > m_maxSize)
+        {
+            m_overflow = true;
+            return false;
+        }
+        if(m_body.empty() && m_easy != nullptr)
+        {
+            // The headers are in by the first chunk, size the body once instead of growing it chunk by chunk
+            curl_off_t contentLength = -1;
+            if(curl_easy_getinfo(m_easy, CURLINFO_CONTENT_LENGTH_DOWNLOAD_T, &contentLength) == CURLE_OK
+                    && contentLength > 0)
+            {
+                m_body.reserve(((uint64_t)contentLength < m_maxSize) ? contentLength : m_maxSize);
+            }
+        }
+        m_body.append(buf, length);
+    }
+
+    if(m_expect.empty() || m_found)
+    {
+        return true;
+    }
+    for(size_t i = 0; i < length; i++)
+    {
+        while(m_matchPos > 0 && buf[i] != m_expect[m_matchPos])
+        {
+            m_matchPos = m_prefix[m_matchPos - 1];
+        }
+        if(buf[i] == m_expect[m_matchPos] && ++m_matchPos == m_expect.size())
+        {
+            m_found = true;
+            if(!m_keepBody)
+            {
+                // Nothing left to look at in the rest of the body
+                m_stopped = true;
+                return false;
+            }
+            return true;
+        }
+    }
+    if(!m_keepBody && m_received > m_maxSize)
+    {
+        m_overflow = true;
+        return false;
+    }
+    return true;
+}
+
+CURLcode
+HMCurlBuffer::getResult(CURLcode result) const
+{
+    if(m_stopped && result == CURLE_WRITE_ERROR)
+    {
+        return CURLE_OK;
+    }
+    if(m_overflow && result == CURLE_WRITE_ERROR)
+    {
+        return CURLE_FILESIZE_EXCEEDED;
+    }
+    return result;
+}
+
+bool
+HMCurlBuffer::isMatched() const
+{
+    return m_expect.empty() || m_found;
+}
+
+uint64_t
+HMCurlBuffer::getReceived() const
+{
+    return m_received;
+}
+
+const string&
+HMCurlBuffer::getBody() const
+{
+    return m_body;
+}
+
+void
+HMCurlBuffer::releaseBody(string& body)
+{
+    body.swap(m_body);
+    m_body.clear();
+}
+
+size_t
+HMCurlBuffer::curlWrite(void* ptr, size_t size, size_t nmemb, void* arg)
+{
+    HMCurlBuffer* buffer = (HMCurlBuffer*) arg;
+    size_t length = size * nmemb;
+    // Any count other than the length makes curl stop the transfer with CURLE_WRITE_ERROR
+    return buffer->append((const char*) ptr, length) ? length : 0;
+}
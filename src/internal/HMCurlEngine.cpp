@@ -0,0 +1,525 @@
+// Copyright 2019, Oath Inc.
+// Licensed under the terms of the Apache 2.0 license. See LICENSE file in the root of the distribution for licensing details.
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <netinet/in.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <signal.h>
+#include <functional>
+#include <system_error>
+
+#include "HMCurlEngine.h"
+#include "HMTLSIdentity.h"
+#include "HMLogBase.h"
+
+using namespace std;
+
+//! The max number of epoll events to process per wakeup.
+#define HM_CURL_ENGINE_MAX_EVENTS 1024
+
+static string
+curlEngineError(const string& msg)
+{
+    error_code ec(errno, generic_category());
+    return msg + " " + ec.message();
+}
+
+//! Get the scheme and authority of a URL so all the requests to a target land on the same thread.
+static string
+curlTarget(const HMCurlRequest& request)
+{
+    size_t start = request.m_url.find("//");
+    start = (start == string::npos) ? 0 : start + 2;
+    return request.m_url.substr(0, request.m_url.find('/', start)) + request.m_connectTo;
+}
+
+static int
+curlEngineSockopt(void* arg, curl_socket_t fd, curlsocktype purpose)
+{
+    (void)purpose;
+    int val = *(uint8_t*) arg;
+    setsockopt(fd, IPPROTO_IP, IP_TOS, (const char*) &val, sizeof(val));
+    return CURL_SOCKOPT_OK;
+}
+
+HMCurlEngine::~HMCurlEngine()
+{
+    shutDown();
+}
+
+bool
+HMCurlEngine::start()
+{
+    if(m_keepRunning)
+    {
+        return true;
+    }
+
+    m_share = curl_share_init();
+    if(m_share == nullptr)
+    {
+        HMLog(HM_LOG_CRITICAL, "[CURLENGINE] Failed to create the curl share");
+        return false;
+    }
+    curl_share_setopt(m_share, CURLSHOPT_LOCKFUNC, HMCurlEngine::lockCallback);
+    curl_share_setopt(m_share, CURLSHOPT_UNLOCKFUNC, HMCurlEngine::unlockCallback);
+    curl_share_setopt(m_share, CURLSHOPT_USERDATA, this);
+    curl_share_setopt(m_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+    curl_share_setopt(m_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+
+    m_keepRunning = true;
+    for(uint32_t i = 0; i < m_nThreads; i++)
+    {
+        unique_ptr<Reactor> reactor = make_unique<Reactor>();
+        reactor->m_epollFd = epoll_create1(EPOLL_CLOEXEC);
+        reactor->m_wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        reactor->m_multi = curl_multi_init();
+        if(reactor->m_epollFd < 0 || reactor->m_wakeFd < 0 || reactor->m_multi == nullptr)
+        {
+            HMLog(HM_LOG_CRITICAL, "[CURLENGINE] %s", curlEngineError("Failed to create the curl engine").c_str());
+            cleanupReactor(reactor.get());
+            shutDown();
+            return false;
+        }
+        curl_multi_setopt(reactor->m_multi, CURLMOPT_SOCKETFUNCTION, HMCurlEngine::socketCallback);
+        curl_multi_setopt(reactor->m_multi, CURLMOPT_SOCKETDATA, reactor.get());
+        curl_multi_setopt(reactor->m_multi, CURLMOPT_TIMERFUNCTION, HMCurlEngine::timerCallback);
+        curl_multi_setopt(reactor->m_multi, CURLMOPT_TIMERDATA, reactor.get());
+        curl_multi_setopt(reactor->m_multi, CURLMOPT_MAXCONNECTS, (long)m_maxConnects);
+
+        epoll_event ev;
+        memset(&ev, 0, sizeof(ev));
+        ev.events = EPOLLIN;
+        ev.data.fd = reactor->m_wakeFd;
+        epoll_ctl(reactor->m_epollFd, EPOLL_CTL_ADD, reactor->m_wakeFd, &ev);
+        reactor->m_thread = thread(&HMCurlEngine::run, this, reactor.get());
+        m_reactors.push_back(move(reactor));
+    }
+    HMLog(HM_LOG_NOTICE, "[CURLENGINE] Started curl engine with %u threads", m_nThreads);
+    return true;
+}
+
+void
+HMCurlEngine::shutDown()
+{
+    m_keepRunning = false;
+    for(auto& reactor : m_reactors)
+    {
+        uint64_t val = 1;
+        if(write(reactor->m_wakeFd, &val, sizeof(val)) < 0)
+        {
+            HMLog(HM_LOG_DEBUG, "[CURLENGINE] Failed to wake curl engine thread");
+        }
+    }
+    for(auto& reactor : m_reactors)
+    {
+        if(reactor->m_thread.joinable())
+        {
+            reactor->m_thread.join();
+        }
+        cleanupReactor(reactor.get());
+    }
+    m_reactors.clear();
+    if(m_share != nullptr)
+    {
+        curl_share_cleanup(m_share);
+        m_share = nullptr;
+    }
+}
+
+bool
+HMCurlEngine::submit(HMCurlRequest& request)
+{
+    if(!m_keepRunning || m_reactors.empty())
+    {
+        return false;
+    }
+    Reactor* reactor = m_reactors[hash<string>()(curlTarget(request)) % m_reactors.size()].get();
+    request.m_result = CURLE_OK;
+    request.m_responseCode = 0;
+    request.m_connectTime = 0;
+    request.m_reused = false;
+    request.m_body.clear();
+    m_inFlight++;
+    {
+        lock_guard<mutex> lk(reactor->m_submitMutex);
+        reactor->m_submitted.push_back(&request);
+    }
+    uint64_t val = 1;
+    if(write(reactor->m_wakeFd, &val, sizeof(val)) < 0)
+    {
+        HMLog(HM_LOG_DEBUG, "[CURLENGINE] Failed to wake curl engine thread");
+    }
+    return true;
+}
+
+uint64_t
+HMCurlEngine::getInFlight() const
+{
+    return m_inFlight;
+}
+
+uint64_t
+HMCurlEngine::getReused() const
+{
+    return m_reused;
+}
+
+uint32_t
+HMCurlEngine::getNThreads() const
+{
+    return m_nThreads;
+}
+
+void
+HMCurlEngine::run(Reactor* reactor)
+{
+    signal(SIGPIPE, SIG_IGN);
+    vector<epoll_event> events(HM_CURL_ENGINE_MAX_EVENTS);
+    vector<HMCurlRequest*> submitted;
+    int running = 0;
+
+    while(m_keepRunning)
+    {
+        int timeout = -1;
+        if(reactor->m_timerSet)
+        {
+            HMMonotonicTime now = HMMonotonicTime::now();
+            timeout = (reactor->m_timer <= now) ? 0 : (int)(reactor->m_timer - now);
+        }
+
+        int nEvents = epoll_wait(reactor->m_epollFd, events.data(), events.size(), timeout);
+        if(nEvents < 0 && errno != EINTR)
+        {
+            HMLog(HM_LOG_ERROR, "[CURLENGINE] %s", curlEngineError("epoll_wait failed").c_str());
+        }
+
+        for(int i = 0; i < nEvents; i++)
+        {
+            if(events[i].data.fd == reactor->m_wakeFd)
+            {
+                uint64_t val;
+                while(read(reactor->m_wakeFd, &val, sizeof(val)) > 0);
+                continue;
+            }
+            int action = 0;
+            if(events[i].events & EPOLLIN)
+            {
+                action |= CURL_CSELECT_IN;
+            }
+            if(events[i].events & EPOLLOUT)
+            {
+                action |= CURL_CSELECT_OUT;
+            }
+            if(events[i].events & (EPOLLERR | EPOLLHUP))
+            {
+                action |= CURL_CSELECT_ERR;
+            }
+            curl_multi_socket_action(reactor->m_multi, events[i].data.fd, action, &running);
+        }
+
+        if(reactor->m_timerSet && reactor->m_timer <= HMMonotonicTime::now())
+        {
+            reactor->m_timerSet = false;
+            curl_multi_socket_action(reactor->m_multi, CURL_SOCKET_TIMEOUT, 0, &running);
+        }
+
+        {
+            lock_guard<mutex> lk(reactor->m_submitMutex);
+            submitted.swap(reactor->m_submitted);
+        }
+        for(auto request : submitted)
+        {
+            startTransfer(reactor, request);
+        }
+        submitted.clear();
+
+        processCompleted(reactor);
+    }
+
+    // Hand back everything still pending so the owners can finish.
+    {
+        lock_guard<mutex> lk(reactor->m_submitMutex);
+        submitted.swap(reactor->m_submitted);
+    }
+    for(auto request : submitted)
+    {
+        fail(request, CURLE_ABORTED_BY_CALLBACK);
+    }
+    while(!reactor->m_transfers.empty())
+    {
+        complete(reactor, *reactor->m_transfers.begin(), CURLE_ABORTED_BY_CALLBACK);
+    }
+}
+
+void
+HMCurlEngine::startTransfer(Reactor* reactor, HMCurlRequest* request)
+{
+    CURL* easy = nullptr;
+    if(!reactor->m_idleHandles.empty())
+    {
+        easy = reactor->m_idleHandles.back();
+        reactor->m_idleHandles.pop_back();
+    }
+    else
+    {
+        easy = curl_easy_init();
+    }
+    if(easy == nullptr)
+    {
+        HMLog(HM_LOG_ERROR, "[CURLENGINE] Failed to initialize CURL");
+        fail(request, CURLE_FAILED_INIT);
+        return;
+    }
+
+    Transfer* transfer = new Transfer(easy, request);
+    reactor->m_transfers.insert(transfer);
+    for(auto& header : request->m_headers)
+    {
+        transfer->m_headers = curl_slist_append(transfer->m_headers, header.c_str());
+    }
+    if(!request->m_keepAlive)
+    {
+        transfer->m_headers = curl_slist_append(transfer->m_headers, "Connection: close");
+        curl_easy_setopt(easy, CURLOPT_FORBID_REUSE, 1L);
+    }
+
+    curl_easy_setopt(easy, CURLOPT_PRIVATE, transfer);
+    curl_easy_setopt(easy, CURLOPT_SHARE, m_share);
+    curl_easy_setopt(easy, CURLOPT_URL, request->m_url.c_str());
+    curl_easy_setopt(easy, CURLOPT_HTTPHEADER, transfer->m_headers);
+    curl_easy_setopt(easy, CURLOPT_CONNECTTIMEOUT_MS, (long)request->m_connectTimeout);
+    curl_easy_setopt(easy, CURLOPT_TIMEOUT_MS, (long)request->m_timeout);
+    curl_easy_setopt(easy, CURLOPT_SSL_VERIFYHOST, 0L);
+    curl_easy_setopt(easy, CURLOPT_NOSIGNAL, 1L);
+    curl_easy_setopt(easy, CURLOPT_TCP_NODELAY, 1L);
+    request->m_body.attach(easy);
+
+    if(!request->m_connectTo.empty())
+    {
+        transfer->m_connectTo = curl_slist_append(nullptr, request->m_connectTo.c_str());
+        curl_easy_setopt(easy, CURLOPT_CONNECT_TO, transfer->m_connectTo);
+    }
+    if(request->m_sourceAddress.isSet())
+    {
+        curl_easy_setopt(easy, CURLOPT_INTERFACE, request->m_sourceAddress.toString().c_str());
+    }
+    if(request->m_tos)
+    {
+        curl_easy_setopt(easy, CURLOPT_SOCKOPTFUNCTION, curlEngineSockopt);
+        curl_easy_setopt(easy, CURLOPT_SOCKOPTDATA, &request->m_tos);
+    }
+    if(!request->m_verifyPeer)
+    {
+        curl_easy_setopt(easy, CURLOPT_CAINFO, NULL);
+        curl_easy_setopt(easy, CURLOPT_SSL_VERIFYPEER, 0L);
+    }
+    else if(!request->m_caFile.empty())
+    {
+        curl_easy_setopt(easy, CURLOPT_CAINFO, request->m_caFile.c_str());
+    }
+    if(request->m_clientIdentity)
+    {
+        // The client certificate is not part of the curl connection and session matching, so a client
+        // certificate connection is never shared with the other checks to the same target.
+        transfer->m_clientIdentity = request->m_clientIdentity;
+        curl_easy_setopt(easy, CURLOPT_SSL_CTX_FUNCTION, HMTLSIdentity::curlSslCtxCallback);
+        curl_easy_setopt(easy, CURLOPT_SSL_CTX_DATA, transfer->m_clientIdentity.get());
+        curl_easy_setopt(easy, CURLOPT_SSL_SESSIONID_CACHE, 0L);
+        curl_easy_setopt(easy, CURLOPT_FRESH_CONNECT, 1L);
+        curl_easy_setopt(easy, CURLOPT_FORBID_REUSE, 1L);
+    }
+
+    request->m_start = HMMonotonicTime::now();
+    CURLMcode res = curl_multi_add_handle(reactor->m_multi, easy);
+    if(res != CURLM_OK)
+    {
+        HMLog(HM_LOG_ERROR, "[CURLENGINE] Failed to add the request for %s: %s",
+                request->m_url.c_str(), curl_multi_strerror(res));
+        curl_easy_cleanup(easy);
+        transfer->m_easy = nullptr;
+        request->m_body.attach(nullptr);
+        curl_slist_free_all(transfer->m_headers);
+        curl_slist_free_all(transfer->m_connectTo);
+        reactor->m_transfers.erase(transfer);
+        delete transfer;
+        fail(request, CURLE_FAILED_INIT);
+    }
+}
+
+void
+HMCurlEngine::processCompleted(Reactor* reactor)
+{
+    CURLMsg* msg;
+    int pending;
+    while((msg = curl_multi_info_read(reactor->m_multi, &pending)) != nullptr)
+    {
+        if(msg->msg != CURLMSG_DONE)
+        {
+            continue;
+        }
+        Transfer* transfer = nullptr;
+        curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE, (char**)&transfer);
+        complete(reactor, transfer, msg->data.result);
+    }
+}
+
+void
+HMCurlEngine::complete(Reactor* reactor, Transfer* transfer, CURLcode result)
+{
+    HMCurlRequest* request = transfer->m_request;
+    CURL* easy = transfer->m_easy;
+    request->m_end = HMMonotonicTime::now();
+    // A transfer stopped once the expected string was found is a success
+    result = request->m_body.getResult(result);
+    request->m_result = result;
+    request->m_body.attach(nullptr);
+
+    long connects = 0;
+    double connectTime = 0;
+    curl_easy_getinfo(easy, CURLINFO_RESPONSE_CODE, &request->m_responseCode);
+    curl_easy_getinfo(easy, CURLINFO_NUM_CONNECTS, &connects);
+    request->m_reused = (result == CURLE_OK && connects == 0);
+    if(request->m_reused)
+    {
+        // No connect to time on a reused connection, use the time to the first response byte instead
+        m_reused++;
+        curl_easy_getinfo(easy, CURLINFO_STARTTRANSFER_TIME, &connectTime);
+    }
+    else
+    {
+        curl_easy_getinfo(easy, CURLINFO_CONNECT_TIME, &connectTime);
+    }
+    request->m_connectTime = (uint64_t)(connectTime * 1000000);
+
+    curl_multi_remove_handle(reactor->m_multi, easy);
+    curl_slist_free_all(transfer->m_headers);
+    curl_slist_free_all(transfer->m_connectTo);
+    reactor->m_transfers.erase(transfer);
+    delete transfer;
+
+    if(m_keepRunning && reactor->m_idleHandles.size() < HM_CURL_ENGINE_MAX_IDLE_HANDLES)
+    {
+        // Reset keeps the handle allocations, the open connections stay with the multi handle.
+        curl_easy_reset(easy);
+        reactor->m_idleHandles.push_back(easy);
+    }
+    else
+    {
+        curl_easy_cleanup(easy);
+    }
+
+    m_inFlight--;
+    request->m_callback(*request, request->m_arg);
+}
+
+void
+HMCurlEngine::fail(HMCurlRequest* request, CURLcode result)
+{
+    request->m_start = HMMonotonicTime::now();
+    request->m_end = request->m_start;
+    request->m_result = result;
+    m_inFlight--;
+    request->m_callback(*request, request->m_arg);
+}
+
+void
+HMCurlEngine::cleanupReactor(Reactor* reactor)
+{
+    for(auto easy : reactor->m_idleHandles)
+    {
+        curl_easy_cleanup(easy);
+    }
+    reactor->m_idleHandles.clear();
+    if(reactor->m_multi != nullptr)
+    {
+        curl_multi_cleanup(reactor->m_multi);
+        reactor->m_multi = nullptr;
+    }
+    if(reactor->m_wakeFd >= 0)
+    {
+        close(reactor->m_wakeFd);
+        reactor->m_wakeFd = -1;
+    }
+    if(reactor->m_epollFd >= 0)
+    {
+        close(reactor->m_epollFd);
+        reactor->m_epollFd = -1;
+    }
+}
+
+int
+HMCurlEngine::socketCallback(CURL* easy, curl_socket_t fd, int what, void* arg, void* socketArg)
+{
+    (void)easy;
+    Reactor* reactor = (Reactor*) arg;
+    if(what == CURL_POLL_REMOVE)
+    {
+        epoll_ctl(reactor->m_epollFd, EPOLL_CTL_DEL, fd, nullptr);
+        curl_multi_assign(reactor->m_multi, fd, nullptr);
+        return 0;
+    }
+
+    epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.data.fd = fd;
+    if(what & CURL_POLL_IN)
+    {
+        ev.events |= EPOLLIN;
+    }
+    if(what & CURL_POLL_OUT)
+    {
+        ev.events |= EPOLLOUT;
+    }
+
+    // Tag the socket so we know if it is already in the epoll set
+    if(socketArg == nullptr)
+    {
+        if(epoll_ctl(reactor->m_epollFd, EPOLL_CTL_ADD, fd, &ev) < 0)
+        {
+            HMLog(HM_LOG_ERROR, "[CURLENGINE] %s", curlEngineError("epoll_ctl add failed").c_str());
+            return -1;
+        }
+        curl_multi_assign(reactor->m_multi, fd, reactor);
+    }
+    else if(epoll_ctl(reactor->m_epollFd, EPOLL_CTL_MOD, fd, &ev) < 0)
+    {
+        HMLog(HM_LOG_ERROR, "[CURLENGINE] %s", curlEngineError("epoll_ctl mod failed").c_str());
+        return -1;
+    }
+    return 0;
+}
+
+int
+HMCurlEngine::timerCallback(CURLM* multi, long timeout, void* arg)
+{
+    (void)multi;
+    Reactor* reactor = (Reactor*) arg;
+    reactor->m_timerSet = (timeout >= 0);
+    if(reactor->m_timerSet)
+    {
+        reactor->m_timer = HMMonotonicTime::now() + timeout;
+    }
+    return 0;
+}
+
+void
+HMCurlEngine::lockCallback(CURL* easy, curl_lock_data data, curl_lock_access access, void* arg)
+{
+    (void)easy;
+    (void)access;
+    HMCurlEngine* engine = (HMCurlEngine*) arg;
+    engine->m_shareMutex[data].lock();
+}
+
+void
+HMCurlEngine::unlockCallback(CURL* easy, curl_lock_data data, void* arg)
+{
+    (void)easy;
+    HMCurlEngine* engine = (HMCurlEngine*) arg;
+    engine->m_shareMutex[data].unlock();
+}
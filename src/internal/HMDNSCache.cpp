@@ -199,12 +199,12 @@ HMDNSCache::queryNeeded(const string& name, const HMDNSLookup& dnsHostCheck) con
     HM_SCHEDULE_STATE result = HM_SCHEDULE_EVENT;
     bool alreadyScheduled = true;
     bool isCheckTimeChanged = false;
-    HMTimeStamp nextCheck = HMTimeStamp::now() + HMTimeStamp::HOURINMS;
+    HMMonotonicTime nextCheck = HMMonotonicTime::now() + HMTimeStamp::HOURINMS;
     auto key = make_pair(name, dnsHostCheck);
     auto ret = m_cache.find(key);
     if(ret != m_cache.end())
     {
-        HMTimeStamp checkTime = ret->second.nextQueryTime();
+        HMMonotonicTime checkTime = ret->second.nextQueryTime();
         HM_WORK_STATE query_state = ret->second.getQueryState();
         if ((query_state == HM_CHECK_FAILED)
                 || (query_state == HM_CHECK_INACTIVE))
@@ -227,14 +227,14 @@ HMDNSCache::queryNeeded(const string& name, const HMDNSLookup& dnsHostCheck) con
     {
         result = HM_SCHEDULE_IGNORE;
     }
-    if (nextCheck <= HMTimeStamp::now())
+    if (nextCheck <= HMMonotonicTime::now())
     {
         result = HM_SCHEDULE_WORK;
     }
     return result;
 }
 
-HMTimeStamp
+HMMonotonicTime
 HMDNSCache::nextQueryTime(const string& name, const HMDNSLookup& dnsHostCheck) const
 {
     auto key = make_pair(name, dnsHostCheck);
@@ -244,7 +244,7 @@ HMDNSCache::nextQueryTime(const string& name, const HMDNSLookup& dnsHostCheck) c
         HMLog(HM_LOG_ERROR,
                         "Missing DNS entry in cache in function nextQueryTime for host %s - DNS check type %s",
                         name.c_str(), printDnsType(dnsHostCheck.getType()).c_str());
-        return HMTimeStamp::now() + HMTimeStamp::HOURINMS;
+        return HMMonotonicTime::now() + HMTimeStamp::HOURINMS;
     }
     return it->second.nextQueryTime();
 }
@@ -266,7 +266,7 @@ HMDNSCache::startDNSQuery(const string& name, HMDNSLookup& dnsHostCheck)
 }
 
 void
-HMDNSCache::queueDNSQuery(string name, HMDNSLookup& dnsHostCheck, HMWorkQueue& queue)
+HMDNSCache::queueDNSQuery(string name, HMDNSLookup& dnsHostCheck, HMWorkQueue& queue, HMEventLoop* eventLoop, bool control)
 {
     HMLog(HM_LOG_DEBUG, "[DEBUG] DNS Health Check QueueCheck for %s",
             name.c_str());
@@ -280,6 +280,15 @@ HMDNSCache::queueDNSQuery(string name, HMDNSLookup& dnsHostCheck, HMWorkQueue& q
                 name.c_str(), printDnsType(dnsHostCheck.getType()).c_str());
         return;
     }
+    shared_ptr<HMDestinationSlot> slot;
+    HMMonotonicTime retry;
+    if(eventLoop != nullptr && dnsHostCheck.getType() == HM_DNS_TYPE_LOOKUP
+            && !queue.getDestinationLimiter().acquireResolver(slot, retry))
+    {
+        HMLog(HM_LOG_DEBUG3, "[CORE] DNS lookup for %s held back by the resolver limits to %llu ms", name.c_str(), retry.getMilliseconds());
+        eventLoop->addDNSTimeout(name, dnsHostCheck, retry);
+        return;
+    }
     unique_ptr<HMWork> dnslookup;
     switch(dnsHostCheck.getType())
     {
@@ -327,8 +336,13 @@ HMDNSCache::queueDNSQuery(string name, HMDNSLookup& dnsHostCheck, HMWorkQueue& q
     {
         dnslookup->setReschedule(false);
     }
-    dnslookup->m_start = HMTimeStamp::now();
-    dnslookup->m_end = HMTimeStamp::now() + it->second.getDNSTTL();
+    dnslookup->m_start = HMMonotonicTime::now();
+    dnslookup->m_end = HMMonotonicTime::now() + it->second.getDNSTTL();
+    dnslookup->m_destinationSlot = slot;
+    if(control)
+    {
+        dnslookup->m_workClass = HM_WORK_CLASS_CONTROL;
+    }
     it->second.queueQuery();
     queue.insertWork(dnslookup);
 }
@@ -347,6 +361,13 @@ HMDNSCache::queueDNSLookups(HMWorkQueue& queue, HMEventLoop& eventLoop, bool res
         HM_SCHEDULE_STATE state = this->queryNeeded(it->first.first, it->first.second);
         if(state == HM_SCHEDULE_EVENT || state == HM_SCHEDULE_WORK)
         {
+            shared_ptr<HMDestinationSlot> slot;
+            HMMonotonicTime retry;
+            if(it->first.second.getType() == HM_DNS_TYPE_LOOKUP && !queue.getDestinationLimiter().acquireResolver(slot, retry))
+            {
+                eventLoop.addDNSTimeout(it->first.first, it->first.second, retry);
+                continue;
+            }
             // if there is no active query, then we add one
             switch (it->first.second.getType())
             {
@@ -391,14 +412,15 @@ HMDNSCache::queueDNSLookups(HMWorkQueue& queue, HMEventLoop& eventLoop, bool res
                     break;
                 }
             }
-            dnslookup->m_start = HMTimeStamp::now();
-            dnslookup->m_end = HMTimeStamp::now() + it->second.getDNSTTL();
+            dnslookup->m_start = HMMonotonicTime::now();
+            dnslookup->m_end = HMMonotonicTime::now() + it->second.getDNSTTL();
+            dnslookup->m_destinationSlot = slot;
             it->second.queueQuery();
             queue.insertWork(dnslookup);
         }
         else if(restart && (state == HM_SCHEDULE_IGNORE))
         {
-            HMTimeStamp checkTime = nextQueryTime(it->first.first, it->first.second);
+            HMMonotonicTime checkTime = nextQueryTime(it->first.first, it->first.second);
             eventLoop.addDNSTimeout(it->first.first, it->first.second, checkTime);
         }
     }
@@ -34,12 +34,12 @@ HMDNSResult::queueQuery()
     m_queryState = HM_CHECK_QUEUED;
 }
 
-HMTimeStamp
+HMMonotonicTime
 HMDNSResult::startQuery()
 {
     lock_guard<shared_timed_mutex> lock(m_resultLock);
     m_queryState = HM_CHECK_IN_PROGRESS;
-    m_queryTime = HMTimeStamp::now() + m_queryTimeout;
+    m_queryTime = HMMonotonicTime::now() + m_queryTimeout;
     return m_queryTime;
 }
 
@@ -49,28 +49,29 @@ HMDNSResult::finishQuery(bool success)
     lock_guard<shared_timed_mutex> lock(m_resultLock);
     m_queryState = success?HM_CHECK_INACTIVE:HM_CHECK_FAILED;
     m_resultTime = HMTimeStamp::now();
+    m_lastResult = HMMonotonicTime::now();
 }
 
 bool
 HMDNSResult::queryNeeded() const
 {
-    return (nextQueryTime() <= HMTimeStamp::now());
+    return (nextQueryTime() <= HMMonotonicTime::now());
 }
 
-HMTimeStamp
+HMMonotonicTime
 HMDNSResult::nextQueryTime() const
 {
     lock_guard<shared_timed_mutex> lock(m_resultLock);
-    HMTimeStamp now = HMTimeStamp::now();
+    HMMonotonicTime now = HMMonotonicTime::now();
     if(m_queryState == HM_CHECK_INACTIVE)
     {
-        if((m_resultTime + m_dnsTimeout) < now)
+        if((m_lastResult + m_dnsTimeout) < now)
         {
             return now;
         }
         else
         {
-            return m_resultTime + m_dnsTimeout;
+            return m_lastResult + m_dnsTimeout;
         }
     }
     else if(m_queryState == HM_CHECK_IN_PROGRESS)
@@ -86,7 +87,7 @@ HMDNSResult::nextQueryTime() const
     }
     else if(m_queryState == HM_CHECK_FAILED)
     {
-        return m_resultTime + m_dnsTimeout;
+        return m_lastResult + m_dnsTimeout;
     }
     // return something really high since the check is in progress
     return now + HMTimeStamp::HOURINMS;
@@ -157,5 +158,6 @@ void
 HMDNSResult::setResultTime(const HMTimeStamp& resultTime)
 {
     m_resultTime = resultTime;
+    m_lastResult = HMMonotonicTime::fromWallClock(resultTime);
 }
 
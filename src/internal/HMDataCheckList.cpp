@@ -6,39 +6,48 @@
 #include "HMResultPublisher.h"
 #include "HMDataCheckList.h"
 #include "HMAuxCache.h"
+#include "HMEventLoop.h"
 #include "HMStorage.h"
 #include "HMWork.h"
 #include "HMLogBase.h"
 #include "HMWorkHealthCheckCurl.h"
 #include "HMWorkQueue.h"
 #include "HMWorkHealthCheckTCP.h"
+#ifdef USE_ARES
 #include "HMWorkHealthCheckDNS.h"
+#endif
 #include "HMWorkHealthCheckNone.h"
 #include "HMWorkAuxFetchCurl.h"
 #include "HMWorkHealthCheckTCPS.h"
 #include "HMWorkHealthMultiWork.h"
 using namespace std;
 
+atomic<uint64_t> HMDataCheckList::m_lastListID(0);
+
 HM_SCHEDULE_STATE
 HMDataCheckList::checkNeeded(string& hostname, HMIPAddress& ip, HMDataHostCheck& hostCheck)
 {
-    if(ip.toString() == "0.0.0.0" || ip.toString() == "::")
+    return checkNeeded(getCheckID(hostname, hostCheck), ip);
+}
+
+HM_SCHEDULE_STATE
+HMDataCheckList::checkNeeded(uint32_t checkID, const HMIPAddress& ip)
+{
+    if(ip.isUnspecified() || checkID >= m_checkIndex.size())
     {
         return HM_SCHEDULE_IGNORE;
     }
     HM_SCHEDULE_STATE result = HM_SCHEDULE_EVENT;
     bool alreadyScheduled = true;
     bool isCheckTimeChanged = false;
-    HMTimeStamp nextCheck = HMTimeStamp::now() + HMTimeStamp::HOURINMS;
-    auto key = make_pair(hostname, hostCheck);
-    auto ret = m_checklist.equal_range(key);
-    for (auto it = ret.first; it != ret.second; ++it)
+    HMMonotonicTime nextCheck = HMMonotonicTime::now() + HMTimeStamp::HOURINMS;
+    for (auto it : m_checkIndex[checkID])
     {
         if(!it->second.isValidIP(ip))
         {
             return HM_SCHEDULE_IGNORE;
         }
-        HMTimeStamp checkTime = it->second.nextCheckTime(ip);
+        HMMonotonicTime checkTime = it->second.nextCheckTime(ip);
         HM_WORK_STATE query_state = it->second.getQueryState(ip);
         if((query_state == HM_CHECK_FAILED) || (query_state == HM_CHECK_INACTIVE))
         {
@@ -54,22 +63,141 @@ HMDataCheckList::checkNeeded(string& hostname, HMIPAddress& ip, HMDataHostCheck&
     {
         result = HM_SCHEDULE_IGNORE;
     }
-    if(nextCheck <= HMTimeStamp::now())
+    // Read the clock after the check times, a check due now is reported at the time read by nextCheckTime
+    if(nextCheck <= HMMonotonicTime::now())
     {
         result = HM_SCHEDULE_WORK;
     }
     return result;
 }
 
-HMTimeStamp
+uint32_t
+HMDataCheckList::getCheckID(const string& hostname, const HMDataHostCheck& hostCheck) const
+{
+    return findCheckID(hostname, hostCheck, hashCheck(hostname, hostCheck));
+}
+
+uint64_t
+HMDataCheckList::getListID() const
+{
+    return m_listID;
+}
+
+size_t
+HMDataCheckList::hashCheck(const string& hostname, const HMDataHostCheck& hostCheck)
+{
+    // Only hash fields that are part of the CompareCheckList ordering so equivalent keys hash the same
+    size_t hash = std::hash<string>()(hostname);
+    hash ^= std::hash<string>()(hostCheck.getCheckInfo()) + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
+    hash ^= ((size_t)hostCheck.getCheckType() << 32 | (size_t)hostCheck.getPort() << 8 | hostCheck.getDnsType())
+            + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
+    return hash;
+}
+
+uint32_t
+HMDataCheckList::findCheckID(const string& hostname, const HMDataHostCheck& hostCheck, size_t hash) const
+{
+    if(m_checkSlots.empty())
+    {
+        return HM_CHECK_ID_INVALID;
+    }
+    size_t mask = m_checkSlots.size() - 1;
+    for(size_t slot = hash & mask; ; slot = (slot + 1) & mask)
+    {
+        uint32_t checkID = m_checkSlots[slot];
+        if(checkID == HM_CHECK_ID_INVALID)
+        {
+            return HM_CHECK_ID_INVALID;
+        }
+        if(m_checkHashes[checkID] == hash)
+        {
+            const auto& key = m_checkIndex[checkID].front()->first;
+            if(key.first == hostname && key.second == hostCheck && key.second.getDnsType() == hostCheck.getDnsType())
+            {
+                return checkID;
+            }
+        }
+    }
+}
+
+void
+HMDataCheckList::indexCheck(HMCheckList::iterator it)
+{
+    size_t hash = hashCheck(it->first.first, it->first.second);
+    uint32_t checkID = findCheckID(it->first.first, it->first.second, hash);
+    if(checkID != HM_CHECK_ID_INVALID)
+    {
+        m_checkIndex[checkID].push_back(it);
+        return;
+    }
+
+    // Keep the table at most half full, growing it rehashes the stored hashes
+    checkID = m_checkIndex.size();
+    if(checkID * 2 > m_checkSlots.size())
+    {
+        m_checkSlots.assign(max<size_t>(16, m_checkSlots.size() * 2), HM_CHECK_ID_INVALID);
+        size_t mask = m_checkSlots.size() - 1;
+        for(uint32_t id = 1; id < checkID; ++id)
+        {
+            size_t slot = m_checkHashes[id] & mask;
+            while(m_checkSlots[slot] != HM_CHECK_ID_INVALID)
+            {
+                slot = (slot + 1) & mask;
+            }
+            m_checkSlots[slot] = id;
+        }
+    }
+    m_checkIndex.push_back(vector<HMCheckList::iterator>(1, it));
+    m_checkHashes.push_back(hash);
+    size_t mask = m_checkSlots.size() - 1;
+    size_t slot = hash & mask;
+    while(m_checkSlots[slot] != HM_CHECK_ID_INVALID)
+    {
+        slot = (slot + 1) & mask;
+    }
+    m_checkSlots[slot] = checkID;
+}
+
+bool
+HMDataCheckList::hasCheck(const string& hostname, const HMIPAddress& ip, const HMDataHostCheck& hostCheck)
+{
+    return hasCheck(getCheckID(hostname, hostCheck), ip);
+}
+
+bool
+HMDataCheckList::hasCheck(uint32_t checkID, const HMIPAddress& ip)
+{
+    if(checkID >= m_checkIndex.size())
+    {
+        return false;
+    }
+    for (auto it : m_checkIndex[checkID])
+    {
+        if(it->second.isValidIP(ip))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+HMMonotonicTime
 HMDataCheckList::nextCheckTime(string& hostname, const HMIPAddress& ip, HMDataHostCheck& hostCheck)
 {
-    HMTimeStamp nextCheck = HMTimeStamp::now() + HMTimeStamp::HOURINMS;
-    auto key = make_pair(hostname, hostCheck);
-    auto ret = m_checklist.equal_range(key);
-    for(auto it = ret.first; it != ret.second; ++it)
+    return nextCheckTime(getCheckID(hostname, hostCheck), ip);
+}
+
+HMMonotonicTime
+HMDataCheckList::nextCheckTime(uint32_t checkID, const HMIPAddress& ip)
+{
+    HMMonotonicTime nextCheck = HMMonotonicTime::now() + HMTimeStamp::HOURINMS;
+    if(checkID >= m_checkIndex.size())
+    {
+        return nextCheck;
+    }
+    for(auto it : m_checkIndex[checkID])
     {
-        HMTimeStamp checkTime = it->second.nextCheckTime(ip);
+        HMMonotonicTime checkTime = it->second.nextCheckTime(ip);
         if(checkTime < nextCheck)
         {
             nextCheck = checkTime;
@@ -78,15 +206,23 @@ HMDataCheckList::nextCheckTime(string& hostname, const HMIPAddress& ip, HMDataHo
     return nextCheck;
 }
 
-HMTimeStamp
+HMMonotonicTime
 HMDataCheckList::getCheckTimeout(const string& hostname, const HMIPAddress& ip, HMDataHostCheck& hostCheck)
 {
-    HMTimeStamp minCheckTimeout = HMTimeStamp::now() + HMTimeStamp::HOURINMS;
-    auto key = make_pair(hostname, hostCheck);
-    auto ret = m_checklist.equal_range(key);
-    for(auto it = ret.first; it != ret.second; ++it)
+    return getCheckTimeout(getCheckID(hostname, hostCheck), ip);
+}
+
+HMMonotonicTime
+HMDataCheckList::getCheckTimeout(uint32_t checkID, const HMIPAddress& ip)
+{
+    HMMonotonicTime minCheckTimeout = HMMonotonicTime::now() + HMTimeStamp::HOURINMS;
+    if(checkID >= m_checkIndex.size())
     {
-        HMTimeStamp checkTime = it->second.getCheckTimeout(ip);
+        return minCheckTimeout;
+    }
+    for(auto it : m_checkIndex[checkID])
+    {
+        HMMonotonicTime checkTime = it->second.getCheckTimeout(ip);
         if(checkTime < minCheckTimeout)
         {
             minCheckTimeout = checkTime;
@@ -96,15 +232,38 @@ HMDataCheckList::getCheckTimeout(const string& hostname, const HMIPAddress& ip,
 }
 
 void
-HMDataCheckList::queueCheck(const string& hostname, const HMIPAddress& ip, HMDataHostCheck& check, HMWorkQueue& queue)
+HMDataCheckList::queueCheck(const string& hostname, const HMIPAddress& ip, HMDataHostCheck& check, HMWorkQueue& queue,
+        HMEventLoop* eventLoop, bool control)
+{
+    queueCheck(getCheckID(hostname, check), hostname, ip, check, queue, eventLoop, control);
+}
+
+void
+HMDataCheckList::queueCheck(uint32_t checkID, const string& hostname, const HMIPAddress& ip, HMDataHostCheck& check, HMWorkQueue& queue,
+        HMEventLoop* eventLoop, bool control)
 {
-    HMLog(HM_LOG_DEBUG, "[CORE] Health Check QueueCheck for %s(%s)",
+    shared_ptr<HMDestinationSlot> slot;
+    HMMonotonicTime retry;
+    // The checks of type none never leave the host
+    if(eventLoop != nullptr && check.getCheckType() != HM_CHECK_NONE && check.getCheckType() != HM_CHECK_DEFAULT
+            && !queue.getDestinationLimiter().acquire(ip, slot, retry))
+    {
+        HMLog(HM_LOG_DEBUG3, "[CORE] Health Check for %s(%s) held back by the destination limits to %llu ms",
+                hostname.c_str(), ip.toString().c_str(), retry.getMilliseconds());
+        eventLoop->addHealthCheckTimeout(hostname, ip, check, retry, m_listID, checkID);
+        return;
+    }
+    if(HMLogEnabled(HM_LOG_DEBUG))
+    {
+        HMLog(HM_LOG_DEBUG, "[CORE] Health Check QueueCheck for %s(%s)",
                                         hostname.c_str(), ip.toString().c_str());
-    auto key = make_pair(hostname, check);
-    auto ret = m_checklist.equal_range(key);
-    for (auto it = ret.first; it != ret.second; ++it)
+    }
+    if(checkID < m_checkIndex.size())
     {
-        it->second.queueQuerry(ip);
+        for (auto it : m_checkIndex[checkID])
+        {
+            it->second.queueQuerry(ip);
+        }
     }
 
     unique_ptr<HMWork> healthCheck;
@@ -120,6 +279,7 @@ HMDataCheckList::queueCheck(const string& hostname, const HMIPAddress& ip, HMDat
         {
         case HM_CHECK_PLUGIN_DEFAULT:
         case HM_CHECK_PLUGIN_HTTP_CURL:
+        case HM_CHECK_PLUGIN_HTTP_CURL_MULTI:
             healthCheck = make_unique<HMWorkHealthCheckCurl>(
                     HMWorkHealthCheckCurl(hostname, ip, check));
             break;
@@ -156,6 +316,7 @@ HMDataCheckList::queueCheck(const string& hostname, const HMIPAddress& ip, HMDat
         switch (check.getCheckPlugin())
         {
         case HM_CHECK_PLUGIN_TCP_RAW:
+        case HM_CHECK_PLUGIN_TCP_EPOLL:
         case HM_CHECK_PLUGIN_DEFAULT:
             healthCheck = make_unique<HMWorkHealthCheckTCP>(
                     HMWorkHealthCheckTCP(hostname, ip, check));
@@ -169,6 +330,7 @@ HMDataCheckList::queueCheck(const string& hostname, const HMIPAddress& ip, HMDat
     case HM_CHECK_TCPS:
         switch (check.getCheckPlugin()) {
         case HM_CHECK_PLUGIN_TCPS_RAW:
+        case HM_CHECK_PLUGIN_TCPS_EPOLL:
         case HM_CHECK_PLUGIN_DEFAULT:
             healthCheck = make_unique<HMWorkHealthCheckTCPS>(
                     HMWorkHealthCheckTCPS(hostname, ip, check));
@@ -260,8 +422,15 @@ HMDataCheckList::queueCheck(const string& hostname, const HMIPAddress& ip, HMDat
         return;
     }
     // Setup the timing parameters
-    healthCheck->m_start = HMTimeStamp::now();
-    healthCheck->m_end = getCheckTimeout(hostname, ip, check);
+    healthCheck->m_start = HMMonotonicTime::now();
+    healthCheck->m_end = getCheckTimeout(checkID, ip);
+    healthCheck->m_checkListID = m_listID;
+    healthCheck->m_checkID = checkID;
+    healthCheck->m_destinationSlot = slot;
+    if(control)
+    {
+        healthCheck->m_workClass = HM_WORK_CLASS_CONTROL;
+    }
     if(check.getFlowType() == HM_FLOW_REMOTE_HOSTGROUP_TYPE || check.getFlowType() == HM_FLOW_REMOTE_HOST_TYPE)
     {
         healthCheck->setReschedule(false);
@@ -269,22 +438,76 @@ HMDataCheckList::queueCheck(const string& hostname, const HMIPAddress& ip, HMDat
     queue.insertWork(healthCheck);
 }
 
-HMTimeStamp
+void
+HMDataCheckList::scheduleCheck(const string& hostname, const HMIPAddress& ip, HMDataHostCheck& check, HMWorkQueue& queue,
+        HMEventLoop& eventLoop, bool restart)
+{
+    uint32_t checkID = getCheckID(hostname, check);
+    if(checkID >= m_checkIndex.size())
+    {
+        return;
+    }
+    if(restart)
+    {
+        // A reload forces the check, make it due so it is queued when its spread timeout expires
+        for(auto it : m_checkIndex[checkID])
+        {
+            it->second.expireCheck(ip);
+        }
+    }
+    HMMonotonicTime checkTime = nextCheckTime(checkID, ip);
+    if(checkTime > HMMonotonicTime::now())
+    {
+        return;
+    }
+
+    bool spread = restart;
+    uint64_t ttl = ULLONG_MAX;
+    for(auto it : m_checkIndex[checkID])
+    {
+        spread = spread || !it->second.isCheckedSinceStart(ip);
+        ttl = (it->second.getTTL() < ttl) ? it->second.getTTL() : ttl;
+    }
+    if(spread)
+    {
+        // The phase only depends on the check and the address so a check keeps its place in the window across reloads
+        size_t hash = m_checkHashes[checkID];
+        hash ^= std::hash<string>()(ip.toString()) + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
+        checkTime = eventLoop.getCheckSchedule().spread(hash, ttl, true);
+        if(checkTime > HMMonotonicTime::now())
+        {
+            HMLog(HM_LOG_DEBUG3, "[CORE] Health Check for %s(%s) spread to %llu ms", hostname.c_str(), ip.toString().c_str(),
+                    checkTime.getMilliseconds());
+            eventLoop.addHealthCheckTimeout(hostname, ip, check, checkTime, m_listID, checkID);
+            return;
+        }
+    }
+    queueCheck(checkID, hostname, ip, check, queue, &eventLoop);
+}
+
+HMMonotonicTime
 HMDataCheckList::startCheck(string& hostname, HMIPAddress& ip, HMDataHostCheck& check)
+{
+    return startCheck(getCheckID(hostname, check), ip);
+}
+
+HMMonotonicTime
+HMDataCheckList::startCheck(uint32_t checkID, const HMIPAddress& ip)
 {
     uint64_t maxCheckTimeout = 0;
-    auto key = make_pair(hostname, check);
-    auto ret = m_checklist.equal_range(key);
-    for(auto it = ret.first; it != ret.second; ++it)
+    if(checkID < m_checkIndex.size())
     {
-        if(it->second.isValidIP(ip))
+        for(auto it : m_checkIndex[checkID])
         {
-            it->second.startQuery(ip);
+            if(it->second.isValidIP(ip))
+            {
+                it->second.startQuery(ip);
+            }
+            maxCheckTimeout = (it->second.getTimeout() > maxCheckTimeout) ? it->second.getTimeout() : maxCheckTimeout;
         }
-        maxCheckTimeout = (it->second.getTimeout() > maxCheckTimeout) ? it->second.getTimeout() : maxCheckTimeout;
     }
 
-    return HMTimeStamp().now() + maxCheckTimeout;
+    return HMMonotonicTime::now() + maxCheckTimeout;
 }
 
 bool
@@ -345,6 +568,7 @@ HMDataCheckList::updateCheck(HMWork* work, multimap<HMDataCheckParams, HMDataChe
             iit->second.m_softStatus = iit->second.m_status;
             iit->second.m_remoteCheckTime = iit->second.m_checkTime;
             iit->second.m_checkTime = HMTimeStamp::now();
+            iit->second.m_lastCheck = HMMonotonicTime::now();
             // reset query state to prevent the health check to go off schedule
             iit->second.m_queryState = HM_CHECK_INACTIVE;
             it->second.updateCheck(iit->second.m_address, iit->second, true);
@@ -377,6 +601,7 @@ HMDataCheckList::updateCheck(HMWork* work, map<HMDataCheckParams, HMDataCheckRes
             paramsIt->second.m_softStatus = paramsIt->second.m_status;
             paramsIt->second.m_remoteCheckTime = paramsIt->second.m_checkTime;
             paramsIt->second.m_checkTime = HMTimeStamp::now();
+            paramsIt->second.m_lastCheck = HMMonotonicTime::now();
             // reset query state to prevent the health check to go off schedule
             paramsIt->second.m_queryState = HM_CHECK_INACTIVE;
             it->second.updateCheck(paramsIt->second.m_address, paramsIt->second, true);
@@ -400,7 +625,8 @@ HMDataCheckList::updateCheck(HMWork* work, HMDataHostCheck& hostCheck)
                     work->m_reason,
                     work->m_start,
                     work->m_end,
-                    hostCheck.getPort());
+                    hostCheck.getPort(),
+                    work->m_connectEnd);
         }
     }
 }
@@ -452,7 +678,7 @@ HMDataCheckList::publishCheck(HMWork* work, HMDataHostCheck& hostCheck, const HM
 
 
 void
-HMDataCheckList::storeAux(HMWork* work, HMDataHostCheck& hostCheck, const HMIPAddress& address, string  auxData, HMStorage* store, HMAuxCache& aux, HM_AUX_DATA_TYPE auxDataType)
+HMDataCheckList::storeAux(HMWork* work, HMDataHostCheck& hostCheck, const HMIPAddress& address, string& auxData, HMStorage* store, HMAuxCache& aux, HM_AUX_DATA_TYPE auxDataType)
 {
 
     if(work->m_reason == HM_REASON_SUCCESS)
@@ -630,6 +856,7 @@ HMDataCheckList::addHostGroup(HMDataHostGroup& hostGroup)
             if(!found)
             {
                 auto it = m_checklist.insert(make_pair(key,check));
+                indexCheck(it);
                 it->second.addHostGroup(hostGroup.getName());
                 string emptyRemoteHost = "";
                 HMDataHostCheck tempHostCheck = hostcheck;
@@ -644,6 +871,63 @@ HMDataCheckList::addHostGroup(HMDataHostGroup& hostGroup)
     return 0;
 }
 
+uint64_t
+HMDataCheckList::restoreChecks(HMDataCheckList& src, const set<string>& unchangedGroups, HMStorage* store, vector<HMCheckHeader>& changedChecks)
+{
+    uint64_t restored = 0;
+    vector<string> hostGroups;
+    vector<pair<HMIPAddress, HMDataCheckResult>> results;
+    changedChecks.clear();
+    for(auto it = src.m_checklist.begin(); it != src.m_checklist.end(); ++it)
+    {
+        hostGroups.clear();
+        it->second.getHostGroups(hostGroups);
+        bool unchanged = !hostGroups.empty() && it->first.second.getFlowType() == HM_FLOW_DNS_HEALTH_TYPE;
+        for(auto hostGroup = hostGroups.begin(); unchanged && hostGroup != hostGroups.end(); ++hostGroup)
+        {
+            unchanged = (unchangedGroups.find(*hostGroup) != unchangedGroups.end());
+        }
+
+        // Unchanged checks have the same key and check params in both check lists
+        HMDataCheckParams* params = nullptr;
+        uint32_t checkID = unchanged ? getCheckID(it->first.first, it->first.second) : HM_CHECK_ID_INVALID;
+        if(checkID != HM_CHECK_ID_INVALID)
+        {
+            for(auto entry : m_checkIndex[checkID])
+            {
+                if(entry->second == it->second)
+                {
+                    params = &entry->second;
+                    break;
+                }
+            }
+        }
+        if(params == nullptr)
+        {
+            changedChecks.push_back(HMCheckHeader(it->first.first, HMIPAddress(), it->first.second, it->second));
+            continue;
+        }
+
+        results.clear();
+        params->restoreResults(it->second, results);
+        if(!results.empty())
+        {
+            HMCheckHeader header(it->first.first, HMIPAddress(), it->first.second, *params);
+            for(string& groupName : hostGroups)
+            {
+                header.m_checkParams.addHostGroup(groupName);
+            }
+            for(auto& result : results)
+            {
+                header.m_address = result.first;
+                store->updateCheckResultCache(header, result.second);
+            }
+        }
+        restored++;
+    }
+    return restored;
+}
+
 void
 HMDataCheckList::initDNSCache(HMDNSCache& cache, HMWaitList& dnsWaitList, HM_DNS_PLUGIN_CLASS lookupDNSPlugin, HM_DNS_PLUGIN_CLASS staticDNSPlugin)
 {
@@ -734,6 +1018,7 @@ HMDataCheckList::insertCheck(string hostGroup, string host, HMDataHostCheck& hos
     {
         auto key = make_pair(host, hostCheck);
         auto it = m_checklist.insert(make_pair(key,checkParams));
+        indexCheck(it);
         for(set<HMIPAddress>::iterator iit = ips.begin();iit != ips.end(); ++iit)
         {
             it->second.emptyQuery(*iit);
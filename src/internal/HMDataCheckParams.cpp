@@ -134,25 +134,26 @@ HMDataCheckParams::setHostStatus(const HMIPAddress& address, bool forceHostStatu
 bool
 HMDataCheckParams::checkNeeded(HMIPAddress& address)
 {
-    return (nextCheckTime(address) <= HMTimeStamp::now());
+    return (nextCheckTime(address) <= HMMonotonicTime::now());
 }
 
-HMTimeStamp
+HMMonotonicTime
 HMDataCheckParams::nextCheckTime(const HMIPAddress& address)
 {
     lock_guard<shared_timed_mutex> lock(m_sharedMutex);
-    HMTimeStamp now = HMTimeStamp::now();
+    HMMonotonicTime now = HMMonotonicTime::now();
     auto it = m_checkData.find(address);
     if(it == m_checkData.end())
     {
         return now;
     }
     
-    HMTimeStamp nextchecktime;
+    HMMonotonicTime nextchecktime;
     nextchecktime =  now + HMTimeStamp::HOURINMS;
     if(it->second.m_queryState == HM_CHECK_INACTIVE || it->second.m_queryState == HM_CHECK_FAILED)
     {
-        if((it->second.m_checkTime + m_checkTTL) < now)
+        HMMonotonicTime lastCheck = it->second.getLastCheck();
+        if((lastCheck + m_checkTTL) < now)
         {
             nextchecktime = now;
         }
@@ -164,22 +165,22 @@ HMDataCheckParams::nextCheckTime(const HMIPAddress& address)
                             && ((it->second.m_numFailedChecks)
                                     <= m_numCheckRetries)))
             {
-                nextchecktime = it->second.m_checkTime + m_checkRetryDelay;
+                nextchecktime = lastCheck + m_checkRetryDelay;
             }
             else
             {
-                nextchecktime = it->second.m_checkTime + m_checkTTL;
+                nextchecktime = lastCheck + m_checkTTL;
             }
         }
     }
     return nextchecktime;
 }
 
-HMTimeStamp
+HMMonotonicTime
 HMDataCheckParams::getCheckTimeout(const HMIPAddress& address)
 {
     (void)address;
-    return HMTimeStamp::now() + m_checkTTL;
+    return HMMonotonicTime::now() + m_checkTTL;
 }
 
 void
@@ -207,7 +208,7 @@ HMDataCheckParams::emptyQuery(const HMIPAddress& address)
 }
 
 void
-HMDataCheckParams::startQuery(HMIPAddress& address)
+HMDataCheckParams::startQuery(const HMIPAddress& address)
 {
     lock_guard<shared_timed_mutex> lock(m_sharedMutex);
     auto it = m_checkData.find(address);
@@ -216,6 +217,7 @@ HMDataCheckParams::startQuery(HMIPAddress& address)
         return;
     }
     it->second.m_checkTime = HMTimeStamp::now();
+    it->second.m_lastCheck = HMMonotonicTime::now();
     it->second.m_queryState = HM_CHECK_IN_PROGRESS;
 }
 
@@ -242,7 +244,8 @@ HMDataCheckParams::updateCheck(const HMIPAddress& address, const HMDataCheckResu
 }
 
 void
-HMDataCheckParams::updateCheck(string& hostname, const HMIPAddress& address, HM_RESPONSE response, HM_REASON reason, HMTimeStamp start, HMTimeStamp end, uint16_t port)
+HMDataCheckParams::updateCheck(string& hostname, const HMIPAddress& address, HM_RESPONSE response, HM_REASON reason, HMMonotonicTime start, HMMonotonicTime end, uint16_t port,
+        HMMonotonicTime connectEnd)
 {
 
     lock_guard<shared_timed_mutex> lock(m_sharedMutex);
@@ -271,21 +274,36 @@ HMDataCheckParams::updateCheck(string& hostname, const HMIPAddress& address, HM_
     it->second.m_address = address;
     it->second.m_response = response;
     it->second.m_reason = reason;
-    it->second.m_start = start;
-    it->second.m_end = end;
+    // The check is timed on the monotonic clock, only the stored result is in wall clock time
+    HMTimeStamp wallStart = start.toWallClock();
+    it->second.m_start = wallStart;
+    it->second.m_end = wallStart + end.microsecondsSince(start) / 1000;
     it->second.m_port = port;
+    // Split the connect of the checks with a TLS handshake between the TCP connect and the handshake
+    if(connectEnd.isSet() && start <= connectEnd)
+    {
+        it->second.m_tcpConnectTime = connectEnd.microsecondsSince(start);
+        it->second.m_tlsHandshakeTime = end.microsecondsSince(connectEnd);
+    }
+    else
+    {
+        it->second.m_tcpConnectTime = 0;
+        it->second.m_tlsHandshakeTime = 0;
+    }
 
     // Fix the possible race condition during DNS timeouts
     it->second.m_queryState = HM_CHECK_INACTIVE;
 
     if(response == HM_RESPONSE_DNS_FAILED)
     {
-        it->second.m_checkTime = start;
+        it->second.m_checkTime = wallStart;
+        it->second.m_lastCheck = start;
         return;
     }
 
     it->second.m_numChecks++;
     it->second.m_checkTime = HMTimeStamp::now();
+    it->second.m_lastCheck = HMMonotonicTime::now();
 
     if(response == HM_RESPONSE_CONNECTED)
     {
@@ -389,7 +407,7 @@ HMDataCheckParams::updateCheck(string& hostname, const HMIPAddress& address, HM_
     if (((it->second.m_softStatus & HM_HOST_STATUS_UP) != 0)
             != ((it->second.m_flapStatus & HM_HOST_STATUS_UP) != 0))
     {
-        if (start - it->second.m_flapTime < flap)
+        if (wallStart - it->second.m_flapTime < flap)
         {
             it->second.m_numFlaps++;
         }
@@ -413,8 +431,8 @@ HMDataCheckParams::updateCheck(string& hostname, const HMIPAddress& address, HM_
                     printHostGroups().c_str());
         }
 
-        it->second.m_flapTime = start;
-        it->second.m_changeTime = start;
+        it->second.m_flapTime = wallStart;
+        it->second.m_changeTime = wallStart;
 
         if(it->second.m_numFailedChecks > m_numCheckRetries)
         {
@@ -428,7 +446,7 @@ HMDataCheckParams::updateCheck(string& hostname, const HMIPAddress& address, HM_
             it->second.m_numFailedChecks = 0;
         }
     }
-    else if(start - it->second.m_flapTime >= flap) 
+    else if(wallStart - it->second.m_flapTime >= flap) 
     {
         it->second.m_numFlaps = 0;
     }
@@ -461,6 +479,32 @@ HMDataCheckParams::invalidateResult(const HMIPAddress& address, HMDataCheckResul
     return true;
 }
 
+void
+HMDataCheckParams::restoreResults(HMDataCheckParams& src, vector<pair<HMIPAddress, HMDataCheckResult>>& restored)
+{
+    shared_lock<shared_timed_mutex> srcLock(src.m_sharedMutex);
+    lock_guard<shared_timed_mutex> lock(m_sharedMutex);
+    for(const auto& srcResult : src.m_checkData)
+    {
+        auto it = m_checkData.find(srcResult.first);
+        if(it != m_checkData.end() && !(it->second.m_checkTime < srcResult.second.m_checkTime))
+        {
+            continue;
+        }
+        HMDataCheckResult result = srcResult.second;
+        result.m_queryState = HM_CHECK_INACTIVE;
+        if(it == m_checkData.end())
+        {
+            m_checkData.insert(make_pair(srcResult.first, result));
+        }
+        else
+        {
+            it->second = result;
+        }
+        restored.push_back(make_pair(srcResult.first, result));
+    }
+}
+
 bool
 HMDataCheckParams::getCheckResult(const HMIPAddress& address, HMDataCheckResult& result)
 {
@@ -506,6 +550,28 @@ HMDataCheckParams::getCheckTime(HMIPAddress& address)
     return it->second.m_checkTime;
 }
 
+bool
+HMDataCheckParams::isCheckedSinceStart(const HMIPAddress& address)
+{
+    shared_lock<shared_timed_mutex> lock(m_sharedMutex);
+
+    auto it = m_checkData.find(address);
+    return (it != m_checkData.end()) && it->second.m_lastCheck.isSet();
+}
+
+void
+HMDataCheckParams::expireCheck(const HMIPAddress& address)
+{
+    lock_guard<shared_timed_mutex> lock(m_sharedMutex);
+
+    auto it = m_checkData.find(address);
+    if(it != m_checkData.end())
+    {
+        // The earliest set time, long past any TTL
+        it->second.m_lastCheck = HMMonotonicTime(1);
+    }
+}
+
 uint8_t
 HMDataCheckParams::getNumCheckRetries() const
 {
@@ -620,7 +686,7 @@ HMDataCheckParams::addHostGroup(string name)
 }
 
 HM_WORK_STATE
-HMDataCheckParams::getQueryState(HMIPAddress& address)
+HMDataCheckParams::getQueryState(const HMIPAddress& address)
 {
     lock_guard<shared_timed_mutex> lock(m_sharedMutex);
 
@@ -636,13 +702,14 @@ HMDataCheckParams::getQueryState(HMIPAddress& address)
 
 void
 HMDataCheckParams::setResponse(string& hostname,
-        HMTimeStamp start,
-        HMTimeStamp end,
+        HMMonotonicTime start,
+        HMMonotonicTime end,
         map<HMIPAddress,HMDataCheckResult>::iterator& it)
 {
     uint64_t srt;
-    uint64_t rt = end - start;
-    uint64_t totrt = HMTimeStamp::now() - start;
+    uint64_t rtMicros = end.microsecondsSince(start);
+    uint64_t rt = rtMicros / 1000;
+    uint64_t totrt = HMMonotonicTime::now().microsecondsSince(start) / 1000;
 
     uint8_t rtmode = m_measurementOptions & HM_RT_BITS;
 
@@ -707,6 +774,7 @@ HMDataCheckParams::setResponse(string& hostname,
             it->second.m_numSlowResponses = 0;
             it->second.m_totalResponseTime = totrt;
             it->second.m_responseTime = rt;
+            it->second.m_responseTimeMicros = rtMicros;
             it->second.m_smoothedResponseTime = srt;
 
             HMLog(HM_LOG_DEBUG3,
@@ -8,53 +8,202 @@ using namespace std;
 uint32_t
 HMDataCheckResult::serialize(char* buf, uint32_t size) const
 {
-    if(buf == nullptr || size < sizeof(SerStruct))
+    if(buf != nullptr && size >= MAX_SERIALIZED_SIZE)
     {
-        return sizeof(SerStruct);
+        return serializeCompact(buf);
     }
 
-    SerStruct* ptr = (SerStruct*)buf;
-
-    ptr->m_address = m_address;
-    ptr->m_start = m_start.getTimeSinceEpoch();
-    ptr->m_end = m_end.getTimeSinceEpoch();
-    ptr->m_responseTime = m_responseTime;
-    ptr->m_totalResponseTime = m_totalResponseTime;
-    ptr->m_minResponseTime = m_minResponseTime;
-    ptr->m_maxResponseTime = m_maxResponseTime;
-    ptr->m_smoothedResponseTime = m_smoothedResponseTime;
-    ptr->m_sumResponseTime = m_sumResponseTime;
-    ptr->m_numChecks = m_numChecks;
-    ptr->m_numResponses = m_numResponses;
-    ptr->m_numConnectFailures = m_numConnectFailures;
-    ptr->m_numFailures = m_numFailures;
-    ptr->m_numTimeouts = m_numTimeouts;
-    ptr->m_numFlaps = m_numFlaps;
-    ptr->m_status = m_status;
-    ptr->m_response = m_response;
-    ptr->m_reason = m_reason;
-    ptr->m_softReason = m_softReason;
-    ptr->m_numFailedChecks = m_numFailedChecks;
-    ptr->m_numSlowResponses = m_numSlowResponses;
-    ptr->m_port = m_port;
-    ptr->m_changeTime = m_changeTime.getTimeSinceEpoch();
-    ptr->m_prevTime = m_flapTime.getTimeSinceEpoch();
-    ptr->m_forceHostDown = m_forceHostDown;
-    ptr->m_queueCheckTime = m_queueCheckTime.getTimeSinceEpoch();
-    ptr->m_checkTime = m_checkTime.getTimeSinceEpoch();
-    ptr->m_remoteCheckTime = m_remoteCheckTime.getTimeSinceEpoch();
-    return sizeof(SerStruct);
+    char data[MAX_SERIALIZED_SIZE];
+    uint32_t len = serializeCompact(data);
+    if(buf != nullptr && size >= len)
+    {
+        memcpy(buf, data, len);
+    }
+    return len;
 }
 
 bool
 HMDataCheckResult::deserialize(char* buf, uint32_t size)
 {
-    if(buf == nullptr || size < sizeof(SerStruct))
+    uint32_t used;
+    return deserialize(buf, size, used);
+}
+
+bool
+HMDataCheckResult::deserialize(const char* buf, uint32_t size, uint32_t& used)
+{
+    used = 0;
+    if(buf == nullptr || size == 0)
+    {
+        return false;
+    }
+    // The fixed layout starts with the address type, never the magic
+    if((uint8_t)buf[0] == COMPACT_MAGIC)
+    {
+        return deserializeCompact(buf, size, used);
+    }
+    return deserializeLegacy(buf, size, used);
+}
+
+uint32_t
+HMDataCheckResult::serializeCompact(char* buf) const
+{
+    uint64_t fields[FIELD_COUNT];
+    uint64_t checkTime = m_checkTime.getTimeSinceEpoch();
+    fields[FIELD_CHECK_TIME] = checkTime;
+    fields[FIELD_START] = m_start.getTimeSinceEpoch();
+    fields[FIELD_END] = m_end.getTimeSinceEpoch();
+    fields[FIELD_QUEUE_CHECK_TIME] = m_queueCheckTime.getTimeSinceEpoch();
+    fields[FIELD_CHANGE_TIME] = m_changeTime.getTimeSinceEpoch();
+    fields[FIELD_FLAP_TIME] = m_flapTime.getTimeSinceEpoch();
+    fields[FIELD_REMOTE_CHECK_TIME] = m_remoteCheckTime.getTimeSinceEpoch();
+    for(uint32_t i = FIELD_START; i <= FIELD_REMOTE_CHECK_TIME; i++)
+    {
+        // Offset by one so only the unset timestamps are 0 and left out
+        if(fields[i] != 0)
+        {
+            fields[i] = HMVarint::zigzag((int64_t)(fields[i] - checkTime)) + 1;
+        }
+    }
+    fields[FIELD_RESPONSE_TIME] = m_responseTime;
+    fields[FIELD_TOTAL_RESPONSE_TIME] = m_totalResponseTime;
+    fields[FIELD_MIN_RESPONSE_TIME] = m_minResponseTime;
+    fields[FIELD_MAX_RESPONSE_TIME] = m_maxResponseTime;
+    fields[FIELD_SMOOTHED_RESPONSE_TIME] = m_smoothedResponseTime;
+    fields[FIELD_SUM_RESPONSE_TIME] = m_sumResponseTime;
+    fields[FIELD_NUM_CHECKS] = m_numChecks;
+    fields[FIELD_NUM_RESPONSES] = m_numResponses;
+    fields[FIELD_NUM_CONNECT_FAILURES] = m_numConnectFailures;
+    fields[FIELD_NUM_FAILURES] = m_numFailures;
+    fields[FIELD_NUM_TIMEOUTS] = m_numTimeouts;
+    fields[FIELD_NUM_FLAPS] = m_numFlaps;
+    fields[FIELD_STATUS] = m_status;
+    fields[FIELD_RESPONSE] = m_response;
+    fields[FIELD_REASON] = m_reason;
+    fields[FIELD_SOFT_REASON] = m_softReason;
+    fields[FIELD_NUM_FAILED_CHECKS] = m_numFailedChecks;
+    fields[FIELD_NUM_SLOW_RESPONSES] = m_numSlowResponses;
+    fields[FIELD_PORT] = m_port;
+    fields[FIELD_FORCE_HOST_DOWN] = m_forceHostDown;
+    fields[FIELD_TCP_CONNECT_TIME] = m_tcpConnectTime;
+    fields[FIELD_TLS_HANDSHAKE_TIME] = m_tlsHandshakeTime;
+    fields[FIELD_RESPONSE_TIME_MICROS] = m_responseTimeMicros;
+
+    uint64_t present = 0;
+    for(uint32_t i = 0; i < FIELD_COUNT; i++)
+    {
+        if(fields[i] != 0)
+        {
+            present |= (1ULL << i);
+        }
+    }
+
+    char* target = buf;
+    *target++ = (char)COMPACT_MAGIC;
+    *target++ = (char)COMPACT_VERSION;
+    target += HMVarint::put(target, present);
+    target += HMVarint::putAddress(target, m_address);
+    for(uint32_t i = 0; i < FIELD_COUNT; i++)
+    {
+        if(fields[i] != 0)
+        {
+            target += HMVarint::put(target, fields[i]);
+        }
+    }
+    return target - buf;
+}
+
+bool
+HMDataCheckResult::deserializeCompact(const char* buf, uint32_t size, uint32_t& used)
+{
+    const char* src = buf;
+    const char* end = buf + size;
+    if(size < 2 || (uint8_t)src[1] != COMPACT_VERSION)
+    {
+        return false;
+    }
+    src += 2;
+
+    uint64_t present;
+    HMIPAddress address;
+    if(!HMVarint::get(src, end, present) || !HMVarint::getAddress(src, end, address))
+    {
+        return false;
+    }
+
+    uint64_t fields[FIELD_COUNT] = {};
+    for(uint32_t i = 0; i < 64 && (present >> i) != 0; i++)
+    {
+        if(!(present & (1ULL << i)))
+        {
+            continue;
+        }
+        uint64_t value;
+        if(!HMVarint::get(src, end, value))
+        {
+            return false;
+        }
+        // Fields appended by newer versions are skipped
+        if(i < FIELD_COUNT)
+        {
+            fields[i] = value;
+        }
+    }
+
+    uint64_t checkTime = fields[FIELD_CHECK_TIME];
+    for(uint32_t i = FIELD_START; i <= FIELD_REMOTE_CHECK_TIME; i++)
+    {
+        if(fields[i] != 0)
+        {
+            fields[i] = checkTime + HMVarint::unzigzag(fields[i] - 1);
+        }
+    }
+
+    m_address = address;
+    m_checkTime.setTime(checkTime);
+    m_start.setTime(fields[FIELD_START]);
+    m_end.setTime(fields[FIELD_END]);
+    m_queueCheckTime.setTime(fields[FIELD_QUEUE_CHECK_TIME]);
+    m_changeTime.setTime(fields[FIELD_CHANGE_TIME]);
+    m_flapTime.setTime(fields[FIELD_FLAP_TIME]);
+    m_remoteCheckTime.setTime(fields[FIELD_REMOTE_CHECK_TIME]);
+    m_responseTime = fields[FIELD_RESPONSE_TIME];
+    m_totalResponseTime = fields[FIELD_TOTAL_RESPONSE_TIME];
+    m_minResponseTime = fields[FIELD_MIN_RESPONSE_TIME];
+    m_maxResponseTime = fields[FIELD_MAX_RESPONSE_TIME];
+    m_smoothedResponseTime = fields[FIELD_SMOOTHED_RESPONSE_TIME];
+    m_sumResponseTime = fields[FIELD_SUM_RESPONSE_TIME];
+    m_numChecks = fields[FIELD_NUM_CHECKS];
+    m_numResponses = fields[FIELD_NUM_RESPONSES];
+    m_numConnectFailures = fields[FIELD_NUM_CONNECT_FAILURES];
+    m_numFailures = fields[FIELD_NUM_FAILURES];
+    m_numTimeouts = fields[FIELD_NUM_TIMEOUTS];
+    m_numFlaps = fields[FIELD_NUM_FLAPS];
+    m_status = HM_HOST_STATUS(fields[FIELD_STATUS]);
+    m_response = HM_RESPONSE(fields[FIELD_RESPONSE]);
+    m_reason = HM_REASON(fields[FIELD_REASON]);
+    m_softReason = HM_REASON(fields[FIELD_SOFT_REASON]);
+    m_numFailedChecks = fields[FIELD_NUM_FAILED_CHECKS];
+    m_numSlowResponses = fields[FIELD_NUM_SLOW_RESPONSES];
+    m_port = fields[FIELD_PORT];
+    m_forceHostDown = fields[FIELD_FORCE_HOST_DOWN];
+    m_tcpConnectTime = fields[FIELD_TCP_CONNECT_TIME];
+    m_tlsHandshakeTime = fields[FIELD_TLS_HANDSHAKE_TIME];
+    m_responseTimeMicros = fields[FIELD_RESPONSE_TIME_MICROS];
+
+    used = src - buf;
+    return true;
+}
+
+bool
+HMDataCheckResult::deserializeLegacy(const char* buf, uint32_t size, uint32_t& used)
+{
+    if(size < sizeof(SerStruct))
     {
         return false;
     }
 
-    SerStruct* ptr = (SerStruct*)buf;
+    const SerStruct* ptr = (const SerStruct*)buf;
 
     m_address = ptr->m_address;
     m_start.setTime(ptr->m_start);
@@ -84,6 +233,11 @@ HMDataCheckResult::deserialize(char* buf, uint32_t size)
     m_queueCheckTime.setTime(ptr->m_queueCheckTime);
     m_checkTime.setTime(ptr->m_checkTime);
     m_remoteCheckTime.setTime(ptr->m_remoteCheckTime);
+    // Not in the fixed layout
+    m_tcpConnectTime = 0;
+    m_tlsHandshakeTime = 0;
+    m_responseTimeMicros = 0;
 
+    used = sizeof(SerStruct);
     return true;
 }
@@ -29,6 +29,8 @@ HMDataHostCheck::HMDataHostCheck(const HMAPIDataHostCheck& apiDataHostCheck)
     m_sourceAddress.set(apiDataHostCheck.m_sourceAddress);
     m_remoteCheck = false;
     m_TOSValue = apiDataHostCheck.m_TOSValue;
+    m_keepAlive = false;
+    m_priority = HM_WORK_PRIORITY_NORMAL;
 }
 
 bool
@@ -50,6 +52,10 @@ HMDataHostCheck::operator<(const HMDataHostCheck& k) const
                             {
                                 if (m_distributedFallback == k.m_distributedFallback)
                                 {
+                                    if (m_flowType == k.m_flowType)
+                                    {
+                                        return m_checkExpect < k.m_checkExpect;
+                                    }
                                     return m_flowType < k.m_flowType;
                                 }
                                 return m_distributedFallback < k.m_distributedFallback;
@@ -86,7 +92,8 @@ HMDataHostCheck::operator==(const HMDataHostCheck& k) const
             && m_sourceAddress == k.m_sourceAddress
             && m_TOSValue == k.m_TOSValue
             && m_distributedFallback == k.m_distributedFallback
-            && m_flowType == k.m_flowType)
+            && m_flowType == k.m_flowType
+            && m_checkExpect == k.m_checkExpect)
     {
         return true;
     }
@@ -100,6 +107,7 @@ HMDataHostCheck::setCheckParams(const HMDataHostGroup& dataHostGroup)
     m_port = dataHostGroup.getCheckPort();
     m_dualstack = dataHostGroup.getDualstack();
     m_checkInfo = dataHostGroup.getCheckInfo();
+    m_checkExpect = dataHostGroup.getCheckExpect();
     m_remoteCheck = dataHostGroup.getRemoteCheck();
     m_checkPlugin = dataHostGroup.getCheckPlugin();
     m_remoteCheckType = dataHostGroup.getRemoteCheckType();
@@ -108,6 +116,8 @@ HMDataHostCheck::setCheckParams(const HMDataHostGroup& dataHostGroup)
     m_TOSValue = dataHostGroup.getTOSValue();
     m_DNSType = dataHostGroup.getDNSType();
     m_flowType = dataHostGroup.getFlowType();
+    m_keepAlive = dataHostGroup.getKeepAlive();
+    m_priority = dataHostGroup.getPriority();
 }
 
 HM_CHECK_TYPE
@@ -134,12 +144,18 @@ HMDataHostCheck::getDualStack() const
     return m_dualstack;
 }
 
-string
+const string&
 HMDataHostCheck::getCheckInfo() const
 {
     return m_checkInfo;
 }
 
+const string&
+HMDataHostCheck::getCheckExpect() const
+{
+    return m_checkExpect;
+}
+
 HM_DISTRIBUTED_FALLBACK
 HMDataHostCheck::getDistributedFallBack() const
 {
@@ -275,6 +291,16 @@ uint8_t HMDataHostCheck::getTOSValue() const
     return m_TOSValue;
 }
 
+bool HMDataHostCheck::getKeepAlive() const
+{
+    return m_keepAlive;
+}
+
+HM_WORK_PRIORITY HMDataHostCheck::getPriority() const
+{
+    return m_priority;
+}
+
 HM_DNS_TYPE HMDataHostCheck::getDnsType() const
 {
     return m_DNSType;
@@ -1,5 +1,6 @@
 // Copyright 2019, Oath Inc.
 // Licensed under the terms of the Apache 2.0 license. See LICENSE file in the root of the distribution for licensing details.
+#include <cstddef>
 #include <cstring>
 
 #include "HMConstants.h"
@@ -17,6 +18,7 @@ bool HMDataHostGroup::operator<(const HMDataHostGroup& k) const
             || m_checkType < k.m_checkType
             || m_port < k.m_port
             || m_checkInfo < k.m_checkInfo
+            || m_checkExpect < k.m_checkExpect
             || m_numCheckRetries < k.m_numCheckRetries
             || m_checkRetryDelay < k.m_checkRetryDelay
             || m_smoothingWindow < k.m_smoothingWindow
@@ -29,7 +31,9 @@ bool HMDataHostGroup::operator<(const HMDataHostGroup& k) const
             || m_passthroughInfo < k.m_passthroughInfo
             || m_checkPlugin < k.m_checkPlugin
             || m_TOSValue < k.m_TOSValue
-            || m_flowType < k.m_flowType )
+            || m_flowType < k.m_flowType
+            || m_keepAlive < k.m_keepAlive
+            || m_priority < k.m_priority )
     {
         return true;
     }
@@ -45,6 +49,7 @@ HMDataHostGroup::operator==(const HMDataHostGroup& k) const
     && (m_checkType == k.m_checkType)
     && (m_port == k.m_port)
     && (m_checkInfo == k.m_checkInfo)
+    && (m_checkExpect == k.m_checkExpect)
     && (m_numCheckRetries == k.m_numCheckRetries)
     && (m_checkRetryDelay == k.m_checkRetryDelay)
     && (m_smoothingWindow == k.m_smoothingWindow)
@@ -56,7 +61,9 @@ HMDataHostGroup::operator==(const HMDataHostGroup& k) const
     && (m_flapThreshold == k.m_flapThreshold)
     && (m_passthroughInfo == k.m_passthroughInfo)
     && (m_TOSValue == k.m_TOSValue)
-    && (m_flowType == k.m_flowType))
+    && (m_flowType == k.m_flowType)
+    && (m_keepAlive == k.m_keepAlive)
+    && (m_priority == k.m_priority))
     {
         return true;
     }
@@ -97,10 +104,9 @@ HMDataHostGroup::HMDataHostGroup(const std::string& groupName, HMAPICheckInfo& c
     m_remoteCheckType = (HM_REMOTE_CHECK_TYPE)checkInfo.m_remoteCheckType;
     m_TOSValue = checkInfo.m_TOSValue;
     m_flowType = (HM_FLOW_TYPE)checkInfo.m_flowType;
-    for(string& host: checkInfo.m_hosts)
-    {
-        m_hosts.push_back(host);
-    }
+    m_keepAlive = false;
+    m_priority = HM_WORK_PRIORITY_NORMAL;
+    m_hosts = make_shared<vector<string>>(checkInfo.m_hosts);
     for (string& hostGrp : checkInfo.m_hostGroups)
     {
         m_hostGroups.push_back(hostGrp);
@@ -145,6 +151,7 @@ HMDataHostGroup::setHostGroupParameters(const HMDataHostGroup& hostGroup)
          m_port = hostGroup.m_port;
          m_checkType = hostGroup.m_checkType;
          m_checkInfo = hostGroup.m_checkInfo;
+         m_checkExpect = hostGroup.m_checkExpect;
          m_numCheckRetries = hostGroup.m_numCheckRetries;
          m_checkRetryDelay = hostGroup.m_checkRetryDelay;
          m_smoothingWindow = hostGroup.m_smoothingWindow;
@@ -160,9 +167,9 @@ HMDataHostGroup::setHostGroupParameters(const HMDataHostGroup& hostGroup)
 void
 HMDataHostGroup::addHost(string& host)
 {
-    if(find(m_hosts.begin(),m_hosts.end(), host) == m_hosts.end())
+    if(find(m_hosts->begin(),m_hosts->end(), host) == m_hosts->end())
     {
-        m_hosts.push_back(host);
+        getMutableHostList().push_back(host);
     }
 }
 
@@ -196,6 +203,12 @@ HMDataHostGroup::setCheckInfo(const string& checkInfo)
     m_checkInfo = checkInfo;
 }
 
+void
+HMDataHostGroup::setCheckExpect(const string& checkExpect)
+{
+    m_checkExpect = checkExpect;
+}
+
 void
 HMDataHostGroup::setNumCheckRetries(uint8_t numCheckRetries)
 {
@@ -334,6 +347,12 @@ HMDataHostGroup::getCheckInfo() const
     return m_checkInfo;
 }
 
+const string&
+HMDataHostGroup::getCheckExpect() const
+{
+    return m_checkExpect;
+}
+
 uint32_t
 HMDataHostGroup::getFlapThreshold() const
 {
@@ -385,23 +404,33 @@ HMDataHostGroup::getCheckRetryDelay() const
 const vector<string>*
 HMDataHostGroup::getHostList() const
 {
-    return &m_hosts;
+    return m_hosts.get();
+}
+
+vector<string>&
+HMDataHostGroup::getMutableHostList()
+{
+    if(m_hosts.use_count() > 1)
+    {
+        m_hosts = make_shared<vector<string>>(*m_hosts);
+    }
+    return *m_hosts;
 }
 
 bool
 HMDataHostGroup::isValidHost(string& host) const
 {
-    return find(m_hosts.begin(),m_hosts.end(),host) != m_hosts.end();
+    return find(m_hosts->begin(),m_hosts->end(),host) != m_hosts->end();
 }
 
 uint32_t
 HMDataHostGroup::serialize(char* buf, uint32_t size) const
 {
     HMLog(HM_LOG_DEBUG3, "Hostgroup  %s serialsation called ", m_groupName.c_str());
-    uint32_t totalSize = sizeof(SerStruct) + m_groupName.size() + m_checkInfo.size() + m_remoteCheck.size();
+    uint32_t totalSize = sizeof(SerStruct) + m_groupName.size() + m_checkInfo.size() + m_checkExpect.size() + m_remoteCheck.size();
     uint32_t hostGroupsSize = 0;
     uint32_t hostsSize = 0;
-    for(auto it = m_hosts.begin(); it != m_hosts.end(); ++it)
+    for(auto it = m_hosts->begin(); it != m_hosts->end(); ++it)
     {
         hostsSize += (sizeof(uint32_t) + it->size());
     }
@@ -421,8 +450,13 @@ HMDataHostGroup::serialize(char* buf, uint32_t size) const
         return totalSize;
     }
 
+    // Zero the padding so the fields appended later read as 0 from this layout
+    memset(buf, 0, sizeof(SerStruct));
     SerStruct* ptr = (SerStruct*)buf;
 
+    ptr->m_magic = SER_MAGIC;
+    ptr->m_version = SER_VERSION;
+    ptr->m_size = sizeof(SerStruct);
     ptr->m_measurementOptions = m_measurementOptions;
     ptr->m_dualstack = m_dualstack;
     ptr->m_checkType = m_checkType;
@@ -441,9 +475,12 @@ HMDataHostGroup::serialize(char* buf, uint32_t size) const
     ptr->m_sourceAddress = m_sourceAddress;
     ptr->m_TOSValue = m_TOSValue;
     ptr->m_flowType = m_flowType;
+    ptr->m_keepAlive = m_keepAlive;
+    ptr->m_priority = m_priority;
     ptr->m_groupNameSize = m_groupName.size();
     ptr->m_checkInfoSize = m_checkInfo.size();
-    ptr->m_numHosts = m_hosts.size();
+    ptr->m_checkExpectSize = m_checkExpect.size();
+    ptr->m_numHosts = m_hosts->size();
     ptr->m_remoteCheckSize = m_remoteCheck.size();
     ptr->m_totalHostSize = hostsSize;
     ptr->m_numHostGroups = m_hostGroups.size();
@@ -460,6 +497,12 @@ HMDataHostGroup::serialize(char* buf, uint32_t size) const
         target += m_checkInfo.size();
     }
 
+    if(ptr->m_checkExpectSize)
+    {
+        memcpy(target, m_checkExpect.c_str(), m_checkExpect.size());
+        target += m_checkExpect.size();
+    }
+
     if (ptr->m_remoteCheckSize)
     {
         strncpy(target, m_remoteCheck.c_str(), m_remoteCheck.size());
@@ -467,7 +510,7 @@ HMDataHostGroup::serialize(char* buf, uint32_t size) const
     }
 
     // now add the hosts
-    for(auto it = m_hosts.begin(); it != m_hosts.end(); ++it)
+    for(auto it = m_hosts->begin(); it != m_hosts->end(); ++it)
     {
         *(uint32_t*)target = (uint32_t)it->size();
         strncpy((target + sizeof(uint32_t)) , it->c_str(), it->size());
@@ -490,12 +533,73 @@ HMDataHostGroup::serialize(char* buf, uint32_t size) const
 bool
 HMDataHostGroup::deserialize(char* buf, uint32_t size)
 {
-    if(buf == nullptr || size < sizeof(SerStruct))
+    if(buf == nullptr || size == 0)
     {
         return false;
     }
 
+    if((uint8_t)buf[0] != SER_MAGIC)
+    {
+        return deserializeLegacy(buf, size);
+    }
+
     SerStruct* ptr = (SerStruct*)buf;
+    if(size < offsetof(SerStruct, m_measurementOptions) || ptr->m_version != SER_VERSION
+            || ptr->m_size < offsetof(SerStruct, m_keepAlive) || ptr->m_size > size)
+    {
+        return false;
+    }
+
+    SerStruct ser = {};
+    memcpy((void*)&ser, buf, min((size_t)ptr->m_size, sizeof(SerStruct)));
+    return deserialize(ser, buf + ptr->m_size, size - ptr->m_size);
+}
+
+bool
+HMDataHostGroup::deserializeLegacy(char* buf, uint32_t size)
+{
+    if(size < sizeof(LegacySerStruct))
+    {
+        return false;
+    }
+
+    // The fields added since are left at 0
+    LegacySerStruct* legacy = (LegacySerStruct*)buf;
+    SerStruct ser = {};
+    ser.m_measurementOptions = legacy->m_measurementOptions;
+    ser.m_dualstack = legacy->m_dualstack;
+    ser.m_checkType = legacy->m_checkType;
+    ser.m_port = legacy->m_port;
+    ser.m_numCheckRetries = legacy->m_numCheckRetries;
+    ser.m_checkRetryDelay = legacy->m_checkRetryDelay;
+    ser.m_smoothingWindow = legacy->m_smoothingWindow;
+    ser.m_groupThreshold = legacy->m_groupThreshold;
+    ser.m_slowThreshold = legacy->m_slowThreshold;
+    ser.m_maxFlaps = legacy->m_maxFlaps;
+    ser.m_checkTimeout = legacy->m_checkTimeout;
+    ser.m_checkTTL = legacy->m_checkTTL;
+    ser.m_flapThreshold = legacy->m_flapThreshold;
+    ser.m_passthroughInfo = legacy->m_passthroughInfo;
+    ser.m_distributedFallback = legacy->m_distributedFallback;
+    ser.m_groupNameSize = legacy->m_groupNameSize;
+    ser.m_checkInfoSize = legacy->m_checkInfoSize;
+    ser.m_numHosts = legacy->m_numHosts;
+    ser.m_remoteCheckSize = legacy->m_remoteCheckSize;
+    ser.m_totalHostSize = legacy->m_totalHostSize;
+    ser.m_numHostGroups = legacy->m_numHostGroups;
+    ser.m_totalHostGroupSize = legacy->m_totalHostGroupSize;
+    ser.m_sourceAddress = legacy->m_sourceAddress;
+    ser.m_TOSValue = legacy->m_TOSValue;
+    ser.m_DNSCheckPlugin = legacy->m_DNSCheckPlugin;
+    ser.m_flowType = legacy->m_flowType;
+
+    return deserialize(ser, buf + sizeof(LegacySerStruct), size - sizeof(LegacySerStruct));
+}
+
+bool
+HMDataHostGroup::deserialize(const SerStruct& ser, const char* src, uint32_t size)
+{
+    const SerStruct* ptr = &ser;
 
     m_measurementOptions = ptr->m_measurementOptions;
     m_dualstack = HM_DUALSTACK(ptr->m_dualstack);
@@ -514,14 +618,15 @@ HMDataHostGroup::deserialize(char* buf, uint32_t size)
     m_sourceAddress = ptr->m_sourceAddress;
     m_TOSValue = ptr->m_TOSValue;
     m_flowType = (HM_FLOW_TYPE)ptr->m_flowType;
+    m_keepAlive = ptr->m_keepAlive;
+    m_priority = (HM_WORK_PRIORITY)ptr->m_priority;
     m_distributedFallback = HM_DISTRIBUTED_FALLBACK(ptr->m_distributedFallback);
-    if(size < sizeof(SerStruct) + ptr->m_groupNameSize + ptr->m_checkInfoSize + ptr->m_totalHostSize + ptr->m_totalHostGroupSize)
+    if((uint64_t)size < (uint64_t)ptr->m_groupNameSize + ptr->m_checkInfoSize + ptr->m_checkExpectSize
+            + ptr->m_remoteCheckSize + ptr->m_totalHostSize + ptr->m_totalHostGroupSize)
     {
         return false;
     }
 
-    char* src = buf + sizeof(SerStruct);
-
     m_groupName.resize(ptr->m_groupNameSize);
     strncpy(&m_groupName.at(0), src, ptr->m_groupNameSize);
     src += ptr->m_groupNameSize;
@@ -533,6 +638,9 @@ HMDataHostGroup::deserialize(char* buf, uint32_t size)
         src += ptr->m_checkInfoSize;
     }
 
+    m_checkExpect.assign(src, ptr->m_checkExpectSize);
+    src += ptr->m_checkExpectSize;
+
     if (ptr->m_remoteCheckSize > 0)
     {
         m_remoteCheck.resize(ptr->m_remoteCheckSize);
@@ -540,12 +648,13 @@ HMDataHostGroup::deserialize(char* buf, uint32_t size)
         src += ptr->m_remoteCheckSize;
     }
 
-    m_hosts.resize(ptr->m_numHosts);
+    vector<string>& hosts = getMutableHostList();
+    hosts.resize(ptr->m_numHosts);
     for(uint32_t i = 0; i < ptr->m_numHosts; ++i)
     {
         uint32_t size = *(uint32_t*)src;
-        m_hosts[i].resize(size);
-        strncpy(&m_hosts[i].at(0), src + sizeof(uint32_t), size);
+        hosts[i].resize(size);
+        strncpy(&hosts[i].at(0), src + sizeof(uint32_t), size);
         src += (size + sizeof(uint32_t));
     }
 
@@ -597,7 +706,10 @@ HMDataHostGroup::getHash(HMHashMD5& hash)
     }
 
     hash.update(&m_TOSValue, (uint8_t)(sizeof(m_TOSValue)));
-    for (string host: m_hosts)
+    hash.update(&m_keepAlive, (uint8_t)(sizeof(m_keepAlive)));
+    hash.update(&m_priority, (uint8_t)(sizeof(m_priority)));
+    hash.update(m_checkExpect.c_str(), (uint64_t) (m_checkExpect.length()));
+    for (const string& host: *m_hosts)
     {
         hash.update(host.c_str(), (uint64_t) (host.length()));
     }
@@ -684,6 +796,30 @@ HMDataHostGroup::setTOSValue(uint8_t tosValue)
     m_TOSValue = tosValue;
 }
 
+bool
+HMDataHostGroup::getKeepAlive() const
+{
+    return m_keepAlive;
+}
+
+void
+HMDataHostGroup::setKeepAlive(bool keepAlive)
+{
+    m_keepAlive = keepAlive;
+}
+
+HM_WORK_PRIORITY
+HMDataHostGroup::getPriority() const
+{
+    return m_priority;
+}
+
+void
+HMDataHostGroup::setPriority(HM_WORK_PRIORITY priority)
+{
+    m_priority = priority;
+}
+
 HM_DNS_TYPE HMDataHostGroup::getDNSType() const
 {
     return m_DNSType;
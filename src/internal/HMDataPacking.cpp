@@ -1,3 +1,5 @@
+#include <unordered_map>
+
 #include "HMDataPacking.h"
 using namespace google::protobuf::io;
 using namespace std;
@@ -96,6 +98,9 @@ HMDataPacking::packDataCheckResult(const string& hostname, const HMDataCheckResu
     pDataCheckResult->set_start(dataCheckResult.m_start.getTimeSinceEpoch());
     pDataCheckResult->set_end(dataCheckResult.m_end.getTimeSinceEpoch());
     pDataCheckResult->set_responsetime(dataCheckResult.m_responseTime);
+    pDataCheckResult->set_tcpconnecttime(dataCheckResult.m_tcpConnectTime);
+    pDataCheckResult->set_tlshandshaketime(dataCheckResult.m_tlsHandshakeTime);
+    pDataCheckResult->set_responsetimemicros(dataCheckResult.m_responseTimeMicros);
     pDataCheckResult->set_totalresponsetime(dataCheckResult.m_totalResponseTime);
     pDataCheckResult->set_minresponsetime(dataCheckResult.m_minResponseTime);
     pDataCheckResult->set_maxresponsetime(dataCheckResult.m_maxResponseTime);
@@ -128,6 +133,9 @@ HMDataPacking::unpackDataCheckResult(const netchasm::DataCheckResult& pDataCheck
     dataCheckResult.m_start = pDataCheckResult.start();
     dataCheckResult.m_end = pDataCheckResult.end();
     dataCheckResult.m_responseTime = pDataCheckResult.responsetime();
+    dataCheckResult.m_tcpConnectTime = pDataCheckResult.tcpconnecttime();
+    dataCheckResult.m_tlsHandshakeTime = pDataCheckResult.tlshandshaketime();
+    dataCheckResult.m_responseTimeMicros = pDataCheckResult.responsetimemicros();
     dataCheckResult.m_totalResponseTime = pDataCheckResult.totalresponsetime();
     dataCheckResult.m_minResponseTime = pDataCheckResult.minresponsetime();
     dataCheckResult.m_maxResponseTime = pDataCheckResult.maxresponsetime();
@@ -162,6 +170,9 @@ HMDataPacking::unpackDataCheckResult(const netchasm::DataCheckResult& pDataCheck
     time.setTime(pDataCheckResult.end());
     dataCheckResult.m_end = time;
     dataCheckResult.m_responseTime = pDataCheckResult.responsetime();
+    dataCheckResult.m_tcpConnectTime = pDataCheckResult.tcpconnecttime();
+    dataCheckResult.m_tlsHandshakeTime = pDataCheckResult.tlshandshaketime();
+    dataCheckResult.m_responseTimeMicros = pDataCheckResult.responsetimemicros();
     dataCheckResult.m_totalResponseTime = pDataCheckResult.totalresponsetime();
     dataCheckResult.m_minResponseTime = pDataCheckResult.minresponsetime();
     dataCheckResult.m_maxResponseTime = pDataCheckResult.maxresponsetime();
@@ -372,6 +383,17 @@ HMDataPacking::packThreadInfo(HMAPIThreadInfo& tInfo, uint64_t& dataSize)
     netchasm::ThreadInfo threadInfo;
     threadInfo.set_numidlethreads(tInfo.m_numIdleThreads);
     threadInfo.set_numthreads(tInfo.m_numThreads);
+    threadInfo.set_minthreads(tInfo.m_minThreads);
+    threadInfo.set_maxthreads(tInfo.m_maxThreads);
+    threadInfo.set_targetthreads(tInfo.m_targetThreads);
+    threadInfo.set_queuewaitp50(tInfo.m_queueWaitP50);
+    threadInfo.set_queuewaitp99(tInfo.m_queueWaitP99);
+    threadInfo.set_utilisation(tInfo.m_utilisation);
+    threadInfo.set_numgrows(tInfo.m_numGrows);
+    threadInfo.set_numshrinks(tInfo.m_numShrinks);
+    threadInfo.set_numrecycles(tInfo.m_numRecycles);
+    threadInfo.set_residentmemory(tInfo.m_residentMemory);
+    threadInfo.set_openfiles(tInfo.m_openFiles);
     unique_ptr<char[]> data;
     if(!threadInfo.IsInitialized())
     {
@@ -391,6 +413,131 @@ HMDataPacking::unpackThreadInfo(unique_ptr<char[]>& data, uint64_t dataSize, HMA
     {
         tInfo.m_numIdleThreads = threadInfo.numidlethreads();
         tInfo.m_numThreads = threadInfo.numthreads();
+        tInfo.m_minThreads = threadInfo.minthreads();
+        tInfo.m_maxThreads = threadInfo.maxthreads();
+        tInfo.m_targetThreads = threadInfo.targetthreads();
+        tInfo.m_queueWaitP50 = threadInfo.queuewaitp50();
+        tInfo.m_queueWaitP99 = threadInfo.queuewaitp99();
+        tInfo.m_utilisation = threadInfo.utilisation();
+        tInfo.m_numGrows = threadInfo.numgrows();
+        tInfo.m_numShrinks = threadInfo.numshrinks();
+        tInfo.m_numRecycles = threadInfo.numrecycles();
+        tInfo.m_residentMemory = threadInfo.residentmemory();
+        tInfo.m_openFiles = threadInfo.openfiles();
+        return true;
+    }
+    return false;
+}
+
+unique_ptr<char[]>
+HMDataPacking::packStoreInfo(HMAPIStoreInfo& sInfo, uint64_t& dataSize)
+{
+    dataSize = 0;
+    netchasm::StoreInfo storeInfo;
+    storeInfo.set_queuesize(sInfo.m_queueSize);
+    storeInfo.set_batchsize(sInfo.m_batchSize);
+    storeInfo.set_overflowpolicy(sInfo.m_overflowPolicy);
+    storeInfo.set_checksqueued(sInfo.m_checksQueued);
+    storeInfo.set_checksenqueued(sInfo.m_checksEnqueued);
+    storeInfo.set_checksdropped(sInfo.m_checksDropped);
+    storeInfo.set_checksblocked(sInfo.m_checksBlocked);
+    storeInfo.set_checkscoalesced(sInfo.m_checksCoalesced);
+    storeInfo.set_checkbatches(sInfo.m_checkBatches);
+    storeInfo.set_auxqueued(sInfo.m_auxQueued);
+    storeInfo.set_auxenqueued(sInfo.m_auxEnqueued);
+    storeInfo.set_auxdropped(sInfo.m_auxDropped);
+    storeInfo.set_auxblocked(sInfo.m_auxBlocked);
+    storeInfo.set_auxcoalesced(sInfo.m_auxCoalesced);
+    storeInfo.set_auxbatches(sInfo.m_auxBatches);
+    unique_ptr<char[]> data;
+    if(!storeInfo.IsInitialized())
+    {
+        return data;
+    }
+    dataSize = storeInfo.ByteSize();
+    data = make_unique<char[]>(dataSize);
+    storeInfo.SerializeToArray(data.get(), dataSize);
+    return data;
+}
+
+bool
+HMDataPacking::unpackStoreInfo(unique_ptr<char[]>& data, uint64_t dataSize, HMAPIStoreInfo& sInfo)
+{
+    netchasm::StoreInfo storeInfo;
+    if(storeInfo.ParseFromArray(data.get(), dataSize))
+    {
+        sInfo.m_queueSize = storeInfo.queuesize();
+        sInfo.m_batchSize = storeInfo.batchsize();
+        sInfo.m_overflowPolicy = storeInfo.overflowpolicy();
+        sInfo.m_checksQueued = storeInfo.checksqueued();
+        sInfo.m_checksEnqueued = storeInfo.checksenqueued();
+        sInfo.m_checksDropped = storeInfo.checksdropped();
+        sInfo.m_checksBlocked = storeInfo.checksblocked();
+        sInfo.m_checksCoalesced = storeInfo.checkscoalesced();
+        sInfo.m_checkBatches = storeInfo.checkbatches();
+        sInfo.m_auxQueued = storeInfo.auxqueued();
+        sInfo.m_auxEnqueued = storeInfo.auxenqueued();
+        sInfo.m_auxDropped = storeInfo.auxdropped();
+        sInfo.m_auxBlocked = storeInfo.auxblocked();
+        sInfo.m_auxCoalesced = storeInfo.auxcoalesced();
+        sInfo.m_auxBatches = storeInfo.auxbatches();
+        return true;
+    }
+    return false;
+}
+
+unique_ptr<char[]>
+HMDataPacking::packWorkQueueInfo(HMAPIWorkQueueInfo& wInfo, uint64_t& dataSize)
+{
+    dataSize = 0;
+    netchasm::WorkQueueInfo workQueueInfo;
+    workQueueInfo.set_queuesize(wInfo.m_queueSize);
+    workQueueInfo.set_numshards(wInfo.m_numShards);
+    workQueueInfo.set_starvationtime(wInfo.m_starvationTime);
+    for(const HMAPIWorkClassInfo& cInfo : wInfo.m_classes)
+    {
+        netchasm::WorkClassInfo* classInfo = workQueueInfo.add_classes();
+        classInfo->set_name(cInfo.m_name);
+        classInfo->set_weight(cInfo.m_weight);
+        classInfo->set_depth(cInfo.m_depth);
+        classInfo->set_dequeued(cInfo.m_dequeued);
+        classInfo->set_totalwait(cInfo.m_totalWait);
+        classInfo->set_oldestwait(cInfo.m_oldestWait);
+        classInfo->set_starved(cInfo.m_starved);
+    }
+    unique_ptr<char[]> data;
+    if(!workQueueInfo.IsInitialized())
+    {
+        return data;
+    }
+    dataSize = workQueueInfo.ByteSize();
+    data = make_unique<char[]>(dataSize);
+    workQueueInfo.SerializeToArray(data.get(), dataSize);
+    return data;
+}
+
+bool
+HMDataPacking::unpackWorkQueueInfo(unique_ptr<char[]>& data, uint64_t dataSize, HMAPIWorkQueueInfo& wInfo)
+{
+    netchasm::WorkQueueInfo workQueueInfo;
+    if(workQueueInfo.ParseFromArray(data.get(), dataSize))
+    {
+        wInfo.m_queueSize = workQueueInfo.queuesize();
+        wInfo.m_numShards = workQueueInfo.numshards();
+        wInfo.m_starvationTime = workQueueInfo.starvationtime();
+        wInfo.m_classes.clear();
+        for(const netchasm::WorkClassInfo& classInfo : workQueueInfo.classes())
+        {
+            HMAPIWorkClassInfo cInfo;
+            cInfo.m_name = classInfo.name();
+            cInfo.m_weight = classInfo.weight();
+            cInfo.m_depth = classInfo.depth();
+            cInfo.m_dequeued = classInfo.dequeued();
+            cInfo.m_totalWait = classInfo.totalwait();
+            cInfo.m_oldestWait = classInfo.oldestwait();
+            cInfo.m_starved = classInfo.starved();
+            wInfo.m_classes.push_back(cInfo);
+        }
         return true;
     }
     return false;
@@ -636,6 +783,66 @@ HMDataPacking::unpackHostGroupInfo(unique_ptr<char[]>& data, uint64_t dataSize,
     return false;
 }
 
+unique_ptr<char[]>
+HMDataPacking::packHostGroupDelta(uint64_t epoch, uint64_t sequence, bool resync, vector<HMGroupCheckResult>& results, uint64_t& dataSize)
+{
+    netchasm::HostGroupDelta pHostGroupDelta;
+    pHostGroupDelta.set_epoch(epoch);
+    pHostGroupDelta.set_sequence(sequence);
+    pHostGroupDelta.set_resync(resync);
+    unordered_map<string, uint32_t> hostIndex;
+    string buf;
+    for (auto& it : results)
+    {
+         auto host = hostIndex.insert(make_pair(it.m_hostName, (uint32_t)hostIndex.size()));
+         if(host.second)
+         {
+             pHostGroupDelta.add_hostnames(it.m_hostName);
+         }
+         netchasm::CompactCheckResult* result = pHostGroupDelta.add_results();
+         result->set_host(host.first->second);
+         buf.resize(it.m_result.serialize(nullptr, 0));
+         it.m_result.serialize(&buf[0], buf.size());
+         result->set_result(buf);
+    }
+    unique_ptr<char[]> data;
+    if(!pHostGroupDelta.IsInitialized())
+    {
+        return data;
+    }
+    dataSize = pHostGroupDelta.ByteSize();
+    data = make_unique<char[]>(dataSize);
+    pHostGroupDelta.SerializeToArray(data.get(), dataSize);
+    return data;
+}
+
+bool
+HMDataPacking::unpackHostGroupDelta(unique_ptr<char[]>& data, uint64_t dataSize, uint64_t& epoch, uint64_t& sequence, bool& resync, vector<HMGroupCheckResult>& checkResults)
+{
+    netchasm::HostGroupDelta pHostGroupDelta;
+    if(pHostGroupDelta.ParseFromArray(data.get(), dataSize))
+    {
+        epoch = pHostGroupDelta.epoch();
+        sequence = pHostGroupDelta.sequence();
+        resync = pHostGroupDelta.resync();
+        for(const netchasm::CompactCheckResult& pResult : pHostGroupDelta.results())
+        {
+            HMGroupCheckResult result;
+            uint32_t used;
+            if(pResult.host() >= (uint32_t)pHostGroupDelta.hostnames_size()
+                    || !result.m_result.deserialize(pResult.result().data(), pResult.result().size(), used))
+            {
+                return false;
+            }
+            result.m_hostName = pHostGroupDelta.hostnames(pResult.host());
+            result.m_address = result.m_result.m_address;
+            checkResults.push_back(std::move(result));
+        }
+        return true;
+    }
+    return false;
+}
+
 unique_ptr<char[]>
 HMDataPacking::packAuxInfo(HMAuxInfo& auxInfo, string& hostName, HMIPAddress& addr, uint64_t& dataSize)
 {
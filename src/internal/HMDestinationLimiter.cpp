@@ -0,0 +1,103 @@
+// Copyright 2019, Oath Inc.
+// Licensed under the terms of the Apache 2.0 license. See LICENSE file in the root of the distribution for licensing details.
+#include "HMDestinationLimiter.h"
+
+using namespace std;
+
+void
+HMDestinationLimiter::setConfig(const HMDestinationLimitConfig& config)
+{
+    lock_guard<mutex> lock(m_mutex);
+    m_config = config;
+    if(m_config.m_burst == 0)
+    {
+        m_config.m_burst = 1;
+    }
+    for(auto it = m_destinations.begin(); it != m_destinations.end();)
+    {
+        if(*it->second.m_inFlight == 0)
+        {
+            it = m_destinations.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+    m_enabled = m_config.m_concurrency > 0 || m_config.m_rate > 0;
+    m_resolverEnabled = m_config.m_resolverConcurrency > 0 || m_config.m_resolverRate > 0;
+}
+
+bool
+HMDestinationLimiter::acquire(const HMIPAddress& destination, shared_ptr<HMDestinationSlot>& slot, HMMonotonicTime& retry)
+{
+    if(!m_enabled)
+    {
+        return true;
+    }
+    lock_guard<mutex> lock(m_mutex);
+    sweep(HMMonotonicTime::now());
+    HMIPAddress key = destination.getPrefix((destination.getType() == AF_INET6) ? m_config.m_prefixIpv6 : m_config.m_prefixIpv4);
+    return acquire(m_destinations[key], m_config.m_concurrency, m_config.m_rate, slot, retry);
+}
+
+bool
+HMDestinationLimiter::acquireResolver(shared_ptr<HMDestinationSlot>& slot, HMMonotonicTime& retry)
+{
+    if(!m_resolverEnabled)
+    {
+        return true;
+    }
+    lock_guard<mutex> lock(m_mutex);
+    return acquire(m_resolver, m_config.m_resolverConcurrency, m_config.m_resolverRate, slot, retry);
+}
+
+bool
+HMDestinationLimiter::acquire(Destination& destination, uint32_t concurrency, uint32_t rate, shared_ptr<HMDestinationSlot>& slot, HMMonotonicTime& retry)
+{
+    HMMonotonicTime now = HMMonotonicTime::now();
+    if(concurrency > 0 && *destination.m_inFlight >= concurrency)
+    {
+        // Nothing tells when a check completes, so try again after the retry delay
+        retry = now + m_config.m_retryDelay;
+        m_numDeferred++;
+        return false;
+    }
+    if(rate > 0)
+    {
+        uint64_t interval = 1000000 / rate;
+        uint64_t burst = (m_config.m_burst - 1) * interval;
+        uint64_t nextStart = (destination.m_nextStart > now.getMicroseconds()) ? destination.m_nextStart : now.getMicroseconds();
+        if(nextStart - now.getMicroseconds() > burst)
+        {
+            retry = HMMonotonicTime(nextStart - burst);
+            m_numDeferred++;
+            return false;
+        }
+        destination.m_nextStart = nextStart + interval;
+    }
+    slot = make_shared<HMDestinationSlot>(destination.m_inFlight);
+    return true;
+}
+
+void
+HMDestinationLimiter::sweep(const HMMonotonicTime& now)
+{
+    if(now.getMicroseconds() < m_nextSweep)
+    {
+        return;
+    }
+    m_nextSweep = now.getMicroseconds() + HM_DESTINATION_SWEEP_INTERVAL * 1000;
+    for(auto it = m_destinations.begin(); it != m_destinations.end();)
+    {
+        // The in flight count only grows under the mutex, an idle destination stays idle while it is dropped
+        if(*it->second.m_inFlight == 0 && it->second.m_nextStart <= now.getMicroseconds())
+        {
+            it = m_destinations.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
@@ -6,86 +6,61 @@
 using namespace std;
 
 void
-HMEventLoopQueue::addDNSTimeout(const string& hostname, const HMDNSLookup& dnslookup, HMTimeStamp timeStamp)
+HMEventLoopQueue::addDNSTimeout(const string& hostname, const HMDNSLookup& dnslookup, HMMonotonicTime timeStamp)
 {
-    auto queueLock = unique_lock<mutex> (m_queueMutex, defer_lock);
-    HMLog(HM_LOG_DEBUG3, "[EVENT] Adding DNS scheduler timeout %llu", timeStamp.getTimeSinceEpoch());
-
-    bool preempt = false;
-    queueLock.lock();
-    if(m_timeouts.empty() || timeStamp < m_timeouts.top().m_timeout)
-    {
-        preempt = true;
-    }
-    m_timeouts.push(Timeout(hostname, dnslookup, timeStamp));
-    queueLock.unlock();
-
-    // if the Timeout we are inserting is before the next timeout, kick the tracker
-    if(preempt)
-    {
-        wakeupTracker();
-    }
+    HMLog(HM_LOG_DEBUG3, "[EVENT] Adding DNS scheduler timeout %llu", timeStamp.getMilliseconds());
+    Timeout timeout(hostname, dnslookup, timeStamp);
+    addTimeout(timeout);
 }
 
 void
-HMEventLoopQueue::addRemoteTimeout(const string& hostname, HMTimeStamp timeStamp)
+HMEventLoopQueue::addRemoteTimeout(const string& hostname, HMMonotonicTime timeStamp)
 {
-    auto queueLock = unique_lock<mutex> (m_queueMutex, defer_lock);
-    HMLog(HM_LOG_DEBUG3, "[EVENT] Adding Remote scheduler timeout %llu", timeStamp.getTimeSinceEpoch());
-
-    bool preempt = false;
-    queueLock.lock();
-    if(m_timeouts.empty() || timeStamp < m_timeouts.top().m_timeout)
-    {
-        preempt = true;
-    }
-    m_timeouts.push(Timeout(hostname, timeStamp));
-    queueLock.unlock();
-
-    // if the Timeout we are inserting is before the next timeout, kick the tracker
-    if(preempt)
-    {
-        wakeupTracker();
-    }
+    HMLog(HM_LOG_DEBUG3, "[EVENT] Adding Remote scheduler timeout %llu", timeStamp.getMilliseconds());
+    Timeout timeout(hostname, timeStamp);
+    addTimeout(timeout);
 }
 
 void
-HMEventLoopQueue::addRemoteHostTimeout(const std::string& hostname, const HMDataHostCheck& dataHostCheck,HMTimeStamp timeStamp)
+HMEventLoopQueue::addRemoteHostTimeout(const std::string& hostname, const HMDataHostCheck& dataHostCheck,HMMonotonicTime timeStamp)
 {
-    auto queueLock = unique_lock<mutex> (m_queueMutex, defer_lock);
-    HMLog(HM_LOG_DEBUG3, "[EVENT] Adding Remote host scheduler timeout %llu", timeStamp.getTimeSinceEpoch());
-
-    bool preempt = false;
-    queueLock.lock();
-    if(m_timeouts.empty() || timeStamp < m_timeouts.top().m_timeout)
-    {
-        preempt = true;
-    }
-    m_timeouts.push(Timeout(hostname, dataHostCheck, timeStamp));
-    queueLock.unlock();
+    HMLog(HM_LOG_DEBUG3, "[EVENT] Adding Remote host scheduler timeout %llu", timeStamp.getMilliseconds());
+    Timeout timeout(hostname, dataHostCheck, timeStamp);
+    addTimeout(timeout);
+}
 
-    // if the Timeout we are inserting is before the next timeout, kick the tracker
-    if(preempt)
-    {
-        wakeupTracker();
-    }
+void
+HMEventLoopQueue::addHealthCheckTimeout(const string& hostname, const HMIPAddress& address, const HMDataHostCheck check, HMMonotonicTime timeStamp)
+{
+    timeStamp = m_checkSchedule.jitter(timeStamp);
+    HMLog(HM_LOG_DEBUG3, "[EVENT] Adding HealthCheck Scheduler timeout %llu for %s", timeStamp.getMilliseconds(),hostname.c_str());
+    Timeout timeout(hostname, address, check, timeStamp);
+    addTimeout(timeout);
 }
 
+void
+HMEventLoopQueue::addHealthCheckTimeout(const string& hostname, const HMIPAddress& address, const HMDataHostCheck check, HMMonotonicTime timeStamp,
+        uint64_t checkListID, uint32_t checkID)
+{
+    timeStamp = m_checkSchedule.jitter(timeStamp);
+    HMLog(HM_LOG_DEBUG3, "[EVENT] Adding HealthCheck Scheduler timeout %llu for %s", timeStamp.getMilliseconds(),hostname.c_str());
+    Timeout timeout(hostname, address, check, timeStamp, checkListID, checkID);
+    addTimeout(timeout);
+}
 
 void
-HMEventLoopQueue::addHealthCheckTimeout(const string& hostname, const HMIPAddress& address, const HMDataHostCheck check, HMTimeStamp timeStamp)
+HMEventLoopQueue::addTimeout(Timeout& timeout)
 {
     auto queueLock = unique_lock<mutex> (m_queueMutex, defer_lock);
     bool preempt = false;
-
-    HMLog(HM_LOG_DEBUG3, "[EVENT] Adding HealthCheck Scheduler timeout %llu for %s", timeStamp.getTimeSinceEpoch(),hostname.c_str());
+    HMMonotonicTime expiration = timeout.m_timeout;
 
     queueLock.lock();
-    if(m_timeouts.empty() || timeStamp < m_timeouts.top().m_timeout)
+    if(m_timeouts.empty() || expiration < m_nextWakeup)
     {
         preempt = true;
     }
-    m_timeouts.push(Timeout(hostname, address, check, timeStamp));
+    m_timeouts.schedule(move(timeout), expiration);
     queueLock.unlock();
 
     // if the Timeout we are inserting is before the next timeout, kick the tracker
@@ -114,6 +89,7 @@ HMEventLoopQueue::shutDown()
 uint64_t
 HMEventLoopQueue::getTimeOutQueueSize()
 {
+    lock_guard<mutex> lock(m_queueMutex);
     return m_timeouts.size();
 }
 
@@ -130,140 +106,162 @@ HMEventLoopQueue::run()
     auto queueLock = unique_lock<mutex> (m_queueMutex, defer_lock);
     auto sleepLock = unique_lock<mutex> (m_sleepMutex, defer_lock);
     std::shared_ptr<HMState> currentState;
-    HMTimeStamp nextTimeout;
-    // Initial timeout check
-    queueLock.lock();
-    nextTimeout = (m_timeouts.empty()?
-            (HMTimeStamp::now() + m_emptyTimeout):(m_timeouts.top().m_timeout));
-    queueLock.unlock();
+    HMMonotonicTime nextTimeout;
+    vector<Timeout> expired;
 
+    m_stateManager->updateState(currentState);
     while(m_keepRunning)
     {
+        // Find when the wheel next needs service
+        queueLock.lock();
+        if(!m_timeouts.nextExpiration(nextTimeout))
+        {
+            nextTimeout = HMMonotonicTime::now() + m_emptyTimeout;
+        }
+        m_nextWakeup = nextTimeout;
+        queueLock.unlock();
 
         // Wait if there is no work to do and we are not shutting down
-        while(HMTimeStamp::now() < nextTimeout && m_keepRunning)
+        if(HMMonotonicTime::now() < nextTimeout)
         {
-
-            HMLog(HM_LOG_DEBUG3, "[EVENT] Event Queue Sleeping until %llu s", nextTimeout.getTimeSinceEpoch());
+            HMLog(HM_LOG_DEBUG3, "[EVENT] Event Queue Sleeping until %llu ms", nextTimeout.getMilliseconds());
 
             // Sleep till the next timeout
             sleepLock.lock();
             if(!m_wakeup)
             {
-                m_sleepCond.wait_until(sleepLock, nextTimeout.m_timeStamp);
-            }
-            else
-            {
-                m_wakeup = false;
+                // Wait for the time left on the monotonic clock, waiting until a wall clock time would stall or burst on a clock step
+                m_sleepCond.wait_for(sleepLock, chrono::milliseconds(nextTimeout.getMillisecondsFromNow()));
             }
+            m_wakeup = false;
             sleepLock.unlock();
             if(!m_keepRunning)
             {
                 return;
             }
-
-            m_stateManager->updateState(currentState);
-
-            // Check the latest timeout value
-            queueLock.lock();
-            nextTimeout = (m_timeouts.empty() ? (HMTimeStamp::now() + m_emptyTimeout) : (m_timeouts.top().m_timeout));
-            queueLock.unlock();
         }
 
-        HMLog(HM_LOG_DEBUG3, "[EVENT] Event Queue Waking Up");
+        // Update to the current state
+        if(m_stateManager->updateState(currentState))
+        {
+            cancelStaleTimeouts(currentState);
+        }
 
-        // Ok Wait again if we have not timeout event
         queueLock.lock();
-        if(m_timeouts.empty())
+        m_timeouts.expire(HMMonotonicTime::now(), expired);
+        queueLock.unlock();
+
+        if(!expired.empty())
         {
-            nextTimeout = HMTimeStamp::now() + m_emptyTimeout;
-            queueLock.unlock();
-            continue;
+            HMLog(HM_LOG_DEBUG3, "[EVENT] Event Queue Waking Up");
         }
-        Timeout timeout = m_timeouts.top();
-        m_timeouts.pop();
-        queueLock.unlock();
+        for(auto& timeout : expired)
+        {
+            processTimeout(timeout, currentState);
+        }
+        expired.clear();
+    }
+}
 
-        // Update to the current state
-        m_stateManager->updateState(currentState);
-        HM_SCHEDULE_STATE check_state;
+void
+HMEventLoopQueue::processTimeout(Timeout& timeout, shared_ptr<HMState>& currentState)
+{
+    HM_SCHEDULE_STATE check_state;
+    uint32_t checkID;
 
-        switch(timeout.m_type)
+    switch(timeout.m_type)
+    {
+    case HEALTHCHECK_TIMEOUT:
+        HMLog(HM_LOG_DEBUG, "[EVENT] Health Check Scheduler Timeout for %s", timeout.m_hostname.c_str());
+
+        checkID = timeout.getCheckID(currentState->m_checkList);
+        check_state = currentState->m_checkList.checkNeeded(checkID, timeout.m_address);
+        if (check_state == HM_SCHEDULE_WORK)
+        {
+            HMLog(HM_LOG_DEBUG3, "[DEBUG] Health Check Schedule work for %s", timeout.m_hostname.c_str());
+            currentState->m_checkList.queueCheck(checkID, timeout.m_hostname, timeout.m_address, timeout.m_hostCheck, m_stateManager->m_workQueue, this);
+        }
+        else if (check_state == HM_SCHEDULE_EVENT)
         {
-        case HEALTHCHECK_TIMEOUT:
-            HMLog(HM_LOG_DEBUG, "[EVENT] Health Check Scheduler Timeout for %s", timeout.m_hostname.c_str());
+            HMLog(HM_LOG_DEBUG3, "[DEBUG] Health Check Schedule event for %s", timeout.m_hostname.c_str());
+            // The expired timeout is rescheduled in place so the hostname and host check are moved, not copied
+            timeout.m_timeout = m_checkSchedule.jitter(currentState->m_checkList.nextCheckTime(checkID, timeout.m_address));
+            addTimeout(timeout);
+        }
+        break;
+    case REMOTECHECK_TIMEOUT:
+        HMLog(HM_LOG_DEBUG, "[EVENT] Remote Scheduler host group Check Timeout for %s", timeout.m_hostname.c_str());
 
-            check_state = currentState->m_checkList.checkNeeded(timeout.m_hostname, timeout.m_address, timeout.m_hostCheck);
-            if (check_state == HM_SCHEDULE_WORK)
-            {
-                HMLog(HM_LOG_DEBUG3, "[DEBUG] Health Check Schedule work for %s", timeout.m_hostname.c_str());
-                currentState->m_checkList.queueCheck(timeout.m_hostname, timeout.m_address, timeout.m_hostCheck, m_stateManager->m_workQueue);
-            }
-            else if (check_state == HM_SCHEDULE_EVENT)
-            {
-                HMLog(HM_LOG_DEBUG3, "[DEBUG] Health Check Schedule event for %s", timeout.m_hostname.c_str());
-                HMTimeStamp nextCheckTimeOut = currentState->m_checkList.nextCheckTime(timeout.m_hostname, timeout.m_address, timeout.m_hostCheck);
-                addHealthCheckTimeout(timeout.m_hostname, timeout.m_address, timeout.m_hostCheck, nextCheckTimeOut);
-            }
-            break;
-        case REMOTECHECK_TIMEOUT:
-            HMLog(HM_LOG_DEBUG, "[EVENT] Remote Scheduler host group Check Timeout for %s", timeout.m_hostname.c_str());
+        check_state = currentState->m_remoteCache.checkNeeded(timeout.m_hostname);
+        if (check_state == HM_SCHEDULE_WORK)
+        {
+            HMLog(HM_LOG_DEBUG3, "[DEBUG] Remote Check Schedule work for %s", timeout.m_hostname.c_str());
+            currentState->m_remoteCache.queueRemoteCheck(timeout.m_hostname, m_stateManager->m_workQueue, currentState->m_hostGroups);
+        }
+        else if (check_state == HM_SCHEDULE_EVENT)
+        {
+            HMLog(HM_LOG_DEBUG3, "[DEBUG] Remote Check Schedule event for %s", timeout.m_hostname.c_str());
+            HMMonotonicTime nextCheckTimeOut = currentState->m_remoteCache.nextCheckTime(timeout.m_hostname);
+            addRemoteTimeout(timeout.m_hostname, nextCheckTimeOut);
+        }
+        break;
+    case REMOTEHOSTCHECK_TIMEOUT:
+        HMLog(HM_LOG_DEBUG, "[EVENT] Remote Scheduler host Check Timeout for %s", timeout.m_hostname.c_str());
 
-            check_state = currentState->m_remoteCache.checkNeeded(timeout.m_hostname);
-            if (check_state == HM_SCHEDULE_WORK)
-            {
-                HMLog(HM_LOG_DEBUG3, "[DEBUG] Remote Check Schedule work for %s", timeout.m_hostname.c_str());
-                currentState->m_remoteCache.queueRemoteCheck(timeout.m_hostname, m_stateManager->m_workQueue, currentState->m_hostGroups);
-            }
-            else if (check_state == HM_SCHEDULE_EVENT)
-            {
-                HMLog(HM_LOG_DEBUG3, "[DEBUG] Remote Check Schedule event for %s", timeout.m_hostname.c_str());
-                HMTimeStamp nextCheckTimeOut = currentState->m_remoteCache.nextCheckTime(timeout.m_hostname);
-                addRemoteTimeout(timeout.m_hostname, nextCheckTimeOut);
-            }
-            break;
-        case REMOTEHOSTCHECK_TIMEOUT:
-            HMLog(HM_LOG_DEBUG, "[EVENT] Remote Scheduler host Check Timeout for %s", timeout.m_hostname.c_str());
+        check_state = currentState->m_remoteHostCache.checkNeeded(timeout.m_hostname, timeout.m_hostCheck);
+        if (check_state == HM_SCHEDULE_WORK)
+        {
+            HMLog(HM_LOG_DEBUG3, "[DEBUG] Remote host Check Schedule work for %s", timeout.m_hostname.c_str());
+            currentState->m_remoteHostCache.queueRemoteCheck(timeout.m_hostname, timeout.m_hostCheck, m_stateManager->m_workQueue);
+        }
+        else if (check_state == HM_SCHEDULE_EVENT)
+        {
+            HMLog(HM_LOG_DEBUG3, "[DEBUG] Remote host Check Schedule event for %s", timeout.m_hostname.c_str());
+            HMMonotonicTime nextCheckTimeOut = currentState->m_remoteHostCache.nextCheckTime(timeout.m_hostname, timeout.m_hostCheck);
+            addRemoteTimeout(timeout.m_hostname, nextCheckTimeOut);
+        }
+        break;
+    case DNS_TIMEOUT:
+    case DNSV6_TIMEOUT:
+        HMLog(HM_LOG_DEBUG, "[EVENT] DNS Scheduler Entry Timeout for %s",  timeout.m_hostname.c_str());
 
-            check_state = currentState->m_remoteHostCache.checkNeeded(timeout.m_hostname, timeout.m_hostCheck);
-            if (check_state == HM_SCHEDULE_WORK)
-            {
-                HMLog(HM_LOG_DEBUG3, "[DEBUG] Remote host Check Schedule work for %s", timeout.m_hostname.c_str());
-                currentState->m_remoteHostCache.queueRemoteCheck(timeout.m_hostname, timeout.m_hostCheck, m_stateManager->m_workQueue);
-            }
-            else if (check_state == HM_SCHEDULE_EVENT)
-            {
-                HMLog(HM_LOG_DEBUG3, "[DEBUG] Remote host Check Schedule event for %s", timeout.m_hostname.c_str());
-                HMTimeStamp nextCheckTimeOut = currentState->m_remoteHostCache.nextCheckTime(timeout.m_hostname, timeout.m_hostCheck);
-                addRemoteTimeout(timeout.m_hostname, nextCheckTimeOut);
-            }
-            break;
-        case DNS_TIMEOUT:
-        case DNSV6_TIMEOUT:
-            HMLog(HM_LOG_DEBUG, "[EVENT] DNS Scheduler Entry Timeout for %s",  timeout.m_hostname.c_str());
+        check_state = currentState->m_dnsCache.queryNeeded(timeout.m_hostname, timeout.m_dnsLookup);
+        if (check_state == HM_SCHEDULE_WORK)
+        {
+            HMLog(HM_LOG_DEBUG3, "[DEBUG] DNS Health Check Schedule work for %s", timeout.m_hostname.c_str());
+            currentState->m_dnsCache.queueDNSQuery(timeout.m_hostname, timeout.m_dnsLookup, m_stateManager->m_workQueue, this);
+        }
+        else if (check_state == HM_SCHEDULE_EVENT)
+        {
+            HMLog(HM_LOG_DEBUG3, "[DEBUG] DNS Health Check Schedule event for %s", timeout.m_hostname.c_str());
+            HMMonotonicTime nextCheckTimeOut = currentState->m_checkList.nextCheckTime(timeout.m_hostname, timeout.m_address, timeout.m_hostCheck);
+            addDNSTimeout(timeout.m_hostname, timeout.m_dnsLookup, nextCheckTimeOut);
+        }
+        else
+        {
+            string ip_version = timeout.m_type == DNSV6_TIMEOUT? "IPv6":"IPv4";
+            HMLog(HM_LOG_DEBUG3, "%s DNS Check dropped for %s, already in schedule", ip_version.c_str(), timeout.m_hostname.c_str());
+        }
+        break;
 
-            check_state = currentState->m_dnsCache.queryNeeded(timeout.m_hostname, timeout.m_dnsLookup);
-            if (check_state == HM_SCHEDULE_WORK)
-            {
-                HMLog(HM_LOG_DEBUG3, "[DEBUG] DNS Health Check Schedule work for %s", timeout.m_hostname.c_str());
-                currentState->m_dnsCache.queueDNSQuery(timeout.m_hostname, timeout.m_dnsLookup, m_stateManager->m_workQueue);
-            }
-            else if (check_state == HM_SCHEDULE_EVENT)
-            {
-                HMLog(HM_LOG_DEBUG3, "[DEBUG] DNS Health Check Schedule event for %s", timeout.m_hostname.c_str());
-                HMTimeStamp nextCheckTimeOut = currentState->m_checkList.nextCheckTime(timeout.m_hostname, timeout.m_address, timeout.m_hostCheck);
-                addDNSTimeout(timeout.m_hostname, timeout.m_dnsLookup, nextCheckTimeOut);
-            }
-            else
-            {
-                string ip_version = timeout.m_type == DNSV6_TIMEOUT? "IPv6":"IPv4";
-                HMLog(HM_LOG_DEBUG3, "%s DNS Check dropped for %s, already in schedule", ip_version.c_str(), timeout.m_hostname.c_str());
-            }
-            break;
+    }
+}
 
-        }
-        queueLock.lock();
-        nextTimeout = (m_timeouts.empty() ? (HMTimeStamp::now() + m_emptyTimeout) : (m_timeouts.top().m_timeout));
-        queueLock.unlock();
+void
+HMEventLoopQueue::cancelStaleTimeouts(shared_ptr<HMState>& currentState)
+{
+    uint64_t cancelled = 0;
+    {
+        lock_guard<mutex> lock(m_queueMutex);
+        cancelled = m_timeouts.cancelIf([&currentState](Timeout& timeout)
+        {
+            // Looking up the check ids of the kept timeouts here keeps the lookups by name out of processTimeout
+            return timeout.m_type == HEALTHCHECK_TIMEOUT
+                    && !currentState->m_checkList.hasCheck(timeout.getCheckID(currentState->m_checkList), timeout.m_address);
+        });
+    }
+    if(cancelled > 0)
+    {
+        HMLog(HM_LOG_INFO, "[EVENT] Cancelled %llu health check timeouts for checks removed by the reload", cancelled);
     }
 }
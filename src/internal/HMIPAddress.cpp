@@ -182,6 +182,47 @@ HMIPAddress::isSet() const
     return m_type != AF_UNSPEC;
 }
 
+bool
+HMIPAddress::isUnspecified() const
+{
+    if(m_type == AF_INET)
+    {
+        return m_ip.addr == INADDR_ANY;
+    }
+    else if(m_type == AF_INET6)
+    {
+        return IN6_IS_ADDR_UNSPECIFIED(&m_ip.addr6);
+    }
+    return false;
+}
+
+HMIPAddress
+HMIPAddress::getPrefix(uint32_t prefixLength) const
+{
+    HMIPAddress prefix = *this;
+    if(m_type == AF_INET)
+    {
+        if(prefixLength < 32)
+        {
+            uint32_t mask = prefixLength ? ~(uint32_t)0 << (32 - prefixLength) : 0;
+            prefix.m_ip.addr = m_ip.addr & htonl(mask);
+        }
+    }
+    else if(m_type == AF_INET6)
+    {
+        for(uint32_t i = 0; i < 16; i++)
+        {
+            if(prefixLength >= (i + 1) * 8)
+            {
+                continue;
+            }
+            uint32_t bits = (prefixLength > i * 8) ? prefixLength - i * 8 : 0;
+            prefix.m_ip.addr6.s6_addr[i] &= (uint8_t)(0xFF << (8 - bits));
+        }
+    }
+    return prefix;
+}
+
 uint8_t
 HMIPAddress::getType() const
 {
@@ -0,0 +1,270 @@
+// Copyright 2019, Oath Inc.
+// Licensed under the terms of the Apache 2.0 license. See LICENSE file in the root of the distribution for licensing details.
+#include <chrono>
+
+#include "HMKafkaPipeline.h"
+#include "HMTimeStamp.h"
+#include "HMLogBase.h"
+
+using namespace std;
+
+HMKafkaPipeline::HMKafkaPipeline(unique_ptr<HMKafkaProducer> producer, const HMKafkaPipelineConfig& config) :
+    m_producer(move(producer)),
+    m_config(config),
+    m_ring(config.m_queueSize),
+    m_keepRunning(false),
+    m_sleeping(false),
+    m_enqueued(0),
+    m_dropped(0),
+    m_produced(0),
+    m_retries(0),
+    m_delivered(0),
+    m_failed(0),
+    m_inFlight(0)
+{
+    if(m_config.m_batchSize == 0)
+    {
+        m_config.m_batchSize = 1;
+    }
+    if(m_producer)
+    {
+        m_producer->setDeliveryCallback(&HMKafkaPipeline::deliveryReport, this);
+    }
+}
+
+HMKafkaPipeline::~HMKafkaPipeline()
+{
+    shutDown();
+}
+
+bool
+HMKafkaPipeline::start()
+{
+    if(!m_producer)
+    {
+        HMLog(HM_LOG_CRITICAL, "[KAFKA] Invalid producer");
+        return false;
+    }
+    if(m_thread.joinable())
+    {
+        return true;
+    }
+    m_keepRunning = true;
+    m_thread = thread(&HMKafkaPipeline::run, this);
+    return true;
+}
+
+void
+HMKafkaPipeline::shutDown()
+{
+    {
+        lock_guard<mutex> lk(m_mutex);
+        m_keepRunning = false;
+        m_cond.notify_one();
+    }
+    if(m_thread.joinable())
+    {
+        m_thread.join();
+    }
+}
+
+bool
+HMKafkaPipeline::enqueue(unique_ptr<char[]> data, size_t datalen)
+{
+    if(!m_keepRunning)
+    {
+        m_dropped++;
+        HMLog(HM_LOG_DEBUG, "[KAFKA] Publisher not running, result dropped");
+        return false;
+    }
+
+    Message message(move(data), datalen);
+    if(m_ring.push(message))
+    {
+        m_enqueued++;
+        wake();
+        return true;
+    }
+
+    switch(m_config.m_dropPolicy)
+    {
+    case HM_PUBLISH_DROP_OLDEST:
+    {
+        Message oldest;
+        while(!m_ring.push(message))
+        {
+            if(m_ring.pop(oldest))
+            {
+                m_dropped++;
+            }
+        }
+        m_enqueued++;
+        wake();
+        HMLog(HM_LOG_DEBUG, "[KAFKA] Publisher queue full, oldest result dropped");
+        return true;
+    }
+    case HM_PUBLISH_BLOCK:
+    {
+        HMTimeStamp deadline = HMTimeStamp::now() + m_config.m_blockTimeout;
+        while(m_keepRunning && HMTimeStamp::now() < deadline)
+        {
+            wake();
+            this_thread::sleep_for(chrono::milliseconds(1));
+            if(m_ring.push(message))
+            {
+                m_enqueued++;
+                wake();
+                return true;
+            }
+        }
+        break;
+    }
+    case HM_PUBLISH_DROP_NEWEST:
+        break;
+    }
+
+    m_dropped++;
+    HMLog(HM_LOG_DEBUG, "[KAFKA] Publisher queue full, result dropped");
+    return false;
+}
+
+void
+HMKafkaPipeline::getStats(HMKafkaPipelineStats& stats) const
+{
+    stats.m_enqueued = m_enqueued;
+    stats.m_dropped = m_dropped;
+    stats.m_produced = m_produced;
+    stats.m_retries = m_retries;
+    stats.m_delivered = m_delivered;
+    stats.m_failed = m_failed;
+    stats.m_queued = m_ring.size();
+    stats.m_inFlight = m_inFlight;
+}
+
+const HMKafkaPipelineConfig&
+HMKafkaPipeline::getConfig() const
+{
+    return m_config;
+}
+
+void
+HMKafkaPipeline::run()
+{
+    HMLog(HM_LOG_INFO, "[KAFKA] Publisher thread started");
+    Message message;
+    while(true)
+    {
+        uint32_t count = 0;
+        while(count < m_config.m_batchSize && m_ring.pop(message))
+        {
+            produce(message);
+            count++;
+        }
+
+        m_producer->poll(0);
+
+        if(count > 0)
+        {
+            continue;
+        }
+
+        unique_lock<mutex> lk(m_mutex);
+        if(!m_keepRunning)
+        {
+            break;
+        }
+        // Wake up in time to serve the delivery reports of the results in flight
+        uint32_t timeout = (m_inFlight > 0) ? m_config.m_linger : HM_PUBLISH_IDLE_WAIT;
+        m_sleeping = true;
+        atomic_thread_fence(memory_order_seq_cst);
+        if(m_ring.empty())
+        {
+            m_cond.wait_for(lk, chrono::milliseconds(timeout ? timeout : 1));
+        }
+        m_sleeping = false;
+    }
+
+    // Produce whatever was queued before the shutdown
+    while(m_ring.pop(message))
+    {
+        produce(message);
+    }
+
+    if(!m_producer->flush(m_config.m_flushTimeout))
+    {
+        HMLog(HM_LOG_ERROR, "[KAFKA] %lu results not delivered on shutdown", m_inFlight.load());
+        m_producer->purge();
+    }
+    // The delivery reports free the buffers, so serve them all before the producer goes away
+    HMTimeStamp deadline = HMTimeStamp::now() + HM_PUBLISH_PURGE_TIMEOUT;
+    while(m_inFlight > 0 && HMTimeStamp::now() < deadline)
+    {
+        m_producer->poll(10);
+    }
+    if(m_inFlight > 0)
+    {
+        HMLog(HM_LOG_ERROR, "[KAFKA] %lu results still outstanding after the purge", m_inFlight.load());
+    }
+    HMLog(HM_LOG_INFO, "[KAFKA] Publisher thread stopped: %lu enqueued %lu dropped %lu delivered %lu failed",
+            m_enqueued.load(), m_dropped.load(), m_delivered.load(), m_failed.load());
+}
+
+bool
+HMKafkaPipeline::produce(Message& message)
+{
+    bool lastTry = false;
+    while(true)
+    {
+        HM_PUBLISH_PRODUCE_STATUS status = m_producer->produce(message.m_data.get(), message.m_size, message.m_data.get());
+        if(status == HM_PUBLISH_PRODUCE_OK)
+        {
+            // The buffer now belongs to the producer until its delivery report
+            m_inFlight++;
+            m_produced++;
+            message.m_data.release();
+            return true;
+        }
+        if(status != HM_PUBLISH_PRODUCE_QUEUE_FULL || lastTry)
+        {
+            break;
+        }
+        m_retries++;
+        // Serve the delivery reports to make room, the checks back up into the ring meanwhile
+        m_producer->poll(100);
+        // Don't hold up the shutdown on brokers that are not taking results
+        lastTry = !m_keepRunning;
+    }
+
+    m_failed++;
+    message.m_data.reset();
+    HMLog(HM_LOG_ERROR, "[KAFKA] Failed to produce result");
+    return false;
+}
+
+void
+HMKafkaPipeline::wake()
+{
+    // Pairs with the fence in run so either the thread sees the new result or we see it sleeping
+    atomic_thread_fence(memory_order_seq_cst);
+    if(m_sleeping)
+    {
+        lock_guard<mutex> lk(m_mutex);
+        m_cond.notify_one();
+    }
+}
+
+void
+HMKafkaPipeline::deliveryReport(void* opaque, bool delivered, void* arg)
+{
+    HMKafkaPipeline* pipeline = static_cast<HMKafkaPipeline*>(arg);
+    if(delivered)
+    {
+        pipeline->m_delivered++;
+    }
+    else
+    {
+        pipeline->m_failed++;
+    }
+    pipeline->m_inFlight--;
+    delete[] static_cast<char*>(opaque);
+}
@@ -8,7 +8,10 @@
 #include <signal.h>
 #include <sys/time.h>
 #include <sys/syscall.h>
+#include <time.h>
+#include <pthread.h>
 #include <algorithm>
+#include <chrono>
 
 #include "HMLogBase.h"
 
@@ -16,6 +19,57 @@ using namespace std;
 
 HMLogBase* hlog = nullptr;
 
+//! The format of the first line of the log.
+static const char* beginLoggingFormat = "Begin Logging";
+//! The format of the line replacing the dropped lines.
+static const char* droppedLogsFormat = "Max log queue length exceeded %d logs dropped";
+
+//! The source of the unique log ids.
+static atomic<uint64_t> nextLogId(1);
+static once_flag atForkFlag;
+
+// The ring and the cached thread id of the calling thread.
+class HMLogThreadState
+{
+public:
+    HMLogThreadState() :
+        m_logId(0),
+        m_tid(0) {};
+
+    //! The id of the log the ring is registered with.
+    uint64_t m_logId;
+    shared_ptr<HMLogRing> m_ring;
+    pid_t m_tid;
+};
+
+static thread_local HMLogThreadState threadLogState;
+
+// The forking thread is the only thread of the child and gets a new thread id.
+static void atForkChild()
+{
+    threadLogState.m_tid = 0;
+    threadLogState.m_logId = 0;
+}
+
+static pid_t getThreadId()
+{
+    if(threadLogState.m_tid == 0)
+    {
+        // Because of a glibc bug we have to use syscall
+        threadLogState.m_tid = syscall(SYS_gettid,0);
+    }
+    return threadLogState.m_tid;
+}
+
+// The log time only needs the resolution of the coarse clock, which is read without a system call.
+static void getCoarseTime(struct timeval& tv)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME_COARSE, &ts);
+    tv.tv_sec = ts.tv_sec;
+    tv.tv_usec = ts.tv_nsec / 1000;
+}
+
 static void usr1Handler(int s)
 {
     (void)s;
@@ -37,6 +91,7 @@ HMLogBase::initLogging(HM_LOG_LEVEL level, bool threaded)
     sigemptyset(&sigUsr1Handler.sa_mask);
     sigUsr1Handler.sa_flags = 0;
     sigaction(SIGUSR1, &sigUsr1Handler, NULL);
+    call_once(atForkFlag, [](){ pthread_atfork(nullptr, nullptr, atForkChild); });
     m_threaded = threaded;
     m_logLevel = level;
 
@@ -48,47 +103,26 @@ HMLogBase::initLogging(HM_LOG_LEVEL level, bool threaded)
         return false;
     }
 
-    LogEntry* entry;
-    entry = new LogEntry;
-    entry->entry = (char *)malloc(15);
-    if(entry->entry == nullptr)
-    {
-        //LCOV_EXCL_START
-        entry->entry = nullptr;
-        entry->length = 0;
-        entry->level = HM_LOG_NONE;
-        //LCOV_EXCL_STOP
-    }
-    else
+    m_id = nextLogId++;
+    m_droppedLogs = 0;
+    m_queued = 0;
     {
-        sprintf(entry->entry, "Begin Logging");
-        entry->length = 14;
-        entry->level = HM_LOG_NOTICE;
+        lock_guard<mutex> lk(m_ringMutex);
+        m_rings.clear();
     }
-    // Because of a glibc bug we have to use syscall
-    entry->tid = syscall(SYS_gettid,0);
-    gettimeofday(&entry->tv, NULL);
-    entry->ready = true;
-    entry->next = nullptr;
-    m_droppedLogs = 0;
     if (m_threaded)
     {
-        // init the log linked list
-        m_writeHead = entry;
-        m_readHead = m_writeHead;
         m_keepRunning = true;
 
         // start the logging thread
         m_thread = thread(&HMLogBase::flushBuffer, this);
-        m_current = 0;
-        m_last = 0;
-    }
-    else
-    {
-        writeLog(entry);
-        free(entry->entry);
-        delete entry;
     }
+
+    // The first line is written whatever the log level
+    char record[LOG_RECORD_STACK_SIZE];
+    uint32_t size = HMLogRecord::recordSize(beginLoggingFormat, false);
+    HMLogRecord::writeRecord(record, size, HM_LOG_NOTICE, beginLoggingFormat, false);
+    submitRecord(record, size);
     return true;
 }
 
@@ -107,7 +141,7 @@ HMLogBase::setMaxLogQueue(uint32_t max)
 void
 HMLogBase::shutDownLogging()
 {
-    if (m_threaded)
+    if (m_threaded && m_thread.joinable())
     {
         unique_lock<mutex> lock(m_dataReadyLock);
         m_keepRunning = false;
@@ -122,73 +156,133 @@ HMLogBase::shutDownLogging()
 void
 HMLogBase::log(HM_LOG_LEVEL level, const char* buf, ...)
 {
-    LogEntry* entry;
-    int ret;
+    char* line;
 
     if(level > m_logLevel)
     {
         return;
     }
 
-    if(m_threaded)
+    va_list args;
+    va_start(args,buf);
+    int ret = vasprintf(&line, buf, args);
+    va_end(args);
+    if(ret == -1)
     {
-        // Add an entry to the linked list
-        getEntry(entry);
+        return;//LCOV_EXCL_LINE
     }
-    else
+    logFormat(level, "%s", (const char*)line);
+    free(line);
+}
+
+void
+HMLogBase::submitRecord(char* record, uint32_t size)
+{
+    HMLogRecordHeader header;
+    HMLogRecord::readHeader(record, header);
+    header.m_tid = getThreadId();
+    getCoarseTime(header.m_tv);
+    memcpy(record, &header, sizeof(header));
+
+    if(!m_threaded)
     {
-        entry = new LogEntry;
+        string line;
+        writeRecord(record, line, nullptr);
+        return;
     }
-    // If this is null, then we are too big give up
-    if(entry == nullptr)
+
+    if(!m_keepRunning)
     {
         m_droppedLogs++;
         return;
     }
-
-    va_list args;
-    va_start(args,buf);
-
-    // check to see if we were dropping lines
-    if(m_droppedLogs.load() > 0)
+    if(m_queued.fetch_add(1) >= m_maxQueue)
     {
-        ret = asprintf(&(entry->entry), "Max log queue length exceeded %d logs dropped", m_droppedLogs.load() + 1);
-        m_droppedLogs = 0;
-        entry->length = ret;
-        entry->level = HM_LOG_WARNING;
+        m_queued--;
+        m_droppedLogs++;
+        return;
     }
-    // Format the log line string
-    else if((ret = vasprintf(&(entry->entry), buf, args)) == -1)
+
+    // check to see if we were dropping lines, the notice replaces this line which is counted as dropped
+    uint32_t dropped = 0;
+    char notice[LOG_RECORD_STACK_SIZE];
+    if(m_droppedLogs.load(memory_order_relaxed) > 0 && (dropped = m_droppedLogs.exchange(0)) > 0)
     {
-        //LCOV_EXCL_START
-        entry->entry = nullptr;
-        entry->length = 0;
-        entry->level = HM_LOG_NONE;
-        //LCOV_EXCL_STOP
+        size = HMLogRecord::recordSize(droppedLogsFormat, false, dropped + 1);
+        HMLogRecord::writeRecord(notice, size, HM_LOG_WARNING, droppedLogsFormat, false, dropped + 1);
+        HMLogRecordHeader noticeHeader;
+        HMLogRecord::readHeader(notice, noticeHeader);
+        noticeHeader.m_tid = header.m_tid;
+        noticeHeader.m_tv = header.m_tv;
+        memcpy(notice, &noticeHeader, sizeof(noticeHeader));
+        record = notice;
     }
-    else
+
+    if(!getThreadRing()->push(record, size))
     {
-        entry->length = ret;
-        entry->level = level;
+        m_queued--;
+        m_droppedLogs += dropped + 1;
+        return;
     }
-    va_end(args);
-    // Because of a glibc bug we have to use syscall
-    entry->tid = syscall(SYS_gettid,0);
-    gettimeofday(&entry->tv, NULL);
-    entry->ready = true;
 
-    if(m_threaded)
+    if(m_waiting)
     {
         // Signal the read thread that new data is ready
         lock_guard<mutex> lk(m_dataReadyLock);
         m_dataReadyCond.notify_one();
     }
+}
+
+HMLogRing*
+HMLogBase::getThreadRing()
+{
+    if(threadLogState.m_logId != m_id || !threadLogState.m_ring)
+    {
+        shared_ptr<HMLogRing> ring = make_shared<HMLogRing>(DEFAULT_LOG_RING_SIZE);
+        {
+            lock_guard<mutex> lk(m_ringMutex);
+            m_rings.push_back(ring);
+        }
+        threadLogState.m_ring = ring;
+        threadLogState.m_logId = m_id;
+    }
+    return threadLogState.m_ring.get();
+}
+
+void
+HMLogBase::writeRecord(const char* record, string& line, unordered_map<const char*, HMLogFormat>* formats)
+{
+    HMLogRecordHeader header;
+    HMLogRecord::readHeader(record, header);
+    const char* format;
+    const char* args = HMLogFormat::getArgs(record, header, format);
+    const char* end = record + header.m_size;
+
+    line.clear();
+    if(formats != nullptr && !header.m_inlineFormat)
+    {
+        auto it = formats->find(format);
+        if(it == formats->end())
+        {
+            it = formats->insert(make_pair(format, HMLogFormat())).first;
+            it->second.parse(format);
+        }
+        it->second.format(args, end, header.m_nArgs, line);
+    }
     else
     {
-        writeLog(entry);
-        free(entry->entry);
-        delete entry;
+        HMLogFormat parsed;
+        parsed.parse(format);
+        parsed.format(args, end, header.m_nArgs, line);
     }
+
+    LogEntry entry;
+    entry.entry = const_cast<char*>(line.c_str());
+    entry.length = line.size();
+    entry.level = (HM_LOG_LEVEL)header.m_level;
+    entry.tid = header.m_tid;
+    entry.tv = header.m_tv;
+    writeLog(&entry);
 }
 
 HM_LOG_LEVEL
@@ -310,80 +404,77 @@ HMLogBase::unsetAsDefaultLogger()
 }
 
 void
-HMLogBase::getEntry(struct LogEntry*& entry)
+HMLogBase::drainRings(vector<char>& records, vector<size_t>& offsets)
 {
-    // Spin lock since logging should grab a new entry quickly
-    // Note we can do some pre-allocation if this becomes very slow
-    HMLockGuard<HMUtilitySpinLock> lg(m_spinLock);
-
-    if(m_last > m_current && (m_last - m_current) > m_maxQueue)
+    lock_guard<mutex> lk(m_ringMutex);
+    for(auto it = m_rings.begin(); it != m_rings.end();)
     {
-        entry = nullptr;
-        return;
-    }
-
-    if(!m_keepRunning)
-    {
-        entry = nullptr;
-        return;
+        HMLogRing* ring = it->get();
+        size_t offset = records.size();
+        while(ring->pop(records))
+        {
+            offsets.push_back(offset);
+            offset = records.size();
+        }
+        // Release the rings of the threads that exited once they are drained
+        if(it->use_count() == 1 && ring->empty())
+        {
+            it = m_rings.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
     }
-    m_writeHead->next = new LogEntry;
-    entry = m_writeHead->next;
-    m_writeHead = m_writeHead->next;
-    m_writeHead->ready = false;
-    m_writeHead->next = nullptr;
-    m_last++;
 }
 
-
 void
 HMLogBase::flushBuffer()
 {
-    unique_lock<mutex> lk(m_dataReadyLock, defer_lock);
-    LogEntry* entry;
+    unordered_map<const char*, HMLogFormat> formats;
+    vector<char> records;
+    vector<size_t> offsets;
+    vector<pair<uint64_t, size_t>> order;
+    string line;
 
-    while(m_keepRunning || m_readHead != m_writeHead)
+    while(true)
     {
-        while(m_readHead != m_writeHead)
-        {
-            entry = m_readHead;
+        bool keepRunning = m_keepRunning;
+        records.clear();
+        offsets.clear();
+        drainRings(records, offsets);
 
-            // Wait for the write to be complete if we are caught up
-            if(!entry->ready)
+        if(offsets.empty())
+        {
+            if(!keepRunning)
             {
-                continue;//LCOV_EXCL_LINE
+                break;
             }
-
-            m_current++;
-
-            writeLog(entry);
-
-            m_readHead = m_readHead->next;
-            free(entry->entry);
-            delete entry;
+            // wait for new data
+            unique_lock<mutex> lk(m_dataReadyLock);
+            m_waiting = true;
+            if(m_queued == 0 && m_keepRunning)
+            {
+                m_dataReadyCond.wait_for(lk, chrono::milliseconds(DEFAULT_LOG_FLUSH_INTERVAL));
+            }
+            m_waiting = false;
+            continue;
         }
 
-
-        // wait for new data
-        lk.lock();
-        m_dataReadyCond.wait(lk, [this](){return m_readHead != m_writeHead || !m_keepRunning;});
-        lk.unlock();
-    }
-
-    HMLockGuard<HMUtilitySpinLock> lg(m_spinLock);
-    while (m_readHead != nullptr)
-    {
-        // write the last entry
-        entry = m_readHead;
-
-        // Wait for the write to be complete if we are caught up
-        if(entry->ready)
+        // Interleave the records of the threads in time order
+        order.clear();
+        for(auto offset : offsets)
+        {
+            HMLogRecordHeader header;
+            HMLogRecord::readHeader(&records[offset], header);
+            order.push_back(make_pair(header.m_tv.tv_sec * 1000000ULL + header.m_tv.tv_usec, offset));
+        }
+        stable_sort(order.begin(), order.end(),
+                [](const pair<uint64_t, size_t>& a, const pair<uint64_t, size_t>& b){ return a.first < b.first; });
+        for(auto& it : order)
         {
-            m_current++;
-            writeLog(entry);
+            writeRecord(&records[it.second], line, &formats);
         }
-        m_readHead = m_readHead->next;
-        free(entry->entry);
-        delete entry;
+        m_queued -= offsets.size();
     }
 }
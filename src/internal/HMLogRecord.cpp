@@ -0,0 +1,345 @@
+// Copyright 2019, Oath Inc.
+// Licensed under the terms of the Apache 2.0 license. See LICENSE file in the root of the distribution for licensing details.
+#include <stdio.h>
+#include <ctype.h>
+#include <algorithm>
+
+#include "HMLogRecord.h"
+
+using namespace std;
+
+//! The size of the buffer used to format a single conversion.
+#define LOG_CONVERSION_BUFFER 128
+
+// An argument read back from a record.
+class HMLogArg
+{
+public:
+    HMLogArg() :
+        m_type(HM_LOG_ARG_INT),
+        m_int(0),
+        m_double(0),
+        m_string(nullptr),
+        m_valid(false) {};
+
+    HM_LOG_ARG_TYPE m_type;
+    uint64_t m_int;
+    double m_double;
+    const char* m_string;
+    bool m_valid;
+};
+
+static const char*
+readArg(const char* pos, const char* end, HMLogArg& arg)
+{
+    if(pos >= end)
+    {
+        arg.m_valid = false;
+        return pos;
+    }
+    arg.m_valid = true;
+    arg.m_type = (HM_LOG_ARG_TYPE)*pos++;
+    switch(arg.m_type)
+    {
+    case HM_LOG_ARG_STRING:
+    {
+        uint32_t len;
+        memcpy(&len, pos, sizeof(len));
+        arg.m_string = pos + sizeof(len);
+        return arg.m_string + len + 1;
+    }
+    case HM_LOG_ARG_DOUBLE:
+        memcpy(&arg.m_double, pos, sizeof(arg.m_double));
+        return pos + sizeof(arg.m_double);
+    default:
+        memcpy(&arg.m_int, pos, sizeof(arg.m_int));
+        return pos + sizeof(arg.m_int);
+    }
+}
+
+static int64_t
+argToInt(const HMLogArg& arg)
+{
+    switch(arg.m_type)
+    {
+    case HM_LOG_ARG_DOUBLE:
+        return (int64_t)arg.m_double;
+    case HM_LOG_ARG_STRING:
+        return 0;
+    default:
+        return (int64_t)arg.m_int;
+    }
+}
+
+void
+HMLogFormat::parse(const char* format)
+{
+    m_segments.clear();
+    Segment segment;
+    const char* pos = format;
+    while(*pos)
+    {
+        if(*pos != '%')
+        {
+            segment.m_literal += *pos++;
+            continue;
+        }
+        if(pos[1] == '%')
+        {
+            segment.m_literal += '%';
+            pos += 2;
+            continue;
+        }
+        const char* start = pos++;
+        while(*pos && strchr("-+ #0'", *pos))
+        {
+            pos++;
+        }
+        while(*pos && (isdigit(*pos) || *pos == '*' || *pos == '.'))
+        {
+            if(*pos == '*')
+            {
+                segment.m_stars++;
+            }
+            pos++;
+        }
+        if(*pos == 'h')
+        {
+            segment.m_length = (pos[1] == 'h') ? 'H' : 'h';
+            pos += (pos[1] == 'h') ? 2 : 1;
+        }
+        else if(*pos == 'l')
+        {
+            segment.m_length = (pos[1] == 'l') ? 'L' : 'l';
+            pos += (pos[1] == 'l') ? 2 : 1;
+        }
+        else if(*pos == 'j' || *pos == 'q')
+        {
+            segment.m_length = 'L';
+            pos++;
+        }
+        else if(*pos == 'z' || *pos == 't')
+        {
+            segment.m_length = *pos++;
+        }
+        else if(*pos == 'L')
+        {
+            segment.m_length = 'D';
+            pos++;
+        }
+        if(*pos == 0)
+        {
+            // A truncated conversion is printed as is
+            segment.m_literal.append(start, pos - start);
+            segment.m_stars = 0;
+            segment.m_length = 0;
+            break;
+        }
+        segment.m_conversion = *pos++;
+        segment.m_spec.assign(start, pos - start);
+        m_segments.push_back(segment);
+        segment = Segment();
+    }
+    if(!segment.m_literal.empty() || m_segments.empty())
+    {
+        m_segments.push_back(segment);
+    }
+}
+
+void
+HMLogFormat::format(const char* args, const char* end, uint32_t nArgs, string& out) const
+{
+    char buf[LOG_CONVERSION_BUFFER];
+    const char* pos = args;
+    uint32_t used = 0;
+    HMLogArg arg;
+    for(auto& segment : m_segments)
+    {
+        out += segment.m_literal;
+        if(segment.m_spec.empty())
+        {
+            continue;
+        }
+
+        // Resolve the * width and precision from the arguments
+        string starSpec;
+        const char* spec = segment.m_spec.c_str();
+        if(segment.m_stars > 0)
+        {
+            for(char c : segment.m_spec)
+            {
+                if(c == '*')
+                {
+                    arg.m_valid = false;
+                    if(used < nArgs)
+                    {
+                        pos = readArg(pos, end, arg);
+                        used++;
+                    }
+                    starSpec += to_string(arg.m_valid ? argToInt(arg) : 0);
+                }
+                else
+                {
+                    starSpec += c;
+                }
+            }
+            spec = starSpec.c_str();
+        }
+
+        arg.m_valid = false;
+        if(segment.m_conversion != 'n' && used < nArgs)
+        {
+            pos = readArg(pos, end, arg);
+            used++;
+        }
+        if(!arg.m_valid)
+        {
+            if(segment.m_conversion != 'n')
+            {
+                out += "(missing)";
+            }
+            continue;
+        }
+
+        int len = 0;
+        switch(segment.m_conversion)
+        {
+        case 's':
+            if(arg.m_type != HM_LOG_ARG_STRING)
+            {
+                len = snprintf(buf, sizeof(buf), "%" PRId64, argToInt(arg));
+            }
+            else if(segment.m_spec.size() == 2)
+            {
+                out += arg.m_string;
+                continue;
+            }
+            else
+            {
+                len = snprintf(buf, sizeof(buf), spec, arg.m_string);
+                if(len >= (int)sizeof(buf))
+                {
+                    size_t offset = out.size();
+                    out.resize(offset + len + 1);
+                    snprintf(&out[offset], len + 1, spec, arg.m_string);
+                    out.resize(offset + len);
+                    continue;
+                }
+            }
+            break;
+        case 'd':
+        case 'i':
+        case 'c':
+        {
+            int64_t value = argToInt(arg);
+            switch(segment.m_length)
+            {
+            case 'H':
+                len = snprintf(buf, sizeof(buf), spec, (signed char)value);
+                break;
+            case 'h':
+                len = snprintf(buf, sizeof(buf), spec, (short)value);
+                break;
+            case 'l':
+                len = snprintf(buf, sizeof(buf), spec, (long)value);
+                break;
+            case 'L':
+                len = snprintf(buf, sizeof(buf), spec, (long long)value);
+                break;
+            case 'z':
+                len = snprintf(buf, sizeof(buf), spec, (ssize_t)value);
+                break;
+            case 't':
+                len = snprintf(buf, sizeof(buf), spec, (ptrdiff_t)value);
+                break;
+            default:
+                len = snprintf(buf, sizeof(buf), spec, (int)value);
+                break;
+            }
+            break;
+        }
+        case 'u':
+        case 'o':
+        case 'x':
+        case 'X':
+        {
+            uint64_t value = (uint64_t)argToInt(arg);
+            switch(segment.m_length)
+            {
+            case 'H':
+                len = snprintf(buf, sizeof(buf), spec, (unsigned char)value);
+                break;
+            case 'h':
+                len = snprintf(buf, sizeof(buf), spec, (unsigned short)value);
+                break;
+            case 'l':
+                len = snprintf(buf, sizeof(buf), spec, (unsigned long)value);
+                break;
+            case 'L':
+                len = snprintf(buf, sizeof(buf), spec, (unsigned long long)value);
+                break;
+            case 'z':
+            case 't':
+                len = snprintf(buf, sizeof(buf), spec, (size_t)value);
+                break;
+            default:
+                len = snprintf(buf, sizeof(buf), spec, (unsigned int)value);
+                break;
+            }
+            break;
+        }
+        case 'f':
+        case 'F':
+        case 'e':
+        case 'E':
+        case 'g':
+        case 'G':
+        case 'a':
+        case 'A':
+        {
+            double value = (arg.m_type == HM_LOG_ARG_DOUBLE) ? arg.m_double :
+                    (arg.m_type == HM_LOG_ARG_UINT) ? (double)arg.m_int : (double)argToInt(arg);
+            if(segment.m_length == 'D')
+            {
+                len = snprintf(buf, sizeof(buf), spec, (long double)value);
+            }
+            else
+            {
+                len = snprintf(buf, sizeof(buf), spec, value);
+            }
+            break;
+        }
+        case 'p':
+            len = snprintf(buf, sizeof(buf), spec, (void*)(uintptr_t)arg.m_int);
+            break;
+        default:
+            // Unknown conversions are printed as is
+            out += segment.m_spec;
+            continue;
+        }
+        if(arg.m_type == HM_LOG_ARG_STRING && segment.m_conversion != 's')
+        {
+            out += arg.m_string;
+            continue;
+        }
+        if(len > 0)
+        {
+            out.append(buf, min(len, (int)sizeof(buf) - 1));
+        }
+    }
+}
+
+const char*
+HMLogFormat::getArgs(const char* record, const HMLogRecordHeader& header, const char*& format)
+{
+    const char* pos = record + sizeof(HMLogRecordHeader);
+    if(header.m_inlineFormat)
+    {
+        uint32_t len;
+        memcpy(&len, pos, sizeof(len));
+        format = pos + sizeof(len);
+        return format + len + 1;
+    }
+    format = header.m_format;
+    return pos;
+}
@@ -0,0 +1,82 @@
+// Copyright 2019, Oath Inc.
+// Licensed under the terms of the Apache 2.0 license. See LICENSE file in the root of the distribution for licensing details.
+#include <string.h>
+
+#include "HMLogRing.h"
+
+using namespace std;
+
+HMLogRing::HMLogRing(uint32_t capacity) :
+    m_head(0),
+    m_tail(0)
+{
+    uint64_t size = 64;
+    while(size < capacity)
+    {
+        size <<= 1;
+    }
+    m_mask = size - 1;
+    m_buffer.reset(new char[size]);
+}
+
+void
+HMLogRing::copyIn(uint64_t pos, const char* data, uint32_t size)
+{
+    uint64_t offset = pos & m_mask;
+    uint64_t first = min((uint64_t)size, m_mask + 1 - offset);
+    memcpy(&m_buffer[offset], data, first);
+    if(first < size)
+    {
+        memcpy(&m_buffer[0], data + first, size - first);
+    }
+}
+
+void
+HMLogRing::copyOut(uint64_t pos, char* data, uint32_t size) const
+{
+    uint64_t offset = pos & m_mask;
+    uint64_t first = min((uint64_t)size, m_mask + 1 - offset);
+    memcpy(data, &m_buffer[offset], first);
+    if(first < size)
+    {
+        memcpy(data + first, &m_buffer[0], size - first);
+    }
+}
+
+bool
+HMLogRing::push(const char* record, uint32_t size)
+{
+    uint64_t head = m_head.load(memory_order_relaxed);
+    uint64_t tail = m_tail.load(memory_order_acquire);
+    if(size < sizeof(uint32_t) || head - tail + size > m_mask + 1)
+    {
+        return false;
+    }
+    copyIn(head, record, size);
+    m_head.store(head + size, memory_order_release);
+    return true;
+}
+
+bool
+HMLogRing::pop(vector<char>& out)
+{
+    uint64_t tail = m_tail.load(memory_order_relaxed);
+    uint64_t head = m_head.load(memory_order_acquire);
+    if(head == tail)
+    {
+        return false;
+    }
+    uint32_t size;
+    copyOut(tail, (char*)&size, sizeof(size));
+    size_t offset = out.size();
+    out.resize(offset + size);
+    copyOut(tail, &out[offset], size);
+    m_tail.store(tail + size, memory_order_release);
+    return true;
+}
+
+bool
+HMLogRing::empty() const
+{
+    return m_head.load(memory_order_acquire) == m_tail.load(memory_order_acquire);
+}
@@ -0,0 +1,96 @@
+// Copyright 2019, Oath Inc.
+// Licensed under the terms of the Apache 2.0 license. See LICENSE file in the root of the distribution for licensing details.
+#include "HMMonotonicTime.h"
+
+using namespace std;
+
+atomic<HMFakeClock*> HMMonotonicTime::m_fakeClock(nullptr);
+
+HMMonotonicTime
+HMMonotonicTime::now()
+{
+    HMFakeClock* fakeClock = m_fakeClock.load(memory_order_relaxed);
+    if(fakeClock != nullptr)
+    {
+        return HMMonotonicTime(fakeClock->now());
+    }
+    return HMMonotonicTime(chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+uint64_t
+HMMonotonicTime::getMillisecondsFromNow() const
+{
+    uint64_t micros = microsecondsSince(HMMonotonicTime::now());
+    return (micros + 999) / 1000;
+}
+
+struct timeval
+HMMonotonicTime::getTimeout() const
+{
+    uint64_t micros = microsecondsSince(HMMonotonicTime::now());
+    return { (time_t)(micros / 1000000), (suseconds_t)(micros % 1000000) };
+}
+
+HMTimeStamp
+HMMonotonicTime::toWallClock() const
+{
+    if(!isSet())
+    {
+        return HMTimeStamp();
+    }
+    HMMonotonicTime now = HMMonotonicTime::now();
+    HMTimeStamp wallNow = HMTimeStamp::now();
+    if(m_time > now.m_time)
+    {
+        return wallNow + (m_time - now.m_time) / 1000;
+    }
+    return wallNow - (now.m_time - m_time) / 1000;
+}
+
+HMMonotonicTime
+HMMonotonicTime::fromWallClock(const HMTimeStamp& timeStamp)
+{
+    if(timeStamp.getTimeSinceEpoch() == 0)
+    {
+        return HMMonotonicTime();
+    }
+    HMMonotonicTime now = HMMonotonicTime::now();
+    HMTimeStamp wallNow = HMTimeStamp::now();
+    if(wallNow < timeStamp)
+    {
+        return now + (timeStamp - wallNow);
+    }
+    uint64_t age = (wallNow - timeStamp) * 1000;
+    // Times older than the start of the clock are clamped to its start, they are only ever used as long past
+    return HMMonotonicTime((age < now.m_time) ? now.m_time - age : 1);
+}
+
+void
+HMMonotonicTime::setFakeClock(HMFakeClock* clock)
+{
+    m_fakeClock = clock;
+}
+
+HMMonotonicTime
+operator + (const HMMonotonicTime& ts, uint64_t offset)
+{
+    return HMMonotonicTime(ts.m_time + offset * 1000);
+}
+
+HMMonotonicTime
+operator + (uint64_t offset, const HMMonotonicTime& ts)
+{
+    return HMMonotonicTime(ts.m_time + offset * 1000);
+}
+
+HMMonotonicTime
+operator - (const HMMonotonicTime& ts, uint64_t offset)
+{
+    return HMMonotonicTime((ts.m_time > offset * 1000) ? ts.m_time - offset * 1000 : 0);
+}
+
+uint64_t
+operator - (const HMMonotonicTime& ts1, const HMMonotonicTime& ts2)
+{
+    return (int64_t)(ts1.m_time - ts2.m_time) / 1000;
+}
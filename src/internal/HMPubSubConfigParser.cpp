@@ -146,6 +146,84 @@ HMPubSubConfigParser::parseConfig(const string& fileName, HMState& checkState)
                 }
                 config.brokers += val;
             }
+            if (kafkaNode["queuesize"])
+            {
+                int value = atoi(kafkaNode["queuesize"].Scalar().c_str());
+                if (value > 0)
+                {
+                    config.pipeline.m_queueSize = value;
+                }
+                else
+                {
+                    nerr++;
+                    HMLog(HM_LOG_ERROR, "%s(%d): Invalid kafka queue size %s",
+                            fileName.c_str(), kafkaNode["queuesize"].Mark().line, kafkaNode["queuesize"].Scalar().c_str());
+                }
+            }
+            if (kafkaNode["batchsize"])
+            {
+                int value = atoi(kafkaNode["batchsize"].Scalar().c_str());
+                if (value > 0)
+                {
+                    config.pipeline.m_batchSize = value;
+                }
+                else
+                {
+                    nerr++;
+                    HMLog(HM_LOG_ERROR, "%s(%d): Invalid kafka batch size %s",
+                            fileName.c_str(), kafkaNode["batchsize"].Mark().line, kafkaNode["batchsize"].Scalar().c_str());
+                }
+            }
+            if (kafkaNode["linger"])
+            {
+                int value = atoi(kafkaNode["linger"].Scalar().c_str());
+                if (value >= 0)
+                {
+                    config.pipeline.m_linger = value;
+                }
+                else
+                {
+                    nerr++;
+                    HMLog(HM_LOG_ERROR, "%s(%d): Invalid kafka linger %s",
+                            fileName.c_str(), kafkaNode["linger"].Mark().line, kafkaNode["linger"].Scalar().c_str());
+                }
+            }
+            if (kafkaNode["blocktimeout"])
+            {
+                int value = atoi(kafkaNode["blocktimeout"].Scalar().c_str());
+                if (value >= 0)
+                {
+                    config.pipeline.m_blockTimeout = value;
+                }
+                else
+                {
+                    nerr++;
+                    HMLog(HM_LOG_ERROR, "%s(%d): Invalid kafka block timeout %s",
+                            fileName.c_str(), kafkaNode["blocktimeout"].Mark().line, kafkaNode["blocktimeout"].Scalar().c_str());
+                }
+            }
+            if (kafkaNode["droppolicy"])
+            {
+                val = kafkaNode["droppolicy"].Scalar();
+                if (val == "newest")
+                {
+                    config.pipeline.m_dropPolicy = HM_PUBLISH_DROP_NEWEST;
+                }
+                else if (val == "oldest")
+                {
+                    config.pipeline.m_dropPolicy = HM_PUBLISH_DROP_OLDEST;
+                }
+                else if (val == "block")
+                {
+                    config.pipeline.m_dropPolicy = HM_PUBLISH_BLOCK;
+                }
+                else
+                {
+                    nerr++;
+                    HMLog(HM_LOG_ERROR, "%s(%d): Invalid kafka drop policy %s",
+                            fileName.c_str(), kafkaNode["droppolicy"].Mark().line, val.c_str());
+                }
+            }
             publisher = make_unique<HMPublisherKafka>(config, topic);
 #else
             HMLog(HM_LOG_ERROR, "%s(%d): Error: Kafka module disabled during build",
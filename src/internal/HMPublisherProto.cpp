@@ -15,5 +15,5 @@ HMPublisherProto::publish(const string& hostName, const HMDataCheckResult& dataC
         HMPubSubDataPacking dataPacking;
         uint64_t buflen;
         unique_ptr<char[]> data = dataPacking.packPublishResults(hostName, mark, hostGroups, dataCheckResult, buflen);
-        publish(data.get(), buflen);
+        publish(move(data), buflen);
 }
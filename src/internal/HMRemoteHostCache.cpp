@@ -68,12 +68,12 @@ HMRemoteHostCache::checkNeeded(const string& name, const HMDataHostCheck& dataHo
     HM_SCHEDULE_STATE result = HM_SCHEDULE_EVENT;
     bool alreadyScheduled = true;
     bool isCheckTimeChanged = false;
-    HMTimeStamp nextCheck = HMTimeStamp::now() + HMTimeStamp::HOURINMS;
+    HMMonotonicTime nextCheck = HMMonotonicTime::now() + HMTimeStamp::HOURINMS;
     auto key = make_pair(name, dataHostCheck);
     auto ret = m_cache.find(key);
     if(ret != m_cache.end())
     {
-        HMTimeStamp checkTime = ret->second.nextCheckTime();
+        HMMonotonicTime checkTime = ret->second.nextCheckTime();
         HM_WORK_STATE query_state = ret->second.getCheckState();
         if ((query_state == HM_CHECK_FAILED)
                 || (query_state == HM_CHECK_INACTIVE))
@@ -96,14 +96,14 @@ HMRemoteHostCache::checkNeeded(const string& name, const HMDataHostCheck& dataHo
     {
         result = HM_SCHEDULE_IGNORE;
     }
-    if (nextCheck <= HMTimeStamp::now())
+    if (nextCheck <= HMMonotonicTime::now())
     {
         result = HM_SCHEDULE_WORK;
     }
     return result;
 }
 
-HMTimeStamp
+HMMonotonicTime
 HMRemoteHostCache::nextCheckTime(const string& name, const HMDataHostCheck& dataHostCheck) const
 {
     auto key = make_pair(name, dataHostCheck);
@@ -113,7 +113,7 @@ HMRemoteHostCache::nextCheckTime(const string& name, const HMDataHostCheck& data
         HMLog(HM_LOG_ERROR,
                         "Missing remote entry in cache in function nextCheckTime for host %s",
                         name.c_str());
-        return HMTimeStamp::now() + HMTimeStamp::HOURINMS;
+        return HMMonotonicTime::now() + HMTimeStamp::HOURINMS;
     }
     return it->second.nextCheckTime();
 }
@@ -163,8 +163,8 @@ HMRemoteHostCache::queueRemoteCheck(string name, const HMDataHostCheck& dataHost
             HMLog(HM_LOG_ERROR, "% remote check type currently not supported", printRemoteCheckType(dataHostCheck.getRemoteCheckType()));
             return false;
     }
-    remotelookup->m_start = HMTimeStamp::now();
-    remotelookup->m_end = HMTimeStamp::now() + it->second.getCheckTTL();
+    remotelookup->m_start = HMMonotonicTime::now();
+    remotelookup->m_end = HMMonotonicTime::now() + it->second.getCheckTTL();
     it->second.queueCheck();
     queue.insertWork(remotelookup);
     return true;
@@ -199,14 +199,14 @@ HMRemoteHostCache::queueRemoteLookups(HMWorkQueue& queue, HMEventLoop& eventLoop
                     continue;
 
             }
-            remotelookup->m_start = HMTimeStamp::now();
-            remotelookup->m_end = HMTimeStamp::now() + it->second.getCheckTTL();
+            remotelookup->m_start = HMMonotonicTime::now();
+            remotelookup->m_end = HMMonotonicTime::now() + it->second.getCheckTTL();
             it->second.queueCheck();
             queue.insertWork(remotelookup);
         }
         else if(restart && (state == HM_SCHEDULE_IGNORE))
         {
-            HMTimeStamp checkTime = nextCheckTime(it->first.first, it->first.second);
+            HMMonotonicTime checkTime = nextCheckTime(it->first.first, it->first.second);
             eventLoop.addRemoteHostTimeout(it->first.first, it->first.second, checkTime);
         }
     }
@@ -70,12 +70,12 @@ HMRemoteHostGroupCache::checkNeeded(const string& name) const
     HM_SCHEDULE_STATE result = HM_SCHEDULE_EVENT;
     bool alreadyScheduled = true;
     bool isCheckTimeChanged = false;
-    HMTimeStamp nextCheck = HMTimeStamp::now() + HMTimeStamp::HOURINMS;
+    HMMonotonicTime nextCheck = HMMonotonicTime::now() + HMTimeStamp::HOURINMS;
     auto key = name;
     auto ret = m_cache.find(key);
     if(ret != m_cache.end())
     {
-        HMTimeStamp checkTime = ret->second.nextCheckTime();
+        HMMonotonicTime checkTime = ret->second.nextCheckTime();
         HM_WORK_STATE query_state = ret->second.getCheckState();
         if ((query_state == HM_CHECK_FAILED)
                 || (query_state == HM_CHECK_INACTIVE))
@@ -98,14 +98,14 @@ HMRemoteHostGroupCache::checkNeeded(const string& name) const
     {
         result = HM_SCHEDULE_IGNORE;
     }
-    if (nextCheck <= HMTimeStamp::now())
+    if (nextCheck <= HMMonotonicTime::now())
     {
         result = HM_SCHEDULE_WORK;
     }
     return result;
 }
 
-HMTimeStamp
+HMMonotonicTime
 HMRemoteHostGroupCache::nextCheckTime(const string& name) const
 {
     auto key = name;
@@ -115,7 +115,7 @@ HMRemoteHostGroupCache::nextCheckTime(const string& name) const
         HMLog(HM_LOG_ERROR,
                         "Missing remote entry in cache in function nextCheckTime for hostgroup %s",
                         name.c_str());
-        return HMTimeStamp::now() + HMTimeStamp::HOURINMS;
+        return HMMonotonicTime::now() + HMTimeStamp::HOURINMS;
     }
     return it->second.nextCheckTime();
 }
@@ -175,8 +175,8 @@ HMRemoteHostGroupCache::queueRemoteCheck(string name, HMWorkQueue& queue, const
             HMLog(HM_LOG_ERROR, "% remote check type currently not supported", printRemoteCheckType(hostGroupIt->second.getRemoteCheckType()));
             return false;
     }
-    remotelookup->m_start = HMTimeStamp::now();
-    remotelookup->m_end = HMTimeStamp::now() + it->second.getCheckTTL();
+    remotelookup->m_start = HMMonotonicTime::now();
+    remotelookup->m_end = HMMonotonicTime::now() + it->second.getCheckTTL();
     it->second.queueCheck();
     queue.insertWork(remotelookup);
     return true;
@@ -221,14 +221,14 @@ HMRemoteHostGroupCache::queueRemoteLookups(HMWorkQueue& queue, HMEventLoop& even
                     continue;
 
             }
-            remotelookup->m_start = HMTimeStamp::now();
-            remotelookup->m_end = HMTimeStamp::now() + it->second.getCheckTTL();
+            remotelookup->m_start = HMMonotonicTime::now();
+            remotelookup->m_end = HMMonotonicTime::now() + it->second.getCheckTTL();
             it->second.queueCheck();
             queue.insertWork(remotelookup);
         }
         else if(restart && (state == HM_SCHEDULE_IGNORE))
         {
-            HMTimeStamp checkTime = nextCheckTime(it->first);
+            HMMonotonicTime checkTime = nextCheckTime(it->first);
             eventLoop.addRemoteTimeout(it->first, checkTime);
         }
     }
@@ -249,3 +249,25 @@ HMRemoteHostGroupCache::updateResultTime(const string& name, const HMTimeStamp&
     }
     it->second.setResultTime(resultTime);
 }
+
+bool
+HMRemoteHostGroupCache::getSubscription(const string& name, HMIPAddress& peer, uint64_t& epoch, uint64_t& sequence) const
+{
+    auto it = m_cache.find(name);
+    if(it == m_cache.end())
+    {
+        return false;
+    }
+    it->second.getSubscription(peer, epoch, sequence);
+    return true;
+}
+
+void
+HMRemoteHostGroupCache::setSubscription(const string& name, const HMIPAddress& peer, uint64_t epoch, uint64_t sequence)
+{
+    auto it = m_cache.find(name);
+    if(it != m_cache.end())
+    {
+        it->second.setSubscription(peer, epoch, sequence);
+    }
+}
@@ -23,12 +23,12 @@ HMRemoteResult::queueCheck()
     m_checkState = HM_CHECK_QUEUED;
 }
 
-HMTimeStamp
+HMMonotonicTime
 HMRemoteResult::startCheck()
 {
     lock_guard<shared_timed_mutex> lock(m_resultLock);
     m_checkState = HM_CHECK_IN_PROGRESS;
-    m_checkTime = HMTimeStamp::now() + m_remoteTimeout;
+    m_checkTime = HMMonotonicTime::now() + m_remoteTimeout;
     return m_checkTime;
 }
 
@@ -38,28 +38,29 @@ HMRemoteResult::finishCheck(bool success)
     lock_guard<shared_timed_mutex> lock(m_resultLock);
     m_checkState = success?HM_CHECK_INACTIVE:HM_CHECK_FAILED;
     m_resultTime = HMTimeStamp::now();
+    m_lastResult = HMMonotonicTime::now();
 }
 
 bool
 HMRemoteResult::checkNeeded() const
 {
-    return (nextCheckTime() <= HMTimeStamp::now());
+    return (nextCheckTime() <= HMMonotonicTime::now());
 }
 
-HMTimeStamp
+HMMonotonicTime
 HMRemoteResult::nextCheckTime() const
 {
     lock_guard<shared_timed_mutex> lock(m_resultLock);
-    HMTimeStamp now = HMTimeStamp::now();
+    HMMonotonicTime now = HMMonotonicTime::now();
     if(m_checkState == HM_CHECK_INACTIVE)
     {
-        if((m_resultTime + m_remoteTTL) < now)
+        if((m_lastResult + m_remoteTTL) < now)
         {
             return now;
         }
         else
         {
-            return m_resultTime + m_remoteTTL;
+            return m_lastResult + m_remoteTTL;
         }
     }
     else if(m_checkState == HM_CHECK_IN_PROGRESS)
@@ -75,7 +76,7 @@ HMRemoteResult::nextCheckTime() const
     }
     else if(m_checkState == HM_CHECK_FAILED)
     {
-        return m_resultTime + m_remoteTTL;
+        return m_lastResult + m_remoteTTL;
     }
     // return something really high since the check is in progress
     return now + HMTimeStamp::HOURINMS;
@@ -103,5 +104,24 @@ void
 HMRemoteResult::setResultTime(const HMTimeStamp& resultTime)
 {
     m_resultTime = resultTime;
+    m_lastResult = HMMonotonicTime::fromWallClock(resultTime);
+}
+
+void
+HMRemoteResult::getSubscription(HMIPAddress& peer, uint64_t& epoch, uint64_t& sequence) const
+{
+    shared_lock<shared_timed_mutex> lock(m_resultLock);
+    peer = m_subscribePeer;
+    epoch = m_subscribeEpoch;
+    sequence = m_subscribeSequence;
+}
+
+void
+HMRemoteResult::setSubscription(const HMIPAddress& peer, uint64_t epoch, uint64_t sequence)
+{
+    lock_guard<shared_timed_mutex> lock(m_resultLock);
+    m_subscribePeer = peer;
+    m_subscribeEpoch = epoch;
+    m_subscribeSequence = sequence;
 }
 
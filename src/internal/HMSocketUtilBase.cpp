@@ -411,6 +411,54 @@ HMSocketUtilBase::getHostGroupResults(string& hostGroupName, timeval &tv, const
     return HM_SOCK_DATA_FAILED;
 }
 
+HM_SOCK_DATA_STATUS
+HMSocketUtilBase::getHostGroupDelta(string& hostGroupName, timeval &tv, const HMHash& hash, uint64_t& epoch,
+        uint64_t& sequence, bool& resync, vector<HMGroupCheckResult>& results)
+{
+    lock_guard<mutex> clock(m_mutex);
+    results.clear();
+    if (isConnectionReset() || (getReason() != HM_REASON_NONE && getReason() != HM_REASON_SUCCESS))
+    {
+        reconnect();
+    }
+    HMDataPacking dataPacking;
+    uint64_t dataSize;
+    std::unique_ptr<char[]> data = dataPacking.packHash(hostGroupName, hash, dataSize);
+    string cmd = std::to_string(HM_CONTROL_SOCKET_VERSION) + " "
+            + HM_CMD_HOSTGROUPDELTA + " " + hostGroupName + " " + to_string(epoch) + " "
+            + to_string(sequence) + " " + to_string(dataSize);
+    if (sendCommand(cmd))
+    {
+        if (sendData(data.get(), dataSize))
+        {
+            uint64_t packetSize = 0;
+            if (recvData((char*) &packetSize, sizeof(packetSize), tv) == HM_SOCK_DATA_OK)
+            {
+                packetSize = dataPacking.ntoh64(packetSize);
+                if (packetSize == 0)
+                {
+                    HMLog(HM_LOG_DEBUG,
+                            "[SocketUtil] Remote delta fetch received packet size 0 for %s",
+                            hostGroupName.c_str());
+                    return HM_SOCK_DATA_EMPTY;
+                }
+                std::unique_ptr<char[]> recvdData = make_unique<char[]>(packetSize);
+                if(recvData(recvdData.get(), packetSize, tv) == HM_SOCK_DATA_OK)
+                {
+                    if(dataPacking.unpackHostGroupDelta(recvdData, packetSize, epoch, sequence, resync, results))
+                    {
+                        return HM_SOCK_DATA_OK;
+                    }
+                }
+            }
+        }
+    }
+    setConnectionReset(true);
+    closeSocket();
+    HMLog(HM_LOG_DEBUG, "[SocketUtil] Failed to receive result delta from remote hostgroup for %s", hostGroupName.c_str());
+    return HM_SOCK_DATA_FAILED;
+}
+
 
 HM_REASON
 HMSocketUtilBase::getReason() const
@@ -424,7 +472,7 @@ HMSocketUtilBase::getErrorMsg() const
     return m_errorMsg;
 }
 
-const HMTimeStamp&
+const HMMonotonicTime&
 HMSocketUtilBase::getConnectTime() const
 {
     return m_connectTime;
@@ -164,7 +164,7 @@ HMSocketUtilTCP::connectSocket()
                 {
                     m_clientPort = ntohs(sin.sin_port);
                 }
-                m_connectTime = HMTimeStamp::now();
+                m_connectTime = HMMonotonicTime::now();
                 m_connected = true;
                 return true;
             }
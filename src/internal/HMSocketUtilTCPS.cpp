@@ -28,6 +28,7 @@ HMSocketUtilTCPS::closeSocket()
 bool
 HMSocketUtilTCPS::connectSocket()
 {
+    m_tcpConnectTime = m_connectTime;
     m_ssl = SSL_new(m_ctx);
     if (m_ssl)
     {
@@ -39,7 +40,7 @@ HMSocketUtilTCPS::connectSocket()
             int cret = SSL_connect(m_ssl);
             if (cret > 0)
             {
-                m_connectTime = HMTimeStamp::now();
+                m_connectTime = HMMonotonicTime::now();
                 m_connected = true;
                 return true;
             }
@@ -110,6 +111,12 @@ HMSocketUtilTCPS::~HMSocketUtilTCPS()
     closeSocket();
 }
 
+const HMMonotonicTime&
+HMSocketUtilTCPS::getTCPConnectTime() const
+{
+    return m_tcpConnectTime;
+}
+
 void
 HMSocketUtilTCPS::reconnect()
 {
@@ -57,6 +57,15 @@ HMState::HMState(HMState& k) :
     m_dnsRetries = k.m_dnsRetries;
     m_nMaxThreads = k.m_nMaxThreads;
     m_nMinThreads = k.m_nMinThreads;
+    m_threadPoolConfig = k.m_threadPoolConfig;
+    m_checkScheduleConfig = k.m_checkScheduleConfig;
+    m_destinationLimitConfig = k.m_destinationLimitConfig;
+    m_workQueueConfig = k.m_workQueueConfig;
+    m_connectEngineThreads = k.m_connectEngineThreads;
+    m_curlEngineThreads = k.m_curlEngineThreads;
+    m_maxBodySize = k.m_maxBodySize;
+    m_dnsResolver = k.m_dnsResolver;
+    m_dnsResolverThreads = k.m_dnsResolverThreads;
     m_connectionTimeout = k.m_connectionTimeout;
     m_logClass = k.m_logClass;
     m_logLevel = k.m_logLevel;
@@ -69,6 +78,9 @@ HMState::HMState(HMState& k) :
     m_auxPolicy = k.m_auxPolicy;
     m_healthCheckPolicy = k.m_healthCheckPolicy;
     m_storageLockPolicy = k.m_storageLockPolicy;
+    m_storageQueueSize = k.m_storageQueueSize;
+    m_storageBatchSize = k.m_storageBatchSize;
+    m_storageOverflowPolicy = k.m_storageOverflowPolicy;
     m_controlSocketCheckPortv4 = k.m_controlSocketCheckPortv4;
     m_controlSocketCheckPortv6 = k.m_controlSocketCheckPortv6;
     m_hash = k.m_hash;
@@ -76,6 +88,7 @@ HMState::HMState(HMState& k) :
     m_healthCheckCAFile = k.m_healthCheckCAFile;
     m_healthCheckKey = k.m_healthCheckKey;
     m_healthCheckCert = k.m_healthCheckCert;
+    m_healthCheckIdentity = k.m_healthCheckIdentity;
     m_control_socket = k.m_control_socket;
     m_enableSecureRemote = k.m_enableSecureRemote;
     m_certFile = k.m_certFile;
@@ -85,6 +98,7 @@ HMState::HMState(HMState& k) :
     m_hostGroups = k.m_hostGroups;
     m_enableMutualAuth = k.m_enableMutualAuth;
     m_enableSharedConnection = k.m_enableSharedConnection;
+    m_enableRemoteSubscribe = k.m_enableRemoteSubscribe;
     m_maxConnections = k.m_maxConnections;
     m_libEventEnabled = k.m_libEventEnabled;
     m_flowType = k.m_flowType;
@@ -114,6 +128,15 @@ HMState::copyMasterParams(HMState& k)
     m_dnsRetries = k.m_dnsRetries;
     m_nMaxThreads = k.m_nMaxThreads;
     m_nMinThreads = k.m_nMinThreads;
+    m_threadPoolConfig = k.m_threadPoolConfig;
+    m_checkScheduleConfig = k.m_checkScheduleConfig;
+    m_destinationLimitConfig = k.m_destinationLimitConfig;
+    m_workQueueConfig = k.m_workQueueConfig;
+    m_connectEngineThreads = k.m_connectEngineThreads;
+    m_curlEngineThreads = k.m_curlEngineThreads;
+    m_maxBodySize = k.m_maxBodySize;
+    m_dnsResolver = k.m_dnsResolver;
+    m_dnsResolverThreads = k.m_dnsResolverThreads;
     m_connectionTimeout = k.m_connectionTimeout;
     m_logClass = k.m_logClass;
     m_logLevel = k.m_logLevel;
@@ -127,6 +150,9 @@ HMState::copyMasterParams(HMState& k)
     m_auxPolicy = k.m_auxPolicy;
     m_healthCheckPolicy = k.m_healthCheckPolicy;
     m_storageLockPolicy = k.m_storageLockPolicy;
+    m_storageQueueSize = k.m_storageQueueSize;
+    m_storageBatchSize = k.m_storageBatchSize;
+    m_storageOverflowPolicy = k.m_storageOverflowPolicy;
     m_controlSocketCheckPortv4 = k.m_controlSocketCheckPortv4;
     m_controlSocketCheckPortv6 = k.m_controlSocketCheckPortv6;
     m_hash = k.m_hash;
@@ -134,6 +160,7 @@ HMState::copyMasterParams(HMState& k)
     m_healthCheckCAFile = k.m_healthCheckCAFile;
     m_healthCheckKey = k.m_healthCheckKey;
     m_healthCheckCert = k.m_healthCheckCert;
+    m_healthCheckIdentity = k.m_healthCheckIdentity;
     m_control_socket = k.m_control_socket;
     m_enableSecureRemote = k.m_enableSecureRemote;
     m_certFile = k.m_certFile;
@@ -142,6 +169,7 @@ HMState::copyMasterParams(HMState& k)
     m_PubSubConfigFile = k.m_PubSubConfigFile;
     m_enableMutualAuth = k.m_enableMutualAuth;
     m_enableSharedConnection = k.m_enableSharedConnection;
+    m_enableRemoteSubscribe = k.m_enableRemoteSubscribe;
     m_maxConnections = k.m_maxConnections;
     m_libEventEnabled = k.m_libEventEnabled;
     m_flowType = k.m_flowType;
@@ -350,12 +378,66 @@ HMState::getMaxThreads()
     return m_nMaxThreads;
 }
 
+uint32_t
+HMState::getConnectEngineThreads() const
+{
+    return m_connectEngineThreads;
+}
+
+uint32_t
+HMState::getCurlEngineThreads() const
+{
+    return m_curlEngineThreads;
+}
+
+uint64_t
+HMState::getMaxBodySize() const
+{
+    return m_maxBodySize;
+}
+
+bool
+HMState::isDNSResolverEnabled() const
+{
+    return m_dnsResolver;
+}
+
+uint32_t
+HMState::getDNSResolverThreads() const
+{
+    return m_dnsResolverThreads;
+}
+
 uint64_t
 HMState::getMinThreads()
 {
     return m_nMinThreads;
 }
 
+const HMThreadPoolConfig&
+HMState::getThreadPoolConfig() const
+{
+    return m_threadPoolConfig;
+}
+
+const HMCheckScheduleConfig&
+HMState::getCheckScheduleConfig() const
+{
+    return m_checkScheduleConfig;
+}
+
+const HMDestinationLimitConfig&
+HMState::getDestinationLimitConfig() const
+{
+    return m_destinationLimitConfig;
+}
+
+const HMWorkQueueConfig&
+HMState::getWorkQueueConfig() const
+{
+    return m_workQueueConfig;
+}
+
 uint32_t
 HMState::getDNSLookupTimeout() const
 {
@@ -415,6 +497,12 @@ HMState::setSocketPath(const string& path)
     m_socketPath = path;
 }
 
+void
+HMState::setCurlEngineThreads(uint32_t threads)
+{
+    m_curlEngineThreads = threads;
+}
+
 bool
 HMState::loadAllConfigs()
 {
@@ -732,17 +820,17 @@ HMState::forceHealthCheck(const string& hostGroup, HMWorkQueue& workQueue)
                             if(*address == HMIPAddress(AF_INET))
                             {
                                 HMDNSLookup dnsHostCheck(dataCheck.getDnsType(), false, hostGroupInfo->second.getRemoteCheck());
-                                m_dnsCache.queueDNSQuery(*it, dnsHostCheck, workQueue);
+                                m_dnsCache.queueDNSQuery(*it, dnsHostCheck, workQueue, nullptr, true);
                             }
                             else if(*address == HMIPAddress(AF_INET6))
                             {
                                 HMDNSLookup dnsHostCheck(dataCheck.getDnsType(), true, hostGroupInfo->second.getRemoteCheck());
-                                m_dnsCache.queueDNSQuery(*it, dnsHostCheck, workQueue);
+                                m_dnsCache.queueDNSQuery(*it, dnsHostCheck, workQueue, nullptr, true);
                             }
                         }
                         else
                         {
-                            m_checkList.queueCheck(*it, *address, dataCheck, workQueue);
+                            m_checkList.queueCheck(*it, *address, dataCheck, workQueue, nullptr, true);
                         }
                     }
                 }
@@ -772,17 +860,17 @@ HMState::forceHealthCheck(const string& hostGroup, const string& hostName, HMWor
                         if(*address == HMIPAddress(AF_INET))
                         {
                             HMDNSLookup dnsHostCheck(dataCheck.getDnsType(), false, hostGroupInfo->second.getRemoteCheck());
-                            m_dnsCache.queueDNSQuery(hostName, dnsHostCheck, workQueue);
+                            m_dnsCache.queueDNSQuery(hostName, dnsHostCheck, workQueue, nullptr, true);
                         }
                         else if(*address == HMIPAddress(AF_INET6))
                         {
                             HMDNSLookup dnsHostCheck(dataCheck.getDnsType(), true, hostGroupInfo->second.getRemoteCheck());
-                            m_dnsCache.queueDNSQuery(hostName, dnsHostCheck, workQueue);
+                            m_dnsCache.queueDNSQuery(hostName, dnsHostCheck, workQueue, nullptr, true);
                         }
                     }
                     else
                     {
-                        m_checkList.queueCheck(hostName, *address, dataCheck, workQueue);
+                        m_checkList.queueCheck(hostName, *address, dataCheck, workQueue, nullptr, true);
                     }
                 }
             }
@@ -806,13 +894,13 @@ HMState::forceDNSCheck(const string &hostGroup, HMWorkQueue& workQueue)
                 {
                     HMDNSLookup dnsHostCheck(dataCheck.getDnsType(), false, hostGroupInfo->second.getRemoteCheck());
                     dnsHostCheck.setPlugin(getDNSPlugin(dataCheck.getDnsType()));
-                    m_dnsCache.queueDNSQuery(*it, dnsHostCheck, workQueue);
+                    m_dnsCache.queueDNSQuery(*it, dnsHostCheck, workQueue, nullptr, true);
                 }
                 if(dataCheck.getDualStack() & HM_DUALSTACK_IPV6_ONLY)
                 {
                     HMDNSLookup dnsHostCheck(dataCheck.getDnsType(), true, hostGroupInfo->second.getRemoteCheck());
                     dnsHostCheck.setPlugin(getDNSPlugin(dataCheck.getDnsType()));
-                    m_dnsCache.queueDNSQuery(*it, dnsHostCheck, workQueue);
+                    m_dnsCache.queueDNSQuery(*it, dnsHostCheck, workQueue, nullptr, true);
                 }
             }
         }
@@ -832,13 +920,13 @@ HMState::forceDNSCheck(const string &hostGroup, const string &hostName, HMWorkQu
             {
                 HMDNSLookup dnsHostCheck(dataCheck.getDnsType(), false, hostGroupInfo->second.getRemoteCheck());
                 dnsHostCheck.setPlugin(getDNSPlugin(dataCheck.getDnsType()));
-                m_dnsCache.queueDNSQuery(hostName, dnsHostCheck, workQueue);
+                m_dnsCache.queueDNSQuery(hostName, dnsHostCheck, workQueue, nullptr, true);
             }
             if(dataCheck.getDualStack() & HM_DUALSTACK_IPV6_ONLY)
             {
                 HMDNSLookup dnsHostCheck(dataCheck.getDnsType(), true, hostGroupInfo->second.getRemoteCheck());
                 dnsHostCheck.setPlugin(getDNSPlugin(dataCheck.getDnsType()));
-                m_dnsCache.queueDNSQuery(hostName, dnsHostCheck, workQueue);
+                m_dnsCache.queueDNSQuery(hostName, dnsHostCheck, workQueue, nullptr, true);
             }
         }
     }
@@ -868,7 +956,7 @@ HMState::forceDNSCheck(const string &hostName,  HM_DNS_TYPE dnsType, const set<H
 
         if(m_dnsCache.getDNSResult(hostName, dnsHostCheck, iter))
         {
-            m_dnsCache.queueDNSQuery(hostName, dnsHostCheck, workQueue);
+            m_dnsCache.queueDNSQuery(hostName, dnsHostCheck, workQueue, nullptr, true);
         }
         else
         {
@@ -884,7 +972,7 @@ HMState::forceDNSCheck(const string &hostName,  HM_DNS_TYPE dnsType, const set<H
         HMDNSLookup dnsHostCheck(dnsType, true);
         if (m_dnsCache.getDNSResult(hostName, dnsHostCheck, iter))
         {
-            m_dnsCache.queueDNSQuery(hostName, dnsHostCheck, workQueue);
+            m_dnsCache.queueDNSQuery(hostName, dnsHostCheck, workQueue, nullptr, true);
         }
         else
         {
@@ -918,9 +1006,71 @@ HMState::openBackend(bool readOnly)
     m_datastore->updateAuxCommitPolicy(m_auxPolicy);
     m_datastore->updateHealthCheckCommitPolicy(m_healthCheckPolicy);
     m_datastore->updateLockPolicy(m_storageLockPolicy);
+    m_datastore->updateQueuePolicy(m_storageQueueSize, m_storageBatchSize, m_storageOverflowPolicy);
     return m_datastore->openStore(readOnly);
 }
 
+void
+HMState::diffHostGroups(const HMState& src)
+{
+    uint32_t changed = 0;
+    uint32_t added = 0;
+    m_unchangedHostGroups.clear();
+    for(auto it = m_hostGroups.begin(); it != m_hostGroups.end(); ++it)
+    {
+        auto srcGroup = src.m_hostGroups.find(it->first);
+        if(srcGroup == src.m_hostGroups.end())
+        {
+            added++;
+            continue;
+        }
+        // The hash covers the hosts and check params but not all of the host check
+        HMDataHostCheck hostCheck;
+        HMDataHostCheck srcHostCheck;
+        if(it->second.getHashValue() == srcGroup->second.getHashValue()
+                && it->second.getHostCheck(hostCheck)
+                && srcGroup->second.getHostCheck(srcHostCheck)
+                && hostCheck == srcHostCheck
+                && hostCheck.getDnsType() == srcHostCheck.getDnsType())
+        {
+            m_unchangedHostGroups.insert(it->first);
+        }
+        else
+        {
+            changed++;
+        }
+    }
+    HMLog(HM_LOG_INFO, "[CORE] Reload diff: %lu host groups unchanged, %u changed, %u added, %lu removed",
+            m_unchangedHostGroups.size(), changed, added,
+            src.m_hostGroups.size() - m_unchangedHostGroups.size() - changed);
+}
+
+const set<string>&
+HMState::getUnchangedHostGroups() const
+{
+    return m_unchangedHostGroups;
+}
+
+void
+HMState::restoreDNSEntry(HMState& src, const string& hostname, const HMDataHostCheck& hostCheck)
+{
+    set<HMIPAddress> addresses;
+    map<pair<string,HMDNSLookup>,HMDNSResult>::const_iterator dnsResultV4;
+    map<pair<string,HMDNSLookup>,HMDNSResult>::const_iterator dnsResultV6;
+    HMDNSLookup dnsHostCheckV6(hostCheck.getDnsType(), true, hostCheck.getRemoteCheck());
+    HMDNSLookup dnsHostCheckV4(hostCheck.getDnsType(), false, hostCheck.getRemoteCheck());
+    src.m_dnsCache.getAddresses(hostname, HM_DUALSTACK_IPV4_ONLY, dnsHostCheckV4, addresses);
+    src.m_dnsCache.getAddresses(hostname, HM_DUALSTACK_IPV6_ONLY, dnsHostCheckV6, addresses);
+    HMDNSResult emptyResult;
+    bool foundV4 = src.m_dnsCache.getDNSResult(hostname, dnsHostCheckV4, dnsResultV4);
+    bool foundV6 = src.m_dnsCache.getDNSResult(hostname, dnsHostCheckV6, dnsResultV6);
+    HMDNSLookup lookup(hostCheck.getDnsType(), hostCheck.getRemoteCheck());
+    m_dnsCache.updateReloadDNSEntry(hostname, addresses,
+            foundV4 ? dnsResultV4->second : emptyResult,
+            foundV6 ? dnsResultV6->second : emptyResult,
+            lookup);
+}
+
 // this function copies state from a current CheckState to a new CheckState
 // We need to restore both the DNS and HealthCheck State
 void
@@ -928,62 +1078,73 @@ HMState::restoreRunningCheckState(shared_ptr<HMState> src)
 {
     vector<HMCheckHeader> allChecks;
     vector<string> changedHost;
-    if(src->m_checkList.getAllChecks(allChecks))
+
+    // The checks of the unchanged host groups are restored in one pass, only the changed checks are restored by address
+    uint64_t restored = m_checkList.restoreChecks(src->m_checkList, m_unchangedHostGroups, m_datastore.get(), allChecks);
+    for(auto& groupName : m_unchangedHostGroups)
     {
-        for(auto it = allChecks.begin(); it != allChecks.end(); ++it)
+        auto group = m_hostGroups.find(groupName);
+        HMDataHostCheck hostCheck;
+        if(group == m_hostGroups.end() || !group->second.getHostCheck(hostCheck)
+                || hostCheck.getFlowType() != HM_FLOW_DNS_HEALTH_TYPE)
         {
-            set<HMIPAddress> addresses;
-            if(it->m_hostCheck.getFlowType() == HM_FLOW_DNS_HEALTH_TYPE)
-            {
-                map<pair<string,HMDNSLookup>,HMDNSResult>::const_iterator dnsResultV4;
-                map<pair<string,HMDNSLookup>,HMDNSResult>::const_iterator dnsResultV6;
-                HMDNSLookup dnsHostCheckV6(it->m_hostCheck.getDnsType(), true, it->m_hostCheck.getRemoteCheck());
-                HMDNSLookup dnsHostCheckV4(it->m_hostCheck.getDnsType(), false, it->m_hostCheck.getRemoteCheck());
-                src->m_dnsCache.getAddresses(it->m_hostname, HM_DUALSTACK_IPV4_ONLY, dnsHostCheckV4, addresses);
-                src->m_dnsCache.getAddresses(it->m_hostname, HM_DUALSTACK_IPV6_ONLY, dnsHostCheckV6, addresses);
-                src->m_dnsCache.getDNSResult(it->m_hostname, dnsHostCheckV4, dnsResultV4);
-                src->m_dnsCache.getDNSResult(it->m_hostname, dnsHostCheckV6, dnsResultV6);
-                HMDNSLookup lookup(it->m_hostCheck.getDnsType(), it->m_hostCheck.getRemoteCheck());
-                m_dnsCache.updateReloadDNSEntry(it->m_hostname, addresses, dnsResultV4->second, dnsResultV6->second, lookup);
-            }
-            else if(it->m_hostCheck.getFlowType() == HM_FLOW_REMOTE_HOST_TYPE)
-            {
-                src->m_checkList.getCheckResultsAddress(it->m_hostname, it->m_hostCheck, it->m_hostCheck.getDualStack(), addresses);
-            }
-            for(auto address = addresses.begin(); address != addresses.end(); ++address)
+            continue;
+        }
+        for(auto& hostname : *group->second.getHostList())
+        {
+            restoreDNSEntry(*src, hostname, hostCheck);
+        }
+    }
+    HMLog(HM_LOG_DEBUG, "[CORE] Restored %llu unchanged checks, restoring %lu changed checks", restored, allChecks.size());
+
+    for(auto it = allChecks.begin(); it != allChecks.end(); ++it)
+    {
+        set<HMIPAddress> addresses;
+        if(it->m_hostCheck.getFlowType() == HM_FLOW_DNS_HEALTH_TYPE)
+        {
+            HMDNSLookup dnsHostCheckV6(it->m_hostCheck.getDnsType(), true, it->m_hostCheck.getRemoteCheck());
+            HMDNSLookup dnsHostCheckV4(it->m_hostCheck.getDnsType(), false, it->m_hostCheck.getRemoteCheck());
+            src->m_dnsCache.getAddresses(it->m_hostname, HM_DUALSTACK_IPV4_ONLY, dnsHostCheckV4, addresses);
+            src->m_dnsCache.getAddresses(it->m_hostname, HM_DUALSTACK_IPV6_ONLY, dnsHostCheckV6, addresses);
+            restoreDNSEntry(*src, it->m_hostname, it->m_hostCheck);
+        }
+        else if(it->m_hostCheck.getFlowType() == HM_FLOW_REMOTE_HOST_TYPE)
+        {
+            src->m_checkList.getCheckResultsAddress(it->m_hostname, it->m_hostCheck, it->m_hostCheck.getDualStack(), addresses);
+        }
+        for(auto address = addresses.begin(); address != addresses.end(); ++address)
+        {
+            it->m_address = *address;
+            HMDataCheckResult result(it->m_checkParams.getTimeout());
+            if(src->m_checkList.getCheckResult(*it, result))
             {
-                it->m_address = *address;
-                HMDataCheckResult result(it->m_checkParams.getTimeout());
-                if(src->m_checkList.getCheckResult(*it, result))
+                HMDataCheckResult tmp_result(it->m_checkParams.getTimeout());
+                if(!m_checkList.getCheckResult(*it, tmp_result)
+                        || tmp_result.m_checkTime < result.m_checkTime)
                 {
-                    HMDataCheckResult tmp_result(it->m_checkParams.getTimeout());
-                    if(!m_checkList.getCheckResult(*it, tmp_result)
-                            || tmp_result.m_checkTime < result.m_checkTime)
+                    result.m_queryState = HM_CHECK_INACTIVE;
+                    bool found = m_checkList.updateCheck(*it, result);
+                    //update the last checktime in remote host cache
+                    if(it->m_hostCheck.getFlowType() == HM_FLOW_REMOTE_HOST_TYPE)
                     {
-                        result.m_queryState = HM_CHECK_INACTIVE;
-                        bool found = m_checkList.updateCheck(*it, result);
-                        //update the last checktime in remote host cache
-                        if(it->m_hostCheck.getFlowType() == HM_FLOW_REMOTE_HOST_TYPE)
+                        map<pair<string, HMDataHostCheck>, HMRemoteResult>::const_iterator result;
+                        if (src->m_remoteHostCache.getRemoteResult(it->m_hostname, it->m_hostCheck, result))
                         {
-                            map<pair<string, HMDataHostCheck>, HMRemoteResult>::const_iterator result;
-                            if (src->m_remoteHostCache.getRemoteResult(it->m_hostname, it->m_hostCheck, result))
-                            {
-                                m_remoteHostCache.updateResultTime(it->m_hostname, it->m_hostCheck,
-                                        result->second.getResultTime());
-                            }
+                            m_remoteHostCache.updateResultTime(it->m_hostname, it->m_hostCheck,
+                                    result->second.getResultTime());
                         }
-                        vector<string> dHgs;
-                        m_checkList.getHostGroups(*it, dHgs);
-                        if(found)
+                    }
+                    vector<string> dHgs;
+                    m_checkList.getHostGroups(*it, dHgs);
+                    if(found)
+                    {
+                        HMLog(HM_LOG_DEBUG, "[CORE] Updating previous results for host %s", it->m_hostname.c_str());
+                        // checkparams will not have the hostgroups as we do not do a deep copy.
+                        for(string groupName : dHgs)
                         {
-                            HMLog(HM_LOG_DEBUG, "[CORE] Updating previous results for host %s", it->m_hostname.c_str());
-                            // checkparams will not have the hostgroups as we do not do a deep copy.
-                            for(string groupName : dHgs)
-                            {
-                                it->m_checkParams.addHostGroup(groupName);
-                            }
-                            m_datastore->updateCheckResultCache(*it, result);
+                            it->m_checkParams.addHostGroup(groupName);
                         }
+                        m_datastore->updateCheckResultCache(*it, result);
                     }
                 }
             }
@@ -1020,11 +1181,16 @@ HMState::restoreRunningCheckState(shared_ptr<HMState> src)
 }
 
 void
-HMState::resheduleHealthChecks(shared_ptr<HMState> src, HMWorkQueue& workQueue)
+HMState::resheduleHealthChecks(shared_ptr<HMState> src, HMWorkQueue& workQueue, HMEventLoop& eventLoop)
 {
     // This function reschedules all healthchecks that have changes from the previous configs
     for(auto iter = m_hostGroups.begin(); iter != m_hostGroups.end(); ++iter)
     {
+        // Unchanged host groups keep their scheduled health checks
+        if(m_unchangedHostGroups.find(iter->first) != m_unchangedHostGroups.end())
+        {
+            continue;
+        }
         // We first look at all the healthchecks that are in both previous and current configs
         auto it = src->m_hostGroups.find(iter->first);
         if(it != src->m_hostGroups.end())
@@ -1050,7 +1216,7 @@ HMState::resheduleHealthChecks(shared_ptr<HMState> src, HMWorkQueue& workQueue)
                     {
                         for(auto address = addresses.begin(); address != addresses.end(); ++address)
                         {
-                            m_checkList.queueCheck(hostName, *address, nDataCheck, workQueue);
+                            m_checkList.scheduleCheck(hostName, *address, nDataCheck, workQueue, eventLoop, true);
                         }
                     }
                 }
@@ -1074,7 +1240,7 @@ HMState::resheduleHealthChecks(shared_ptr<HMState> src, HMWorkQueue& workQueue)
                         string hostName = *hostname;
                         for(auto address = addresses.begin(); address != addresses.end(); ++address)
                         {
-                            m_checkList.queueCheck(hostName, *address, nDataCheck, workQueue);
+                            m_checkList.scheduleCheck(hostName, *address, nDataCheck, workQueue, eventLoop, true);
                         }
                     }
                 }
@@ -1095,7 +1261,7 @@ HMState::resheduleHealthChecks(shared_ptr<HMState> src, HMWorkQueue& workQueue)
                         string hostName = *hostname;
                         for(auto address = addresses.begin(); address != addresses.end(); ++address)
                         {
-                            m_checkList.queueCheck(hostName, *address, nDataCheck, workQueue);
+                            m_checkList.scheduleCheck(hostName, *address, nDataCheck, workQueue, eventLoop, true);
                         }
                     }
                 }
@@ -1119,7 +1285,7 @@ HMState::resheduleHealthChecks(shared_ptr<HMState> src, HMWorkQueue& workQueue)
                 {
                     for(auto address = addresses.begin(); address != addresses.end(); ++address)
                     {
-                        m_checkList.queueCheck(hostName, *address, nDataCheck, workQueue);
+                        m_checkList.scheduleCheck(hostName, *address, nDataCheck, workQueue, eventLoop, true);
                     }
                 }
             }
@@ -1128,56 +1294,71 @@ HMState::resheduleHealthChecks(shared_ptr<HMState> src, HMWorkQueue& workQueue)
 }
 
 void
-HMState::resheduleDNSChecks(shared_ptr<HMState> src, HMWorkQueue& workQueue)
+HMState::resheduleDNSCheck(HMState& src, const string& hostname, const HMDataHostCheck& hostCheck, HMWorkQueue& workQueue)
 {
-    // This function reschedules all dnschecks that have change in ttl value which may cause the dns check to go off schedule.
-    vector<HMCheckHeader> allChecks;
-    if(m_checkList.getAllChecks(allChecks))
+    for(bool ipv6 : {false, true})
     {
-        for(auto it = allChecks.begin(); it != allChecks.end(); ++it)
+        if(!(hostCheck.getDualStack() & (ipv6 ? HM_DUALSTACK_IPV6_ONLY : HM_DUALSTACK_IPV4_ONLY)))
         {
-            if(it->m_hostCheck.getDualStack() & HM_DUALSTACK_IPV4_ONLY)
-            {
-                HMDNSLookup dnsHostCheck(it->m_hostCheck.getDnsType(), false, it->m_hostCheck.getRemoteCheck());
-                dnsHostCheck.setPlugin(getDNSPlugin(it->m_hostCheck.getDnsType()));
-                map<pair<string, HMDNSLookup>, HMDNSResult>::const_iterator resultSrcDNS;
-                map<pair<string, HMDNSLookup>, HMDNSResult>::const_iterator resultDestDNS;
+            continue;
+        }
+        HMDNSLookup dnsHostCheck(hostCheck.getDnsType(), ipv6, hostCheck.getRemoteCheck());
+        dnsHostCheck.setPlugin(getDNSPlugin(hostCheck.getDnsType()));
+        map<pair<string, HMDNSLookup>, HMDNSResult>::const_iterator resultSrcDNS;
+        map<pair<string, HMDNSLookup>, HMDNSResult>::const_iterator resultDestDNS;
 
-                if(src->m_dnsCache.getDNSResult(it->m_hostname, dnsHostCheck, resultSrcDNS)
-                        && m_dnsCache.getDNSResult(it->m_hostname, dnsHostCheck, resultDestDNS))
-                {
-                    if(resultSrcDNS->second.getDNSTTL() < resultDestDNS->second.getDNSTTL())
-                    {
-                       m_dnsCache.queueDNSQuery(it->m_hostname, dnsHostCheck, workQueue);
-                    }
-                }
-            }
-            if(it->m_hostCheck.getDualStack() & HM_DUALSTACK_IPV6_ONLY)
+        if(src.m_dnsCache.getDNSResult(hostname, dnsHostCheck, resultSrcDNS)
+                && m_dnsCache.getDNSResult(hostname, dnsHostCheck, resultDestDNS))
+        {
+            if(resultSrcDNS->second.getDNSTTL() < resultDestDNS->second.getDNSTTL())
             {
-                HMDNSLookup dnsHostCheck(it->m_hostCheck.getDnsType(), true, it->m_hostCheck.getRemoteCheck());
-                dnsHostCheck.setPlugin(getDNSPlugin(it->m_hostCheck.getDnsType()));
-                map<pair<string, HMDNSLookup>, HMDNSResult>::const_iterator resultSrcDNS;
-                map<pair<string, HMDNSLookup>, HMDNSResult>::const_iterator resultDestDNS;
-
-                if(src->m_dnsCache.getDNSResult(it->m_hostname, dnsHostCheck, resultSrcDNS)
-                        && m_dnsCache.getDNSResult(it->m_hostname, dnsHostCheck, resultDestDNS))
-                {
-                    if(resultSrcDNS->second.getDNSTTL() < resultDestDNS->second.getDNSTTL())
-                    {
-                        m_dnsCache.queueDNSQuery(it->m_hostname, dnsHostCheck, workQueue);
-                    }
-                }
+                m_dnsCache.queueDNSQuery(hostname, dnsHostCheck, workQueue);
             }
         }
     }
 }
 
+void
+HMState::resheduleDNSChecks(shared_ptr<HMState> src, HMWorkQueue& workQueue)
+{
+    // This function reschedules all dnschecks that have change in ttl value which may cause the dns check to go off schedule.
+    // The TTL of a host can only change with a host group that was changed, added or removed by the reload.
+    for(auto it = m_hostGroups.begin(); it != m_hostGroups.end(); ++it)
+    {
+        HMDataHostCheck hostCheck;
+        if(m_unchangedHostGroups.find(it->first) != m_unchangedHostGroups.end() || !it->second.getHostCheck(hostCheck))
+        {
+            continue;
+        }
+        for(auto& hostname : *it->second.getHostList())
+        {
+            resheduleDNSCheck(*src, hostname, hostCheck, workQueue);
+        }
+    }
+    for(auto it = src->m_hostGroups.begin(); it != src->m_hostGroups.end(); ++it)
+    {
+        HMDataHostCheck hostCheck;
+        if(m_hostGroups.find(it->first) != m_hostGroups.end() || !it->second.getHostCheck(hostCheck))
+        {
+            continue;
+        }
+        for(auto& hostname : *it->second.getHostList())
+        {
+            resheduleDNSCheck(*src, hostname, hostCheck, workQueue);
+        }
+    }
+}
+
 void
 HMState::updateBackend(shared_ptr<HMState> src)
 {
     set<string> mHosts;
     for(auto it = src->m_hostGroups.begin(); it != src->m_hostGroups.end(); ++it)
     {
+        if(m_unchangedHostGroups.find(it->first) != m_unchangedHostGroups.end())
+        {
+            continue;
+        }
         auto iter = m_hostGroups.find(it->first);
         // TODO I think the pass through comparison can be dropped now...we now track passthrough in the check params....
         if(iter == m_hostGroups.end() || (iter != m_hostGroups.end() && it->second.getPassthroughInfo() != iter->second.getPassthroughInfo() ))
@@ -1245,6 +1426,11 @@ bool HMState::isEnableSharedConnection() const
     return m_enableSharedConnection;
 }
 
+bool HMState::isEnableRemoteSubscribe() const
+{
+    return m_enableRemoteSubscribe;
+}
+
 bool
 HMState::parseMasterYaml(const string& masterConfig)
 {
@@ -1291,6 +1477,136 @@ HMState::parseMasterYaml(const string& masterConfig)
             m_nMinThreads = atoi(val.c_str());
             HMLog(HM_LOG_DEBUG, "[CORE] Minimum worker threads -> %d ", m_nMinThreads);
         }
+        else if(key == "threads.target-wait")
+        {
+            m_threadPoolConfig.m_targetWait = atoi(val.c_str());
+            HMLog(HM_LOG_DEBUG, "[CORE] Worker thread target queue wait -> %d ms", m_threadPoolConfig.m_targetWait);
+        }
+        else if(key == "threads.utilisation-low")
+        {
+            m_threadPoolConfig.m_lowUtilisation = atoi(val.c_str());
+            HMLog(HM_LOG_DEBUG, "[CORE] Worker thread low utilisation -> %d%%", m_threadPoolConfig.m_lowUtilisation);
+        }
+        else if(key == "threads.utilisation-high")
+        {
+            m_threadPoolConfig.m_highUtilisation = atoi(val.c_str());
+            HMLog(HM_LOG_DEBUG, "[CORE] Worker thread high utilisation -> %d%%", m_threadPoolConfig.m_highUtilisation);
+        }
+        else if(key == "threads.growth-percent")
+        {
+            m_threadPoolConfig.m_growthPercent = atoi(val.c_str());
+            HMLog(HM_LOG_DEBUG, "[CORE] Worker thread growth -> %d%%", m_threadPoolConfig.m_growthPercent);
+        }
+        else if(key == "threads.shrink-intervals")
+        {
+            m_threadPoolConfig.m_shrinkIntervals = atoi(val.c_str());
+            HMLog(HM_LOG_DEBUG, "[CORE] Worker thread shrink intervals -> %d", m_threadPoolConfig.m_shrinkIntervals);
+        }
+        else if(key == "threads.recycle-memory-growth")
+        {
+            m_threadPoolConfig.m_recycleMemoryGrowth = atoi(val.c_str());
+            HMLog(HM_LOG_DEBUG, "[CORE] Worker thread recycle memory growth -> %d%%", m_threadPoolConfig.m_recycleMemoryGrowth);
+        }
+        else if(key == "threads.recycle-file-growth")
+        {
+            m_threadPoolConfig.m_recycleFileGrowth = atoi(val.c_str());
+            HMLog(HM_LOG_DEBUG, "[CORE] Worker thread recycle file growth -> %d", m_threadPoolConfig.m_recycleFileGrowth);
+        }
+        else if(key == "schedule.spread-window")
+        {
+            m_checkScheduleConfig.m_spreadWindow = atoll(val.c_str());
+            HMLog(HM_LOG_DEBUG, "[CORE] Check schedule spread window -> %llu ms", m_checkScheduleConfig.m_spreadWindow);
+        }
+        else if(key == "schedule.jitter-percent")
+        {
+            m_checkScheduleConfig.m_jitterPercent = atoi(val.c_str());
+            HMLog(HM_LOG_DEBUG, "[CORE] Check schedule jitter -> %d%%", m_checkScheduleConfig.m_jitterPercent);
+        }
+        else if(key == "schedule.ramp-up-rate")
+        {
+            m_checkScheduleConfig.m_rampUpRate = atoi(val.c_str());
+            HMLog(HM_LOG_DEBUG, "[CORE] Check schedule ramp up rate -> %d checks/s", m_checkScheduleConfig.m_rampUpRate);
+        }
+        else if(key == "limits.destination-concurrency")
+        {
+            m_destinationLimitConfig.m_concurrency = atoi(val.c_str());
+            HMLog(HM_LOG_DEBUG, "[CORE] Destination concurrency limit -> %d", m_destinationLimitConfig.m_concurrency);
+        }
+        else if(key == "limits.destination-rate")
+        {
+            m_destinationLimitConfig.m_rate = atoi(val.c_str());
+            HMLog(HM_LOG_DEBUG, "[CORE] Destination rate limit -> %d checks/s", m_destinationLimitConfig.m_rate);
+        }
+        else if(key == "limits.destination-burst")
+        {
+            m_destinationLimitConfig.m_burst = atoi(val.c_str());
+            HMLog(HM_LOG_DEBUG, "[CORE] Destination rate burst -> %d", m_destinationLimitConfig.m_burst);
+        }
+        else if(key == "limits.prefix-ipv4")
+        {
+            m_destinationLimitConfig.m_prefixIpv4 = atoi(val.c_str());
+            HMLog(HM_LOG_DEBUG, "[CORE] Destination IPv4 prefix -> /%d", m_destinationLimitConfig.m_prefixIpv4);
+        }
+        else if(key == "limits.prefix-ipv6")
+        {
+            m_destinationLimitConfig.m_prefixIpv6 = atoi(val.c_str());
+            HMLog(HM_LOG_DEBUG, "[CORE] Destination IPv6 prefix -> /%d", m_destinationLimitConfig.m_prefixIpv6);
+        }
+        else if(key == "limits.resolver-concurrency")
+        {
+            m_destinationLimitConfig.m_resolverConcurrency = atoi(val.c_str());
+            HMLog(HM_LOG_DEBUG, "[CORE] Resolver concurrency limit -> %d", m_destinationLimitConfig.m_resolverConcurrency);
+        }
+        else if(key == "limits.resolver-rate")
+        {
+            m_destinationLimitConfig.m_resolverRate = atoi(val.c_str());
+            HMLog(HM_LOG_DEBUG, "[CORE] Resolver rate limit -> %d lookups/s", m_destinationLimitConfig.m_resolverRate);
+        }
+        else if(key == "limits.retry-delay")
+        {
+            m_destinationLimitConfig.m_retryDelay = atoll(val.c_str());
+            HMLog(HM_LOG_DEBUG, "[CORE] Destination limit retry delay -> %llu ms", m_destinationLimitConfig.m_retryDelay);
+        }
+        else if(key == "workqueue.weight-control")
+        {
+            m_workQueueConfig.m_weights[HM_WORK_CLASS_CONTROL] = atoi(val.c_str());
+            HMLog(HM_LOG_DEBUG, "[CORE] Control work weight -> %d", m_workQueueConfig.m_weights[HM_WORK_CLASS_CONTROL]);
+        }
+        else if(key == "workqueue.weight-high")
+        {
+            m_workQueueConfig.m_weights[HM_WORK_CLASS_HIGH] = atoi(val.c_str());
+            HMLog(HM_LOG_DEBUG, "[CORE] High priority health check weight -> %d", m_workQueueConfig.m_weights[HM_WORK_CLASS_HIGH]);
+        }
+        else if(key == "workqueue.weight-healthcheck")
+        {
+            m_workQueueConfig.m_weights[HM_WORK_CLASS_HEALTHCHECK] = atoi(val.c_str());
+            HMLog(HM_LOG_DEBUG, "[CORE] Health check weight -> %d", m_workQueueConfig.m_weights[HM_WORK_CLASS_HEALTHCHECK]);
+        }
+        else if(key == "workqueue.weight-low")
+        {
+            m_workQueueConfig.m_weights[HM_WORK_CLASS_LOW] = atoi(val.c_str());
+            HMLog(HM_LOG_DEBUG, "[CORE] Low priority health check weight -> %d", m_workQueueConfig.m_weights[HM_WORK_CLASS_LOW]);
+        }
+        else if(key == "workqueue.weight-dns")
+        {
+            m_workQueueConfig.m_weights[HM_WORK_CLASS_DNSLOOKUP] = atoi(val.c_str());
+            HMLog(HM_LOG_DEBUG, "[CORE] DNS lookup weight -> %d", m_workQueueConfig.m_weights[HM_WORK_CLASS_DNSLOOKUP]);
+        }
+        else if(key == "workqueue.weight-remote")
+        {
+            m_workQueueConfig.m_weights[HM_WORK_CLASS_REMOTE] = atoi(val.c_str());
+            HMLog(HM_LOG_DEBUG, "[CORE] Remote check weight -> %d", m_workQueueConfig.m_weights[HM_WORK_CLASS_REMOTE]);
+        }
+        else if(key == "workqueue.weight-aux")
+        {
+            m_workQueueConfig.m_weights[HM_WORK_CLASS_AUXFETCH] = atoi(val.c_str());
+            HMLog(HM_LOG_DEBUG, "[CORE] Aux fetch weight -> %d", m_workQueueConfig.m_weights[HM_WORK_CLASS_AUXFETCH]);
+        }
+        else if(key == "workqueue.starvation-time")
+        {
+            m_workQueueConfig.m_starvationTime = atoll(val.c_str());
+            HMLog(HM_LOG_DEBUG, "[CORE] Work starvation time -> %llu ms", m_workQueueConfig.m_starvationTime);
+        }
         else if(key == "connectiontimeout")
         {
             m_connectionTimeout = atol(val.c_str());
@@ -1355,6 +1671,33 @@ HMState::parseMasterYaml(const string& masterConfig)
                 return false;
             }
         }
+        else if(key == "dns.resolver")
+        {
+            if(val == "blocking")
+            {
+                m_dnsResolver = false;
+                HMLog(HM_LOG_NOTICE, "[CORE] Using a blocking ares lookup on the worker threads for DNS");
+            }
+            else if(val == "epoll")
+            {
+                m_dnsResolver = true;
+                HMLog(HM_LOG_NOTICE, "[CORE] Using the epoll DNS resolver for DNS");
+            }
+            else
+            {
+                HMLog(HM_LOG_ERROR, "[CORE] Invalid DNS resolver type %s", val.c_str());
+                return false;
+            }
+        }
+        else if(key == "dns.resolver-threads")
+        {
+            m_dnsResolverThreads = atoi(val.c_str());
+            if(m_dnsResolverThreads == 0)
+            {
+                m_dnsResolverThreads = HM_DEFAULT_DNS_RESOLVER_THREADS;
+            }
+            HMLog(HM_LOG_DEBUG, "[CORE] DNS resolver threads -> %d ", m_dnsResolverThreads);
+        }
         else if (key == "dns.statictype")
         {
             if(val == "static")
@@ -1381,6 +1724,31 @@ HMState::parseMasterYaml(const string& masterConfig)
                 m_httpDefaultCheckClass = HM_CHECK_PLUGIN_HTTP_CURL;
                 HMLog(HM_LOG_NOTICE, "[CORE] Using Curl Library for HTTP/S Check Types");
             }
+            else if(val == "multi")
+            {
+                m_httpDefaultCheckClass = HM_CHECK_PLUGIN_HTTP_CURL_MULTI;
+                HMLog(HM_LOG_NOTICE, "[CORE] Using the curl multi engine for HTTP/S Check Types");
+            }
+        }
+        else if(key == "http.engine-threads")
+        {
+            int threads = atoi(val.c_str());
+            if(threads <= 0)
+            {
+                HMLog(HM_LOG_ERROR, "[CORE] Invalid curl engine threads %s", val.c_str());
+                return false;
+            }
+            m_curlEngineThreads = threads;
+            HMLog(HM_LOG_DEBUG, "[CORE] Curl engine threads -> %d ", m_curlEngineThreads);
+        }
+        else if(key == "http.max-body-size")
+        {
+            m_maxBodySize = strtoull(val.c_str(), nullptr, 10);
+            if(m_maxBodySize == 0)
+            {
+                m_maxBodySize = HM_DEFAULT_MAX_BODY_SIZE;
+            }
+            HMLog(HM_LOG_DEBUG, "[CORE] Max body size -> %lu ", m_maxBodySize);
         }
         else if(key == "ftp.type")
         {
@@ -1397,15 +1765,35 @@ HMState::parseMasterYaml(const string& masterConfig)
                 m_tcpDefaultCheckClass = HM_CHECK_PLUGIN_TCP_RAW;
                 HMLog(HM_LOG_NOTICE, "[CORE] Using raw socket for TCP Check Type");
             }
+            else if(val == "epoll")
+            {
+                m_tcpDefaultCheckClass = HM_CHECK_PLUGIN_TCP_EPOLL;
+                HMLog(HM_LOG_NOTICE, "[CORE] Using the epoll connect engine for TCP Check Type");
+            }
+        }
+        else if(key == "tcp.engine-threads")
+        {
+            m_connectEngineThreads = atoi(val.c_str());
+            if(m_connectEngineThreads == 0)
+            {
+                m_connectEngineThreads = HM_DEFAULT_CONNECT_ENGINE_THREADS;
+            }
+            HMLog(HM_LOG_DEBUG, "[CORE] Connect engine threads -> %d ", m_connectEngineThreads);
         }
         else if (key == "tcps.type")
         {
             if (val == "rawsocket")
             {
-                m_tcpDefaultCheckClass = HM_CHECK_PLUGIN_TCPS_RAW;
+                m_tcpsDefaultCheckClass = HM_CHECK_PLUGIN_TCPS_RAW;
                 HMLog(HM_LOG_NOTICE,
                         "[CORE] Using raw socket for TCPS Check Type");
             }
+            else if (val == "epoll")
+            {
+                m_tcpsDefaultCheckClass = HM_CHECK_PLUGIN_TCPS_EPOLL;
+                HMLog(HM_LOG_NOTICE,
+                        "[CORE] Using the epoll connect engine for TCPS Check Type");
+            }
         }
         else if(key == "dnscheck.type")
         {
@@ -1438,6 +1826,25 @@ HMState::parseMasterYaml(const string& masterConfig)
                 m_storageLockPolicy = HM_STORAGE_PARTITION_LOCKS;
             }
         }
+        else if(key == "db.queueSize")
+        {
+            m_storageQueueSize = atoll(val.c_str());
+        }
+        else if(key == "db.batchSize")
+        {
+            m_storageBatchSize = atoi(val.c_str());
+        }
+        else if(key == "db.overflowPolicy")
+        {
+            if(val == "block")
+            {
+                m_storageOverflowPolicy = HM_STORAGE_OVERFLOW_BLOCK;
+            }
+            else if(val == "dropoldest")
+            {
+                m_storageOverflowPolicy = HM_STORAGE_OVERFLOW_DROP_OLDEST;
+            }
+        }
         else if(key == "db.type")
         {
             if(val == "mdbm")
@@ -1735,6 +2142,22 @@ HMState::parseMasterYaml(const string& masterConfig)
                         "Invalid value for enable-shared-connection, setting to default value");
             }
         }
+        else if (key == "enable-remote-subscribe")
+        {
+            if (val == "on")
+            {
+                m_enableRemoteSubscribe = true;
+            }
+            else if (val == "off")
+            {
+                m_enableRemoteSubscribe = false;
+            }
+            else
+            {
+                HMLog(HM_LOG_ERROR,
+                        "Invalid value for enable-remote-subscribe, setting to default value");
+            }
+        }
         else if (key == "max-remote-connections")
         {
             int conn = atoi(val.c_str());
@@ -1776,6 +2199,17 @@ HMState::parseMasterYaml(const string& masterConfig)
         }
     }
 
+    // Reuse the identity already parsed if the credentials did not change
+    m_healthCheckIdentity.reset();
+    if(!m_healthCheckKey.empty() && !m_healthCheckCert.empty())
+    {
+        m_healthCheckIdentity = HMTLSIdentityCache::instance().get(m_healthCheckKey, m_healthCheckCert);
+        if(!m_healthCheckIdentity)
+        {
+            HMLog(HM_LOG_CRITICAL, "[CORE] Invalid health check certificate or key");
+        }
+    }
+
     //adding directories
     for( auto dir: dirs)
     {
@@ -1854,6 +2288,11 @@ const std::string& HMState::getHealthCheckCert() const
     return m_healthCheckCert;
 }
 
+shared_ptr<HMTLSIdentity> HMState::getHealthCheckIdentity() const
+{
+    return m_healthCheckIdentity;
+}
+
 const std::string& HMState::getCertFile() const
 {
     return m_certFile;
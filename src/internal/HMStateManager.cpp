@@ -8,6 +8,7 @@
 #include <sys/socket.h>
 #include <signal.h>
 #include <iostream>
+#include <thread>
 #include <curl/curl.h>
 #include <openssl/crypto.h>
 
@@ -25,6 +26,10 @@
 #include "HMControlTLSSocket.h"
 #include "HMControlTCPSocket.h"
 #include "HMOpenSSL.h"
+#include "HMControlReactor.h"
+#ifdef USE_ARES
+#include "HMDNSResolver.h"
+#endif
 
 using namespace std;
 
@@ -33,6 +38,10 @@ HMStateManager::HMStateManager() :
           m_eventLoop(nullptr),
           m_threadPool(nullptr),
           m_libEvent(nullptr),
+          m_connectEngine(nullptr),
+          m_curlEngine(nullptr),
+          m_dnsResolver(nullptr),
+          m_controlReactor(nullptr),
           m_enableRemoteQueryReply(true),
           m_active(false)
 {
@@ -50,6 +59,12 @@ HMStateManager::~HMStateManager()
     }
 
     delete (m_threadPool);
+    delete (m_connectEngine);
+    delete (m_curlEngine);
+#ifdef USE_ARES
+    delete (m_dnsResolver);
+#endif
+    delete (m_controlReactor);
 
     if(m_eventLoop == m_libEvent)
     {
@@ -71,22 +86,24 @@ HMStateManager::~HMStateManager()
 bool
 HMStateManager::updateState(shared_ptr<HMState>& current)
 {
-    if(current == m_currentState)
+    shared_ptr<HMState> state = atomic_load(&m_currentState);
+    if(current == state)
     {
         return false;
     }
-    current = m_currentState;
+    current = move(state);
     return true;
 }
 
 bool
 HMStateManager::updateTransactionState(shared_ptr<HMState>& transactionState)
 {
-    if(transactionState == m_newTransactionState)
+    shared_ptr<HMState> state = atomic_load(&m_newTransactionState);
+    if(transactionState == state)
     {
         return false;
     }
-    transactionState = m_newTransactionState;
+    transactionState = move(state);
     return true;
 }
 
@@ -95,7 +112,7 @@ HMStateManager::resetTransactionState()
 {
     shared_ptr<HMState> currentState;
     updateState(currentState);
-    m_newTransactionState = make_shared<HMState>(*(currentState.get()));
+    atomic_store(&m_newTransactionState, make_shared<HMState>(*(currentState.get())));
 }
 
 // The main Daemon HealthCheck Function
@@ -142,6 +159,50 @@ HMStateManager::healthCheck(string masterConfig, HM_LOG_LEVEL logLevel)
     {
         m_eventLoop = new HMEventLoopQueue(this);
     }
+    m_eventLoop->getCheckSchedule().setConfig(m_currentState->getCheckScheduleConfig());
+    m_workQueue.getDestinationLimiter().setConfig(m_currentState->getDestinationLimitConfig());
+    m_workQueue.setConfig(m_currentState->getWorkQueueConfig());
+
+    if(m_currentState->getDefaultTCPCheckype() == HM_CHECK_PLUGIN_TCP_EPOLL
+            || m_currentState->getDefaultTCPSCheckype() == HM_CHECK_PLUGIN_TCPS_EPOLL)
+    {
+        HMLog(HM_LOG_INFO, "[CORE] Starting TCP Connect Engine");
+        m_connectEngine = new HMConnectEngine(m_currentState->getConnectEngineThreads());
+        if(!m_connectEngine->start())
+        {
+            HMLog(HM_LOG_ERROR, "[CORE] Failed to start the TCP connect engine, falling back to blocking TCP/TCPS checks");
+            delete m_connectEngine;
+            m_connectEngine = nullptr;
+        }
+    }
+
+    if(m_currentState->getDefaultHTTPCheckype() == HM_CHECK_PLUGIN_HTTP_CURL_MULTI)
+    {
+        HMLog(HM_LOG_INFO, "[CORE] Starting HTTP Curl Engine");
+        m_curlEngine = new HMCurlEngine(m_currentState->getCurlEngineThreads());
+        if(!m_curlEngine->start())
+        {
+            HMLog(HM_LOG_ERROR, "[CORE] Failed to start the curl engine, falling back to blocking HTTP/S checks");
+            delete m_curlEngine;
+            m_curlEngine = nullptr;
+        }
+    }
+
+    if(m_currentState->isDNSResolverEnabled())
+    {
+#ifdef USE_ARES
+        HMLog(HM_LOG_INFO, "[CORE] Starting DNS Resolver");
+        m_dnsResolver = new HMDNSResolver(m_currentState->getDNSResolverThreads());
+        if(!m_dnsResolver->start())
+        {
+            HMLog(HM_LOG_ERROR, "[CORE] Failed to start the DNS resolver, falling back to blocking DNS lookups");
+            delete m_dnsResolver;
+            m_dnsResolver = nullptr;
+        }
+#else
+        HMLog(HM_LOG_ERROR, "Ares disabled during build. Please enable it for the DNS resolver to work");
+#endif
+    }
 
     // Step 3. Fill the initial work order Queue
     // Note #1. We always insert into the DNS callback since the checklist is by definition unique for each host/checktype
@@ -153,6 +214,13 @@ HMStateManager::healthCheck(string masterConfig, HM_LOG_LEVEL logLevel)
     current->m_remoteHostCache.queueRemoteLookups(m_workQueue, *m_eventLoop, true);
     const string socketPath = current->getSocketPath();
     // Step 4: Create a socket to listen for external commands
+    m_controlReactor = new HMControlReactor(*this);
+    if(!m_controlReactor->start())
+    {
+        HMLog(HM_LOG_CRITICAL, "[CORE] Failed to start the control reactor");
+        delete m_controlReactor;
+        m_controlReactor = nullptr;
+    }
 
     for(HM_CONTROL_SOCKET type : current->getControlSocket())
     {
@@ -235,6 +303,28 @@ HMStateManager::healthCheck(string masterConfig, HM_LOG_LEVEL logLevel)
     updateState(current);
     m_threadPool->shutdown();
 
+    if(m_connectEngine)
+    {
+        m_connectEngine->shutDown();
+    }
+
+    if(m_curlEngine)
+    {
+        m_curlEngine->shutDown();
+    }
+
+#ifdef USE_ARES
+    if(m_dnsResolver)
+    {
+        m_dnsResolver->shutDown();
+    }
+#endif
+
+    if(m_controlReactor)
+    {
+        m_controlReactor->shutDown();
+    }
+
     if(hlog != nullptr)
     {
         hlog->shutDownLogging();
@@ -424,8 +514,8 @@ HMStateManager::loadDaemonState(const string& masterConfig, HM_LOG_LEVEL logLeve
         HMLog(HM_LOG_CRITICAL, "[CORE] Failure loading pub-sub config file");
         return false;
     }
-    m_newTransactionState = make_shared<HMState>(*(m_newState.get()));
-    m_currentState.swap(m_newState);
+    atomic_store(&m_newTransactionState, make_shared<HMState>(*(m_newState.get())));
+    atomic_store(&m_currentState, m_newState);
     m_newState.reset();
 
     m_currentState->restoreStoredCheckState();
@@ -435,11 +525,16 @@ HMStateManager::loadDaemonState(const string& masterConfig, HM_LOG_LEVEL logLeve
 void
 HMStateManager::swapStates()
 {
+    m_newState->diffHostGroups(*m_currentState);
     m_newState->restoreRunningCheckState(m_currentState);
-    m_newTransactionState = make_shared<HMState>(*(m_newState.get()));
-    m_currentState.swap(m_newState);
+    atomic_store(&m_newTransactionState, make_shared<HMState>(*(m_newState.get())));
+    // Publish the new state, the readers pick it up with updateState
+    m_newState = atomic_exchange(&m_currentState, m_newState);
     m_currentState->resheduleDNSChecks(m_newState, m_workQueue);
-    m_currentState->resheduleHealthChecks(m_newState, m_workQueue);
+    m_eventLoop->getCheckSchedule().setConfig(m_currentState->getCheckScheduleConfig());
+    m_workQueue.getDestinationLimiter().setConfig(m_currentState->getDestinationLimitConfig());
+    m_workQueue.setConfig(m_currentState->getWorkQueueConfig());
+    m_currentState->resheduleHealthChecks(m_newState, m_workQueue, *m_eventLoop);
     m_currentState->m_dnsCache.queueDNSLookups(m_workQueue, *m_eventLoop, false);
     m_currentState->m_remoteCache.queueRemoteLookups(m_workQueue, *m_eventLoop, m_currentState->m_hostGroups, false);
     m_currentState->m_remoteHostCache.queueRemoteLookups(m_workQueue, *m_eventLoop, false);
@@ -448,7 +543,9 @@ HMStateManager::swapStates()
     m_eventLoop->wakeupTracker();
     m_workQueue.cycleThreads();
     while(m_newState.use_count() > 1)
-    {}
+    {
+        this_thread::yield();
+    }
     // Load any results that were in flight
     m_currentState->restoreRunningCheckState(m_newState);
 
@@ -463,7 +560,7 @@ HMStateManager::commitDaemonConfigs(HMHash& hash)
     lock_guard<mutex> lg(m_reloadMutex);
 
     // Parse the new config into a check state data structure
-    m_newState = make_shared<HMState>(*(m_newTransactionState.get()));
+    m_newState = make_shared<HMState>(*(atomic_load(&m_newTransactionState).get()));
     if (!m_newState->hashConfigs())
     {
         HMLog(HM_LOG_CRITICAL, "[CORE] Failure Initializing Hashing function");
@@ -522,7 +619,7 @@ HMStateManager::refreshDaemonConfigs()
 bool
 HMStateManager::reloadDaemonConfigs()
 {
-    return reloadDaemonConfigs(m_currentState->getMasterConfig());
+    return reloadDaemonConfigs(atomic_load(&m_currentState)->getMasterConfig());
 }
 
 bool
@@ -572,6 +669,18 @@ HMStateManager::reloadDaemonConfigs(const string& masterConfig)
         HMLog(HM_LOG_WARNING, "Socket path cannot be changed");
     }
 
+    // The curl engine is started and sized once at startup
+    if(m_currentState && m_newState->getCurlEngineThreads() != m_currentState->getCurlEngineThreads())
+    {
+        HMLog(HM_LOG_WARNING, "Curl engine threads cannot be changed without a restart, keeping %u",
+                m_currentState->getCurlEngineThreads());
+        m_newState->setCurlEngineThreads(m_currentState->getCurlEngineThreads());
+    }
+    if(m_curlEngine == nullptr && m_newState->getDefaultHTTPCheckype() == HM_CHECK_PLUGIN_HTTP_CURL_MULTI)
+    {
+        HMLog(HM_LOG_WARNING, "Curl engine cannot be started without a restart, HTTP/S checks stay blocking");
+    }
+
     // deal with the backend setup
     if (!m_newState->openBackend(false))
     {
@@ -691,6 +800,22 @@ HMStateManager::getIdleThreads()
     return m_threadPool->countIdle();
 }
 
+void
+HMStateManager::getThreadInfo(HMAPIThreadInfo& info)
+{
+    m_threadPool->getThreadInfo(info);
+}
+
+void
+HMStateManager::getStoreInfo(HMAPIStoreInfo& info)
+{
+    shared_ptr<HMState> state = atomic_load(&m_currentState);
+    if(state && state->m_datastore)
+    {
+        state->m_datastore->getStoreInfo(info);
+    }
+}
+
 uint64_t
 HMStateManager::getEventQueueSize()
 {
@@ -773,7 +898,7 @@ HMStateManager::setRecycle(bool recycle)
 void
 HMStateManager::setState(shared_ptr<HMState> debugState)
 {
-    m_currentState = debugState;
+    atomic_store(&m_currentState, debugState);
 }
 
 bool HMStateManager::isEnableRemoteQueryReply() const
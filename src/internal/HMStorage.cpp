@@ -1,6 +1,8 @@
 // Copyright 2019, Oath Inc.
 // Licensed under the terms of the Apache 2.0 license. See LICENSE file in the root of the distribution for licensing details.
 #include <vector>
+#include <atomic>
+#include <unordered_set>
 
 #include "HMStorage.h"
 #include "HMAuxCache.h"
@@ -8,6 +10,197 @@
 
 using namespace std;
 
+// Revisions never repeat, even across recreated groups
+static atomic<uint64_t> nextRevision(1);
+
+// Only the state the delta consumers act on moves the sequence, not the check times and counters
+static bool
+stateChanged(const HMDataCheckResult& current, const HMDataCheckResult& update)
+{
+    return current.m_status != update.m_status
+            || !(current.m_address == update.m_address)
+            || current.m_reason != update.m_reason
+            || current.m_forceHostDown != update.m_forceHostDown;
+}
+
+HMGroupCheckResults::HMGroupCheckResults() :
+    m_sequence(0),
+    m_resyncSequence(0)
+{
+    // Recreated groups restart their sequence, tell them apart with the creation time
+    static atomic<uint32_t> created(0);
+    m_epoch = (HMTimeStamp::now().getTimeSinceEpoch() << 10) | (created++ & 0x3FF);
+}
+
+HMGroupCheckResult*
+HMGroupCheckResults::find(const string& hostName, const HMIPAddress& address)
+{
+    auto it = m_index.find(key(hostName, address));
+    if(it == m_index.end())
+    {
+        return nullptr;
+    }
+    return &m_results[it->second];
+}
+
+HMGroupCheckResult*
+HMGroupCheckResults::findUpdate(const string& hostName, const HMIPAddress& address)
+{
+    HMGroupCheckResult* result = find(hostName, address);
+    if(result == nullptr && (address.getType() == AF_INET || address.getType() == AF_INET6))
+    {
+        result = find(hostName, HMIPAddress(address.getType()));
+    }
+    return result;
+}
+
+HMGroupCheckResult*
+HMGroupCheckResults::insert(const HMGroupCheckResult& result)
+{
+    auto it = m_index.insert(make_pair(key(result.m_hostName, result.m_address), m_results.size()));
+    if(!it.second)
+    {
+        HMGroupCheckResult* entry = &m_results[it.first->second];
+        bool changed = !(entry->m_result == result.m_result);
+        bool moved = stateChanged(entry->m_result, result.m_result);
+        uint64_t sequence = entry->m_sequence;
+        uint64_t revision = entry->m_revision;
+        *entry = result;
+        entry->m_sequence = moved ? ++m_sequence : sequence;
+        entry->m_revision = changed ? nextRevision++ : revision;
+        return entry;
+    }
+    m_results.push_back(result);
+    m_results.back().m_sequence = ++m_sequence;
+    m_results.back().m_revision = nextRevision++;
+    m_hostCount[result.m_hostName]++;
+    return &m_results.back();
+}
+
+void
+HMGroupCheckResults::setResult(HMGroupCheckResult* result, const HMDataCheckResult& checkResult)
+{
+    if(!(result->m_result == checkResult))
+    {
+        if(stateChanged(result->m_result, checkResult))
+        {
+            result->m_sequence = ++m_sequence;
+        }
+        result->m_result = checkResult;
+        result->m_revision = nextRevision++;
+    }
+}
+
+void
+HMGroupCheckResults::assign(const vector<HMGroupCheckResult>& results)
+{
+    unordered_set<string> keys;
+    for(auto& result : results)
+    {
+        keys.insert(key(result.m_hostName, result.m_address));
+        HMGroupCheckResult* entry = find(result.m_hostName, result.m_address);
+        if(entry == nullptr)
+        {
+            insert(result);
+            continue;
+        }
+        setResult(entry, result.m_result);
+        entry->m_backendStale = result.m_backendStale;
+        entry->m_commitTime = result.m_commitTime;
+    }
+    vector<pair<string, HMIPAddress>> removed;
+    for(auto& result : m_results)
+    {
+        if(keys.find(key(result.m_hostName, result.m_address)) == keys.end())
+        {
+            removed.push_back(make_pair(result.m_hostName, result.m_address));
+        }
+    }
+    for(auto& it : removed)
+    {
+        erase(it.first, it.second);
+    }
+}
+
+bool
+HMGroupCheckResults::getDelta(uint64_t& epoch, uint64_t& sequence, vector<HMGroupCheckResult>& results) const
+{
+    results.clear();
+    bool delta = (epoch == m_epoch) && (sequence >= m_resyncSequence) && (sequence <= m_sequence);
+    for(auto& result : m_results)
+    {
+        if(!delta || result.m_sequence > sequence)
+        {
+            results.push_back(result);
+        }
+    }
+    epoch = m_epoch;
+    sequence = m_sequence;
+    return delta;
+}
+
+void
+HMGroupCheckResults::setAddress(HMGroupCheckResult* result, const HMIPAddress& address)
+{
+    if(result->m_address == address)
+    {
+        return;
+    }
+    size_t pos = result - m_results.data();
+    m_index.erase(key(result->m_hostName, result->m_address));
+    result->m_address = address;
+    result->m_sequence = ++m_sequence;
+    result->m_revision = nextRevision++;
+    m_index[key(result->m_hostName, address)] = pos;
+}
+
+bool
+HMGroupCheckResults::erase(const string& hostName, const HMIPAddress& address)
+{
+    auto it = m_index.find(key(hostName, address));
+    if(it == m_index.end())
+    {
+        return false;
+    }
+    size_t pos = it->second;
+    m_index.erase(it);
+    m_resyncSequence = ++m_sequence;
+    auto hostIt = m_hostCount.find(hostName);
+    if(hostIt != m_hostCount.end() && --hostIt->second == 0)
+    {
+        m_hostCount.erase(hostIt);
+    }
+    // Fill the hole with the last result so the other positions stay valid
+    if(pos != m_results.size() - 1)
+    {
+        m_results[pos] = std::move(m_results.back());
+        m_index[key(m_results[pos].m_hostName, m_results[pos].m_address)] = pos;
+    }
+    m_results.pop_back();
+    return true;
+}
+
+void
+HMGroupCheckResults::clear()
+{
+    if(!m_results.empty())
+    {
+        m_resyncSequence = ++m_sequence;
+    }
+    m_results.clear();
+    m_index.clear();
+    m_hostCount.clear();
+}
+
+string
+HMGroupCheckResults::key(const string& hostName, const HMIPAddress& address)
+{
+    string key = hostName;
+    key.push_back('\0');
+    key += address.toString();
+    return key;
+}
+
 bool
 HMCheckHeader::operator<(const HMCheckHeader& k) const
 {
@@ -82,6 +275,7 @@ HMStorage::openStore(bool readonly)
     }
     if(!readonly)
     {
+        openQueues(true);
         m_thread = thread(&HMStorage::runStore, this);
     }
 
@@ -98,6 +292,7 @@ HMStorage::closeStore()
             lock_guard<mutex> lg(m_dataReadyMutex);
             m_dataReadyCond.notify_all();
         }
+        openQueues(false);
         if(m_thread.joinable())
         {
             m_thread.join();
@@ -113,12 +308,37 @@ bool HMStorage::validateDBVersion()
     {
         if(configInfo.m_version != HM_MDBM_VERSION)
         {
-             return clearBackend();
+            if(configInfo.m_version < HM_MDBM_VERSION && migrateBackend(configInfo.m_version))
+            {
+                if(m_readonly)
+                {
+                    return true;
+                }
+                configInfo.m_version = HM_MDBM_VERSION;
+                return storeConfigInfo(configInfo);
+            }
+            return clearBackend();
         }
     }
     return true;
 }
 
+bool
+HMStorage::migrateBackend(uint8_t version)
+{
+    (void)version;
+    return false;
+}
+
+bool
+HMStorage::getGroupCheckDelta(const string& groupName, uint64_t& epoch, uint64_t& sequence, vector<HMGroupCheckResult>& results)
+{
+    epoch = 0;
+    sequence = 0;
+    getGroupCheckResults(groupName, results);
+    return false;
+}
+
 void
 HMStorage::updateAuxCommitPolicy(HM_STORAGE_COMMIT_POLICY commitPolicy)
 {
@@ -137,15 +357,61 @@ HMStorage::updateLockPolicy(HM_STORAGE_LOCK_POLICY lockPolicy)
     m_lockPolicy = lockPolicy;
 }
 
+void
+HMStorage::updateQueuePolicy(uint64_t queueSize, uint32_t batchSize, HM_STORAGE_OVERFLOW_POLICY overflowPolicy)
+{
+    m_queueSize = queueSize ? queueSize : HM_DEFAULT_STORAGE_QUEUE_SIZE;
+    m_batchSize = batchSize ? batchSize : HM_DEFAULT_STORAGE_BATCH_SIZE;
+    m_overflowPolicy = overflowPolicy;
+}
+
+void
+HMStorage::getStoreInfo(HMAPIStoreInfo& info)
+{
+    info.m_queueSize = m_queueSize;
+    info.m_batchSize = m_batchSize;
+    info.m_overflowPolicy = m_overflowPolicy;
+}
+
+void
+HMStorage::openQueues(bool open)
+{
+    (void)open;
+}
+
 void
 HMStorage::runStore()
 {
-    unique_lock<mutex> notifyLock(m_dataReadyMutex, defer_lock);
     while(!m_shutdown)
     {
-        notifyLock.lock();
-        m_dataReadyCond.wait(notifyLock, [this](){return commitHealthCheck() || commitAuxInfo() || m_shutdown;});
-        notifyLock.unlock();
+        // Commit without holding the notify lock so the checks never wait on the backend
+        bool checks = commitHealthCheck();
+        bool aux = commitAuxInfo();
+        if(checks || aux)
+        {
+            continue;
+        }
+
+        unique_lock<mutex> lk(m_dataReadyMutex);
+        m_storeSleeping = true;
+        atomic_thread_fence(memory_order_seq_cst);
+        if(!m_shutdown && !pendingCommits())
+        {
+            m_dataReadyCond.wait_for(lk, chrono::milliseconds(HM_STORAGE_IDLE_WAIT));
+        }
+        m_storeSleeping = false;
     }
     while(commitHealthCheck() || commitAuxInfo()) {}
 }
+
+void
+HMStorage::wakeStore()
+{
+    // Pairs with the fence in runStore so either the thread sees the new update or we see it sleeping
+    atomic_thread_fence(memory_order_seq_cst);
+    if(m_storeSleeping)
+    {
+        lock_guard<mutex> lk(m_dataReadyMutex);
+        m_dataReadyCond.notify_one();
+    }
+}
@@ -700,5 +700,18 @@ HMStorageHost::commitAuxInfo()
     return true;
 }
 
+bool
+HMStorageHost::pendingCommits()
+{
+    bool pending = false;
+    m_checkQueueSpinLock.lock();
+    pending = !m_storeCheckQueue.empty();
+    m_checkQueueSpinLock.unlock();
+    m_auxQueueSpinLock.lock();
+    pending = pending || !m_storeAuxQueue.empty();
+    m_auxQueueSpinLock.unlock();
+    return pending;
+}
+
 
 
@@ -1,5 +1,6 @@
 // Copyright 2019, Oath Inc.
 // Licensed under the terms of the Apache 2.0 license. See LICENSE file in the root of the distribution for licensing details.
+#include <map>
 #include <string>
 #include <vector>
 #include <memory>
@@ -15,6 +16,19 @@
 
 using namespace std;
 
+//! Key coalescing the queued updates for the same host and address of a host group.
+template<class T>
+static string
+updateKey(const T& update)
+{
+    string key = update.m_hostGroup;
+    key.push_back('\0');
+    key += update.m_hostName;
+    key.push_back('\0');
+    key += update.m_address.toString();
+    return key;
+}
+
 void
 HMStorageHostGroup::initResultsFromBackend(HMDataCheckList& checkList, HMDNSCache& dnsCache, HMAuxCache& auxCache, HMRemoteHostGroupCache& remoteCache, HMRemoteHostCache& remoteHostCache)
 {
@@ -27,7 +41,11 @@ HMStorageHostGroup::initResultsFromBackend(HMDataCheckList& checkList, HMDNSCach
 
     // shutdown the write thread while re-loading
     m_shutdown = true;
-    m_dataReadyCond.notify_one();
+    {
+        lock_guard<mutex> lk(m_dataReadyMutex);
+        m_dataReadyCond.notify_one();
+    }
+    openQueues(false);
     if(m_thread.joinable())
     {
         m_thread.join();
@@ -45,8 +63,8 @@ HMStorageHostGroup::initResultsFromBackend(HMDataCheckList& checkList, HMDNSCach
     }
 
     // Clear the write queues
-    m_storeCheckQueue = queue<HMGroupCheckUpdate>();
-    m_storeAuxQueue = queue<HMGroupAuxUpdate>();
+    m_storeCheckQueue.clear();
+    m_storeAuxQueue.clear();
 
     // bring in all info from the backend
     multimap<string, HMGroupCheckResult> backendChecks;
@@ -230,7 +248,7 @@ HMStorageHostGroup::initResultsFromBackend(HMDataCheckList& checkList, HMDNSCach
                             it->second.m_result);
         }
         lock_guard<shared_timed_mutex> lock(m_checkUpdateMutex);
-        m_hostGroupResults.insert(make_pair(it->first, it->second));
+        m_hostGroupResults[it->first].insert(it->second);
 
         //Update the remote Cache result time
         if(hostGroup->second.getFlowType() == HM_FLOW_REMOTE_HOSTGROUP_TYPE)
@@ -258,6 +276,7 @@ HMStorageHostGroup::initResultsFromBackend(HMDataCheckList& checkList, HMDNSCach
     // Power up the storage thread again
     if(!m_readonly)
     {
+        openQueues(true);
         m_thread = thread(&HMStorageHostGroup::runStore, this);
     }
 
@@ -348,12 +367,11 @@ HMStorageHostGroup::storeCheckResult(const string& hostname,
         HMLog(HM_LOG_DEBUG, "[STORE] Inserting into store check queue hostgroup %s of host %s", it->c_str(), hostname.c_str());
         HMGroupCheckUpdate update(*it, hostname, address, checkResult);
         // Now add this to the update list
-        m_checkQueueSpinLock.lock();
-        m_storeCheckQueue.push(update);
-        m_checkQueueSpinLock.unlock();
-
-        lock_guard<mutex> lk(m_dataReadyMutex);
-        m_dataReadyCond.notify_one();
+        if(!m_storeCheckQueue.push(update))
+        {
+            HMLog(HM_LOG_DEBUG, "[STORE] Store check queue closed, dropped hostgroup %s of host %s", it->c_str(), hostname.c_str());
+        }
+        wakeStore();
     }
     return true;
 }
@@ -378,13 +396,13 @@ HMStorageHostGroup::getCheckResult(const string& hostname,
         {
             // Now parse out the result and return
             shared_lock<shared_timed_mutex> lock(m_checkUpdateMutex);
-            auto entries = m_hostGroupResults.equal_range(*it);
-            for(auto iit = entries.first; iit != entries.second; ++iit)
+            auto group = m_hostGroupResults.find(*it);
+            if(group != m_hostGroupResults.end())
             {
-                if(iit->second.m_address == address && iit->second.m_hostName == hostname)
+                HMGroupCheckResult* result = group->second.find(hostname, address);
+                if(result != nullptr)
                 {
-                    // if we do, update the entry and stop looking
-                    checkResult = iit->second.m_result;
+                    checkResult = result->m_result;
                     return true;
                 }
             }
@@ -413,17 +431,11 @@ HMStorageHostGroup::purgeCheckResult(const string& hostname,
         {
             // Now parse out the result and return
             lock_guard<shared_timed_mutex> lock(m_checkUpdateMutex);
-            auto entries = m_hostGroupResults.equal_range(*it);
-            for (auto iit = entries.first; iit != entries.second; ++iit)
+            auto group = m_hostGroupResults.find(*it);
+            if (group != m_hostGroupResults.end() && group->second.erase(hostname, address))
             {
-                if (iit->second.m_address == address
-                        && iit->second.m_hostName == hostname)
-                {
-                    m_hostGroupResults.erase(iit);
-                    hostgroup = *it;
-                    found = true;
-                    break;
-                }
+                hostgroup = *it;
+                found = true;
             }
         }
         if (found)
@@ -470,12 +482,11 @@ HMStorageHostGroup::storeAuxInfo(const string& hostname,
         HMGroupAuxUpdate update(*it, hostname, address, auxInfo);
 
         // Now add this to the update list
-        m_auxQueueSpinLock.lock();
-        m_storeAuxQueue.push(update);
-        m_auxQueueSpinLock.unlock();
-
-        lock_guard<mutex> lk(m_dataReadyMutex);
-        m_dataReadyCond.notify_one();
+        if(!m_storeAuxQueue.push(update))
+        {
+            HMLog(HM_LOG_DEBUG, "[STORE] Store aux queue closed, dropped hostgroup %s of host %s", it->c_str(), hostname.c_str());
+        }
+        wakeStore();
     }
     return true;
 }
@@ -612,28 +623,21 @@ HMStorageHostGroup::getDNS(const std::string& hostname, std::set<HMIPAddress>& i
 bool
 HMStorageHostGroup::updateCheckResultCache(HMCheckHeader& header, HMDataCheckResult& result)
 {
-    bool found = false;
     lock_guard<shared_timed_mutex> lock(m_checkUpdateMutex);
     vector<string> hostGroupNames;
     header.m_checkParams.getHostGroups(hostGroupNames);
     for (string groupName : hostGroupNames)
     {
-        auto entries = m_hostGroupResults.equal_range(groupName);
-        for (auto iit = entries.first; iit != entries.second; ++iit)
+        HMGroupCheckResults& groupResults = m_hostGroupResults[groupName];
+        HMGroupCheckResult* entry = groupResults.find(header.m_hostname, result.m_address);
+        if (entry != nullptr)
         {
-            if (iit->second.m_hostName == header.m_hostname
-                    && iit->second.m_address == result.m_address)
-            {
-                // if we do, update the entry and stop looking
-                found = true;
-                iit->second.m_result = result;
-                iit->second.m_address = result.m_address;
-                iit->second.m_result.m_address = result.m_address;
-            }
+            // if we do, update the entry
+            groupResults.setResult(entry, result);
         }
-        if (!found)
+        else
         {
-            m_hostGroupResults.insert(make_pair(groupName, HMGroupCheckResult(header.m_hostname, header.m_address, result)));
+            groupResults.insert(HMGroupCheckResult(header.m_hostname, header.m_address, result));
         }
     }
 
@@ -702,11 +706,7 @@ HMStorageHostGroup::storeHostGroupCheckResult(const string& hostgroupname, vecto
     }
     {
         lock_guard<shared_timed_mutex> lock(m_checkUpdateMutex);
-        m_hostGroupResults.erase(hostgroupname);
-        for(auto& it: checkResult)
-        {
-            m_hostGroupResults.insert(make_pair(hostgroupname, it));
-        }
+        m_hostGroupResults[hostgroupname].assign(checkResult);
     }
     storeHostGroupCheckResults(hostgroupname);
     return true;
@@ -770,15 +770,19 @@ HMStorageHostGroup::getGroupCheckResults(const string& groupName, bool noCache,
     }
 
     shared_lock<shared_timed_mutex> lock(m_checkUpdateMutex);
-    auto range = m_hostGroupResults.equal_range(groupName);
-    for(auto it = range.first; it != range.second; ++it)
+    auto group = m_hostGroupResults.find(groupName);
+    if(group == m_hostGroupResults.end())
+    {
+        return true;
+    }
+    for(auto it = group->second.begin(); it != group->second.end(); ++it)
     {
         if (!onlyResolved
                 || (onlyResolved
-                        && it->second.m_result.m_response != HM_RESPONSE_DNS_FAILED
-                        && it->second.m_result.m_response != HM_RESPONSE_NONE))
+                        && it->m_result.m_response != HM_RESPONSE_DNS_FAILED
+                        && it->m_result.m_response != HM_RESPONSE_NONE))
         {
-            results.push_back(it->second);
+            results.push_back(*it);
         }
     }
     return true;
@@ -789,14 +793,30 @@ HMStorageHostGroup::getGroupCheckResults(const string& groupName, vector<HMGroup
 {
     results.clear();
     shared_lock<shared_timed_mutex> lock(m_checkUpdateMutex);
-    auto range = m_hostGroupResults.equal_range(groupName);
-    for(auto it = range.first; it != range.second; ++it)
+    auto group = m_hostGroupResults.find(groupName);
+    if(group != m_hostGroupResults.end())
     {
-        results.push_back(it->second);
+        results.assign(group->second.begin(), group->second.end());
     }
     return true;
 }
 
+bool
+HMStorageHostGroup::getGroupCheckDelta(const string& groupName, uint64_t& epoch, uint64_t& sequence, vector<HMGroupCheckResult>& results)
+{
+    results.clear();
+    shared_lock<shared_timed_mutex> lock(m_checkUpdateMutex);
+    auto group = m_hostGroupResults.find(groupName);
+    if(group == m_hostGroupResults.end())
+    {
+        // Nothing cached yet, an empty resync
+        epoch = 0;
+        sequence = 0;
+        return false;
+    }
+    return group->second.getDelta(epoch, sequence, results);
+}
+
 
 bool
 HMStorageHostGroup::getGroupAuxInfo(const string& groupName, bool noCache, bool onlyResolved, vector<HMGroupAuxResult>& results)
@@ -840,29 +860,22 @@ HMStorageHostGroup::getGroupAuxInfo(const string& groupName, bool noCache, bool
 bool
 HMStorageHostGroup::updateCheckResultsCache(HMCheckHeader& header, HMDataCheckResult& result)
 {
-    bool found = false;
     lock_guard<shared_timed_mutex> lock(m_checkUpdateMutex);
 
     vector<string> hostGroupNames;
     header.m_checkParams.getHostGroups(hostGroupNames);
     for (string groupName : hostGroupNames)
     {
-        auto entries = m_hostGroupResults.equal_range(groupName);
-        for (auto iit = entries.first; iit != entries.second; ++iit)
+        HMGroupCheckResults& groupResults = m_hostGroupResults[groupName];
+        HMGroupCheckResult* entry = groupResults.find(header.m_hostname, result.m_address);
+        if (entry != nullptr)
         {
-            if (iit->second.m_hostName == header.m_hostname
-                    && iit->second.m_address == result.m_address)
-            {
-                // if we do, update the entry and stop looking
-                found = true;
-                iit->second.m_result = result;
-                iit->second.m_address = result.m_address;
-                iit->second.m_result.m_address = result.m_address;
-            }
+            // if we do, update the entry
+            groupResults.setResult(entry, result);
         }
-        if (!found)
+        else
         {
-            m_hostGroupResults.insert(make_pair(groupName, HMGroupCheckResult(header.m_hostname, header.m_address, result)));
+            groupResults.insert(HMGroupCheckResult(header.m_hostname, header.m_address, result));
         }
     }
 
@@ -872,136 +885,151 @@ HMStorageHostGroup::updateCheckResultsCache(HMCheckHeader& header, HMDataCheckRe
 bool
 HMStorageHostGroup::commitHealthCheck()
 {
-    bool found = false;
-
-    m_checkQueueSpinLock.lock();
-    if(m_storeCheckQueue.size() == 0)
+    vector<HMGroupCheckUpdate> batch;
+    if(m_storeCheckQueue.popBatch(batch, m_batchSize, updateKey<HMGroupCheckUpdate>) == 0)
     {
-        m_checkQueueSpinLock.unlock();
         return false;
     }
 
-    HMGroupCheckUpdate update = m_storeCheckQueue.front();
-    m_storeCheckQueue.pop();
-    m_checkQueueSpinLock.unlock();
+    // Apply the whole batch to the cache first, then evaluate and write each host group once
+    // The pair holds the cold start and the first host flags of the group
+    map<string, pair<bool, bool>> groups;
+    for(auto& update : batch)
+    {
+        bool coldStart = false;
+        if(!applyCheckUpdate(update, coldStart))
+        {
+            continue;
+        }
+        auto it = m_hostGroupMap->find(update.m_hostGroup);
+        auto& flags = groups[update.m_hostGroup];
+        flags.first = flags.first || coldStart;
+        flags.second = flags.second
+                || (!it->second.getHostList()->empty() && update.m_hostName == it->second.getHostList()->front());
+    }
+    for(auto& group : groups)
+    {
+        commitGroupResults(group.first, group.second.first, group.second.second);
+    }
+    return true;
+}
 
-    // Get the check TTL
-    uint64_t ttl;
+bool
+HMStorageHostGroup::applyCheckUpdate(HMGroupCheckUpdate& update, bool& coldStart)
+{
     auto it = m_hostGroupMap->find(update.m_hostGroup);
     if(it == m_hostGroupMap->end())
     {
+        HMLog(HM_LOG_ERROR, "[STORE] HostGroup %s missing HostGroupMap", update.m_hostGroup.c_str());
         return false;
     }
-    else
+    HMDNSLookup dnsHostCheck(it->second.getDNSType(), update.m_address.getType() == AF_INET6, it->second.getRemoteCheck());
+    bool isValidAddress = m_dnsCache->isValidAddress(update.m_hostName,
+            it->second.getDualstack(), dnsHostCheck, update.m_address);
+    if (!isValidAddress && it->second.getFlowType() == HM_FLOW_DNS_HEALTH_TYPE)
     {
-        HMDNSLookup dnsHostCheck(it->second.getDNSType(), update.m_address.getType() == AF_INET6, it->second.getRemoteCheck());
-        bool isValidAddress = m_dnsCache->isValidAddress(update.m_hostName,
-                it->second.getDualstack(), dnsHostCheck, update.m_address);
-        if (!isValidAddress && it->second.getFlowType() == HM_FLOW_DNS_HEALTH_TYPE)
-        {
-            return true;
-        }
+        return false;
     }
-    ttl = it->second.getCheckTTL();
-
-    set<string> hosts;
-    bool coldStart = false;
-    bool allStale = true;
-    HMTimeStamp oldest = HMTimeStamp::now();
-
 
     // Check to see if we already have an entry for this ip address
-    { // establish scope for our lock
-        lock_guard<shared_timed_mutex> lock(m_checkUpdateMutex);
-        auto entries = m_hostGroupResults.equal_range(update.m_hostGroup);
-        for(auto iit = entries.first; iit != entries.second; ++iit)
-        {
-            if (!found
-                    && (iit->second.m_hostName == update.m_hostName)
-                    && ((iit->second.m_address == update.m_address)
-                            || (update.m_address.getType() == AF_INET6
-                                    && iit->second.m_address == HMIPAddress(AF_INET6))
-                            || (update.m_address.getType() == AF_INET
-                                    && iit->second.m_address == HMIPAddress(AF_INET))))
-            {
-                // if we do, update the entry and stop looking
-                found = true;
-                iit->second.m_result = update.m_result;
-                iit->second.m_address = update.m_address;
-                iit->second.m_result.m_address = update.m_address;
-                iit->second.m_backendStale = true;
-            }
-            allStale = (allStale && iit->second.m_backendStale);
-            oldest = (iit->second.m_commitTime < oldest) ? iit->second.m_commitTime : oldest;
-            hosts.insert(iit->second.m_hostName);
-        }
+    lock_guard<shared_timed_mutex> lock(m_checkUpdateMutex);
+    HMGroupCheckResults& groupResults = m_hostGroupResults[update.m_hostGroup];
+    HMGroupCheckResult* entry = groupResults.findUpdate(update.m_hostName, update.m_address);
+    if(entry != nullptr)
+    {
+        groupResults.setAddress(entry, update.m_address);
+        HMDataCheckResult result = update.m_result;
+        result.m_address = update.m_address;
+        groupResults.setResult(entry, result);
+        entry->m_backendStale = true;
     }
-    if(!found)
+    else
     {
-        coldStart  = true;
-        hosts.insert(update.m_hostName);
         // If no entry is found add one
-        lock_guard<shared_timed_mutex> lock(m_checkUpdateMutex);
-        m_hostGroupResults.insert(make_pair(update.m_hostGroup, HMGroupCheckResult(update.m_hostName, update.m_address, update.m_result)));
+        coldStart = true;
+        groupResults.insert(HMGroupCheckResult(update.m_hostName, update.m_address, update.m_result));
     }
+    return true;
+}
 
-    // Note this is where we can insert a check to see if update on every cycle... ie a timeout or update only when the whole rotation is updated
-    // Update only if all the hosts information are available
-    auto hostGroupIt = m_hostGroupMap->find(update.m_hostGroup);
-    if (hostGroupIt != m_hostGroupMap->end())
+void
+HMStorageHostGroup::commitGroupResults(const string& hostGroup, bool coldStart, bool firstHost)
+{
+    auto hostGroupIt = m_hostGroupMap->find(hostGroup);
+    if (hostGroupIt == m_hostGroupMap->end())
     {
-        // If we don't have the full health check complete return
-        if(hosts.size() < hostGroupIt->second.getHostList()->size())
+        return;
+    }
+    uint64_t ttl = hostGroupIt->second.getCheckTTL();
+
+    bool allStale = true;
+    HMTimeStamp oldest = HMTimeStamp::now();
+    {
+        shared_lock<shared_timed_mutex> lock(m_checkUpdateMutex);
+        auto group = m_hostGroupResults.find(hostGroup);
+        if(group == m_hostGroupResults.end())
         {
-            return true;
+            return;
         }
 
-        // Now we choose if we should commit the entry.
-        // No matter what our update strategy is, we push an update if this is the last host in the initial check cycle
-        // Also update if we are in amways commit.
-        if(coldStart
-                || (m_healthCheckCommitPolicy == HM_STORAGE_COMMIT_ALWAYS)
-                || ((m_healthCheckCommitPolicy == HM_STORAGE_COMMIT_ON_FIRST) && (update.m_hostName == hostGroupIt->second.getHostList()->front()))
-                || ((m_healthCheckCommitPolicy == HM_STORAGE_COMMIT_ON_ALL_READY) && allStale)
-                || ((m_healthCheckCommitPolicy == HM_STORAGE_COMMIT_ON_TTL) && (ttl < (HMTimeStamp::now() - oldest))))
+        // Note this is where we can insert a check to see if update on every cycle... ie a timeout or update only when the whole rotation is updated
+        // Update only if all the hosts information are available
+        if(group->second.hostCount() < hostGroupIt->second.getHostList()->size())
+        {
+            return;
+        }
+        for(auto& entry : group->second)
         {
-            storeHostGroupCheckResults(update.m_hostGroup);
+            allStale = (allStale && entry.m_backendStale);
+            oldest = (entry.m_commitTime < oldest) ? entry.m_commitTime : oldest;
+        }
+    }
 
-            // Now set the proper cache params for the next commit
+    // Now we choose if we should commit the entry.
+    // No matter what our update strategy is, we push an update if this is the last host in the initial check cycle
+    // Also update if we are in amways commit.
+    if(coldStart
+            || (m_healthCheckCommitPolicy == HM_STORAGE_COMMIT_ALWAYS)
+            || ((m_healthCheckCommitPolicy == HM_STORAGE_COMMIT_ON_FIRST) && firstHost)
+            || ((m_healthCheckCommitPolicy == HM_STORAGE_COMMIT_ON_ALL_READY) && allStale)
+            || ((m_healthCheckCommitPolicy == HM_STORAGE_COMMIT_ON_TTL) && (ttl < (HMTimeStamp::now() - oldest))))
+    {
+        storeHostGroupCheckResults(hostGroup);
 
-            lock_guard<shared_timed_mutex> lock(m_checkUpdateMutex);
-            auto entries = m_hostGroupResults.equal_range(update.m_hostGroup);
+        // Now set the proper cache params for the next commit
+        lock_guard<shared_timed_mutex> lock(m_checkUpdateMutex);
+        auto group = m_hostGroupResults.find(hostGroup);
+        if(group != m_hostGroupResults.end())
+        {
             HMTimeStamp ts = HMTimeStamp::now();
-            for(auto iit = entries.first; iit != entries.second; ++iit)
+            for(auto& entry : group->second)
             {
-                iit->second.m_backendStale = false;
-                iit->second.m_commitTime = ts;
+                entry.m_backendStale = false;
+                entry.m_commitTime = ts;
             }
         }
     }
-    else
-    {
-        HMLog(HM_LOG_ERROR, "[STORE] HostGroup %s missing HostGroupMap ");
-        return false;
-    }
-    return true;
 }
 
 bool
 HMStorageHostGroup::commitAuxInfo()
 {
-    bool found = false;
-
-    m_auxQueueSpinLock.lock();
-    if(m_storeAuxQueue.size() == 0)
+    vector<HMGroupAuxUpdate> batch;
+    if(m_storeAuxQueue.popBatch(batch, m_batchSize, updateKey<HMGroupAuxUpdate>) == 0)
     {
-        m_auxQueueSpinLock.unlock();
         return false;
     }
+    for(auto& update : batch)
+    {
+        commitAuxUpdate(update);
+    }
+    return true;
+}
 
-    HMGroupAuxUpdate update = m_storeAuxQueue.front();
-    m_storeAuxQueue.pop();
-    m_auxQueueSpinLock.unlock();
+bool
+HMStorageHostGroup::commitAuxUpdate(HMGroupAuxUpdate& update)
+{
+    bool found = false;
 
     // Get the check TTL
     uint64_t ttl;
@@ -1105,6 +1133,48 @@ HMStorageHostGroup::commitAuxInfo()
     return true;
 }
 
+bool
+HMStorageHostGroup::pendingCommits()
+{
+    return !m_storeCheckQueue.empty() || !m_storeAuxQueue.empty();
+}
+
+void
+HMStorageHostGroup::openQueues(bool open)
+{
+    m_storeCheckQueue.setOpen(open);
+    m_storeAuxQueue.setOpen(open);
+}
+
+void
+HMStorageHostGroup::updateQueuePolicy(uint64_t queueSize, uint32_t batchSize, HM_STORAGE_OVERFLOW_POLICY overflowPolicy)
+{
+    HMStorage::updateQueuePolicy(queueSize, batchSize, overflowPolicy);
+    m_storeCheckQueue.setConfig(m_queueSize, m_overflowPolicy);
+    m_storeAuxQueue.setConfig(m_queueSize, m_overflowPolicy);
+}
+
+void
+HMStorageHostGroup::getStoreInfo(HMAPIStoreInfo& info)
+{
+    HMStorage::getStoreInfo(info);
+    HMStorageQueueStats stats;
+    m_storeCheckQueue.getStats(stats);
+    info.m_checksQueued = stats.m_queued;
+    info.m_checksEnqueued = stats.m_enqueued;
+    info.m_checksDropped = stats.m_dropped;
+    info.m_checksBlocked = stats.m_blocked;
+    info.m_checksCoalesced = stats.m_coalesced;
+    info.m_checkBatches = stats.m_batches;
+    m_storeAuxQueue.getStats(stats);
+    info.m_auxQueued = stats.m_queued;
+    info.m_auxEnqueued = stats.m_enqueued;
+    info.m_auxDropped = stats.m_dropped;
+    info.m_auxBlocked = stats.m_blocked;
+    info.m_auxCoalesced = stats.m_coalesced;
+    info.m_auxBatches = stats.m_batches;
+}
+
 bool
 HMStorageHostGroup::getInternalHostGroupInfo(const string& hostGroupName, const HMDataHostGroup* &hostGroup)
 {
@@ -1124,11 +1194,11 @@ HMStorageHostGroup::getInternalCheckResults(const string& hostGroupName, vector<
     results.clear();
 
     shared_lock<shared_timed_mutex> lock(m_checkUpdateMutex);
-    auto rangeResults = m_hostGroupResults.equal_range(hostGroupName);
-    for(auto it = rangeResults.first; it != rangeResults.second; ++it)
+    auto group = m_hostGroupResults.find(hostGroupName);
+    if(group != m_hostGroupResults.end())
     {
-        count++;
-        results.push_back(it->second);
+        results.assign(group->second.begin(), group->second.end());
+        count = results.size();
     }
     return count;
 }
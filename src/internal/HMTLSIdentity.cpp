@@ -0,0 +1,198 @@
+// Copyright 2019, Oath Inc.
+// Licensed under the terms of the Apache 2.0 license. See LICENSE file in the root of the distribution for licensing details.
+#include <openssl/pem.h>
+#include <openssl/err.h>
+
+#include "HMTLSIdentity.h"
+#include "HMHashMD5.h"
+#include "HMLogBase.h"
+
+using namespace std;
+
+HMTLSIdentity::~HMTLSIdentity()
+{
+    if(m_clientCtx != nullptr)
+    {
+        SSL_CTX_free(m_clientCtx);
+    }
+    if(m_chain != nullptr)
+    {
+        sk_X509_pop_free(m_chain, X509_free);
+    }
+    if(m_cert != nullptr)
+    {
+        X509_free(m_cert);
+    }
+    if(m_key != nullptr)
+    {
+        EVP_PKEY_free(m_key);
+    }
+}
+
+shared_ptr<HMTLSIdentity>
+HMTLSIdentity::create(const string& key, const string& cert)
+{
+    shared_ptr<HMTLSIdentity> identity(new HMTLSIdentity());
+
+    BIO* bio = BIO_new_mem_buf(key.c_str(), key.size());
+    if(bio != nullptr)
+    {
+        identity->m_key = PEM_read_bio_PrivateKey(bio, NULL, 0, NULL);
+        BIO_free(bio);
+    }
+    if(identity->m_key == nullptr)
+    {
+        HMLog(HM_LOG_ERROR, "[TLS] Failed to parse the health check key");
+        return nullptr;
+    }
+
+    bio = BIO_new_mem_buf(cert.c_str(), cert.size());
+    if(bio != nullptr)
+    {
+        identity->m_cert = PEM_read_bio_X509(bio, NULL, 0, NULL);
+        identity->m_chain = sk_X509_new_null();
+        X509* ca;
+        while(identity->m_chain != nullptr && (ca = PEM_read_bio_X509(bio, NULL, 0, NULL)) != nullptr)
+        {
+            sk_X509_push(identity->m_chain, ca);
+        }
+        // Reading past the last certificate leaves an error on the queue
+        ERR_clear_error();
+        BIO_free(bio);
+    }
+    if(identity->m_cert == nullptr || identity->m_chain == nullptr)
+    {
+        HMLog(HM_LOG_ERROR, "[TLS] Failed to parse the health check certificate");
+        return nullptr;
+    }
+
+    if(X509_check_private_key(identity->m_cert, identity->m_key) != 1)
+    {
+        ERR_clear_error();
+        HMLog(HM_LOG_ERROR, "[TLS] The health check key does not match the certificate");
+        return nullptr;
+    }
+
+    identity->m_clientCtx = SSL_CTX_new(SSLv23_client_method());
+    if(identity->m_clientCtx == nullptr || !identity->useIdentity(identity->m_clientCtx))
+    {
+        HMLog(HM_LOG_ERROR, "[TLS] Failed to create the health check SSL context");
+        return nullptr;
+    }
+    return identity;
+}
+
+bool
+HMTLSIdentity::useIdentity(SSL_CTX* ctx) const
+{
+    if(SSL_CTX_use_certificate(ctx, m_cert) != 1 || SSL_CTX_use_PrivateKey(ctx, m_key) != 1)
+    {
+        return false;
+    }
+    for(int i = 0; i < sk_X509_num(m_chain); i++)
+    {
+        if(SSL_CTX_add1_chain_cert(ctx, sk_X509_value(m_chain, i)) != 1)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool
+HMTLSIdentity::useIdentity(SSL* ssl) const
+{
+    if(SSL_use_certificate(ssl, m_cert) != 1 || SSL_use_PrivateKey(ssl, m_key) != 1)
+    {
+        return false;
+    }
+    for(int i = 0; i < sk_X509_num(m_chain); i++)
+    {
+        if(SSL_add1_chain_cert(ssl, sk_X509_value(m_chain, i)) != 1)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+SSL_CTX*
+HMTLSIdentity::getClientCtx() const
+{
+    return m_clientCtx;
+}
+
+CURLcode
+HMTLSIdentity::curlSslCtxCallback(CURL* curl, void* sslctx, void* arg)
+{
+    (void)curl;
+    const HMTLSIdentity* identity = (const HMTLSIdentity*) arg;
+    if(!identity->useIdentity((SSL_CTX*) sslctx))
+    {
+        HMLog(HM_LOG_ERROR, "[TLS] Failed to use the health check certificate");
+        return CURLE_SSL_CERTPROBLEM;
+    }
+    return CURLE_OK;
+}
+
+HMTLSIdentityCache&
+HMTLSIdentityCache::instance()
+{
+    static HMTLSIdentityCache cache;
+    return cache;
+}
+
+shared_ptr<HMTLSIdentity>
+HMTLSIdentityCache::get(const string& key, const string& cert)
+{
+    HMHashMD5 md5;
+    HMHash hash;
+    if(!md5.init())
+    {
+        return HMTLSIdentity::create(key, cert);
+    }
+    md5.update(key.c_str(), key.size());
+    md5.update(cert.c_str(), cert.size());
+    md5.final(hash);
+    string id((char*)hash.m_hashValue, hash.m_hashSize);
+
+    lock_guard<mutex> lk(m_mutex);
+    // Drop the identities of rotated credentials
+    for(auto it = m_identities.begin(); it != m_identities.end();)
+    {
+        it = it->second.expired() ? m_identities.erase(it) : next(it);
+    }
+
+    auto it = m_identities.find(id);
+    if(it != m_identities.end())
+    {
+        shared_ptr<HMTLSIdentity> identity = it->second.lock();
+        if(identity)
+        {
+            return identity;
+        }
+    }
+
+    shared_ptr<HMTLSIdentity> identity = HMTLSIdentity::create(key, cert);
+    if(identity)
+    {
+        m_identities[id] = identity;
+        HMLog(HM_LOG_INFO, "[TLS] Loaded health check client certificate");
+    }
+    return identity;
+}
+
+uint32_t
+HMTLSIdentityCache::size()
+{
+    lock_guard<mutex> lk(m_mutex);
+    uint32_t count = 0;
+    for(auto& it : m_identities)
+    {
+        if(!it.second.expired())
+        {
+            count++;
+        }
+    }
+    return count;
+}
@@ -0,0 +1,83 @@
+// Copyright 2019, Oath Inc.
+// Licensed under the terms of the Apache 2.0 license. See LICENSE file in the root of the distribution for licensing details.
+#include <ctime>
+
+#include "HMTLSSessionCache.h"
+
+using namespace std;
+
+HMTLSSessionCache::~HMTLSSessionCache()
+{
+    clear();
+}
+
+SSL_SESSION*
+HMTLSSessionCache::get(const HMIPAddress& address, uint16_t port, SSL_CTX* ctx)
+{
+    lock_guard<mutex> lk(m_mutex);
+    auto it = m_sessions.find(make_pair(address, port));
+    if(it == m_sessions.end() || it->second.m_ctx != ctx)
+    {
+        return nullptr;
+    }
+    SSL_SESSION* session = it->second.m_session;
+    if((uint64_t)time(nullptr) >= (uint64_t)SSL_SESSION_get_time(session) + SSL_SESSION_get_timeout(session))
+    {
+        SSL_SESSION_free(session);
+        m_sessions.erase(it);
+        return nullptr;
+    }
+    SSL_SESSION_up_ref(session);
+    return session;
+}
+
+void
+HMTLSSessionCache::store(const HMIPAddress& address, uint16_t port, SSL_CTX* ctx, SSL_SESSION* session)
+{
+    lock_guard<mutex> lk(m_mutex);
+    auto key = make_pair(address, port);
+    auto it = m_sessions.find(key);
+    if(it != m_sessions.end())
+    {
+        SSL_SESSION_free(it->second.m_session);
+        it->second.m_ctx = ctx;
+        it->second.m_session = session;
+        return;
+    }
+    if(m_sessions.size() >= m_maxSessions)
+    {
+        SSL_SESSION_free(m_sessions.begin()->second.m_session);
+        m_sessions.erase(m_sessions.begin());
+    }
+    m_sessions.insert(make_pair(key, Entry{ctx, session}));
+}
+
+void
+HMTLSSessionCache::remove(const HMIPAddress& address, uint16_t port)
+{
+    lock_guard<mutex> lk(m_mutex);
+    auto it = m_sessions.find(make_pair(address, port));
+    if(it != m_sessions.end())
+    {
+        SSL_SESSION_free(it->second.m_session);
+        m_sessions.erase(it);
+    }
+}
+
+void
+HMTLSSessionCache::clear()
+{
+    lock_guard<mutex> lk(m_mutex);
+    for(auto& it : m_sessions)
+    {
+        SSL_SESSION_free(it.second.m_session);
+    }
+    m_sessions.clear();
+}
+
+uint64_t
+HMTLSSessionCache::size()
+{
+    lock_guard<mutex> lk(m_mutex);
+    return m_sessions.size();
+}
@@ -1,23 +1,34 @@
 // Copyright 2019, Oath Inc.
 // Licensed under the terms of the Apache 2.0 license. See LICENSE file in the root of the distribution for licensing details.
 #include <tgmath.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <chrono>
+#include <fstream>
 
 #include "HMThreadPool.h"
 
 using namespace std;
 
+void
+HMThreadPool::startWorker(uint32_t index)
+{
+    unique_ptr<HMThreadWorker> mw = make_unique<HMThreadWorker>(HMThreadWorker(m_stateManager, m_eventLoop));
+    thread newThread(&HMThreadWorker::runThread, mw.get());
+    m_workers[index] = move(make_pair(move(mw), move(newThread)));
+}
+
 void
 HMThreadPool::resize(uint64_t nThreads)
 {
+    lock_guard<mutex> lg(m_poolMutex);
     // increase threads
     if(nThreads > m_nThreads)
     {
         m_workers.resize(nThreads);
         for(uint32_t i = m_nThreads; i < nThreads; i++)
         {
-            unique_ptr<HMThreadWorker> mw = make_unique<HMThreadWorker>(HMThreadWorker(m_stateManager, m_eventLoop));
-            thread newThread(&HMThreadWorker::runThread, mw.get());
-            m_workers[i] = move(make_pair(move(mw), move(newThread)));
+            startWorker(i);
         }
     }
     // decrease threads
@@ -40,6 +51,7 @@ HMThreadPool::resize(uint64_t nThreads)
 uint64_t
 HMThreadPool::countIdle()
 {
+    lock_guard<mutex> lg(m_poolMutex);
     uint64_t total = 0;
     for(auto it = m_workers.begin(); it != m_workers.end(); ++it)
     {
@@ -55,20 +67,68 @@ void
 HMThreadPool::recycleThreads()
 {
     HMLog(HM_LOG_NOTICE, "[CORE] Recycling of threads started");
+    lock_guard<mutex> lg(m_poolMutex);
+    // Replace the workers one at a time so the rest of the pool keeps serving the queue
     for (uint32_t i = 0; i < m_nThreads; i++)
     {
-        if (m_workers[i].first->getUsedCounter() > 10000)
+        if (m_workers[i].first->getUsedCounter() > 0)
         {
             m_workers[i].first->shutDown();
+            m_stateManager->m_workQueue.cycleThreads();
             m_workers[i].second.join();
-            unique_ptr<HMThreadWorker> mw = make_unique<HMThreadWorker>(HMThreadWorker(m_stateManager, m_eventLoop));
-            thread newThread(&HMThreadWorker::runThread, mw.get());
-            m_workers[i] = move(make_pair(move(mw), move(newThread)));
+            startWorker(i);
         }
     }
+    m_nRecycles++;
     HMLog(HM_LOG_NOTICE, "[CORE] Recycling of threads completed");
 }
 
+bool
+HMThreadPool::getResourceUsage(uint64_t& residentMemory, uint64_t& openFiles)
+{
+    ifstream statm("/proc/self/statm");
+    uint64_t size = 0;
+    uint64_t resident = 0;
+    if(!(statm >> size >> resident))
+    {
+        return false;
+    }
+    residentMemory = resident * (sysconf(_SC_PAGESIZE) / 1024);
+
+    DIR* dir = opendir("/proc/self/fd");
+    if(dir == nullptr)
+    {
+        return false;
+    }
+    openFiles = 0;
+    while(readdir(dir) != nullptr)
+    {
+        openFiles++;
+    }
+    closedir(dir);
+    // Skip the . and .. entries and the descriptor of the directory itself
+    openFiles = openFiles > 3 ? openFiles - 3 : 0;
+    return true;
+}
+
+bool
+HMThreadPool::needsRecycle(const HMThreadPoolConfig& config) const
+{
+    if(config.m_recycleMemoryGrowth > 0
+            && m_residentMemory * 100 > m_baseMemory * (100 + config.m_recycleMemoryGrowth))
+    {
+        HMLog(HM_LOG_NOTICE, "[CORE] Resident memory grew from %lu kB to %lu kB", m_baseMemory, m_residentMemory);
+        return true;
+    }
+    if(config.m_recycleFileGrowth > 0
+            && m_openFiles > m_baseFiles + config.m_recycleFileGrowth)
+    {
+        HMLog(HM_LOG_NOTICE, "[CORE] Open descriptors grew from %lu to %lu", m_baseFiles, m_openFiles);
+        return true;
+    }
+    return false;
+}
+
 void
 HMThreadPool::monitorThreads()
 {
@@ -77,51 +137,64 @@ HMThreadPool::monitorThreads()
 
     resize(currentState->getMaxThreads());
     currentState.reset();
-    int confidence = 0;
-    uint32_t exp = 0;
-    uint64_t counter = 0;
+    getResourceUsage(m_baseMemory, m_baseFiles);
+    vector<uint64_t> waitHistogram;
+    auto lastSample = chrono::steady_clock::now();
     HMLog(HM_LOG_NOTICE, "[CORE] Starting threadpool monitor");
     while(!m_shutdown)
     {
-        m_stateManager->updateState(currentState);
-        exp+=1;
-        uint64_t offSchedule = m_stateManager->m_workQueue.getNumOffSchedule() + m_stateManager->m_workQueue.queueSize();
-        uint64_t idle = countIdle();
-        uint32_t stride = (m_stridePercent * m_nThreads)/ 100;
-        if(offSchedule > 0)
+        sleep(m_monitorFrequency);
+        if(m_shutdown)
         {
-            exp=1;
-            m_stateManager->m_workQueue.setNumOffSchedule(0);
-            uint64_t newNThreads = m_nThreads + ceil((double)offSchedule/(double)m_workPerThreadRatio);
-            uint64_t nThreads = currentState->getMaxThreads();
-            resize(newNThreads > nThreads ? nThreads : newNThreads);
+            break;
         }
-        else if(idle > stride)
+        m_stateManager->updateState(currentState);
+        const HMThreadPoolConfig& config = currentState->getThreadPoolConfig();
+
+        // Measure the last interval
+        auto now = chrono::steady_clock::now();
+        uint64_t elapsed = chrono::duration_cast<chrono::microseconds>(now - lastSample).count();
+        lastSample = now;
+        waitHistogram.assign(HM_WORK_QUEUE_WAIT_BUCKETS, 0);
+        m_stateManager->m_workQueue.collectQueueWait(waitHistogram);
+        uint64_t queued = m_stateManager->m_workQueue.getNumOffSchedule() + m_stateManager->m_workQueue.queueSize();
+        m_stateManager->m_workQueue.setNumOffSchedule(0);
+
+        uint64_t target;
+        uint64_t nThreads;
         {
-            exp=1;
-            confidence+=1;
-            if(confidence >= 3)
+            lock_guard<mutex> lg(m_poolMutex);
+            uint64_t busy = 0;
+            for(auto& worker : m_workers)
             {
-                confidence = 0;
-                uint64_t newNThreads =  m_nThreads - stride;
-                uint64_t nThreads = currentState->getMinThreads();;
-                resize(newNThreads < nThreads ? nThreads : newNThreads);
+                busy += worker.first->collectBusyTime();
             }
-
+            nThreads = m_nThreads;
+            uint64_t utilisation = (elapsed && nThreads) ? (busy * 100) / (elapsed * nThreads) : 0;
+            m_controller.setConfig(config, currentState->getMinThreads(), currentState->getMaxThreads(),
+                    m_stridePercent, m_workPerThreadRatio);
+            target = m_controller.update(nThreads, waitHistogram, utilisation > 100 ? 100 : utilisation, queued);
+            getResourceUsage(m_residentMemory, m_openFiles);
         }
-        else
+        if(target != nThreads)
         {
-            confidence = 0;
+            HMAPIThreadInfo info;
+            {
+                lock_guard<mutex> lg(m_poolMutex);
+                m_controller.getStats(info);
+            }
+            HMLog(HM_LOG_INFO, "[CORE] Resizing the thread pool from %lu to %lu threads, queue wait p50 %lu ms p99 %lu ms, utilisation %u%%, %lu queued",
+                    nThreads, target, info.m_queueWaitP50, info.m_queueWaitP99, info.m_utilisation, queued);
+            resize(target);
         }
-        counter+=m_monitorFrequency;
-        lock_guard<mutex> lock();
-        if (isRecycle() && counter >= 3600)
+
+        if (isRecycle() && needsRecycle(config))
         {
             recycleThreads();
-            counter = 0;
+            lock_guard<mutex> lg(m_poolMutex);
+            getResourceUsage(m_baseMemory, m_baseFiles);
         }
         currentState.reset();
-        sleep(m_monitorFrequency);
     }
     HMLog(HM_LOG_NOTICE, "[CORE] Shutting down threadpool monitor");
 }
@@ -130,6 +203,7 @@ void
 HMThreadPool::shutdown()
 {
     m_shutdown = true;
+    lock_guard<mutex> lg(m_poolMutex);
     for(auto it = m_workers.begin(); it != m_workers.end(); ++it)
     {
         it->first->shutDown();
@@ -142,6 +216,25 @@ HMThreadPool::shutdown()
     m_workers.clear();
 }
 
+void
+HMThreadPool::getThreadInfo(HMAPIThreadInfo& info)
+{
+    lock_guard<mutex> lg(m_poolMutex);
+    info.m_numThreads = m_nThreads;
+    info.m_numIdleThreads = 0;
+    for(auto& worker : m_workers)
+    {
+        if(worker.first->isIdle())
+        {
+            info.m_numIdleThreads++;
+        }
+    }
+    m_controller.getStats(info);
+    info.m_numRecycles = m_nRecycles;
+    info.m_residentMemory = m_residentMemory;
+    info.m_openFiles = m_openFiles;
+}
+
 uint64_t
 HMThreadPool::getNThreads()
 {
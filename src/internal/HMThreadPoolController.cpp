@@ -0,0 +1,114 @@
+// Copyright 2019, Oath Inc.
+// Licensed under the terms of the Apache 2.0 license. See LICENSE file in the root of the distribution for licensing details.
+#include "HMThreadPoolController.h"
+
+using namespace std;
+
+void
+HMThreadPoolController::setConfig(const HMThreadPoolConfig& config, uint64_t minThreads, uint64_t maxThreads,
+        uint32_t stridePercent, uint32_t workPerThreadRatio)
+{
+    m_config = config;
+    m_minThreads = minThreads ? minThreads : 1;
+    m_maxThreads = maxThreads < m_minThreads ? m_minThreads : maxThreads;
+    m_stridePercent = stridePercent;
+    m_workPerThreadRatio = workPerThreadRatio ? workPerThreadRatio : 1;
+}
+
+uint64_t
+HMThreadPoolController::update(uint64_t nThreads, const vector<uint64_t>& waitHistogram, uint32_t utilisation, uint64_t queued)
+{
+    m_waitP50 = getPercentile(waitHistogram, 50);
+    m_waitP99 = getPercentile(waitHistogram, 99);
+    m_utilisation = utilisation;
+
+    uint64_t target = nThreads;
+    bool late = m_waitP99 > m_config.m_targetWait;
+    bool saturated = utilisation >= m_config.m_highUtilisation && queued > 0;
+    if(late || saturated)
+    {
+        m_lowIntervals = 0;
+        uint64_t growth = (nThreads * m_config.m_growthPercent + 99) / 100;
+        uint64_t backlog = (queued + m_workPerThreadRatio - 1) / m_workPerThreadRatio;
+        if(backlog > growth)
+        {
+            growth = backlog;
+        }
+        if(m_waitP99 > 4 * (uint64_t)m_config.m_targetWait)
+        {
+            growth *= 2;
+        }
+        target = nThreads + (growth ? growth : 1);
+    }
+    else if(utilisation < m_config.m_lowUtilisation && queued == 0
+            && m_waitP99 <= m_config.m_targetWait / 2)
+    {
+        if(++m_lowIntervals >= m_config.m_shrinkIntervals)
+        {
+            m_lowIntervals = 0;
+            uint64_t stride = (nThreads * m_stridePercent) / 100;
+            target = nThreads - (stride ? stride : 1);
+        }
+    }
+    else
+    {
+        m_lowIntervals = 0;
+    }
+
+    if(target > m_maxThreads)
+    {
+        target = m_maxThreads;
+    }
+    if(target < m_minThreads)
+    {
+        target = m_minThreads;
+    }
+    if(target > nThreads)
+    {
+        m_nGrows++;
+    }
+    else if(target < nThreads)
+    {
+        m_nShrinks++;
+    }
+    m_target = target;
+    return target;
+}
+
+uint64_t
+HMThreadPoolController::getPercentile(const vector<uint64_t>& waitHistogram, uint32_t percentile)
+{
+    uint64_t total = 0;
+    for(auto count : waitHistogram)
+    {
+        total += count;
+    }
+    if(total == 0)
+    {
+        return 0;
+    }
+    uint64_t rank = (total * percentile + 99) / 100;
+    uint64_t seen = 0;
+    for(size_t i = 0; i < waitHistogram.size(); i++)
+    {
+        seen += waitHistogram[i];
+        if(seen >= rank)
+        {
+            return i == 0 ? 0 : (1ULL << i);
+        }
+    }
+    return 1ULL << (waitHistogram.size() - 1);
+}
+
+void
+HMThreadPoolController::getStats(HMAPIThreadInfo& info) const
+{
+    info.m_minThreads = m_minThreads;
+    info.m_maxThreads = m_maxThreads;
+    info.m_targetThreads = m_target;
+    info.m_queueWaitP50 = m_waitP50;
+    info.m_queueWaitP99 = m_waitP99;
+    info.m_utilisation = m_utilisation;
+    info.m_numGrows = m_nGrows;
+    info.m_numShrinks = m_nShrinks;
+}
@@ -3,6 +3,7 @@
 #include <signal.h>
 #include <cstring>
 #include <sstream>
+#include <chrono>
 
 #include "HMThreadWorker.h"
 #include "HMWork.h"
@@ -38,6 +39,7 @@ HMThreadWorker::runThread()
         {
             m_idle = false;
             m_nUsed+=1;
+            auto start = chrono::steady_clock::now();
             m_order->init(m_workState);
             m_order->updateState(m_stateManager, m_eventLoop);
             HM_WORK_STATUS result = m_order->processWork();
@@ -45,6 +47,7 @@ HMThreadWorker::runThread()
             {
                 m_stateManager->m_workQueue.insertMap(m_order);
             }
+            m_busyTime += chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - start).count();
             m_idle = true;
         }
     }
@@ -69,3 +72,9 @@ HMThreadWorker::getUsedCounter()
     return m_nUsed;
 }
 
+uint64_t
+HMThreadWorker::collectBusyTime()
+{
+    return m_busyTime.exchange(0);
+}
+
@@ -74,6 +74,44 @@ void HMWork::updateState(HMStateManager* stateManager, HMEventLoop* eventLoop)
     m_eventLoop = eventLoop;
 }
 
+HM_WORK_CLASS HMWork::getWorkClass()
+{
+    if(m_workClass != HM_WORK_CLASS_DEFAULT)
+    {
+        return m_workClass;
+    }
+    switch(getWorkType())
+    {
+    case HM_WORK_DNSLOOKUP:
+        m_workClass = HM_WORK_CLASS_DNSLOOKUP;
+        break;
+    case HM_WORK_AUXFETCH:
+        m_workClass = HM_WORK_CLASS_AUXFETCH;
+        break;
+    case HM_WORK_REMOTECHECK:
+    case HM_WORK_REMOTEHOSTCHECK:
+        m_workClass = HM_WORK_CLASS_REMOTE;
+        break;
+    case HM_WORK_HEALTHCHECK:
+    default:
+        switch(m_hostCheck.getPriority())
+        {
+        case HM_WORK_PRIORITY_HIGH:
+            m_workClass = HM_WORK_CLASS_HIGH;
+            break;
+        case HM_WORK_PRIORITY_LOW:
+            m_workClass = HM_WORK_CLASS_LOW;
+            break;
+        case HM_WORK_PRIORITY_NORMAL:
+        default:
+            m_workClass = HM_WORK_CLASS_HEALTHCHECK;
+            break;
+        }
+        break;
+    }
+    return m_workClass;
+}
+
 void HMWork::setMark(int mark)
 {
     m_mark = mark;
@@ -98,3 +136,13 @@ void HMWork::setPublish(bool publish)
 {
     m_publish = publish;
 }
+
+uint32_t HMWork::getCheckID(HMDataCheckList& checkList)
+{
+    if(m_checkListID != checkList.getListID())
+    {
+        m_checkID = checkList.getCheckID(m_hostname, m_hostCheck);
+        m_checkListID = checkList.getListID();
+    }
+    return m_checkID;
+}
@@ -26,7 +26,7 @@ HM_WORK_STATUS HMWorkAuxFetch::processWork()
     m_stateManager->updateState(currentState);
 
     // now conduct the check.
-    m_timeout = currentState->m_checkList.startCheck(m_hostname, m_ipAddress, m_hostCheck);
+    m_timeout = currentState->m_checkList.startCheck(getCheckID(currentState->m_checkList), m_ipAddress);
 
     result = fetchAux();
 
@@ -41,14 +41,14 @@ HM_WORK_STATUS HMWorkAuxFetch::processWork()
     // check to see if this check is complete
     if(m_reschedule)
     {
-        HMTimeStamp checkTime = currentState->m_checkList.nextCheckTime(m_hostname, m_ipAddress, m_hostCheck);
-        if(checkTime <= HMTimeStamp::now())
+        HMMonotonicTime checkTime = currentState->m_checkList.nextCheckTime(getCheckID(currentState->m_checkList), m_ipAddress);
+        if(checkTime <= HMMonotonicTime::now())
         {
-            currentState->m_checkList.queueCheck(m_hostname, m_ipAddress, m_hostCheck, m_stateManager->m_workQueue);
+            currentState->m_checkList.queueCheck(m_checkID, m_hostname, m_ipAddress, m_hostCheck, m_stateManager->m_workQueue, m_eventLoop);
         }
         else
         {
-            m_eventLoop->addHealthCheckTimeout(m_hostname, m_ipAddress, m_hostCheck, checkTime);
+            m_eventLoop->addHealthCheckTimeout(m_hostname, m_ipAddress, m_hostCheck, checkTime, m_checkListID, m_checkID);
         }
     }
     return result;
@@ -4,111 +4,17 @@
 
 #include "HMWorkAuxFetchCurl.h"
 #include "HMWork.h"
-#include "HMTimeStamp.h"
+#include "HMMonotonicTime.h"
 #include "HMConstants.h"
 #include "HMLogBase.h"
 #include "HMStateManager.h"
+#include "HMTLSIdentity.h"
 
 // LCOV_EXCL_START; Tested in functional testing
 
 using namespace std;
 
 
-//rsa key and cert
-static CURLcode testsslctxkey_function(CURL* curl, void* sslctx, void* mykey)
-{   
-    (void)curl; /* avoid warnings */
-    (void)mykey; /* avoid warnings */
-
-    
-    auto l =  (std::pair<std::string,std::string>*) mykey;
-    
-    BIO* kbio = NULL;
-    RSA* rsa = NULL;
-    int ret;
-    
-    (void)curl; /* avoid warnings */
-    (void)mykey; /* avoid warnings */
-    
-    char* mypem = (char*)l->first.c_str();/*key*/
-    
-    kbio = BIO_new_mem_buf(mypem, -1);
-    
-    if(kbio == NULL)
-    {   
-        HMLog(HM_LOG_ERROR,"[CURLCHECK]BIO_new_mem_buf failed");
-    }
-    
-    /*read the key bio into an RSA object*/
-    rsa = PEM_read_bio_RSAPrivateKey(kbio, NULL, 0, NULL);
-    if(rsa == NULL)
-    {   
-        HMLog(HM_LOG_ERROR,"[CURLCHECK]Failed to create key bio");
-    }
-    
-    /*tell SSL to use the RSA key from memory*/
-    ret = SSL_CTX_use_RSAPrivateKey((SSL_CTX*)sslctx, rsa);
-    if(ret != 1)
-    {   
-        HMLog(HM_LOG_ERROR,"[CURLCHECK] RSA Key failed");
-    }
-    
-    /*cert*/
-    X509* cert = NULL;
-    BIO* bio;
-    
-    char* mycert = (char*)l->second.c_str();/*cert*/
-    
-    bio=BIO_new_mem_buf(mycert, -1);
-    if(bio == NULL)
-    {   
-        HMLog(HM_LOG_ERROR,"[CURLCHECK]BIO_new_mem_buf failed");
-    }
-    
-    cert = PEM_read_bio_X509(bio, NULL, 0, NULL);
-    if(cert == NULL)
-    {   
-        HMLog(HM_LOG_ERROR,"[CURLCHECK]Failed to create cert bio");
-    }
-    
-    /*tell SSL to use the X509 certificate*/ 
-    ret = SSL_CTX_use_certificate((SSL_CTX*)sslctx, cert);
-    if(ret != 1)
-    {
-        HMLog(HM_LOG_ERROR,"Use certificate failed\n");
-    }
-    
-    if(kbio)
-    {   
-        BIO_free(kbio);
-    }
-    if(rsa)
-    {   
-        RSA_free(rsa);
-    }
-    if(bio)
-    {
-        BIO_free(bio);
-    }
-    if(cert)
-    { 
-       X509_free(cert);
-    } 
-
-    delete l;
-    /* all set to go */
-    return CURLE_OK;
-}
-
-
-size_t
-curl_Callback(void* ptr, size_t size, size_t nmemb, HMWorkAuxFetchCurl* check)
-{
-    check->updateBuffer((char*)ptr,nmemb);
-    check->setAuxDataType(HM_AUX_DATA_XML);
-    return size * nmemb;
-}
-
 int
 sockopt_callBack(void *sockopt, curl_socket_t curlfd,
                             curlsocktype purpose)
@@ -119,12 +25,6 @@ sockopt_callBack(void *sockopt, curl_socket_t curlfd,
   return CURL_SOCKOPT_OK;
 }
 
-void
-HMWorkAuxFetchCurl::updateBuffer(char* buf, uint32_t length)
-{
-    rcvdBuffer = rcvdBuffer + string(buf, length);
-}
-
 HM_WORK_STATUS
 HMWorkAuxFetchCurl::fetchAux()
 {
@@ -148,7 +48,7 @@ HMWorkAuxFetchCurl::fetchAux()
         uint32_t port = m_hostCheck.getPort();
         uint32_t checkInfoPort;
 
-        uint64_t timeout = m_timeout - HMTimeStamp::now();
+        uint64_t timeout = m_timeout - HMMonotonicTime::now();
 
         if(!curl)
         {
@@ -348,14 +248,11 @@ HMWorkAuxFetchCurl::fetchAux()
         //MUTUAL TLS
         if ((m_hostCheck.getCheckType() == HM_CHECK_AUX_MTLS_HTTPS
                 || m_hostCheck.getCheckType() == HM_CHECK_AUX_MTLS_HTTPS_NO_PEER_CHECK) 
-                    && (!currentState->getHealthCheckCert().empty() 
-                        && !currentState->getHealthCheckKey().empty()))
+                    && currentState->getHealthCheckIdentity())
         {
-            curl_easy_setopt(curl, CURLOPT_SSLCERTTYPE, "PEM");
-            curl_easy_setopt(curl, CURLOPT_SSLKEYTYPE, "PEM");
-            auto certkey = new std::pair<std::string, std::string>(currentState->getHealthCheckKey(), currentState->getHealthCheckCert());
-            curl_easy_setopt(curl, CURLOPT_SSL_CTX_FUNCTION, *testsslctxkey_function);
-            curl_easy_setopt(curl, CURLOPT_SSL_CTX_DATA,certkey);
+            // currentState holds the identity until the fetch completes
+            curl_easy_setopt(curl, CURLOPT_SSL_CTX_FUNCTION, HMTLSIdentity::curlSslCtxCallback);
+            curl_easy_setopt(curl, CURLOPT_SSL_CTX_DATA, currentState->getHealthCheckIdentity().get());
         }
 
         if(uri.empty())
@@ -369,13 +266,14 @@ HMWorkAuxFetchCurl::fetchAux()
 
         curl_easy_setopt(curl,CURLOPT_URL,url.c_str());
 
-        rcvdBuffer = "";
-        curl_easy_setopt(curl,CURLOPT_WRITEFUNCTION, &curl_Callback);
-        curl_easy_setopt(curl,CURLOPT_WRITEDATA, this);
+        m_rcvdBuffer.setParams(currentState->getMaxBodySize(), true);
+        m_rcvdBuffer.attach(curl);
+        setAuxDataType(HM_AUX_DATA_XML);
 
-        m_start = HMTimeStamp::now();
-        CURLcode res = curl_easy_perform(curl);
-        m_end = HMTimeStamp::now();
+        m_start = HMMonotonicTime::now();
+        CURLcode res = m_rcvdBuffer.getResult(curl_easy_perform(curl));
+        m_end = HMMonotonicTime::now();
+        m_rcvdBuffer.attach(nullptr);
 
         long http_code;
         curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &http_code);
@@ -390,8 +288,9 @@ HMWorkAuxFetchCurl::fetchAux()
             {
                 double t;
                 curl_easy_getinfo(curl, CURLINFO_CONNECT_TIME, &t);
-                m_end = m_start + ((uint64_t)(t*1000));
-                m_auxData = rcvdBuffer;
+                m_end = m_start.plusMicroseconds((uint64_t)(t * 1000000));
+                // Hand the body over to the aux parser without a copy
+                m_rcvdBuffer.releaseBody(m_auxData);
                 m_reason = HM_REASON_SUCCESS;
             }
             else
@@ -0,0 +1,88 @@
+// Copyright 2019, Oath Inc.
+// Licensed under the terms of the Apache 2.0 license. See LICENSE file in the root of the distribution for licensing details.
+#include "HMWorkClassQueue.h"
+
+using namespace std;
+
+void
+HMWorkClassQueue::push(unique_ptr<HMWork>& work)
+{
+    HM_WORK_CLASS workClass = work->getWorkClass();
+    if(workClass >= HM_WORK_CLASS_COUNT)
+    {
+        workClass = HM_WORK_CLASS_HEALTHCHECK;
+    }
+    m_queues[workClass].push_back(move(work));
+    m_size++;
+}
+
+bool
+HMWorkClassQueue::pop(unique_ptr<HMWork>& work, const uint32_t* weights, uint64_t starvationTime, bool& starved)
+{
+    starved = false;
+    if(m_size == 0)
+    {
+        return false;
+    }
+
+    int32_t pick = -1;
+    if(starvationTime > 0)
+    {
+        HMMonotonicTime now = HMMonotonicTime::now();
+        uint64_t oldestWait = 0;
+        for(uint32_t i = 0; i < HM_WORK_CLASS_COUNT; i++)
+        {
+            if(m_queues[i].empty())
+            {
+                continue;
+            }
+            uint64_t wait = now.microsecondsSince(m_queues[i].front()->m_queueTime);
+            if(wait >= starvationTime && wait > oldestWait)
+            {
+                oldestWait = wait;
+                pick = i;
+            }
+        }
+        starved = (pick >= 0);
+    }
+
+    if(pick < 0)
+    {
+        int64_t totalWeight = 0;
+        for(uint32_t i = 0; i < HM_WORK_CLASS_COUNT; i++)
+        {
+            if(m_queues[i].empty())
+            {
+                continue;
+            }
+            int64_t weight = weights[i] ? weights[i] : 1;
+            m_credits[i] += weight;
+            totalWeight += weight;
+            if(pick < 0 || m_credits[i] > m_credits[pick])
+            {
+                pick = i;
+            }
+        }
+        m_credits[pick] -= totalWeight;
+    }
+
+    work = move(m_queues[pick].front());
+    m_queues[pick].pop_front();
+    m_size--;
+    if(m_queues[pick].empty())
+    {
+        // An idle class does not bank credits or debts for when it has work again
+        m_credits[pick] = 0;
+    }
+    return true;
+}
+
+HMMonotonicTime
+HMWorkClassQueue::getOldest(HM_WORK_CLASS workClass) const
+{
+    if(m_queues[workClass].empty())
+    {
+        return HMMonotonicTime();
+    }
+    return m_queues[workClass].front()->m_queueTime;
+}
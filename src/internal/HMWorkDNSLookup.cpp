@@ -11,31 +11,41 @@ using namespace std;
 
 HM_WORK_STATUS HMWorkDNSLookup::processWork()
 {
-    bool result;
-    HMLog(HM_LOG_DEBUG3, "[WORKER] [%llu] Resolving DNS for %s", m_ID, m_hostname.c_str());
-
-    // Update the smart pointer
     shared_ptr<HMState> currentState;
-    m_stateManager->updateState(currentState);
 
-    if(!currentState->m_dnsCache.startDNSQuery(m_hostname, m_dnsHostCheck))
+    if(m_workStatus == HM_WORK_IDLE)
     {
-        return HM_WORK_COMPLETE;
+        HMLog(HM_LOG_DEBUG3, "[WORKER] [%llu] Resolving DNS for %s", m_ID, m_hostname.c_str());
+
+        // Update the smart pointer
+        m_stateManager->updateState(currentState);
+
+        if(!currentState->m_dnsCache.startDNSQuery(m_hostname, m_dnsHostCheck))
+        {
+            return HM_WORK_COMPLETE;
+        }
+
+        m_workStatus = dnsLookup();
     }
 
-    result = dnsLookup();
+    if(m_workStatus == HM_WORK_IN_PROGRESS)
+    {
+        // the continuation will requeue the work once the lookup completes
+        return m_workStatus;
+    }
+    bool result = (m_workStatus != HM_WORK_IDLE);
 
     // Update the smart pointer if necessary
     m_stateManager->updateState(currentState);
 
     // Make sure we completed the query with success and don't need another
-    HMTimeStamp checkTime = currentState->m_dnsCache.nextQueryTime(m_hostname, m_dnsHostCheck);
+    HMMonotonicTime checkTime = currentState->m_dnsCache.nextQueryTime(m_hostname, m_dnsHostCheck);
     if (m_reschedule)
     {
-        if (checkTime <= HMTimeStamp::now())
+        if (checkTime <= HMMonotonicTime::now())
         {
             currentState->m_dnsCache.queueDNSQuery(m_hostname, m_dnsHostCheck,
-                    m_stateManager->m_workQueue);
+                    m_stateManager->m_workQueue, m_eventLoop);
         }
         else
         {
@@ -87,7 +97,7 @@ HM_WORK_STATUS HMWorkDNSLookup::processWork()
         HMLog(HM_LOG_DEBUG, "[WORKER] [%llu] IP List retrieved total size %d", m_ID, ips.size());
         for(auto iit = ips.begin(); iit != ips.end(); ++iit)
         {
-            if (iit->toString() == "0.0.0.0" || iit->toString() == "::")
+            if (iit->isUnspecified())
             {
                 if(*iit == this->m_ipAddress)
                 {
@@ -99,12 +109,19 @@ HM_WORK_STATUS HMWorkDNSLookup::processWork()
             HMLog(HM_LOG_DEBUG3, "[WORKER] [%llu] IP %s", m_ID, iit->toString().c_str());
             checkTime = currentState->m_checkList.nextCheckTime(m_hostname, *iit, check);
             HMLog(HM_LOG_DEBUG3, "[WORKER] [%llu] Next check time %llu for %s at %s", m_ID,
-                    checkTime.getTimeSinceEpoch(),
+                    checkTime.getMilliseconds(),
                     m_hostname.c_str(),
                     iit->toString().c_str());
-            if(checkTime <= HMTimeStamp::now())
+            if(checkTime <= HMMonotonicTime::now())
             {
-                currentState->m_checkList.queueCheck(m_hostname, *iit, check, m_stateManager->m_workQueue);
+                if(m_eventLoop)
+                {
+                    currentState->m_checkList.scheduleCheck(m_hostname, *iit, check, m_stateManager->m_workQueue, *m_eventLoop, false);
+                }
+                else
+                {
+                    currentState->m_checkList.queueCheck(m_hostname, *iit, check, m_stateManager->m_workQueue);
+                }
             }
         }
     }
@@ -31,7 +31,7 @@ HMWorkDNSLookupStatic::dnsLookup()
     }
 
     // Now process the returned data
-    m_start = HMTimeStamp::now();
+    m_start = HMMonotonicTime::now();
     m_end = m_start;
 
     shared_ptr<HMState> current;
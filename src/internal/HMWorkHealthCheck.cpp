@@ -30,11 +30,17 @@ HMWorkHealthCheck::processWork()
         m_stateManager->updateState(currentState);
 
         // now conduct the check.
-        m_timeout = currentState->m_checkList.startCheck(m_hostname, m_ipAddress, m_hostCheck);
+        m_timeout = currentState->m_checkList.startCheck(getCheckID(currentState->m_checkList), m_ipAddress);
 
         m_workStatus = healthCheck();
     }
 
+    if (m_workStatus == HM_WORK_IN_PROGRESS)
+    {
+        // the continuation will requeue the work once the check completes
+        return m_workStatus;
+    }
+
     if (m_workStatus)
     {
         // process the results
@@ -54,18 +60,18 @@ HMWorkHealthCheck::processWork()
         }
         if (m_reschedule)
         {
-            HMTimeStamp checkTime = currentState->m_checkList.nextCheckTime(m_hostname, m_ipAddress, m_hostCheck);
+            HMMonotonicTime checkTime = currentState->m_checkList.nextCheckTime(getCheckID(currentState->m_checkList), m_ipAddress);
             HMDNSLookup dnsHostCheck(m_hostCheck.getDnsType(), m_ipAddress.getType() == AF_INET6, m_hostCheck.getRemoteCheck());
             bool isValidAddress = currentState->m_dnsCache.isValidAddress(m_hostname, m_hostCheck.getDualStack(), dnsHostCheck, m_ipAddress);
             if (isValidAddress)
             {
-                if (checkTime <= HMTimeStamp::now())
+                if (checkTime <= HMMonotonicTime::now())
                 {
-                    currentState->m_checkList.queueCheck(m_hostname, m_ipAddress, m_hostCheck, m_stateManager->m_workQueue);
+                    currentState->m_checkList.queueCheck(m_checkID, m_hostname, m_ipAddress, m_hostCheck, m_stateManager->m_workQueue, m_eventLoop);
                 }
                 else
                 {
-                    m_eventLoop->addHealthCheckTimeout(m_hostname, m_ipAddress, m_hostCheck, checkTime);
+                    m_eventLoop->addHealthCheckTimeout(m_hostname, m_ipAddress, m_hostCheck, checkTime, m_checkListID, m_checkID);
                 }
             }
         }
@@ -4,123 +4,308 @@
 
 #include "HMWorkHealthCheckCurl.h"
 #include "HMWork.h"
-#include "HMTimeStamp.h"
+#include "HMMonotonicTime.h"
 #include "HMConstants.h"
 #include "HMLogBase.h"
 #include "HMStateManager.h"
+#include "HMTLSIdentity.h"
 
 // LCOV_EXCL_START; Tested in functional testing
 
 using namespace std;
 
-//cert and rs load
-static CURLcode testsslctxkey_function(CURL* curl, void* sslctx, void* mykey)
+int
+sockopt_callback(void *sockopt, curl_socket_t curlfd,
+                            curlsocktype purpose)
 {
-    (void)curl; /* avoid warnings */
-    (void)mykey; /* avoid warnings */
-
-
-    auto l =  (std::pair<std::string,std::string>*) mykey;
-
-    BIO* kbio = NULL;
-    RSA* rsa = NULL;
-    int ret;
-
-    (void)curl; /* avoid warnings */
-    (void)mykey; /* avoid warnings */
-
-    char* mypem = (char*)l->first.c_str();/*key*/
-
-    kbio = BIO_new_mem_buf(mypem, -1);
+  (void)purpose;
+  int val = *(int *)sockopt;
+  setsockopt(curlfd, IPPROTO_IP, IP_TOS, (const char *)&val, sizeof(val));
+  return CURL_SOCKOPT_OK;
+}
 
-    if(kbio == NULL)
+void
+HMWorkHealthCheckCurl::buildHttpRequest(string& url, vector<string>& headers, string& connectTo)
+{
+    string uri;
+    string checkInfoHost;
+    bool sni = false;
+    uint32_t port = m_hostCheck.getPort();
+    uint32_t checkInfoPort;
+
+    // setup the HTTP parameters
+    // we need to parse the checkInfo parameter
+    // Check to see if we have the format: //hostname/uriCURLOPT_NOSIGNAL
+    string checkInfo = m_hostCheck.getCheckInfo();
+    if(checkInfo.size() > 2 && checkInfo[0] == '/' && (checkInfo)[1] == '/')
     {
-        HMLog(HM_LOG_ERROR,"[CURLCHECK]BIO_new_mem_buf failed");
-    }
+        int hostLen = 0;
+        size_t index;
+        if((index = checkInfo.find("/", 2)) != string::npos)
+        {
+            //checkinfo //xxxx/yy hostLen = 4 (xxxx)
+            hostLen =
+                    checkInfo.substr(2, (checkInfo.find("/", 2) - 2)).length();
+        }
+        else
+        {
+            //checkinfo //xxx
+            hostLen = checkInfo.substr(2).length();
+        }
+        if(hostLen)
+        {
 
-    /*read the key bio into an RSA object*/
-    rsa = PEM_read_bio_RSAPrivateKey(kbio, NULL, 0, NULL);
-    if(rsa == NULL)
+            string hostname;
+            sni = true;
+            //check for special cases checkinfo //<host>, //<host:port>, //xx
+            hostname = m_hostCheck.parseCheckInfo(m_hostname, checkInfoPort, checkInfoHost);
+            HMLog(HM_LOG_DEBUG3,
+                    "[CURLCHECK] Curl slist %s for %s : %d at %s with checkinfo %s",
+                    hostname.c_str(),
+                    m_hostname.c_str(),
+                    port,
+                    m_ipAddress.toString().c_str(),
+                    checkInfo.c_str());
+
+            headers.push_back(hostname);
+
+            // checkinfo //xxx/yyy, uri = yyy
+            //checkinfo //xxx ,uri is empty
+            if(index != string::npos)
+            {
+                uri = checkInfo.substr(index);
+                HMLog(HM_LOG_DEBUG3,
+                        "[CURLCHECK] Curl uri %s for %s : %d at %s with checkinfo %s",
+                        uri.c_str(),
+                        m_hostname.c_str(),
+                        port,
+                        m_ipAddress.toString().c_str(),
+                        checkInfo.c_str());
+            }
+        }
+        else
+        {
+            // checkInfo /// uri = /,  checkinfo ///xx uri = /xx
+            uri = checkInfo.substr(2); // checkInfo ///
+            HMLog(HM_LOG_DEBUG3,
+                    "[CURLCHECK] Curl uri %s for %s : %d at %s with checkinfo %s",
+                    uri.c_str(),
+                    m_hostname.c_str(),
+                    port,
+                    m_ipAddress.toString().c_str(),
+                    checkInfo.c_str());
+        }
+    }
+    else
     {
-        HMLog(HM_LOG_ERROR,"[CURLCHECK]Failed to create key bio");
+        uri = checkInfo;
     }
 
-    /*tell SSL to use the RSA key from memory*/
-    ret = SSL_CTX_use_RSAPrivateKey((SSL_CTX*)sslctx, rsa);
-    if(ret != 1)
+    url = ((m_hostCheck.getCheckType() == HM_CHECK_HTTP) ? "http://" : "https://");
+
+    //if the mode is http or https with checkInfo /xxx or ///xxxx
+    if((sni == false) || (m_hostCheck.getCheckType() == HM_CHECK_HTTP))
     {
-        HMLog(HM_LOG_ERROR,"[CURLCHECK]RSA  Key failed");
+        if(m_ipAddress.getType() == AF_INET6)
+        {
+            url = url + "[" + m_ipAddress.toString() + "]:" + to_string((uint64_t) port);
+        }
+        else
+        {
+            url = url + m_ipAddress.toString() +":" + to_string((uint64_t)port);
+        }
     }
+    else
+    {
+        //sni enabled https and https_no_peer_check
+        string hostsni;
+        if(checkInfoHost.empty())
+        {
+            //checkinfo //<host>/ or //<host:port>/
+            if(m_ipAddress.getType() == AF_INET6)
+            {
+                hostsni = m_hostname + ":" + to_string((uint64_t) port)
+                        + ":[" + m_ipAddress.toString() + "]" + ":"
+                        + to_string((uint64_t) port);
+            }
+            else
+            {
+                hostsni = m_hostname + ":" + to_string((uint64_t) port)
+                        + ":" + m_ipAddress.toString() + ":"
+                        + to_string((uint64_t) port);
+            }
 
-    /*cert*/
-    X509* cert = NULL;
-    BIO* bio;
+            if(port == 443)
+            {
+                // if default port then only the host name is passed in the url
+                url = url + m_hostname;
+            }
+            else
+            {
+                url = url + m_hostname + ":" + to_string((uint64_t) port);
+            }
+        }
+        else
+        {
+            //checkinfo //hostname:port/ or //hostname/
+            if(m_ipAddress.getType() == AF_INET6)
+            {
+                //checkinfohost:checkinfoport:[ip]:checkport
+                hostsni = checkInfoHost + ":"
+                        + to_string((uint64_t) checkInfoPort) + ":["
+                        + m_ipAddress.toString() + "]" + ":"
+                        + to_string((uint64_t) port);
+            }
+            else
+            {
+                //checkinfohost:checkinfoport:ip:checkport
+                hostsni = checkInfoHost + ":"
+                        + to_string((uint64_t) checkInfoPort) + ":"
+                        + m_ipAddress.toString() + ":"
+                        + to_string((uint64_t) port);
+            }
 
-    char* mycert = (char*)l->second.c_str();/*cert*/
+            if(checkInfoPort == 443)
+            {
+                // if default port then only the host name is passed in the url
+                url = url + checkInfoHost;
+            }
+            else
+            {
+                url = url + checkInfoHost + ":" + to_string((uint64_t) checkInfoPort);
 
-    bio=BIO_new_mem_buf(mycert, -1);
-    if(bio == NULL)
-    {
-        HMLog(HM_LOG_ERROR,"[CURLCHECK]BIO_new_mem_buf failed");
+            }
+        }
+        HMLog(HM_LOG_DEBUG3,
+            "[CURLCHECK] curl SNI host header %s for CurlCheck for %s at %s with checkinfo %s",
+            hostsni.c_str(),
+            m_hostname.c_str(),
+            m_ipAddress.toString().c_str(),
+            checkInfo.c_str());
+
+        connectTo = hostsni;
     }
 
-    cert = PEM_read_bio_X509(bio, NULL, 0, NULL);
-    if(cert == NULL)
+    if(uri.empty())
+    {
+        url = url + "/status.html";
+    }
+    else
     {
-        HMLog(HM_LOG_ERROR,"[CURLCHECK]Failed to create cert bio");
+        url = url + uri;
     }
+}
+
+void
+HMWorkHealthCheckCurl::setHttpResult(CURLcode res, long httpCode, uint64_t responseTime, bool matched)
+{
+    m_response = HM_RESPONSE_FAILED;
+    m_reason = HM_REASON_NONE;
 
-    /*tell SSL to use the X509 certificate*/ 
-    ret = SSL_CTX_use_certificate((SSL_CTX*)sslctx, cert);
-    if(ret != 1)
+    if(res == CURLE_OK)
     {
-        HMLog(HM_LOG_ERROR,"Use certificate failed\n");
+        m_response = HM_RESPONSE_CONNECTED;
+        if(httpCode == 200 && !matched)
+        {
+            HMLog(HM_LOG_DEBUG3, "[CURLCHECK] Body from %s(%s) did not contain %s",
+                    m_hostname.c_str(), m_ipAddress.toString().c_str(), m_hostCheck.getCheckExpect().c_str());
+            m_reason = HM_REASON_RESPONSE_DOWN;
+        }
+        else if(httpCode == 200)
+        {
+            m_end = m_start.plusMicroseconds(responseTime);
+            m_reason = HM_REASON_SUCCESS;
+        }
+        else
+        {
+            if(httpCode >= 300 && httpCode < 400)
+            {
+                m_reason = HM_REASON_RESPONSE_3XX;
+            }
+            else if(httpCode == 403)
+            {
+                m_reason = HM_REASON_RESPONSE_403;
+            }
+            else if(httpCode == 404)
+            {
+                m_reason = HM_REASON_RESPONSE_404;
+            }
+            else if(httpCode >= 500 && httpCode < 600)
+            {
+                m_reason = HM_REASON_RESPONSE_5XX;
+            }
+            else
+            {
+                m_reason = HM_REASON_RESPONSE_DOWN;
+            }
+        }
     }
- 
-    if(kbio)
+    else if(res == CURLE_OPERATION_TIMEDOUT)
     {
-        BIO_free(kbio);
+        m_reason = HM_REASON_RESPONSE_TIMEOUT;
     }
-    if(rsa)
+    else if(res == CURLE_LOGIN_DENIED)
     {
-        RSA_free(rsa);
+        m_reason = HM_REASON_RESPONSE_403;
     }
-    if(bio)
+    else if(res == CURLE_COULDNT_CONNECT)
     {
-        BIO_free(bio);
+        m_reason = HM_REASON_CONNECT_FAILURE;
     }
-    if(cert)
-    { 
-       X509_free(cert);
+    else
+    {
+        m_reason = HM_REASON_RESPONSE_FAILURE;
     }
-
-    delete l;
-
-    /* all set to go */
-    return CURLE_OK;
 }
 
-size_t
-curl_Callback(void* ptr, size_t size, size_t nmemb, HMWorkHealthCheckCurl* check)
+bool
+HMWorkHealthCheckCurl::submitRequest(HMCurlEngine* engine, const HMState& state, const string& url,
+        const vector<string>& headers, const string& connectTo)
 {
-    check->updateBuffer((char*)ptr,nmemb);
-    return size * nmemb;
-}
-
-int
-sockopt_callback(void *sockopt, curl_socket_t curlfd,
-                            curlsocktype purpose)
-{
-  (void)purpose;
-  int val = *(int *)sockopt;
-  setsockopt(curlfd, IPPROTO_IP, IP_TOS, (const char *)&val, sizeof(val));
-  return CURL_SOCKOPT_OK;
+    HM_CHECK_TYPE checkType = m_hostCheck.getCheckType();
+
+    m_curlRequest.m_url = url;
+    m_curlRequest.m_headers = headers;
+    m_curlRequest.m_headers.push_back("User-Agent: YahooFOR/1.0");
+    m_curlRequest.m_connectTo = connectTo;
+    m_curlRequest.m_sourceAddress = m_hostCheck.getSourceAddress();
+    m_curlRequest.m_tos = m_hostCheck.getTOSValue();
+    m_curlRequest.m_connectTimeout = state.getConnectionTimeout();
+    m_curlRequest.m_timeout = (m_timeout > HMMonotonicTime::now()) ? (m_timeout - HMMonotonicTime::now()) : 1;
+    m_curlRequest.m_verifyPeer = (checkType != HM_CHECK_HTTPS_NO_PEER_CHECK
+            && checkType != HM_CHECK_MTLS_HTTPS_NO_PEER_CHECK);
+    m_curlRequest.m_caFile.clear();
+    if(checkType == HM_CHECK_HTTPS || checkType == HM_CHECK_MTLS_HTTPS)
+    {
+        m_curlRequest.m_caFile = state.getHealthCheckCAFile();
+    }
+    m_curlRequest.m_clientIdentity.reset();
+    if(checkType == HM_CHECK_MTLS_HTTPS || checkType == HM_CHECK_MTLS_HTTPS_NO_PEER_CHECK)
+    {
+        m_curlRequest.m_clientIdentity = state.getHealthCheckIdentity();
+    }
+    m_curlRequest.m_keepAlive = m_hostCheck.getKeepAlive();
+    m_curlRequest.m_callback = HMWorkHealthCheckCurl::requestDone;
+    m_curlRequest.m_arg = this;
+    HMLog(HM_LOG_DEBUG3, "[CURLCHECK] curl engine fetching http url for CurlCheck %s", url.c_str());
+    return engine->submit(m_curlRequest);
 }
 
 void
-HMWorkHealthCheckCurl::updateBuffer(char* buf, uint32_t length)
+HMWorkHealthCheckCurl::requestDone(HMCurlRequest& request, void* arg)
 {
-    rcvdBuffer = rcvdBuffer + string(buf, length);
+    HMWorkHealthCheckCurl* work = (HMWorkHealthCheckCurl*) arg;
+    work->m_start = request.m_start;
+    work->m_end = request.m_end;
+    work->setHttpResult(request.m_result, request.m_responseCode, request.m_connectTime, request.m_body.isMatched());
+
+    HMLog(HM_LOG_DEBUG3, "[CURLCHECK] curl engine fetching http url for CurlCheck %s returned reason %s%s",
+            request.m_url.c_str(),
+            printReason(work->m_reason).c_str(),
+            request.m_reused ? " on a reused connection" : "");
+
+    work->m_workStatus = HM_WORK_COMPLETE;
+    work->m_stateManager->m_workQueue.addWork((HMWork*)work);
 }
 
 HM_WORK_STATUS
@@ -135,16 +320,33 @@ HMWorkHealthCheckCurl::healthCheck()
         shared_ptr<HMState> currentState;
         m_stateManager->updateState(currentState);
 
-        string uri;
         string url;
-        string checkInfoHost;
-        bool sni = false;
+        string connectTo;
+        vector<string> headers;
+        buildHttpRequest(url, headers, connectTo);
+        // The body is only matched as it comes in, never kept
+        m_curlRequest.m_body.setParams(currentState->getMaxBodySize(), false, m_hostCheck.getCheckExpect());
+
+        HMCurlEngine* engine = m_stateManager->getCurlEngine();
+        if(engine != nullptr && m_hostCheck.getCheckPlugin() == HM_CHECK_PLUGIN_HTTP_CURL_MULTI)
+        {
+            m_start = HMMonotonicTime::now();
+            m_end = m_start;
+            m_reason = HM_REASON_NONE;
+            m_response = HM_RESPONSE_FAILED;
+            if(submitRequest(engine, *currentState, url, headers, connectTo))
+            {
+                return HM_WORK_IN_PROGRESS;
+            }
+            HMLog(HM_LOG_DEBUG, "[CURLCHECK] Curl engine unavailable, using blocking curl for %s", url.c_str());
+        }
+
         CURL* curl;
         curl = curl_easy_init();
         curl_slist* slist = NULL;
         struct curl_slist *host = NULL;
 
-        uint64_t timeout = m_timeout - HMTimeStamp::now();
+        uint64_t timeout = m_timeout - HMMonotonicTime::now();
 
         if(!curl)
         {
@@ -152,77 +354,10 @@ HMWorkHealthCheckCurl::healthCheck()
             return HM_WORK_COMPLETE;
         }
 
-        uint32_t port = m_hostCheck.getPort();
-        uint32_t checkInfoPort;
-
-        // setup the HTTP parameters
-        // we need to parse the checkInfo parameter
-        // Check to see if we have the format: //hostname/uriCURLOPT_NOSIGNAL
-        string checkInfo = m_hostCheck.getCheckInfo();
-        if(checkInfo.size() > 2 && checkInfo[0] == '/' && (checkInfo)[1] == '/')
-        {
-            int hostLen = 0;
-            size_t index;
-            if((index = checkInfo.find("/", 2)) != string::npos)
-            {
-                //checkinfo //xxxx/yy hostLen = 4 (xxxx)
-                hostLen =
-                        checkInfo.substr(2, (checkInfo.find("/", 2) - 2)).length();
-            }
-            else
-            {
-                //checkinfo //xxx
-                hostLen = checkInfo.substr(2).length();
-            }
-            if(hostLen)
-            {
-
-                string hostname;
-                sni = true;
-                //check for special cases checkinfo //<host>, //<host:port>, //xx
-                hostname = m_hostCheck.parseCheckInfo(m_hostname, checkInfoPort, checkInfoHost);
-                HMLog(HM_LOG_DEBUG3,
-                        "[CURLCHECK] Curl slist %s for %s : %d at %s with checkinfo %s",
-                        hostname.c_str(),
-                        m_hostname.c_str(),
-                        port,
-                        m_ipAddress.toString().c_str(),
-                        checkInfo.c_str());
-
-                slist = curl_slist_append(slist, hostname.c_str());
-
-                // checkinfo //xxx/yyy, uri = yyy
-                //checkinfo //xxx ,uri is empty
-                if(index != string::npos)
-                {
-                    uri = checkInfo.substr(index);
-                    HMLog(HM_LOG_DEBUG3,
-                            "[CURLCHECK] Curl uri %s for %s : %d at %s with checkinfo %s",
-                            uri.c_str(),
-                            m_hostname.c_str(),
-                            port,
-                            m_ipAddress.toString().c_str(),
-                            checkInfo.c_str());
-                }
-            }
-            else
-            {
-                // checkInfo /// uri = /,  checkinfo ///xx uri = /xx
-                uri = checkInfo.substr(2); // checkInfo ///
-                HMLog(HM_LOG_DEBUG3,
-                        "[CURLCHECK] Curl uri %s for %s : %d at %s with checkinfo %s",
-                        uri.c_str(),
-                        m_hostname.c_str(),
-                        port,
-                        m_ipAddress.toString().c_str(),
-                        checkInfo.c_str());
-            }
-        }
-        else
+        for(auto& header : headers)
         {
-            uri = checkInfo;
+            slist = curl_slist_append(slist, header.c_str());
         }
-
         slist = curl_slist_append(slist, "Connection: close");
         slist = curl_slist_append(slist, "User-Agent: YahooFOR/1.0");
 
@@ -252,93 +387,12 @@ HMWorkHealthCheckCurl::healthCheck()
             curl_easy_setopt(curl,CURLOPT_SSL_VERIFYPEER,0);
         }
 
-        url = ((m_hostCheck.getCheckType() == HM_CHECK_HTTP) ? "http://" : "https://");
-
-        //if the mode is http or https with checkInfo /xxx or ///xxxx
-        if((sni == false) || (m_hostCheck.getCheckType() == HM_CHECK_HTTP))
+        if(!connectTo.empty())
         {
-            if(m_ipAddress.getType() == AF_INET6)
-            {
-                url = url + "[" + m_ipAddress.toString() + "]:" + to_string((uint64_t) port);
-            }
-            else
-            {
-                url = url + m_ipAddress.toString() +":" + to_string((uint64_t)port);
-            }
-        }
-        else
-        {
-            //sni enabled https and https_no_peer_check
-            string hostsni;
-            if(checkInfoHost.empty())
-            {
-                //checkinfo //<host>/ or //<host:port>/
-                if(m_ipAddress.getType() == AF_INET6)
-                {
-                    hostsni = m_hostname + ":" + to_string((uint64_t) port)
-                            + ":[" + m_ipAddress.toString() + "]" + ":"
-                            + to_string((uint64_t) port);
-                }
-                else
-                {
-                    hostsni = m_hostname + ":" + to_string((uint64_t) port)
-                            + ":" + m_ipAddress.toString() + ":"
-                            + to_string((uint64_t) port);
-                }
-
-                if(port == 443)
-                {
-                    // if default port then only the host name is passed in the url
-                    url = url + m_hostname;
-                }
-                else
-                {
-                    url = url + m_hostname + ":" + to_string((uint64_t) port);
-                }
-            }
-            else
-            {
-                //checkinfo //hostname:port/ or //hostname/
-                if(m_ipAddress.getType() == AF_INET6)
-                {
-                    //checkinfohost:checkinfoport:[ip]:checkport
-                    hostsni = checkInfoHost + ":"
-                            + to_string((uint64_t) checkInfoPort) + ":["
-                            + m_ipAddress.toString() + "]" + ":"
-                            + to_string((uint64_t) port);
-                }
-                else
-                {
-                    //checkinfohost:checkinfoport:ip:checkport
-                    hostsni = checkInfoHost + ":"
-                            + to_string((uint64_t) checkInfoPort) + ":"
-                            + m_ipAddress.toString() + ":"
-                            + to_string((uint64_t) port);
-                }
-
-                if(checkInfoPort == 443)
-                {
-                    // if default port then only the host name is passed in the url
-                    url = url + checkInfoHost;
-                }
-                else
-                {
-                    url = url + checkInfoHost + ":" + to_string((uint64_t) checkInfoPort);
-
-                }
-            }
-            HMLog(HM_LOG_DEBUG3,
-                "[CURLCHECK] curl SNI host header %s for CurlCheck for %s at %s with checkinfo %s",
-                hostsni.c_str(),
-                m_hostname.c_str(),
-                m_ipAddress.toString().c_str(),
-                checkInfo.c_str());
-
-            host = curl_slist_append(NULL, hostsni.c_str());
+            host = curl_slist_append(NULL, connectTo.c_str());
             curl_easy_setopt(curl, CURLOPT_CONNECT_TO, host);
         }
 
-        std::pair<std::string, std::string>* certkey;
         if ((m_hostCheck.getCheckType() == HM_CHECK_HTTPS
                || m_hostCheck.getCheckType() == HM_CHECK_MTLS_HTTPS)
                     && !currentState->getHealthCheckCAFile().empty())
@@ -348,93 +402,28 @@ HMWorkHealthCheckCurl::healthCheck()
         //mtls add key and cert
         if ((m_hostCheck.getCheckType() == HM_CHECK_MTLS_HTTPS
                 || m_hostCheck.getCheckType() == HM_CHECK_MTLS_HTTPS_NO_PEER_CHECK)
-                    && (!currentState->getHealthCheckCert().empty() 
-                        && !currentState->getHealthCheckKey().empty()))
+                    && currentState->getHealthCheckIdentity())
         {
-            curl_easy_setopt(curl, CURLOPT_SSLCERTTYPE, "PEM");
-            curl_easy_setopt(curl, CURLOPT_SSLKEYTYPE, "PEM");
-            certkey = new std::pair<std::string, std::string>(currentState->getHealthCheckKey(), currentState->getHealthCheckCert());
-            curl_easy_setopt(curl, CURLOPT_SSL_CTX_FUNCTION, *testsslctxkey_function);
-            curl_easy_setopt(curl, CURLOPT_SSL_CTX_DATA,certkey);
+            // currentState holds the identity until the fetch completes
+            curl_easy_setopt(curl, CURLOPT_SSL_CTX_FUNCTION, HMTLSIdentity::curlSslCtxCallback);
+            curl_easy_setopt(curl, CURLOPT_SSL_CTX_DATA, currentState->getHealthCheckIdentity().get());
         }
 
-        if(uri.empty())
-        {
-            url = url + "/status.html";
-        }
-        else
-        {
-            url = url + uri;
-        }
         curl_easy_setopt(curl,CURLOPT_URL,url.c_str());
         HMLog(HM_LOG_DEBUG3, "[CURLCHECK] curl fetching http url for CurlCheck %s",url.c_str());
 
-        rcvdBuffer = "";
-        curl_easy_setopt(curl,CURLOPT_WRITEFUNCTION, &curl_Callback);
-        curl_easy_setopt(curl,CURLOPT_WRITEDATA, this);
+        m_curlRequest.m_body.attach(curl);
 
-        m_start = HMTimeStamp::now();
-        CURLcode res = curl_easy_perform(curl);
-        m_end = HMTimeStamp::now();
+        m_start = HMMonotonicTime::now();
+        CURLcode res = m_curlRequest.m_body.getResult(curl_easy_perform(curl));
+        m_end = HMMonotonicTime::now();
+        m_curlRequest.m_body.attach(nullptr);
 
         long http_code;
         curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &http_code);
-
-
-        m_response = HM_RESPONSE_FAILED;
-        m_reason = HM_REASON_NONE;
-
-        if(res == CURLE_OK)
-        {
-            m_response = HM_RESPONSE_CONNECTED;
-            if(http_code == 200)
-            {
-                double t;
-                curl_easy_getinfo(curl, CURLINFO_CONNECT_TIME, &t);
-                m_end = m_start + ((uint64_t)(t*1000));
-                m_reason = HM_REASON_SUCCESS;
-            }
-            else
-            {
-                if(http_code >= 300 && http_code < 400)
-                {
-                    m_reason = HM_REASON_RESPONSE_3XX;
-                }
-                else if(http_code == 403)
-                {
-                    m_reason = HM_REASON_RESPONSE_403;
-                }
-                else if(http_code == 404)
-                {
-                    m_reason = HM_REASON_RESPONSE_404;
-                }
-                else if(http_code >= 500 && http_code < 600)
-                {
-                    m_reason = HM_REASON_RESPONSE_5XX;
-                }
-                else
-                {
-                    m_reason = HM_REASON_RESPONSE_DOWN;
-                }
-            }
-        }
-        else if(res == CURLE_OPERATION_TIMEDOUT)
-        {
-            m_reason = HM_REASON_RESPONSE_TIMEOUT;
-        }
-        else if(res == CURLE_LOGIN_DENIED)
-        {
-            m_reason = HM_REASON_RESPONSE_403;
-        }
-        else if(res == CURLE_COULDNT_CONNECT)
-        {
-            m_reason = HM_REASON_CONNECT_FAILURE;
-        }
-        else
-        {
-            m_reason = HM_REASON_RESPONSE_FAILURE;
-        }
-
+        double t;
+        curl_easy_getinfo(curl, CURLINFO_CONNECT_TIME, &t);
+        setHttpResult(res, http_code, (uint64_t)(t * 1000000), m_curlRequest.m_body.isMatched());
                
         HMLog(HM_LOG_DEBUG3, "[CURLCHECK] curl fetching http url for CurlCheck %s returned reason %s ",
                  url.c_str(),
@@ -446,7 +435,6 @@ HMWorkHealthCheckCurl::healthCheck()
         curl_slist_free_all(slist);
         return HM_WORK_COMPLETE;
     }
-
     else if(m_hostCheck.getCheckType() == HM_CHECK_FTP
             || m_hostCheck.getCheckType() == HM_CHECK_FTPS_IMPLICIT
             || m_hostCheck.getCheckType() == HM_CHECK_FTPS_IMPLICIT_NO_PEER_CHECK
@@ -463,7 +451,7 @@ HMWorkHealthCheckCurl::healthCheck()
         string uri;
         string url;
 
-        uint64_t timeout = (m_timeout - HMTimeStamp::now()) / 1000;
+        uint64_t timeout = (m_timeout - HMMonotonicTime::now()) / 1000;
 
         CURL* curl = curl_easy_init();
 
@@ -559,16 +547,16 @@ HMWorkHealthCheckCurl::healthCheck()
             url = url + uri;
         }
 
-        rcvdBuffer = "";
-        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, &curl_Callback);
-        curl_easy_setopt(curl, CURLOPT_WRITEDATA, this);
+        m_curlRequest.m_body.setParams(currentState->getMaxBodySize(), false);
+        m_curlRequest.m_body.attach(curl);
 
         HMLog(HM_LOG_DEBUG3, "[CURLCHECK] curl fetching ftp url for CurlCheck %s", url.c_str());
         curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
 
-        m_start = HMTimeStamp::now();
+        m_start = HMMonotonicTime::now();
         CURLcode res = curl_easy_perform(curl);
-        m_end = HMTimeStamp::now();
+        m_end = HMMonotonicTime::now();
+        m_curlRequest.m_body.attach(nullptr);
 
         long ftp_code;
         curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &ftp_code);
@@ -583,7 +571,7 @@ HMWorkHealthCheckCurl::healthCheck()
                     "[CURLCHECK] curl CONNECTED ftp url for CurlCheck %s",url.c_str());
             double t;
             curl_easy_getinfo(curl, CURLINFO_CONNECT_TIME, &t);
-            m_end = m_start + ((uint64_t) (t * 1000));
+            m_end = m_start.plusMicroseconds((uint64_t) (t * 1000000));
             m_reason = HM_REASON_SUCCESS;
         }
         else if(res == CURLE_OPERATION_TIMEDOUT)
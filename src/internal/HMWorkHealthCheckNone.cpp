@@ -2,7 +2,7 @@
 // Licensed under the terms of the Apache 2.0 license. See LICENSE file in the root of the distribution for licensing details.
 #include "HMWorkHealthCheckNone.h"
 #include "HMWork.h"
-#include "HMTimeStamp.h"
+#include "HMMonotonicTime.h"
 #include "HMConstants.h"
 #include "HMLogBase.h"
 
@@ -20,10 +20,10 @@ HMWorkHealthCheckNone::healthCheck()
                  m_hostname.c_str(),
                  m_ipAddress.toString().c_str());
 
-        m_start = HMTimeStamp::now();
+        m_start = HMMonotonicTime::now();
         m_response = HM_RESPONSE_CONNECTED;
         m_reason = HM_REASON_SUCCESS;
-        m_end= HMTimeStamp::now();
+        m_end= HMMonotonicTime::now();
         return HM_WORK_COMPLETE;
     }
     else
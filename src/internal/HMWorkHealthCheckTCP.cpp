@@ -10,7 +10,7 @@
 
 #include "HMWorkHealthCheckTCP.h"
 #include "HMWork.h"
-#include "HMTimeStamp.h"
+#include "HMMonotonicTime.h"
 #include "HMConstants.h"
 #include "HMLogBase.h"
 #include "HMStateManager.h"
@@ -32,15 +32,32 @@ HMWorkHealthCheckTCP::healthCheck()
 
         string url;
         string checkInfo = m_hostCheck.getCheckInfo();
+
+        HMConnectEngine* engine = m_stateManager->getConnectEngine();
+        if (engine != nullptr
+                && m_hostCheck.getCheckPlugin() == HM_CHECK_PLUGIN_TCP_EPOLL
+                && checkInfo != HM_MASTER_HEALTH_CHECK_COMMAND)
+        {
+            m_start = HMMonotonicTime::now();
+            m_end = m_start;
+            m_reason = HM_REASON_NONE;
+            m_response = HM_RESPONSE_FAILED;
+            if (submitConnect(engine, currentState->getConnectionTimeout()))
+            {
+                return HM_WORK_IN_PROGRESS;
+            }
+            HMLog(HM_LOG_DEBUG, "[TCPCHECK] Connect engine unavailable, using raw socket for host:%s(%s)",
+                    m_hostname.c_str(), m_ipAddress.toString().c_str());
+        }
         //Check if tcp connected successfully, if check-info is present check for returned data to match
-        m_start = HMTimeStamp::now();
-        m_end = HMTimeStamp::now();
+        m_start = HMMonotonicTime::now();
+        m_end = HMMonotonicTime::now();
         m_reason = HM_REASON_NONE;
         m_response = HM_RESPONSE_FAILED;
         timeval tv, tv_checkinfo;
         tv.tv_sec = currentState->getConnectionTimeout() / 1000;
         tv.tv_usec = 0;
-        tv_checkinfo.tv_sec = 30;
+        tv_checkinfo.tv_sec = HM_DEFAULT_TCP_CHECKINFO_TIMEOUT / 1000;
         tv_checkinfo.tv_usec = 0;
         HMSocketUtilTCP socketApi(m_ipAddress, m_hostCheck.getPort(), tv, m_hostCheck.getSourceAddress(), m_hostCheck.getTOSValue(), false);
         socketApi.connectServer();
@@ -145,4 +162,78 @@ HMWorkHealthCheckTCP::healthCheck()
     }
     return HM_WORK_COMPLETE;
 }
+
+bool
+HMWorkHealthCheckTCP::submitConnect(HMConnectEngine* engine, uint64_t timeout)
+{
+    m_connectRequest.m_address = m_ipAddress;
+    m_connectRequest.m_sourceAddress = m_hostCheck.getSourceAddress();
+    m_connectRequest.m_port = m_hostCheck.getPort();
+    m_connectRequest.m_tos = m_hostCheck.getTOSValue();
+    m_connectRequest.m_connectTimeout = timeout;
+    m_connectRequest.m_readSize = m_hostCheck.getCheckInfo().length();
+    m_connectRequest.m_readTimeout = HM_DEFAULT_TCP_CHECKINFO_TIMEOUT;
+    m_connectRequest.m_callback = HMWorkHealthCheckTCP::connectDone;
+    m_connectRequest.m_arg = this;
+    return engine->submit(m_connectRequest);
+}
+
+void
+HMWorkHealthCheckTCP::connectDone(HMConnectRequest& request, void* arg)
+{
+    HMWorkHealthCheckTCP* work = (HMWorkHealthCheckTCP*) arg;
+    const string& checkInfo = work->m_hostCheck.getCheckInfo();
+
+    work->m_reason = request.m_reason;
+    work->m_response = HM_RESPONSE_FAILED;
+    switch (request.m_reason)
+    {
+    case HM_REASON_INTERNAL_ERROR:
+        HMLog(HM_LOG_ERROR, "[TCPCHECK] %s - HostName = %s(%s), checkInfo = %s",
+                request.m_errorMsg.c_str(), work->m_hostname.c_str(), work->m_ipAddress.toString().c_str(),
+                checkInfo.c_str());
+        break;
+    case HM_REASON_CONNECT_TIMEOUT:
+        HMLog(HM_LOG_DEBUG3,
+                "[TCPCHECK] TCP connect timeout for host:%s(%s), port:%hu",
+                work->m_hostname.c_str(), work->m_ipAddress.toString().c_str(), work->m_hostCheck.getPort());
+        break;
+    case HM_REASON_CONNECT_FAILURE:
+        HMLog(HM_LOG_DEBUG3,
+                "[TCPCHECK] TCP connect failed for host:%s(%s), port:%hu",
+                work->m_hostname.c_str(), work->m_ipAddress.toString().c_str(), work->m_hostCheck.getPort());
+        break;
+    case HM_REASON_RESPONSE_TIMEOUT:
+        HMLog(HM_LOG_DEBUG,
+                "[TCPCHECK] TCP connect timeout for host:%s(%s), port:%hu",
+                work->m_hostname.c_str(), work->m_ipAddress.toString().c_str(), work->m_hostCheck.getPort());
+        break;
+    case HM_REASON_RESPONSE_FAILURE:
+        // The remote end closed the connection before sending the check info
+        work->m_reason = HM_REASON_NONE;
+        break;
+    case HM_REASON_SUCCESS:
+        work->m_end = request.m_connectTime;
+        if (checkInfo.empty() || request.m_data == checkInfo)
+        {
+            HMLog(HM_LOG_DEBUG3,
+                    "[TCPCHECK] Health check successful for host:%s(%s), port:%hu",
+                    work->m_hostname.c_str(), work->m_ipAddress.toString().c_str(), work->m_hostCheck.getPort());
+            work->m_response = HM_RESPONSE_CONNECTED;
+        }
+        else
+        {
+            HMLog(HM_LOG_DEBUG3,
+                    "[TCPCHECK] tcp response for %s(%s) did not match CheckInfo %s",
+                    work->m_hostname.c_str(), work->m_ipAddress.toString().c_str(), request.m_data.c_str());
+            work->m_reason = HM_REASON_NONE;
+        }
+        break;
+    default:
+        break;
+    }
+
+    work->m_workStatus = HM_WORK_COMPLETE;
+    work->m_stateManager->m_workQueue.addWork((HMWork*)work);
+}
 // LCOV_EXCL_STOP; Tested in functional testing
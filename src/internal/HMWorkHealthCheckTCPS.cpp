@@ -9,11 +9,12 @@
 #include <string.h>
 
 #include "HMWork.h"
-#include "HMTimeStamp.h"
+#include "HMMonotonicTime.h"
 #include "HMConstants.h"
 #include "HMLogBase.h"
 #include "HMStateManager.h"
 #include "HMWorkHealthCheckTCPS.h"
+#include "HMTLSIdentity.h"
 
 // LCOV_EXCL_START; Tested in functional testing
 
@@ -33,8 +34,9 @@ HMWorkHealthCheckTCPS::healthCheck()
         string url;
         string checkInfo = m_hostCheck.getCheckInfo();
         //Check if tcp connected successfully, if check-info is present check for returned data to match
-        m_start = HMTimeStamp::now();
-        m_end = HMTimeStamp::now();
+        m_start = HMMonotonicTime::now();
+        m_end = HMMonotonicTime::now();
+        m_connectEnd = HMMonotonicTime();
         m_reason = HM_REASON_NONE;
         m_response = HM_RESPONSE_FAILED;
         timeval tv, tv_checkinfo;
@@ -42,7 +44,18 @@ HMWorkHealthCheckTCPS::healthCheck()
         tv.tv_usec = 0;
         tv_checkinfo.tv_sec = 30;
         tv_checkinfo.tv_usec = 0;
-        if(currentState->m_ctx == NULL)
+        // Use the daemon context when secure remote is enabled, else the health check client identity
+        SSL_CTX* ctx = NULL;
+        shared_ptr<HMTLSIdentity> identity = currentState->getHealthCheckIdentity();
+        if(currentState->m_ctx != NULL)
+        {
+            ctx = currentState->m_ctx->getCtx();
+        }
+        else if(identity)
+        {
+            ctx = identity->getClientCtx();
+        }
+        if(ctx == NULL)
         {
             HMLog(HM_LOG_ERROR, "[TLSCHECK] SSL context is NULL. Check Master config params and certs - HostName = %s(%s), checkInfo = %s",
                                 m_hostname.c_str(), m_ipAddress.toString().c_str(),
@@ -50,9 +63,28 @@ HMWorkHealthCheckTCPS::healthCheck()
             m_reason = HM_REASON_INTERNAL_ERROR;
             return HM_WORK_COMPLETE;
         }
-        HMSocketUtilTCPS socketApi(currentState->m_ctx->getCtx(), m_ipAddress, m_hostCheck.getPort(), tv, m_hostCheck.getSourceAddress(), m_hostCheck.getTOSValue(), false);
+
+        HMConnectEngine* engine = m_stateManager->getConnectEngine();
+        if (engine != nullptr
+                && m_hostCheck.getCheckPlugin() == HM_CHECK_PLUGIN_TCPS_EPOLL
+                && checkInfo != HM_MASTER_HEALTH_CHECK_COMMAND)
+        {
+            if (submitConnect(engine, ctx, currentState->getConnectionTimeout()))
+            {
+                return HM_WORK_IN_PROGRESS;
+            }
+            HMLog(HM_LOG_DEBUG, "[TLSCHECK] Connect engine unavailable, using raw socket for host:%s(%s)",
+                    m_hostname.c_str(), m_ipAddress.toString().c_str());
+            m_start = HMMonotonicTime::now();
+            m_end = m_start;
+        }
+        HMSocketUtilTCPS socketApi(ctx, m_ipAddress, m_hostCheck.getPort(), tv, m_hostCheck.getSourceAddress(), m_hostCheck.getTOSValue(), false);
         socketApi.connectServer();
         m_reason = socketApi.getReason();
+        if (socketApi.getTCPConnectTime().isSet())
+        {
+            m_connectEnd = socketApi.getTCPConnectTime();
+        }
         switch (m_reason)
         {
         case HM_REASON_INTERNAL_ERROR:
@@ -153,4 +185,95 @@ HMWorkHealthCheckTCPS::healthCheck()
     }
     return HM_WORK_COMPLETE;
 }
+
+bool
+HMWorkHealthCheckTCPS::submitConnect(HMConnectEngine* engine, SSL_CTX* ctx, uint64_t timeout)
+{
+    // Keep the context alive until the engine is done with it, a reload can free it meanwhile
+    SSL_CTX_up_ref(ctx);
+    m_connectRequest.m_address = m_ipAddress;
+    m_connectRequest.m_sourceAddress = m_hostCheck.getSourceAddress();
+    m_connectRequest.m_port = m_hostCheck.getPort();
+    m_connectRequest.m_tos = m_hostCheck.getTOSValue();
+    m_connectRequest.m_connectTimeout = timeout;
+    m_connectRequest.m_readSize = m_hostCheck.getCheckInfo().length();
+    m_connectRequest.m_readTimeout = HM_DEFAULT_TCP_CHECKINFO_TIMEOUT;
+    m_connectRequest.m_sslCtx = ctx;
+    m_connectRequest.m_callback = HMWorkHealthCheckTCPS::connectDone;
+    m_connectRequest.m_arg = this;
+    if (!engine->submit(m_connectRequest))
+    {
+        SSL_CTX_free(ctx);
+        m_connectRequest.m_sslCtx = nullptr;
+        return false;
+    }
+    return true;
+}
+
+void
+HMWorkHealthCheckTCPS::connectDone(HMConnectRequest& request, void* arg)
+{
+    HMWorkHealthCheckTCPS* work = (HMWorkHealthCheckTCPS*) arg;
+    const string& checkInfo = work->m_hostCheck.getCheckInfo();
+
+    SSL_CTX_free(request.m_sslCtx);
+    request.m_sslCtx = nullptr;
+
+    work->m_connectEnd = request.m_connectTime;
+    work->m_reason = request.m_reason;
+    work->m_response = HM_RESPONSE_FAILED;
+    switch (request.m_reason)
+    {
+    case HM_REASON_INTERNAL_ERROR:
+        HMLog(HM_LOG_ERROR, "[TLSCHECK] %s - HostName = %s(%s), checkInfo = %s",
+                request.m_errorMsg.c_str(), work->m_hostname.c_str(), work->m_ipAddress.toString().c_str(),
+                checkInfo.c_str());
+        break;
+    case HM_REASON_CONNECT_TIMEOUT:
+        HMLog(HM_LOG_DEBUG3,
+                "[TLSCHECK] TLS connect timeout for host:%s(%s), port:%hu",
+                work->m_hostname.c_str(), work->m_ipAddress.toString().c_str(), work->m_hostCheck.getPort());
+        break;
+    case HM_REASON_CONNECT_FAILURE:
+        HMLog(HM_LOG_DEBUG3,
+                "[TLSCHECK] TLS connect failed for host:%s(%s), port:%hu",
+                work->m_hostname.c_str(), work->m_ipAddress.toString().c_str(), work->m_hostCheck.getPort());
+        break;
+    case HM_REASON_RESPONSE_TIMEOUT:
+        HMLog(HM_LOG_DEBUG,
+                "[TLSCHECK] TLS connect timeout for host:%s(%s), port:%hu",
+                work->m_hostname.c_str(), work->m_ipAddress.toString().c_str(), work->m_hostCheck.getPort());
+        break;
+    case HM_REASON_RESPONSE_FAILURE:
+        // The remote end closed the connection before sending the check info
+        work->m_reason = HM_REASON_NONE;
+        break;
+    case HM_REASON_SUCCESS:
+        work->m_end = request.m_handshakeTime;
+        HMLog(HM_LOG_DEBUG3,
+                "[TLSCHECK] Connection successful to host:%s(%s), port:%hu, session %s",
+                work->m_hostname.c_str(), work->m_ipAddress.toString().c_str(), work->m_hostCheck.getPort(),
+                request.m_sessionReused ? "resumed" : "negotiated");
+        if (checkInfo.empty() || request.m_data == checkInfo)
+        {
+            HMLog(HM_LOG_DEBUG3,
+                    "[TLSCHECK] Health check successful for host:%s(%s), port:%hu",
+                    work->m_hostname.c_str(), work->m_ipAddress.toString().c_str(), work->m_hostCheck.getPort());
+            work->m_response = HM_RESPONSE_CONNECTED;
+        }
+        else
+        {
+            HMLog(HM_LOG_DEBUG3,
+                    "[TLSCHECK] tls response for %s(%s) did not match CheckInfo %s",
+                    work->m_hostname.c_str(), work->m_ipAddress.toString().c_str(), request.m_data.c_str());
+            work->m_reason = HM_REASON_NONE;
+        }
+        break;
+    default:
+        break;
+    }
+
+    work->m_workStatus = HM_WORK_COMPLETE;
+    work->m_stateManager->m_workQueue.addWork((HMWork*)work);
+}
 // LCOV_EXCL_STOP; Tested in functional testing
@@ -5,7 +5,7 @@
 #include "HMWorkMarkFetchCurl.h"
 #include "HMWorkHealthMultiWork.h"
 #include "HMWork.h"
-#include "HMTimeStamp.h"
+#include "HMMonotonicTime.h"
 #include "HMConstants.h"
 #include "HMLogBase.h"
 #include "HMStateManager.h"
@@ -4,7 +4,7 @@
 
 #include "HMWorkMarkFetchCurl.h"
 #include "HMWork.h"
-#include "HMTimeStamp.h"
+#include "HMMonotonicTime.h"
 #include "HMConstants.h"
 #include "HMLogBase.h"
 #include "HMStateManager.h"
@@ -13,13 +13,6 @@
 
 using namespace std;
 
-size_t
-curl_Callback(void* ptr, size_t size, size_t nmemb, HMWorkMarkFetchCurl* check)
-{
-    check->updateBuffer((char*)ptr,nmemb);
-    return size * nmemb;
-}
-
 int
 sockopt_CallBack(void *sockopt, curl_socket_t curlfd,
                             curlsocktype purpose)
@@ -60,12 +53,6 @@ sockopt_mark_callback(void *sockopt, curl_socket_t curlfd,
     return CURL_SOCKOPT_OK;
 }
 
-void
-HMWorkMarkFetchCurl::updateBuffer(char* buf, uint32_t length)
-{
-    rcvdBuffer = rcvdBuffer + string(buf, length);
-}
-
 HM_WORK_STATUS
 HMWorkMarkFetchCurl::healthCheck()
 {
@@ -87,7 +74,7 @@ HMWorkMarkFetchCurl::healthCheck()
         curl_slist* slist = NULL;
         struct curl_slist *host = NULL;
 
-        uint64_t timeout = m_timeout - HMTimeStamp::now();
+        uint64_t timeout = m_timeout - HMMonotonicTime::now();
 
         if(!curl)
         {
@@ -297,13 +284,13 @@ HMWorkMarkFetchCurl::healthCheck()
         curl_easy_setopt(curl,CURLOPT_URL,url.c_str());
         HMLog(HM_LOG_DEBUG3, "[CURLMARKCHECK] curl fetching http url for CurlCheck %s",url.c_str());
 
-        rcvdBuffer = "";
-        curl_easy_setopt(curl,CURLOPT_WRITEFUNCTION, &curl_Callback);
-        curl_easy_setopt(curl,CURLOPT_WRITEDATA, this);
+        m_rcvdBuffer.setParams(currentState->getMaxBodySize(), false, m_hostCheck.getCheckExpect());
+        m_rcvdBuffer.attach(curl);
 
-        m_start = HMTimeStamp::now();
-        CURLcode res = curl_easy_perform(curl);
-        m_end = HMTimeStamp::now();
+        m_start = HMMonotonicTime::now();
+        CURLcode res = m_rcvdBuffer.getResult(curl_easy_perform(curl));
+        m_end = HMMonotonicTime::now();
+        m_rcvdBuffer.attach(nullptr);
 
         long http_code;
         curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &http_code);
@@ -314,11 +301,17 @@ HMWorkMarkFetchCurl::healthCheck()
         if(res == CURLE_OK)
         {
             m_response = HM_RESPONSE_CONNECTED;
-            if(http_code == 200)
+            if(http_code == 200 && !m_rcvdBuffer.isMatched())
+            {
+                HMLog(HM_LOG_DEBUG3, "[CURLMARKCHECK] Body from %s(%s) did not contain %s",
+                        m_hostname.c_str(), m_ipAddress.toString().c_str(), m_hostCheck.getCheckExpect().c_str());
+                m_reason = HM_REASON_RESPONSE_DOWN;
+            }
+            else if(http_code == 200)
             {
                 double t;
                 curl_easy_getinfo(curl, CURLINFO_CONNECT_TIME, &t);
-                m_end = m_start + ((uint64_t)(t*1000));
+                m_end = m_start.plusMicroseconds((uint64_t)(t * 1000000));
                 m_reason = HM_REASON_SUCCESS;
             }
             else
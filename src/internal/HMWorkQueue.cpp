@@ -3,12 +3,43 @@
 #define __STDC_FORMAT_MACROS
 #include <inttypes.h>
 
+#include <thread>
+
 #include "HMWorkQueue.h"
 #include "HMConstants.h"
 #include "HMLogBase.h"
 
 using namespace std;
 
+//! Used to hand out the home shards to the threads.
+static atomic<uint32_t> s_nextThreadShard(0);
+
+HMWorkQueue::HMWorkQueue(uint32_t nShards) :
+    m_mapShards(new MapShard[HM_WORK_MAP_SHARDS]),
+    m_size(0),
+    m_sleepers(0),
+    m_ttlTreshold(HM_DEFAULT_TTL_THRESHOLD),
+    m_shutdown(false)
+{
+    setConfig(HMWorkQueueConfig());
+    if(nShards == 0)
+    {
+        nShards = thread::hardware_concurrency();
+    }
+    if(nShards == 0)
+    {
+        nShards = 1;
+    }
+    if(nShards > HM_WORK_QUEUE_MAX_SHARDS)
+    {
+        nShards = HM_WORK_QUEUE_MAX_SHARDS;
+    }
+    for(uint32_t i = 0; i < nShards; i++)
+    {
+        m_shards.push_back(make_unique<Shard>());
+    }
+}
+
 void
 HMWorkQueue::cycleThreads()
 {
@@ -16,6 +47,20 @@ HMWorkQueue::cycleThreads()
     m_notifyCond.notify_all();
 }
 
+uint32_t
+HMWorkQueue::getHomeShard()
+{
+    static thread_local uint32_t threadShard = s_nextThreadShard++;
+    return threadShard % m_shards.size();
+}
+
+HMWorkQueue::MapShard&
+HMWorkQueue::getMapShard(HMWork* work)
+{
+    // Work orders are heap allocated, skip the low bits that are always zero
+    return m_mapShards[(reinterpret_cast<uintptr_t>(work) >> 4) % HM_WORK_MAP_SHARDS];
+}
+
 void
 HMWorkQueue::insertWork(unique_ptr<HMWork>& work)
 {
@@ -37,133 +82,249 @@ HMWorkQueue::insertWork(unique_ptr<HMWork>& work)
                 (uint32_t) work->m_hostCheck.getPort(),
                 work->m_hostname.c_str(), work->m_ipAddress.toString().c_str());
     }
-    unique_lock<mutex> lock(m_queueMutex);
-    m_queue.push(move(work));
+    work->m_queueTime = HMMonotonicTime::now();
+    Shard& home = *m_shards[getHomeShard()];
+    unique_lock<mutex> lock(home.m_queueMutex);
+    home.m_queue.push(work);
+    m_size++;
     lock.unlock();
-    lock_guard<mutex> lg(m_notifyMutex);
-    m_notifyCond.notify_one();
+    // Only take the notify lock if a thread is waiting for work
+    if(m_sleepers > 0)
+    {
+        lock_guard<mutex> lg(m_notifyMutex);
+        m_notifyCond.notify_one();
+    }
 }
 
 void
 HMWorkQueue::insertMap(unique_ptr<HMWork>& work)
 {
-    lock_guard<mutex> mg(m_mapMutex);
-    m_workMap.emplace(work.get(),move(work));
+    MapShard& shard = getMapShard(work.get());
+    {
+        lock_guard<mutex> mg(shard.m_mapMutex);
+        // The continuation may already have completed before the worker parked the work
+        if(shard.m_earlyCompletions.erase(work.get()) == 0)
+        {
+            shard.m_workMap.emplace(work.get(),move(work));
+            return;
+        }
+    }
+    insertWork(work);
 }
 
 void
 HMWorkQueue::addWork(HMWork* value)
 {
+    MapShard& shard = getMapShard(value);
     unique_ptr<HMWork> work;
     {
-        lock_guard<mutex> mg(m_mapMutex);
-        work = move((m_workMap.at(value)));
-        m_workMap.erase(value);
+        lock_guard<mutex> mg(shard.m_mapMutex);
+        auto it = shard.m_workMap.find(value);
+        if(it == shard.m_workMap.end())
+        {
+            // The worker has not parked the work yet, let insertMap requeue it
+            shard.m_earlyCompletions.insert(value);
+            return;
+        }
+        work = move(it->second);
+        shard.m_workMap.erase(it);
     }
     insertWork(work);
 }
 
+bool
+HMWorkQueue::takeWork(uint32_t homeIndex, unique_ptr<HMWork>& work, bool& starved)
+{
+    uint32_t weights[HM_WORK_CLASS_COUNT];
+    for(uint32_t i = 0; i < HM_WORK_CLASS_COUNT; i++)
+    {
+        weights[i] = m_weights[i].load(memory_order_relaxed);
+    }
+    uint64_t starvationTime = m_starvationTime.load(memory_order_relaxed);
+
+    Shard& home = *m_shards[homeIndex];
+    {
+        lock_guard<mutex> lock(home.m_queueMutex);
+        if(home.m_queue.pop(work, weights, starvationTime, starved))
+        {
+            m_size--;
+            return true;
+        }
+    }
+
+    // Steal half of the first shard with work, starting after our own, in the order the victim would hand it out
+    vector<unique_ptr<HMWork>> batch;
+    for(uint32_t i = 1; i < m_shards.size() && batch.empty(); i++)
+    {
+        Shard& victim = *m_shards[(homeIndex + i) % m_shards.size()];
+        lock_guard<mutex> lock(victim.m_queueMutex);
+        size_t nSteal = (victim.m_queue.size() + 1) / 2;
+        if(nSteal > HM_WORK_QUEUE_STEAL_BATCH)
+        {
+            nSteal = HM_WORK_QUEUE_STEAL_BATCH;
+        }
+        unique_ptr<HMWork> stolen;
+        bool stolenStarved = false;
+        for(size_t j = 0; j < nSteal && victim.m_queue.pop(stolen, weights, starvationTime, stolenStarved); j++)
+        {
+            if(batch.empty())
+            {
+                starved = stolenStarved;
+            }
+            batch.push_back(move(stolen));
+        }
+    }
+    if(batch.empty())
+    {
+        return false;
+    }
+
+    work = move(batch.front());
+    m_size--;
+    if(batch.size() > 1)
+    {
+        lock_guard<mutex> lock(home.m_queueMutex);
+        for(size_t j = 1; j < batch.size(); j++)
+        {
+            home.m_queue.push(batch[j]);
+        }
+    }
+    return true;
+}
+
 bool
 HMWorkQueue::getWork(unique_ptr<HMWork>& work, bool& threadShutdown)
 {
-    unique_lock<mutex> queueLock(m_queueMutex, defer_lock);
+    uint32_t homeIndex = getHomeShard();
     unique_lock<mutex> notifyLock(m_notifyMutex, defer_lock);
     while(!m_shutdown && !threadShutdown)
     {
         // retrieve work
-        queueLock.lock();
-        if(!m_queue.empty())
+        bool starved = false;
+        if(takeWork(homeIndex, work, starved))
         {
-            work = move(m_queue.front());
-            m_queue.pop();
-            queueLock.unlock();
-            
-            if(work->m_workStatus != HM_WORK_IN_PROGRESS)
-            {
-                // deal with timing issues here
-                HMTimeStamp now = HMTimeStamp::now();
-
-                uint64_t totalTime = now - work->m_start;
-                m_totalCount++;
-                m_totalTime += totalTime;
-
-                if(m_totalCount == 1000)
-                {
-                    uint64_t avg = m_totalTime / 1000;
-                    m_totalCount = 0;
-                    m_totalTime = 0;
-
-                    HMLog(HM_LOG_INFO, "[CORE] Average queue time for 1000 queries is %" PRIu64 " ms", avg);
-                }
-
-                if (now > (work->m_end - (((float)m_ttlTreshold/100.0) * (work->m_end - work->m_start))))
-                {
-                    m_numOffSchedule += 1;
-                }
-
-                if(now > work->m_end)
-                {
-                    uint64_t ttl = work->m_end - work->m_start;
-                    HM_WORK_TYPE workType = work->getWorkType();
-                    if(workType == HM_WORK_DNSLOOKUP)
-                    {
-                        HMLog(HM_LOG_INFO, "[CORE] DNS Lookup Work order for %s in the queue for %" PRIu64" ms with a ttl of %" PRIu64,
-                                work->m_hostname.c_str(),
-                                totalTime,
-                                ttl);
-                    }
-                    else if(workType == HM_WORK_REMOTECHECK)
-                    {
-                        HMLog(HM_LOG_INFO, "[CORE] Remote Host Group Lookup Work order for %s in the queue for %" PRIu64" ms with a ttl of %" PRIu64,
-                                work->m_hostname.c_str(),
-                                totalTime,
-                                ttl);
-                    }
-                    else if(workType == HM_WORK_REMOTEHOSTCHECK)
-                    {
-                        HMLog(HM_LOG_INFO, "[CORE] Remote Host Lookup Work order for %s in the queue for %" PRIu64" ms with a ttl of %" PRIu64,
-                                work->m_hostname.c_str(),
-                                totalTime,
-                                ttl);
-                    }
-                    else
-                    {
-                        HMLog(HM_LOG_WARNING, "[CORE] %s Work order for %s checking %s in the queue for %" PRIu64" ms with a ttl of %" PRIu64,
-                                printWorkType(workType).c_str(),
-                                work->m_hostname.c_str(),
-                                work->m_ipAddress.toString().c_str(),
-                                totalTime,
-                                ttl);
-                    }
-                }
-
-                HMLog(HM_LOG_DEBUG3, "[CORE] Processing work order for %s which was queued for %llu",
-                        work->m_hostname.c_str(),
-                        totalTime);
-            }
-            HMLog(HM_LOG_DEBUG, "[CORE] Work Queue Length %d", m_queue.size());
+            updateStats(*m_shards[homeIndex], work, starved);
+            HMLog(HM_LOG_DEBUG, "[CORE] Work Queue Length %d", (uint32_t)m_size);
             return true;
         }
-        queueLock.unlock();
 
         notifyLock.lock();
-        m_notifyCond.wait(notifyLock, [this, &threadShutdown](){return (!m_queue.empty() || m_shutdown || threadShutdown);});
+        m_sleepers++;
+        m_notifyCond.wait(notifyLock, [this, &threadShutdown](){return (m_size > 0 || m_shutdown || threadShutdown);});
+        m_sleepers--;
         notifyLock.unlock();
     }
     return false;
 }
 
+void
+HMWorkQueue::updateStats(Shard& home, unique_ptr<HMWork>& work, bool starved)
+{
+    HM_WORK_CLASS workClass = work->getWorkClass();
+    if(workClass < HM_WORK_CLASS_COUNT)
+    {
+        home.m_classDequeued[workClass].fetch_add(1, memory_order_relaxed);
+        home.m_classWait[workClass].fetch_add(HMMonotonicTime::now().microsecondsSince(work->m_queueTime), memory_order_relaxed);
+        if(starved)
+        {
+            home.m_classStarved[workClass].fetch_add(1, memory_order_relaxed);
+        }
+    }
+
+    if(work->m_workStatus != HM_WORK_IN_PROGRESS)
+    {
+        // deal with timing issues here
+        HMMonotonicTime now = HMMonotonicTime::now();
+
+        uint64_t totalTime = now - work->m_start;
+        // Continuations are queued again long after their start, only count the time in the queue
+        uint64_t queueWait = now - work->m_queueTime;
+        home.m_totalCount++;
+        home.m_totalTime += queueWait;
+        uint32_t bucket = queueWait ? 64 - __builtin_clzll(queueWait) : 0;
+        if(bucket >= HM_WORK_QUEUE_WAIT_BUCKETS)
+        {
+            bucket = HM_WORK_QUEUE_WAIT_BUCKETS - 1;
+        }
+        home.m_waitHistogram[bucket].fetch_add(1, memory_order_relaxed);
+
+        if(home.m_totalCount == 1000)
+        {
+            uint64_t avg = home.m_totalTime / 1000;
+            home.m_totalCount = 0;
+            home.m_totalTime = 0;
+
+            HMLog(HM_LOG_INFO, "[CORE] Average queue time for 1000 queries is %" PRIu64 " ms", avg);
+        }
+
+        if (now > (work->m_end - (((float)m_ttlTreshold/100.0) * (work->m_end - work->m_start))))
+        {
+            home.m_numOffSchedule += 1;
+        }
+
+        if(now > work->m_end)
+        {
+            uint64_t ttl = work->m_end - work->m_start;
+            HM_WORK_TYPE workType = work->getWorkType();
+            if(workType == HM_WORK_DNSLOOKUP)
+            {
+                HMLog(HM_LOG_INFO, "[CORE] DNS Lookup Work order for %s in the queue for %" PRIu64" ms with a ttl of %" PRIu64,
+                        work->m_hostname.c_str(),
+                        totalTime,
+                        ttl);
+            }
+            else if(workType == HM_WORK_REMOTECHECK)
+            {
+                HMLog(HM_LOG_INFO, "[CORE] Remote Host Group Lookup Work order for %s in the queue for %" PRIu64" ms with a ttl of %" PRIu64,
+                        work->m_hostname.c_str(),
+                        totalTime,
+                        ttl);
+            }
+            else if(workType == HM_WORK_REMOTEHOSTCHECK)
+            {
+                HMLog(HM_LOG_INFO, "[CORE] Remote Host Lookup Work order for %s in the queue for %" PRIu64" ms with a ttl of %" PRIu64,
+                        work->m_hostname.c_str(),
+                        totalTime,
+                        ttl);
+            }
+            else
+            {
+                HMLog(HM_LOG_WARNING, "[CORE] %s Work order for %s checking %s in the queue for %" PRIu64" ms with a ttl of %" PRIu64,
+                        printWorkType(workType).c_str(),
+                        work->m_hostname.c_str(),
+                        work->m_ipAddress.toString().c_str(),
+                        totalTime,
+                        ttl);
+            }
+        }
+
+        HMLog(HM_LOG_DEBUG3, "[CORE] Processing work order for %s which was queued for %llu",
+                work->m_hostname.c_str(),
+                totalTime);
+    }
+}
+
 uint32_t
 HMWorkQueue::queueSize()
 {
-    lock_guard<mutex> lg(m_queueMutex);
-    return m_queue.size();
+    return m_size;
+}
+
+uint32_t
+HMWorkQueue::getShardCount() const
+{
+    return m_shards.size();
 }
 
 uint64_t
 HMWorkQueue::getNumOffSchedule() const
 {
-    return m_numOffSchedule;
+    uint64_t numOffSchedule = 0;
+    for(auto& shard : m_shards)
+    {
+        numOffSchedule += shard->m_numOffSchedule;
+    }
+    return numOffSchedule;
 }
 
 uint32_t
@@ -175,7 +336,12 @@ HMWorkQueue::getTtlTreshold() const
 void
 HMWorkQueue::setNumOffSchedule(uint64_t numOffSchedule)
 {
-    m_numOffSchedule = numOffSchedule;
+    // Keep the total in the first shard
+    for(auto& shard : m_shards)
+    {
+        shard->m_numOffSchedule = 0;
+    }
+    m_shards[0]->m_numOffSchedule = numOffSchedule;
 }
 
 void
@@ -185,6 +351,62 @@ HMWorkQueue::setTtlTreshold(uint32_t ttlTreshold)
 
 }
 
+void
+HMWorkQueue::collectQueueWait(vector<uint64_t>& histogram)
+{
+    histogram.resize(HM_WORK_QUEUE_WAIT_BUCKETS, 0);
+    for(auto& shard : m_shards)
+    {
+        for(uint32_t i = 0; i < HM_WORK_QUEUE_WAIT_BUCKETS; i++)
+        {
+            histogram[i] += shard->m_waitHistogram[i].exchange(0, memory_order_relaxed);
+        }
+    }
+}
+
+void
+HMWorkQueue::setConfig(const HMWorkQueueConfig& config)
+{
+    for(uint32_t i = 0; i < HM_WORK_CLASS_COUNT; i++)
+    {
+        m_weights[i] = config.m_weights[i] ? config.m_weights[i] : 1;
+    }
+    m_starvationTime = config.m_starvationTime * 1000;
+}
+
+void
+HMWorkQueue::getWorkQueueInfo(HMAPIWorkQueueInfo& info)
+{
+    info.m_queueSize = m_size;
+    info.m_numShards = m_shards.size();
+    info.m_starvationTime = m_starvationTime / 1000;
+    info.m_classes.clear();
+    info.m_classes.resize(HM_WORK_CLASS_COUNT);
+    HMMonotonicTime now = HMMonotonicTime::now();
+    for(uint32_t i = 0; i < HM_WORK_CLASS_COUNT; i++)
+    {
+        info.m_classes[i].m_name = printWorkClass((HM_WORK_CLASS)i);
+        info.m_classes[i].m_weight = m_weights[i];
+    }
+    for(auto& shard : m_shards)
+    {
+        lock_guard<mutex> lock(shard->m_queueMutex);
+        for(uint32_t i = 0; i < HM_WORK_CLASS_COUNT; i++)
+        {
+            HMAPIWorkClassInfo& classInfo = info.m_classes[i];
+            classInfo.m_depth += shard->m_queue.size((HM_WORK_CLASS)i);
+            classInfo.m_dequeued += shard->m_classDequeued[i];
+            classInfo.m_totalWait += shard->m_classWait[i];
+            classInfo.m_starved += shard->m_classStarved[i];
+            HMMonotonicTime oldest = shard->m_queue.getOldest((HM_WORK_CLASS)i);
+            if(oldest.isSet() && now.microsecondsSince(oldest) > classInfo.m_oldestWait)
+            {
+                classInfo.m_oldestWait = now.microsecondsSince(oldest);
+            }
+        }
+    }
+}
+
 void
 HMWorkQueue::shutdown()
 {
@@ -24,6 +24,11 @@ HM_WORK_STATUS HMWorkRemoteCheck::processWork()
 
     m_workStatus = remoteLookup();
     currentState->m_remoteCache.finishCheck(m_hostname, true);
+    if(m_workStatus != HM_WORK_COMPLETE_REMOTE)
+    {
+        // The stored results will no longer match the remote ones, the next delta fetch has to resync
+        currentState->m_remoteCache.setSubscription(m_hostname, HMIPAddress(), 0, 0);
+    }
 
     if(m_workStatus == HM_WORK_COMPLETE_REMOTE)
     {
@@ -40,9 +45,9 @@ HM_WORK_STATUS HMWorkRemoteCheck::processWork()
     m_stateManager->updateState(currentState);
 
     // Make sure we completed the query with success and don't need another
-    HMTimeStamp checkTime = currentState->m_remoteCache.nextCheckTime(
+    HMMonotonicTime checkTime = currentState->m_remoteCache.nextCheckTime(
             m_hostname);
-    if (checkTime <= HMTimeStamp::now())
+    if (checkTime <= HMMonotonicTime::now())
     {
         currentState->m_remoteCache.queueRemoteCheck(m_hostname,
                 m_stateManager->m_workQueue, currentState->m_hostGroups);
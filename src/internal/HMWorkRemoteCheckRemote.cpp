@@ -1,6 +1,8 @@
 // Copyright 2019, Oath Inc.
 // Licensed under the terms of the Apache 2.0 license. See LICENSE file in the root of the distribution for licensing details.
 
+#include <unordered_map>
+
 #include "HMIPAddress.h"
 #include "HMLogBase.h"
 #include "HMWork.h"
@@ -79,7 +81,9 @@ HMWorkRemoteCheckRemote::getHostResult(HMState& state, const string& remoteHost,
         break;
     }
 
-    if (socketAPI->getHostGroupResults(m_hostname, tv_checkinfo, m_hash, m_results) == HM_SOCK_DATA_OK)
+    bool fetched = state.isEnableRemoteSubscribe()
+            && getHostGroupDelta(state, socketAPI, remote.m_address, tv_checkinfo);
+    if (fetched || socketAPI->getHostGroupResults(m_hostname, tv_checkinfo, m_hash, m_results) == HM_SOCK_DATA_OK)
     {
         if (this->m_hostCheck.getCheckType() != HM_CHECK_AUX_HTTP
                 && this->m_hostCheck.getCheckType() != HM_CHECK_AUX_HTTPS
@@ -113,6 +117,62 @@ HMWorkRemoteCheckRemote::getHostResult(HMState& state, const string& remoteHost,
     return false;
 }
 
+bool
+HMWorkRemoteCheckRemote::getHostGroupDelta(HMState& state, shared_ptr<HMSocketUtilBase>& socketAPI, const HMIPAddress& peer, timeval& tv)
+{
+    HMIPAddress lastPeer;
+    uint64_t epoch = 0;
+    uint64_t sequence = 0;
+    state.m_remoteCache.getSubscription(m_hostname, lastPeer, epoch, sequence);
+    if(!(lastPeer == peer))
+    {
+        epoch = 0;
+        sequence = 0;
+    }
+    bool resync = false;
+    vector<HMGroupCheckResult> delta;
+    if(socketAPI->getHostGroupDelta(m_hostname, tv, m_hash, epoch, sequence, resync, delta) != HM_SOCK_DATA_OK)
+    {
+        state.m_remoteCache.setSubscription(m_hostname, HMIPAddress(), 0, 0);
+        return false;
+    }
+    size_t received = delta.size();
+    if(resync)
+    {
+        m_results.swap(delta);
+    }
+    else
+    {
+        state.m_datastore->getGroupCheckResults(m_hostname, m_results);
+        unordered_map<string, size_t> index;
+        for(size_t i = 0; i < m_results.size(); i++)
+        {
+            // The unchanged results get the check time of the remote host back, updateResults stamps them again
+            m_results[i].m_result.m_checkTime = m_results[i].m_result.m_remoteCheckTime;
+            index[m_results[i].m_hostName + '\0' + m_results[i].m_address.toString()] = i;
+        }
+        for(auto& result : delta)
+        {
+            auto it = index.find(result.m_hostName + '\0' + result.m_address.toString());
+            if(it == index.end())
+            {
+                m_results.push_back(move(result));
+            }
+            else
+            {
+                m_results[it->second] = move(result);
+            }
+        }
+    }
+    HMLog(HM_LOG_DEBUG3,
+            "[%s-%s] Fetched %s of %lu results for hostgroup %s at sequence %lu",
+            printFlowType(m_hostCheck.getFlowType()).c_str(),
+            printRemoteCheckType(m_hostCheck.getRemoteCheckType()).c_str(),
+            resync ? "resync" : "delta", received, m_hostname.c_str(), sequence);
+    state.m_remoteCache.setSubscription(m_hostname, peer, epoch, sequence);
+    return true;
+}
+
 bool
 HMWorkRemoteCheckRemote::remoteCheck(HMState& state, HMDataHostGroup& dataHostGroup)
 {
@@ -198,8 +258,8 @@ HMWorkRemoteCheckRemote::remoteLookup()
 
     if (!m_hostCheck.getRemoteCheck().empty())
     {
-        m_start = HMTimeStamp::now();
-        m_end = HMTimeStamp::now();
+        m_start = HMMonotonicTime::now();
+        m_end = HMMonotonicTime::now();
         m_reason = HM_REASON_NONE;
         m_response = HM_RESPONSE_FAILED;
         shared_ptr<HMState> currentState;
@@ -41,9 +41,9 @@ HM_WORK_STATUS HMWorkRemoteHostCheck::processWork()
     m_stateManager->updateState(currentState);
 
     // Make sure we completed the query with success and don't need another
-    HMTimeStamp checkTime = currentState->m_remoteHostCache.nextCheckTime(
+    HMMonotonicTime checkTime = currentState->m_remoteHostCache.nextCheckTime(
             m_hostname, m_hostCheck);
-    if (checkTime <= HMTimeStamp::now())
+    if (checkTime <= HMMonotonicTime::now())
     {
         currentState->m_remoteHostCache.queueRemoteCheck(m_hostname, m_hostCheck,
                 m_stateManager->m_workQueue);
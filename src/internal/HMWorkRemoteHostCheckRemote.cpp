@@ -198,8 +198,8 @@ HMWorkRemoteHostCheckRemote::remoteLookup()
 
     if (!m_hostCheck.getRemoteCheck().empty())
     {
-        m_start = HMTimeStamp::now();
-        m_end = HMTimeStamp::now();
+        m_start = HMMonotonicTime::now();
+        m_end = HMMonotonicTime::now();
         m_reason = HM_REASON_NONE;
         m_response = HM_RESPONSE_FAILED;
         shared_ptr<HMState> currentState;
@@ -0,0 +1,488 @@
+// Copyright 2019, Oath Inc.
+// Licensed under the terms of the Apache 2.0 license. See LICENSE file in the root of the distribution for licensing details.
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <netinet/in.h>
+#include <netdb.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <signal.h>
+#include <system_error>
+#include <deque>
+
+#include "HMDNSResolver.h"
+#include "HMLogBase.h"
+
+using namespace std;
+
+//! The max number of epoll events to process per wakeup.
+#define HM_DNS_RESOLVER_MAX_EVENTS 1024
+//! The max number of submitted lookups to start per wakeup, so a burst of submits can't starve the replies already in flight.
+#define HM_DNS_RESOLVER_MAX_STARTS 128
+
+static string
+resolverError(const string& msg)
+{
+    error_code ec(errno, generic_category());
+    return msg + " " + ec.message();
+}
+
+HMDNSResolver::~HMDNSResolver()
+{
+    shutDown();
+}
+
+bool
+HMDNSResolver::start()
+{
+    if(m_keepRunning)
+    {
+        return true;
+    }
+    m_keepRunning = true;
+    for(uint32_t i = 0; i < m_nThreads; i++)
+    {
+        unique_ptr<Reactor> reactor = make_unique<Reactor>();
+        reactor->m_epollFd = epoll_create1(EPOLL_CLOEXEC);
+        reactor->m_wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if(reactor->m_epollFd < 0 || reactor->m_wakeFd < 0)
+        {
+            HMLog(HM_LOG_CRITICAL, "[RESOLVER] %s", resolverError("Failed to create the DNS resolver").c_str());
+            if(reactor->m_epollFd >= 0)
+            {
+                close(reactor->m_epollFd);
+            }
+            if(reactor->m_wakeFd >= 0)
+            {
+                close(reactor->m_wakeFd);
+            }
+            shutDown();
+            return false;
+        }
+        epoll_event ev;
+        memset(&ev, 0, sizeof(ev));
+        ev.events = EPOLLIN;
+        ev.data.fd = reactor->m_wakeFd;
+        epoll_ctl(reactor->m_epollFd, EPOLL_CTL_ADD, reactor->m_wakeFd, &ev);
+        reactor->m_lastSweep = HMMonotonicTime::now();
+        reactor->m_thread = thread(&HMDNSResolver::run, this, reactor.get());
+        m_reactors.push_back(move(reactor));
+    }
+    {
+        lock_guard<shared_timed_mutex> lk(m_stateMutex);
+        m_stopped = false;
+    }
+    HMLog(HM_LOG_NOTICE, "[RESOLVER] Started DNS resolver with %u threads", m_nThreads);
+    return true;
+}
+
+void
+HMDNSResolver::shutDown()
+{
+    {
+        // Submits check the flag under the same lock, so none can queue a request after the threads drained
+        lock_guard<shared_timed_mutex> lk(m_stateMutex);
+        m_stopped = true;
+        m_keepRunning = false;
+    }
+    for(auto& reactor : m_reactors)
+    {
+        uint64_t val = 1;
+        if(write(reactor->m_wakeFd, &val, sizeof(val)) < 0)
+        {
+            HMLog(HM_LOG_DEBUG, "[RESOLVER] Failed to wake DNS resolver thread");
+        }
+    }
+    for(auto& reactor : m_reactors)
+    {
+        if(reactor->m_thread.joinable())
+        {
+            reactor->m_thread.join();
+        }
+        close(reactor->m_wakeFd);
+        close(reactor->m_epollFd);
+    }
+    m_reactors.clear();
+}
+
+bool
+HMDNSResolver::submit(HMDNSRequest& request)
+{
+    shared_lock<shared_timed_mutex> lk(m_stateMutex);
+    if(m_stopped || m_reactors.empty())
+    {
+        return false;
+    }
+    Reactor* reactor = m_reactors[m_nextReactor++ % m_reactors.size()].get();
+    request.m_status = ARES_SUCCESS;
+    request.m_timeouts = 0;
+    request.m_name.clear();
+    request.m_addresses.clear();
+    m_inFlight++;
+    {
+        lock_guard<mutex> submitLock(reactor->m_submitMutex);
+        reactor->m_submitted.push_back(&request);
+    }
+    uint64_t val = 1;
+    if(write(reactor->m_wakeFd, &val, sizeof(val)) < 0)
+    {
+        HMLog(HM_LOG_DEBUG, "[RESOLVER] Failed to wake DNS resolver thread");
+    }
+    return true;
+}
+
+uint64_t
+HMDNSResolver::getInFlight() const
+{
+    return m_inFlight;
+}
+
+uint32_t
+HMDNSResolver::getNThreads() const
+{
+    return m_nThreads;
+}
+
+void
+HMDNSResolver::getServerStats(map<string, HMDNSServerStats>& stats)
+{
+    lock_guard<mutex> lk(m_statsMutex);
+    stats = m_serverStats;
+}
+
+void
+HMDNSResolver::run(Reactor* reactor)
+{
+    signal(SIGPIPE, SIG_IGN);
+    vector<epoll_event> events(HM_DNS_RESOLVER_MAX_EVENTS);
+    vector<HMDNSRequest*> submitted;
+    deque<HMDNSRequest*> backlog;
+
+    while(m_keepRunning)
+    {
+        int nEvents = epoll_wait(reactor->m_epollFd, events.data(), events.size(), backlog.empty() ? nextTimeout(reactor) : 0);
+        if(nEvents < 0 && errno != EINTR)
+        {
+            HMLog(HM_LOG_ERROR, "[RESOLVER] %s", resolverError("epoll_wait failed").c_str());
+        }
+
+        for(int i = 0; i < nEvents; i++)
+        {
+            int fd = events[i].data.fd;
+            if(fd == reactor->m_wakeFd)
+            {
+                uint64_t val;
+                while(read(reactor->m_wakeFd, &val, sizeof(val)) > 0);
+                continue;
+            }
+            // The socket may have been closed while processing an earlier event
+            auto it = reactor->m_sockets.find(fd);
+            if(it == reactor->m_sockets.end())
+            {
+                continue;
+            }
+            ares_socket_t readFd = (events[i].events & (EPOLLIN | EPOLLERR | EPOLLHUP)) ? fd : ARES_SOCKET_BAD;
+            ares_socket_t writeFd = (events[i].events & EPOLLOUT) ? fd : ARES_SOCKET_BAD;
+            ares_process_fd(it->second->m_channel, readFd, writeFd);
+        }
+
+        {
+            lock_guard<mutex> lk(reactor->m_submitMutex);
+            submitted.swap(reactor->m_submitted);
+        }
+        backlog.insert(backlog.end(), submitted.begin(), submitted.end());
+        submitted.clear();
+        for(uint32_t i = 0; i < HM_DNS_RESOLVER_MAX_STARTS && !backlog.empty(); i++)
+        {
+            startLookup(reactor, backlog.front());
+            backlog.pop_front();
+        }
+
+        processTimeouts(reactor);
+        sweepChannels(reactor);
+    }
+
+    // Hand back everything still pending so the owners can finish.
+    {
+        lock_guard<mutex> lk(reactor->m_submitMutex);
+        submitted.swap(reactor->m_submitted);
+    }
+    backlog.insert(backlog.end(), submitted.begin(), submitted.end());
+    for(auto request : backlog)
+    {
+        fail(request, ARES_EDESTRUCTION);
+    }
+    // Destroying a channel completes its pending lookups with ARES_EDESTRUCTION
+    for(auto& it : reactor->m_channels)
+    {
+        ares_destroy(it.second->m_channel);
+    }
+    reactor->m_channels.clear();
+}
+
+HMDNSResolver::Channel*
+HMDNSResolver::getChannel(Reactor* reactor, const HMDNSRequest& request)
+{
+    uint64_t timeout = (request.m_timeout == 0) ? HM_DEFAULT_DNS_RESOLUTION_TIMEOUT : request.m_timeout;
+    string server = request.m_server.isSet() ? request.m_server.toString() : "system";
+    if(request.m_port != 0)
+    {
+        server += ":" + to_string(request.m_port);
+    }
+    string key = server + (request.m_useTCP ? "/tcp/" : "/udp/") + request.m_sourceAddress.toString()
+            + "/" + to_string(timeout) + "/" + to_string(request.m_tries);
+
+    auto it = reactor->m_channels.find(key);
+    if(it != reactor->m_channels.end())
+    {
+        return it->second.get();
+    }
+
+    unique_ptr<Channel> channel = make_unique<Channel>(reactor, key, server);
+    ares_options opts;
+    memset(&opts, 0, sizeof(opts));
+    opts.flags = request.m_useTCP ? ARES_FLAG_USEVC : 0;
+    opts.timeout = timeout;
+    opts.tries = request.m_tries ? request.m_tries : 1;
+    opts.sock_state_cb = HMDNSResolver::socketStateCallback;
+    opts.sock_state_cb_data = channel.get();
+    int optMask = ARES_OPT_FLAGS | ARES_OPT_TIMEOUTMS | ARES_OPT_TRIES | ARES_OPT_SOCK_STATE_CB;
+    if(request.m_port != 0)
+    {
+        if(request.m_useTCP)
+        {
+            opts.tcp_port = request.m_port;
+            optMask |= ARES_OPT_TCP_PORT;
+        }
+        else
+        {
+            opts.udp_port = request.m_port;
+            optMask |= ARES_OPT_UDP_PORT;
+        }
+    }
+
+    if(ares_init_options(&channel->m_channel, &opts, optMask) != ARES_SUCCESS)
+    {
+        HMLog(HM_LOG_ERROR, "[RESOLVER] Ares Init Error for %s", server.c_str());
+        return nullptr;
+    }
+
+    if(request.m_server.isSet())
+    {
+        ares_addr_node addrs;
+        memset(&addrs, 0, sizeof(addrs));
+        addrs.next = nullptr;
+        addrs.family = request.m_server.getType();
+        if(addrs.family == AF_INET)
+        {
+            addrs.addr.addr4.s_addr = request.m_server.addr4();
+        }
+        else
+        {
+            in6_addr ipv6addr = request.m_server.addr6();
+            memcpy(&addrs.addr.addr6, &ipv6addr, sizeof(addrs.addr.addr6));
+        }
+        ares_set_servers(channel->m_channel, &addrs);
+    }
+
+    if(request.m_sourceAddress.getType() == AF_INET)
+    {
+        ares_set_local_ip4(channel->m_channel, ntohl(request.m_sourceAddress.addr4()));
+    }
+    else if(request.m_sourceAddress.getType() == AF_INET6)
+    {
+        in6_addr ipv6addr = request.m_sourceAddress.addr6();
+        ares_set_local_ip6(channel->m_channel, (const unsigned char*)&ipv6addr);
+    }
+
+    HMLog(HM_LOG_DEBUG, "[RESOLVER] Created channel %s", key.c_str());
+    Channel* ret = channel.get();
+    reactor->m_channels.emplace(key, move(channel));
+    return ret;
+}
+
+void
+HMDNSResolver::startLookup(Reactor* reactor, HMDNSRequest* request)
+{
+    request->m_start = HMMonotonicTime::now();
+    Channel* channel = getChannel(reactor, *request);
+    if(channel == nullptr)
+    {
+        fail(request, ARES_ENOTINITIALIZED);
+        return;
+    }
+    channel->m_pending++;
+    channel->m_lastUsed = request->m_start;
+    Query* query = new Query(this, channel, request);
+    HMLog(HM_LOG_DEBUG3, "[RESOLVER] Resolving %s with %s", request->m_hostname.c_str(), channel->m_server.c_str());
+    // The callback may run before ares_gethostbyname returns, the query must not be used afterwards
+    ares_gethostbyname(channel->m_channel, request->m_hostname.c_str(), request->m_family,
+            HMDNSResolver::hostCallback, query);
+}
+
+int
+HMDNSResolver::nextTimeout(Reactor* reactor)
+{
+    if(reactor->m_channels.empty())
+    {
+        return -1;
+    }
+    // Wake up at least once per idle period to sweep the idle channels
+    uint64_t next = HM_DNS_RESOLVER_CHANNEL_IDLE_TIME;
+    for(auto& it : reactor->m_channels)
+    {
+        Channel* channel = it.second.get();
+        if(channel->m_pending == 0)
+        {
+            continue;
+        }
+        timeval tv;
+        if(ares_timeout(channel->m_channel, NULL, &tv) != NULL)
+        {
+            uint64_t timeout = tv.tv_sec * 1000 + (tv.tv_usec + 999) / 1000;
+            next = (timeout < next) ? timeout : next;
+        }
+    }
+    return (int)next;
+}
+
+void
+HMDNSResolver::processTimeouts(Reactor* reactor)
+{
+    for(auto& it : reactor->m_channels)
+    {
+        if(it.second->m_pending > 0)
+        {
+            ares_process_fd(it.second->m_channel, ARES_SOCKET_BAD, ARES_SOCKET_BAD);
+        }
+    }
+}
+
+void
+HMDNSResolver::sweepChannels(Reactor* reactor)
+{
+    HMMonotonicTime now = HMMonotonicTime::now();
+    if(now < reactor->m_lastSweep + HM_DNS_RESOLVER_CHANNEL_IDLE_TIME)
+    {
+        return;
+    }
+    reactor->m_lastSweep = now;
+    for(auto it = reactor->m_channels.begin(); it != reactor->m_channels.end();)
+    {
+        Channel* channel = it->second.get();
+        if(channel->m_pending == 0 && channel->m_lastUsed + HM_DNS_RESOLVER_CHANNEL_IDLE_TIME <= now)
+        {
+            HMLog(HM_LOG_DEBUG, "[RESOLVER] Destroying idle channel %s", channel->m_key.c_str());
+            ares_destroy(channel->m_channel);
+            it = reactor->m_channels.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
+void
+HMDNSResolver::complete(Query* query, int status, int timeouts, hostent* host)
+{
+    HMDNSRequest* request = query->m_request;
+    Channel* channel = query->m_channel;
+    delete query;
+
+    request->m_end = HMMonotonicTime::now();
+    request->m_status = status;
+    request->m_timeouts = timeouts;
+    if(status == ARES_SUCCESS && host != nullptr)
+    {
+        if(host->h_name != nullptr)
+        {
+            request->m_name = host->h_name;
+        }
+        for(char** p = host->h_addr_list; *p != NULL; p++)
+        {
+            HMIPAddress ip;
+            if(ip.set(*p, host->h_addrtype))
+            {
+                request->m_addresses.push_back(ip);
+            }
+        }
+    }
+
+    {
+        lock_guard<mutex> lk(m_statsMutex);
+        HMDNSServerStats& stats = m_serverStats[channel->m_server];
+        stats.m_queries++;
+        stats.m_totalTime += request->m_end - request->m_start;
+        switch(status)
+        {
+        case ARES_SUCCESS:
+            stats.m_success++;
+            break;
+        case ARES_ENOTFOUND:
+        case ARES_ENODATA:
+            stats.m_notFound++;
+            break;
+        case ARES_ETIMEOUT:
+            stats.m_timeouts++;
+            break;
+        default:
+            stats.m_failures++;
+            break;
+        }
+    }
+
+    channel->m_pending--;
+    channel->m_lastUsed = request->m_end;
+    m_inFlight--;
+    if(request->m_callback)
+    {
+        request->m_callback(*request, request->m_arg);
+    }
+}
+
+void
+HMDNSResolver::fail(HMDNSRequest* request, int status)
+{
+    request->m_end = HMMonotonicTime::now();
+    request->m_status = status;
+    m_inFlight--;
+    if(request->m_callback)
+    {
+        request->m_callback(*request, request->m_arg);
+    }
+}
+
+void
+HMDNSResolver::socketStateCallback(void* data, ares_socket_t fd, int readable, int writable)
+{
+    Channel* channel = (Channel*) data;
+    Reactor* reactor = channel->m_reactor;
+    if(!readable && !writable)
+    {
+        epoll_ctl(reactor->m_epollFd, EPOLL_CTL_DEL, fd, nullptr);
+        reactor->m_sockets.erase(fd);
+        return;
+    }
+
+    epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = (readable ? (uint32_t)EPOLLIN : 0) | (writable ? (uint32_t)EPOLLOUT : 0);
+    ev.data.fd = fd;
+    int op = (reactor->m_sockets.count(fd) > 0) ? EPOLL_CTL_MOD : EPOLL_CTL_ADD;
+    reactor->m_sockets[fd] = channel;
+    if(epoll_ctl(reactor->m_epollFd, op, fd, &ev) < 0)
+    {
+        HMLog(HM_LOG_ERROR, "[RESOLVER] %s", resolverError("epoll_ctl").c_str());
+    }
+}
+
+void
+HMDNSResolver::hostCallback(void* arg, int status, int timeouts, hostent* host)
+{
+    Query* query = (Query*) arg;
+    query->m_resolver->complete(query, status, timeouts, host);
+}
@@ -8,6 +8,7 @@
 #include "HMLogBase.h"
 #include "HMWork.h"
 #include "HMStateManager.h"
+#include "HMDNSResolver.h"
 
 // LCOV_EXCL_START; Tested in functional testing
 
@@ -18,46 +19,19 @@ aresCallback (void* arg, int status, int timeouts, struct hostent* host)
 {
     (void)timeouts;
     HMWorkDNSLookupAres* check = (HMWorkDNSLookupAres*)arg;
+    vector<HMIPAddress> addresses;
     if (status == ARES_SUCCESS)
     {
-        bool isIPEmpty = true;
-        // now the ip addresses
         for(char** p = host->h_addr_list; *p != NULL; p++)
         {
             HMIPAddress ip;
             if(ip.set(*p,host->h_addrtype))
             {
-                isIPEmpty = false;
-                check->addIP(ip);
+                addresses.push_back(ip);
             }
         }
-        if (isIPEmpty)
-        {
-            HMIPAddress ip(check->m_ipAddress.getType());
-            check->addIP(ip);
-            check->m_response = HM_RESPONSE_DNS_FAILED;
-            check->m_reason = HM_REASON_DNS_FAILURE;
-        }
-    }
-    else if (status == ARES_ETIMEOUT)
-    {
-        HMIPAddress ip(check->m_ipAddress.getType());
-        check->addIP(ip);
-        check->m_response = HM_RESPONSE_DNS_FAILED;
-        check->m_reason = HM_REASON_DNS_TIMEOUT;
-        string ip_version = check->m_ipAddress.getType() == AF_INET? "IPv4":"IPv6";
-        HMLog(HM_LOG_DEBUG3,"[ARES] DNS lookup %s for %s: TIMEOUT",check->m_hostname.c_str(), ip_version.c_str());
-    }
-    else
-    {
-        HMIPAddress ip(check->m_ipAddress.getType());
-        check->addIP(ip);
-        check->m_reason = (ARES_ENOTFOUND == status)
-                   ? HM_REASON_DNS_NOTFOUND : HM_REASON_DNS_FAILURE;
-        check->m_response = HM_RESPONSE_DNS_FAILED;
-        string ip_version = check->m_ipAddress.getType() == AF_INET? "IPv4":"IPv6";
-        HMLog(HM_LOG_NOTICE,"[ARES] %s %s for host %s", ip_version.c_str(), printReason(check->m_reason).c_str(),check->m_hostname.c_str());
     }
+    check->setLookupResult(status, addresses);
     check->signalDone();
 }
 
@@ -71,6 +45,28 @@ HMWorkDNSLookupAres::init(HMWorkState& state)
 HM_WORK_STATUS
 HMWorkDNSLookupAres::dnsLookup()
 {
+    HMDNSResolver* resolver = m_stateManager->getDNSResolver();
+    if(resolver != nullptr)
+    {
+        shared_ptr<HMState> current;
+        m_stateManager->updateState(current);
+        HMLog(HM_LOG_DEBUG3, "[ARES] Resolving %s with the DNS resolver" , m_hostname.c_str());
+        m_dnsRequest.m_hostname = m_hostname;
+        m_dnsRequest.m_family = (m_ipAddress.getType() == AF_INET) ? AF_INET : AF_INET6;
+        if(!current->getDNSAddress(m_dnsRequest.m_server))
+        {
+            m_dnsRequest.m_server = HMIPAddress();
+        }
+        m_dnsRequest.m_timeout = current->getDNSLookupTimeout();
+        m_dnsRequest.m_tries = current->getDNSRetries();
+        m_dnsRequest.m_callback = HMWorkDNSLookupAres::lookupDone;
+        m_dnsRequest.m_arg = this;
+        if(resolver->submit(m_dnsRequest))
+        {
+            return HM_WORK_IN_PROGRESS;
+        }
+        HMLog(HM_LOG_DEBUG, "[ARES] DNS resolver unavailable, resolving %s on the worker thread", m_hostname.c_str());
+    }
 
     m_finished = false;
     int nfds;
@@ -102,8 +98,15 @@ HMWorkDNSLookupAres::dnsLookup()
         ares_process(*m_channel, &readers, &writers);
     } while(!m_finished);
 
+    storeResult();
+    return HM_WORK_COMPLETE;
+}
+
+void
+HMWorkDNSLookupAres::storeResult()
+{
     // Now process the returned data
-    m_start = HMTimeStamp::now();
+    m_start = HMMonotonicTime::now();
     m_end = m_start;
     shared_ptr<HMState> current;
     m_stateManager->updateState(current);
@@ -128,7 +131,57 @@ HMWorkDNSLookupAres::dnsLookup()
         }
     }
     current->m_dnsCache.finishQuery(m_hostname, m_dnsHostCheck, true);
-    return HM_WORK_COMPLETE;
+}
+
+void
+HMWorkDNSLookupAres::setLookupResult(int status, const vector<HMIPAddress>& addresses)
+{
+    if (status == ARES_SUCCESS)
+    {
+        bool isIPEmpty = true;
+        // now the ip addresses
+        for(auto ip : addresses)
+        {
+            isIPEmpty = false;
+            addIP(ip);
+        }
+        if (isIPEmpty)
+        {
+            HMIPAddress ip(m_ipAddress.getType());
+            addIP(ip);
+            m_response = HM_RESPONSE_DNS_FAILED;
+            m_reason = HM_REASON_DNS_FAILURE;
+        }
+    }
+    else if (status == ARES_ETIMEOUT)
+    {
+        HMIPAddress ip(m_ipAddress.getType());
+        addIP(ip);
+        m_response = HM_RESPONSE_DNS_FAILED;
+        m_reason = HM_REASON_DNS_TIMEOUT;
+        string ip_version = m_ipAddress.getType() == AF_INET? "IPv4":"IPv6";
+        HMLog(HM_LOG_DEBUG3,"[ARES] DNS lookup %s for %s: TIMEOUT",m_hostname.c_str(), ip_version.c_str());
+    }
+    else
+    {
+        HMIPAddress ip(m_ipAddress.getType());
+        addIP(ip);
+        m_reason = (ARES_ENOTFOUND == status)
+                   ? HM_REASON_DNS_NOTFOUND : HM_REASON_DNS_FAILURE;
+        m_response = HM_RESPONSE_DNS_FAILED;
+        string ip_version = m_ipAddress.getType() == AF_INET? "IPv4":"IPv6";
+        HMLog(HM_LOG_NOTICE,"[ARES] %s %s for host %s", ip_version.c_str(), printReason(m_reason).c_str(),m_hostname.c_str());
+    }
+}
+
+void
+HMWorkDNSLookupAres::lookupDone(HMDNSRequest& request, void* arg)
+{
+    HMWorkDNSLookupAres* work = (HMWorkDNSLookupAres*) arg;
+    work->setLookupResult(request.m_status, request.m_addresses);
+    work->storeResult();
+    work->m_workStatus = HM_WORK_COMPLETE;
+    work->m_stateManager->m_workQueue.addWork((HMWork*)work);
 }
 
 void
@@ -8,9 +8,10 @@
 
 #include "HMWorkHealthCheckDNS.h"
 #include "HMWork.h"
-#include "HMTimeStamp.h"
+#include "HMMonotonicTime.h"
 #include "HMConstants.h"
 #include "HMLogBase.h"
+#include "HMStateManager.h"
 
 // LCOV_EXCL_START; Tested in functional testing
 
@@ -19,27 +20,38 @@ using namespace std;
 static void
 aresCallback (void* arg, int status, int timeouts, struct hostent* host)
 {
-    HM_REASON ret = HM_REASON_NONE;
     HMWorkHealthCheckDNS* check = (HMWorkHealthCheckDNS*)arg;
-    string msg;
+    HMIPAddress ip;
     if (status == ARES_SUCCESS)
     {
-        HMIPAddress ip;
-        if(ip.set(host->h_addr_list[0],host->h_addrtype))
+        ip.set(host->h_addr_list[0],host->h_addrtype);
+    }
+    check->setCheckResult(status, timeouts, (status == ARES_SUCCESS) ? host->h_name : "", ip);
+    check->signalDone();
+}
+
+void
+HMWorkHealthCheckDNS::setCheckResult(int aresStatus, int timeouts, const string& name, const HMIPAddress& ip)
+{
+    HM_REASON ret = HM_REASON_NONE;
+    string msg;
+    if (aresStatus == ARES_SUCCESS)
+    {
+        if(ip.isSet())
         {
-            msg = "Resolved address : " + string (host->h_name) + " with IP : "+ ip.toString();
+            msg = "Resolved address : " + name + " with IP : "+ ip.toString();
         }
         ret = HM_REASON_SUCCESS;
 
     }
-    else if (status == ARES_ENOTFOUND)
+    else if (aresStatus == ARES_ENOTFOUND)
     {
-        msg = "DNS lookup not found, error code :" + to_string(status);
+        msg = "DNS lookup not found, error code :" + to_string(aresStatus);
         ret = HM_REASON_DNS_NOTFOUND;
     }
     else
     {
-        msg = "Ares DNS failure, error code:" + to_string(status);
+        msg = "Ares DNS failure, error code:" + to_string(aresStatus);
         ret = HM_REASON_DNS_FAILURE;
     }
 
@@ -50,8 +62,22 @@ aresCallback (void* arg, int status, int timeouts, struct hostent* host)
         ret = HM_REASON_DNS_TIMEOUT;
     }
 
-    check->status(ret,msg);
-    check->signalDone();
+    status(ret,msg);
+}
+
+void
+HMWorkHealthCheckDNS::lookupDone(HMDNSRequest& request, void* arg)
+{
+    HMWorkHealthCheckDNS* work = (HMWorkHealthCheckDNS*) arg;
+    work->m_end = request.m_end;
+    HMIPAddress ip;
+    if(!request.m_addresses.empty())
+    {
+        ip = request.m_addresses.front();
+    }
+    work->setCheckResult(request.m_status, request.m_timeouts, request.m_name, ip);
+    work->m_workStatus = HM_WORK_COMPLETE;
+    work->m_stateManager->m_workQueue.addWork((HMWork*)work);
 }
 
 HM_WORK_STATUS
@@ -73,13 +99,35 @@ HMWorkHealthCheckDNS::healthCheck()
         fd_set readers, writers;
         timeval tv, *tvp, maxtv;
 
-        uint64_t timeout = m_timeout - HMTimeStamp::now();
+        uint64_t timeout = m_timeout - HMMonotonicTime::now();
         maxtv.tv_sec = timeout / 1000;
         maxtv.tv_usec = 0;
 
         m_response = HM_RESPONSE_FAILED;
         m_reason = HM_REASON_NONE;
 
+        HMDNSResolver* resolver = m_stateManager->getDNSResolver();
+        if(resolver != nullptr)
+        {
+            m_dnsRequest.m_hostname = checkInfo;
+            m_dnsRequest.m_family = (m_ipAddress.getType() == AF_INET) ? AF_INET : AF_INET6;
+            m_dnsRequest.m_server = m_ipAddress;
+            m_dnsRequest.m_port = m_hostCheck.getPort();
+            m_dnsRequest.m_useTCP = (m_hostCheck.getCheckType() == HM_CHECK_DNSVC);
+            m_dnsRequest.m_sourceAddress = m_hostCheck.getSourceAddress();
+            m_dnsRequest.m_timeout = timeout;
+            m_dnsRequest.m_tries = 1;
+            m_dnsRequest.m_callback = HMWorkHealthCheckDNS::lookupDone;
+            m_dnsRequest.m_arg = this;
+            m_start = HMMonotonicTime::now();
+            if(resolver->submit(m_dnsRequest))
+            {
+                return HM_WORK_IN_PROGRESS;
+            }
+            HMLog(HM_LOG_DEBUG, "[DNSCHECK] DNS resolver unavailable, checking %s on the worker thread",
+                    m_ipAddress.toString().c_str());
+        }
+
         struct ares_options opts;
         opts.flags = 0;
 
@@ -134,7 +182,7 @@ HMWorkHealthCheckDNS::healthCheck()
             {
                 ares_set_local_ip6(channel, (const unsigned char*)m_hostCheck.getSourceAddress().addr6().__in6_u.__u6_addr32);
             }
-            m_start = HMTimeStamp::now();
+            m_start = HMMonotonicTime::now();
 
             if(m_ipAddress.getType() == AF_INET)
             {
@@ -159,7 +207,7 @@ HMWorkHealthCheckDNS::healthCheck()
                 ares_process(channel, &readers, &writers);
             }
 
-            m_end = HMTimeStamp::now();
+            m_end = HMMonotonicTime::now();
 
             ares_destroy(channel);
         }
@@ -88,11 +88,8 @@ cxx_cond_wait(void *cond_, void *lock_, const struct timeval *tv)
 
     if (tv)
     {
-        HMTimeStamp ts;
-        ts.setTime(tv->tv_sec * 1000 + tv->tv_usec);
-        ts = ts + HMTimeStamp::now();
-
-        r = cond->wait_until(lck, ts.m_timeStamp);
+        // Wait for the relative timeout instead of until a wall clock time, so a clock step does not change the wait
+        r = cond->wait_for(lck, std::chrono::seconds(tv->tv_sec) + std::chrono::microseconds(tv->tv_usec));
         if (r == cv_status::timeout)
         {
             return 1;
@@ -180,7 +177,7 @@ HMEventLoopLibEvent::~HMEventLoopLibEvent()
 }
 
 void
-HMEventLoopLibEvent::addDNSTimeout(const string& hostname, const HMDNSLookup& dnsHostCheck, HMTimeStamp timeStamp)
+HMEventLoopLibEvent::addDNSTimeout(const string& hostname, const HMDNSLookup& dnsHostCheck, HMMonotonicTime timeStamp)
 {
     DNSTimeout* data = new DNSTimeout(hostname, dnsHostCheck);
     //struct event* ev = event_new(m_base, -1, 0, &HMEventLoopLibEvent::handleDNSTimeout, data);
@@ -195,7 +192,7 @@ HMEventLoopLibEvent::addDNSTimeout(const string& hostname, const HMDNSLookup& dn
 }
 
 void
-HMEventLoopLibEvent::addRemoteTimeout(const string& hostGroupName, HMTimeStamp timeStamp)
+HMEventLoopLibEvent::addRemoteTimeout(const string& hostGroupName, HMMonotonicTime timeStamp)
 {
     RemoteTimeout* data = new RemoteTimeout(hostGroupName);
     //struct event* ev = event_new(m_base, -1, 0, &HMEventLoopLibEvent::handleDNSTimeout, data);
@@ -210,7 +207,7 @@ HMEventLoopLibEvent::addRemoteTimeout(const string& hostGroupName, HMTimeStamp t
 }
 
 void
-HMEventLoopLibEvent::addRemoteHostTimeout(const std::string& hostname, const HMDataHostCheck& dataHostCheck, HMTimeStamp timeStamp)
+HMEventLoopLibEvent::addRemoteHostTimeout(const std::string& hostname, const HMDataHostCheck& dataHostCheck, HMMonotonicTime timeStamp)
 {
     RemoteHostTimeout* data = new RemoteHostTimeout(hostname, dataHostCheck);
     //struct event* ev = event_new(m_base, -1, 0, &HMEventLoopLibEvent::handleDNSTimeout, data);
@@ -225,13 +222,13 @@ HMEventLoopLibEvent::addRemoteHostTimeout(const std::string& hostname, const HMD
 }
 
 void
-HMEventLoopLibEvent::addHealthCheckTimeout(const string& hostname, const HMIPAddress& address, const HMDataHostCheck hostCheck, HMTimeStamp timeStamp)
+HMEventLoopLibEvent::addHealthCheckTimeout(const string& hostname, const HMIPAddress& address, const HMDataHostCheck hostCheck, HMMonotonicTime timeStamp)
 {
     HealthCheckTimeout* data = new HealthCheckTimeout(hostname, address, hostCheck);
     //struct event* ev = event_new(m_base, -1, 0, &HMEventLoopLibEvent::handleHealthCheckTimeout, data);
     struct event* ev =  evtimer_new(m_base, &HMEventLoopLibEvent::handleHealthCheckTimeout, data);
 
-    struct timeval tv = timeStamp.getTimeout();
+    struct timeval tv = m_checkSchedule.jitter(timeStamp).getTimeout();
     HMLog(HM_LOG_DEBUG3, "[EVENT] Adding HealthCheck timeout %d.%d for %s", tv.tv_sec, tv.tv_usec, hostname.c_str());
     data->m_ev = ev;
     data->m_stateManager = m_stateManager;
@@ -271,7 +268,8 @@ HMEventLoopLibEvent::handleDNSTimeout(evutil_socket_t fd, short what, void* arg)
                 data->m_hostname.c_str());
         currentState->m_dnsCache.queueDNSQuery(data->m_hostname,
                 data->m_dnsHostCheck,
-                state->m_workQueue);
+                state->m_workQueue,
+                event);
     }
     else if (check_state == HM_SCHEDULE_EVENT)
     {
@@ -279,7 +277,7 @@ HMEventLoopLibEvent::handleDNSTimeout(evutil_socket_t fd, short what, void* arg)
                 "[DEBUG] DNS Health Check Schedule event for %s",
                 data->m_hostname.c_str());
         HMDataHostCheck temp;
-        HMTimeStamp nextCheckTimeOut = currentState->m_checkList.nextCheckTime(data->m_hostname, HMIPAddress(), temp);
+        HMMonotonicTime nextCheckTimeOut = currentState->m_checkList.nextCheckTime(data->m_hostname, HMIPAddress(), temp);
         event->addDNSTimeout(data->m_hostname, data->m_dnsHostCheck, nextCheckTimeOut);
     }
 
@@ -325,7 +323,7 @@ HMEventLoopLibEvent::handleRemoteTimeout(evutil_socket_t fd, short what, void* a
         HMLog(HM_LOG_DEBUG3,
                 "[DEBUG] Remote Check Schedule event for %s",
                 data->m_hostGroupName.c_str());
-        HMTimeStamp nextCheckTimeOut = currentState->m_remoteCache.nextCheckTime(data->m_hostGroupName);
+        HMMonotonicTime nextCheckTimeOut = currentState->m_remoteCache.nextCheckTime(data->m_hostGroupName);
         event->addRemoteTimeout(data->m_hostGroupName, nextCheckTimeOut);
     }
 
@@ -370,7 +368,7 @@ HMEventLoopLibEvent::handleRemoteHostTimeout(evutil_socket_t fd, short what, voi
                 "[DEBUG] Remote Check Schedule event for %s",
                 data->m_hostName.c_str());
         HMDataHostCheck temp;
-        HMTimeStamp nextCheckTimeOut = currentState->m_remoteHostCache.nextCheckTime(data->m_hostName, data->m_hostCheck);
+        HMMonotonicTime nextCheckTimeOut = currentState->m_remoteHostCache.nextCheckTime(data->m_hostName, data->m_hostCheck);
         event->addRemoteHostTimeout(data->m_hostName, data->m_hostCheck, nextCheckTimeOut);
     }
 
@@ -409,13 +407,13 @@ HMEventLoopLibEvent::handleHealthCheckTimeout(evutil_socket_t fd, short what, vo
                 data->m_hostname.c_str());
         currentState->m_checkList.queueCheck(data->m_hostname,
                 data->m_address, data->m_hostCheck,
-                state->m_workQueue);
+                state->m_workQueue, event);
     }
     else if (check_state == HM_SCHEDULE_EVENT)
     {
         HMLog(HM_LOG_DEBUG3, "[DEBUG] Health Check Schedule event for %s",
                 data->m_hostname.c_str());
-        HMTimeStamp nextCheckTimeOut = currentState->m_checkList.nextCheckTime(data->m_hostname, data->m_address, data->m_hostCheck);
+        HMMonotonicTime nextCheckTimeOut = currentState->m_checkList.nextCheckTime(data->m_hostname, data->m_address, data->m_hostCheck);
         event->addHealthCheckTimeout(data->m_hostname, data->m_address, data->m_hostCheck, nextCheckTimeOut);
     }
 
@@ -71,7 +71,7 @@ HMWorkDNSLookupLibEvent::libEventDNSCallback (int result, char type, int count,
 HM_WORK_STATUS
 HMWorkDNSLookupLibEvent::dnsLookup()
 {
-    m_start = HMTimeStamp::now();
+    m_start = HMMonotonicTime::now();
     m_end = m_start;
 
     HMEventLoopLibEvent* le = m_stateManager->getLibEvent();
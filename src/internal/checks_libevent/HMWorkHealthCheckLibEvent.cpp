@@ -15,6 +15,7 @@
 #include "HMEventLoopLibEvent.h"
 #include "HMStateManager.h"
 #include "HMLogBase.h"
+#include "HMTLSIdentity.h"
 
 using namespace std;
 
@@ -23,7 +24,9 @@ HMWorkHealthCheckLibEvent::healthCheck()
 {
     if (m_hostCheck.getCheckType() == HM_CHECK_HTTP
             || m_hostCheck.getCheckType() == HM_CHECK_HTTPS
-            || m_hostCheck.getCheckType() == HM_CHECK_HTTPS_NO_PEER_CHECK)
+            || m_hostCheck.getCheckType() == HM_CHECK_HTTPS_NO_PEER_CHECK
+            || m_hostCheck.getCheckType() == HM_CHECK_MTLS_HTTPS
+            || m_hostCheck.getCheckType() == HM_CHECK_MTLS_HTTPS_NO_PEER_CHECK)
     {
         string uri;
         string url;
@@ -54,7 +57,8 @@ HMWorkHealthCheckLibEvent::healthCheck()
             return HM_WORK_COMPLETE;
         }
 
-        if (m_hostCheck.getCheckType() == HM_CHECK_HTTPS_NO_PEER_CHECK)
+        if (m_hostCheck.getCheckType() == HM_CHECK_HTTPS_NO_PEER_CHECK
+                || m_hostCheck.getCheckType() == HM_CHECK_MTLS_HTTPS_NO_PEER_CHECK)
         {
             m_verifyPeer = false;
         }
@@ -212,7 +216,9 @@ HMWorkHealthCheckLibEvent::healthCheck()
 
         // Now we start to setup the connection
         if( m_hostCheck.getCheckType() == HM_CHECK_HTTPS
-            || m_hostCheck.getCheckType() == HM_CHECK_HTTPS_NO_PEER_CHECK)
+            || m_hostCheck.getCheckType() == HM_CHECK_HTTPS_NO_PEER_CHECK
+            || m_hostCheck.getCheckType() == HM_CHECK_MTLS_HTTPS
+            || m_hostCheck.getCheckType() == HM_CHECK_MTLS_HTTPS_NO_PEER_CHECK)
         {
             // now get the cert store
             SSL_CTX* ssl_ctx = le->getSSLCertStore();
@@ -234,6 +240,24 @@ HMWorkHealthCheckLibEvent::healthCheck()
                 return HM_WORK_COMPLETE;
             }
 
+            if(m_hostCheck.getCheckType() == HM_CHECK_MTLS_HTTPS
+                || m_hostCheck.getCheckType() == HM_CHECK_MTLS_HTTPS_NO_PEER_CHECK)
+            {
+                // The connection takes its own references on the already parsed key and certificate
+                shared_ptr<HMState> currentState;
+                m_stateManager->updateState(currentState);
+                shared_ptr<HMTLSIdentity> identity = currentState->getHealthCheckIdentity();
+                if(!identity || !identity->useIdentity(m_ssl))
+                {
+                    HMLog(HM_LOG_ERROR,"[LIBHTTP] LibEvent failed to set the health check certificate");
+                    SSL_free(m_ssl);
+                    m_ssl = NULL;
+                    m_response = HM_RESPONSE_FAILED;
+                    m_reason = HM_REASON_INTERNAL_ERROR;
+                    return HM_WORK_COMPLETE;
+                }
+            }
+
             if(sni)
             {
                 SSL_set_tlsext_host_name(m_ssl, hostsni.c_str());
@@ -243,7 +267,7 @@ HMWorkHealthCheckLibEvent::healthCheck()
                                 BUFFEREVENT_SSL_CONNECTING,
                                 BEV_OPT_CLOSE_ON_FREE | BEV_OPT_DEFER_CALLBACKS);
         }
-
+        else
         {
             m_bev = bufferevent_socket_new(base, -1, BEV_OPT_CLOSE_ON_FREE);
         }
@@ -278,7 +302,7 @@ HMWorkHealthCheckLibEvent::healthCheck()
 
 
         evhttp_connection_set_retries(m_evcon, 1);
-        evhttp_connection_set_timeout(m_evcon, m_timeout.getTimeSinceEpoch() - HMTimeStamp::now().getTimeSinceEpoch());
+        evhttp_connection_set_timeout(m_evcon, (m_timeout.getMillisecondsFromNow() + 999) / 1000);
         if (m_hostCheck.getSourceAddress().isSet())
         {
             evhttp_connection_set_local_address(m_evcon, m_hostCheck.getSourceAddress().toString().c_str());
@@ -318,8 +342,8 @@ HMWorkHealthCheckLibEvent::healthCheck()
         evhttp_add_header(m_headers, "Connection", "close");
         evhttp_add_header(m_headers, "User-Agent", "YahooFOR/1.0");
 
-        m_end.setTime(0);
-        m_start = HMTimeStamp::now();
+        m_end = HMMonotonicTime();
+        m_start = HMMonotonicTime::now();
         if(evhttp_make_request(m_evcon, m_req, EVHTTP_REQ_GET, uri.c_str()) != 0)
         {
 
@@ -358,9 +382,9 @@ HMWorkHealthCheckLibEvent::requestDone(struct evhttp_request *req, void* arg)
 {
 
     HMWorkHealthCheckLibEvent* work = (HMWorkHealthCheckLibEvent*) arg;
-    if(work->m_end.getTimeSinceEpoch() == 0)
+    if(!work->m_end.isSet())
     {
-        work->m_end = HMTimeStamp::now();
+        work->m_end = HMMonotonicTime::now();
     }
 
     // If the request is null than libevent did something stupid
@@ -384,7 +408,7 @@ HMWorkHealthCheckLibEvent::requestDone(struct evhttp_request *req, void* arg)
             work->rcvdBuffer.clear();
             while ((nread = evbuffer_remove(evhttp_request_get_input_buffer(req), buffer, sizeof(buffer))) > 0)
             {
-                work->rcvdBuffer = work->rcvdBuffer + std::string(buffer, nread);
+                work->rcvdBuffer.append(buffer, nread);
             }
         }
         else
@@ -459,7 +483,7 @@ HMWorkHealthCheckLibEvent::connectCallback(struct bufferevent* bev, short events
     HMWorkHealthCheckLibEvent* work = (HMWorkHealthCheckLibEvent*)arg;
     if(events & BEV_EVENT_CONNECTED)
     {
-        work->m_end = HMTimeStamp::now();
+        work->m_end = HMMonotonicTime::now();
     }
 }
 
@@ -6,8 +6,79 @@
 
 using namespace std;
 
+bool
+HMKafkaProducerRd::init(const string& brokers, const HMKafkaPipelineConfig& config)
+{
+    unique_ptr<RdKafka::Conf> conf(RdKafka::Conf::create(RdKafka::Conf::CONF_GLOBAL));
+    string errstr;
+    if(conf->set("metadata.broker.list", brokers, errstr) != RdKafka::Conf::CONF_OK)
+    {
+        HMLog(HM_LOG_CRITICAL, "Failed to add brokers to the configuration: %s",
+                errstr.c_str());
+    }
+
+    if(conf->set("linger.ms", to_string(config.m_linger), errstr) != RdKafka::Conf::CONF_OK
+            || conf->set("batch.num.messages", to_string(config.m_batchSize), errstr) != RdKafka::Conf::CONF_OK
+            || conf->set("queue.buffering.max.messages", to_string(config.m_queueSize), errstr) != RdKafka::Conf::CONF_OK)
+    {
+        HMLog(HM_LOG_ERROR, "Failed to set the producer batching: %s", errstr.c_str());
+    }
+
+    if (conf->set("dr_cb", static_cast<RdKafka::DeliveryReportCb*>(this), errstr) != RdKafka::Conf::CONF_OK)
+    {
+        HMLog(HM_LOG_CRITICAL,
+                "Failed to register callbacks to the configuration: %s",
+                errstr.c_str());
+    }
+
+    RdKafka::Producer *producer = RdKafka::Producer::create(conf.get(), errstr);
+    if (!producer)
+    {
+        HMLog(HM_LOG_CRITICAL, "Failed to create producer: %s", errstr.c_str());
+        return false;
+    }
+    m_producer.reset(producer);
+    return true;
+}
+
+HM_PUBLISH_PRODUCE_STATUS
+HMKafkaProducerRd::produce(char* data, size_t datalen, void* opaque)
+{
+    // No copy and no free flags, the pipeline owns the buffer until the delivery report
+    RdKafka::ErrorCode err = m_producer->produce(m_topic, RdKafka::Topic::PARTITION_UA,
+            0, data, datalen, NULL, 0, 0, opaque);
+    if(err == RdKafka::ERR_NO_ERROR)
+    {
+        return HM_PUBLISH_PRODUCE_OK;
+    }
+    if(err == RdKafka::ERR__QUEUE_FULL)
+    {
+        return HM_PUBLISH_PRODUCE_QUEUE_FULL;
+    }
+    HMLog(HM_LOG_ERROR, "Failed to produce to topic %s : %s", m_topic.c_str(), RdKafka::err2str(err).c_str());
+    return HM_PUBLISH_PRODUCE_FAILED;
+}
+
+void
+HMKafkaProducerRd::poll(uint32_t timeout)
+{
+    m_producer->poll(timeout);
+}
+
+bool
+HMKafkaProducerRd::flush(uint32_t timeout)
+{
+    return m_producer->flush(timeout) == RdKafka::ERR_NO_ERROR;
+}
 
-void DeliveryReportCb::dr_cb(RdKafka::Message &message)
+void
+HMKafkaProducerRd::purge()
+{
+    m_producer->purge(RdKafka::Producer::PURGE_QUEUE | RdKafka::Producer::PURGE_INFLIGHT);
+}
+
+void
+HMKafkaProducerRd::dr_cb(RdKafka::Message &message)
 {
     /* If message.err() is non-zero the message delivery failed permanently
      * for the message. */
@@ -17,37 +88,32 @@ void DeliveryReportCb::dr_cb(RdKafka::Message &message)
     }
     else
     {
-        HMLog(HM_LOG_DEBUG,"Message delivered to topic %s: partition:%d: Offset:%ll", message.topic_name().c_str(),message.partition(), message.offset());
+        HMLog(HM_LOG_DEBUG3, "Message delivered to topic %s: partition:%d: Offset:%ld", message.topic_name().c_str(), message.partition(), message.offset());
     }
+    delivered(message.msg_opaque(), message.err() == RdKafka::ERR_NO_ERROR);
 }
 
 HMPublisherKafka::HMPublisherKafka(HMKafkaConfig& config, string topic) : m_topic(topic), m_config(config)
 {
-    unique_ptr<RdKafka::Conf> confptr;
-    RdKafka::Conf *conf = RdKafka::Conf::create(RdKafka::Conf::CONF_GLOBAL);
-    confptr.reset(conf);
-    string errstr;
-    if(confptr->set("metadata.broker.list", m_config.brokers, errstr) != RdKafka::Conf::CONF_OK)
+    auto producer = make_unique<HMKafkaProducerRd>(m_topic);
+    if(!producer->init(m_config.brokers, m_config.pipeline))
     {
-        HMLog(HM_LOG_CRITICAL, "Failed to add brokers to the configuration: %s",
-                errstr.c_str());
+        return;
     }
 
-    if (conf->set("dr_cb", &m_dr_cb, errstr) != RdKafka::Conf::CONF_OK)
+    m_pipeline = make_unique<HMKafkaPipeline>(move(producer), m_config.pipeline);
+    if(!m_pipeline->start())
     {
-        HMLog(HM_LOG_CRITICAL,
-                "Failed to register callbacks to the configuration: %s",
-                errstr.c_str());
+        HMLog(HM_LOG_CRITICAL, "Failed to start the publisher thread for topic %s", m_topic.c_str());
+        m_pipeline.reset();
     }
+}
 
-    RdKafka::Producer *producer = RdKafka::Producer::create(conf, errstr);
-    if (!producer)
-    {
-        HMLog(HM_LOG_CRITICAL, "Failed to create producer: %s", errstr.c_str());
-    }
-    else
+HMPublisherKafka::~HMPublisherKafka()
+{
+    if(m_pipeline)
     {
-        m_producer.reset(producer);
+        m_pipeline->shutDown();
     }
 }
 
@@ -61,43 +127,20 @@ const HMKafkaConfig& HMPublisherKafka::getConfig() const
     return m_config;
 }
 
-RdKafka::ErrorCode
-HMPublisherKafka::produce(char* data, const size_t datalen) const
+void HMPublisherKafka::getStats(HMKafkaPipelineStats& stats) const
 {
-    if(!m_producer)
+    if(m_pipeline)
     {
-        HMLog(HM_LOG_CRITICAL, "Invalid producer");
-        return RdKafka::ErrorCode::ERR_INVALID_REQUEST;
+        m_pipeline->getStats(stats);
     }
-    return m_producer->produce(m_topic, RdKafka::Topic::PARTITION_UA,
-            RdKafka::Producer::RK_MSG_COPY, data, datalen,
-            NULL, 0, 0, NULL);
 }
 
-void HMPublisherKafka::publish(char* data, const size_t datalen) const
+void HMPublisherKafka::publish(unique_ptr<char[]> data, const size_t datalen) const
 {
-    if (!m_producer)
+    if (!m_pipeline)
     {
         HMLog(HM_LOG_CRITICAL, "Invalid producer");
         return;
     }
-    RdKafka::ErrorCode err = produce(data, datalen);
-    if (err != RdKafka::ERR_NO_ERROR)
-    {
-        if (err == RdKafka::ERR__QUEUE_FULL)
-        {
-            m_producer->poll(1000);
-            err = produce(data, datalen);
-        }
-    }
-
-    if(err == RdKafka::ERR_NO_ERROR)
-    {
-        HMLog(HM_LOG_DEBUG, "Enqueued message for data");
-    }
-    else
-    {
-        HMLog(HM_LOG_ERROR, "Failed to produce to topic %s : %s", m_topic.c_str(), RdKafka::err2str(err).c_str());
-    }
-    m_producer->flush(10000);
+    m_pipeline->enqueue(move(data), datalen);
 }
@@ -255,16 +255,13 @@ HMAuxParserRapidXML::parseAuxData(const string& hostname,
 {
     HMLog(HM_LOG_DEBUG3,
             "[CURLCHECK] HMAuxCache::parseXML: url %s from host %s@%s", hostname.c_str(), sourceURL.c_str(), address.toString().c_str());
-    // I hate this copy so much. But for now I will leave it to fix in profiling
-    vector<char> buffer(auxStr.begin(), auxStr.end());
-    buffer.push_back('\0');
-
     xml_node<>* rootNode;
     xml_document<char> doc;
 
     try
     {
-        doc.parse<0>(&buffer[0]);
+        // Parse the fetched body in place, the string is always NUL terminated and is not used after the parse
+        doc.parse<0>(&auxStr[0]);
     }
     catch (parse_error &e)
     {
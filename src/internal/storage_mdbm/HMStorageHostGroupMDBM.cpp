@@ -5,11 +5,14 @@
 #include <cstring>
 #include <climits>
 #include <unistd.h>
+#include <map>
+#include <iterator>
 
 #include "HMStorageHostGroupMDBM.h"
 #include "HMAuxCache.h"
 #include "HMLogBase.h"
 #include "HMStorage.h"
+#include "HMVarint.h"
 
 using namespace std;
 
@@ -166,7 +169,7 @@ MDBMHandle::mdbmRemove()
     }
 
     mdbm_delete(m_handle, m_kv.key);
-    HMLog(HM_LOG_DEBUG3, "[STORE] delete %s in mdbm", m_kv.key);
+    HMLog(HM_LOG_DEBUG3, "[STORE] delete %s in mdbm", m_kv.key.dptr);
 
     return unlock();
 }
@@ -274,6 +277,11 @@ HMStorageHostGroupMDBM::clearBackend()
 
     HMLog(HM_LOG_DEBUG3, "[STORE] YMDBMStore::clearBackend");
 
+    {
+        lock_guard<mutex> lock(m_checkIndexMutex);
+        m_checkIndex.clear();
+    }
+
     unique_ptr<MDBMHandle> handle = m_pool->getHandle();
     if(!handle)
     {
@@ -614,61 +622,281 @@ HMStorageHostGroupMDBM::storeHostGroupCheckResults(const string& hostGroupName)
         return false;
     }
 
+    lock_guard<mutex> indexLock(m_checkIndexMutex);
+    auto indexIt = loadCheckIndex(hostGroupName);
+    CheckIndex& index = indexIt->second;
+
+    // Only the results with a new revision since the last store are serialized
+    map<pair<string, HMIPAddress>, CheckRecord> changed;
+    vector<pair<string, HMIPAddress>> removed;
+    {
+        shared_lock<shared_timed_mutex> lock(m_checkUpdateMutex);
+        auto group = m_hostGroupResults.find(hostGroupName);
+        if(group != m_hostGroupResults.end())
+        {
+            for(auto it = group->second.begin(); it != group->second.end(); ++it)
+            {
+                if(it->m_hostName.size() == 0)
+                {
+                    HMLog(HM_LOG_ERROR, "[STORE] Hostname size is zero for hostgroup %s", hostGroupName.c_str());
+                    return false;
+                }
+                pair<string, HMIPAddress> key = make_pair(it->m_hostName, it->m_address);
+                auto entry = index.m_entries.find(key);
+                if(entry != index.m_entries.end() && entry->second.m_revision == it->m_revision)
+                {
+                    continue;
+                }
+                CheckRecord& record = changed[key];
+                record.m_revision = it->m_revision;
+                record.m_data.resize(sizeof(uint64_t) + it->m_result.serialize(nullptr, 0));
+                it->m_result.serialize(&record.m_data.at(sizeof(uint64_t)), record.m_data.size() - sizeof(uint64_t));
+            }
+        }
+        for(auto it = index.m_entries.begin(); it != index.m_entries.end(); ++it)
+        {
+            if(group == m_hostGroupResults.end() || group->second.find(it->first.first, it->first.second) == nullptr)
+            {
+                removed.push_back(it->first);
+            }
+        }
+    }
+
+    return storeCheckEntries(indexIt, changed, removed);
+}
+
+map<string, HMStorageHostGroupMDBM::CheckIndex>::iterator
+HMStorageHostGroupMDBM::loadCheckIndex(const string& hostGroupName)
+{
+    auto indexIt = m_checkIndex.find(hostGroupName);
+    if(indexIt == m_checkIndex.end())
+    {
+        // Pick up the generation and records left by a previous run, the records are rewritten on this first store
+        CheckIndex index;
+        readCheckIndex(hostGroupName, index);
+        indexIt = m_checkIndex.insert(make_pair(hostGroupName, move(index))).first;
+    }
+    return indexIt;
+}
+
+bool
+HMStorageHostGroupMDBM::storeCheckEntries(map<string, CheckIndex>::iterator indexIt,
+        map<pair<string, HMIPAddress>, CheckRecord>& changed, const vector<pair<string, HMIPAddress>>& removed)
+{
     // Internal data format:
-    // | total size (bytes) | number of records (count) |
-    //(| size of hostname (bytes) | hostname | IPAddress | results |) --repeated count times
-    uint32_t size = 2 * sizeof(uint32_t);
-    uint32_t count = 0;
+    // Index: | compact marker | version | generation | number of hosts (count) |
+    //       (| size of hostname (bytes) | hostname | number of addresses (count) |
+    //       (| IPAddress | record generation |) --repeated for each address) --repeated for each host
+    // Record: | record generation | results |
+    // The index numbers are varints and the addresses are compact, see HMVarint.
+    // Older versions wrote the index as:
+    // Index: | total size (bytes) | generation | number of records (count) |
+    //       (| size of hostname (bytes) | hostname | IPAddress | record generation |) --repeated count times
+    const string& hostGroupName = indexIt->first;
+    CheckIndex& index = indexIt->second;
+    uint64_t generation = index.m_generation + 1;
+
+    // Write the changed records before the index so the index never refers to a record that is not there yet
+    uint32_t written = 0;
+    for(auto it = changed.begin(); it != changed.end(); ++it)
+    {
+        *(uint64_t*)&it->second.m_data.at(0) = generation;
+        if(!storeRecord(checkEntryKey(hostGroupName, it->first.first, it->first.second), it->second.m_data))
+        {
+            HMLog(HM_LOG_ERROR, "[STORE] Failed to store check record for %s in hostgroup %s", it->first.first.c_str(), hostGroupName.c_str());
+            // Force the index to be reread on the next store
+            m_checkIndex.erase(indexIt);
+            return false;
+        }
+        CheckIndexEntry& indexEntry = index.m_entries[it->first];
+        indexEntry.m_generation = generation;
+        indexEntry.m_revision = it->second.m_revision;
+        written++;
+    }
 
-    shared_lock<shared_timed_mutex> lock(m_checkUpdateMutex);
-    auto range = m_hostGroupResults.equal_range(hostGroupName);
-    for(auto it = range.first; it != range.second; ++it)
+    if(written == 0 && removed.empty())
     {
-        count++;
-        size += (sizeof(uint32_t) + it->second.m_hostName.size() + sizeof(HMIPAddress) + it->second.m_result.serialize(nullptr, 0));
+        HMLog(HM_LOG_DEBUG3, "[STORE] Hostgroup %s unchanged", hostGroupName.c_str());
+        return true;
+    }
+
+    for(auto it = removed.begin(); it != removed.end(); ++it)
+    {
+        index.m_entries.erase(*it);
+    }
+    index.m_generation = generation;
+
+    // The entries are sorted by hostname, so the addresses of a host are next to each other
+    uint64_t hosts = 0;
+    uint32_t size = sizeof(uint32_t) + sizeof(uint8_t) + 2 * HMVarint::MAX_SIZE;
+    for(auto it = index.m_entries.begin(); it != index.m_entries.end(); ++it)
+    {
+        if(it == index.m_entries.begin() || prev(it)->first.first != it->first.first)
+        {
+            hosts++;
+            size += 2 * HMVarint::MAX_SIZE + it->first.first.size();
+        }
+        size += HMVarint::MAX_ADDRESS_SIZE + HMVarint::MAX_SIZE;
     }
     string data;
     data.resize(size);
 
     char* target = &data.at(0);
-    char* end = target + size;
-
-    *(uint32_t*)target = size;
-    *(uint32_t*)(target + sizeof(uint32_t)) = count;
-    target += (2 * sizeof(uint32_t));
+    *(uint32_t*)target = HM_MDBM_CHECK_INDEX_COMPACT;
+    target += sizeof(uint32_t);
+    *(uint8_t*)target = HM_MDBM_CHECK_INDEX_VERSION;
+    target += sizeof(uint8_t);
+    target += HMVarint::put(target, index.m_generation);
+    target += HMVarint::put(target, hosts);
 
-    for(auto it = range.first; it != range.second; ++it)
+    for(auto it = index.m_entries.begin(); it != index.m_entries.end();)
     {
-        if(it->second.m_hostName.size() == 0)
+        const string& hostName = it->first.first;
+        auto hostEnd = it;
+        uint64_t addresses = 0;
+        while(hostEnd != index.m_entries.end() && hostEnd->first.first == hostName)
         {
-            HMLog(HM_LOG_ERROR, "[STORE] Hostname size is zero for hostgroup %s", hostGroupName.c_str());
-            return false;
+            ++hostEnd;
+            addresses++;
+        }
+        target += HMVarint::put(target, hostName.size());
+        memcpy(target, hostName.data(), hostName.size());
+        target += hostName.size();
+        target += HMVarint::put(target, addresses);
+        for(; it != hostEnd; ++it)
+        {
+            target += HMVarint::putAddress(target, it->first.second);
+            target += HMVarint::put(target, it->second.m_generation);
         }
-        *(uint32_t*)target = (uint32_t)it->second.m_hostName.size();
-        strncpy(target + sizeof(uint32_t), it->second.m_hostName.c_str(), it->second.m_hostName.size());
-        memcpy(target + sizeof(uint32_t) + it->second.m_hostName.size(), &it->second.m_address, sizeof(HMIPAddress));
-        target += (sizeof(uint32_t) + it->second.m_hostName.size() + sizeof(HMIPAddress));
-        target += it->second.m_result.serialize(target, end - target);
     }
+    data.resize(target - &data.at(0));
 
-    unique_ptr<MDBMHandle> handle = m_pool->getHandle();
-    if(!handle)
+    if(!storeRecord(HM_MDBM_CHECK_INDEX_PREFIX + hostGroupName, data))
     {
-        //LCOV_EXCL_LINE; can't be tested
+        HMLog(HM_LOG_ERROR, "[STORE] Failed to store check index for hostgroup %s", hostGroupName.c_str());
+        m_checkIndex.erase(indexIt);
         return false;
-        //LCOV_EXCL_LINE; can't be tested
     }
 
-    string hostGroupNameCopy = HM_MDBM_CHECK_PREFIX + hostGroupName;
+    // Only drop the records once the index no longer refers to them
+    for(auto it = removed.begin(); it != removed.end(); ++it)
+    {
+        removeRecord(checkEntryKey(hostGroupName, it->first, it->second));
+    }
 
-    handle->m_kv.key.dptr = &hostGroupNameCopy.at(0);
-    handle->m_kv.key.dsize = hostGroupNameCopy.length();
-    handle->m_kv.val.dptr = &data.at(0);
-    handle->m_kv.val.dsize = size;
+    HMLog(HM_LOG_DEBUG3, "[STORE] Store hostgroup %s generation %lu: %u records written %lu removed in mdbm",
+            hostGroupName.c_str(), generation, written, removed.size());
 
-    HMLog(HM_LOG_DEBUG3, "[STORE] Store hostgroup %s in mdbm", hostGroupNameCopy.c_str());
+    return true;
+}
 
-    return handle->mdbmStore();
+bool
+HMStorageHostGroupMDBM::readCheckIndex(const string& hostGroupName, CheckIndex& index)
+{
+    string data;
+    if(!fetchRecord(HM_MDBM_CHECK_INDEX_PREFIX + hostGroupName, data))
+    {
+        return false;
+    }
+
+    if(data.size() >= sizeof(uint32_t) && *(uint32_t*)&data.at(0) == HM_MDBM_CHECK_INDEX_COMPACT)
+    {
+        return readCompactCheckIndex(hostGroupName, data, index);
+    }
+
+    uint32_t headerSize = sizeof(uint32_t) + sizeof(uint64_t) + sizeof(uint32_t);
+    if(data.size() < headerSize || *(uint32_t*)&data.at(0) != data.size())
+    {
+        HMLog(HM_LOG_INFO, "[STORE] readCheckIndex: Returned index incorrect size: %s", hostGroupName.c_str());
+        return false;
+    }
+
+    char* src = &data.at(0) + sizeof(uint32_t);
+    char* end = &data.at(0) + data.size();
+
+    index.m_generation = *(uint64_t*)src;
+    src += sizeof(uint64_t);
+    uint32_t entries = *(uint32_t*)src;
+    src += sizeof(uint32_t);
+
+    index.m_entries.clear();
+    for(uint32_t i = 0; i < entries; i++)
+    {
+        if(src + sizeof(uint32_t) > end)
+        {
+            HMLog(HM_LOG_INFO, "[STORE] readCheckIndex: Parse error incorrect record size: %s", hostGroupName.c_str());
+            return false;
+        }
+        uint32_t stringsize = *(uint32_t*)src;
+        if(src + sizeof(uint32_t) + stringsize + sizeof(HMIPAddress) + sizeof(uint64_t) > end)
+        {
+            HMLog(HM_LOG_INFO, "[STORE] readCheckIndex: Parse error incorrect record size: %s", hostGroupName.c_str());
+            return false;
+        }
+
+        string hostName(src + sizeof(uint32_t), stringsize);
+        src += (sizeof(uint32_t) + stringsize);
+
+        HMIPAddress address;
+        memcpy(&address, src, sizeof(HMIPAddress));
+        src += sizeof(HMIPAddress);
+
+        index.m_entries[make_pair(hostName, address)].m_generation = *(uint64_t*)src;
+        src += sizeof(uint64_t);
+    }
+
+    return true;
+}
+
+bool
+HMStorageHostGroupMDBM::readCompactCheckIndex(const string& hostGroupName, const string& data, CheckIndex& index)
+{
+    const char* src = data.data() + sizeof(uint32_t);
+    const char* end = data.data() + data.size();
+    uint64_t hosts;
+    if(src >= end || *(uint8_t*)src != HM_MDBM_CHECK_INDEX_VERSION)
+    {
+        HMLog(HM_LOG_INFO, "[STORE] readCheckIndex: Unknown index version: %s", hostGroupName.c_str());
+        return false;
+    }
+    src += sizeof(uint8_t);
+    if(!HMVarint::get(src, end, index.m_generation) || !HMVarint::get(src, end, hosts))
+    {
+        HMLog(HM_LOG_INFO, "[STORE] readCheckIndex: Returned index incorrect size: %s", hostGroupName.c_str());
+        return false;
+    }
+
+    index.m_entries.clear();
+    for(uint64_t i = 0; i < hosts; i++)
+    {
+        uint64_t stringsize;
+        uint64_t addresses;
+        if(!HMVarint::get(src, end, stringsize) || stringsize > (uint64_t)(end - src))
+        {
+            HMLog(HM_LOG_INFO, "[STORE] readCheckIndex: Parse error incorrect record size: %s", hostGroupName.c_str());
+            return false;
+        }
+        string hostName(src, stringsize);
+        src += stringsize;
+        if(!HMVarint::get(src, end, addresses))
+        {
+            HMLog(HM_LOG_INFO, "[STORE] readCheckIndex: Parse error incorrect record size: %s", hostGroupName.c_str());
+            return false;
+        }
+        for(uint64_t j = 0; j < addresses; j++)
+        {
+            HMIPAddress address;
+            uint64_t generation;
+            if(!HMVarint::getAddress(src, end, address) || !HMVarint::get(src, end, generation))
+            {
+                HMLog(HM_LOG_INFO, "[STORE] readCheckIndex: Parse error incorrect record size: %s", hostGroupName.c_str());
+                return false;
+            }
+            index.m_entries[make_pair(hostName, address)].m_generation = generation;
+        }
+    }
+
+    return true;
 }
 
 bool
@@ -688,11 +916,7 @@ HMStorageHostGroupMDBM::getHostGroupCheckResults(const string& hostGroupName)
     }
 
     lock_guard<shared_timed_mutex> lock(m_checkUpdateMutex);
-    m_hostGroupResults.erase(hostGroupName);
-    for(auto it = results.begin(); it != results.end(); ++it)
-    {
-        m_hostGroupResults.insert(make_pair(hostGroupName, *it));
-    }
+    m_hostGroupResults[hostGroupName].assign(results);
     return true;
 }
 
@@ -705,6 +929,55 @@ HMStorageHostGroupMDBM::getHostGroupCheckResults(const string& hostGroupName, ve
         return false;
     }
 
+    for(uint32_t attempt = 0; attempt < HM_MDBM_CHECK_READ_RETRIES; attempt++)
+    {
+        CheckIndex index;
+        if(!readCheckIndex(hostGroupName, index))
+        {
+            // The database may still hold the group in the single record layout
+            return getLegacyHostGroupCheckResults(hostGroupName, results);
+        }
+
+        results.clear();
+        results.resize(index.m_entries.size());
+
+        bool consistent = true;
+        uint32_t i = 0;
+        for(auto it = index.m_entries.begin(); it != index.m_entries.end(); ++it, i++)
+        {
+            string data;
+            // A record missing or at another generation was updated after the index was read
+            if(!fetchRecord(checkEntryKey(hostGroupName, it->first.first, it->first.second), data)
+                    || data.size() < sizeof(uint64_t)
+                    || *(uint64_t*)&data.at(0) != it->second.m_generation)
+            {
+                consistent = false;
+                break;
+            }
+
+            results[i].m_hostName = it->first.first;
+            results[i].m_address = it->first.second;
+            if(!results[i].m_result.deserialize(&data[0] + sizeof(uint64_t), data.size() - sizeof(uint64_t)))
+            {
+                HMLog(HM_LOG_INFO, "[STORE] getHostGroupCheckResults: Parse error incorrect hostname results size: %s", hostGroupName.c_str());
+                return false;
+            }
+        }
+
+        if(consistent)
+        {
+            return true;
+        }
+    }
+
+    HMLog(HM_LOG_INFO, "[STORE] getHostGroupCheckResults: Hostgroup %s kept changing while being read", hostGroupName.c_str());
+    results.clear();
+    return false;
+}
+
+bool
+HMStorageHostGroupMDBM::getLegacyHostGroupCheckResults(const string& hostGroupName, vector<HMGroupCheckResult>& results)
+{
     unique_ptr<MDBMHandle> handle = m_pool->getHandle();
     if(!handle)
     {
@@ -752,19 +1025,19 @@ HMStorageHostGroupMDBM::getHostGroupCheckResults(const string& hostGroupName, ve
             return false;
         }
 
-        results[i].m_hostName.resize(*src);
-        strncpy(&results[i].m_hostName.at(0), src + sizeof(uint32_t), stringsize);
+        results[i].m_hostName.assign(src + sizeof(uint32_t), stringsize);
         src += (sizeof(uint32_t) + stringsize);
 
         memcpy(&results[i].m_address, src,sizeof(HMIPAddress));
         src += sizeof(HMIPAddress);
 
-        if(!results[i].m_result.deserialize(src, end - src))
+        uint32_t used;
+        if(!results[i].m_result.deserialize(src, end - src, used))
         {
             HMLog(HM_LOG_INFO, "[STORE] getHostGroupCheckResults: Parse error incorrect hostname results size: %s", hostGroupName.c_str());
             return false;
         }
-        src += results[i].m_result.serialize(nullptr, 0);
+        src += used;
     }
 
     return true;
@@ -787,6 +1060,33 @@ HMStorageHostGroupMDBM::removeHostGroupCheckResults(const string& hostGroupName)
         return false;
     }
 
+    lock_guard<mutex> lock(m_checkIndexMutex);
+    CheckIndex index;
+    auto indexIt = m_checkIndex.find(hostGroupName);
+    if(indexIt != m_checkIndex.end())
+    {
+        index = move(indexIt->second);
+        m_checkIndex.erase(indexIt);
+    }
+    else
+    {
+        readCheckIndex(hostGroupName, index);
+    }
+
+    // Remove the index first so readers never see an index without its records
+    bool ret = removeRecord(HM_MDBM_CHECK_INDEX_PREFIX + hostGroupName);
+    for(auto it = index.m_entries.begin(); it != index.m_entries.end(); ++it)
+    {
+        ret = removeRecord(checkEntryKey(hostGroupName, it->first.first, it->first.second)) && ret;
+    }
+    removeRecord(HM_MDBM_CHECK_PREFIX + hostGroupName);
+
+    return ret;
+}
+
+bool
+HMStorageHostGroupMDBM::fetchRecord(const string& key, string& data)
+{
     unique_ptr<MDBMHandle> handle = m_pool->getHandle();
     if(!handle)
     {
@@ -795,14 +1095,133 @@ HMStorageHostGroupMDBM::removeHostGroupCheckResults(const string& hostGroupName)
         //LCOV_EXCL_LINE; can't be tested
     }
 
-    string hostGroupNameCopy = HM_MDBM_CHECK_PREFIX + hostGroupName;
+    string keyCopy = key;
+    handle->m_kv.key.dptr = &keyCopy.at(0);
+    handle->m_kv.key.dsize = keyCopy.length();
 
-    handle->m_kv.key.dptr = &hostGroupNameCopy.at(0);
-    handle->m_kv.key.dsize = hostGroupNameCopy.length();
+    if(!handle->mdbmFetch())
+    {
+        return false;
+    }
+
+    // Copy the data out so the lock is released with the handle
+    data.assign(handle->m_kv.val.dptr, handle->m_kv.val.dsize);
+    return true;
+}
+
+bool
+HMStorageHostGroupMDBM::storeRecord(const string& key, string& data)
+{
+    unique_ptr<MDBMHandle> handle = m_pool->getHandle();
+    if(!handle)
+    {
+        //LCOV_EXCL_LINE; can't be tested
+        return false;
+        //LCOV_EXCL_LINE; can't be tested
+    }
+
+    string keyCopy = key;
+    handle->m_kv.key.dptr = &keyCopy.at(0);
+    handle->m_kv.key.dsize = keyCopy.length();
+    handle->m_kv.val.dptr = &data.at(0);
+    handle->m_kv.val.dsize = data.length();
+
+    return handle->mdbmStore();
+}
+
+bool
+HMStorageHostGroupMDBM::removeRecord(const string& key)
+{
+    unique_ptr<MDBMHandle> handle = m_pool->getHandle();
+    if(!handle)
+    {
+        //LCOV_EXCL_LINE; can't be tested
+        return false;
+        //LCOV_EXCL_LINE; can't be tested
+    }
+
+    string keyCopy = key;
+    handle->m_kv.key.dptr = &keyCopy.at(0);
+    handle->m_kv.key.dsize = keyCopy.length();
 
     return handle->mdbmRemove();
 }
 
+string
+HMStorageHostGroupMDBM::checkEntryKey(const string& hostGroupName, const string& hostName, const HMIPAddress& address) const
+{
+    // Host names can't hold a '|' so the key is unique for any group name
+    return HM_MDBM_CHECK_ENTRY_PREFIX + hostGroupName + "|" + hostName + "|" + address.toString();
+}
+
+bool
+HMStorageHostGroupMDBM::migrateBackend(uint8_t version)
+{
+    if(version != HM_MDBM_VERSION_GROUP_BLOB && version != HM_MDBM_VERSION_GROUP_INFO)
+    {
+        return false;
+    }
+
+    if(m_readonly)
+    {
+        // Readers fall back to the older layouts until a writer migrates the database
+        return true;
+    }
+
+    set<string> groupNames;
+    getHostGroupNames(groupNames);
+
+    for(auto name = groupNames.begin(); name != groupNames.end(); ++name)
+    {
+        // The host group info is read in either layout and written back in the versioned one
+        HMDataHostGroup hostGroup(*name);
+        if(getGroupInfo(*name, hostGroup) && !storeGroupInfo(*name, hostGroup))
+        {
+            HMLog(HM_LOG_ERROR, "[STORE] Failed to migrate group info for hostgroup %s", name->c_str());
+            return false;
+        }
+
+        if(version != HM_MDBM_VERSION_GROUP_BLOB)
+        {
+            continue;
+        }
+
+        vector<HMGroupCheckResult> results;
+        if(!getLegacyHostGroupCheckResults(*name, results))
+        {
+            continue;
+        }
+
+        lock_guard<mutex> lock(m_checkIndexMutex);
+        auto indexIt = loadCheckIndex(*name);
+        map<pair<string, HMIPAddress>, CheckRecord> entries;
+        for(auto it = results.begin(); it != results.end(); ++it)
+        {
+            CheckRecord& record = entries[make_pair(it->m_hostName, it->m_address)];
+            record.m_data.resize(sizeof(uint64_t) + it->m_result.serialize(nullptr, 0));
+            it->m_result.serialize(&record.m_data.at(sizeof(uint64_t)), record.m_data.size() - sizeof(uint64_t));
+        }
+        vector<pair<string, HMIPAddress>> removed;
+        for(auto it = indexIt->second.m_entries.begin(); it != indexIt->second.m_entries.end(); ++it)
+        {
+            if(entries.find(it->first) == entries.end())
+            {
+                removed.push_back(it->first);
+            }
+        }
+
+        if(!storeCheckEntries(indexIt, entries, removed))
+        {
+            HMLog(HM_LOG_ERROR, "[STORE] Failed to migrate check results for hostgroup %s", name->c_str());
+            return false;
+        }
+        removeRecord(HM_MDBM_CHECK_PREFIX + *name);
+    }
+
+    HMLog(HM_LOG_INFO, "[STORE] Migrated %lu hostgroups from mdbm version %u", groupNames.size(), version);
+    return true;
+}
+
 bool
 HMStorageHostGroupMDBM::storeHostGroupAuxInfo(const string& hostGroupName)
 {
@@ -40,6 +40,8 @@ TESTNAME::setUp()
     check-info: hm-hello\n\
     source-address: 127.0.0.5\n\
     tos-value: 01\n\
+    keepalive: on\n\
+    priority: high\n\
     check-retries:  2\n\
     check-retry-delay:  3\r\n\
     timeout: 2000\n\
@@ -58,6 +60,7 @@ TESTNAME::setUp()
 -   name: config.parse2.netchasm.net\n\
     allow-hosts: any\n\
     check-info: //hm/checkinfo\n\
+    check-expect: status OK\n\
     source-address: ::2\n\
     check-port:  80\n\
     check-type: http\n\
@@ -331,6 +334,9 @@ TESTNAME::test_config1_tests()
     CPPUNIT_ASSERT_EQUAL((int)HM_CHECK_TCP, (int)hi.getCheckType());
     CPPUNIT_ASSERT_EQUAL(123, (int)hi.getCheckPort());
     CPPUNIT_ASSERT_EQUAL(1, (int)hi.getTOSValue());
+    CPPUNIT_ASSERT(hi.getKeepAlive());
+    CPPUNIT_ASSERT_EQUAL((int)HM_WORK_PRIORITY_HIGH, (int)hi.getPriority());
+    CPPUNIT_ASSERT(hi.getCheckExpect().empty());
     CPPUNIT_ASSERT("127.0.0.5" == hi.getSourceAddress().toString());
     CPPUNIT_ASSERT_EQUAL((unsigned int)HM_RT_TOTAL,
             (unsigned int)(hi.getMeasurementOptions() & HM_RT_TOTAL));
@@ -369,6 +375,9 @@ TESTNAME::test_config2_tests()
     CPPUNIT_ASSERT_EQUAL(80, (int)hi.getCheckPort());
     CPPUNIT_ASSERT("::2" == hi.getSourceAddress().toString());
     CPPUNIT_ASSERT_EQUAL(0 , (int)hi.getTOSValue());
+    CPPUNIT_ASSERT(!hi.getKeepAlive());
+    CPPUNIT_ASSERT_EQUAL((int)HM_WORK_PRIORITY_NORMAL, (int)hi.getPriority());
+    CPPUNIT_ASSERT_EQUAL(string("status OK"), hi.getCheckExpect());
     CPPUNIT_ASSERT_EQUAL((unsigned int)HM_RT_CONNECT,
             (unsigned int)(hi.getMeasurementOptions() & HM_RT_CONNECT));
     CPPUNIT_ASSERT_EQUAL(10000, (int)hi.getCheckTimeout());
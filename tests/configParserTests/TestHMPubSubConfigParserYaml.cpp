@@ -48,6 +48,11 @@ TESTNAME::setUp()
         brokerlist:\n\
             - 192.168.1.1:9092\n\
             - 192.168.1.1:9093\n\
+        queuesize: 1024\n\
+        batchsize: 100\n\
+        linger: 20\n\
+        droppolicy: block\n\
+        blocktimeout: 50\n\
         \n";
     fmultiplekafka.close();
 
@@ -86,6 +91,18 @@ TESTNAME::setUp()
             - 192.168.1.1:9092\n\
     \n";
     fnoTopic.close();
+
+    ofstream finvalidSize(invalidSizeKafka);
+    finvalidSize << "-   name: kafka1\n\
+    type: kafka\n\
+    parameters:\n\
+        brokerlist:\n\
+            - 192.168.1.1:9092\n\
+        topic: test\n\
+        queuesize: 0\n\
+        batchsize: -5\n\
+    \n";
+    finvalidSize.close();
     currentState.m_resultPublisher = make_shared<HMResultPublisher>();
     assert(currentState.m_resultPublisher);
 }
@@ -99,6 +116,7 @@ TESTNAME::tearDown()
     remove(invalidType.c_str());
     remove(noBrokerKakfa.c_str());
     remove(noTopicKafka.c_str());
+    remove(invalidSizeKafka.c_str());
 }
 
 void
@@ -138,6 +156,11 @@ TESTNAME::test_config2_tests()
     CPPUNIT_ASSERT(publisher->isPublishOnChange());
     CPPUNIT_ASSERT(publisher->getTopic() == "test1");
     CPPUNIT_ASSERT(publisher->getConfig().brokers == "192.168.1.1:9092,192.168.1.1:9093");
+    CPPUNIT_ASSERT_EQUAL(1024, (int)publisher->getConfig().pipeline.m_queueSize);
+    CPPUNIT_ASSERT_EQUAL(100, (int)publisher->getConfig().pipeline.m_batchSize);
+    CPPUNIT_ASSERT_EQUAL(20, (int)publisher->getConfig().pipeline.m_linger);
+    CPPUNIT_ASSERT_EQUAL(50, (int)publisher->getConfig().pipeline.m_blockTimeout);
+    CPPUNIT_ASSERT(publisher->getConfig().pipeline.m_dropPolicy == HM_PUBLISH_BLOCK);
     CPPUNIT_ASSERT(
             publisher->getHostGroups().find("hg1")
                     != publisher->getHostGroups().end());
@@ -155,4 +178,11 @@ TESTNAME::test_config3_tests()
     CPPUNIT_ASSERT(parser.parseConfig(invalidType, currentState));
     CPPUNIT_ASSERT(parser.parseConfig(noTopicKafka, currentState));
     CPPUNIT_ASSERT(parser.parseConfig(noBrokerKakfa, currentState));
+
+    // Invalid sizes are reported and the defaults kept
+    CPPUNIT_ASSERT_EQUAL((uint32_t)2, parser.parseConfig(invalidSizeKafka, currentState));
+    HMPublisherKafka* publisher = (HMPublisherKafka*)currentState.m_resultPublisher->getpublisher("kafka1");
+    CPPUNIT_ASSERT(publisher);
+    CPPUNIT_ASSERT_EQUAL(HM_DEFAULT_PUBLISH_QUEUE_SIZE, (int)publisher->getConfig().pipeline.m_queueSize);
+    CPPUNIT_ASSERT_EQUAL(HM_DEFAULT_PUBLISH_BATCH_SIZE, (int)publisher->getConfig().pipeline.m_batchSize);
 }
@@ -36,6 +36,7 @@ protected:
     const std::string invalidType = "./invalidtype.yaml";
     const std::string noBrokerKakfa = "./noBrokerKafka.yaml";
     const std::string noTopicKafka = "./noTopic.yaml";
+    const std::string invalidSizeKafka = "./invalidSizeKafka.yaml";
 
     HMState currentState;
 };
@@ -0,0 +1,186 @@
+// Copyright 2019, Oath Inc.
+// Licensed under the terms of the Apache 2.0 license. See LICENSE file in the root of the distribution for licensing details.
+#include "TestHMCheckSchedule.h"
+#include "HMEventLoopQueue.h"
+#include "common.h"
+
+using namespace std;
+
+CPPUNIT_TEST_SUITE_REGISTRATION(TESTNAME);
+
+void TESTNAME::setUp() {
+    setupCommon();
+}
+
+void TESTNAME::tearDown() {
+    HMMonotonicTime::setFakeClock(nullptr);
+    teardownCommon();
+}
+
+void TESTNAME::test_defaults() {
+    HMFakeClock clock;
+    HMMonotonicTime::setFakeClock(&clock);
+    HMCheckSchedule schedule;
+    HMMonotonicTime now = HMMonotonicTime::now();
+
+    // Nothing is spread or delayed until configured
+    CPPUNIT_ASSERT(now == schedule.spread(12345, 30000, true));
+    CPPUNIT_ASSERT(now == schedule.spread(67890, 30000, true));
+    CPPUNIT_ASSERT(now + 5000 == schedule.jitter(now + 5000));
+
+    HMCheckScheduleConfig config;
+    schedule.setConfig(config);
+    CPPUNIT_ASSERT(now == schedule.spread(12345, 30000, false));
+    CPPUNIT_ASSERT(now + 5000 == schedule.jitter(now + 5000));
+}
+
+void TESTNAME::test_spread() {
+    HMFakeClock clock;
+    HMMonotonicTime::setFakeClock(&clock);
+    HMCheckSchedule schedule;
+    HMCheckScheduleConfig config;
+    config.m_spreadWindow = 10000;
+    schedule.setConfig(config);
+    HMMonotonicTime now = HMMonotonicTime::now();
+
+    // The same hash always gets the same phase
+    HMMonotonicTime phase = schedule.spread(42, 30000, false);
+    CPPUNIT_ASSERT(phase == schedule.spread(42, 30000, false));
+    CPPUNIT_ASSERT(phase < now + 10000);
+
+    // The phases are spread evenly over the window
+    vector<uint32_t> buckets(10, 0);
+    for(uint64_t hash = 0; hash < 1000; hash++)
+    {
+        HMMonotonicTime checkTime = schedule.spread(hash, 30000, false);
+        CPPUNIT_ASSERT(checkTime >= now);
+        CPPUNIT_ASSERT(checkTime < now + 10000);
+        buckets[(checkTime - now) / 1000]++;
+    }
+    for(auto count : buckets)
+    {
+        CPPUNIT_ASSERT(count > 50);
+        CPPUNIT_ASSERT(count < 150);
+    }
+
+    // The window never goes past the TTL
+    for(uint64_t hash = 0; hash < 100; hash++)
+    {
+        CPPUNIT_ASSERT(schedule.spread(hash, 2000, false) < now + 2000);
+    }
+}
+
+void TESTNAME::test_ramp_up() {
+    HMFakeClock clock;
+    HMMonotonicTime::setFakeClock(&clock);
+    HMCheckSchedule schedule;
+    HMCheckScheduleConfig config;
+    config.m_rampUpRate = 100;
+    schedule.setConfig(config);
+    HMMonotonicTime now = HMMonotonicTime::now();
+
+    // 100 checks a second, one slot every 10ms
+    CPPUNIT_ASSERT(now == schedule.spread(1, 30000, true));
+    CPPUNIT_ASSERT(now + 10 == schedule.spread(1, 30000, true));
+    CPPUNIT_ASSERT(now + 20 == schedule.spread(1, 30000, true));
+    // Checks not ramped up do not take a slot
+    CPPUNIT_ASSERT(now == schedule.spread(1, 30000, false));
+    CPPUNIT_ASSERT(now + 30 == schedule.spread(1, 30000, true));
+
+    // Once the slots are in the past the ramp up starts from now
+    clock.advance(1000000);
+    now = HMMonotonicTime::now();
+    CPPUNIT_ASSERT(now == schedule.spread(1, 30000, true));
+    CPPUNIT_ASSERT(now + 10 == schedule.spread(1, 30000, true));
+
+    // The phase is added to the slot
+    config.m_spreadWindow = 5000;
+    schedule.setConfig(config);
+    HMMonotonicTime phase = schedule.spread(7, 30000, false);
+    HMMonotonicTime checkTime = schedule.spread(7, 30000, true);
+    CPPUNIT_ASSERT(phase == checkTime);
+    checkTime = schedule.spread(7, 30000, true);
+    CPPUNIT_ASSERT_EQUAL((uint64_t)10000, checkTime.microsecondsSince(phase));
+}
+
+void TESTNAME::test_jitter() {
+    HMFakeClock clock;
+    HMMonotonicTime::setFakeClock(&clock);
+    HMCheckSchedule schedule;
+    HMCheckScheduleConfig config;
+    config.m_jitterPercent = 10;
+    schedule.setConfig(config);
+    HMMonotonicTime now = HMMonotonicTime::now();
+
+    HMMonotonicTime checkTime = now + 10000;
+    bool jittered = false;
+    for(uint32_t i = 0; i < 100; i++)
+    {
+        HMMonotonicTime jitterTime = schedule.jitter(checkTime);
+        CPPUNIT_ASSERT(jitterTime >= checkTime);
+        CPPUNIT_ASSERT(jitterTime <= checkTime + 1000);
+        jittered = jittered || (jitterTime != checkTime);
+    }
+    CPPUNIT_ASSERT(jittered);
+
+    // A time already passed is never delayed
+    CPPUNIT_ASSERT(now - 10 == schedule.jitter(now - 10));
+
+    // The jitter is capped
+    config.m_jitterPercent = 90;
+    schedule.setConfig(config);
+    for(uint32_t i = 0; i < 100; i++)
+    {
+        CPPUNIT_ASSERT(schedule.jitter(checkTime) <= now + 15000);
+    }
+}
+
+void TESTNAME::test_schedule_check() {
+    // Start past the first TTL so the new checks are due
+    HMFakeClock clock(HMMonotonicTime::now().getMicroseconds() + HM_DEFAULT_TTL * 1000);
+    HMMonotonicTime::setFakeClock(&clock);
+    HMEventLoopQueue eventLoop(&m_state);
+    HMDataHostCheck data_host;
+    HMDataCheckParams params;
+    HMDataCheckList check_list;
+    HMWorkQueue queue;
+    HMIPAddress ip;
+    ip.set("192.168.1.1");
+    set<HMIPAddress> ips;
+    ips.insert(ip);
+    string host_group = "HostGroup1";
+    HMDataHostGroup hostGroup(host_group);
+    hostGroup.setCheckType(HM_CHECK_TCP);
+    hostGroup.setCheckPlugin(HM_CHECK_PLUGIN_TCP_RAW);
+    hostGroup.setPort(80);
+    hostGroup.setDualStack(HM_DUALSTACK_BOTH);
+    hostGroup.setCheckInfo("DummyCheckInfo");
+    hostGroup.setRemoteCheck("");
+    hostGroup.setRemoteCheckType(HM_REMOTE_CHECK_NONE);
+    hostGroup.setDistributedFallback(HM_DISTRIBUTED_FALLBACK_NONE);
+    data_host.setCheckParams(hostGroup);
+    for(string host : {"Host1", "Host2", "Host3"})
+    {
+        check_list.insertCheck(host_group, host, data_host, params, ips);
+    }
+
+    // Without a spread window a due check is queued right away
+    check_list.scheduleCheck("Host1", ip, data_host, queue, eventLoop, false);
+    CPPUNIT_ASSERT_EQUAL((uint32_t)1, queue.queueSize());
+    CPPUNIT_ASSERT_EQUAL((uint64_t)0, eventLoop.getTimeOutQueueSize());
+
+    // With a spread window the first check is scheduled in the window
+    HMCheckScheduleConfig config;
+    config.m_spreadWindow = 10000;
+    eventLoop.getCheckSchedule().setConfig(config);
+    check_list.scheduleCheck("Host2", ip, data_host, queue, eventLoop, false);
+    CPPUNIT_ASSERT_EQUAL((uint32_t)1, queue.queueSize());
+    CPPUNIT_ASSERT_EQUAL((uint64_t)1, eventLoop.getTimeOutQueueSize());
+
+    // A reload forces the check and spreads it
+    string host_name = "Host3";
+    check_list.scheduleCheck(host_name, ip, data_host, queue, eventLoop, true);
+    CPPUNIT_ASSERT_EQUAL((uint32_t)1, queue.queueSize());
+    CPPUNIT_ASSERT_EQUAL((uint64_t)2, eventLoop.getTimeOutQueueSize());
+    CPPUNIT_ASSERT(check_list.nextCheckTime(host_name, ip, data_host) <= HMMonotonicTime::now());
+}
@@ -0,0 +1,39 @@
+// Copyright 2019, Oath Inc.
+// Licensed under the terms of the Apache 2.0 license. See LICENSE file in the root of the distribution for licensing details.
+#ifndef TEST_HMCHECKSCHEDULE_H_
+#define TEST_HMCHECKSCHEDULE_H_
+
+#include <cppunit/Test.h>
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include "HMCheckSchedule.h"
+#include "HMStateManager.h"
+
+#define TESTNAME Test_HMCheckSchedule
+
+class TESTNAME : public CppUnit::TestFixture
+{
+
+    CPPUNIT_TEST_SUITE(TESTNAME);
+    CPPUNIT_TEST(test_defaults);
+    CPPUNIT_TEST(test_spread);
+    CPPUNIT_TEST(test_ramp_up);
+    CPPUNIT_TEST(test_jitter);
+    CPPUNIT_TEST(test_schedule_check);
+    CPPUNIT_TEST_SUITE_END();
+
+
+public:
+
+    void setUp();
+    void tearDown();
+    void test_defaults();
+    void test_spread();
+    void test_ramp_up();
+    void test_jitter();
+    void test_schedule_check();
+protected:
+    HMStateManager m_state;
+};
+
+#endif /* TEST_HMCHECKSCHEDULE_H_ */
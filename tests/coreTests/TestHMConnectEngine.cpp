@@ -0,0 +1,408 @@
+// Copyright 2019, Oath Inc.
+// Licensed under the terms of the Apache 2.0 license. See LICENSE file in the root of the distribution for licensing details.
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <string.h>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <openssl/ssl.h>
+#include <openssl/x509.h>
+
+#include "TestHMConnectEngine.h"
+#include "common.h"
+
+using namespace std;
+
+CPPUNIT_TEST_SUITE_REGISTRATION(TESTNAME);
+
+struct ConnectWaiter
+{
+    mutex m_mutex;
+    condition_variable m_cond;
+    bool m_done = false;
+};
+
+static void
+connectDone(HMConnectRequest& request, void* arg)
+{
+    (void)request;
+    ConnectWaiter* waiter = (ConnectWaiter*)arg;
+    lock_guard<mutex> lk(waiter->m_mutex);
+    waiter->m_done = true;
+    waiter->m_cond.notify_all();
+}
+
+static bool
+waitConnect(ConnectWaiter& waiter)
+{
+    unique_lock<mutex> lk(waiter.m_mutex);
+    return waiter.m_cond.wait_for(lk, chrono::seconds(5), [&waiter](){return waiter.m_done;});
+}
+
+// Open a listening socket on a loopback ephemeral port
+static int
+listenLoopback(uint16_t& port)
+{
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;
+    bind(fd, (sockaddr*)&addr, sizeof(addr));
+    listen(fd, 16);
+    socklen_t len = sizeof(addr);
+    getsockname(fd, (sockaddr*)&addr, &len);
+    port = ntohs(addr.sin_port);
+    return fd;
+}
+
+static void
+setupRequest(HMConnectRequest& request, ConnectWaiter& waiter, uint16_t port)
+{
+    request.m_address.set("127.0.0.1");
+    request.m_port = port;
+    request.m_connectTimeout = 2000;
+    request.m_readTimeout = 2000;
+    request.m_callback = connectDone;
+    request.m_arg = &waiter;
+}
+
+// Create a server context with a self signed EC certificate
+static SSL_CTX*
+createServerCtx(int maxVersion)
+{
+    EVP_PKEY* key = NULL;
+    EVP_PKEY_CTX* pctx = EVP_PKEY_CTX_new_id(EVP_PKEY_EC, NULL);
+    EVP_PKEY_keygen_init(pctx);
+    EVP_PKEY_CTX_set_ec_paramgen_curve_nid(pctx, NID_X9_62_prime256v1);
+    EVP_PKEY_keygen(pctx, &key);
+    EVP_PKEY_CTX_free(pctx);
+
+    X509* cert = X509_new();
+    ASN1_INTEGER_set(X509_get_serialNumber(cert), 1);
+    X509_gmtime_adj(X509_get_notBefore(cert), 0);
+    X509_gmtime_adj(X509_get_notAfter(cert), 3600);
+    X509_set_pubkey(cert, key);
+    X509_NAME* name = X509_get_subject_name(cert);
+    X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC, (const unsigned char*)"netchasm-test", -1, -1, 0);
+    X509_set_issuer_name(cert, name);
+    X509_sign(cert, key, EVP_sha256());
+
+    SSL_CTX* ctx = SSL_CTX_new(TLS_server_method());
+    SSL_CTX_use_certificate(ctx, cert);
+    SSL_CTX_use_PrivateKey(ctx, key);
+    SSL_CTX_set_max_proto_version(ctx, maxVersion);
+    X509_free(cert);
+    EVP_PKEY_free(key);
+    return ctx;
+}
+
+// Serve TLS connections on the listening socket, sending the banner once the handshake is done
+static void
+serveTLS(int listenFd, SSL_CTX* ctx, uint32_t nConnections, string banner)
+{
+    for(uint32_t i = 0; i < nConnections; i++)
+    {
+        int fd = accept(listenFd, nullptr, nullptr);
+        if(fd < 0)
+        {
+            return;
+        }
+        SSL* ssl = SSL_new(ctx);
+        SSL_set_fd(ssl, fd);
+        if(SSL_accept(ssl) == 1)
+        {
+            if(!banner.empty())
+            {
+                SSL_write(ssl, banner.c_str(), banner.size());
+            }
+            // Wait for the client to close
+            char buf[64];
+            while(SSL_read(ssl, buf, sizeof(buf)) > 0);
+            SSL_shutdown(ssl);
+        }
+        SSL_free(ssl);
+        close(fd);
+    }
+}
+
+static bool
+waitSessions(HMConnectEngine& engine, uint64_t count)
+{
+    for(int i = 0; i < 200 && engine.getSessionCache().size() < count; i++)
+    {
+        usleep(10000);
+    }
+    return engine.getSessionCache().size() == count;
+}
+
+void TESTNAME::setUp() {
+    setupCommon();
+}
+
+void TESTNAME::tearDown() {
+    teardownCommon();
+}
+
+void TESTNAME::test_connect_success() {
+    uint16_t port = 0;
+    int listenFd = listenLoopback(port);
+    HMConnectEngine engine(2);
+    CPPUNIT_ASSERT(engine.start());
+    CPPUNIT_ASSERT_EQUAL(2, (int)engine.getNThreads());
+
+    ConnectWaiter waiter;
+    HMConnectRequest request;
+    setupRequest(request, waiter, port);
+    CPPUNIT_ASSERT(engine.submit(request));
+    CPPUNIT_ASSERT(waitConnect(waiter));
+    CPPUNIT_ASSERT_EQUAL((int)HM_REASON_SUCCESS, (int)request.m_reason);
+    CPPUNIT_ASSERT(request.m_clientPort > 0);
+    CPPUNIT_ASSERT(request.m_start <= request.m_connectTime);
+    CPPUNIT_ASSERT_EQUAL(0, (int)engine.getInFlight());
+
+    engine.shutDown();
+    close(listenFd);
+}
+
+void TESTNAME::test_connect_refused() {
+    uint16_t port = 0;
+    int listenFd = listenLoopback(port);
+    // Free the port so the connect is refused
+    close(listenFd);
+
+    HMConnectEngine engine(1);
+    CPPUNIT_ASSERT(engine.start());
+
+    ConnectWaiter waiter;
+    HMConnectRequest request;
+    setupRequest(request, waiter, port);
+    CPPUNIT_ASSERT(engine.submit(request));
+    CPPUNIT_ASSERT(waitConnect(waiter));
+    CPPUNIT_ASSERT_EQUAL((int)HM_REASON_CONNECT_FAILURE, (int)request.m_reason);
+    engine.shutDown();
+}
+
+void TESTNAME::test_checkinfo_read() {
+    uint16_t port = 0;
+    int listenFd = listenLoopback(port);
+    HMConnectEngine engine(1);
+    CPPUNIT_ASSERT(engine.start());
+
+    ConnectWaiter waiter;
+    HMConnectRequest request;
+    setupRequest(request, waiter, port);
+    request.m_readSize = 5;
+    CPPUNIT_ASSERT(engine.submit(request));
+
+    int clientFd = accept(listenFd, nullptr, nullptr);
+    CPPUNIT_ASSERT(clientFd >= 0);
+    CPPUNIT_ASSERT_EQUAL(3, (int)write(clientFd, "HEL", 3));
+    usleep(10000);
+    CPPUNIT_ASSERT_EQUAL(3, (int)write(clientFd, "LO\n", 3));
+
+    CPPUNIT_ASSERT(waitConnect(waiter));
+    CPPUNIT_ASSERT_EQUAL((int)HM_REASON_SUCCESS, (int)request.m_reason);
+    CPPUNIT_ASSERT_EQUAL(string("HELLO"), request.m_data);
+
+    engine.shutDown();
+    close(clientFd);
+    close(listenFd);
+}
+
+void TESTNAME::test_checkinfo_timeout() {
+    uint16_t port = 0;
+    int listenFd = listenLoopback(port);
+    HMConnectEngine engine(1);
+    CPPUNIT_ASSERT(engine.start());
+
+    ConnectWaiter waiter;
+    HMConnectRequest request;
+    setupRequest(request, waiter, port);
+    request.m_readSize = 5;
+    request.m_readTimeout = 100;
+    CPPUNIT_ASSERT(engine.submit(request));
+
+    CPPUNIT_ASSERT(waitConnect(waiter));
+    CPPUNIT_ASSERT_EQUAL((int)HM_REASON_RESPONSE_TIMEOUT, (int)request.m_reason);
+    CPPUNIT_ASSERT(request.m_data.empty());
+
+    engine.shutDown();
+    close(listenFd);
+}
+
+void TESTNAME::test_submit_not_running() {
+    HMConnectEngine engine(1);
+    ConnectWaiter waiter;
+    HMConnectRequest request;
+    setupRequest(request, waiter, 1);
+    CPPUNIT_ASSERT(!engine.submit(request));
+    CPPUNIT_ASSERT(!waiter.m_done);
+}
+
+void TESTNAME::test_tls_resume() {
+    uint16_t port = 0;
+    int listenFd = listenLoopback(port);
+    SSL_CTX* serverCtx = createServerCtx(TLS1_2_VERSION);
+    SSL_CTX* clientCtx = SSL_CTX_new(TLS_client_method());
+    thread server(serveTLS, listenFd, serverCtx, 2, "");
+
+    HMConnectEngine engine(1);
+    CPPUNIT_ASSERT(engine.start());
+
+    ConnectWaiter waiter;
+    HMConnectRequest request;
+    setupRequest(request, waiter, port);
+    request.m_sslCtx = clientCtx;
+    CPPUNIT_ASSERT(engine.submit(request));
+    CPPUNIT_ASSERT(waitConnect(waiter));
+    CPPUNIT_ASSERT_EQUAL((int)HM_REASON_SUCCESS, (int)request.m_reason);
+    CPPUNIT_ASSERT(!request.m_sessionReused);
+    CPPUNIT_ASSERT(request.m_start <= request.m_connectTime);
+    CPPUNIT_ASSERT(request.m_connectTime <= request.m_handshakeTime);
+    CPPUNIT_ASSERT(waitSessions(engine, 1));
+
+    // The next check of the target resumes the session
+    ConnectWaiter resumeWaiter;
+    setupRequest(request, resumeWaiter, port);
+    CPPUNIT_ASSERT(engine.submit(request));
+    CPPUNIT_ASSERT(waitConnect(resumeWaiter));
+    CPPUNIT_ASSERT_EQUAL((int)HM_REASON_SUCCESS, (int)request.m_reason);
+    CPPUNIT_ASSERT(request.m_sessionReused);
+    CPPUNIT_ASSERT_EQUAL(1, (int)engine.getSessionCache().size());
+
+    engine.shutDown();
+    server.join();
+    close(listenFd);
+    SSL_CTX_free(clientCtx);
+    SSL_CTX_free(serverCtx);
+}
+
+void TESTNAME::test_tls13_ticket() {
+    uint16_t port = 0;
+    int listenFd = listenLoopback(port);
+    SSL_CTX* serverCtx = createServerCtx(TLS1_3_VERSION);
+    SSL_CTX* clientCtx = SSL_CTX_new(TLS_client_method());
+    thread server(serveTLS, listenFd, serverCtx, 3, "HELLO");
+
+    HMConnectEngine engine(1);
+    CPPUNIT_ASSERT(engine.start());
+
+    // The ticket comes after the handshake, the connection waits for it after the request is handed back
+    ConnectWaiter waiter;
+    HMConnectRequest request;
+    setupRequest(request, waiter, port);
+    request.m_sslCtx = clientCtx;
+    CPPUNIT_ASSERT(engine.submit(request));
+    CPPUNIT_ASSERT(waitConnect(waiter));
+    CPPUNIT_ASSERT_EQUAL((int)HM_REASON_SUCCESS, (int)request.m_reason);
+    CPPUNIT_ASSERT(!request.m_sessionReused);
+    CPPUNIT_ASSERT_EQUAL(0, (int)engine.getInFlight());
+    CPPUNIT_ASSERT(waitSessions(engine, 1));
+
+    ConnectWaiter resumeWaiter;
+    setupRequest(request, resumeWaiter, port);
+    CPPUNIT_ASSERT(engine.submit(request));
+    CPPUNIT_ASSERT(waitConnect(resumeWaiter));
+    CPPUNIT_ASSERT_EQUAL((int)HM_REASON_SUCCESS, (int)request.m_reason);
+    CPPUNIT_ASSERT(request.m_sessionReused);
+
+    // The check info is read over TLS
+    ConnectWaiter readWaiter;
+    setupRequest(request, readWaiter, port);
+    request.m_readSize = 5;
+    CPPUNIT_ASSERT(engine.submit(request));
+    CPPUNIT_ASSERT(waitConnect(readWaiter));
+    CPPUNIT_ASSERT_EQUAL((int)HM_REASON_SUCCESS, (int)request.m_reason);
+    CPPUNIT_ASSERT(request.m_sessionReused);
+    CPPUNIT_ASSERT_EQUAL(string("HELLO"), request.m_data);
+
+    engine.shutDown();
+    server.join();
+    close(listenFd);
+    SSL_CTX_free(clientCtx);
+    SSL_CTX_free(serverCtx);
+}
+
+void TESTNAME::test_tls_handshake_failure() {
+    uint16_t port = 0;
+    int listenFd = listenLoopback(port);
+    SSL_CTX* clientCtx = SSL_CTX_new(TLS_client_method());
+    HMConnectEngine engine(1);
+    CPPUNIT_ASSERT(engine.start());
+
+    // A plain TCP server never answers the handshake
+    ConnectWaiter waiter;
+    HMConnectRequest request;
+    setupRequest(request, waiter, port);
+    request.m_sslCtx = clientCtx;
+    request.m_connectTimeout = 100;
+    CPPUNIT_ASSERT(engine.submit(request));
+    CPPUNIT_ASSERT(waitConnect(waiter));
+    CPPUNIT_ASSERT_EQUAL((int)HM_REASON_CONNECT_TIMEOUT, (int)request.m_reason);
+    CPPUNIT_ASSERT(request.m_connectTime.isSet());
+    CPPUNIT_ASSERT_EQUAL(0, (int)request.m_handshakeTime.getMicroseconds());
+
+    // A server closing the connection fails the handshake
+    ConnectWaiter closeWaiter;
+    setupRequest(request, closeWaiter, port);
+    CPPUNIT_ASSERT(engine.submit(request));
+    int fd = accept(listenFd, nullptr, nullptr);
+    int fd2 = accept(listenFd, nullptr, nullptr);
+    close(fd);
+    close(fd2);
+    CPPUNIT_ASSERT(waitConnect(closeWaiter));
+    CPPUNIT_ASSERT_EQUAL((int)HM_REASON_CONNECT_FAILURE, (int)request.m_reason);
+    CPPUNIT_ASSERT_EQUAL(0, (int)engine.getSessionCache().size());
+
+    engine.shutDown();
+    close(listenFd);
+    SSL_CTX_free(clientCtx);
+}
+
+void TESTNAME::test_session_cache() {
+    SSL_CTX* ctx = SSL_CTX_new(TLS_client_method());
+    SSL_CTX* otherCtx = SSL_CTX_new(TLS_client_method());
+    HMTLSSessionCache cache(2);
+    HMIPAddress address1;
+    HMIPAddress address2;
+    address1.set("10.0.0.1");
+    address2.set("10.0.0.2");
+
+    CPPUNIT_ASSERT(cache.get(address1, 443, ctx) == nullptr);
+    SSL_SESSION* session = SSL_SESSION_new();
+    SSL_SESSION_set_time(session, time(nullptr));
+    SSL_SESSION_set_timeout(session, 300);
+    cache.store(address1, 443, ctx, session);
+
+    SSL_SESSION* cached = cache.get(address1, 443, ctx);
+    CPPUNIT_ASSERT(cached == session);
+    SSL_SESSION_free(cached);
+    // Only offered to the context that negotiated it, and for the same port
+    CPPUNIT_ASSERT(cache.get(address1, 443, otherCtx) == nullptr);
+    CPPUNIT_ASSERT(cache.get(address1, 8443, ctx) == nullptr);
+
+    // Expired sessions are dropped
+    SSL_SESSION* expired = SSL_SESSION_new();
+    SSL_SESSION_set_time(expired, time(nullptr) - 600);
+    SSL_SESSION_set_timeout(expired, 300);
+    cache.store(address2, 443, ctx, expired);
+    CPPUNIT_ASSERT(cache.get(address2, 443, ctx) == nullptr);
+    CPPUNIT_ASSERT_EQUAL(1, (int)cache.size());
+
+    // The cache is bounded
+    cache.store(address2, 443, ctx, SSL_SESSION_new());
+    cache.store(address2, 8443, ctx, SSL_SESSION_new());
+    CPPUNIT_ASSERT_EQUAL(2, (int)cache.size());
+
+    cache.remove(address2, 8443);
+    CPPUNIT_ASSERT(cache.size() <= 1);
+    cache.clear();
+    CPPUNIT_ASSERT_EQUAL(0, (int)cache.size());
+    SSL_CTX_free(ctx);
+    SSL_CTX_free(otherCtx);
+}
@@ -0,0 +1,46 @@
+// Copyright 2019, Oath Inc.
+// Licensed under the terms of the Apache 2.0 license. See LICENSE file in the root of the distribution for licensing details.
+#ifndef TEST_HMCONNECTENGINE_H_
+#define TEST_HMCONNECTENGINE_H_
+
+#include <cppunit/Test.h>
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include "HMConnectEngine.h"
+
+#define TESTNAME Test_HMConnectEngine
+
+class TESTNAME : public CppUnit::TestFixture
+{
+
+    CPPUNIT_TEST_SUITE(TESTNAME);
+    CPPUNIT_TEST(test_connect_success);
+    CPPUNIT_TEST(test_connect_refused);
+    CPPUNIT_TEST(test_checkinfo_read);
+    CPPUNIT_TEST(test_checkinfo_timeout);
+    CPPUNIT_TEST(test_submit_not_running);
+    CPPUNIT_TEST(test_tls_resume);
+    CPPUNIT_TEST(test_tls13_ticket);
+    CPPUNIT_TEST(test_tls_handshake_failure);
+    CPPUNIT_TEST(test_session_cache);
+    CPPUNIT_TEST_SUITE_END();
+
+
+public:
+
+    void setUp();
+    void tearDown();
+    void test_connect_success();
+    void test_connect_refused();
+    void test_checkinfo_read();
+    void test_checkinfo_timeout();
+    void test_submit_not_running();
+    void test_tls_resume();
+    void test_tls13_ticket();
+    void test_tls_handshake_failure();
+    void test_session_cache();
+protected:
+
+};
+
+#endif /* TEST_HMCONNECTENGINE_H_ */
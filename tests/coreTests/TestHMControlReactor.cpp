@@ -0,0 +1,280 @@
+// Copyright 2019, Oath Inc.
+// Licensed under the terms of the Apache 2.0 license. See LICENSE file in the root of the distribution for licensing details.
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <poll.h>
+#include <unistd.h>
+#include <string.h>
+#include <thread>
+#include <vector>
+
+#include "TestHMControlReactor.h"
+#include "HMStateManager.h"
+#include "HMControlBase.h"
+#include "HMDataPacking.h"
+#include "common.h"
+
+using namespace std;
+
+CPPUNIT_TEST_SUITE_REGISTRATION(TESTNAME);
+
+// Listener on a loopback ephemeral port served by the reactor under test.
+class TestControlListener : public HMCommandListenerBase
+{
+public:
+    TestControlListener(HMStateManager& stateManager) :
+        HMCommandListenerBase(stateManager),
+        m_socket(-1),
+        m_port(0)
+    {
+        m_socket = socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        bind(m_socket, (sockaddr*)&addr, sizeof(addr));
+        listen(m_socket, SOMAXCONN);
+        socklen_t len = sizeof(addr);
+        getsockname(m_socket, (sockaddr*)&addr, &len);
+        m_port = ntohs(addr.sin_port);
+    }
+
+    ~TestControlListener()
+    {
+        close(m_socket);
+    }
+
+    void run() {}
+    void listernerShutDown() {}
+
+    uint32_t getConnections() { return m_connections; }
+
+    int m_socket;
+    uint16_t m_port;
+};
+
+static int
+connectClient(uint16_t port)
+{
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(port);
+    if(connect(fd, (sockaddr*)&addr, sizeof(addr)) < 0)
+    {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static bool
+sendFrame(int fd, const string& cmd)
+{
+    uint64_t size = HMDataPacking::hton64(cmd.size());
+    string frame((const char*)&size, sizeof(size));
+    frame += cmd;
+    return send(fd, frame.data(), frame.size(), MSG_NOSIGNAL) == (ssize_t)frame.size();
+}
+
+// Read exactly size bytes, return the number of bytes read before the timeout or EOF.
+static size_t
+readFully(int fd, char* data, size_t size, int timeoutMs = 2000)
+{
+    size_t done = 0;
+    while(done < size)
+    {
+        pollfd pfd = { fd, POLLIN, 0 };
+        if(poll(&pfd, 1, timeoutMs) <= 0)
+        {
+            break;
+        }
+        ssize_t rc = recv(fd, data + done, size - done, 0);
+        if(rc <= 0)
+        {
+            break;
+        }
+        done += rc;
+    }
+    return done;
+}
+
+// Check the reactor closed the connection.
+static bool
+waitClosed(int fd, int timeoutMs)
+{
+    char c;
+    pollfd pfd = { fd, POLLIN, 0 };
+    if(poll(&pfd, 1, timeoutMs) <= 0)
+    {
+        return false;
+    }
+    return recv(fd, &c, 1, 0) <= 0;
+}
+
+static bool
+waitConnections(TestControlListener& listener, uint32_t count, uint32_t seconds = 5)
+{
+    HMTimeStamp expiry = HMTimeStamp::now() + seconds * 1000;
+    while(listener.getConnections() != count && HMTimeStamp::now() < expiry)
+    {
+        this_thread::sleep_for(chrono::milliseconds(10));
+    }
+    return listener.getConnections() == count;
+}
+
+void
+TESTNAME::setUp()
+{
+}
+
+void
+TESTNAME::tearDown()
+{
+}
+
+void
+TESTNAME::test_command_dispatch()
+{
+    HMStateManager stateManager;
+    TestControlListener listener(stateManager);
+    HMControlReactor reactor(stateManager);
+    CPPUNIT_ASSERT(reactor.start());
+    CPPUNIT_ASSERT(reactor.addListener(listener.m_socket, HM_CONTROL_SOCKET_TCP_V4, &listener));
+
+    int fd = connectClient(listener.m_port);
+    CPPUNIT_ASSERT(fd >= 0);
+    // An unknown protocol version is answered with an empty message by the command handlers
+    CPPUNIT_ASSERT(sendFrame(fd, "99 gethandlerthreadscount"));
+    uint64_t size = 1;
+    CPPUNIT_ASSERT_EQUAL(sizeof(size), readFully(fd, (char*)&size, sizeof(size)));
+    CPPUNIT_ASSERT_EQUAL((uint64_t)0, size);
+
+    // A second command on the same connection
+    CPPUNIT_ASSERT(sendFrame(fd, "99 gethandlerthreadscount"));
+    size = 1;
+    CPPUNIT_ASSERT_EQUAL(sizeof(size), readFully(fd, (char*)&size, sizeof(size)));
+    CPPUNIT_ASSERT_EQUAL((uint64_t)0, size);
+    CPPUNIT_ASSERT_EQUAL((uint32_t)1, listener.getConnections());
+
+    CPPUNIT_ASSERT(sendFrame(fd, "quit"));
+    CPPUNIT_ASSERT(waitClosed(fd, 2000));
+    CPPUNIT_ASSERT(waitConnections(listener, 0));
+    close(fd);
+    reactor.shutDown();
+}
+
+void
+TESTNAME::test_burst_connections()
+{
+    const uint32_t nClients = 200;
+    HMStateManager stateManager;
+    TestControlListener listener(stateManager);
+    HMControlReactor reactor(stateManager);
+    CPPUNIT_ASSERT(reactor.start());
+    CPPUNIT_ASSERT(reactor.addListener(listener.m_socket, HM_CONTROL_SOCKET_TCP_V4, &listener));
+
+    vector<int> fds;
+    for(uint32_t i = 0; i < nClients; i++)
+    {
+        int fd = connectClient(listener.m_port);
+        CPPUNIT_ASSERT(fd >= 0);
+        CPPUNIT_ASSERT(sendFrame(fd, HM_CMD_KEEPOPENSTR));
+        CPPUNIT_ASSERT(sendFrame(fd, "99 gethandlerthreadscount"));
+        fds.push_back(fd);
+    }
+    for(int fd : fds)
+    {
+        uint64_t size = 1;
+        CPPUNIT_ASSERT_EQUAL(sizeof(size), readFully(fd, (char*)&size, sizeof(size)));
+        CPPUNIT_ASSERT_EQUAL((uint64_t)0, size);
+    }
+    CPPUNIT_ASSERT_EQUAL(nClients, reactor.getConnections());
+    CPPUNIT_ASSERT_EQUAL(nClients, listener.getConnections());
+
+    for(int fd : fds)
+    {
+        close(fd);
+    }
+    CPPUNIT_ASSERT(waitConnections(listener, 0));
+    CPPUNIT_ASSERT_EQUAL((uint32_t)0, reactor.getConnections());
+    reactor.shutDown();
+}
+
+void
+TESTNAME::test_max_connections()
+{
+    HMStateManager stateManager;
+    TestControlListener listener(stateManager);
+    HMControlReactor reactor(stateManager, 1, 2);
+    CPPUNIT_ASSERT(reactor.start());
+    CPPUNIT_ASSERT(reactor.addListener(listener.m_socket, HM_CONTROL_SOCKET_TCP_V4, &listener));
+
+    int fd1 = connectClient(listener.m_port);
+    int fd2 = connectClient(listener.m_port);
+    CPPUNIT_ASSERT(waitConnections(listener, 2));
+    int fd3 = connectClient(listener.m_port);
+    CPPUNIT_ASSERT(fd3 >= 0);
+    // The connection above the limit is closed as soon as it is accepted
+    CPPUNIT_ASSERT(waitClosed(fd3, 2000));
+    CPPUNIT_ASSERT_EQUAL((uint32_t)2, listener.getConnections());
+
+    close(fd1);
+    close(fd2);
+    close(fd3);
+    reactor.shutDown();
+}
+
+void
+TESTNAME::test_idle_timeout()
+{
+    HMStateManager stateManager;
+    TestControlListener listener(stateManager);
+    HMControlReactor reactor(stateManager);
+    CPPUNIT_ASSERT(reactor.start());
+    CPPUNIT_ASSERT(reactor.addListener(listener.m_socket, HM_CONTROL_SOCKET_TCP_V4, &listener));
+
+    int idle = connectClient(listener.m_port);
+    int persistent = connectClient(listener.m_port);
+    CPPUNIT_ASSERT(sendFrame(persistent, HM_CMD_KEEPOPENSTR));
+    CPPUNIT_ASSERT(waitConnections(listener, 2));
+
+    // Connections that did not ask to be kept open are closed after the idle timeout
+    CPPUNIT_ASSERT(!waitClosed(idle, HM_CONTROL_IDLE_TIMEOUT / 2));
+    CPPUNIT_ASSERT(waitClosed(idle, HM_CONTROL_IDLE_TIMEOUT + 1000));
+    CPPUNIT_ASSERT(waitConnections(listener, 1));
+
+    CPPUNIT_ASSERT(sendFrame(persistent, "99 gethandlerthreadscount"));
+    uint64_t size = 1;
+    CPPUNIT_ASSERT_EQUAL(sizeof(size), readFully(persistent, (char*)&size, sizeof(size)));
+
+    close(idle);
+    close(persistent);
+    reactor.shutDown();
+}
+
+void
+TESTNAME::test_shutdown_open()
+{
+    HMStateManager stateManager;
+    TestControlListener listener(stateManager);
+    HMControlReactor reactor(stateManager);
+    CPPUNIT_ASSERT(reactor.start());
+    CPPUNIT_ASSERT(reactor.addListener(listener.m_socket, HM_CONTROL_SOCKET_TCP_V4, &listener));
+
+    int fd = connectClient(listener.m_port);
+    CPPUNIT_ASSERT(sendFrame(fd, HM_CMD_KEEPOPENSTR));
+    // Send a partial frame so the connection has buffered data at shutdown
+    uint64_t size = HMDataPacking::hton64(100);
+    CPPUNIT_ASSERT(send(fd, &size, sizeof(size), MSG_NOSIGNAL) == sizeof(size));
+    CPPUNIT_ASSERT(waitConnections(listener, 1));
+
+    reactor.shutDown();
+    CPPUNIT_ASSERT(waitClosed(fd, 2000));
+    CPPUNIT_ASSERT_EQUAL((uint32_t)0, listener.getConnections());
+    CPPUNIT_ASSERT(!reactor.addListener(listener.m_socket, HM_CONTROL_SOCKET_TCP_V4, &listener));
+    close(fd);
+}
@@ -0,0 +1,38 @@
+// Copyright 2019, Oath Inc.
+// Licensed under the terms of the Apache 2.0 license. See LICENSE file in the root of the distribution for licensing details.
+#ifndef TEST_HMCONTROLREACTOR_H_
+#define TEST_HMCONTROLREACTOR_H_
+
+#include <cppunit/Test.h>
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include "HMControlReactor.h"
+
+#define TESTNAME Test_HMControlReactor
+
+class TESTNAME : public CppUnit::TestFixture
+{
+
+    CPPUNIT_TEST_SUITE(TESTNAME);
+    CPPUNIT_TEST(test_command_dispatch);
+    CPPUNIT_TEST(test_burst_connections);
+    CPPUNIT_TEST(test_max_connections);
+    CPPUNIT_TEST(test_idle_timeout);
+    CPPUNIT_TEST(test_shutdown_open);
+    CPPUNIT_TEST_SUITE_END();
+
+
+public:
+
+    void setUp();
+    void tearDown();
+    void test_command_dispatch();
+    void test_burst_connections();
+    void test_max_connections();
+    void test_idle_timeout();
+    void test_shutdown_open();
+protected:
+
+};
+
+#endif /* TEST_HMCONTROLREACTOR_H_ */
@@ -0,0 +1,324 @@
+// Copyright 2019, Oath Inc.
+// Licensed under the terms of the Apache 2.0 license. See LICENSE file in the root of the distribution for licensing details.
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <string.h>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <condition_variable>
+
+#include "TestHMCurlEngine.h"
+#include "common.h"
+
+using namespace std;
+
+CPPUNIT_TEST_SUITE_REGISTRATION(TESTNAME);
+
+struct CurlWaiter
+{
+    mutex m_mutex;
+    condition_variable m_cond;
+    bool m_done = false;
+};
+
+static void
+requestDone(HMCurlRequest& request, void* arg)
+{
+    (void)request;
+    CurlWaiter* waiter = (CurlWaiter*)arg;
+    lock_guard<mutex> lk(waiter->m_mutex);
+    waiter->m_done = true;
+    waiter->m_cond.notify_all();
+}
+
+static bool
+waitRequest(CurlWaiter& waiter)
+{
+    unique_lock<mutex> lk(waiter.m_mutex);
+    bool done = waiter.m_cond.wait_for(lk, chrono::seconds(5), [&waiter](){return waiter.m_done;});
+    waiter.m_done = false;
+    return done;
+}
+
+// Minimal HTTP/1.1 server on a loopback ephemeral port serving one connection at a time
+class TestHTTPServer
+{
+public:
+    TestHTTPServer() :
+        m_port(0),
+        m_accepted(0)
+    {
+        m_listenFd = socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port = 0;
+        bind(m_listenFd, (sockaddr*)&addr, sizeof(addr));
+        listen(m_listenFd, 16);
+        socklen_t len = sizeof(addr);
+        getsockname(m_listenFd, (sockaddr*)&addr, &len);
+        m_port = ntohs(addr.sin_port);
+        m_thread = thread(&TestHTTPServer::run, this);
+    }
+
+    ~TestHTTPServer()
+    {
+        shutdown(m_listenFd, SHUT_RDWR);
+        m_thread.join();
+        close(m_listenFd);
+    }
+
+    string url(const string& path)
+    {
+        return "http://127.0.0.1:" + to_string(m_port) + path;
+    }
+
+    uint16_t m_port;
+    atomic<int> m_accepted;
+
+private:
+    void run()
+    {
+        int fd;
+        while((fd = accept(m_listenFd, nullptr, nullptr)) >= 0)
+        {
+            m_accepted++;
+            string buffer;
+            char buf[1024];
+            ssize_t n;
+            while((n = read(fd, buf, sizeof(buf))) > 0)
+            {
+                buffer.append(buf, n);
+                size_t end = buffer.find("\r\n\r\n");
+                if(end == string::npos)
+                {
+                    continue;
+                }
+                string request = buffer.substr(0, end);
+                buffer.erase(0, end + 4);
+                string response = (request.find("GET /status.html ") == 0) ?
+                        "HTTP/1.1 200 OK\r\nContent-Length: 2\r\n\r\nok" :
+                        "HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\n\r\n";
+                if(write(fd, response.c_str(), response.size()) < 0
+                        || request.find("Connection: close") != string::npos)
+                {
+                    break;
+                }
+            }
+            close(fd);
+        }
+    }
+
+    int m_listenFd;
+    thread m_thread;
+};
+
+static void
+setupRequest(HMCurlRequest& request, CurlWaiter& waiter, const string& url)
+{
+    request.m_url = url;
+    request.m_connectTimeout = 2000;
+    request.m_timeout = 2000;
+    request.m_callback = requestDone;
+    request.m_arg = &waiter;
+}
+
+void TESTNAME::setUp() {
+    setupCommon();
+}
+
+void TESTNAME::tearDown() {
+    teardownCommon();
+}
+
+void TESTNAME::test_fetch_success() {
+    TestHTTPServer server;
+    HMCurlEngine engine(2);
+    CPPUNIT_ASSERT(engine.start());
+    CPPUNIT_ASSERT_EQUAL(2, (int)engine.getNThreads());
+
+    CurlWaiter waiter;
+    HMCurlRequest request;
+    setupRequest(request, waiter, server.url("/status.html"));
+    CPPUNIT_ASSERT(engine.submit(request));
+    CPPUNIT_ASSERT(waitRequest(waiter));
+    CPPUNIT_ASSERT_EQUAL((int)CURLE_OK, (int)request.m_result);
+    CPPUNIT_ASSERT_EQUAL(200, (int)request.m_responseCode);
+    CPPUNIT_ASSERT_EQUAL(string("ok"), request.m_body.getBody());
+    CPPUNIT_ASSERT(request.m_start <= request.m_end);
+    CPPUNIT_ASSERT(!request.m_reused);
+    CPPUNIT_ASSERT_EQUAL(0, (int)engine.getInFlight());
+
+    engine.shutDown();
+}
+
+void TESTNAME::test_fetch_not_found() {
+    TestHTTPServer server;
+    HMCurlEngine engine(1);
+    CPPUNIT_ASSERT(engine.start());
+
+    CurlWaiter waiter;
+    HMCurlRequest request;
+    setupRequest(request, waiter, server.url("/missing.html"));
+    CPPUNIT_ASSERT(engine.submit(request));
+    CPPUNIT_ASSERT(waitRequest(waiter));
+    CPPUNIT_ASSERT_EQUAL((int)CURLE_OK, (int)request.m_result);
+    CPPUNIT_ASSERT_EQUAL(404, (int)request.m_responseCode);
+
+    engine.shutDown();
+}
+
+void TESTNAME::test_keepalive_reuse() {
+    TestHTTPServer server;
+    HMCurlEngine engine(2);
+    CPPUNIT_ASSERT(engine.start());
+
+    CurlWaiter waiter;
+    HMCurlRequest request;
+    setupRequest(request, waiter, server.url("/status.html"));
+    request.m_keepAlive = true;
+    for(int i = 0; i < 3; i++)
+    {
+        CPPUNIT_ASSERT(engine.submit(request));
+        CPPUNIT_ASSERT(waitRequest(waiter));
+        CPPUNIT_ASSERT_EQUAL(200, (int)request.m_responseCode);
+        CPPUNIT_ASSERT_EQUAL(i > 0, request.m_reused);
+    }
+    CPPUNIT_ASSERT_EQUAL(1, server.m_accepted.load());
+    CPPUNIT_ASSERT_EQUAL(2, (int)engine.getReused());
+
+    engine.shutDown();
+}
+
+void TESTNAME::test_no_keepalive() {
+    TestHTTPServer server;
+    HMCurlEngine engine(1);
+    CPPUNIT_ASSERT(engine.start());
+
+    CurlWaiter waiter;
+    HMCurlRequest request;
+    setupRequest(request, waiter, server.url("/status.html"));
+    for(int i = 0; i < 2; i++)
+    {
+        CPPUNIT_ASSERT(engine.submit(request));
+        CPPUNIT_ASSERT(waitRequest(waiter));
+        CPPUNIT_ASSERT_EQUAL(200, (int)request.m_responseCode);
+        CPPUNIT_ASSERT(!request.m_reused);
+    }
+    CPPUNIT_ASSERT_EQUAL(2, server.m_accepted.load());
+    CPPUNIT_ASSERT_EQUAL(0, (int)engine.getReused());
+
+    engine.shutDown();
+}
+
+void TESTNAME::test_connect_refused() {
+    uint16_t port;
+    {
+        // Free the port so the connect is refused
+        TestHTTPServer server;
+        port = server.m_port;
+    }
+    HMCurlEngine engine(1);
+    CPPUNIT_ASSERT(engine.start());
+
+    CurlWaiter waiter;
+    HMCurlRequest request;
+    setupRequest(request, waiter, "http://127.0.0.1:" + to_string(port) + "/status.html");
+    CPPUNIT_ASSERT(engine.submit(request));
+    CPPUNIT_ASSERT(waitRequest(waiter));
+    CPPUNIT_ASSERT_EQUAL((int)CURLE_COULDNT_CONNECT, (int)request.m_result);
+    engine.shutDown();
+}
+
+void TESTNAME::test_submit_not_running() {
+    HMCurlEngine engine(1);
+    CurlWaiter waiter;
+    HMCurlRequest request;
+    setupRequest(request, waiter, "http://127.0.0.1:1/status.html");
+    CPPUNIT_ASSERT(!engine.submit(request));
+    CPPUNIT_ASSERT(!waiter.m_done);
+}
+
+void TESTNAME::test_fetch_expect() {
+    TestHTTPServer server;
+    HMCurlEngine engine(1);
+    CPPUNIT_ASSERT(engine.start());
+
+    CurlWaiter waiter;
+    HMCurlRequest request;
+    setupRequest(request, waiter, server.url("/status.html"));
+    request.m_body.setParams(1024, false, "ok");
+    CPPUNIT_ASSERT(engine.submit(request));
+    CPPUNIT_ASSERT(waitRequest(waiter));
+    CPPUNIT_ASSERT_EQUAL((int)CURLE_OK, (int)request.m_result);
+    CPPUNIT_ASSERT_EQUAL(200, (int)request.m_responseCode);
+    CPPUNIT_ASSERT(request.m_body.isMatched());
+    CPPUNIT_ASSERT(request.m_body.getBody().empty());
+
+    request.m_body.setParams(1024, false, "not there");
+    CPPUNIT_ASSERT(engine.submit(request));
+    CPPUNIT_ASSERT(waitRequest(waiter));
+    CPPUNIT_ASSERT_EQUAL((int)CURLE_OK, (int)request.m_result);
+    CPPUNIT_ASSERT_EQUAL(200, (int)request.m_responseCode);
+    CPPUNIT_ASSERT(!request.m_body.isMatched());
+    CPPUNIT_ASSERT_EQUAL(2, (int)request.m_body.getReceived());
+
+    engine.shutDown();
+}
+
+void TESTNAME::test_buffer_match() {
+    HMCurlBuffer buffer;
+    CPPUNIT_ASSERT(buffer.isMatched());
+
+    // The partial match is carried over the chunks
+    buffer.setParams(1024, false, "aab");
+    CPPUNIT_ASSERT(!buffer.isMatched());
+    CPPUNIT_ASSERT(buffer.append("xxa", 3));
+    CPPUNIT_ASSERT(buffer.append("a", 1));
+    CPPUNIT_ASSERT(!buffer.isMatched());
+    CPPUNIT_ASSERT(!buffer.append("aby", 3));
+    CPPUNIT_ASSERT(buffer.isMatched());
+    CPPUNIT_ASSERT(buffer.getBody().empty());
+    CPPUNIT_ASSERT_EQUAL((int)CURLE_OK, (int)buffer.getResult(CURLE_WRITE_ERROR));
+
+    // A kept body is read to the end
+    buffer.setParams(1024, true, "aab");
+    CPPUNIT_ASSERT(buffer.append("aaab", 4));
+    CPPUNIT_ASSERT(buffer.isMatched());
+    CPPUNIT_ASSERT(buffer.append("cd", 2));
+    CPPUNIT_ASSERT_EQUAL(string("aaabcd"), buffer.getBody());
+
+    // Not found within the max size
+    buffer.setParams(8, false, "aab");
+    CPPUNIT_ASSERT(buffer.append("abababab", 8));
+    CPPUNIT_ASSERT(!buffer.append("a", 1));
+    CPPUNIT_ASSERT(!buffer.isMatched());
+    CPPUNIT_ASSERT_EQUAL((int)CURLE_FILESIZE_EXCEEDED, (int)buffer.getResult(CURLE_WRITE_ERROR));
+}
+
+void TESTNAME::test_buffer_max_size() {
+    HMCurlBuffer buffer;
+    buffer.setParams(4, true);
+    CPPUNIT_ASSERT(buffer.append("ab", 2));
+    CPPUNIT_ASSERT(buffer.append("cd", 2));
+    CPPUNIT_ASSERT(!buffer.append("e", 1));
+    CPPUNIT_ASSERT_EQUAL((int)CURLE_FILESIZE_EXCEEDED, (int)buffer.getResult(CURLE_WRITE_ERROR));
+    CPPUNIT_ASSERT_EQUAL((int)CURLE_OK, (int)buffer.getResult(CURLE_OK));
+
+    buffer.clear();
+    CPPUNIT_ASSERT(buffer.append("abcd", 4));
+    string body;
+    buffer.releaseBody(body);
+    CPPUNIT_ASSERT_EQUAL(string("abcd"), body);
+    CPPUNIT_ASSERT(buffer.getBody().empty());
+
+    // A body that is not kept is only counted
+    buffer.setParams(4, false);
+    CPPUNIT_ASSERT(buffer.append("abcdefgh", 8));
+    CPPUNIT_ASSERT_EQUAL(8, (int)buffer.getReceived());
+    CPPUNIT_ASSERT(buffer.getBody().empty());
+}
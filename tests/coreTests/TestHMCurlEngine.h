@@ -0,0 +1,46 @@
+// Copyright 2019, Oath Inc.
+// Licensed under the terms of the Apache 2.0 license. See LICENSE file in the root of the distribution for licensing details.
+#ifndef TEST_HMCURLENGINE_H_
+#define TEST_HMCURLENGINE_H_
+
+#include <cppunit/Test.h>
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include "HMCurlEngine.h"
+
+#define TESTNAME Test_HMCurlEngine
+
+class TESTNAME : public CppUnit::TestFixture
+{
+
+    CPPUNIT_TEST_SUITE(TESTNAME);
+    CPPUNIT_TEST(test_fetch_success);
+    CPPUNIT_TEST(test_fetch_not_found);
+    CPPUNIT_TEST(test_keepalive_reuse);
+    CPPUNIT_TEST(test_no_keepalive);
+    CPPUNIT_TEST(test_connect_refused);
+    CPPUNIT_TEST(test_submit_not_running);
+    CPPUNIT_TEST(test_fetch_expect);
+    CPPUNIT_TEST(test_buffer_match);
+    CPPUNIT_TEST(test_buffer_max_size);
+    CPPUNIT_TEST_SUITE_END();
+
+
+public:
+
+    void setUp();
+    void tearDown();
+    void test_fetch_success();
+    void test_fetch_not_found();
+    void test_keepalive_reuse();
+    void test_no_keepalive();
+    void test_connect_refused();
+    void test_submit_not_running();
+    void test_fetch_expect();
+    void test_buffer_match();
+    void test_buffer_max_size();
+protected:
+
+};
+
+#endif /* TEST_HMCURLENGINE_H_ */
@@ -0,0 +1,329 @@
+// Copyright 2019, Oath Inc.
+// Licensed under the terms of the Apache 2.0 license. See LICENSE file in the root of the distribution for licensing details.
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <poll.h>
+#include <unistd.h>
+#include <string.h>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <condition_variable>
+
+#include "TestHMDNSResolver.h"
+#include "common.h"
+
+using namespace std;
+
+CPPUNIT_TEST_SUITE_REGISTRATION(TESTNAME);
+
+//! The address the stub server answers for every name starting with host.
+#define TEST_RESOLVED_ADDRESS "10.1.2.3"
+
+struct DNSWaiter
+{
+    mutex m_mutex;
+    condition_variable m_cond;
+    uint32_t m_done = 0;
+};
+
+static void
+requestDone(HMDNSRequest& request, void* arg)
+{
+    (void)request;
+    DNSWaiter* waiter = (DNSWaiter*)arg;
+    lock_guard<mutex> lk(waiter->m_mutex);
+    waiter->m_done++;
+    waiter->m_cond.notify_all();
+}
+
+static bool
+waitRequests(DNSWaiter& waiter, uint32_t count, uint32_t seconds = 5)
+{
+    unique_lock<mutex> lk(waiter.m_mutex);
+    return waiter.m_cond.wait_for(lk, chrono::seconds(seconds), [&waiter, count](){return waiter.m_done >= count;});
+}
+
+// Minimal UDP DNS server on a loopback ephemeral port.
+// Names starting with host resolve, names starting with drop are never answered and all others don't exist.
+class TestDNSServer
+{
+public:
+    TestDNSServer() :
+        m_port(0),
+        m_queries(0),
+        m_keepRunning(true)
+    {
+        m_fd = socket(AF_INET, SOCK_DGRAM, 0);
+        // Absorb the query bursts of the concurrency test
+        int bufSize = 4 * 1024 * 1024;
+        setsockopt(m_fd, SOL_SOCKET, SO_RCVBUF, &bufSize, sizeof(bufSize));
+        sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port = 0;
+        bind(m_fd, (sockaddr*)&addr, sizeof(addr));
+        socklen_t len = sizeof(addr);
+        getsockname(m_fd, (sockaddr*)&addr, &len);
+        m_port = ntohs(addr.sin_port);
+        m_thread = thread(&TestDNSServer::run, this);
+    }
+
+    ~TestDNSServer()
+    {
+        m_keepRunning = false;
+        m_thread.join();
+        close(m_fd);
+    }
+
+    uint16_t m_port;
+    atomic<int> m_queries;
+
+private:
+    void run()
+    {
+        pollfd pfd;
+        pfd.fd = m_fd;
+        pfd.events = POLLIN;
+        unsigned char buf[512];
+        while(m_keepRunning)
+        {
+            if(poll(&pfd, 1, 50) <= 0)
+            {
+                continue;
+            }
+            sockaddr_storage client;
+            socklen_t clientLen = sizeof(client);
+            ssize_t n = recvfrom(m_fd, buf, sizeof(buf), 0, (sockaddr*)&client, &clientLen);
+            if(n < 12)
+            {
+                continue;
+            }
+            m_queries++;
+
+            // Walk the question name
+            string name;
+            ssize_t pos = 12;
+            while(pos < n && buf[pos] != 0)
+            {
+                name.append((char*)&buf[pos + 1], buf[pos]);
+                name.append(".");
+                pos += buf[pos] + 1;
+            }
+            pos += 5;
+            if(pos > n || name.find("drop") == 0)
+            {
+                continue;
+            }
+
+            string response((char*)buf, pos);
+            response[2] = (char)0x81;
+            response[7] = 0;
+            response[8] = response[9] = response[10] = response[11] = 0;
+            if(name.find("host") == 0)
+            {
+                response[3] = (char)0x80;
+                response[7] = 1;
+                in_addr_t address = inet_addr(TEST_RESOLVED_ADDRESS);
+                const unsigned char answer[] = {0xC0, 0x0C, 0, 1, 0, 1, 0, 0, 0, 60, 0, 4};
+                response.append((const char*)answer, sizeof(answer));
+                response.append((const char*)&address, sizeof(address));
+            }
+            else
+            {
+                // NXDOMAIN
+                response[3] = (char)0x83;
+            }
+            sendto(m_fd, response.data(), response.size(), 0, (sockaddr*)&client, clientLen);
+        }
+    }
+
+    int m_fd;
+    atomic<bool> m_keepRunning;
+    thread m_thread;
+};
+
+static void
+setupRequest(HMDNSRequest& request, DNSWaiter& waiter, const TestDNSServer& server, const string& hostname)
+{
+    request.m_hostname = hostname;
+    request.m_family = AF_INET;
+    request.m_server.set("127.0.0.1");
+    request.m_port = server.m_port;
+    request.m_timeout = 1000;
+    request.m_tries = 1;
+    request.m_callback = requestDone;
+    request.m_arg = &waiter;
+}
+
+void TESTNAME::setUp() {
+    setupCommon();
+}
+
+void TESTNAME::tearDown() {
+    teardownCommon();
+}
+
+void TESTNAME::test_resolve_success() {
+    TestDNSServer server;
+    HMDNSResolver resolver(2);
+    CPPUNIT_ASSERT(resolver.start());
+
+    DNSWaiter waiter;
+    HMDNSRequest request;
+    setupRequest(request, waiter, server, "host.example.test");
+    CPPUNIT_ASSERT(resolver.submit(request));
+    CPPUNIT_ASSERT(waitRequests(waiter, 1));
+
+    CPPUNIT_ASSERT_EQUAL(ARES_SUCCESS, request.m_status);
+    CPPUNIT_ASSERT_EQUAL(1, (int)request.m_addresses.size());
+    CPPUNIT_ASSERT_EQUAL(string(TEST_RESOLVED_ADDRESS), request.m_addresses[0].toString());
+    CPPUNIT_ASSERT_EQUAL(0, (int)resolver.getInFlight());
+
+    map<string, HMDNSServerStats> stats;
+    resolver.getServerStats(stats);
+    string key = "127.0.0.1:" + to_string(server.m_port);
+    CPPUNIT_ASSERT(stats.find(key) != stats.end());
+    CPPUNIT_ASSERT_EQUAL(1, (int)stats[key].m_queries);
+    CPPUNIT_ASSERT_EQUAL(1, (int)stats[key].m_success);
+    resolver.shutDown();
+}
+
+void TESTNAME::test_resolve_not_found() {
+    TestDNSServer server;
+    HMDNSResolver resolver(1);
+    CPPUNIT_ASSERT(resolver.start());
+
+    DNSWaiter waiter;
+    HMDNSRequest request;
+    setupRequest(request, waiter, server, "missing.example.test");
+    CPPUNIT_ASSERT(resolver.submit(request));
+    CPPUNIT_ASSERT(waitRequests(waiter, 1));
+
+    CPPUNIT_ASSERT_EQUAL(ARES_ENOTFOUND, request.m_status);
+    CPPUNIT_ASSERT(request.m_addresses.empty());
+
+    map<string, HMDNSServerStats> stats;
+    resolver.getServerStats(stats);
+    string key = "127.0.0.1:" + to_string(server.m_port);
+    CPPUNIT_ASSERT_EQUAL(1, (int)stats[key].m_notFound);
+    resolver.shutDown();
+}
+
+void TESTNAME::test_resolve_timeout() {
+    TestDNSServer server;
+    HMDNSResolver resolver(1);
+    CPPUNIT_ASSERT(resolver.start());
+
+    DNSWaiter waiter;
+    HMDNSRequest request;
+    setupRequest(request, waiter, server, "drop.example.test");
+    HMTimeStamp start = HMTimeStamp::now();
+    CPPUNIT_ASSERT(resolver.submit(request));
+    CPPUNIT_ASSERT(waitRequests(waiter, 1));
+
+    CPPUNIT_ASSERT_EQUAL(ARES_ETIMEOUT, request.m_status);
+    CPPUNIT_ASSERT(request.m_timeouts > 0);
+    CPPUNIT_ASSERT(HMTimeStamp::now() - start >= 900);
+
+    map<string, HMDNSServerStats> stats;
+    resolver.getServerStats(stats);
+    string key = "127.0.0.1:" + to_string(server.m_port);
+    CPPUNIT_ASSERT_EQUAL(1, (int)stats[key].m_timeouts);
+
+    // The timeout is used as is, not rounded up to whole seconds
+    HMDNSRequest shortRequest;
+    setupRequest(shortRequest, waiter, server, "drop.example.test");
+    shortRequest.m_timeout = 300;
+    start = HMTimeStamp::now();
+    CPPUNIT_ASSERT(resolver.submit(shortRequest));
+    CPPUNIT_ASSERT(waitRequests(waiter, 2));
+    CPPUNIT_ASSERT_EQUAL(ARES_ETIMEOUT, shortRequest.m_status);
+    CPPUNIT_ASSERT(HMTimeStamp::now() - start < 900);
+    resolver.shutDown();
+}
+
+void TESTNAME::test_concurrent_lookups() {
+    TestDNSServer server;
+    HMDNSResolver resolver(2);
+    CPPUNIT_ASSERT(resolver.start());
+
+    const uint32_t count = 2000;
+    DNSWaiter waiter;
+    vector<HMDNSRequest> requests(count);
+    for(uint32_t i = 0; i < count; i++)
+    {
+        setupRequest(requests[i], waiter, server, "host" + to_string(i) + ".example.test");
+        // The loopback socket buffers can still drop a few queries of the burst
+        requests[i].m_tries = 3;
+        CPPUNIT_ASSERT(resolver.submit(requests[i]));
+    }
+    CPPUNIT_ASSERT(waitRequests(waiter, count, 10));
+
+    for(auto& request : requests)
+    {
+        CPPUNIT_ASSERT_EQUAL(ARES_SUCCESS, request.m_status);
+        CPPUNIT_ASSERT_EQUAL(1, (int)request.m_addresses.size());
+    }
+    CPPUNIT_ASSERT_EQUAL(0, (int)resolver.getInFlight());
+    CPPUNIT_ASSERT(server.m_queries >= (int)count);
+    resolver.shutDown();
+}
+
+void TESTNAME::test_shutdown_pending() {
+    TestDNSServer server;
+    HMDNSResolver resolver(1);
+    CPPUNIT_ASSERT(resolver.start());
+
+    DNSWaiter waiter;
+    HMDNSRequest request;
+    setupRequest(request, waiter, server, "drop.example.test");
+    request.m_timeout = 30000;
+    CPPUNIT_ASSERT(resolver.submit(request));
+    while(server.m_queries == 0)
+    {
+        this_thread::sleep_for(chrono::milliseconds(10));
+    }
+    resolver.shutDown();
+
+    CPPUNIT_ASSERT(waitRequests(waiter, 1, 1));
+    CPPUNIT_ASSERT_EQUAL(ARES_EDESTRUCTION, request.m_status);
+    CPPUNIT_ASSERT_EQUAL(0, (int)resolver.getInFlight());
+}
+
+void TESTNAME::test_submit_not_running() {
+    HMDNSResolver resolver(1);
+    HMDNSRequest request;
+    CPPUNIT_ASSERT(!resolver.submit(request));
+    CPPUNIT_ASSERT(resolver.start());
+    resolver.shutDown();
+    CPPUNIT_ASSERT(!resolver.submit(request));
+
+    // Every lookup accepted while the resolver shuts down is handed back
+    TestDNSServer server;
+    CPPUNIT_ASSERT(resolver.start());
+    DNSWaiter waiter;
+    vector<HMDNSRequest> requests(1000);
+    atomic<uint32_t> accepted(0);
+    thread submitter([&]() {
+        for(auto& it : requests)
+        {
+            setupRequest(it, waiter, server, "drop.example.test");
+            if(resolver.submit(it))
+            {
+                accepted++;
+            }
+        }
+    });
+    while(accepted == 0)
+    {
+        this_thread::yield();
+    }
+    resolver.shutDown();
+    submitter.join();
+    CPPUNIT_ASSERT(waitRequests(waiter, accepted, 1));
+    CPPUNIT_ASSERT_EQUAL(accepted.load(), waiter.m_done);
+    CPPUNIT_ASSERT_EQUAL(0, (int)resolver.getInFlight());
+}
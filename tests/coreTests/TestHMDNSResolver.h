@@ -0,0 +1,40 @@
+// Copyright 2019, Oath Inc.
+// Licensed under the terms of the Apache 2.0 license. See LICENSE file in the root of the distribution for licensing details.
+#ifndef TEST_HMDNSRESOLVER_H_
+#define TEST_HMDNSRESOLVER_H_
+
+#include <cppunit/Test.h>
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include "HMDNSResolver.h"
+
+#define TESTNAME Test_HMDNSResolver
+
+class TESTNAME : public CppUnit::TestFixture
+{
+
+    CPPUNIT_TEST_SUITE(TESTNAME);
+    CPPUNIT_TEST(test_resolve_success);
+    CPPUNIT_TEST(test_resolve_not_found);
+    CPPUNIT_TEST(test_resolve_timeout);
+    CPPUNIT_TEST(test_concurrent_lookups);
+    CPPUNIT_TEST(test_shutdown_pending);
+    CPPUNIT_TEST(test_submit_not_running);
+    CPPUNIT_TEST_SUITE_END();
+
+
+public:
+
+    void setUp();
+    void tearDown();
+    void test_resolve_success();
+    void test_resolve_not_found();
+    void test_resolve_timeout();
+    void test_concurrent_lookups();
+    void test_shutdown_pending();
+    void test_submit_not_running();
+protected:
+
+};
+
+#endif /* TEST_HMDNSRESOLVER_H_ */
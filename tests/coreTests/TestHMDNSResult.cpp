@@ -65,16 +65,16 @@ void TESTNAME::test_next_query()
     HMDNSResult results;
     uint64_t query_timeout = 500;
     results.updateTimeouts(100, query_timeout);
-    HMTimeStamp start_time = results.startQuery();
-    HMTimeStamp next_time = results.nextQueryTime();
-    CPPUNIT_ASSERT_EQUAL(start_time.getTimeSinceEpoch() + query_timeout,
-            next_time.getTimeSinceEpoch());
+    HMMonotonicTime start_time = results.startQuery();
+    HMMonotonicTime next_time = results.nextQueryTime();
+    CPPUNIT_ASSERT_EQUAL(start_time.getMilliseconds() + query_timeout,
+            next_time.getMilliseconds());
     CPPUNIT_ASSERT_EQUAL(HM_CHECK_IN_PROGRESS, results.getQueryState());
     std::this_thread::sleep_for(std::chrono::milliseconds(1500));
     next_time = results.nextQueryTime();
     CPPUNIT_ASSERT(
-            (start_time.getTimeSinceEpoch() + query_timeout)
-                    < next_time.getTimeSinceEpoch());
+            (start_time.getMilliseconds() + query_timeout)
+                    < next_time.getMilliseconds());
     CPPUNIT_ASSERT_EQUAL(HM_CHECK_IN_PROGRESS, results.getQueryState());
 }
 
@@ -84,18 +84,18 @@ void TESTNAME::test_next_query1()
     HMDNSResult results;
     uint64_t dns_timeout = 500;
     results.updateTimeouts(dns_timeout, 100);
-    HMTimeStamp result_time = HMTimeStamp::now();
+    HMMonotonicTime result_time = HMMonotonicTime::now();
     results.finishQuery(true);
-    HMTimeStamp next_time = results.nextQueryTime();
+    HMMonotonicTime next_time = results.nextQueryTime();
     CPPUNIT_ASSERT(
-            (result_time.getTimeSinceEpoch() + dns_timeout)
-                    >= next_time.getTimeSinceEpoch());
+            (result_time.getMilliseconds() + dns_timeout)
+                    >= next_time.getMilliseconds());
     CPPUNIT_ASSERT_EQUAL(HM_CHECK_INACTIVE, results.getQueryState());
     std::this_thread::sleep_for(std::chrono::milliseconds(1500));
     next_time = results.nextQueryTime();
     CPPUNIT_ASSERT(
-            (result_time.getTimeSinceEpoch() + dns_timeout)
-                    < next_time.getTimeSinceEpoch());
+            (result_time.getMilliseconds() + dns_timeout)
+                    < next_time.getMilliseconds());
     CPPUNIT_ASSERT_EQUAL(HM_CHECK_INACTIVE, results.getQueryState());
 }
 
@@ -105,12 +105,12 @@ void TESTNAME::test_next_query2()
     HMDNSResult results;
     uint64_t dns_timeout = 500;
     results.updateTimeouts(dns_timeout, 100);
-    HMTimeStamp result_time = HMTimeStamp::now();
+    HMMonotonicTime result_time = HMMonotonicTime::now();
     results.finishQuery(false);
-    HMTimeStamp next_time = results.nextQueryTime();
+    HMMonotonicTime next_time = results.nextQueryTime();
     CPPUNIT_ASSERT(
-            (result_time.getTimeSinceEpoch() + dns_timeout)
-                    >= next_time.getTimeSinceEpoch());
+            (result_time.getMilliseconds() + dns_timeout)
+                    >= next_time.getMilliseconds());
     CPPUNIT_ASSERT_EQUAL(HM_CHECK_FAILED, results.getQueryState());
 }
 
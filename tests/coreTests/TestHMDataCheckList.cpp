@@ -19,6 +19,7 @@ void TESTNAME::setUp()
 
 void TESTNAME::tearDown()
 {
+    HMMonotonicTime::setFakeClock(nullptr);
     teardownCommon();
 }
 
@@ -463,3 +464,97 @@ void TESTNAME::test_basic_healthPlugins_checkIpAddress()
     CPPUNIT_ASSERT(ips.find(ip2) != ips.end());
 
 }
+
+void TESTNAME::test_check_ids()
+{
+    HMDataHostCheck data_host;
+    HMDataHostCheck data_host1;
+    HMDataCheckParams params;
+    HMDataCheckList check_list;
+    HMDataCheckList check_list1;
+    HMWorkQueue queue;
+    HMIPAddress ip, ip1, ip2;
+    string host_group = "HostGroup";
+    string check_info = "DummyCheckInfo";
+    ip.set("192.168.1.1");
+    ip1.set("192.168.1.2");
+    set<HMIPAddress> ips;
+    ips.insert(ip);
+
+    HMDataHostGroup hostGroup(host_group);
+    hostGroup.setCheckType(HM_CHECK_TCP);
+    hostGroup.setCheckPlugin(HM_CHECK_PLUGIN_TCP_RAW);
+    hostGroup.setPort(80);
+    hostGroup.setDualStack(HM_DUALSTACK_BOTH);
+    hostGroup.setCheckInfo(check_info);
+    hostGroup.setRemoteCheck("");
+    hostGroup.setRemoteCheckType(HM_REMOTE_CHECK_NONE);
+    hostGroup.setDistributedFallback(HM_DISTRIBUTED_FALLBACK_NONE);
+    data_host.setCheckParams(hostGroup);
+    hostGroup.setPort(443);
+    data_host1.setCheckParams(hostGroup);
+
+    CPPUNIT_ASSERT(check_list.getListID() != check_list1.getListID());
+    CPPUNIT_ASSERT_EQUAL((uint32_t)HM_CHECK_ID_INVALID, check_list.getCheckID("Host0", data_host));
+
+    // Insert enough keys to grow the hash table a few times
+    for(uint32_t i = 0; i < 100; i++)
+    {
+        check_list.insertCheck(host_group, "Host" + to_string(i), data_host, params, ips);
+        check_list.insertCheck(host_group, "Host" + to_string(i), data_host1, params, ips);
+    }
+    set<uint32_t> checkIDs;
+    for(uint32_t i = 0; i < 100; i++)
+    {
+        uint32_t checkID = check_list.getCheckID("Host" + to_string(i), data_host);
+        uint32_t checkID1 = check_list.getCheckID("Host" + to_string(i), data_host1);
+        CPPUNIT_ASSERT(checkID != HM_CHECK_ID_INVALID);
+        CPPUNIT_ASSERT(checkID1 != HM_CHECK_ID_INVALID);
+        checkIDs.insert(checkID);
+        checkIDs.insert(checkID1);
+    }
+    CPPUNIT_ASSERT_EQUAL((size_t)200, checkIDs.size());
+    CPPUNIT_ASSERT_EQUAL((uint32_t)HM_CHECK_ID_INVALID, check_list.getCheckID("Host100", data_host));
+
+    // A second check params for the same key keeps the same id
+    HMDataCheckParams params1;
+    params1.setCheckParameters(0, 0, 0, 10, 20, 20, 4, 10000, 60000, 0, 0);
+    string host_name = "Host7";
+    uint32_t checkID = check_list.getCheckID(host_name, data_host);
+    check_list.insertCheck(host_group, host_name, data_host, params1, ips);
+    CPPUNIT_ASSERT_EQUAL(checkID, check_list.getCheckID(host_name, data_host));
+
+    // The lookups by id match the lookups by name, hold the clock so both read the same now
+    HMFakeClock clock(HMMonotonicTime::now().getMicroseconds());
+    HMMonotonicTime::setFakeClock(&clock);
+    CPPUNIT_ASSERT(check_list.hasCheck(checkID, ip));
+    CPPUNIT_ASSERT(!check_list.hasCheck(checkID, ip1));
+    CPPUNIT_ASSERT(!check_list.hasCheck(HM_CHECK_ID_INVALID, ip));
+    CPPUNIT_ASSERT_EQUAL(check_list.checkNeeded(host_name, ip, data_host), check_list.checkNeeded(checkID, ip));
+    CPPUNIT_ASSERT_EQUAL(HM_SCHEDULE_IGNORE, check_list.checkNeeded(HM_CHECK_ID_INVALID, ip));
+    CPPUNIT_ASSERT(check_list.nextCheckTime(host_name, ip, data_host) == check_list.nextCheckTime(checkID, ip));
+    HMMonotonicTime::setFakeClock(nullptr);
+
+    // The unspecified address is never checked
+    ip2.set("0.0.0.0");
+    ips.clear();
+    ips.insert(ip2);
+    check_list.insertCheck(host_group, host_name, data_host, params, ips);
+    CPPUNIT_ASSERT_EQUAL(HM_SCHEDULE_IGNORE, check_list.checkNeeded(checkID, ip2));
+
+    // The work carries the check id and looks it up again in another check list
+    check_list.queueCheck(checkID, host_name, ip, data_host, queue);
+    CPPUNIT_ASSERT_EQUAL((uint32_t)1, queue.queueSize());
+    unique_ptr<HMWork> work;
+    bool threadStatus = false;
+    queue.getWork(work, threadStatus);
+    CPPUNIT_ASSERT(work.get() != nullptr);
+    CPPUNIT_ASSERT_EQUAL(check_list.getListID(), work->m_checkListID);
+    CPPUNIT_ASSERT_EQUAL(checkID, work->m_checkID);
+    CPPUNIT_ASSERT_EQUAL(checkID, work->getCheckID(check_list));
+    CPPUNIT_ASSERT_EQUAL((uint32_t)HM_CHECK_ID_INVALID, work->getCheckID(check_list1));
+    HMDataCheckList check_list2;
+    check_list2.insertCheck(host_group, host_name, data_host, params, ips);
+    CPPUNIT_ASSERT_EQUAL(check_list2.getCheckID(host_name, data_host), work->getCheckID(check_list2));
+    CPPUNIT_ASSERT_EQUAL(check_list2.getListID(), work->m_checkListID);
+}
@@ -24,6 +24,7 @@ class TESTNAME : public CppUnit::TestFixture
     CPPUNIT_TEST(test_basic_healthPlugins_mtls);
     CPPUNIT_TEST(test_hostgroup_distributed_fallback);
     CPPUNIT_TEST(test_basic_healthPlugins_checkIpAddress);
+    CPPUNIT_TEST(test_check_ids);
     CPPUNIT_TEST_SUITE_END();
 
 
@@ -41,6 +42,7 @@ public:
     void test_basic_healthPlugins_checkIpAddress();
     void test_ip_dns_failed();
     void test_basic_healthPlugins_mtls();
+    void test_check_ids();
 protected:
 
 };
@@ -19,6 +19,7 @@ void TESTNAME::setUp()
 
 void TESTNAME::tearDown()
 {
+    HMMonotonicTime::setFakeClock(nullptr);
     teardownCommon();
 }
 
@@ -50,7 +51,7 @@ void TESTNAME::test_basic_query()
     CPPUNIT_ASSERT_EQUAL(HM_CHECK_IN_PROGRESS, params.getQueryState(ip));
     CPPUNIT_ASSERT(params.getCheckTime(ip) <= HMTimeStamp::now());
     CPPUNIT_ASSERT(!params.checkNeeded(ip));
-    CPPUNIT_ASSERT(params.nextCheckTime(ip) > HMTimeStamp::now());
+    CPPUNIT_ASSERT(params.nextCheckTime(ip) > HMMonotonicTime::now());
     set<HMIPAddress> addresses;
     CPPUNIT_ASSERT(params.getAddresses(HM_DUALSTACK_IPV4_ONLY, addresses));
     CPPUNIT_ASSERT_EQUAL(1, (int)addresses.size());
@@ -69,7 +70,7 @@ void TESTNAME::test_basic_queryV6()
     CPPUNIT_ASSERT_EQUAL(HM_CHECK_IN_PROGRESS, params.getQueryState(ip));
     CPPUNIT_ASSERT(params.getCheckTime(ip) <= HMTimeStamp::now());
     CPPUNIT_ASSERT(!params.checkNeeded(ip));
-    CPPUNIT_ASSERT(params.nextCheckTime(ip) > HMTimeStamp::now());
+    CPPUNIT_ASSERT(params.nextCheckTime(ip) > HMMonotonicTime::now());
     set<HMIPAddress> addresses;
     CPPUNIT_ASSERT(params.getAddresses(HM_DUALSTACK_IPV6_ONLY, addresses));
     CPPUNIT_ASSERT_EQUAL(1, (int)addresses.size());
@@ -123,8 +124,8 @@ void TESTNAME::test_basic_result()
 	hostGroup.setRemoteCheckType(HM_REMOTE_CHECK_NONE);
 	hostGroup.setDistributedFallback(HM_DISTRIBUTED_FALLBACK_NONE);
 	dataHost.setCheckParams(hostGroup);
-    HMTimeStamp start = HMTimeStamp::now();
-    HMTimeStamp end = HMTimeStamp::now() + 1000;
+    HMMonotonicTime start = HMMonotonicTime::now();
+    HMMonotonicTime end = HMMonotonicTime::now() + 1000;
     params.emptyQuery(ip);
     params.startQuery(ip);
     params.updateCheck(host_name, ip, HM_RESPONSE_CONNECTED, HM_REASON_DNS_NOTFOUND,
@@ -162,8 +163,8 @@ void TESTNAME::test_dns_failed_result()
 	hostGroup.setDistributedFallback(HM_DISTRIBUTED_FALLBACK_NONE);
 	dataHost.setCheckParams(hostGroup);
 
-    HMTimeStamp start = HMTimeStamp::now();
-    HMTimeStamp end = start;
+    HMMonotonicTime start = HMMonotonicTime::now();
+    HMMonotonicTime end = start;
     params.emptyQuery(ip);
     params.updateCheck(host_name, ip, HM_RESPONSE_DNS_FAILED, HM_REASON_DNS_NOTFOUND,
             start, end, dataHost.getPort());
@@ -171,9 +172,9 @@ void TESTNAME::test_dns_failed_result()
     CPPUNIT_ASSERT_EQUAL((uint16_t )801, (uint16_t )result.m_port);
     CPPUNIT_ASSERT_EQUAL((uint8_t )HM_RESPONSE_DNS_FAILED, (uint8_t )result.m_response);
     CPPUNIT_ASSERT_EQUAL((uint8_t )HM_REASON_DNS_NOTFOUND, (uint8_t )result.m_reason);
-    CPPUNIT_ASSERT(start == result.m_start);
-    CPPUNIT_ASSERT(start == result.m_checkTime);
-    CPPUNIT_ASSERT(start == result.m_end);
+    CPPUNIT_ASSERT(start == result.m_lastCheck);
+    CPPUNIT_ASSERT(result.m_start == result.m_checkTime);
+    CPPUNIT_ASSERT(result.m_end == result.m_checkTime);
     CPPUNIT_ASSERT(!result.m_address.toString().compare("0.0.0.0"));
     CPPUNIT_ASSERT_EQUAL((uint32_t )0, result.m_numChecks);
     CPPUNIT_ASSERT(
@@ -201,8 +202,8 @@ void TESTNAME::test_basic_result1()
 	hostGroup.setDistributedFallback(HM_DISTRIBUTED_FALLBACK_NONE);
 	dataHost.setCheckParams(hostGroup);
 
-    HMTimeStamp start = HMTimeStamp::now();
-    HMTimeStamp end = HMTimeStamp::now() + 1000;
+    HMMonotonicTime start = HMMonotonicTime::now();
+    HMMonotonicTime end = HMMonotonicTime::now() + 1000;
     params.emptyQuery(ip);
     params.startQuery(ip);
     params.updateCheck(host_name, ip, HM_RESPONSE_FAILED, HM_REASON_CONNECT_TIMEOUT,
@@ -234,8 +235,8 @@ void TESTNAME::test_basic_result2()
 	hostGroup.setDistributedFallback(HM_DISTRIBUTED_FALLBACK_NONE);
 	dataHost.setCheckParams(hostGroup);
 
-    HMTimeStamp start = HMTimeStamp::now();
-    HMTimeStamp end = HMTimeStamp::now() + 1000;
+    HMMonotonicTime start = HMMonotonicTime::now();
+    HMMonotonicTime end = HMMonotonicTime::now() + 1000;
     params.emptyQuery(ip);
     params.startQuery(ip);
     params.updateCheck(host_name, ip, HM_RESPONSE_FAILED, HM_REASON_RESPONSE_FAILURE,
@@ -267,8 +268,8 @@ void TESTNAME::test_basic_result3()
 	hostGroup.setDistributedFallback(HM_DISTRIBUTED_FALLBACK_NONE);
 	dataHost.setCheckParams(hostGroup);
 
-    HMTimeStamp start = HMTimeStamp::now();
-    HMTimeStamp end = HMTimeStamp::now() + 1000;
+    HMMonotonicTime start = HMMonotonicTime::now();
+    HMMonotonicTime end = HMMonotonicTime::now() + 1000;
     params.emptyQuery(ip);
     params.startQuery(ip);
     params.updateCheck(host_name, ip, HM_RESPONSE_FAILED, HM_REASON_CONNECT_FAILURE,
@@ -304,8 +305,8 @@ void TESTNAME::test_basic_result4()
 	hostGroup.setDistributedFallback(HM_DISTRIBUTED_FALLBACK_NONE);
 	dataHost.setCheckParams(hostGroup);
 
-    HMTimeStamp start = HMTimeStamp::now();
-    HMTimeStamp end = HMTimeStamp::now() + 1000;
+    HMMonotonicTime start = HMMonotonicTime::now();
+    HMMonotonicTime end = HMMonotonicTime::now() + 1000;
     params.emptyQuery(ip);
     params.startQuery(ip);
     params.updateCheck(host_name, ip, HM_RESPONSE_CONNECTED, HM_REASON_SUCCESS, start,
@@ -319,7 +320,7 @@ void TESTNAME::test_basic_result4()
     CPPUNIT_ASSERT_EQUAL((uint32_t )(end - start),
             result.m_smoothedResponseTime);
     CPPUNIT_ASSERT(
-            (uint32_t )(HMTimeStamp::now() - start)
+            (uint32_t )(HMMonotonicTime::now() - start)
                     >= result.m_totalResponseTime);
 }
 
@@ -346,8 +347,8 @@ void TESTNAME::test_basic_result5()
 	hostGroup.setDistributedFallback(HM_DISTRIBUTED_FALLBACK_NONE);
 	dataHost.setCheckParams(hostGroup);
 
-    HMTimeStamp start = HMTimeStamp::now();
-    HMTimeStamp end = HMTimeStamp::now() + 1000;
+    HMMonotonicTime start = HMMonotonicTime::now();
+    HMMonotonicTime end = HMMonotonicTime::now() + 1000;
     params.emptyQuery(ip);
     params.startQuery(ip);
     params.updateCheck(host_name, ip, HM_RESPONSE_CONNECTED, HM_REASON_SUCCESS, start,
@@ -359,10 +360,10 @@ void TESTNAME::test_basic_result5()
     CPPUNIT_ASSERT_EQUAL((uint32_t )(end - start), result.m_responseTime);
     CPPUNIT_ASSERT_EQUAL((uint32_t )1, result.m_numResponses);
     CPPUNIT_ASSERT(
-            (uint32_t )(HMTimeStamp::now() - start)
+            (uint32_t )(HMMonotonicTime::now() - start)
                     >= result.m_smoothedResponseTime);
     CPPUNIT_ASSERT(
-            (uint32_t )(HMTimeStamp::now() - start)
+            (uint32_t )(HMMonotonicTime::now() - start)
                     >= result.m_totalResponseTime);
 }
 
@@ -386,8 +387,8 @@ void TESTNAME::test_basic_result6()
 	hostGroup.setDistributedFallback(HM_DISTRIBUTED_FALLBACK_NONE);
 	dataHost.setCheckParams(hostGroup);
 
-    HMTimeStamp start = HMTimeStamp::now();
-    HMTimeStamp end = HMTimeStamp::now() + 1000;
+    HMMonotonicTime start = HMMonotonicTime::now();
+    HMMonotonicTime end = HMMonotonicTime::now() + 1000;
     params.emptyQuery(ip);
     params.startQuery(ip);
     params.updateCheck(host_name, ip, HM_RESPONSE_FAILED, HM_REASON_INTERNAL_ERROR,
@@ -422,8 +423,8 @@ void TESTNAME::test_basic_retry()
 	hostGroup.setDistributedFallback(HM_DISTRIBUTED_FALLBACK_NONE);
 	dataHost.setCheckParams(hostGroup);
 
-    HMTimeStamp start = HMTimeStamp::now();
-    HMTimeStamp end = HMTimeStamp::now() + 1000;
+    HMMonotonicTime start = HMMonotonicTime::now();
+    HMMonotonicTime end = HMMonotonicTime::now() + 1000;
     params.emptyQuery(ip);
     params.startQuery(ip);
     params.updateCheck(host_name, ip, HM_RESPONSE_CONNECTED,
@@ -490,8 +491,8 @@ void TESTNAME::test_basic_flaps()
 	hostGroup.setDistributedFallback(HM_DISTRIBUTED_FALLBACK_NONE);
 	dataHost.setCheckParams(hostGroup);
 
-    HMTimeStamp start = HMTimeStamp::now();
-    HMTimeStamp end = HMTimeStamp::now() + 1000;
+    HMMonotonicTime start = HMMonotonicTime::now();
+    HMMonotonicTime end = HMMonotonicTime::now() + 1000;
     params.emptyQuery(ip);
     params.startQuery(ip);
     params.updateCheck(host_name, ip, HM_RESPONSE_CONNECTED,
@@ -528,6 +529,9 @@ void TESTNAME::test_basic_flaps()
 void TESTNAME::test_nexttime_retry()
 {
     //Tests next check time is after check retry delay
+    // The stored check time is in wall clock milliseconds, hold the monotonic clock so the conversion can not round past the delay
+    HMFakeClock clock(HMMonotonicTime::now().getMicroseconds());
+    HMMonotonicTime::setFakeClock(&clock);
     HMDataCheckParams params;
     HMIPAddress ip;
     HMDataCheckResult result;
@@ -543,8 +547,8 @@ void TESTNAME::test_nexttime_retry()
     params.setCheckParameters(3, 100, 0, 0, 0, 0, 0, 0, 900000, 0, 0);
 
     params.updateCheck(ip, result, true);
-    HMTimeStamp nexttime = HMTimeStamp::now();
-    HMTimeStamp ret = params.nextCheckTime(ip);
+    HMMonotonicTime nexttime = HMMonotonicTime::now();
+    HMMonotonicTime ret = params.nextCheckTime(ip);
     CPPUNIT_ASSERT( ret > nexttime);
     CPPUNIT_ASSERT( ret <= (nexttime + 100));
 
@@ -553,7 +557,7 @@ void TESTNAME::test_nexttime_retry()
     result.m_status = HM_HOST_STATUS_UP;
     result.m_softStatus = HM_HOST_STATUS_UP;
     params.updateCheck(ip, result, true);
-    nexttime = HMTimeStamp::now();
+    nexttime = HMMonotonicTime::now();
     ret = params.nextCheckTime(ip);
     CPPUNIT_ASSERT( ret > nexttime);
     CPPUNIT_ASSERT( ret <= (nexttime + 100));
@@ -563,7 +567,7 @@ void TESTNAME::test_nexttime_retry()
     result.m_status = HM_HOST_STATUS_UP;
     result.m_softStatus = HM_HOST_STATUS_UP;
     params.updateCheck(ip, result, true);
-    nexttime = HMTimeStamp::now();
+    nexttime = HMMonotonicTime::now();
     ret = params.nextCheckTime(ip);
     CPPUNIT_ASSERT(ret > nexttime + 100);
     CPPUNIT_ASSERT(ret <= (nexttime + 900000));
@@ -574,6 +578,8 @@ void TESTNAME::test_nexttime_ttl()
 {
 
     //Tests next check time is after ttl
+    HMFakeClock clock(HMMonotonicTime::now().getMicroseconds());
+    HMMonotonicTime::setFakeClock(&clock);
     HMDataCheckParams params;
     HMIPAddress ip;
     HMDataCheckResult result , result1;
@@ -588,8 +594,8 @@ void TESTNAME::test_nexttime_ttl()
     params.setCheckParameters(3, 10000, 0, 0, 0, 0, 0, 0, 50000, 0, 0);
 
     params.updateCheck(ip, result, true);
-    HMTimeStamp nexttime = HMTimeStamp::now();
-    HMTimeStamp ret = params.nextCheckTime(ip);
+    HMMonotonicTime nexttime = HMMonotonicTime::now();
+    HMMonotonicTime ret = params.nextCheckTime(ip);
     CPPUNIT_ASSERT( ret > (nexttime + 20000));
     CPPUNIT_ASSERT( ret <= (nexttime + 50000));
 
@@ -603,7 +609,7 @@ void TESTNAME::test_nexttime_ttl()
     params.setCheckParameters(3, 10000, 0, 0, 0, 0, 0, 0, 500000, 0, 0);
 
     params.updateCheck(ip, result1, true);
-    nexttime = HMTimeStamp::now();
+    nexttime = HMMonotonicTime::now();
     ret = params.nextCheckTime(ip);
     CPPUNIT_ASSERT( ret > nexttime + 30000);
     CPPUNIT_ASSERT( ret <= nexttime + 500000);
@@ -626,8 +632,8 @@ void TESTNAME::test_nexttime_immediate()
     params.setCheckParameters(3, 100, 0, 0, 0, 0, 0, 0, 10000, 0, 0);
 
     params.updateCheck(ip, result, true);
-    HMTimeStamp nexttime = HMTimeStamp::now();
-    HMTimeStamp ret = params.nextCheckTime(ip);
+    HMMonotonicTime nexttime = HMMonotonicTime::now();
+    HMMonotonicTime ret = params.nextCheckTime(ip);
     CPPUNIT_ASSERT( ret <= (nexttime + 100));
 
 }
@@ -655,8 +661,8 @@ void TESTNAME::test_response_200()
 	hostGroup.setDistributedFallback(HM_DISTRIBUTED_FALLBACK_NONE);
 	dataHost.setCheckParams(hostGroup);
 
-    HMTimeStamp start = HMTimeStamp::now();
-    HMTimeStamp end = HMTimeStamp::now() + 11000;
+    HMMonotonicTime start = HMMonotonicTime::now();
+    HMMonotonicTime end = HMMonotonicTime::now() + 11000;
     params.emptyQuery(ip);
     params.startQuery(ip);
     params.updateCheck(host_name, ip, HM_RESPONSE_CONNECTED, HM_REASON_SUCCESS, start,
@@ -697,8 +703,8 @@ void TESTNAME::test_retry_200()
 	hostGroup.setDistributedFallback(HM_DISTRIBUTED_FALLBACK_NONE);
 	dataHost.setCheckParams(hostGroup);
 
-    HMTimeStamp start = HMTimeStamp::now();
-    HMTimeStamp end = HMTimeStamp::now() + 1000;
+    HMMonotonicTime start = HMMonotonicTime::now();
+    HMMonotonicTime end = HMMonotonicTime::now() + 1000;
     params.emptyQuery(ip);
     params.startQuery(ip);
     params.updateCheck(host_name, ip, HM_RESPONSE_CONNECTED,
@@ -0,0 +1,276 @@
+// Copyright 2019, Oath Inc.
+// Licensed under the terms of the Apache 2.0 license. See LICENSE file in the root of the distribution for licensing details.
+#include <string>
+#include <vector>
+#include "TestHMDataCheckResult.h"
+#include "HMVarint.h"
+#include "HMStorage.h"
+#include "HMDataPacking.h"
+#include "common.h"
+
+using namespace std;
+
+CPPUNIT_TEST_SUITE_REGISTRATION(TESTNAME);
+
+namespace
+{
+// The fixed layout written by older versions
+struct LegacyResult
+{
+    HMIPAddress m_address;
+    uint64_t m_start;
+    uint64_t m_end;
+    uint32_t m_responseTime;
+    uint32_t m_totalResponseTime;
+    uint32_t m_minResponseTime;
+    uint32_t m_maxResponseTime;
+    uint32_t m_smoothedResponseTime;
+    uint64_t m_sumResponseTime;
+    uint32_t m_numChecks;
+    uint32_t m_numResponses;
+    uint32_t m_numConnectFailures;
+    uint32_t m_numFailures;
+    uint32_t m_numTimeouts;
+    uint32_t m_numFlaps;
+    uint16_t m_status;
+    uint8_t m_response;
+    uint8_t m_reason;
+    uint8_t m_softReason;
+    uint8_t m_numFailedChecks;
+    uint8_t m_numSlowResponses;
+    uint16_t m_port;
+    uint64_t m_changeTime;
+    uint64_t m_prevTime;
+    bool m_forceHostDown;
+    uint64_t m_queueCheckTime;
+    uint64_t m_checkTime;
+    uint64_t m_remoteCheckTime;
+};
+
+HMDataCheckResult makeResult()
+{
+    HMDataCheckResult result;
+    HMTimeStamp now = HMTimeStamp::now();
+    result.m_address.set("fad0::1");
+    result.m_checkTime = now;
+    result.m_start = now - 20;
+    result.m_end = now - 5;
+    result.m_queueCheckTime = now - 30;
+    result.m_changeTime = now - 3600000;
+    result.m_remoteCheckTime = now;
+    result.m_responseTime = 12;
+    result.m_totalResponseTime = 15;
+    result.m_minResponseTime = 3;
+    result.m_maxResponseTime = 200;
+    result.m_smoothedResponseTime = 14;
+    result.m_sumResponseTime = 123456789;
+    result.m_numChecks = 1000;
+    result.m_numResponses = 998;
+    result.m_numFailures = 2;
+    result.m_numTimeouts = 1;
+    result.m_status = HM_HOST_STATUS_UP;
+    result.m_response = HM_RESPONSE_CONNECTED;
+    result.m_reason = HM_REASON_SUCCESS;
+    result.m_softReason = HM_REASON_SUCCESS;
+    result.m_port = 443;
+    return result;
+}
+}
+
+void TESTNAME::setUp() {
+    setupCommon();
+}
+
+void TESTNAME::tearDown() {
+    teardownCommon();
+}
+
+void TESTNAME::test_varint() {
+    char buf[HMVarint::MAX_SIZE];
+    vector<uint64_t> values = { 0, 1, 127, 128, 300, 0xFFFFFFFF, 0xFFFFFFFFFFFFFFFFULL };
+    for(auto value : values)
+    {
+        uint32_t len = HMVarint::put(buf, value);
+        CPPUNIT_ASSERT_EQUAL(HMVarint::size(value), len);
+        const char* src = buf;
+        uint64_t read;
+        CPPUNIT_ASSERT(HMVarint::get(src, buf + len, read));
+        CPPUNIT_ASSERT_EQUAL(value, read);
+        CPPUNIT_ASSERT(src == buf + len);
+        // A truncated value is not read
+        src = buf;
+        CPPUNIT_ASSERT(len == 1 || !HMVarint::get(src, buf + len - 1, read));
+    }
+    CPPUNIT_ASSERT_EQUAL(10, (int)HMVarint::size(0xFFFFFFFFFFFFFFFFULL));
+
+    vector<int64_t> deltas = { 0, -1, 1, -64, 63, -3600000 };
+    for(auto delta : deltas)
+    {
+        CPPUNIT_ASSERT_EQUAL(delta, HMVarint::unzigzag(HMVarint::zigzag(delta)));
+    }
+    CPPUNIT_ASSERT_EQUAL(1, (int)HMVarint::size(HMVarint::zigzag(-20)));
+
+    char addrBuf[HMVarint::MAX_ADDRESS_SIZE];
+    vector<string> addresses = { "192.168.0.1", "fad0::1" };
+    for(auto& addr : addresses)
+    {
+        HMIPAddress address;
+        address.set(addr);
+        uint32_t len = HMVarint::putAddress(addrBuf, address);
+        const char* src = addrBuf;
+        HMIPAddress read;
+        CPPUNIT_ASSERT(HMVarint::getAddress(src, addrBuf + len, read));
+        CPPUNIT_ASSERT(read == address);
+        src = addrBuf;
+        CPPUNIT_ASSERT(!HMVarint::getAddress(src, addrBuf + len - 1, read));
+    }
+    HMIPAddress unset;
+    CPPUNIT_ASSERT_EQUAL(1, (int)HMVarint::putAddress(addrBuf, unset));
+}
+
+void TESTNAME::test_serialize() {
+    HMDataCheckResult result = makeResult();
+    uint32_t size = result.serialize(nullptr, 0);
+    vector<char> buf(size);
+    CPPUNIT_ASSERT_EQUAL(size, result.serialize(&buf[0], size));
+
+    // Too small a buffer only returns the size
+    vector<char> small(size - 1, 0);
+    CPPUNIT_ASSERT_EQUAL(size, result.serialize(&small[0], small.size()));
+
+    HMDataCheckResult read;
+    CPPUNIT_ASSERT(read.deserialize(&buf[0], size));
+    CPPUNIT_ASSERT(read == result);
+    CPPUNIT_ASSERT(read.m_remoteCheckTime == result.m_remoteCheckTime);
+    CPPUNIT_ASSERT(read.m_softReason == result.m_softReason);
+
+    // The compact format is well under half of the fixed layout
+    CPPUNIT_ASSERT(size * 2 < sizeof(LegacyResult));
+
+    // An empty result is just the header and the address
+    HMDataCheckResult empty;
+    CPPUNIT_ASSERT_EQUAL(4, (int)empty.serialize(nullptr, 0));
+    buf.resize(4);
+    empty.serialize(&buf[0], buf.size());
+    CPPUNIT_ASSERT(read.deserialize(&buf[0], buf.size()));
+    CPPUNIT_ASSERT(read == empty);
+
+    // Truncated results are rejected
+    buf.resize(size);
+    result.serialize(&buf[0], size);
+    for(uint32_t i = 1; i < size; i++)
+    {
+        CPPUNIT_ASSERT(!read.deserialize(&buf[0], i));
+    }
+
+    // The size used is reported when more data follows
+    buf.resize(size + 8, 0);
+    uint32_t used = 0;
+    CPPUNIT_ASSERT(read.deserialize(&buf[0], buf.size(), used));
+    CPPUNIT_ASSERT_EQUAL(size, used);
+}
+
+void TESTNAME::test_legacy() {
+    HMDataCheckResult result = makeResult();
+    LegacyResult legacy = LegacyResult();
+    legacy.m_address = result.m_address;
+    legacy.m_start = result.m_start.getTimeSinceEpoch();
+    legacy.m_end = result.m_end.getTimeSinceEpoch();
+    legacy.m_responseTime = result.m_responseTime;
+    legacy.m_totalResponseTime = result.m_totalResponseTime;
+    legacy.m_minResponseTime = result.m_minResponseTime;
+    legacy.m_maxResponseTime = result.m_maxResponseTime;
+    legacy.m_smoothedResponseTime = result.m_smoothedResponseTime;
+    legacy.m_sumResponseTime = result.m_sumResponseTime;
+    legacy.m_numChecks = result.m_numChecks;
+    legacy.m_numResponses = result.m_numResponses;
+    legacy.m_numFailures = result.m_numFailures;
+    legacy.m_numTimeouts = result.m_numTimeouts;
+    legacy.m_status = result.m_status;
+    legacy.m_response = result.m_response;
+    legacy.m_reason = result.m_reason;
+    legacy.m_softReason = result.m_softReason;
+    legacy.m_port = result.m_port;
+    legacy.m_changeTime = result.m_changeTime.getTimeSinceEpoch();
+    legacy.m_queueCheckTime = result.m_queueCheckTime.getTimeSinceEpoch();
+    legacy.m_checkTime = result.m_checkTime.getTimeSinceEpoch();
+    legacy.m_remoteCheckTime = result.m_remoteCheckTime.getTimeSinceEpoch();
+
+    HMDataCheckResult read;
+    uint32_t used = 0;
+    CPPUNIT_ASSERT(read.deserialize((const char*)&legacy, sizeof(legacy), used));
+    CPPUNIT_ASSERT_EQUAL((uint32_t)sizeof(legacy), used);
+    CPPUNIT_ASSERT(read == result);
+    CPPUNIT_ASSERT(!read.deserialize((const char*)&legacy, sizeof(legacy) - 1, used));
+
+    // Old records are rewritten in the compact format
+    vector<char> buf(read.serialize(nullptr, 0));
+    read.serialize(&buf[0], buf.size());
+    HMDataCheckResult compact;
+    CPPUNIT_ASSERT(compact.deserialize(&buf[0], buf.size()));
+    CPPUNIT_ASSERT(compact == result);
+}
+
+void TESTNAME::test_unknown_fields() {
+    // A newer writer appending a field past the known ones
+    char buf[64];
+    char* target = buf;
+    *target++ = (char)0xC7;
+    *target++ = 1;
+    target += HMVarint::put(target, (1ULL << 13) | (1ULL << 40));
+    target += HMVarint::putAddress(target, HMIPAddress());
+    target += HMVarint::put(target, 5);
+    target += HMVarint::put(target, 123456);
+
+    HMDataCheckResult read;
+    uint32_t used = 0;
+    CPPUNIT_ASSERT(read.deserialize(buf, target - buf, used));
+    CPPUNIT_ASSERT_EQUAL((uint32_t)(target - buf), used);
+    CPPUNIT_ASSERT_EQUAL(5, (int)read.m_numChecks);
+
+    // An unknown version is rejected
+    buf[1] = 2;
+    CPPUNIT_ASSERT(!read.deserialize(buf, target - buf, used));
+}
+
+void TESTNAME::test_group_delta_packing() {
+    string hostname1 = "test1.hm.com";
+    string hostname2 = "test2.hm.com";
+    HMDataCheckResult result = makeResult();
+    vector<HMGroupCheckResult> results;
+    HMIPAddress address1;
+    HMIPAddress address2;
+    address1.set("192.168.0.1");
+    address2.set("fad0::1");
+    result.m_address = address1;
+    results.push_back(HMGroupCheckResult(hostname1, address1, result));
+    result.m_address = address2;
+    results.push_back(HMGroupCheckResult(hostname1, address2, result));
+    results.push_back(HMGroupCheckResult(hostname2, address2, result));
+
+    HMDataPacking dataPacking;
+    uint64_t dataSize = 0;
+    unique_ptr<char[]> data = dataPacking.packHostGroupDelta(7, 42, false, results, dataSize);
+    CPPUNIT_ASSERT(dataSize > 0);
+
+    uint64_t epoch = 0;
+    uint64_t sequence = 0;
+    bool resync = true;
+    vector<HMGroupCheckResult> unpacked;
+    CPPUNIT_ASSERT(dataPacking.unpackHostGroupDelta(data, dataSize, epoch, sequence, resync, unpacked));
+    CPPUNIT_ASSERT_EQUAL(7, (int)epoch);
+    CPPUNIT_ASSERT_EQUAL(42, (int)sequence);
+    CPPUNIT_ASSERT(!resync);
+    CPPUNIT_ASSERT_EQUAL(3, (int)unpacked.size());
+    for(uint32_t i = 0; i < unpacked.size(); i++)
+    {
+        CPPUNIT_ASSERT(unpacked[i].m_hostName == results[i].m_hostName);
+        CPPUNIT_ASSERT(unpacked[i].m_address == results[i].m_address);
+        CPPUNIT_ASSERT(unpacked[i].m_result == results[i].m_result);
+    }
+
+    // Each hostname is only sent once
+    netchasm::HostGroupDelta delta;
+    CPPUNIT_ASSERT(delta.ParseFromArray(data.get(), dataSize));
+    CPPUNIT_ASSERT_EQUAL(2, (int)delta.hostnames_size());
+}
@@ -0,0 +1,38 @@
+// Copyright 2019, Oath Inc.
+// Licensed under the terms of the Apache 2.0 license. See LICENSE file in the root of the distribution for licensing details.
+#ifndef TEST_HMDATACHECKRESULT_H_
+#define TEST_HMDATACHECKRESULT_H_
+
+#include <cppunit/Test.h>
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include "HMDataCheckResult.h"
+
+#define TESTNAME Test_HMDataCheckResult
+
+class TESTNAME : public CppUnit::TestFixture
+{
+
+    CPPUNIT_TEST_SUITE(TESTNAME);
+    CPPUNIT_TEST(test_varint);
+    CPPUNIT_TEST(test_serialize);
+    CPPUNIT_TEST(test_legacy);
+    CPPUNIT_TEST(test_unknown_fields);
+    CPPUNIT_TEST(test_group_delta_packing);
+    CPPUNIT_TEST_SUITE_END();
+
+
+public:
+
+    void setUp();
+    void tearDown();
+    void test_varint();
+    void test_serialize();
+    void test_legacy();
+    void test_unknown_fields();
+    void test_group_delta_packing();
+protected:
+
+};
+
+#endif /* TEST_HMDATACHECKRESULT_H_ */
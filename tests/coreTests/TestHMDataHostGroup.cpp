@@ -0,0 +1,222 @@
+// Copyright 2019, Oath Inc.
+// Licensed under the terms of the Apache 2.0 license. See LICENSE file in the root of the distribution for licensing details.
+#include <cstring>
+
+#include "TestHMDataHostGroup.h"
+#include "common.h"
+
+using namespace std;
+
+CPPUNIT_TEST_SUITE_REGISTRATION(TESTNAME);
+
+// The fixed layout of the host group info written before it was versioned
+struct LegacyHostGroup
+{
+    uint16_t m_measurementOptions;
+    uint8_t m_dualstack;
+    uint8_t m_checkType;
+    uint16_t m_port;
+    uint8_t m_numCheckRetries;
+    uint32_t m_checkRetryDelay;
+    uint32_t m_smoothingWindow;
+    uint32_t m_groupThreshold;
+    uint32_t m_slowThreshold;
+    uint32_t m_maxFlaps;
+    uint64_t m_checkTimeout;
+    uint64_t m_checkTTL;
+    uint32_t m_flapThreshold;
+    uint32_t m_passthroughInfo;
+    uint8_t m_distributedFallback;
+    uint32_t m_groupNameSize;
+    uint32_t m_checkInfoSize;
+    uint32_t m_numHosts;
+    uint32_t m_remoteCheckSize;
+    uint32_t m_totalHostSize;
+    uint32_t m_numHostGroups;
+    uint32_t m_totalHostGroupSize;
+    HMIPAddress m_sourceAddress;
+    uint8_t m_TOSValue;
+    uint8_t m_DNSCheckPlugin;
+    uint8_t m_flowType;
+};
+
+static void appendString(string& data, const string& value, bool withSize)
+{
+    if(withSize)
+    {
+        uint32_t size = value.size();
+        data.append((char*)&size, sizeof(size));
+    }
+    data.append(value);
+}
+
+void TESTNAME::setUp()
+{
+    setupCommon();
+}
+
+void TESTNAME::tearDown()
+{
+    teardownCommon();
+}
+
+void TESTNAME::test_serialize()
+{
+    string host1 = "host1.hm.com";
+    string host2 = "host2.hm.com";
+    string child = "child.hm.com";
+    HMIPAddress source;
+    source.set("10.1.1.1");
+
+    HMDataHostGroup hostGroup("group.hm.com");
+    hostGroup.setCheckType(HM_CHECK_HTTP);
+    hostGroup.setPort(8080);
+    hostGroup.setCheckInfo("/status");
+    hostGroup.setCheckExpect("OK");
+    hostGroup.setCheckTTL(60000);
+    hostGroup.setSourceAddress(source);
+    hostGroup.setTOSValue(4);
+    hostGroup.setKeepAlive(true);
+    hostGroup.setPriority(HM_WORK_PRIORITY_HIGH);
+    hostGroup.addHost(host1);
+    hostGroup.addHost(host2);
+    hostGroup.addHostGroup(child);
+
+    string data;
+    data.resize(hostGroup.serialize(nullptr, 0));
+    CPPUNIT_ASSERT_EQUAL((uint32_t)data.size(), hostGroup.serialize(&data.at(0), data.size()));
+
+    HMDataHostGroup testGroup("");
+    CPPUNIT_ASSERT(testGroup.deserialize(&data.at(0), data.size()));
+    CPPUNIT_ASSERT(testGroup == hostGroup);
+    CPPUNIT_ASSERT_EQUAL(string("group.hm.com"), testGroup.getName());
+    CPPUNIT_ASSERT_EQUAL(string("OK"), testGroup.getCheckExpect());
+    CPPUNIT_ASSERT(testGroup.getKeepAlive());
+    CPPUNIT_ASSERT_EQUAL((int)HM_WORK_PRIORITY_HIGH, (int)testGroup.getPriority());
+    CPPUNIT_ASSERT_EQUAL(2, (int)testGroup.getHostList()->size());
+    CPPUNIT_ASSERT_EQUAL(1, (int)testGroup.getHostGroupList()->size());
+
+    // A truncated buffer is rejected
+    CPPUNIT_ASSERT(!testGroup.deserialize(&data.at(0), data.size() - 1));
+}
+
+void TESTNAME::test_deserialize_legacy()
+{
+    string groupName = "group.hm.com";
+    string checkInfo = "/status";
+    string remoteCheck = "remote.hm.com";
+    string host1 = "host1.hm.com";
+    string host2 = "host2.hm.com";
+    string child = "child.hm.com";
+
+    LegacyHostGroup legacy;
+    memset(&legacy, 0, sizeof(legacy));
+    legacy.m_measurementOptions = HM_RT_SMOOTHED_TOTAL;
+    legacy.m_dualstack = HM_DUALSTACK_BOTH;
+    legacy.m_checkType = HM_CHECK_HTTP;
+    legacy.m_port = 8080;
+    legacy.m_numCheckRetries = 2;
+    legacy.m_checkTimeout = 1500;
+    legacy.m_checkTTL = 60000;
+    legacy.m_groupThreshold = 10;
+    legacy.m_groupNameSize = groupName.size();
+    legacy.m_checkInfoSize = checkInfo.size();
+    legacy.m_remoteCheckSize = remoteCheck.size();
+    legacy.m_numHosts = 2;
+    legacy.m_totalHostSize = 2 * sizeof(uint32_t) + host1.size() + host2.size();
+    legacy.m_numHostGroups = 1;
+    legacy.m_totalHostGroupSize = sizeof(uint32_t) + child.size();
+    legacy.m_sourceAddress.set("10.1.1.1");
+    legacy.m_TOSValue = 4;
+    legacy.m_flowType = HM_FLOW_REMOTE_HOST_TYPE;
+
+    string data((char*)&legacy, sizeof(legacy));
+    appendString(data, groupName, false);
+    appendString(data, checkInfo, false);
+    appendString(data, remoteCheck, false);
+    appendString(data, host1, true);
+    appendString(data, host2, true);
+    appendString(data, child, true);
+
+    // Read into a group holding the newer fields to check they are reset
+    HMDataHostGroup testGroup("previous.hm.com");
+    testGroup.setCheckExpect("stale");
+    testGroup.setKeepAlive(true);
+    testGroup.setPriority(HM_WORK_PRIORITY_LOW);
+    CPPUNIT_ASSERT(testGroup.deserialize(&data.at(0), data.size()));
+
+    CPPUNIT_ASSERT_EQUAL(groupName, testGroup.getName());
+    CPPUNIT_ASSERT_EQUAL((int)HM_RT_SMOOTHED_TOTAL, (int)testGroup.getMeasurementOptions());
+    CPPUNIT_ASSERT_EQUAL((int)HM_DUALSTACK_BOTH, (int)testGroup.getDualstack());
+    CPPUNIT_ASSERT_EQUAL((int)HM_CHECK_HTTP, (int)testGroup.getCheckType());
+    CPPUNIT_ASSERT_EQUAL(8080, (int)testGroup.getCheckPort());
+    CPPUNIT_ASSERT_EQUAL(2, (int)testGroup.getNumCheckRetries());
+    CPPUNIT_ASSERT_EQUAL(1500, (int)testGroup.getCheckTimeout());
+    CPPUNIT_ASSERT_EQUAL(60000, (int)testGroup.getCheckTTL());
+    CPPUNIT_ASSERT_EQUAL(10, (int)testGroup.getGroupThreshold());
+    CPPUNIT_ASSERT_EQUAL(string("10.1.1.1"), testGroup.getSourceAddress().toString());
+    CPPUNIT_ASSERT_EQUAL(4, (int)testGroup.getTOSValue());
+    CPPUNIT_ASSERT_EQUAL((int)HM_FLOW_REMOTE_HOST_TYPE, (int)testGroup.getFlowType());
+    CPPUNIT_ASSERT_EQUAL(checkInfo, testGroup.getCheckInfo());
+    CPPUNIT_ASSERT_EQUAL(remoteCheck, testGroup.getRemoteCheck());
+    CPPUNIT_ASSERT_EQUAL(2, (int)testGroup.getHostList()->size());
+    CPPUNIT_ASSERT_EQUAL(host1, testGroup.getHostList()->at(0));
+    CPPUNIT_ASSERT_EQUAL(host2, testGroup.getHostList()->at(1));
+    CPPUNIT_ASSERT_EQUAL(1, (int)testGroup.getHostGroupList()->size());
+    CPPUNIT_ASSERT_EQUAL(child, testGroup.getHostGroupList()->at(0));
+
+    // The fields the older layout does not hold are left at their defaults
+    CPPUNIT_ASSERT(testGroup.getCheckExpect().empty());
+    CPPUNIT_ASSERT(!testGroup.getKeepAlive());
+    CPPUNIT_ASSERT_EQUAL((int)HM_WORK_PRIORITY_NORMAL, (int)testGroup.getPriority());
+
+    // Written back it takes the versioned layout
+    string newData;
+    newData.resize(testGroup.serialize(nullptr, 0));
+    testGroup.serialize(&newData.at(0), newData.size());
+    CPPUNIT_ASSERT_EQUAL(0xC9, (int)(uint8_t)newData[0]);
+    HMDataHostGroup newGroup("");
+    CPPUNIT_ASSERT(newGroup.deserialize(&newData.at(0), newData.size()));
+    CPPUNIT_ASSERT(newGroup == testGroup);
+}
+
+void TESTNAME::test_deserialize_invalid()
+{
+    HMDataHostGroup hostGroup("group.hm.com");
+    string data;
+    data.resize(hostGroup.serialize(nullptr, 0));
+    hostGroup.serialize(&data.at(0), data.size());
+
+    HMDataHostGroup testGroup("");
+    CPPUNIT_ASSERT(!testGroup.deserialize(nullptr, 0));
+    CPPUNIT_ASSERT(!testGroup.deserialize(&data.at(0), 1));
+
+    // A layout version this build does not know is rejected
+    data[1]++;
+    CPPUNIT_ASSERT(!testGroup.deserialize(&data.at(0), data.size()));
+}
+
+void TESTNAME::test_deserialize_appended()
+{
+    string host1 = "host1.hm.com";
+    HMDataHostGroup hostGroup("group.hm.com");
+    hostGroup.setCheckInfo("/status");
+    hostGroup.setKeepAlive(true);
+    hostGroup.addHost(host1);
+
+    string data;
+    data.resize(hostGroup.serialize(nullptr, 0));
+    hostGroup.serialize(&data.at(0), data.size());
+
+    // The size of the fixed layout follows the magic and the version
+    uint16_t fixedSize = *(uint16_t*)&data.at(2);
+
+    // A newer layout with fields appended to the fixed layout is read, skipping the new fields
+    string newer = data;
+    newer.insert(fixedSize, 8, '\x7f');
+    *(uint16_t*)&newer.at(2) = fixedSize + 8;
+    HMDataHostGroup testGroup("");
+    CPPUNIT_ASSERT(testGroup.deserialize(&newer.at(0), newer.size()));
+    CPPUNIT_ASSERT(testGroup == hostGroup);
+    CPPUNIT_ASSERT_EQUAL(host1, testGroup.getHostList()->at(0));
+}
@@ -0,0 +1,36 @@
+// Copyright 2019, Oath Inc.
+// Licensed under the terms of the Apache 2.0 license. See LICENSE file in the root of the distribution for licensing details.
+#ifndef TEST_HMDataHostGroup_H_
+#define TEST_HMDataHostGroup_H_
+
+#include <cppunit/Test.h>
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include "HMDataHostGroup.h"
+
+#define TESTNAME Test_HMDataHostGroup
+
+class TESTNAME : public CppUnit::TestFixture
+{
+
+    CPPUNIT_TEST_SUITE(TESTNAME);
+    CPPUNIT_TEST(test_serialize);
+    CPPUNIT_TEST(test_deserialize_legacy);
+    CPPUNIT_TEST(test_deserialize_invalid);
+    CPPUNIT_TEST(test_deserialize_appended);
+    CPPUNIT_TEST_SUITE_END();
+
+
+public:
+
+    void setUp();
+    void tearDown();
+    void test_serialize();
+    void test_deserialize_legacy();
+    void test_deserialize_invalid();
+    void test_deserialize_appended();
+protected:
+
+};
+
+#endif /* TEST_HMDataHostGroup_H_ */
@@ -0,0 +1,256 @@
+// Copyright 2019, Oath Inc.
+// Licensed under the terms of the Apache 2.0 license. See LICENSE file in the root of the distribution for licensing details.
+#include "TestHMDestinationLimiter.h"
+#include "HMEventLoopQueue.h"
+#include "common.h"
+
+using namespace std;
+
+CPPUNIT_TEST_SUITE_REGISTRATION(TESTNAME);
+
+void TESTNAME::setUp() {
+    setupCommon();
+}
+
+void TESTNAME::tearDown() {
+    HMMonotonicTime::setFakeClock(nullptr);
+    teardownCommon();
+}
+
+void TESTNAME::test_defaults() {
+    HMDestinationLimiter limiter;
+    HMIPAddress ip;
+    ip.set("192.168.1.1");
+    shared_ptr<HMDestinationSlot> slot;
+    HMMonotonicTime retry;
+
+    // Nothing is limited until configured
+    for(uint32_t i = 0; i < 100; i++)
+    {
+        CPPUNIT_ASSERT(limiter.acquire(ip, slot, retry));
+        CPPUNIT_ASSERT(limiter.acquireResolver(slot, retry));
+    }
+    CPPUNIT_ASSERT(slot.get() == nullptr);
+    limiter.setConfig(HMDestinationLimitConfig());
+    CPPUNIT_ASSERT(limiter.acquire(ip, slot, retry));
+    CPPUNIT_ASSERT_EQUAL((uint64_t)0, limiter.getNumDeferred());
+}
+
+void TESTNAME::test_concurrency() {
+    HMFakeClock clock;
+    HMMonotonicTime::setFakeClock(&clock);
+    HMDestinationLimiter limiter;
+    HMDestinationLimitConfig config;
+    config.m_concurrency = 2;
+    config.m_retryDelay = 50;
+    limiter.setConfig(config);
+    HMIPAddress ip, ip1;
+    ip.set("192.168.1.1");
+    ip1.set("192.168.1.2");
+    shared_ptr<HMDestinationSlot> slot1, slot2, slot3, slot4;
+    HMMonotonicTime retry;
+
+    CPPUNIT_ASSERT(limiter.acquire(ip, slot1, retry));
+    CPPUNIT_ASSERT(limiter.acquire(ip, slot2, retry));
+    CPPUNIT_ASSERT(!limiter.acquire(ip, slot3, retry));
+    CPPUNIT_ASSERT(slot3.get() == nullptr);
+    CPPUNIT_ASSERT(HMMonotonicTime::now() + 50 == retry);
+    CPPUNIT_ASSERT_EQUAL((uint64_t)1, limiter.getNumDeferred());
+
+    // Another destination has its own limit
+    CPPUNIT_ASSERT(limiter.acquire(ip1, slot4, retry));
+
+    // The slot is given back when its last holder lets go
+    shared_ptr<HMDestinationSlot> copy = slot1;
+    slot1.reset();
+    CPPUNIT_ASSERT(!limiter.acquire(ip, slot3, retry));
+    copy.reset();
+    CPPUNIT_ASSERT(limiter.acquire(ip, slot3, retry));
+
+    // The slots in flight survive a reload of the limits
+    limiter.setConfig(config);
+    CPPUNIT_ASSERT(!limiter.acquire(ip, slot1, retry));
+    slot2.reset();
+    CPPUNIT_ASSERT(limiter.acquire(ip, slot1, retry));
+}
+
+void TESTNAME::test_rate() {
+    HMFakeClock clock;
+    HMMonotonicTime::setFakeClock(&clock);
+    HMDestinationLimiter limiter;
+    HMDestinationLimitConfig config;
+    config.m_rate = 10;
+    limiter.setConfig(config);
+    HMIPAddress ip;
+    ip.set("192.168.1.1");
+    shared_ptr<HMDestinationSlot> slot;
+    HMMonotonicTime retry;
+    HMMonotonicTime now = HMMonotonicTime::now();
+
+    // 10 checks a second, one every 100ms
+    CPPUNIT_ASSERT(limiter.acquire(ip, slot, retry));
+    CPPUNIT_ASSERT(!limiter.acquire(ip, slot, retry));
+    CPPUNIT_ASSERT(now + 100 == retry);
+    clock.advance(99999);
+    CPPUNIT_ASSERT(!limiter.acquire(ip, slot, retry));
+    clock.advance(1);
+    CPPUNIT_ASSERT(limiter.acquire(ip, slot, retry));
+    CPPUNIT_ASSERT(!limiter.acquire(ip, slot, retry));
+
+    // The bucket refills up to the burst while idle
+    config.m_burst = 3;
+    limiter.setConfig(config);
+    clock.advance(10000000);
+    for(uint32_t i = 0; i < 3; i++)
+    {
+        CPPUNIT_ASSERT(limiter.acquire(ip, slot, retry));
+    }
+    CPPUNIT_ASSERT(!limiter.acquire(ip, slot, retry));
+    CPPUNIT_ASSERT(HMMonotonicTime::now() + 100 == retry);
+    clock.advance(100000);
+    CPPUNIT_ASSERT(limiter.acquire(ip, slot, retry));
+    CPPUNIT_ASSERT(!limiter.acquire(ip, slot, retry));
+}
+
+void TESTNAME::test_idle_destinations() {
+    HMFakeClock clock;
+    HMMonotonicTime::setFakeClock(&clock);
+    HMDestinationLimiter limiter;
+    HMDestinationLimitConfig config;
+    config.m_concurrency = 1;
+    config.m_rate = 1;
+    limiter.setConfig(config);
+    HMIPAddress ip, ip1, ip2;
+    ip.set("192.168.1.1");
+    ip1.set("192.168.1.2");
+    ip2.set("192.168.1.3");
+    shared_ptr<HMDestinationSlot> slot, slot1, slot2;
+    HMMonotonicTime retry;
+
+    CPPUNIT_ASSERT(limiter.acquire(ip, slot, retry));
+    CPPUNIT_ASSERT(limiter.acquire(ip1, slot1, retry));
+    CPPUNIT_ASSERT_EQUAL(2, (int)limiter.getNumDestinations());
+
+    // Not dropped before the sweep interval
+    slot.reset();
+    clock.advance(2000000);
+    CPPUNIT_ASSERT(limiter.acquire(ip2, slot2, retry));
+    slot2.reset();
+    CPPUNIT_ASSERT_EQUAL(3, (int)limiter.getNumDestinations());
+    clock.advance(HM_DESTINATION_SWEEP_INTERVAL * 1000 - 2500000);
+    CPPUNIT_ASSERT(limiter.acquire(ip2, slot2, retry));
+    slot2.reset();
+    CPPUNIT_ASSERT_EQUAL(3, (int)limiter.getNumDestinations());
+
+    // The destination with a check in flight and the one with an empty bucket are kept
+    clock.advance(500000);
+    CPPUNIT_ASSERT(!limiter.acquire(ip1, slot, retry));
+    CPPUNIT_ASSERT_EQUAL(2, (int)limiter.getNumDestinations());
+    CPPUNIT_ASSERT(!limiter.acquire(ip2, slot2, retry));
+
+    // Once idle all are dropped
+    slot1.reset();
+    clock.advance(HM_DESTINATION_SWEEP_INTERVAL * 1000);
+    CPPUNIT_ASSERT(limiter.acquire(ip, slot, retry));
+    CPPUNIT_ASSERT_EQUAL(1, (int)limiter.getNumDestinations());
+}
+
+void TESTNAME::test_prefix() {
+    HMDestinationLimiter limiter;
+    HMDestinationLimitConfig config;
+    config.m_concurrency = 1;
+    config.m_prefixIpv4 = 24;
+    config.m_prefixIpv6 = 64;
+    limiter.setConfig(config);
+    HMIPAddress ip, ip1, ip2, ip3;
+    ip.set("192.168.1.1");
+    ip1.set("192.168.1.200");
+    ip2.set("192.168.2.1");
+    ip3.set("2001:db8::1");
+    shared_ptr<HMDestinationSlot> slot, slot1, slot2, slot3, slot4;
+    HMMonotonicTime retry;
+
+    // The addresses in the same prefix share the limit
+    CPPUNIT_ASSERT(limiter.acquire(ip, slot, retry));
+    CPPUNIT_ASSERT(!limiter.acquire(ip1, slot1, retry));
+    CPPUNIT_ASSERT(limiter.acquire(ip2, slot2, retry));
+    CPPUNIT_ASSERT(limiter.acquire(ip3, slot3, retry));
+    ip3.set("2001:db8::ffff:2");
+    CPPUNIT_ASSERT(!limiter.acquire(ip3, slot4, retry));
+    ip3.set("2001:db8:0:1::1");
+    CPPUNIT_ASSERT(limiter.acquire(ip3, slot4, retry));
+}
+
+void TESTNAME::test_resolver() {
+    HMDestinationLimiter limiter;
+    HMDestinationLimitConfig config;
+    config.m_resolverConcurrency = 1;
+    limiter.setConfig(config);
+    HMIPAddress ip;
+    ip.set("192.168.1.1");
+    shared_ptr<HMDestinationSlot> slot, slot1, slot2;
+    HMMonotonicTime retry;
+
+    CPPUNIT_ASSERT(limiter.acquireResolver(slot, retry));
+    CPPUNIT_ASSERT(!limiter.acquireResolver(slot1, retry));
+    // The resolver limits leave the checks alone
+    CPPUNIT_ASSERT(limiter.acquire(ip, slot2, retry));
+    CPPUNIT_ASSERT(slot2.get() == nullptr);
+    slot.reset();
+    CPPUNIT_ASSERT(limiter.acquireResolver(slot1, retry));
+}
+
+void TESTNAME::test_queue_check() {
+    HMFakeClock clock(HMMonotonicTime::now().getMicroseconds());
+    HMMonotonicTime::setFakeClock(&clock);
+    HMEventLoopQueue eventLoop(&m_state);
+    HMDataHostCheck data_host;
+    HMDataCheckParams params;
+    HMDataCheckList check_list;
+    HMWorkQueue queue;
+    HMIPAddress ip;
+    ip.set("192.168.1.1");
+    set<HMIPAddress> ips;
+    ips.insert(ip);
+    string host_group = "HostGroup1";
+    HMDataHostGroup hostGroup(host_group);
+    hostGroup.setCheckType(HM_CHECK_TCP);
+    hostGroup.setCheckPlugin(HM_CHECK_PLUGIN_TCP_RAW);
+    hostGroup.setPort(80);
+    hostGroup.setDualStack(HM_DUALSTACK_BOTH);
+    hostGroup.setCheckInfo("DummyCheckInfo");
+    hostGroup.setRemoteCheck("");
+    hostGroup.setRemoteCheckType(HM_REMOTE_CHECK_NONE);
+    hostGroup.setDistributedFallback(HM_DISTRIBUTED_FALLBACK_NONE);
+    data_host.setCheckParams(hostGroup);
+    for(string host : {"Host1", "Host2", "Host3"})
+    {
+        check_list.insertCheck(host_group, host, data_host, params, ips);
+    }
+    HMDestinationLimitConfig config;
+    config.m_concurrency = 2;
+    queue.getDestinationLimiter().setConfig(config);
+
+    // Three hostnames on the same address, the third check waits in the event loop
+    check_list.queueCheck("Host1", ip, data_host, queue, &eventLoop);
+    check_list.queueCheck("Host2", ip, data_host, queue, &eventLoop);
+    check_list.queueCheck("Host3", ip, data_host, queue, &eventLoop);
+    CPPUNIT_ASSERT_EQUAL((uint32_t)2, queue.queueSize());
+    CPPUNIT_ASSERT_EQUAL((uint64_t)1, eventLoop.getTimeOutQueueSize());
+    string host_name = "Host3";
+    CPPUNIT_ASSERT_EQUAL(HM_SCHEDULE_WORK, check_list.checkNeeded(host_name, ip, data_host));
+
+    // Without an event loop the check is queued regardless
+    check_list.queueCheck("Host3", ip, data_host, queue);
+    CPPUNIT_ASSERT_EQUAL((uint32_t)3, queue.queueSize());
+
+    // Once a check completes the next one goes through
+    unique_ptr<HMWork> work;
+    bool threadStatus = false;
+    CPPUNIT_ASSERT(queue.getWork(work, threadStatus));
+    CPPUNIT_ASSERT(work->m_destinationSlot.get() != nullptr);
+    work.reset();
+    check_list.queueCheck("Host3", ip, data_host, queue, &eventLoop);
+    CPPUNIT_ASSERT_EQUAL((uint32_t)3, queue.queueSize());
+    CPPUNIT_ASSERT_EQUAL((uint64_t)1, eventLoop.getTimeOutQueueSize());
+}
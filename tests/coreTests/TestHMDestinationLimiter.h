@@ -0,0 +1,43 @@
+// Copyright 2019, Oath Inc.
+// Licensed under the terms of the Apache 2.0 license. See LICENSE file in the root of the distribution for licensing details.
+#ifndef TEST_HMDESTINATIONLIMITER_H_
+#define TEST_HMDESTINATIONLIMITER_H_
+
+#include <cppunit/Test.h>
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include "HMDestinationLimiter.h"
+#include "HMStateManager.h"
+
+#define TESTNAME Test_HMDestinationLimiter
+
+class TESTNAME : public CppUnit::TestFixture
+{
+
+    CPPUNIT_TEST_SUITE(TESTNAME);
+    CPPUNIT_TEST(test_defaults);
+    CPPUNIT_TEST(test_concurrency);
+    CPPUNIT_TEST(test_rate);
+    CPPUNIT_TEST(test_idle_destinations);
+    CPPUNIT_TEST(test_prefix);
+    CPPUNIT_TEST(test_resolver);
+    CPPUNIT_TEST(test_queue_check);
+    CPPUNIT_TEST_SUITE_END();
+
+
+public:
+
+    void setUp();
+    void tearDown();
+    void test_defaults();
+    void test_concurrency();
+    void test_rate();
+    void test_idle_destinations();
+    void test_prefix();
+    void test_resolver();
+    void test_queue_check();
+protected:
+    HMStateManager m_state;
+};
+
+#endif /* TEST_HMDESTINATIONLIMITER_H_ */
@@ -39,7 +39,7 @@ void TESTNAME::test_basic_DNS_eventqueue()
     HMDNSLookup dnsHostCheckF(HM_DNS_TYPE_STATIC, false);
     dnsHostCheckF.setPlugin(HM_DNS_PLUGIN_STATIC);
     m_currentState->m_dnsCache.insertDNSEntry(dummy,dnsHostCheckF,300,3000);
-    m_eventQueue->addDNSTimeout(dummy, dnsHostCheckF, HMTimeStamp::now());
+    m_eventQueue->addDNSTimeout(dummy, dnsHostCheckF, HMMonotonicTime::now());
     std::this_thread::sleep_for(2s);
     CPPUNIT_ASSERT_EQUAL(1, (int )m_state.m_workQueue.queueSize());
     unique_ptr<HMWork> work;
@@ -76,7 +76,7 @@ void TESTNAME::test_basic_HC_eventqueue()
     m_currentState->m_checkList.insertCheck("HostGroup1", dummy, check1,
             params,ips);
     m_eventQueue->addHealthCheckTimeout(dummy, ip, check1,
-            HMTimeStamp::now());
+            HMMonotonicTime::now());
     std::this_thread::sleep_for(2s);
     CPPUNIT_ASSERT_EQUAL(1, (int )m_state.m_workQueue.queueSize());
     unique_ptr<HMWork> work;
@@ -129,9 +129,9 @@ void TESTNAME::test_ordering_HC_eventqueue()
 	hostGroup.setDistributedFallback(HM_DISTRIBUTED_FALLBACK_NONE);
 	check1.setCheckParams(hostGroup);
 
-    HMTimeStamp t1 = HMTimeStamp::now() + 1000;
-    HMTimeStamp t2 = t1 - 500;
-    HMTimeStamp t3 = t2 - 1000;
+    HMMonotonicTime t1 = HMMonotonicTime::now() + 1000;
+    HMMonotonicTime t2 = t1 - 500;
+    HMMonotonicTime t3 = t2 - 1000;
 
     m_currentState->m_checkList.insertCheck("HostGroup1", dummy1, check1,
             params,ips0);
@@ -187,8 +187,8 @@ void TESTNAME::test_delay_HC_eventqueue()
 	hostGroup.setRemoteCheckType(HM_REMOTE_CHECK_NONE);
 	hostGroup.setDistributedFallback(HM_DISTRIBUTED_FALLBACK_NONE);
 	check1.setCheckParams(hostGroup);
-    HMTimeStamp t1 = HMTimeStamp::now() + 1000;
-    HMTimeStamp t2 = t1 + 4000;
+    HMMonotonicTime t1 = HMMonotonicTime::now() + 1000;
+    HMMonotonicTime t2 = t1 + 4000;
 
     m_currentState->m_checkList.insertCheck("HostGroup1", dummy1, check1,
             params,ips);
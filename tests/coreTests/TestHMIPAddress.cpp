@@ -379,3 +379,47 @@ void TESTNAME::test_printing() {
     CPPUNIT_ASSERT(ip1.isSet());    
     CPPUNIT_ASSERT_EQUAL(sAddressv6, ip1.toString());
 }
+
+void TESTNAME::test_unspecified() {
+    HMIPAddress ip1;
+    CPPUNIT_ASSERT(!ip1.isUnspecified());
+
+    HMIPAddress ip2(AF_INET);
+    CPPUNIT_ASSERT(ip2.isUnspecified());
+    HMIPAddress ip3(AF_INET6);
+    CPPUNIT_ASSERT(ip3.isUnspecified());
+
+    CPPUNIT_ASSERT(ip1.set("0.0.0.0"));
+    CPPUNIT_ASSERT(ip1.isUnspecified());
+    CPPUNIT_ASSERT(ip1.set("::"));
+    CPPUNIT_ASSERT(ip1.isUnspecified());
+    CPPUNIT_ASSERT(ip1.set("192.168.1.11"));
+    CPPUNIT_ASSERT(!ip1.isUnspecified());
+    CPPUNIT_ASSERT(ip1.set("::1"));
+    CPPUNIT_ASSERT(!ip1.isUnspecified());
+    CPPUNIT_ASSERT(ip1.set("::ffff:0.0.0.0"));
+    CPPUNIT_ASSERT(!ip1.isUnspecified());
+}
+
+void TESTNAME::test_prefix() {
+    HMIPAddress ip1;
+    CPPUNIT_ASSERT(ip1.set("192.168.201.77"));
+    CPPUNIT_ASSERT_EQUAL(string("192.168.201.77"), ip1.getPrefix(32).toString());
+    CPPUNIT_ASSERT_EQUAL(string("192.168.201.77"), ip1.getPrefix(64).toString());
+    CPPUNIT_ASSERT_EQUAL(string("192.168.201.0"), ip1.getPrefix(24).toString());
+    CPPUNIT_ASSERT_EQUAL(string("192.168.200.0"), ip1.getPrefix(23).toString());
+    CPPUNIT_ASSERT_EQUAL(string("0.0.0.0"), ip1.getPrefix(0).toString());
+
+    CPPUNIT_ASSERT(ip1.set("2001:db8:85a3:1234:8a2e:370:7334:1"));
+    CPPUNIT_ASSERT_EQUAL(string("2001:db8:85a3:1234:8a2e:370:7334:1"), ip1.getPrefix(128).toString());
+    CPPUNIT_ASSERT_EQUAL(string("2001:db8:85a3:1234::"), ip1.getPrefix(64).toString());
+    CPPUNIT_ASSERT_EQUAL(string("2001:db8:85a3:1200::"), ip1.getPrefix(56).toString());
+    CPPUNIT_ASSERT_EQUAL(string("2000::"), ip1.getPrefix(4).toString());
+    HMIPAddress ip3;
+    CPPUNIT_ASSERT(ip3.set("2001:db8:85a3:1234::ffff"));
+    CPPUNIT_ASSERT(ip1.getPrefix(64) == ip3.getPrefix(64));
+    CPPUNIT_ASSERT(ip1.getPrefix(65) != ip3.getPrefix(65));
+
+    HMIPAddress ip2;
+    CPPUNIT_ASSERT(!ip2.getPrefix(24).isSet());
+}
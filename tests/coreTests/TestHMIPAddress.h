@@ -17,6 +17,8 @@ class TESTNAME : public CppUnit::TestFixture {
     CPPUNIT_TEST(test_comparisonsv4);
     CPPUNIT_TEST(test_comparisonsv6);
     CPPUNIT_TEST(test_printing);
+    CPPUNIT_TEST(test_unspecified);
+    CPPUNIT_TEST(test_prefix);
     CPPUNIT_TEST_SUITE_END();
 
 
@@ -30,6 +32,8 @@ protected:
     void test_comparisonsv4();
     void test_comparisonsv6();
     void test_printing();
+    void test_unspecified();
+    void test_prefix();
 };
 
 #endif /* TESTHMIPADDRESS_H_ */
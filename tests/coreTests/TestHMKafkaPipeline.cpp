@@ -0,0 +1,349 @@
+// Copyright 2019, Oath Inc.
+// Licensed under the terms of the Apache 2.0 license. See LICENSE file in the root of the distribution for licensing details.
+#include <cstring>
+#include <thread>
+#include <vector>
+#include <string>
+#include "TestHMKafkaPipeline.h"
+#include "common.h"
+
+using namespace std;
+
+CPPUNIT_TEST_SUITE_REGISTRATION(TESTNAME);
+
+//! Local producer standing in for librdkafka.
+class MockProducer : public HMKafkaProducer
+{
+public:
+    MockProducer() :
+        m_blocked(false),
+        m_producing(0),
+        m_queueFull(0),
+        m_autoDeliver(true),
+        m_flushResult(true),
+        m_purged(false),
+        m_reportsPerPoll(0) {}
+
+    HM_PUBLISH_PRODUCE_STATUS produce(char* data, size_t datalen, void* opaque)
+    {
+        unique_lock<mutex> lk(m_mutex);
+        m_producing++;
+        m_cond.notify_all();
+        m_cond.wait(lk, [this]() { return !m_blocked; });
+        m_producing--;
+        if(m_queueFull > 0)
+        {
+            m_queueFull--;
+            return HM_PUBLISH_PRODUCE_QUEUE_FULL;
+        }
+        m_buffers.push_back(data);
+        m_payloads.push_back(string(data, datalen));
+        m_pending.push_back(opaque);
+        return HM_PUBLISH_PRODUCE_OK;
+    }
+
+    void poll(uint32_t timeout)
+    {
+        (void)timeout;
+        vector<void*> pending;
+        bool success = true;
+        {
+            lock_guard<mutex> lk(m_mutex);
+            if(!m_autoDeliver && !m_purged)
+            {
+                return;
+            }
+            success = !m_purged;
+            if(m_reportsPerPoll == 0 || m_reportsPerPoll >= m_pending.size())
+            {
+                pending.swap(m_pending);
+            }
+            else
+            {
+                pending.assign(m_pending.begin(), m_pending.begin() + m_reportsPerPoll);
+                m_pending.erase(m_pending.begin(), m_pending.begin() + m_reportsPerPoll);
+            }
+        }
+        for(auto opaque : pending)
+        {
+            delivered(opaque, success);
+        }
+    }
+
+    bool flush(uint32_t timeout)
+    {
+        {
+            lock_guard<mutex> lk(m_mutex);
+            if(!m_flushResult)
+            {
+                return false;
+            }
+            m_autoDeliver = true;
+        }
+        poll(timeout);
+        return true;
+    }
+
+    void purge()
+    {
+        lock_guard<mutex> lk(m_mutex);
+        m_purged = true;
+    }
+
+    void block(bool blocked)
+    {
+        lock_guard<mutex> lk(m_mutex);
+        m_blocked = blocked;
+        m_cond.notify_all();
+    }
+
+    void waitProducing()
+    {
+        unique_lock<mutex> lk(m_mutex);
+        m_cond.wait(lk, [this]() { return m_producing > 0; });
+    }
+
+    mutex m_mutex;
+    condition_variable m_cond;
+    bool m_blocked;
+    uint32_t m_producing;
+    uint32_t m_queueFull;
+    bool m_autoDeliver;
+    bool m_flushResult;
+    bool m_purged;
+    //! The max number of delivery reports served by a poll, 0 for all.
+    size_t m_reportsPerPoll;
+    vector<char*> m_buffers;
+    vector<string> m_payloads;
+    vector<void*> m_pending;
+};
+
+static unique_ptr<char[]>
+makeMessage(const string& payload)
+{
+    unique_ptr<char[]> data(new char[payload.size()]);
+    memcpy(data.get(), payload.c_str(), payload.size());
+    return data;
+}
+
+static bool
+waitDelivered(HMKafkaPipeline& pipeline, uint64_t count)
+{
+    HMKafkaPipelineStats stats;
+    for(int i = 0; i < 2000; i++)
+    {
+        pipeline.getStats(stats);
+        if(stats.m_delivered + stats.m_failed >= count)
+        {
+            return true;
+        }
+        this_thread::sleep_for(chrono::milliseconds(1));
+    }
+    return false;
+}
+
+void TESTNAME::setUp() {
+    setupCommon();
+}
+
+void TESTNAME::tearDown() {
+    teardownCommon();
+}
+
+void TESTNAME::test_publish_delivered() {
+    auto producer = make_unique<MockProducer>();
+    MockProducer* mock = producer.get();
+    HMKafkaPipelineConfig config;
+    HMKafkaPipeline pipeline(move(producer), config);
+    CPPUNIT_ASSERT(pipeline.start());
+
+    vector<char*> buffers;
+    for(int i = 0; i < 100; i++)
+    {
+        auto data = makeMessage("result" + to_string(i));
+        buffers.push_back(data.get());
+        CPPUNIT_ASSERT(pipeline.enqueue(move(data), 6 + to_string(i).size()));
+    }
+    CPPUNIT_ASSERT(waitDelivered(pipeline, 100));
+
+    HMKafkaPipelineStats stats;
+    pipeline.getStats(stats);
+    CPPUNIT_ASSERT_EQUAL(100, (int)stats.m_enqueued);
+    CPPUNIT_ASSERT_EQUAL(100, (int)stats.m_produced);
+    CPPUNIT_ASSERT_EQUAL(100, (int)stats.m_delivered);
+    CPPUNIT_ASSERT_EQUAL(0, (int)stats.m_dropped);
+    CPPUNIT_ASSERT_EQUAL(0, (int)stats.m_inFlight);
+
+    // The producer got the packed buffers themselves, in order
+    lock_guard<mutex> lk(mock->m_mutex);
+    CPPUNIT_ASSERT(mock->m_buffers == buffers);
+    CPPUNIT_ASSERT(mock->m_payloads[42] == "result42");
+}
+
+void TESTNAME::test_drop_newest() {
+    auto producer = make_unique<MockProducer>();
+    MockProducer* mock = producer.get();
+    HMKafkaPipelineConfig config;
+    config.m_queueSize = 4;
+    HMKafkaPipeline pipeline(move(producer), config);
+    CPPUNIT_ASSERT(pipeline.start());
+
+    // Hold the publisher thread in the producer so the ring fills up
+    mock->block(true);
+    CPPUNIT_ASSERT(pipeline.enqueue(makeMessage("0"), 1));
+    mock->waitProducing();
+    for(int i = 1; i <= 4; i++)
+    {
+        CPPUNIT_ASSERT(pipeline.enqueue(makeMessage(to_string(i)), 1));
+    }
+    CPPUNIT_ASSERT(!pipeline.enqueue(makeMessage("5"), 1));
+
+    HMKafkaPipelineStats stats;
+    pipeline.getStats(stats);
+    CPPUNIT_ASSERT_EQUAL(1, (int)stats.m_dropped);
+    CPPUNIT_ASSERT_EQUAL(4, (int)stats.m_queued);
+
+    mock->block(false);
+    CPPUNIT_ASSERT(waitDelivered(pipeline, 5));
+    lock_guard<mutex> lk(mock->m_mutex);
+    CPPUNIT_ASSERT_EQUAL(5, (int)mock->m_payloads.size());
+    CPPUNIT_ASSERT(mock->m_payloads[4] == "4");
+}
+
+void TESTNAME::test_drop_oldest() {
+    auto producer = make_unique<MockProducer>();
+    MockProducer* mock = producer.get();
+    HMKafkaPipelineConfig config;
+    config.m_queueSize = 4;
+    config.m_dropPolicy = HM_PUBLISH_DROP_OLDEST;
+    HMKafkaPipeline pipeline(move(producer), config);
+    CPPUNIT_ASSERT(pipeline.start());
+
+    mock->block(true);
+    CPPUNIT_ASSERT(pipeline.enqueue(makeMessage("0"), 1));
+    mock->waitProducing();
+    for(int i = 1; i <= 5; i++)
+    {
+        CPPUNIT_ASSERT(pipeline.enqueue(makeMessage(to_string(i)), 1));
+    }
+
+    HMKafkaPipelineStats stats;
+    pipeline.getStats(stats);
+    CPPUNIT_ASSERT_EQUAL(1, (int)stats.m_dropped);
+
+    mock->block(false);
+    CPPUNIT_ASSERT(waitDelivered(pipeline, 5));
+    lock_guard<mutex> lk(mock->m_mutex);
+    vector<string> expected = {"0", "2", "3", "4", "5"};
+    CPPUNIT_ASSERT(mock->m_payloads == expected);
+}
+
+void TESTNAME::test_block() {
+    auto producer = make_unique<MockProducer>();
+    MockProducer* mock = producer.get();
+    HMKafkaPipelineConfig config;
+    config.m_queueSize = 2;
+    config.m_dropPolicy = HM_PUBLISH_BLOCK;
+    config.m_blockTimeout = 50;
+    HMKafkaPipeline pipeline(move(producer), config);
+    CPPUNIT_ASSERT(pipeline.start());
+
+    mock->block(true);
+    CPPUNIT_ASSERT(pipeline.enqueue(makeMessage("0"), 1));
+    mock->waitProducing();
+    CPPUNIT_ASSERT(pipeline.enqueue(makeMessage("1"), 1));
+    CPPUNIT_ASSERT(pipeline.enqueue(makeMessage("2"), 1));
+
+    // Nothing frees up within the block timeout
+    HMTimeStamp start = HMTimeStamp::now();
+    CPPUNIT_ASSERT(!pipeline.enqueue(makeMessage("3"), 1));
+    CPPUNIT_ASSERT(HMTimeStamp::now() - start >= 50);
+
+    // Room frees up while waiting
+    thread unblock([mock]() {
+        this_thread::sleep_for(chrono::milliseconds(10));
+        mock->block(false);
+    });
+    CPPUNIT_ASSERT(pipeline.enqueue(makeMessage("4"), 1));
+    unblock.join();
+
+    CPPUNIT_ASSERT(waitDelivered(pipeline, 4));
+    HMKafkaPipelineStats stats;
+    pipeline.getStats(stats);
+    CPPUNIT_ASSERT_EQUAL(1, (int)stats.m_dropped);
+    CPPUNIT_ASSERT_EQUAL(4, (int)stats.m_delivered);
+}
+
+void TESTNAME::test_producer_queue_full() {
+    auto producer = make_unique<MockProducer>();
+    MockProducer* mock = producer.get();
+    mock->m_queueFull = 2;
+    HMKafkaPipelineConfig config;
+    HMKafkaPipeline pipeline(move(producer), config);
+    CPPUNIT_ASSERT(pipeline.start());
+
+    CPPUNIT_ASSERT(pipeline.enqueue(makeMessage("0"), 1));
+    CPPUNIT_ASSERT(waitDelivered(pipeline, 1));
+
+    HMKafkaPipelineStats stats;
+    pipeline.getStats(stats);
+    CPPUNIT_ASSERT_EQUAL(2, (int)stats.m_retries);
+    CPPUNIT_ASSERT_EQUAL(1, (int)stats.m_delivered);
+    CPPUNIT_ASSERT_EQUAL(0, (int)stats.m_failed);
+}
+
+void TESTNAME::test_shutdown() {
+    // Outstanding results are flushed on shutdown
+    auto producer = make_unique<MockProducer>();
+    MockProducer* mock = producer.get();
+    mock->m_autoDeliver = false;
+    HMKafkaPipelineConfig config;
+    HMKafkaPipeline pipeline(move(producer), config);
+    CPPUNIT_ASSERT(pipeline.start());
+    for(int i = 0; i < 3; i++)
+    {
+        CPPUNIT_ASSERT(pipeline.enqueue(makeMessage(to_string(i)), 1));
+    }
+    pipeline.shutDown();
+    CPPUNIT_ASSERT(!pipeline.enqueue(makeMessage("3"), 1));
+
+    HMKafkaPipelineStats stats;
+    pipeline.getStats(stats);
+    CPPUNIT_ASSERT_EQUAL(3, (int)stats.m_delivered);
+    CPPUNIT_ASSERT_EQUAL(1, (int)stats.m_dropped);
+    CPPUNIT_ASSERT_EQUAL(0, (int)stats.m_inFlight);
+
+    // Results the brokers never take are purged so their buffers are freed
+    producer = make_unique<MockProducer>();
+    mock = producer.get();
+    mock->m_autoDeliver = false;
+    mock->m_flushResult = false;
+    HMKafkaPipeline pipeline2(move(producer), config);
+    CPPUNIT_ASSERT(pipeline2.start());
+    for(int i = 0; i < 3; i++)
+    {
+        CPPUNIT_ASSERT(pipeline2.enqueue(makeMessage(to_string(i)), 1));
+    }
+    pipeline2.shutDown();
+    pipeline2.getStats(stats);
+    CPPUNIT_ASSERT_EQUAL(0, (int)stats.m_delivered);
+    CPPUNIT_ASSERT_EQUAL(3, (int)stats.m_failed);
+    CPPUNIT_ASSERT_EQUAL(0, (int)stats.m_inFlight);
+
+    // The shutdown keeps polling until every purged result is reported
+    producer = make_unique<MockProducer>();
+    mock = producer.get();
+    mock->m_autoDeliver = false;
+    mock->m_flushResult = false;
+    mock->m_reportsPerPoll = 1;
+    HMKafkaPipeline pipeline3(move(producer), config);
+    CPPUNIT_ASSERT(pipeline3.start());
+    for(int i = 0; i < 3; i++)
+    {
+        CPPUNIT_ASSERT(pipeline3.enqueue(makeMessage(to_string(i)), 1));
+    }
+    pipeline3.shutDown();
+    pipeline3.getStats(stats);
+    CPPUNIT_ASSERT_EQUAL(3, (int)stats.m_failed);
+    CPPUNIT_ASSERT_EQUAL(0, (int)stats.m_inFlight);
+}
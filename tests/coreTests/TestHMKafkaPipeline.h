@@ -0,0 +1,40 @@
+// Copyright 2019, Oath Inc.
+// Licensed under the terms of the Apache 2.0 license. See LICENSE file in the root of the distribution for licensing details.
+#ifndef TEST_HMKAFKAPIPELINE_H_
+#define TEST_HMKAFKAPIPELINE_H_
+
+#include <cppunit/Test.h>
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include "HMKafkaPipeline.h"
+
+#define TESTNAME Test_HMKafkaPipeline
+
+class TESTNAME : public CppUnit::TestFixture
+{
+
+    CPPUNIT_TEST_SUITE(TESTNAME);
+    CPPUNIT_TEST(test_publish_delivered);
+    CPPUNIT_TEST(test_drop_newest);
+    CPPUNIT_TEST(test_drop_oldest);
+    CPPUNIT_TEST(test_block);
+    CPPUNIT_TEST(test_producer_queue_full);
+    CPPUNIT_TEST(test_shutdown);
+    CPPUNIT_TEST_SUITE_END();
+
+
+public:
+
+    void setUp();
+    void tearDown();
+    void test_publish_delivered();
+    void test_drop_newest();
+    void test_drop_oldest();
+    void test_block();
+    void test_producer_queue_full();
+    void test_shutdown();
+protected:
+
+};
+
+#endif /* TEST_HMKAFKAPIPELINE_H_ */
@@ -0,0 +1,123 @@
+// Copyright 2019, Oath Inc.
+// Licensed under the terms of the Apache 2.0 license. See LICENSE file in the root of the distribution for licensing details.
+#include "TestHMMonotonicTime.h"
+#include "HMDataCheckParams.h"
+#include "common.h"
+
+using namespace std;
+
+CPPUNIT_TEST_SUITE_REGISTRATION(TESTNAME);
+
+void TESTNAME::setUp() {
+    setupCommon();
+}
+
+void TESTNAME::tearDown() {
+    HMMonotonicTime::setFakeClock(nullptr);
+    teardownCommon();
+}
+
+void TESTNAME::test_fake_clock() {
+    HMMonotonicTime before = HMMonotonicTime::now();
+    CPPUNIT_ASSERT(before.isSet());
+    CPPUNIT_ASSERT(!HMMonotonicTime().isSet());
+
+    HMFakeClock clock(5000000);
+    HMMonotonicTime::setFakeClock(&clock);
+    CPPUNIT_ASSERT_EQUAL((uint64_t)5000000, HMMonotonicTime::now().getMicroseconds());
+    clock.advance(250);
+    CPPUNIT_ASSERT_EQUAL((uint64_t)5000250, HMMonotonicTime::now().getMicroseconds());
+    clock.set(7000000);
+    CPPUNIT_ASSERT_EQUAL((uint64_t)7000, HMMonotonicTime::now().getMilliseconds());
+
+    // Back on the steady clock, which never goes backwards
+    HMMonotonicTime::setFakeClock(nullptr);
+    CPPUNIT_ASSERT(HMMonotonicTime::now() >= before);
+}
+
+void TESTNAME::test_arithmetic() {
+    HMFakeClock clock(10000000);
+    HMMonotonicTime::setFakeClock(&clock);
+    HMMonotonicTime start = HMMonotonicTime::now();
+
+    // Offsets are in milliseconds, differences in milliseconds or microseconds
+    HMMonotonicTime later = start + 1500;
+    CPPUNIT_ASSERT_EQUAL((uint64_t)11500000, later.getMicroseconds());
+    CPPUNIT_ASSERT_EQUAL((uint64_t)1500, later - start);
+    CPPUNIT_ASSERT_EQUAL((uint64_t)1500000, later.microsecondsSince(start));
+    CPPUNIT_ASSERT_EQUAL((uint64_t)0, start.microsecondsSince(later));
+    CPPUNIT_ASSERT_EQUAL((uint64_t)9000000, (start - 1000).getMicroseconds());
+    CPPUNIT_ASSERT(!(start - 20000).isSet());
+    CPPUNIT_ASSERT_EQUAL((uint64_t)137, start.plusMicroseconds(137).microsecondsSince(start));
+
+    // Waits are rounded up so they never end early
+    CPPUNIT_ASSERT_EQUAL((uint64_t)1, start.plusMicroseconds(1).getMillisecondsFromNow());
+    CPPUNIT_ASSERT_EQUAL((uint64_t)1500, later.getMillisecondsFromNow());
+    CPPUNIT_ASSERT_EQUAL((uint64_t)0, (start - 10).getMillisecondsFromNow());
+    struct timeval tv = start.plusMicroseconds(2000300).getTimeout();
+    CPPUNIT_ASSERT_EQUAL(2, (int)tv.tv_sec);
+    CPPUNIT_ASSERT_EQUAL(300, (int)tv.tv_usec);
+    clock.advance(3000000);
+    tv = later.getTimeout();
+    CPPUNIT_ASSERT_EQUAL(0, (int)tv.tv_sec);
+    CPPUNIT_ASSERT_EQUAL(0, (int)tv.tv_usec);
+}
+
+void TESTNAME::test_wall_clock() {
+    HMFakeClock clock(HMTimeStamp::HOURINMS * 1000);
+    HMMonotonicTime::setFakeClock(&clock);
+    HMMonotonicTime now = HMMonotonicTime::now();
+
+    CPPUNIT_ASSERT(!HMMonotonicTime().toWallClock().getTimeSinceEpoch());
+    CPPUNIT_ASSERT(!HMMonotonicTime::fromWallClock(HMTimeStamp()).isSet());
+
+    // The conversions are relative to now, allow for the wall clock moving between the reads
+    HMTimeStamp wallBefore = HMTimeStamp::now();
+    HMTimeStamp wall = (now - 60000).toWallClock();
+    HMTimeStamp wallAfter = HMTimeStamp::now();
+    CPPUNIT_ASSERT(wallBefore - 60000 <= wall);
+    CPPUNIT_ASSERT(wall <= wallAfter - 60000);
+    HMMonotonicTime back = HMMonotonicTime::fromWallClock(wall);
+    CPPUNIT_ASSERT(back <= now - 60000 + 5);
+    CPPUNIT_ASSERT(back + 5 >= now - 60000);
+
+    HMMonotonicTime future = HMMonotonicTime::fromWallClock(HMTimeStamp::now() + 30000);
+    CPPUNIT_ASSERT(future > now + 29000);
+
+    // A wall time older than the start of the clock is long past, it must not be mistaken for unset
+    HMMonotonicTime old = HMMonotonicTime::fromWallClock(HMTimeStamp::now() - 2 * HMTimeStamp::HOURINMS);
+    CPPUNIT_ASSERT(old.isSet());
+    CPPUNIT_ASSERT(old < now - 1000);
+}
+
+void TESTNAME::test_check_schedule() {
+    HMFakeClock clock;
+    HMMonotonicTime::setFakeClock(&clock);
+    HMDataCheckParams params;
+    params.setCheckParameters(0, 0, HM_RT_CONNECT, HM_DEFAULT_SMOOTHING_WINDOW, HM_DEFAULT_GROUP_THRESHOLD,
+            HM_DEFAULT_SLOW_THRESHOLD, HM_DEFAULT_MAX_FLAPS, 1000, 5000, HM_DEFAULT_FLAP_THRESHOLD, 0);
+    HMIPAddress ip;
+    ip.set("10.1.2.3");
+    string hostname = "monotonic.hm.com";
+
+    params.emptyQuery(ip);
+    params.startQuery(ip);
+    HMMonotonicTime start = HMMonotonicTime::now();
+    clock.advance(750);
+    HMMonotonicTime end = HMMonotonicTime::now();
+    params.updateCheck(hostname, ip, HM_RESPONSE_CONNECTED, HM_REASON_SUCCESS, start, end, 80);
+
+    // The sub millisecond response time is kept in microseconds
+    HMDataCheckResult result;
+    CPPUNIT_ASSERT(params.getCheckResult(ip, result));
+    CPPUNIT_ASSERT_EQUAL((uint32_t)750, result.m_responseTimeMicros);
+    CPPUNIT_ASSERT_EQUAL((uint32_t)0, result.m_responseTime);
+
+    // The next check is due a TTL after the check, only when the clock gets there
+    CPPUNIT_ASSERT_EQUAL((end + 5000).getMicroseconds(), params.nextCheckTime(ip).getMicroseconds());
+    CPPUNIT_ASSERT(!params.checkNeeded(ip));
+    clock.advance(4999000);
+    CPPUNIT_ASSERT(!params.checkNeeded(ip));
+    clock.advance(1000);
+    CPPUNIT_ASSERT(params.checkNeeded(ip));
+}
@@ -0,0 +1,36 @@
+// Copyright 2019, Oath Inc.
+// Licensed under the terms of the Apache 2.0 license. See LICENSE file in the root of the distribution for licensing details.
+#ifndef TEST_HMMONOTONICTIME_H_
+#define TEST_HMMONOTONICTIME_H_
+
+#include <cppunit/Test.h>
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include "HMMonotonicTime.h"
+
+#define TESTNAME Test_HMMonotonicTime
+
+class TESTNAME : public CppUnit::TestFixture
+{
+
+    CPPUNIT_TEST_SUITE(TESTNAME);
+    CPPUNIT_TEST(test_fake_clock);
+    CPPUNIT_TEST(test_arithmetic);
+    CPPUNIT_TEST(test_wall_clock);
+    CPPUNIT_TEST(test_check_schedule);
+    CPPUNIT_TEST_SUITE_END();
+
+
+public:
+
+    void setUp();
+    void tearDown();
+    void test_fake_clock();
+    void test_arithmetic();
+    void test_wall_clock();
+    void test_check_schedule();
+protected:
+
+};
+
+#endif /* TEST_HMMONOTONICTIME_H_ */
@@ -29,16 +29,16 @@ void TESTNAME::test_next_query()
     HMRemoteResult results;
     uint64_t query_timeout = 500;
     results.updateTimeouts(100, query_timeout);
-    HMTimeStamp start_time = results.startCheck();
-    HMTimeStamp next_time = results.nextCheckTime();
-    CPPUNIT_ASSERT_EQUAL(start_time.getTimeSinceEpoch() + query_timeout,
-            next_time.getTimeSinceEpoch());
+    HMMonotonicTime start_time = results.startCheck();
+    HMMonotonicTime next_time = results.nextCheckTime();
+    CPPUNIT_ASSERT_EQUAL(start_time.getMilliseconds() + query_timeout,
+            next_time.getMilliseconds());
     CPPUNIT_ASSERT_EQUAL(HM_CHECK_IN_PROGRESS, results.getCheckState());
     std::this_thread::sleep_for(std::chrono::milliseconds(1500));
     next_time = results.nextCheckTime();
     CPPUNIT_ASSERT(
-            (start_time.getTimeSinceEpoch() + query_timeout)
-                    < next_time.getTimeSinceEpoch());
+            (start_time.getMilliseconds() + query_timeout)
+                    < next_time.getMilliseconds());
     CPPUNIT_ASSERT_EQUAL(HM_CHECK_IN_PROGRESS, results.getCheckState());
 }
 
@@ -48,18 +48,18 @@ void TESTNAME::test_next_query1()
     HMRemoteResult results;
     uint64_t remote_timeout = 500;
     results.updateTimeouts(remote_timeout, 100);
-    HMTimeStamp result_time = HMTimeStamp::now();
+    HMMonotonicTime result_time = HMMonotonicTime::now();
     results.finishCheck(true);
-    HMTimeStamp next_time = results.nextCheckTime();
+    HMMonotonicTime next_time = results.nextCheckTime();
     CPPUNIT_ASSERT(
-            (result_time.getTimeSinceEpoch() + remote_timeout)
-                    >= next_time.getTimeSinceEpoch());
+            (result_time.getMilliseconds() + remote_timeout)
+                    >= next_time.getMilliseconds());
     CPPUNIT_ASSERT_EQUAL(HM_CHECK_INACTIVE, results.getCheckState());
     std::this_thread::sleep_for(std::chrono::milliseconds(1500));
     next_time = results.nextCheckTime();
     CPPUNIT_ASSERT(
-            (result_time.getTimeSinceEpoch() + remote_timeout)
-                    < next_time.getTimeSinceEpoch());
+            (result_time.getMilliseconds() + remote_timeout)
+                    < next_time.getMilliseconds());
     CPPUNIT_ASSERT_EQUAL(HM_CHECK_INACTIVE, results.getCheckState());
 }
 
@@ -69,12 +69,12 @@ void TESTNAME::test_next_query2()
     HMRemoteResult results;
     uint64_t remote_timeout = 500;
     results.updateTimeouts(remote_timeout, 100);
-    HMTimeStamp result_time = HMTimeStamp::now();
+    HMMonotonicTime result_time = HMMonotonicTime::now();
     results.finishCheck(false);
-    HMTimeStamp next_time = results.nextCheckTime();
+    HMMonotonicTime next_time = results.nextCheckTime();
     CPPUNIT_ASSERT(
-            (result_time.getTimeSinceEpoch() + remote_timeout)
-                    >= next_time.getTimeSinceEpoch());
+            (result_time.getMilliseconds() + remote_timeout)
+                    >= next_time.getMilliseconds());
     CPPUNIT_ASSERT_EQUAL(HM_CHECK_FAILED, results.getCheckState());
 }
 
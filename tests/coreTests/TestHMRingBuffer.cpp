@@ -0,0 +1,109 @@
+// Copyright 2019, Oath Inc.
+// Licensed under the terms of the Apache 2.0 license. See LICENSE file in the root of the distribution for licensing details.
+#include <thread>
+#include <vector>
+#include "TestHMRingBuffer.h"
+#include "common.h"
+
+using namespace std;
+
+CPPUNIT_TEST_SUITE_REGISTRATION(TESTNAME);
+
+void TESTNAME::setUp() {
+    setupCommon();
+}
+
+void TESTNAME::tearDown() {
+    teardownCommon();
+}
+
+void TESTNAME::test_push_pop() {
+    HMRingBuffer<unique_ptr<int>> ring(5);
+    CPPUNIT_ASSERT_EQUAL(8, (int)ring.capacity());
+    CPPUNIT_ASSERT(ring.empty());
+
+    unique_ptr<int> item;
+    CPPUNIT_ASSERT(!ring.pop(item));
+    for(int i = 0; i < 3; i++)
+    {
+        item = make_unique<int>(i);
+        CPPUNIT_ASSERT(ring.push(item));
+        CPPUNIT_ASSERT(!item);
+    }
+    CPPUNIT_ASSERT_EQUAL(3, (int)ring.size());
+    for(int i = 0; i < 3; i++)
+    {
+        CPPUNIT_ASSERT(ring.pop(item));
+        CPPUNIT_ASSERT_EQUAL(i, *item);
+    }
+    CPPUNIT_ASSERT(ring.empty());
+}
+
+void TESTNAME::test_full() {
+    HMRingBuffer<unique_ptr<int>> ring(4);
+    unique_ptr<int> item;
+    for(int i = 0; i < 4; i++)
+    {
+        item = make_unique<int>(i);
+        CPPUNIT_ASSERT(ring.push(item));
+    }
+
+    // A failed push leaves the item with the caller
+    item = make_unique<int>(4);
+    CPPUNIT_ASSERT(!ring.push(item));
+    CPPUNIT_ASSERT(item);
+    CPPUNIT_ASSERT_EQUAL(4, *item);
+
+    // Wrap around the ring a few times
+    unique_ptr<int> out;
+    for(int i = 4; i < 20; i++)
+    {
+        CPPUNIT_ASSERT(ring.pop(out));
+        CPPUNIT_ASSERT_EQUAL(i - 4, *out);
+        item = make_unique<int>(i);
+        CPPUNIT_ASSERT(ring.push(item));
+    }
+    CPPUNIT_ASSERT_EQUAL(4, (int)ring.size());
+}
+
+void TESTNAME::test_multiple_producers() {
+    const int nProducers = 4;
+    const int nItems = 10000;
+    HMRingBuffer<int> ring(64);
+    vector<thread> producers;
+    for(int p = 0; p < nProducers; p++)
+    {
+        producers.push_back(thread([&ring, p]() {
+            for(int i = 0; i < nItems; i++)
+            {
+                int item = p * nItems + i;
+                while(!ring.push(item))
+                {
+                    this_thread::yield();
+                }
+            }
+        }));
+    }
+
+    // Every item comes out once and each producer's items stay in order
+    vector<int> last(nProducers, -1);
+    int received = 0;
+    int item;
+    while(received < nProducers * nItems)
+    {
+        if(!ring.pop(item))
+        {
+            this_thread::yield();
+            continue;
+        }
+        int p = item / nItems;
+        CPPUNIT_ASSERT(item % nItems > last[p]);
+        last[p] = item % nItems;
+        received++;
+    }
+    for(auto& t : producers)
+    {
+        t.join();
+    }
+    CPPUNIT_ASSERT(ring.empty());
+}
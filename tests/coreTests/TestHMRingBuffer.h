@@ -1,29 +1,34 @@
 // Copyright 2019, Oath Inc.
 // Licensed under the terms of the Apache 2.0 license. See LICENSE file in the root of the distribution for licensing details.
-#ifndef TESTS_STORETESTS_TESTHMSTORAGE_H_
-#define TESTS_STORETESTS_TESTHMSTORAGE_H_
+#ifndef TEST_HMRINGBUFFER_H_
+#define TEST_HMRINGBUFFER_H_
 
 #include <cppunit/Test.h>
 #include <cppunit/TestFixture.h>
 #include <cppunit/extensions/HelperMacros.h>
-#include "HMStateManager.h"
+#include "HMRingBuffer.h"
 
-
-#define TESTNAME Test_HMCommandListenerUtils
+#define TESTNAME Test_HMRingBuffer
 
 class TESTNAME : public CppUnit::TestFixture
 {
 
     CPPUNIT_TEST_SUITE(TESTNAME);
-    CPPUNIT_TEST(test_handlerThreads);
+    CPPUNIT_TEST(test_push_pop);
+    CPPUNIT_TEST(test_full);
+    CPPUNIT_TEST(test_multiple_producers);
     CPPUNIT_TEST_SUITE_END();
 
 
 public:
+
     void setUp();
     void tearDown();
-
+    void test_push_pop();
+    void test_full();
+    void test_multiple_producers();
 protected:
-    void test_handlerThreads();
+
 };
-#endif /* TESTS_STORETESTS_TESTHMSTORAGE_H_ */
+
+#endif /* TEST_HMRINGBUFFER_H_ */
@@ -2064,3 +2064,161 @@ void TESTNAME::test_allcheckResults4()
         CPPUNIT_ASSERT_EQUAL(2000, (int)result->second.getResultTime().getTimeSinceEpoch());
     }
 }
+
+void TESTNAME::test_reload_diff()
+{
+    string hostGroup1 = "hostgroup1";
+    string hostGroup2 = "hostgroup2";
+
+    string hostname1 = "test1.hm.com";
+    string hostname2 = "test2.hm.com";
+    string hostname3 = "test3.hm.com";
+    string hostname4 = "test4.hm.com";
+
+    HMDataHostCheck dataHostCheck1;
+    HMDataHostCheck dataHostCheck2;
+    HMDataCheckParams dataCheckParams1;
+    HMDataCheckParams dataCheckParams2;
+
+    HMDataHostGroup dataHostGroup1(hostGroup1);
+    dataHostGroup1.addHost(hostname1);
+    dataHostGroup1.addHost(hostname2);
+    dataHostGroup1.getHostCheck(dataHostCheck1);
+    dataHostGroup1.getCheckParameters(dataCheckParams1);
+    HMDataHostGroup dataHostGroup2(hostGroup2);
+    dataHostGroup2.addHost(hostname3);
+    dataHostGroup2.setPort(8080);
+    dataHostGroup2.getHostCheck(dataHostCheck2);
+    dataHostGroup2.getCheckParameters(dataCheckParams2);
+    // The reloaded hostgroup2 gets a new host
+    HMDataHostGroup nDataHostGroup2 = dataHostGroup2;
+    nDataHostGroup2.addHost(hostname4);
+
+    HMIPAddress address1;
+    HMIPAddress address2;
+    HMIPAddress address3;
+    address1.set("192.168.0.1");
+    address2.set("192.168.0.2");
+    address3.set("192.168.0.3");
+
+    shared_ptr<HMState> oldstate = make_shared<HMState>();
+    CPPUNIT_ASSERT(oldstate);
+    oldstate->m_hostGroups.insert(make_pair(hostGroup1, dataHostGroup1));
+    oldstate->m_hostGroups.insert(make_pair(hostGroup2, dataHostGroup2));
+    oldstate->hashHostGroupMap();
+    CPPUNIT_ASSERT_EQUAL(2, (int)oldstate->m_checkList.addHostGroup(dataHostGroup1));
+    CPPUNIT_ASSERT_EQUAL(1, (int)oldstate->m_checkList.addHostGroup(dataHostGroup2));
+
+    HMDNSLookup lookup4(HM_DNS_TYPE_LOOKUP, false);
+    vector<pair<string, HMIPAddress>> hosts = { {hostname1, address1}, {hostname2, address2}, {hostname3, address3} };
+    for(auto& host : hosts)
+    {
+        set<HMIPAddress> ips;
+        ips.insert(host.second);
+        oldstate->m_dnsCache.insertDNSEntry(host.first, lookup4, dataHostGroup1.getCheckTimeout(), dataHostGroup1.getCheckTTL());
+        oldstate->m_dnsCache.updateDNSEntry(host.first, lookup4, ips);
+    }
+
+    HMDataCheckResult result1;
+    result1.m_address = address1;
+    result1.m_reason = HM_REASON_CONNECT_TIMEOUT;
+    HMDataCheckResult result2;
+    result2.m_address = address2;
+    result2.m_reason = HM_REASON_CONNECT_FAILURE;
+    HMDataCheckResult result3;
+    result3.m_address = address3;
+    result3.m_reason = HM_REASON_RESPONSE_3XX;
+    {
+        HMCheckHeader header(hostname1, address1, dataHostCheck1, dataCheckParams1);
+        CPPUNIT_ASSERT(oldstate->m_checkList.updateCheck(header, result1));
+    }
+    {
+        HMCheckHeader header(hostname2, address2, dataHostCheck1, dataCheckParams1);
+        CPPUNIT_ASSERT(oldstate->m_checkList.updateCheck(header, result2));
+    }
+    {
+        HMCheckHeader header(hostname3, address3, dataHostCheck2, dataCheckParams2);
+        CPPUNIT_ASSERT(oldstate->m_checkList.updateCheck(header, result3));
+    }
+
+    shared_ptr<HMState> newstate = make_shared<HMState>();
+    CPPUNIT_ASSERT(newstate);
+    newstate->m_datastore = make_unique<TestStorageHostGroup>(&newstate->m_hostGroups, &newstate->m_dnsCache);
+    newstate->m_hostGroups.insert(make_pair(hostGroup1, dataHostGroup1));
+    newstate->m_hostGroups.insert(make_pair(hostGroup2, nDataHostGroup2));
+    newstate->hashHostGroupMap();
+    CPPUNIT_ASSERT_EQUAL(2, (int)newstate->m_checkList.addHostGroup(dataHostGroup1));
+    CPPUNIT_ASSERT_EQUAL(2, (int)newstate->m_checkList.addHostGroup(nDataHostGroup2));
+
+    newstate->diffHostGroups(*oldstate);
+    CPPUNIT_ASSERT_EQUAL(1, (int)newstate->getUnchangedHostGroups().size());
+    CPPUNIT_ASSERT(newstate->getUnchangedHostGroups().count(hostGroup1) == 1);
+
+    newstate->restoreRunningCheckState(oldstate);
+    for(auto& host : hosts)
+    {
+        set<HMIPAddress> ips;
+        CPPUNIT_ASSERT(newstate->m_dnsCache.getAddresses(host.first, HM_DUALSTACK_IPV4_ONLY, lookup4, ips));
+        CPPUNIT_ASSERT_EQUAL(1, (int)ips.size());
+        CPPUNIT_ASSERT(ips.find(host.second) != ips.end());
+    }
+
+    // The results of both the unchanged and the changed host group are restored
+    {
+        HMDataCheckResult result;
+        HMCheckHeader header(hostname1, address1, dataHostCheck1, dataCheckParams1);
+        CPPUNIT_ASSERT(newstate->m_checkList.getCheckResult(header, result));
+        CPPUNIT_ASSERT(result == result1);
+    }
+    {
+        HMDataCheckResult result;
+        HMCheckHeader header(hostname2, address2, dataHostCheck1, dataCheckParams1);
+        CPPUNIT_ASSERT(newstate->m_checkList.getCheckResult(header, result));
+        CPPUNIT_ASSERT(result == result2);
+    }
+    {
+        HMDataCheckResult result;
+        HMCheckHeader header(hostname3, address3, dataHostCheck2, dataCheckParams2);
+        CPPUNIT_ASSERT(newstate->m_checkList.getCheckResult(header, result));
+        CPPUNIT_ASSERT(result == result3);
+    }
+    {
+        std::vector<HMGroupCheckResult> results;
+        CPPUNIT_ASSERT(newstate->m_datastore->getGroupCheckResults(hostGroup1, results));
+        CPPUNIT_ASSERT_EQUAL(2, (int)results.size());
+        CPPUNIT_ASSERT(results[0].m_hostName == hostname1);
+        CPPUNIT_ASSERT(results[0].m_result == result1);
+        CPPUNIT_ASSERT(results[1].m_hostName == hostname2);
+        CPPUNIT_ASSERT(results[1].m_result == result2);
+    }
+}
+
+void TESTNAME::test_state_copy()
+{
+    string hostGroup1 = "hostgroup1";
+    string hostname1 = "test1.hm.com";
+    string hostname2 = "test2.hm.com";
+
+    HMDataHostGroup dataHostGroup1(hostGroup1);
+    dataHostGroup1.addHost(hostname1);
+
+    shared_ptr<HMState> state = make_shared<HMState>();
+    CPPUNIT_ASSERT(state);
+    state->m_hostGroups.insert(make_pair(hostGroup1, dataHostGroup1));
+
+    // The copy shares the host lists
+    shared_ptr<HMState> copy = make_shared<HMState>(*state);
+    CPPUNIT_ASSERT(copy);
+    CPPUNIT_ASSERT(copy->m_hostGroups.find(hostGroup1) != copy->m_hostGroups.end());
+    HMDataHostGroup& srcGroup = state->m_hostGroups.find(hostGroup1)->second;
+    HMDataHostGroup& copyGroup = copy->m_hostGroups.find(hostGroup1)->second;
+    CPPUNIT_ASSERT(copyGroup.getHostList() == srcGroup.getHostList());
+
+    // Changing the copy leaves the source untouched
+    copyGroup.addHost(hostname2);
+    CPPUNIT_ASSERT(copyGroup.getHostList() != srcGroup.getHostList());
+    CPPUNIT_ASSERT_EQUAL(2, (int)copyGroup.getHostList()->size());
+    CPPUNIT_ASSERT_EQUAL(1, (int)srcGroup.getHostList()->size());
+    CPPUNIT_ASSERT(srcGroup.isValidHost(hostname1));
+    CPPUNIT_ASSERT(!srcGroup.isValidHost(hostname2));
+}
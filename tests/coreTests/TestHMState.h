@@ -21,6 +21,8 @@ class TESTNAME : public CppUnit::TestFixture
     CPPUNIT_TEST(test_allcheckResults2);
     CPPUNIT_TEST(test_allcheckResults3);
     CPPUNIT_TEST(test_allcheckResults4);
+    CPPUNIT_TEST(test_reload_diff);
+    CPPUNIT_TEST(test_state_copy);
 
     CPPUNIT_TEST_SUITE_END();
 
@@ -36,6 +38,8 @@ public:
     void test_allcheckResults2();
     void test_allcheckResults3();
     void test_allcheckResults4();
+    void test_reload_diff();
+    void test_state_copy();
 
 protected:
 
@@ -0,0 +1,153 @@
+// Copyright 2019, Oath Inc.
+// Licensed under the terms of the Apache 2.0 license. See LICENSE file in the root of the distribution for licensing details.
+#include <thread>
+#include <vector>
+#include "TestHMStorageQueue.h"
+#include "common.h"
+
+using namespace std;
+
+CPPUNIT_TEST_SUITE_REGISTRATION(TESTNAME);
+
+// The updates are keyed on the tens, so 11 and 12 are for the same host
+static string
+testKey(const int& update)
+{
+    return to_string(update / 10);
+}
+
+void TESTNAME::setUp() {
+    setupCommon();
+}
+
+void TESTNAME::tearDown() {
+    teardownCommon();
+}
+
+void TESTNAME::test_coalesce() {
+    HMStorageQueue<int> queue;
+    queue.setConfig(16, HM_STORAGE_OVERFLOW_BLOCK);
+    vector<int> updates = { 11, 21, 12, 31, 13, 22 };
+    for(auto update : updates)
+    {
+        CPPUNIT_ASSERT(queue.push(update));
+    }
+
+    // The newest update of each key is kept in the place of the first
+    vector<int> batch;
+    CPPUNIT_ASSERT_EQUAL(6, (int)queue.popBatch(batch, 10, testKey));
+    CPPUNIT_ASSERT_EQUAL(3, (int)batch.size());
+    CPPUNIT_ASSERT_EQUAL(13, batch[0]);
+    CPPUNIT_ASSERT_EQUAL(22, batch[1]);
+    CPPUNIT_ASSERT_EQUAL(31, batch[2]);
+    CPPUNIT_ASSERT(queue.empty());
+
+    // The batch size bounds the updates drained
+    batch.clear();
+    for(int i = 0; i < 5; i++)
+    {
+        int update = i * 10;
+        CPPUNIT_ASSERT(queue.push(update));
+    }
+    CPPUNIT_ASSERT_EQUAL(3, (int)queue.popBatch(batch, 3, testKey));
+    CPPUNIT_ASSERT_EQUAL(3, (int)batch.size());
+    CPPUNIT_ASSERT_EQUAL(0, (int)queue.popBatch(batch, 0, testKey));
+
+    HMStorageQueueStats stats;
+    queue.getStats(stats);
+    CPPUNIT_ASSERT_EQUAL(11, (int)stats.m_enqueued);
+    CPPUNIT_ASSERT_EQUAL(3, (int)stats.m_coalesced);
+    CPPUNIT_ASSERT_EQUAL(2, (int)stats.m_batches);
+    CPPUNIT_ASSERT_EQUAL(2, (int)stats.m_queued);
+    CPPUNIT_ASSERT_EQUAL(0, (int)stats.m_dropped);
+}
+
+void TESTNAME::test_drop_oldest() {
+    HMStorageQueue<int> queue;
+    queue.setConfig(4, HM_STORAGE_OVERFLOW_DROP_OLDEST);
+    for(int i = 0; i < 6; i++)
+    {
+        int update = i * 10;
+        CPPUNIT_ASSERT(queue.push(update));
+    }
+
+    vector<int> batch;
+    CPPUNIT_ASSERT_EQUAL(4, (int)queue.popBatch(batch, 10, testKey));
+    CPPUNIT_ASSERT_EQUAL(20, batch[0]);
+    CPPUNIT_ASSERT_EQUAL(50, batch[3]);
+
+    HMStorageQueueStats stats;
+    queue.getStats(stats);
+    CPPUNIT_ASSERT_EQUAL(6, (int)stats.m_enqueued);
+    CPPUNIT_ASSERT_EQUAL(2, (int)stats.m_dropped);
+    CPPUNIT_ASSERT_EQUAL(0, (int)stats.m_blocked);
+}
+
+void TESTNAME::test_block() {
+    HMStorageQueue<int> queue;
+    queue.setConfig(4, HM_STORAGE_OVERFLOW_BLOCK);
+    for(int i = 0; i < 4; i++)
+    {
+        int update = i * 10;
+        CPPUNIT_ASSERT(queue.push(update));
+    }
+
+    // The producer waits until the consumer makes room
+    bool pushed = false;
+    thread producer([&queue, &pushed]() {
+        int update = 40;
+        pushed = queue.push(update);
+    });
+    this_thread::sleep_for(chrono::milliseconds(50));
+    HMStorageQueueStats stats;
+    queue.getStats(stats);
+    CPPUNIT_ASSERT_EQUAL(1, (int)stats.m_blocked);
+    CPPUNIT_ASSERT_EQUAL(4, (int)stats.m_enqueued);
+
+    vector<int> batch;
+    CPPUNIT_ASSERT_EQUAL(2, (int)queue.popBatch(batch, 2, testKey));
+    producer.join();
+    CPPUNIT_ASSERT(pushed);
+
+    batch.clear();
+    CPPUNIT_ASSERT_EQUAL(3, (int)queue.popBatch(batch, 10, testKey));
+    CPPUNIT_ASSERT_EQUAL(40, batch[2]);
+    queue.getStats(stats);
+    CPPUNIT_ASSERT_EQUAL(5, (int)stats.m_enqueued);
+    CPPUNIT_ASSERT_EQUAL(0, (int)stats.m_dropped);
+}
+
+void TESTNAME::test_closed() {
+    HMStorageQueue<int> queue;
+    queue.setConfig(2, HM_STORAGE_OVERFLOW_BLOCK);
+    for(int i = 0; i < 2; i++)
+    {
+        int update = i * 10;
+        CPPUNIT_ASSERT(queue.push(update));
+    }
+
+    // Closing the queue releases a blocked producer which drops its update
+    bool pushed = true;
+    thread producer([&queue, &pushed]() {
+        int update = 20;
+        pushed = queue.push(update);
+    });
+    this_thread::sleep_for(chrono::milliseconds(20));
+    queue.setOpen(false);
+    producer.join();
+    CPPUNIT_ASSERT(!pushed);
+
+    // A closed full queue drops the update right away, it still takes updates while there is room
+    int update = 30;
+    CPPUNIT_ASSERT(!queue.push(update));
+    queue.clear();
+    CPPUNIT_ASSERT(queue.empty());
+    CPPUNIT_ASSERT(queue.push(update));
+
+    HMStorageQueueStats stats;
+    queue.getStats(stats);
+    CPPUNIT_ASSERT_EQUAL(3, (int)stats.m_enqueued);
+    CPPUNIT_ASSERT_EQUAL(2, (int)stats.m_dropped);
+    CPPUNIT_ASSERT_EQUAL(2, (int)stats.m_blocked);
+    CPPUNIT_ASSERT_EQUAL(1, (int)stats.m_queued);
+}
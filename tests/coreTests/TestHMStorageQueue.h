@@ -0,0 +1,36 @@
+// Copyright 2019, Oath Inc.
+// Licensed under the terms of the Apache 2.0 license. See LICENSE file in the root of the distribution for licensing details.
+#ifndef TEST_HMSTORAGEQUEUE_H_
+#define TEST_HMSTORAGEQUEUE_H_
+
+#include <cppunit/Test.h>
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include "HMStorageQueue.h"
+
+#define TESTNAME Test_HMStorageQueue
+
+class TESTNAME : public CppUnit::TestFixture
+{
+
+    CPPUNIT_TEST_SUITE(TESTNAME);
+    CPPUNIT_TEST(test_coalesce);
+    CPPUNIT_TEST(test_drop_oldest);
+    CPPUNIT_TEST(test_block);
+    CPPUNIT_TEST(test_closed);
+    CPPUNIT_TEST_SUITE_END();
+
+
+public:
+
+    void setUp();
+    void tearDown();
+    void test_coalesce();
+    void test_drop_oldest();
+    void test_block();
+    void test_closed();
+protected:
+
+};
+
+#endif /* TEST_HMSTORAGEQUEUE_H_ */
@@ -0,0 +1,137 @@
+// Copyright 2019, Oath Inc.
+// Licensed under the terms of the Apache 2.0 license. See LICENSE file in the root of the distribution for licensing details.
+#include <openssl/evp.h>
+#include <openssl/pem.h>
+#include <openssl/x509.h>
+
+#include "TestHMTLSIdentity.h"
+#include "common.h"
+
+using namespace std;
+
+CPPUNIT_TEST_SUITE_REGISTRATION(TESTNAME);
+
+// Generate a self signed EC key and certificate as PEM
+static void
+generateIdentity(string& keyPem, string& certPem)
+{
+    EVP_PKEY* key = NULL;
+    EVP_PKEY_CTX* pctx = EVP_PKEY_CTX_new_id(EVP_PKEY_EC, NULL);
+    EVP_PKEY_keygen_init(pctx);
+    EVP_PKEY_CTX_set_ec_paramgen_curve_nid(pctx, NID_X9_62_prime256v1);
+    EVP_PKEY_keygen(pctx, &key);
+    EVP_PKEY_CTX_free(pctx);
+
+    X509* cert = X509_new();
+    ASN1_INTEGER_set(X509_get_serialNumber(cert), 1);
+    X509_gmtime_adj(X509_get_notBefore(cert), 0);
+    X509_gmtime_adj(X509_get_notAfter(cert), 3600);
+    X509_set_pubkey(cert, key);
+    X509_NAME* name = X509_get_subject_name(cert);
+    X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC, (const unsigned char*)"netchasm-test", -1, -1, 0);
+    X509_set_issuer_name(cert, name);
+    X509_sign(cert, key, EVP_sha256());
+
+    BIO* bio = BIO_new(BIO_s_mem());
+    PEM_write_bio_PrivateKey(bio, key, NULL, NULL, 0, NULL, NULL);
+    char* data;
+    long len = BIO_get_mem_data(bio, &data);
+    keyPem.assign(data, len);
+    BIO_free(bio);
+
+    bio = BIO_new(BIO_s_mem());
+    PEM_write_bio_X509(bio, cert);
+    len = BIO_get_mem_data(bio, &data);
+    certPem.assign(data, len);
+    BIO_free(bio);
+
+    X509_free(cert);
+    EVP_PKEY_free(key);
+}
+
+void TESTNAME::setUp()
+{
+    generateIdentity(m_key, m_cert);
+    generateIdentity(m_otherKey, m_otherCert);
+}
+
+void TESTNAME::tearDown()
+{
+}
+
+void TESTNAME::test_create()
+{
+    shared_ptr<HMTLSIdentity> identity = HMTLSIdentity::create(m_key, m_cert);
+    CPPUNIT_ASSERT(identity);
+    CPPUNIT_ASSERT(identity->getClientCtx() != nullptr);
+
+    // A certificate followed by its chain
+    identity = HMTLSIdentity::create(m_key, m_cert + m_otherCert);
+    CPPUNIT_ASSERT(identity);
+}
+
+void TESTNAME::test_invalid_pem()
+{
+    CPPUNIT_ASSERT(!HMTLSIdentity::create("", ""));
+    CPPUNIT_ASSERT(!HMTLSIdentity::create("not a key", m_cert));
+    CPPUNIT_ASSERT(!HMTLSIdentity::create(m_key, "not a cert"));
+    CPPUNIT_ASSERT(!HMTLSIdentityCache::instance().get("not a key", "not a cert"));
+}
+
+void TESTNAME::test_key_mismatch()
+{
+    CPPUNIT_ASSERT(!HMTLSIdentity::create(m_key, m_otherCert));
+    CPPUNIT_ASSERT(!HMTLSIdentity::create(m_otherKey, m_cert));
+}
+
+void TESTNAME::test_cache_reuse()
+{
+    HMTLSIdentityCache& cache = HMTLSIdentityCache::instance();
+    shared_ptr<HMTLSIdentity> first = cache.get(m_key, m_cert);
+    shared_ptr<HMTLSIdentity> second = cache.get(m_key, m_cert);
+    CPPUNIT_ASSERT(first);
+    CPPUNIT_ASSERT(first == second);
+    CPPUNIT_ASSERT_EQUAL(1, (int)cache.size());
+}
+
+void TESTNAME::test_cache_rotate()
+{
+    HMTLSIdentityCache& cache = HMTLSIdentityCache::instance();
+    shared_ptr<HMTLSIdentity> old = cache.get(m_key, m_cert);
+    shared_ptr<HMTLSIdentity> rotated = cache.get(m_otherKey, m_otherCert);
+    CPPUNIT_ASSERT(old);
+    CPPUNIT_ASSERT(rotated);
+    CPPUNIT_ASSERT(old != rotated);
+    CPPUNIT_ASSERT_EQUAL(2, (int)cache.size());
+
+    // The old identity stays usable while a check still holds it
+    SSL* ssl = SSL_new(old->getClientCtx());
+    CPPUNIT_ASSERT(ssl != nullptr);
+    old.reset();
+    CPPUNIT_ASSERT_EQUAL(1, (int)cache.size());
+    SSL_free(ssl);
+
+    rotated.reset();
+    CPPUNIT_ASSERT_EQUAL(0, (int)cache.size());
+}
+
+void TESTNAME::test_use_identity()
+{
+    shared_ptr<HMTLSIdentity> identity = HMTLSIdentity::create(m_key, m_cert + m_otherCert);
+    CPPUNIT_ASSERT(identity);
+
+    SSL_CTX* ctx = SSL_CTX_new(SSLv23_client_method());
+    CPPUNIT_ASSERT(identity->useIdentity(ctx));
+    CPPUNIT_ASSERT_EQUAL(1, SSL_CTX_check_private_key(ctx));
+    CPPUNIT_ASSERT_EQUAL(CURLE_OK, HMTLSIdentity::curlSslCtxCallback(nullptr, ctx, identity.get()));
+
+    SSL* ssl = SSL_new(ctx);
+    SSL_CTX_free(ctx);
+    CPPUNIT_ASSERT(identity->useIdentity(ssl));
+    CPPUNIT_ASSERT_EQUAL(1, SSL_check_private_key(ssl));
+
+    // The connection keeps its own references on the identity
+    identity.reset();
+    CPPUNIT_ASSERT(SSL_get_certificate(ssl) != nullptr);
+    SSL_free(ssl);
+}
@@ -0,0 +1,43 @@
+// Copyright 2019, Oath Inc.
+// Licensed under the terms of the Apache 2.0 license. See LICENSE file in the root of the distribution for licensing details.
+#ifndef TEST_HMTLSIDENTITY_H_
+#define TEST_HMTLSIDENTITY_H_
+
+#include <cppunit/Test.h>
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include "HMTLSIdentity.h"
+
+#define TESTNAME Test_HMTLSIdentity
+
+class TESTNAME : public CppUnit::TestFixture
+{
+
+    CPPUNIT_TEST_SUITE(TESTNAME);
+    CPPUNIT_TEST(test_create);
+    CPPUNIT_TEST(test_invalid_pem);
+    CPPUNIT_TEST(test_key_mismatch);
+    CPPUNIT_TEST(test_cache_reuse);
+    CPPUNIT_TEST(test_cache_rotate);
+    CPPUNIT_TEST(test_use_identity);
+    CPPUNIT_TEST_SUITE_END();
+
+
+public:
+
+    void setUp();
+    void tearDown();
+    void test_create();
+    void test_invalid_pem();
+    void test_key_mismatch();
+    void test_cache_reuse();
+    void test_cache_rotate();
+    void test_use_identity();
+protected:
+    std::string m_key;
+    std::string m_cert;
+    std::string m_otherKey;
+    std::string m_otherCert;
+};
+
+#endif /* TEST_HMTLSIDENTITY_H_ */
@@ -82,3 +82,106 @@ void TESTNAME::test_idle_threadpool()
     std::this_thread::sleep_for(std::chrono::milliseconds(250));
     CPPUNIT_ASSERT_EQUAL(3,(int)tp->countIdle());
 }
+
+/*
+ * The controller grows the pool when the queue wait goes over the target,
+ * and grows it faster when the wait is far over the target.
+ */
+void TESTNAME::test_controller_grow()
+{
+    HMThreadPoolConfig config;
+    config.m_targetWait = 100;
+    config.m_growthPercent = 25;
+    HMThreadPoolController controller;
+    controller.setConfig(config, 2, 40, 10, 4);
+
+    vector<uint64_t> histogram(HM_WORK_QUEUE_WAIT_BUCKETS, 0);
+    // All the waits under 16ms, busy workers but nothing queued
+    histogram[4] = 100;
+    CPPUNIT_ASSERT_EQUAL(16, (int)HMThreadPoolController::getPercentile(histogram, 99));
+    CPPUNIT_ASSERT_EQUAL(8, (int)controller.update(8, histogram, 90, 0));
+
+    // p99 at 256ms, over the target
+    histogram[8] = 2;
+    CPPUNIT_ASSERT_EQUAL(256, (int)HMThreadPoolController::getPercentile(histogram, 99));
+    CPPUNIT_ASSERT_EQUAL(10, (int)controller.update(8, histogram, 90, 0));
+
+    // The queued work sets the growth from the work per thread ratio
+    CPPUNIT_ASSERT_EQUAL(13, (int)controller.update(8, histogram, 90, 20));
+
+    // p99 at 1024ms, far over the target doubles the growth
+    histogram[8] = 0;
+    histogram[10] = 2;
+    CPPUNIT_ASSERT_EQUAL(12, (int)controller.update(8, histogram, 90, 0));
+
+    // Never over the max
+    CPPUNIT_ASSERT_EQUAL(40, (int)controller.update(38, histogram, 90, 0));
+
+    HMAPIThreadInfo info;
+    controller.getStats(info);
+    CPPUNIT_ASSERT_EQUAL(40, (int)info.m_targetThreads);
+    CPPUNIT_ASSERT_EQUAL(1024, (int)info.m_queueWaitP99);
+    CPPUNIT_ASSERT_EQUAL(16, (int)info.m_queueWaitP50);
+    CPPUNIT_ASSERT_EQUAL(4, (int)info.m_numGrows);
+    CPPUNIT_ASSERT_EQUAL(0, (int)info.m_numShrinks);
+}
+
+/*
+ * The controller only shrinks the pool after it was underused for the shrink intervals
+ * and never under the minimum.
+ */
+void TESTNAME::test_controller_shrink()
+{
+    HMThreadPoolConfig config;
+    config.m_targetWait = 100;
+    config.m_lowUtilisation = 30;
+    config.m_shrinkIntervals = 3;
+    HMThreadPoolController controller;
+    controller.setConfig(config, 5, 40, 10, 4);
+
+    vector<uint64_t> histogram(HM_WORK_QUEUE_WAIT_BUCKETS, 0);
+    histogram[0] = 100;
+    CPPUNIT_ASSERT_EQUAL(20, (int)controller.update(20, histogram, 10, 0));
+    CPPUNIT_ASSERT_EQUAL(20, (int)controller.update(20, histogram, 10, 0));
+    CPPUNIT_ASSERT_EQUAL(18, (int)controller.update(20, histogram, 10, 0));
+
+    // A busy interval resets the count
+    CPPUNIT_ASSERT_EQUAL(18, (int)controller.update(18, histogram, 10, 0));
+    CPPUNIT_ASSERT_EQUAL(18, (int)controller.update(18, histogram, 50, 0));
+    CPPUNIT_ASSERT_EQUAL(18, (int)controller.update(18, histogram, 10, 0));
+    CPPUNIT_ASSERT_EQUAL(18, (int)controller.update(18, histogram, 10, 0));
+    CPPUNIT_ASSERT_EQUAL(17, (int)controller.update(18, histogram, 10, 0));
+
+    // Never under the min
+    for(int i = 0; i < 3; i++)
+    {
+        controller.update(5, histogram, 0, 0);
+    }
+    CPPUNIT_ASSERT_EQUAL(5, (int)controller.update(5, histogram, 0, 0));
+}
+
+/*
+ * The thread info reports the pool and the resource usage.
+ */
+void TESTNAME::test_thread_info()
+{
+    tp->resize(3);
+    std::this_thread::sleep_for(std::chrono::milliseconds(250));
+    HMAPIThreadInfo info;
+    tp->getThreadInfo(info);
+    CPPUNIT_ASSERT_EQUAL(3, (int)info.m_numThreads);
+    CPPUNIT_ASSERT_EQUAL(3, (int)info.m_numIdleThreads);
+
+    uint64_t residentMemory = 0;
+    uint64_t openFiles = 0;
+    CPPUNIT_ASSERT(HMThreadPool::getResourceUsage(residentMemory, openFiles));
+    CPPUNIT_ASSERT(residentMemory > 0);
+    CPPUNIT_ASSERT(openFiles > 0);
+
+    // Idle workers are not recycled
+    tp->recycleThreads();
+    std::this_thread::sleep_for(std::chrono::milliseconds(250));
+    tp->getThreadInfo(info);
+    CPPUNIT_ASSERT_EQUAL(3, (int)info.m_numThreads);
+    CPPUNIT_ASSERT_EQUAL(1, (int)info.m_numRecycles);
+}
@@ -40,7 +40,11 @@ class TESTNAME: public CppUnit::TestFixture
     CPPUNIT_TEST_SUITE(TESTNAME);
     CPPUNIT_TEST(test_basic_threadpool);
     CPPUNIT_TEST(test_resize_threadpool);
-    CPPUNIT_TEST(test_idle_threadpool);CPPUNIT_TEST_SUITE_END();
+    CPPUNIT_TEST(test_idle_threadpool);
+    CPPUNIT_TEST(test_controller_grow);
+    CPPUNIT_TEST(test_controller_shrink);
+    CPPUNIT_TEST(test_thread_info);
+    CPPUNIT_TEST_SUITE_END();
 
 public:
 
@@ -49,6 +53,9 @@ public:
     void test_basic_threadpool();
     void test_resize_threadpool();
     void test_idle_threadpool();
+    void test_controller_grow();
+    void test_controller_shrink();
+    void test_thread_info();
 protected:
     std::unique_ptr<HMStateManager> sm;
     std::unique_ptr<HMThreadPool> tp;
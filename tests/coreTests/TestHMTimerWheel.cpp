@@ -0,0 +1,140 @@
+// Copyright 2019, Oath Inc.
+// Licensed under the terms of the Apache 2.0 license. See LICENSE file in the root of the distribution for licensing details.
+#include "TestHMTimerWheel.h"
+#include "common.h"
+
+using namespace std;
+
+CPPUNIT_TEST_SUITE_REGISTRATION(TESTNAME);
+
+void TESTNAME::setUp() {
+    setupCommon();
+}
+
+void TESTNAME::tearDown() {
+    teardownCommon();
+}
+
+void TESTNAME::test_basic_expire() {
+    HMTimerWheel<int> wheel;
+    vector<int> expired;
+    HMMonotonicTime now = HMMonotonicTime::now();
+    HMMonotonicTime next;
+
+    CPPUNIT_ASSERT(!wheel.nextExpiration(next));
+    wheel.schedule(1, now + 100);
+    CPPUNIT_ASSERT_EQUAL(1, (int)wheel.size());
+    CPPUNIT_ASSERT(wheel.nextExpiration(next));
+    CPPUNIT_ASSERT(next <= now + 100 + HM_TIMER_WHEEL_RESOLUTION);
+
+    // Never expire early
+    wheel.expire(now + 99, expired);
+    CPPUNIT_ASSERT(expired.empty());
+    wheel.expire(now + 100 + HM_TIMER_WHEEL_RESOLUTION, expired);
+    CPPUNIT_ASSERT_EQUAL(1, (int)expired.size());
+    CPPUNIT_ASSERT_EQUAL(1, expired[0]);
+    CPPUNIT_ASSERT(wheel.empty());
+}
+
+void TESTNAME::test_ordering() {
+    HMTimerWheel<int> wheel;
+    vector<int> expired;
+    HMMonotonicTime now = HMMonotonicTime::now();
+
+    wheel.schedule(3, now + 1500);
+    wheel.schedule(1, now + 500);
+    wheel.schedule(4, now + 2000);
+    wheel.schedule(2, now + 1000);
+    wheel.expire(now + 2100, expired);
+    CPPUNIT_ASSERT_EQUAL(4, (int)expired.size());
+    for(int i = 0; i < 4; i++)
+    {
+        CPPUNIT_ASSERT_EQUAL(i + 1, expired[i]);
+    }
+}
+
+void TESTNAME::test_past_timeout() {
+    HMTimerWheel<int> wheel;
+    vector<int> expired;
+    HMMonotonicTime now = HMMonotonicTime::now();
+
+    wheel.schedule(1, now + 5000);
+    wheel.schedule(2, now - 1000);
+    wheel.expire(now + HM_TIMER_WHEEL_RESOLUTION, expired);
+    CPPUNIT_ASSERT_EQUAL(1, (int)expired.size());
+    CPPUNIT_ASSERT_EQUAL(2, expired[0]);
+    CPPUNIT_ASSERT_EQUAL(1, (int)wheel.size());
+}
+
+void TESTNAME::test_cascade() {
+    HMTimerWheel<int> wheel;
+    vector<int> expired;
+    HMMonotonicTime now = HMMonotonicTime::now();
+
+    // One timeout on each level of the wheel
+    uint64_t delays[] = {1000, 60000, 3600000, 7 * HMTimeStamp::HOURINMS};
+    for(int i = 0; i < 4; i++)
+    {
+        wheel.schedule(i, now + delays[i]);
+    }
+    HMMonotonicTime next;
+    for(int i = 0; i < 4; i++)
+    {
+        wheel.expire(now + delays[i] - 1, expired);
+        CPPUNIT_ASSERT_EQUAL(i, (int)expired.size());
+        wheel.expire(now + delays[i] + HM_TIMER_WHEEL_RESOLUTION, expired);
+        CPPUNIT_ASSERT_EQUAL(i + 1, (int)expired.size());
+        CPPUNIT_ASSERT_EQUAL(i, expired[i]);
+        if(i < 3)
+        {
+            // The next service time must never be past the next timeout
+            CPPUNIT_ASSERT(wheel.nextExpiration(next));
+            CPPUNIT_ASSERT(next <= now + delays[i + 1] + HM_TIMER_WHEEL_RESOLUTION);
+        }
+    }
+    CPPUNIT_ASSERT(wheel.empty());
+}
+
+void TESTNAME::test_cancel() {
+    HMTimerWheel<int> wheel;
+    vector<int> expired;
+    HMMonotonicTime now = HMMonotonicTime::now();
+
+    HMTimerWheel<int>::Handle h1 = wheel.schedule(1, now + 100);
+    HMTimerWheel<int>::Handle h2 = wheel.schedule(2, now + 100);
+    HMTimerWheel<int>::Handle h3 = wheel.schedule(3, now + 100000);
+    CPPUNIT_ASSERT(wheel.cancel(h2));
+    CPPUNIT_ASSERT(!wheel.cancel(h2));
+    CPPUNIT_ASSERT(wheel.cancel(h3));
+    CPPUNIT_ASSERT(!wheel.cancel(HMTimerWheel<int>::INVALID_HANDLE));
+
+    // A reused slot must not be cancelled by a stale handle
+    HMTimerWheel<int>::Handle h4 = wheel.schedule(4, now + 200);
+    CPPUNIT_ASSERT(h4 != h2 && h4 != h3);
+    CPPUNIT_ASSERT(!wheel.cancel(h3));
+
+    wheel.expire(now + 300, expired);
+    CPPUNIT_ASSERT_EQUAL(2, (int)expired.size());
+    CPPUNIT_ASSERT_EQUAL(1, expired[0]);
+    CPPUNIT_ASSERT_EQUAL(4, expired[1]);
+    CPPUNIT_ASSERT(!wheel.cancel(h1));
+}
+
+void TESTNAME::test_cancel_if() {
+    HMTimerWheel<int> wheel;
+    vector<int> expired;
+    HMMonotonicTime now = HMMonotonicTime::now();
+
+    for(int i = 0; i < 100; i++)
+    {
+        wheel.schedule(i, now + 10 * i);
+    }
+    CPPUNIT_ASSERT_EQUAL(50, (int)wheel.cancelIf([](int& value) { return value % 2 == 0; }));
+    CPPUNIT_ASSERT_EQUAL(50, (int)wheel.size());
+    wheel.expire(now + 1000, expired);
+    CPPUNIT_ASSERT_EQUAL(50, (int)expired.size());
+    for(auto value : expired)
+    {
+        CPPUNIT_ASSERT(value % 2 == 1);
+    }
+}
@@ -0,0 +1,40 @@
+// Copyright 2019, Oath Inc.
+// Licensed under the terms of the Apache 2.0 license. See LICENSE file in the root of the distribution for licensing details.
+#ifndef TEST_HMTIMERWHEEL_H_
+#define TEST_HMTIMERWHEEL_H_
+
+#include <cppunit/Test.h>
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include "HMTimerWheel.h"
+
+#define TESTNAME Test_HMTimerWheel
+
+class TESTNAME : public CppUnit::TestFixture
+{
+
+    CPPUNIT_TEST_SUITE(TESTNAME);
+    CPPUNIT_TEST(test_basic_expire);
+    CPPUNIT_TEST(test_ordering);
+    CPPUNIT_TEST(test_past_timeout);
+    CPPUNIT_TEST(test_cascade);
+    CPPUNIT_TEST(test_cancel);
+    CPPUNIT_TEST(test_cancel_if);
+    CPPUNIT_TEST_SUITE_END();
+
+
+public:
+
+    void setUp();
+    void tearDown();
+    void test_basic_expire();
+    void test_ordering();
+    void test_past_timeout();
+    void test_cascade();
+    void test_cancel();
+    void test_cancel_if();
+protected:
+
+};
+
+#endif /* TEST_HMTIMERWHEEL_H_ */
@@ -5,6 +5,7 @@
 #include "HMStateManager.h"
 #include "HMEventLoopQueue.h"
 #include "HMWorkDNSLookupStatic.h"
+#include "HMThreadPoolController.h"
 #include "common.h"
 #include <unistd.h>
 
@@ -18,6 +19,7 @@ void TESTNAME::setUp() {
 }
 
 void TESTNAME::tearDown() {
+    HMMonotonicTime::setFakeClock(nullptr);
     teardownCommon();
 }
 
@@ -130,3 +132,294 @@ void TESTNAME::test_multi_insert() {
     CPPUNIT_ASSERT_EQUAL(3, (int )work_queue->queueSize());
     delete work_queue;
 }
+
+void TESTNAME::test_early_continuation() {
+    const string hostname = "dummy.hm.com";
+    const HMIPAddress ip;
+    const HMDataHostCheck host_check;
+    HMDNSLookup dnsHostCheckF(HM_DNS_TYPE_STATIC, false);
+    HMWorkDNSLookupStatic dns_lookup(hostname, ip, host_check, dnsHostCheckF);
+    HMWorkQueue work_queue;
+
+    // Continuation completes after the work was parked
+    std::unique_ptr<HMWork> work = std::make_unique<HMWorkDNSLookupStatic>(dns_lookup);
+    HMWork* key = work.get();
+    work_queue.insertMap(work);
+    CPPUNIT_ASSERT_EQUAL(0, (int )work_queue.queueSize());
+    work_queue.addWork(key);
+    CPPUNIT_ASSERT_EQUAL(1, (int )work_queue.queueSize());
+
+    // Continuation completes before the work was parked
+    work = std::make_unique<HMWorkDNSLookupStatic>(dns_lookup);
+    key = work.get();
+    work_queue.addWork(key);
+    CPPUNIT_ASSERT_EQUAL(1, (int )work_queue.queueSize());
+    work_queue.insertMap(work);
+    CPPUNIT_ASSERT_EQUAL(2, (int )work_queue.queueSize());
+}
+
+void TESTNAME::test_work_stealing() {
+    const HMIPAddress ip;
+    const HMDataHostCheck host_check;
+    HMDNSLookup dnsHostCheckF(HM_DNS_TYPE_STATIC, false);
+    HMWorkQueue work_queue(4);
+    CPPUNIT_ASSERT_EQUAL(4, (int )work_queue.getShardCount());
+
+    // All the work lands in the shard of this thread
+    const int nWork = 1000;
+    for(int i = 0; i < nWork; i++)
+    {
+        HMWorkDNSLookupStatic dns_lookup("dummy" + to_string(i) + ".hm.com", ip, host_check, dnsHostCheckF);
+        std::unique_ptr<HMWork> work = std::make_unique<HMWorkDNSLookupStatic>(dns_lookup);
+        work_queue.insertWork(work);
+    }
+    CPPUNIT_ASSERT_EQUAL(nWork, (int )work_queue.queueSize());
+
+    // The other threads have to steal it
+    std::atomic<int> nTaken(0);
+    auto worker = [&work_queue, &nTaken]() {
+        bool threadStatus = false;
+        std::unique_ptr<HMWork> work;
+        while(nTaken < nWork && work_queue.getWork(work, threadStatus))
+        {
+            nTaken++;
+        }
+    };
+    std::thread t1(worker);
+    std::thread t2(worker);
+    std::thread t3(worker);
+    while(nTaken < nWork)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    work_queue.shutdown();
+    t1.join();
+    t2.join();
+    t3.join();
+    CPPUNIT_ASSERT_EQUAL(nWork, (int )nTaken);
+    CPPUNIT_ASSERT_EQUAL(0, (int )work_queue.queueSize());
+}
+
+void TESTNAME::test_queue_wait() {
+    const string hostname = "dummy.hm.com";
+    const HMIPAddress ip;
+    const HMDataHostCheck host_check;
+    HMDNSLookup dnsHostCheckF(HM_DNS_TYPE_STATIC, false);
+    HMWorkDNSLookupStatic dns_lookup(hostname, ip, host_check, dnsHostCheckF);
+    HMWorkQueue work_queue(1);
+    HMFakeClock clock;
+    HMMonotonicTime::setFakeClock(&clock);
+
+    // One work order queued 100ms ago, one queued now
+    std::unique_ptr<HMWork> work = std::make_unique<HMWorkDNSLookupStatic>(dns_lookup);
+    work->m_start = HMMonotonicTime::now();
+    work->m_end = work->m_start + 10000;
+    work_queue.insertWork(work);
+    clock.advance(100 * 1000);
+    work = std::make_unique<HMWorkDNSLookupStatic>(dns_lookup);
+    work->m_start = HMMonotonicTime::now();
+    work->m_end = work->m_start + 10000;
+    work_queue.insertWork(work);
+
+    std::unique_ptr<HMWork> work_temp;
+    bool threadStatus = false;
+    CPPUNIT_ASSERT(work_queue.getWork(work_temp, threadStatus));
+    CPPUNIT_ASSERT(work_queue.getWork(work_temp, threadStatus));
+
+    vector<uint64_t> histogram;
+    work_queue.collectQueueWait(histogram);
+    CPPUNIT_ASSERT_EQUAL(HM_WORK_QUEUE_WAIT_BUCKETS, (int)histogram.size());
+    uint64_t total = 0;
+    for(auto count : histogram)
+    {
+        total += count;
+    }
+    CPPUNIT_ASSERT_EQUAL(2, (int)total);
+    // 100ms falls in the 64 to 128ms bucket
+    CPPUNIT_ASSERT_EQUAL(1, (int)histogram[7]);
+    CPPUNIT_ASSERT_EQUAL(1, (int)histogram[0]);
+
+    // The histogram is reset on collection
+    histogram.clear();
+    work_queue.collectQueueWait(histogram);
+    for(auto count : histogram)
+    {
+        CPPUNIT_ASSERT_EQUAL(0, (int)count);
+    }
+}
+
+/*
+ * A completed asynchronous check is queued again long after its start,
+ * only its time in the queue counts and the pool does not grow.
+ */
+void TESTNAME::test_continuation_queue_wait() {
+    const string hostname = "dummy.hm.com";
+    const HMIPAddress ip;
+    const HMDataHostCheck host_check;
+    HMDNSLookup dnsHostCheckF(HM_DNS_TYPE_STATIC, false);
+    HMWorkDNSLookupStatic dns_lookup(hostname, ip, host_check, dnsHostCheckF);
+    HMWorkQueue work_queue(1);
+    HMFakeClock clock;
+    HMMonotonicTime::setFakeClock(&clock);
+
+    // The check started 10s ago and its result just came back
+    clock.advance(10000 * 1000);
+    std::unique_ptr<HMWork> work = std::make_unique<HMWorkDNSLookupStatic>(dns_lookup);
+    work->m_start = HMMonotonicTime::now() - 10000;
+    work->m_end = work->m_start + 20000;
+    work->m_workStatus = HM_WORK_COMPLETE;
+    work_queue.insertWork(work);
+    clock.advance(2 * 1000);
+
+    std::unique_ptr<HMWork> work_temp;
+    bool threadStatus = false;
+    CPPUNIT_ASSERT(work_queue.getWork(work_temp, threadStatus));
+
+    vector<uint64_t> histogram;
+    work_queue.collectQueueWait(histogram);
+    // 2ms falls in the 2 to 4ms bucket
+    CPPUNIT_ASSERT_EQUAL(1, (int)histogram[2]);
+    CPPUNIT_ASSERT_EQUAL(4, (int)HMThreadPoolController::getPercentile(histogram, 99));
+
+    HMThreadPoolConfig config;
+    config.m_targetWait = 100;
+    HMThreadPoolController controller;
+    controller.setConfig(config, 2, 40, 10, 4);
+    CPPUNIT_ASSERT_EQUAL(8, (int)controller.update(8, histogram, 90, 0));
+}
+
+void TESTNAME::test_work_class() {
+    const HMIPAddress ip;
+    HMDataHostCheck host_check;
+    HMDNSLookup dnsHostCheckF(HM_DNS_TYPE_STATIC, false);
+    HMWorkDNSLookupStatic dns_lookup("dummy.hm.com", ip, host_check, dnsHostCheckF);
+    CPPUNIT_ASSERT_EQUAL(HM_WORK_CLASS_DNSLOOKUP, dns_lookup.getWorkClass());
+
+    // A class set on the work is kept
+    HMWorkDNSLookupStatic control_lookup("dummy.hm.com", ip, host_check, dnsHostCheckF);
+    control_lookup.m_workClass = HM_WORK_CLASS_CONTROL;
+    CPPUNIT_ASSERT_EQUAL(HM_WORK_CLASS_CONTROL, control_lookup.getWorkClass());
+
+    // The host check takes the priority of its group
+    HMDataHostGroup group("group.hm.com");
+    group.setPriority(HM_WORK_PRIORITY_HIGH);
+    host_check.setCheckParams(group);
+    CPPUNIT_ASSERT_EQUAL(HM_WORK_PRIORITY_HIGH, host_check.getPriority());
+}
+
+void TESTNAME::test_weighted_dequeue() {
+    const HMIPAddress ip;
+    const HMDataHostCheck host_check;
+    HMDNSLookup dnsHostCheckF(HM_DNS_TYPE_STATIC, false);
+    HMWorkDNSLookupStatic dns_lookup("dummy.hm.com", ip, host_check, dnsHostCheckF);
+    HMWorkQueue work_queue(1);
+    HMWorkQueueConfig config;
+    config.m_weights[HM_WORK_CLASS_HEALTHCHECK] = 3;
+    config.m_weights[HM_WORK_CLASS_DNSLOOKUP] = 1;
+    config.m_starvationTime = 0;
+    work_queue.setConfig(config);
+
+    // A burst of DNS lookups queued ahead of the health checks
+    for(int i = 0; i < 40; i++)
+    {
+        std::unique_ptr<HMWork> work = std::make_unique<HMWorkDNSLookupStatic>(dns_lookup);
+        work->m_workClass = (i < 20) ? HM_WORK_CLASS_DNSLOOKUP : HM_WORK_CLASS_HEALTHCHECK;
+        work_queue.insertWork(work);
+    }
+
+    // The health checks are served 3 to 1 and interleaved with the lookups
+    std::unique_ptr<HMWork> work;
+    bool threadStatus = false;
+    int numHealthCheck = 0;
+    for(int i = 0; i < 16; i++)
+    {
+        CPPUNIT_ASSERT(work_queue.getWork(work, threadStatus));
+        if(work->getWorkClass() == HM_WORK_CLASS_HEALTHCHECK)
+        {
+            numHealthCheck++;
+        }
+        if(i % 4 == 3)
+        {
+            CPPUNIT_ASSERT_EQUAL((i + 1) * 3 / 4, numHealthCheck);
+        }
+    }
+
+    // Once the health checks are done the lookups get all the workers
+    while(work_queue.queueSize() > 0)
+    {
+        CPPUNIT_ASSERT(work_queue.getWork(work, threadStatus));
+    }
+    CPPUNIT_ASSERT_EQUAL(HM_WORK_CLASS_DNSLOOKUP, work->getWorkClass());
+}
+
+void TESTNAME::test_starvation() {
+    HMFakeClock clock(HMMonotonicTime::now().getMicroseconds());
+    HMMonotonicTime::setFakeClock(&clock);
+    const HMIPAddress ip;
+    const HMDataHostCheck host_check;
+    HMDNSLookup dnsHostCheckF(HM_DNS_TYPE_STATIC, false);
+    HMWorkDNSLookupStatic dns_lookup("dummy.hm.com", ip, host_check, dnsHostCheckF);
+    HMWorkQueue work_queue(1);
+    HMWorkQueueConfig config;
+    config.m_weights[HM_WORK_CLASS_CONTROL] = 1000;
+    config.m_weights[HM_WORK_CLASS_AUXFETCH] = 1;
+    config.m_starvationTime = 100;
+    work_queue.setConfig(config);
+
+    std::unique_ptr<HMWork> work = std::make_unique<HMWorkDNSLookupStatic>(dns_lookup);
+    work->m_workClass = HM_WORK_CLASS_AUXFETCH;
+    work_queue.insertWork(work);
+    clock.advance(50000);
+    for(int i = 0; i < 10; i++)
+    {
+        work = std::make_unique<HMWorkDNSLookupStatic>(dns_lookup);
+        work->m_workClass = HM_WORK_CLASS_CONTROL;
+        work_queue.insertWork(work);
+    }
+
+    // The heavy class is served first
+    bool threadStatus = false;
+    CPPUNIT_ASSERT(work_queue.getWork(work, threadStatus));
+    CPPUNIT_ASSERT_EQUAL(HM_WORK_CLASS_CONTROL, work->getWorkClass());
+
+    // Past the starvation time the light class is served ahead of the weights
+    clock.advance(100000);
+    CPPUNIT_ASSERT(work_queue.getWork(work, threadStatus));
+    CPPUNIT_ASSERT_EQUAL(HM_WORK_CLASS_AUXFETCH, work->getWorkClass());
+
+    HMAPIWorkQueueInfo info;
+    work_queue.getWorkQueueInfo(info);
+    CPPUNIT_ASSERT_EQUAL(1, (int)info.m_classes[HM_WORK_CLASS_AUXFETCH].m_starved);
+    CPPUNIT_ASSERT_EQUAL(150000, (int)info.m_classes[HM_WORK_CLASS_AUXFETCH].m_totalWait);
+    CPPUNIT_ASSERT_EQUAL(9, (int)info.m_classes[HM_WORK_CLASS_CONTROL].m_depth);
+    CPPUNIT_ASSERT_EQUAL(100000, (int)info.m_classes[HM_WORK_CLASS_CONTROL].m_oldestWait);
+}
+
+void TESTNAME::test_workqueue_info() {
+    const HMIPAddress ip;
+    const HMDataHostCheck host_check;
+    HMDNSLookup dnsHostCheckF(HM_DNS_TYPE_STATIC, false);
+    HMWorkDNSLookupStatic dns_lookup("dummy.hm.com", ip, host_check, dnsHostCheckF);
+    HMWorkQueue work_queue(2);
+    for(int i = 0; i < 3; i++)
+    {
+        std::unique_ptr<HMWork> work = std::make_unique<HMWorkDNSLookupStatic>(dns_lookup);
+        work_queue.insertWork(work);
+    }
+    std::unique_ptr<HMWork> work;
+    bool threadStatus = false;
+    CPPUNIT_ASSERT(work_queue.getWork(work, threadStatus));
+
+    HMAPIWorkQueueInfo info;
+    work_queue.getWorkQueueInfo(info);
+    CPPUNIT_ASSERT_EQUAL(2, (int)info.m_queueSize);
+    CPPUNIT_ASSERT_EQUAL(2, (int)info.m_numShards);
+    CPPUNIT_ASSERT_EQUAL(HM_DEFAULT_WORK_STARVATION_TIME, (int)info.m_starvationTime);
+    CPPUNIT_ASSERT_EQUAL(HM_WORK_CLASS_COUNT, (int)info.m_classes.size());
+    const HMAPIWorkClassInfo& dns = info.m_classes[HM_WORK_CLASS_DNSLOOKUP];
+    CPPUNIT_ASSERT_EQUAL(string("dns"), dns.m_name);
+    CPPUNIT_ASSERT_EQUAL(HM_DEFAULT_WORK_WEIGHT_DNSLOOKUP, (int)dns.m_weight);
+    CPPUNIT_ASSERT_EQUAL(2, (int)dns.m_depth);
+    CPPUNIT_ASSERT_EQUAL(1, (int)dns.m_dequeued);
+    CPPUNIT_ASSERT_EQUAL(0, (int)info.m_classes[HM_WORK_CLASS_HEALTHCHECK].m_depth);
+}
@@ -19,6 +19,14 @@ class TESTNAME : public CppUnit::TestFixture
     CPPUNIT_TEST(test_notify_workqueue);
     CPPUNIT_TEST(test_shutdown_workqueue);
     CPPUNIT_TEST(test_multi_insert);
+    CPPUNIT_TEST(test_early_continuation);
+    CPPUNIT_TEST(test_work_stealing);
+    CPPUNIT_TEST(test_queue_wait);
+    CPPUNIT_TEST(test_continuation_queue_wait);
+    CPPUNIT_TEST(test_work_class);
+    CPPUNIT_TEST(test_weighted_dequeue);
+    CPPUNIT_TEST(test_starvation);
+    CPPUNIT_TEST(test_workqueue_info);
     CPPUNIT_TEST_SUITE_END();
 
 
@@ -31,6 +39,14 @@ public:
     void test_notify_workqueue();
     void test_shutdown_workqueue();
     void test_multi_insert();
+    void test_early_continuation();
+    void test_work_stealing();
+    void test_queue_wait();
+    void test_continuation_queue_wait();
+    void test_work_class();
+    void test_weighted_dequeue();
+    void test_starvation();
+    void test_workqueue_info();
 protected:
 
 };
@@ -6,10 +6,53 @@
 #include "HMLogText.h"
 #include "HMLogSyslog.h"
 #include <unistd.h>
+#include <sys/syscall.h>
+#include <thread>
+#include <vector>
+#include <chrono>
 CPPUNIT_TEST_SUITE_REGISTRATION(TESTNAME);
 
 int vsyslogInvoked = 0;
 
+// Log keeping the lines in memory, the writer can be held to back up the queue.
+class TestHMLogCapture : public HMLogBase
+{
+public:
+    TestHMLogCapture() :
+        m_hold(false) {};
+
+    void rotate() {}
+
+    void hold(bool hold)
+    {
+        std::lock_guard<std::mutex> lk(m_lineMutex);
+        m_hold = hold;
+        m_lineCond.notify_all();
+    }
+
+    uint32_t getQueued()
+    {
+        return m_queued;
+    }
+
+    std::vector<std::string> m_lines;
+    std::vector<pid_t> m_tids;
+    std::mutex m_lineMutex;
+    std::condition_variable m_lineCond;
+    bool m_hold;
+
+protected:
+    bool openLog(std::string) { return true; }
+    void closeLog() {}
+    void writeLog(LogEntry* entry)
+    {
+        std::unique_lock<std::mutex> lk(m_lineMutex);
+        m_lines.push_back(std::string(entry->entry, entry->length));
+        m_tids.push_back(entry->tid);
+        m_lineCond.wait(lk, [this](){ return !m_hold; });
+    }
+};
+
 void TESTNAME::setUp()
 {
     hlog = nullptr;
@@ -97,6 +140,98 @@ void TESTNAME::test_syslog_notcalled()
   CPPUNIT_ASSERT_EQUAL(0, vsyslogInvoked);
 }
 
+void TESTNAME::test_deferred_format()
+{
+    TestHMLogCapture log;
+    log.initLogging(HM_LOG_DEBUG, true);
+    hlog = &log;
+
+    std::string host = "host1.test.com";
+    char name[16] = "array";
+    uint64_t big = 12345678901234ULL;
+    HMLog(HM_LOG_INFO, "plain line");
+    HMLog(HM_LOG_INFO, "%s checked in %lu ms with %d", host.c_str(), big, -42);
+    HMLog(HM_LOG_INFO, "[%5.2f] [%x] [%c] [%%] [%-6s] [%s]", 3.14159, 255u, 'z', name, host);
+    HMLog(HM_LOG_INFO, "[%*d] [%.*s] [%u] [%hhu]", 4, 7, 3, "abcdef", -1, 258);
+    HMLog(HM_LOG_DEBUG2, "filtered %d", 1);
+    log.log(HM_LOG_WARNING, "direct %d %s", 5, "call");
+    log.shutDownLogging();
+    hlog = nullptr;
+
+    CPPUNIT_ASSERT_EQUAL((size_t)6, log.m_lines.size());
+    CPPUNIT_ASSERT_EQUAL(std::string("Begin Logging"), log.m_lines[0]);
+    CPPUNIT_ASSERT_EQUAL(std::string("plain line"), log.m_lines[1]);
+    CPPUNIT_ASSERT_EQUAL(std::string("host1.test.com checked in 12345678901234 ms with -42"), log.m_lines[2]);
+    CPPUNIT_ASSERT_EQUAL(std::string("[ 3.14] [ff] [z] [%] [array ] [host1.test.com]"), log.m_lines[3]);
+    CPPUNIT_ASSERT_EQUAL(std::string("[   7] [abc] [4294967295] [2]"), log.m_lines[4]);
+    CPPUNIT_ASSERT_EQUAL(std::string("direct 5 call"), log.m_lines[5]);
+    CPPUNIT_ASSERT_EQUAL((pid_t)syscall(SYS_gettid), log.m_tids[1]);
+}
+
+void TESTNAME::test_threaded_loggers()
+{
+    TestHMLogCapture log;
+    log.initLogging(HM_LOG_INFO, true);
+    hlog = &log;
+
+    std::vector<std::thread> threads;
+    for(int t = 0; t < 4; t++)
+    {
+        threads.push_back(std::thread([t](){
+            for(int i = 0; i < 500; i++)
+            {
+                HMLog(HM_LOG_INFO, "thread %d line %d", t, i);
+            }
+        }));
+    }
+    for(auto& t : threads)
+    {
+        t.join();
+    }
+    log.shutDownLogging();
+    hlog = nullptr;
+
+    CPPUNIT_ASSERT_EQUAL((size_t)2001, log.m_lines.size());
+    // The lines of a thread keep their order
+    std::vector<int> next(4, 0);
+    for(size_t i = 1; i < log.m_lines.size(); i++)
+    {
+        int t, line;
+        CPPUNIT_ASSERT_EQUAL(2, sscanf(log.m_lines[i].c_str(), "thread %d line %d", &t, &line));
+        CPPUNIT_ASSERT_EQUAL(next[t], line);
+        next[t]++;
+    }
+}
+
+void TESTNAME::test_dropped_logs()
+{
+    TestHMLogCapture log;
+    log.hold(true);
+    log.initLogging(HM_LOG_INFO, true);
+    log.setMaxLogQueue(10);
+    hlog = &log;
+
+    // The writer holds on the first line, so 9 more fit in the queue
+    for(int i = 0; i < 15; i++)
+    {
+        HMLog(HM_LOG_INFO, "line %d", i);
+    }
+    log.hold(false);
+    for(int i = 0; i < 200 && log.getQueued() > 0; i++)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    HMLog(HM_LOG_INFO, "replaced");
+    HMLog(HM_LOG_INFO, "last");
+    log.shutDownLogging();
+    hlog = nullptr;
+
+    CPPUNIT_ASSERT_EQUAL((size_t)12, log.m_lines.size());
+    CPPUNIT_ASSERT_EQUAL(std::string("line 8"), log.m_lines[9]);
+    CPPUNIT_ASSERT_EQUAL(std::string("Max log queue length exceeded 7 logs dropped"), log.m_lines[10]);
+    CPPUNIT_ASSERT_EQUAL(std::string("last"), log.m_lines[11]);
+}
+
 void syslog(int priority, const char *format, ...)
 {
   // No point in calling the actual vsyslog, whether the
@@ -19,6 +19,9 @@ class TESTNAME : public CppUnit::TestFixture
     CPPUNIT_TEST(test_syslog_level);
     CPPUNIT_TEST(test_syslog_called);
     CPPUNIT_TEST(test_syslog_notcalled);
+    CPPUNIT_TEST(test_deferred_format);
+    CPPUNIT_TEST(test_threaded_loggers);
+    CPPUNIT_TEST(test_dropped_logs);
     CPPUNIT_TEST_SUITE_END();
 
 
@@ -30,6 +33,9 @@ public:
     void test_syslog_level();
     void test_syslog_called();
     void test_syslog_notcalled();
+    void test_deferred_format();
+    void test_threaded_loggers();
+    void test_dropped_logs();
 protected:
 
 };
@@ -191,4 +191,9 @@ bool TestStorage::commitAuxInfo()
     return false;
 }
 
+bool TestStorage::pendingCommits()
+{
+    return m_commitCalls > 0;
+}
+
 
@@ -127,6 +127,7 @@ protected:
     bool closeBackend();
     bool commitHealthCheck();
     bool commitAuxInfo();
+    bool pendingCommits();
 };
 
 
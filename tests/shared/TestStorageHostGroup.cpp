@@ -52,7 +52,7 @@ TestStorageHostGroup::getGroupInfoBackend(const string& hostGroupName, HMDataHos
 bool
 TestStorageHostGroup::test_manual_add(HMGroupCheckUpdate& update)
 {
-    hostGroupResults.insert(make_pair(update.m_hostGroup, HMGroupCheckResult(update.m_hostName, update.m_address, update.m_result)));
+    hostGroupResults[update.m_hostGroup].insert(HMGroupCheckResult(update.m_hostName, update.m_address, update.m_result));
     groupNames.insert(update.m_hostGroup);
     return true;
 }
@@ -128,16 +128,17 @@ bool TestStorageHostGroup::removeGroupInfo(const std::string& hostGroupName)
 bool TestStorageHostGroup::storeHostGroupCheckResults(
         const std::string& hostGroup)
 {
+    groupCommits++;
     return true;
 }
 
 bool TestStorageHostGroup::getHostGroupCheckResults(const std::string& hostGroup)
 {
     groupNames.insert(hostGroup);
-    auto range = hostGroupResults.equal_range(hostGroup);
-    for (auto it = range.first; it != range.second; ++it)
+    auto group = hostGroupResults.find(hostGroup);
+    if (group != hostGroupResults.end())
     {
-        m_hostGroupResults.insert(*it);
+        m_hostGroupResults[hostGroup] = group->second;
     }
     return true;
 }
@@ -150,10 +151,10 @@ bool TestStorageHostGroup::getHostGroupCheckResults(
     {
         return false;
     }
-    auto range = hostGroupResults.equal_range(hostGroup);
-    for (auto it = range.first; it != range.second; ++it)
+    auto group = hostGroupResults.find(hostGroup);
+    if (group != hostGroupResults.end())
     {
-        results.push_back(it->second);
+        results.insert(results.end(), group->second.begin(), group->second.end());
     }
     return true;
 }
@@ -10,7 +10,7 @@ class TestStorageHostGroup : public HMStorageHostGroup
 {
 public:
     TestStorageHostGroup(HMDataHostGroupMap* hostMap, HMDNSCache* dnsCache) :
-        HMStorageHostGroup(hostMap, dnsCache), hostgroupmap(hostMap) {}
+        HMStorageHostGroup(hostMap, dnsCache), hostgroupmap(hostMap), groupCommits(0) {}
 
     bool test_getInternalHostGroupInfo(const std::string& hostGroupName, const HMDataHostGroup* &hostGroup)
         { return getInternalHostGroupInfo(hostGroupName, hostGroup); }
@@ -18,6 +18,8 @@ public:
     uint32_t test_getInternalHostGroupResults(const std::string& hostGroupName, std::vector<HMGroupCheckResult>& results)
         { return  getInternalCheckResults(hostGroupName, results); }
 
+    uint32_t test_getGroupCommits() const { return groupCommits; }
+
     bool test_manual_add(HMGroupCheckUpdate& update);
     void populateHostGroup(bool toLocal);
     bool getHostGroupNames(std::set<std::string>& groupNames);
@@ -66,8 +68,9 @@ protected:
             std::vector<HMGroupAuxResult>& results);
     bool removeHostGroupGroupAuxInfo(const std::string& hostGroup);
     std::set<std::string> groupNames;
-    std::multimap<std::string, HMGroupCheckResult> hostGroupResults;
+    std::unordered_map<std::string, HMGroupCheckResults> hostGroupResults;
     HMDataHostGroupMap *hostgroupmap;
+    uint32_t groupCommits;
 
 };
 
@@ -1132,3 +1132,244 @@ TESTNAME::test_HMStorageHostGroup_InternalFunctions()
     CPPUNIT_ASSERT(entry1 && entry2 && entry3 && entry4);
     delete storageHost;
 }
+
+void
+TESTNAME::test_HMStorageHostGroup_ResultIndex()
+{
+    string hostname1 = "test1.hm.com";
+    string hostname2 = "test2.hm.com";
+
+    HMIPAddress unresolved(AF_INET);
+    HMIPAddress address1;
+    HMIPAddress address2;
+    HMIPAddress address6;
+    address1.set("192.168.0.1");
+    address2.set("192.168.0.2");
+    address6.set("fad0::1");
+
+    HMDataCheckResult result1;
+    HMDataCheckResult result2;
+    HMDataCheckResult result3;
+    result1.m_numChecks = 1;
+    result2.m_numChecks = 2;
+    result3.m_numChecks = 3;
+
+    HMGroupCheckResults results;
+    results.insert(HMGroupCheckResult(hostname1, unresolved, result1));
+    results.insert(HMGroupCheckResult(hostname2, address2, result2));
+    CPPUNIT_ASSERT_EQUAL(2, (int)results.size());
+    CPPUNIT_ASSERT_EQUAL(2, (int)results.hostCount());
+
+    // An update matches the result stored before the address of its family was known
+    CPPUNIT_ASSERT(results.find(hostname1, address1) == nullptr);
+    CPPUNIT_ASSERT(results.findUpdate(hostname1, address6) == nullptr);
+    HMGroupCheckResult* entry = results.findUpdate(hostname1, address1);
+    CPPUNIT_ASSERT(entry != nullptr);
+    CPPUNIT_ASSERT(entry->m_result == result1);
+    results.setAddress(entry, address1);
+    CPPUNIT_ASSERT(results.find(hostname1, address1) == entry);
+    CPPUNIT_ASSERT(results.find(hostname1, unresolved) == nullptr);
+
+    results.insert(HMGroupCheckResult(hostname1, address6, result3));
+    CPPUNIT_ASSERT_EQUAL(3, (int)results.size());
+    CPPUNIT_ASSERT_EQUAL(2, (int)results.hostCount());
+
+    // The same host and address replaces the result
+    results.insert(HMGroupCheckResult(hostname2, address2, result3));
+    CPPUNIT_ASSERT_EQUAL(3, (int)results.size());
+    CPPUNIT_ASSERT(results.find(hostname2, address2)->m_result == result3);
+
+    // Erasing keeps the other results reachable
+    CPPUNIT_ASSERT(results.erase(hostname1, address1));
+    CPPUNIT_ASSERT(!results.erase(hostname1, address1));
+    CPPUNIT_ASSERT_EQUAL(2, (int)results.size());
+    CPPUNIT_ASSERT_EQUAL(2, (int)results.hostCount());
+    CPPUNIT_ASSERT(results.find(hostname1, address6)->m_address == address6);
+    CPPUNIT_ASSERT(results.find(hostname2, address2)->m_address == address2);
+
+    CPPUNIT_ASSERT(results.erase(hostname1, address6));
+    CPPUNIT_ASSERT_EQUAL(1, (int)results.hostCount());
+
+    results.clear();
+    CPPUNIT_ASSERT_EQUAL(0, (int)results.size());
+    CPPUNIT_ASSERT_EQUAL(0, (int)results.hostCount());
+}
+
+void
+TESTNAME::test_HMStorageHostGroup_BatchCommit()
+{
+    HMDataHostGroupMap hostGroupMap;
+
+    string hostGroup1 = "hostgroup1";
+    string hostGroup2 = "hostgroup2";
+    string hostname1_1 = "test1_1.hm.com";
+    string hostname1_2 = "test1_2.hm.com";
+    string hostname2_1 = "test2_1.hm.com";
+    string hostname2_2 = "test2_2.hm.com";
+
+    HMDataHostGroup dataHostGroup1(hostGroup1);
+    dataHostGroup1.addHost(hostname1_1);
+    dataHostGroup1.addHost(hostname1_2);
+    dataHostGroup1.setDualStack(HM_DUALSTACK_BOTH);
+    HMDataHostGroup dataHostGroup2(hostGroup2);
+    dataHostGroup2.addHost(hostname2_1);
+    dataHostGroup2.addHost(hostname2_2);
+    dataHostGroup2.setDualStack(HM_DUALSTACK_BOTH);
+    hostGroupMap.insert(make_pair(hostGroup1, dataHostGroup1));
+    hostGroupMap.insert(make_pair(hostGroup2, dataHostGroup2));
+
+    HMDataHostCheck hostCheck;
+    HMDataCheckParams checkParams1;
+    dataHostGroup1.getCheckParameters(checkParams1);
+    checkParams1.addHostGroup(hostGroup1);
+    HMDataCheckParams checkParams2;
+    dataHostGroup2.getCheckParameters(checkParams2);
+    checkParams2.addHostGroup(hostGroup2);
+
+    vector<string> hostnames = {hostname1_1, hostname1_2, hostname2_1, hostname2_2};
+    vector<HMIPAddress> addresses4(4);
+    vector<HMIPAddress> addresses6(4);
+    HMDNSCache dnsCache;
+    HMDNSLookup dnsHostCheck(HM_DNS_TYPE_LOOKUP, false);
+    HMDNSLookup dnsHostCheckv6(HM_DNS_TYPE_LOOKUP, true);
+    for(uint32_t i = 0; i < hostnames.size(); i++)
+    {
+        addresses4[i].set("192.168.0." + to_string(i + 1));
+        addresses6[i].set("fad0::" + to_string(i + 1));
+        set<HMIPAddress> addresses;
+        addresses.insert(addresses4[i]);
+        dnsCache.insertDNSEntry(hostnames[i], dnsHostCheck, 10000, 10000);
+        dnsCache.updateDNSEntry(hostnames[i], dnsHostCheck, addresses);
+        addresses.clear();
+        addresses.insert(addresses6[i]);
+        dnsCache.insertDNSEntry(hostnames[i], dnsHostCheckv6, 10000, 10000);
+        dnsCache.updateDNSEntry(hostnames[i], dnsHostCheckv6, addresses);
+    }
+
+    TestStorageHostGroup* storageHost = new TestStorageHostGroup(&hostGroupMap, &dnsCache);
+    storageHost->updateHealthCheckCommitPolicy(HM_STORAGE_COMMIT_ALWAYS);
+
+    // Queue the updates before the store thread starts so they are drained in a single batch
+    HMDataCheckResult result;
+    for(uint32_t i = 0; i < hostnames.size(); i++)
+    {
+        HMDataCheckParams& checkParams = (i < 2) ? checkParams1 : checkParams2;
+        result.m_numChecks = i + 1;
+        CPPUNIT_ASSERT(storageHost->storeCheckResult(hostnames[i], addresses4[i], hostCheck, checkParams, result));
+        CPPUNIT_ASSERT(storageHost->storeCheckResult(hostnames[i], addresses6[i], hostCheck, checkParams, result));
+    }
+    storageHost->openStore(false);
+    storageHost->closeStore();
+
+    // Each host group is written once for the whole batch
+    CPPUNIT_ASSERT_EQUAL(2, (int)storageHost->test_getGroupCommits());
+
+    vector<HMGroupCheckResult> results;
+    CPPUNIT_ASSERT(storageHost->getGroupCheckResults(hostGroup1, results));
+    CPPUNIT_ASSERT_EQUAL(4, (int)results.size());
+    CPPUNIT_ASSERT(storageHost->getGroupCheckResults(hostGroup2, results));
+    CPPUNIT_ASSERT_EQUAL(4, (int)results.size());
+    for(auto& it : results)
+    {
+        CPPUNIT_ASSERT(!it.m_backendStale);
+    }
+
+    delete storageHost;
+}
+
+void
+TESTNAME::test_HMStorageHostGroup_ResultDelta()
+{
+    string hostname1 = "test1.hm.com";
+    string hostname2 = "test2.hm.com";
+
+    HMIPAddress address1;
+    HMIPAddress address2;
+    address1.set("192.168.0.1");
+    address2.set("192.168.0.2");
+
+    HMDataCheckResult result1;
+    HMDataCheckResult result2;
+    result1.m_numChecks = 1;
+    result2.m_numChecks = 2;
+    result2.m_status = HM_HOST_STATUS_UP;
+
+    HMGroupCheckResults results;
+    results.insert(HMGroupCheckResult(hostname1, address1, result1));
+    results.insert(HMGroupCheckResult(hostname2, address2, result1));
+
+    // A peer without a sequence gets everything
+    uint64_t epoch = 0;
+    uint64_t sequence = 0;
+    vector<HMGroupCheckResult> delta;
+    CPPUNIT_ASSERT(!results.getDelta(epoch, sequence, delta));
+    CPPUNIT_ASSERT(epoch != 0);
+    CPPUNIT_ASSERT_EQUAL(2, (int)delta.size());
+
+    // Nothing changed, nothing is sent
+    CPPUNIT_ASSERT(results.getDelta(epoch, sequence, delta));
+    CPPUNIT_ASSERT_EQUAL(0, (int)delta.size());
+
+    // Only the changed result is sent, an unchanged update does not move the sequence
+    uint64_t last = sequence;
+    results.setResult(results.find(hostname1, address1), result1);
+    CPPUNIT_ASSERT(results.getDelta(epoch, sequence, delta));
+    CPPUNIT_ASSERT_EQUAL(0, (int)delta.size());
+    CPPUNIT_ASSERT_EQUAL(last, sequence);
+
+    // New check times and counters are not sent either, but move the revision for the stores
+    HMDataCheckResult recheck = result1;
+    recheck.m_numChecks = 5;
+    recheck.m_responseTime = 20;
+    recheck.m_checkTime = HMTimeStamp::now();
+    uint64_t revision = results.find(hostname1, address1)->m_revision;
+    results.setResult(results.find(hostname1, address1), recheck);
+    CPPUNIT_ASSERT(results.getDelta(epoch, sequence, delta));
+    CPPUNIT_ASSERT_EQUAL(0, (int)delta.size());
+    CPPUNIT_ASSERT_EQUAL(last, sequence);
+    CPPUNIT_ASSERT(results.find(hostname1, address1)->m_revision != revision);
+    CPPUNIT_ASSERT(results.find(hostname1, address1)->m_result == recheck);
+    results.insert(HMGroupCheckResult(hostname1, address1, result1));
+    CPPUNIT_ASSERT(results.getDelta(epoch, sequence, delta));
+    CPPUNIT_ASSERT_EQUAL(0, (int)delta.size());
+
+    results.setResult(results.find(hostname2, address2), result2);
+    CPPUNIT_ASSERT(results.getDelta(epoch, sequence, delta));
+    CPPUNIT_ASSERT_EQUAL(1, (int)delta.size());
+    CPPUNIT_ASSERT(delta[0].m_hostName == hostname2);
+    CPPUNIT_ASSERT(delta[0].m_result == result2);
+    CPPUNIT_ASSERT(sequence > last);
+
+    // Assigning the same results is not a change
+    vector<HMGroupCheckResult> all(results.begin(), results.end());
+    results.assign(all);
+    CPPUNIT_ASSERT(results.getDelta(epoch, sequence, delta));
+    CPPUNIT_ASSERT_EQUAL(0, (int)delta.size());
+
+    // A removed result cannot be sent as a delta, the peer resyncs
+    all.pop_back();
+    results.assign(all);
+    CPPUNIT_ASSERT_EQUAL(1, (int)results.size());
+    CPPUNIT_ASSERT(!results.getDelta(epoch, sequence, delta));
+    CPPUNIT_ASSERT_EQUAL(1, (int)delta.size());
+    CPPUNIT_ASSERT(results.getDelta(epoch, sequence, delta));
+    CPPUNIT_ASSERT_EQUAL(0, (int)delta.size());
+
+    // A sequence from another epoch or ahead of the results resyncs
+    uint64_t otherEpoch = epoch + 1;
+    uint64_t otherSequence = sequence;
+    CPPUNIT_ASSERT(!results.getDelta(otherEpoch, otherSequence, delta));
+    CPPUNIT_ASSERT_EQUAL(epoch, otherEpoch);
+    CPPUNIT_ASSERT_EQUAL(1, (int)delta.size());
+    otherSequence = sequence + 1;
+    CPPUNIT_ASSERT(!results.getDelta(otherEpoch, otherSequence, delta));
+    CPPUNIT_ASSERT_EQUAL(sequence, otherSequence);
+
+    // Results rebuilt from scratch never match the sequence of the old ones
+    HMGroupCheckResults rebuilt;
+    rebuilt.assign(all);
+    otherEpoch = epoch;
+    otherSequence = sequence;
+    CPPUNIT_ASSERT(!rebuilt.getDelta(otherEpoch, otherSequence, delta));
+    CPPUNIT_ASSERT(otherEpoch != epoch);
+}
@@ -20,6 +20,9 @@ class TESTNAME : public CppUnit::TestFixture
     CPPUNIT_TEST(test_HMStorageHostGroup_ReadWrite);
     CPPUNIT_TEST(test_HMStorageHostGroup_Restore);
     CPPUNIT_TEST(test_HMStorageHostGroup_InternalFunctions);
+    CPPUNIT_TEST(test_HMStorageHostGroup_ResultIndex);
+    CPPUNIT_TEST(test_HMStorageHostGroup_BatchCommit);
+    CPPUNIT_TEST(test_HMStorageHostGroup_ResultDelta);
     CPPUNIT_TEST_SUITE_END();
 
 
@@ -33,6 +36,9 @@ protected:
     void test_HMStorageHostGroup_ReadWrite();
     void test_HMStorageHostGroup_Restore();
     void test_HMStorageHostGroup_InternalFunctions();
+    void test_HMStorageHostGroup_ResultIndex();
+    void test_HMStorageHostGroup_BatchCommit();
+    void test_HMStorageHostGroup_ResultDelta();
     void test_HMStorageHostGroup_ZeroIp();
 };
 
@@ -1569,3 +1569,382 @@ TESTNAME::test_HMStorageHostGroup_StoreHostGroup()
 }
 
 
+
+static uint64_t
+getRecordGeneration(string& filename, const string& key)
+{
+    MDBMPool pool;
+    if(!pool.init(filename, true))
+    {
+        return 0;
+    }
+    unique_ptr<MDBMHandle> handle = pool.getHandle();
+    string keyCopy = key;
+    handle->m_kv.key.dptr = &keyCopy.at(0);
+    handle->m_kv.key.dsize = keyCopy.length();
+    if(!handle->mdbmFetch() || handle->m_kv.val.dsize < (int32_t)sizeof(uint64_t))
+    {
+        return 0;
+    }
+    return *(uint64_t*)handle->m_kv.val.dptr;
+}
+
+void
+TESTNAME::test_HMStorageHostGroupYForMDBM_IncrementalStore()
+{
+    HMDataHostGroupMap hostGroupMap;
+    string hostGroup1 = "hostgroup1";
+    HMDataHostGroup dataHostGroup1(hostGroup1);
+    hostGroupMap.insert(make_pair(hostGroup1, dataHostGroup1));
+
+    string hostname1 = "test1.hm.com";
+    string hostname2 = "test2.hm.com";
+    string hostname3 = "test3.hm.com";
+
+    HMIPAddress address1;
+    HMIPAddress address2;
+    HMIPAddress address3;
+    address1.set("192.168.0.1");
+    address2.set("192.168.0.2");
+    address3.set("fad0::3");
+
+    HMDataCheckResult result1;
+    HMDataCheckResult result2;
+    HMDataCheckResult result3;
+    result1.m_numChecks = 1;
+    result2.m_numChecks = 2;
+    result3.m_numChecks = 3;
+
+    string filename = "mdbm_yfor";
+    remove(filename.c_str());
+
+    HMDNSCache dnsCache;
+    HMStorageHostGroupMDBM* store = new HMStorageHostGroupMDBM(filename, &hostGroupMap, &dnsCache);
+    CPPUNIT_ASSERT(store->openStore());
+
+    vector<HMGroupCheckResult> results;
+    results.push_back(HMGroupCheckResult(hostname1, address1, result1));
+    results.push_back(HMGroupCheckResult(hostname2, address2, result2));
+    results.push_back(HMGroupCheckResult(hostname3, address3, result3));
+    CPPUNIT_ASSERT(store->storeHostGroupCheckResult(hostGroup1, results));
+
+    // Change one host and drop another
+    result2.m_numChecks = 20;
+    results.clear();
+    results.push_back(HMGroupCheckResult(hostname1, address1, result1));
+    results.push_back(HMGroupCheckResult(hostname2, address2, result2));
+    CPPUNIT_ASSERT(store->storeHostGroupCheckResult(hostGroup1, results));
+
+    vector<HMGroupCheckResult> testResults;
+    CPPUNIT_ASSERT(store->getGroupCheckResults(hostGroup1, true, false, testResults));
+    CPPUNIT_ASSERT_EQUAL(2, (int)testResults.size());
+    CPPUNIT_ASSERT(testResults[0].m_hostName == hostname1);
+    CPPUNIT_ASSERT(testResults[0].m_address == address1);
+    CPPUNIT_ASSERT(testResults[0].m_result == result1);
+    CPPUNIT_ASSERT(testResults[1].m_hostName == hostname2);
+    CPPUNIT_ASSERT(testResults[1].m_address == address2);
+    CPPUNIT_ASSERT(testResults[1].m_result == result2);
+
+    store->closeStore();
+    delete store;
+
+    // Only the changed record was rewritten and the dropped record is gone
+    CPPUNIT_ASSERT_EQUAL((uint64_t)1, getRecordGeneration(filename, HM_MDBM_CHECK_ENTRY_PREFIX + hostGroup1 + "|" + hostname1 + "|" + address1.toString()));
+    CPPUNIT_ASSERT_EQUAL((uint64_t)2, getRecordGeneration(filename, HM_MDBM_CHECK_ENTRY_PREFIX + hostGroup1 + "|" + hostname2 + "|" + address2.toString()));
+    CPPUNIT_ASSERT_EQUAL((uint64_t)0, getRecordGeneration(filename, HM_MDBM_CHECK_ENTRY_PREFIX + hostGroup1 + "|" + hostname3 + "|" + address3.toString()));
+
+    remove(filename.c_str());
+}
+
+void
+TESTNAME::test_HMStorageHostGroupYForMDBM_Migration()
+{
+    HMDataHostGroupMap hostGroupMap;
+    string hostGroup1 = "hostgroup1";
+    HMDataHostGroup dataHostGroup1(hostGroup1);
+    hostGroupMap.insert(make_pair(hostGroup1, dataHostGroup1));
+
+    string hostname1 = "test1.hm.com";
+    string hostname2 = "test2.hm.com";
+
+    HMIPAddress address1;
+    HMIPAddress address2;
+    address1.set("192.168.0.1");
+    address2.set("192.168.0.2");
+
+    HMDataCheckResult result1;
+    HMDataCheckResult result2;
+    result1.m_numChecks = 1;
+    result2.m_numChecks = 2;
+
+    string filename = "mdbm_yfor";
+    remove(filename.c_str());
+
+    // Write a database in the single record layout
+    {
+        MDBMPool pool;
+        CPPUNIT_ASSERT(pool.init(filename, false));
+
+        HMConfigInfo configInfo;
+        configInfo.m_version = HM_MDBM_VERSION_GROUP_BLOB;
+        configInfo.m_configStatus = HM_CONFIG_STATUS_OK;
+        string data;
+        data.resize(configInfo.serialize(nullptr, 0));
+        configInfo.serialize(&data.at(0), data.size());
+        string key = HM_MDBM_CONFIG;
+        unique_ptr<MDBMHandle> handle = pool.getHandle();
+        handle->m_kv.key.dptr = &key.at(0);
+        handle->m_kv.key.dsize = key.length();
+        handle->m_kv.val.dptr = &data.at(0);
+        handle->m_kv.val.dsize = data.length();
+        CPPUNIT_ASSERT(handle->mdbmStore());
+
+        data.resize(2 * sizeof(uint32_t) + hostGroup1.size());
+        *(uint32_t*)&data.at(0) = 1;
+        *(uint32_t*)&data.at(sizeof(uint32_t)) = hostGroup1.size();
+        memcpy(&data.at(2 * sizeof(uint32_t)), hostGroup1.c_str(), hostGroup1.size());
+        key = HM_MDBM_GROUP_NAMES;
+        handle = pool.getHandle();
+        handle->m_kv.key.dptr = &key.at(0);
+        handle->m_kv.key.dsize = key.length();
+        handle->m_kv.val.dptr = &data.at(0);
+        handle->m_kv.val.dsize = data.length();
+        CPPUNIT_ASSERT(handle->mdbmStore());
+
+        vector<HMGroupCheckResult> results;
+        results.push_back(HMGroupCheckResult(hostname1, address1, result1));
+        results.push_back(HMGroupCheckResult(hostname2, address2, result2));
+        uint32_t size = 2 * sizeof(uint32_t);
+        for(auto it = results.begin(); it != results.end(); ++it)
+        {
+            size += sizeof(uint32_t) + it->m_hostName.size() + sizeof(HMIPAddress) + it->m_result.serialize(nullptr, 0);
+        }
+        data.clear();
+        data.resize(size);
+        char* target = &data.at(0);
+        char* end = target + size;
+        *(uint32_t*)target = size;
+        *(uint32_t*)(target + sizeof(uint32_t)) = results.size();
+        target += 2 * sizeof(uint32_t);
+        for(auto it = results.begin(); it != results.end(); ++it)
+        {
+            *(uint32_t*)target = it->m_hostName.size();
+            memcpy(target + sizeof(uint32_t), it->m_hostName.c_str(), it->m_hostName.size());
+            memcpy(target + sizeof(uint32_t) + it->m_hostName.size(), &it->m_address, sizeof(HMIPAddress));
+            target += sizeof(uint32_t) + it->m_hostName.size() + sizeof(HMIPAddress);
+            target += it->m_result.serialize(target, end - target);
+        }
+        key = HM_MDBM_CHECK_PREFIX + hostGroup1;
+        handle = pool.getHandle();
+        handle->m_kv.key.dptr = &key.at(0);
+        handle->m_kv.key.dsize = key.length();
+        handle->m_kv.val.dptr = &data.at(0);
+        handle->m_kv.val.dsize = data.length();
+        CPPUNIT_ASSERT(handle->mdbmStore());
+    }
+
+    HMDNSCache dnsCache;
+
+    // A reader can use the older layout as is
+    HMStorageHostGroupMDBM* store = new HMStorageHostGroupMDBM(filename, &hostGroupMap, &dnsCache);
+    CPPUNIT_ASSERT(store->openStore(true));
+    vector<HMGroupCheckResult> testResults;
+    CPPUNIT_ASSERT(store->getGroupCheckResults(hostGroup1, true, false, testResults));
+    CPPUNIT_ASSERT_EQUAL(2, (int)testResults.size());
+    store->closeStore();
+    delete store;
+
+    // A writer migrates it
+    store = new HMStorageHostGroupMDBM(filename, &hostGroupMap, &dnsCache);
+    CPPUNIT_ASSERT(store->openStore());
+
+    HMConfigInfo testConfigInfo;
+    CPPUNIT_ASSERT(store->getConfigInfo(testConfigInfo));
+    CPPUNIT_ASSERT_EQUAL(HM_MDBM_VERSION, testConfigInfo.m_version);
+
+    testResults.clear();
+    CPPUNIT_ASSERT(store->getGroupCheckResults(hostGroup1, true, false, testResults));
+    CPPUNIT_ASSERT_EQUAL(2, (int)testResults.size());
+    CPPUNIT_ASSERT(testResults[0].m_hostName == hostname1);
+    CPPUNIT_ASSERT(testResults[0].m_address == address1);
+    CPPUNIT_ASSERT(testResults[0].m_result == result1);
+    CPPUNIT_ASSERT(testResults[1].m_hostName == hostname2);
+    CPPUNIT_ASSERT(testResults[1].m_address == address2);
+    CPPUNIT_ASSERT(testResults[1].m_result == result2);
+
+    store->closeStore();
+    delete store;
+
+    CPPUNIT_ASSERT_EQUAL((uint64_t)0, getRecordGeneration(filename, HM_MDBM_CHECK_PREFIX + hostGroup1));
+    CPPUNIT_ASSERT_EQUAL((uint64_t)1, getRecordGeneration(filename, HM_MDBM_CHECK_ENTRY_PREFIX + hostGroup1 + "|" + hostname1 + "|" + address1.toString()));
+
+    remove(filename.c_str());
+}
+
+// The fixed layout of the host group info written before it was versioned
+struct LegacyHostGroup
+{
+    uint16_t m_measurementOptions;
+    uint8_t m_dualstack;
+    uint8_t m_checkType;
+    uint16_t m_port;
+    uint8_t m_numCheckRetries;
+    uint32_t m_checkRetryDelay;
+    uint32_t m_smoothingWindow;
+    uint32_t m_groupThreshold;
+    uint32_t m_slowThreshold;
+    uint32_t m_maxFlaps;
+    uint64_t m_checkTimeout;
+    uint64_t m_checkTTL;
+    uint32_t m_flapThreshold;
+    uint32_t m_passthroughInfo;
+    uint8_t m_distributedFallback;
+    uint32_t m_groupNameSize;
+    uint32_t m_checkInfoSize;
+    uint32_t m_numHosts;
+    uint32_t m_remoteCheckSize;
+    uint32_t m_totalHostSize;
+    uint32_t m_numHostGroups;
+    uint32_t m_totalHostGroupSize;
+    HMIPAddress m_sourceAddress;
+    uint8_t m_TOSValue;
+    uint8_t m_DNSCheckPlugin;
+    uint8_t m_flowType;
+};
+
+void
+TESTNAME::test_HMStorageHostGroupYForMDBM_GroupInfoMigration()
+{
+    string hostGroup1 = "hostgroup1";
+    string hostname1 = "test1.hm.com";
+    string checkInfo = "/status";
+
+    HMDataHostGroup dataHostGroup1(hostGroup1);
+    dataHostGroup1.setMeasurementOptions(HM_RT_TOTAL);
+    dataHostGroup1.setCheckType(HM_CHECK_HTTP);
+    dataHostGroup1.setPort(8080);
+    dataHostGroup1.setCheckInfo(checkInfo);
+    dataHostGroup1.setCheckTTL(60000);
+    dataHostGroup1.addHost(hostname1);
+    HMDataHostGroupMap hostGroupMap;
+    hostGroupMap.insert(make_pair(hostGroup1, dataHostGroup1));
+
+    string filename = "mdbm_yfor";
+    remove(filename.c_str());
+
+    // Write a database with the host group info in the unversioned layout
+    {
+        MDBMPool pool;
+        CPPUNIT_ASSERT(pool.init(filename, false));
+
+        HMConfigInfo configInfo;
+        configInfo.m_version = HM_MDBM_VERSION_GROUP_INFO;
+        configInfo.m_configStatus = HM_CONFIG_STATUS_OK;
+        string data;
+        data.resize(configInfo.serialize(nullptr, 0));
+        configInfo.serialize(&data.at(0), data.size());
+        string key = HM_MDBM_CONFIG;
+        unique_ptr<MDBMHandle> handle = pool.getHandle();
+        handle->m_kv.key.dptr = &key.at(0);
+        handle->m_kv.key.dsize = key.length();
+        handle->m_kv.val.dptr = &data.at(0);
+        handle->m_kv.val.dsize = data.length();
+        CPPUNIT_ASSERT(handle->mdbmStore());
+
+        data.resize(2 * sizeof(uint32_t) + hostGroup1.size());
+        *(uint32_t*)&data.at(0) = 1;
+        *(uint32_t*)&data.at(sizeof(uint32_t)) = hostGroup1.size();
+        memcpy(&data.at(2 * sizeof(uint32_t)), hostGroup1.c_str(), hostGroup1.size());
+        key = HM_MDBM_GROUP_NAMES;
+        handle = pool.getHandle();
+        handle->m_kv.key.dptr = &key.at(0);
+        handle->m_kv.key.dsize = key.length();
+        handle->m_kv.val.dptr = &data.at(0);
+        handle->m_kv.val.dsize = data.length();
+        CPPUNIT_ASSERT(handle->mdbmStore());
+
+        LegacyHostGroup legacy;
+        memset(&legacy, 0, sizeof(legacy));
+        legacy.m_measurementOptions = HM_RT_TOTAL;
+        legacy.m_dualstack = dataHostGroup1.getDualstack();
+        legacy.m_checkType = HM_CHECK_HTTP;
+        legacy.m_port = 8080;
+        legacy.m_numCheckRetries = dataHostGroup1.getNumCheckRetries();
+        legacy.m_checkRetryDelay = dataHostGroup1.getCheckRetryDelay();
+        legacy.m_smoothingWindow = dataHostGroup1.getSmoothingWindow();
+        legacy.m_groupThreshold = dataHostGroup1.getGroupThreshold();
+        legacy.m_slowThreshold = dataHostGroup1.getSlowThreshold();
+        legacy.m_maxFlaps = dataHostGroup1.getMaxFlaps();
+        legacy.m_checkTimeout = dataHostGroup1.getCheckTimeout();
+        legacy.m_checkTTL = 60000;
+        legacy.m_flapThreshold = dataHostGroup1.getFlapThreshold();
+        legacy.m_passthroughInfo = dataHostGroup1.getPassthroughInfo();
+        legacy.m_distributedFallback = dataHostGroup1.getDistributedFallback();
+        legacy.m_groupNameSize = hostGroup1.size();
+        legacy.m_checkInfoSize = checkInfo.size();
+        legacy.m_numHosts = 1;
+        legacy.m_totalHostSize = sizeof(uint32_t) + hostname1.size();
+        legacy.m_sourceAddress = dataHostGroup1.getSourceAddress();
+        legacy.m_TOSValue = dataHostGroup1.getTOSValue();
+        legacy.m_flowType = dataHostGroup1.getFlowType();
+
+        data.assign((char*)&legacy, sizeof(legacy));
+        data.append(hostGroup1);
+        data.append(checkInfo);
+        uint32_t hostSize = hostname1.size();
+        data.append((char*)&hostSize, sizeof(hostSize));
+        data.append(hostname1);
+        key = HM_MDBM_GROUP_PREFIX + hostGroup1;
+        handle = pool.getHandle();
+        handle->m_kv.key.dptr = &key.at(0);
+        handle->m_kv.key.dsize = key.length();
+        handle->m_kv.val.dptr = &data.at(0);
+        handle->m_kv.val.dsize = data.length();
+        CPPUNIT_ASSERT(handle->mdbmStore());
+    }
+
+    HMDNSCache dnsCache;
+
+    // A reader can use the older layout as is
+    HMStorageHostGroupMDBM* store = new HMStorageHostGroupMDBM(filename, &hostGroupMap, &dnsCache);
+    CPPUNIT_ASSERT(store->openStore(true));
+    HMDataHostGroup testGroup(hostGroup1);
+    CPPUNIT_ASSERT(store->getGroupInfo(hostGroup1, testGroup));
+    CPPUNIT_ASSERT(testGroup == dataHostGroup1);
+    CPPUNIT_ASSERT_EQUAL((int)HM_WORK_PRIORITY_NORMAL, (int)testGroup.getPriority());
+    CPPUNIT_ASSERT(!testGroup.getKeepAlive());
+    CPPUNIT_ASSERT(testGroup.getCheckExpect().empty());
+    store->closeStore();
+    delete store;
+
+    // A writer migrates it
+    store = new HMStorageHostGroupMDBM(filename, &hostGroupMap, &dnsCache);
+    CPPUNIT_ASSERT(store->openStore());
+
+    HMConfigInfo testConfigInfo;
+    CPPUNIT_ASSERT(store->getConfigInfo(testConfigInfo));
+    CPPUNIT_ASSERT_EQUAL(HM_MDBM_VERSION, testConfigInfo.m_version);
+
+    HMDataHostGroup migratedGroup(hostGroup1);
+    CPPUNIT_ASSERT(store->getGroupInfo(hostGroup1, migratedGroup));
+    CPPUNIT_ASSERT(migratedGroup == dataHostGroup1);
+    CPPUNIT_ASSERT_EQUAL((int)HM_WORK_PRIORITY_NORMAL, (int)migratedGroup.getPriority());
+    CPPUNIT_ASSERT(!migratedGroup.getKeepAlive());
+
+    store->closeStore();
+    delete store;
+
+    // The blob starts with the magic of the versioned layout
+    {
+        MDBMPool pool;
+        CPPUNIT_ASSERT(pool.init(filename, true));
+        unique_ptr<MDBMHandle> handle = pool.getHandle();
+        string key = HM_MDBM_GROUP_PREFIX + hostGroup1;
+        handle->m_kv.key.dptr = &key.at(0);
+        handle->m_kv.key.dsize = key.length();
+        CPPUNIT_ASSERT(handle->mdbmFetch());
+        CPPUNIT_ASSERT_EQUAL(0xC9, (int)(uint8_t)handle->m_kv.val.dptr[0]);
+    }
+
+    remove(filename.c_str());
+}
@@ -26,6 +26,9 @@ class TESTNAME : public CppUnit::TestFixture
     CPPUNIT_TEST(test_HMStorageHostGroupYForMDBM_ClearBackend);
     CPPUNIT_TEST(test_HMStorageHostGroupYForMDBM_VersionChange);
     CPPUNIT_TEST(test_HMStorageHostGroup_StoreHostGroup);
+    CPPUNIT_TEST(test_HMStorageHostGroupYForMDBM_IncrementalStore);
+    CPPUNIT_TEST(test_HMStorageHostGroupYForMDBM_Migration);
+    CPPUNIT_TEST(test_HMStorageHostGroupYForMDBM_GroupInfoMigration);
     CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -44,6 +47,9 @@ protected:
     void test_HMStorageHostGroupYForMDBM_VersionChange();
     void test_HMStorageHostGroupYForMDBM_BackendTest();
     void test_HMStorageHostGroup_StoreHostGroup();
+    void test_HMStorageHostGroupYForMDBM_IncrementalStore();
+    void test_HMStorageHostGroupYForMDBM_Migration();
+    void test_HMStorageHostGroupYForMDBM_GroupInfoMigration();
 };
 
 #endif /* TESTS_STORETESTS_TESTHMSTORAGEHOSTGROUPMDBM_H_ */
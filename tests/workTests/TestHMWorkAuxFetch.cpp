@@ -16,9 +16,9 @@ HM_WORK_STATUS TestHMWorkAuxFetch::fetchAux()
 
         m_stateManager->updateState(currentState);
 
-        m_start = HMTimeStamp::now();
+        m_start = HMMonotonicTime::now();
         m_response = HM_RESPONSE_CONNECTED;
-        m_end = HMTimeStamp::now()+100;
+        m_end = HMMonotonicTime::now()+100;
         return HM_WORK_COMPLETE;
     }
 
@@ -739,7 +739,8 @@ TESTNAME::test_HMWorkDNSLookup_DnsFailed()
 
     // Basic ipv4 test to make sure the address gets added to the cache and timeout is updated
     HMDataHostCheck hostCheck;
-    HMTimeStamp time = HMTimeStamp::now();
+    HMMonotonicTime time = HMMonotonicTime::now();
+    HMTimeStamp wallTime = HMTimeStamp::now();
     HMDNSLookup dnsHostCheckF(HM_DNS_TYPE_STATIC, false);
     m_currentState->m_dnsCache.insertDNSEntry(failure, dnsHostCheckF, 10000, 10000);
     dnsLookup = new TestHMWorkDNSLookup(failure, addr, hostCheck, dnsHostCheckF);
@@ -757,9 +758,11 @@ TESTNAME::test_HMWorkDNSLookup_DnsFailed()
     {
         CPPUNIT_ASSERT_EQUAL((int)HM_RESPONSE_DNS_FAILED, (int)it->second.m_response);
         CPPUNIT_ASSERT_EQUAL((int)HM_REASON_DNS_NOTFOUND, (int)it->second.m_reason);
-        CPPUNIT_ASSERT_EQUAL(time.getTimeSinceEpoch(), it->second.m_checkTime.getTimeSinceEpoch());
-        CPPUNIT_ASSERT_EQUAL(time.getTimeSinceEpoch(), it->second.m_start.getTimeSinceEpoch());
-        CPPUNIT_ASSERT_EQUAL(time.getTimeSinceEpoch(), it->second.m_end.getTimeSinceEpoch());
+        // The stored times are converted to wall clock time, allow for the rounding of the conversion
+        CPPUNIT_ASSERT(it->second.m_checkTime.getTimeSinceEpoch() + 1 >= wallTime.getTimeSinceEpoch());
+        CPPUNIT_ASSERT(it->second.m_checkTime <= HMTimeStamp::now());
+        CPPUNIT_ASSERT_EQUAL(it->second.m_checkTime.getTimeSinceEpoch(), it->second.m_start.getTimeSinceEpoch());
+        CPPUNIT_ASSERT_EQUAL(it->second.m_checkTime.getTimeSinceEpoch(), it->second.m_end.getTimeSinceEpoch());
     }
     delete dnsLookup;
 }
@@ -18,7 +18,7 @@ TestHMWorkHealthCheck::healthCheck()
     }
     m_response = (responseTime?HM_RESPONSE_CONNECTED:HM_RESPONSE_FAILED);
     m_reason = (responseTime?HM_REASON_SUCCESS:HM_REASON_CONNECT_FAILURE);
-    m_start = HMTimeStamp::now();
+    m_start = HMMonotonicTime::now();
     m_end = m_start + responseTime;
     return HM_WORK_COMPLETE;
 }
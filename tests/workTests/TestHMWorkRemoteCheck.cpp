@@ -18,7 +18,7 @@ TestHMWorkRemoteCheck::remoteLookup()
     }
     m_response = (responseTime?HM_RESPONSE_CONNECTED:HM_RESPONSE_FAILED);
     m_reason = (responseTime?HM_REASON_SUCCESS:HM_REASON_CONNECT_FAILURE);
-    m_start = HMTimeStamp::now();
+    m_start = HMMonotonicTime::now();
     m_end = m_start + responseTime;
     return HM_WORK_COMPLETE_REMOTE;
 }
@@ -574,7 +574,7 @@ TESTNAME::test_HMWorkRemoteCheck_mixed_dns()
 
     CPPUNIT_ASSERT_EQUAL(5, (int)m_state.m_workQueue.queueSize());
 
-    // Now check the work list
+    // Now check the work list, the work classes are served by their weights
     unique_ptr<HMWork> work;
     bool threadStatus = false;
     m_state.m_workQueue.getWork(work, threadStatus);
@@ -582,17 +582,17 @@ TESTNAME::test_HMWorkRemoteCheck_mixed_dns()
     CPPUNIT_ASSERT(work->m_hostCheck == check2);
     CPPUNIT_ASSERT(work->m_ipAddress == address3);
     m_state.m_workQueue.getWork(work, threadStatus);
-    CPPUNIT_ASSERT(work->m_hostname == h2);
-    CPPUNIT_ASSERT(work->m_hostCheck == check2);
-    CPPUNIT_ASSERT(work->m_ipAddress == address4);
+    CPPUNIT_ASSERT(work->m_hostname == h1);
+    CPPUNIT_ASSERT(work->m_hostCheck == defaultcheck);
+    CPPUNIT_ASSERT(work->m_ipAddress == addr);
     m_state.m_workQueue.getWork(work, threadStatus);
     CPPUNIT_ASSERT(work->m_hostname == hg1);
     CPPUNIT_ASSERT(work->m_hostCheck == check1);
     CPPUNIT_ASSERT(work->m_ipAddress == addr);
     m_state.m_workQueue.getWork(work, threadStatus);
-    CPPUNIT_ASSERT(work->m_hostname == h1);
-    CPPUNIT_ASSERT(work->m_hostCheck == defaultcheck);
-    CPPUNIT_ASSERT(work->m_ipAddress == addr);
+    CPPUNIT_ASSERT(work->m_hostname == h2);
+    CPPUNIT_ASSERT(work->m_hostCheck == check2);
+    CPPUNIT_ASSERT(work->m_ipAddress == address4);
     m_state.m_workQueue.getWork(work, threadStatus);
     CPPUNIT_ASSERT(work->m_hostname == h2);
     CPPUNIT_ASSERT(work->m_hostCheck == defaultcheck);
@@ -811,18 +811,18 @@ TESTNAME::test_HMWorkRemoteCheck_mixed_healthcheck()
 
     CPPUNIT_ASSERT_EQUAL(3, (int)m_state.m_workQueue.queueSize());
 
-    // Now check the work list
+    // Now check the work list, the work classes are served by their weights
     unique_ptr<HMWork> work;
     bool threadStatus = false;
     m_state.m_workQueue.getWork(work, threadStatus);
-    CPPUNIT_ASSERT(work->m_hostname == hg1);
-    CPPUNIT_ASSERT(work->m_hostCheck == check1);
-    CPPUNIT_ASSERT(work->m_ipAddress == addr);
-    m_state.m_workQueue.getWork(work, threadStatus);
     CPPUNIT_ASSERT(work->m_hostname == h1);
     CPPUNIT_ASSERT(work->m_hostCheck == check2);
     CPPUNIT_ASSERT(work->m_ipAddress == address3);
     m_state.m_workQueue.getWork(work, threadStatus);
+    CPPUNIT_ASSERT(work->m_hostname == hg1);
+    CPPUNIT_ASSERT(work->m_hostCheck == check1);
+    CPPUNIT_ASSERT(work->m_ipAddress == addr);
+    m_state.m_workQueue.getWork(work, threadStatus);
     CPPUNIT_ASSERT(work->m_hostname == h2);
     CPPUNIT_ASSERT(work->m_hostCheck == check2);
     CPPUNIT_ASSERT(work->m_ipAddress == address4);